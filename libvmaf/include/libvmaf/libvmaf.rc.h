@@ -49,11 +49,18 @@ enum VmafPoolingMethod {
     VMAF_POOL_METHOD_NB
 };
 
+enum VmafThreadScheduler {
+    VMAF_THREAD_SCHEDULER_FIFO = 0,
+    VMAF_THREAD_SCHEDULER_WORK_STEALING,
+};
+
 typedef struct VmafConfiguration {
     enum VmafLogLevel log_level;
     unsigned n_threads;
     unsigned n_subsample;
     unsigned cpumask;
+    enum VmafThreadScheduler scheduler;
+    unsigned max_frames_in_flight; ///< threaded mode only, 0 for unlimited
 } VmafConfiguration;
 
 typedef struct VmafContext VmafContext;
@@ -142,6 +149,86 @@ int vmaf_use_feature(VmafContext *vmaf, const char *feature_name,
 int vmaf_import_feature_score(VmafContext *vmaf, char *feature_name,
                               double value, unsigned index);
 
+/**
+ * Receives feature scores which are no longer retained, see
+ * `vmaf_set_retention_window()`.
+ */
+typedef void (*VmafFeatureSpill)(void *user_data, const char *feature_name,
+                                 unsigned index, double score);
+
+/**
+ * Bound memory for long running contexts by only retaining per-frame feature
+ * scores for the last `n_frames` picture indices. Older scores are handed to
+ * `spill`, if set, and dropped. `spill` is called with internal locks held
+ * and must not call back into the context.
+ *
+ * Pooled scores over ranges which are no longer fully retained can only be
+ * computed for the whole stream, i.e. `index_low` is 0 and `index_high` is at
+ * least the highest picture index read so far. These are served from running
+ * accumulators over every score ever written. Any other range reaching below
+ * the retained window fails with -ERANGE. Model scores are only accumulated
+ * for frames predicted while retained, e.g. via
+ * `vmaf_register_frame_callback()` with a model.
+ *
+ * Must be called before the first `vmaf_read_pictures()` or
+ * `vmaf_import_feature_score()`.
+ *
+ * @param vmaf      The VMAF context allocated with `vmaf_init()`.
+ *
+ * @param n_frames  Number of picture indices to retain, 0 retains all.
+ *
+ * @param spill     Optional sink for scores which are no longer retained.
+ *
+ * @param user_data Passed through to `spill`.
+ *
+ *
+ * @return 0 on success, or < 0 (a negative errno code) on error.
+ */
+int vmaf_set_retention_window(VmafContext *vmaf, unsigned n_frames,
+                              VmafFeatureSpill spill, void *user_data);
+
+/**
+ * Per-frame completion callback, see `vmaf_register_frame_callback()`.
+ *
+ * @param user_data User data passed to `vmaf_register_frame_callback()`.
+ *
+ * @param index     Picture index.
+ *
+ * @param score     Predicted score, NULL if no model was registered or the
+ *                  prediction failed.
+ */
+typedef void (*VmafFrameCallback)(void *user_data, unsigned index,
+                                  const double *score);
+
+/**
+ * Register a callback which fires once all registered features for a
+ * picture index have been written, so that per-frame scores can be read
+ * while extraction continues on other frames. If `model` is set, its
+ * prediction is computed (and stored, like `vmaf_score_at_index()`) before
+ * the callback fires.
+ *
+ * Temporal feature extractors write some scores one picture late, so with
+ * those registered an index completes once the next picture has been
+ * extracted, the last one on flush. Subsampled indices do not fire. In
+ * threaded mode the callback runs on worker threads, possibly concurrently
+ * and out of index order.
+ *
+ * Must be called before the first `vmaf_read_pictures()`.
+ *
+ * @param vmaf      The VMAF context allocated with `vmaf_init()`.
+ *
+ * @param callback  Callback, NULL to unregister.
+ *
+ * @param model     Optional model to predict with before each callback.
+ *
+ * @param user_data Passed through to `callback`.
+ *
+ *
+ * @return 0 on success, or < 0 (a negative errno code) on error.
+ */
+int vmaf_register_frame_callback(VmafContext *vmaf, VmafFrameCallback callback,
+                                 VmafModel *model, void *user_data);
+
 /**
  * Read a pair of pictures and queue them for eventual feature extraction.
  * This should be called after feature extractors are registered via
@@ -152,6 +239,9 @@ int vmaf_import_feature_score(VmafContext *vmaf, char *feature_name,
  * When you're done reading pictures call this function again with both `ref`
  * and `dist` set to NULL to flush all feature extractors.
  *
+ * In threaded mode, if `VmafConfiguration.max_frames_in_flight` is set, this
+ * function blocks while that many frames are still being extracted.
+ *
  * @param vmaf  The VMAF context allocated with `vmaf_init()`.
  *
  * @param ref   Reference picture.
@@ -166,6 +256,27 @@ int vmaf_import_feature_score(VmafContext *vmaf, char *feature_name,
 int vmaf_read_pictures(VmafContext *vmaf, VmafPicture *ref, VmafPicture *dist,
                        unsigned index);
 
+/**
+ * Non-blocking variant of `vmaf_read_pictures()`.
+ * If `VmafConfiguration.max_frames_in_flight` frames are still being
+ * extracted, this function returns -EAGAIN immediately. In that case
+ * ownership of `ref` and `dist` stays with the caller, who may retry later.
+ *
+ * @param vmaf  The VMAF context allocated with `vmaf_init()`.
+ *
+ * @param ref   Reference picture.
+ *
+ * @param dist  Distorted picture.
+ *
+ * @param index Picture index.
+ *
+ *
+ * @return 0 on success, -EAGAIN if the in-flight window is full,
+ *         or < 0 (a negative errno code) on error.
+ */
+int vmaf_try_read_pictures(VmafContext *vmaf, VmafPicture *ref,
+                           VmafPicture *dist, unsigned index);
+
 /**
  * Predict VMAF score at specific index.
  *
@@ -222,6 +333,10 @@ int vmaf_feature_score_at_index(VmafContext *vmaf, const char *feature_name,
 /**
  * Pooled VMAF score for a specific interval.
  *
+ * With a retention window, intervals reaching below the retained pictures
+ * fail with -ERANGE unless they cover the whole stream, see
+ * `vmaf_set_retention_window()`.
+ *
  * @param vmaf         The VMAF context allocated with `vmaf_init()`.
  *
  * @param model        Opaque model context.
@@ -244,6 +359,10 @@ int vmaf_score_pooled(VmafContext *vmaf, VmafModel *model,
 /**
  * Pooled VMAF score for a specific interval, using a model collection.
  *
+ * With a retention window, intervals reaching below the retained pictures
+ * fail with -ERANGE unless they cover the whole stream, see
+ * `vmaf_set_retention_window()`.
+ *
  * @param vmaf              The VMAF context allocated with `vmaf_init()`.
  *
  * @param model_collection  Opaque model collection context.
@@ -268,6 +387,10 @@ int vmaf_score_pooled_model_collection(VmafContext *vmaf,
 /**
  * Pooled feature score for a specific interval.
  *
+ * With a retention window, intervals reaching below the retained pictures
+ * fail with -ERANGE unless they cover the whole stream, see
+ * `vmaf_set_retention_window()`.
+ *
  * @param vmaf          The VMAF context allocated with `vmaf_init()`.
  *
  * @param feature_name  Name of the feature to fetch.
@@ -287,6 +410,20 @@ int vmaf_feature_score_pooled(VmafContext *vmaf, const char *feature_name,
                               enum VmafPoolingMethod pool_method, double *score,
                               unsigned index_low, unsigned index_high);
 
+/**
+ * Reset a VMAF instance so it may score another pair of videos, starting over
+ * at picture index 0. Unflushed pictures are flushed first. All feature
+ * scores are dropped, while used features, their preallocated buffers, the
+ * thread pool, retention window and frame callback are kept. Pictures of the
+ * next pair must match the size, pixel format and bitdepth of the first.
+ *
+ * @param vmaf The VMAF instance to reset.
+ *
+ *
+ * @return 0 on success, or < 0 (a negative errno code) on error.
+ */
+int vmaf_reset(VmafContext *vmaf);
+
 /**
  * Close a VMAF instance and free all associated memory.
  *
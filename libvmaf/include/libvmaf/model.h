@@ -28,6 +28,7 @@ enum VmafModelFlags {
     VMAF_MODEL_FLAG_DISABLE_CLIP = (1 << 0),
     VMAF_MODEL_FLAG_ENABLE_TRANSFORM = (1 << 1),
     VMAF_MODEL_FLAG_DISABLE_TRANSFORM = (1 << 2),
+    VMAF_MODEL_FLAG_SHARED = (1 << 3),
 };
 
 typedef struct VmafModelConfig {
@@ -35,6 +36,14 @@ typedef struct VmafModelConfig {
     uint64_t flags;
 } VmafModelConfig;
 
+/**
+ * With `VMAF_MODEL_FLAG_SHARED`, models and model collections are loaded
+ * once per process and shared. They are looked up by version or path, name
+ * and flags, and are reference counted: each successful load has to be
+ * matched by a `vmaf_model_destroy()` or `vmaf_model_collection_destroy()`.
+ * Models are read-only once loaded, so a shared model may be used by any
+ * number of `VmafContext`s concurrently.
+ */
 int vmaf_model_load(VmafModel **model, VmafModelConfig *cfg,
                     const char *version);
 
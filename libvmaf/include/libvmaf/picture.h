@@ -20,6 +20,7 @@
 #define __VMAF_PICTURE_H__
 
 #include <stddef.h>
+#include <stdint.h>
 
 enum VmafPixelFormat {
     VMAF_PIX_FMT_UNKNOWN,
@@ -42,6 +43,92 @@ typedef struct {
 int vmaf_picture_alloc(VmafPicture *pic, enum VmafPixelFormat pix_fmt,
                        unsigned bpc, unsigned w, unsigned h);
 
+/**
+ * Wrap caller-owned planes into a picture without copying them. `release` is
+ * called with `cookie` once the last reference to the picture is dropped,
+ * possibly from a libvmaf worker thread, after which libvmaf no longer
+ * touches the planes. Each plane has to remain readable for
+ * `stride[i] * h[i]` bytes.
+ *
+ * Planes which are 32-byte aligned with a stride of a multiple of 32 bytes
+ * are used in place. Otherwise `vmaf_read_pictures()` extracts features from
+ * an aligned copy, and releases the wrapped planes right away.
+ *
+ * @param pic     Picture to fill, release with `vmaf_picture_unref()` or
+ *                pass on to `vmaf_read_pictures()`.
+ *
+ * @param data    Plane pointers, Y, U and V.
+ *
+ * @param stride  Plane strides in bytes.
+ *
+ * @param release Optional, called once the planes are no longer used.
+ *
+ * @param cookie  Passed through to `release`.
+ *
+ *
+ * @return 0 on success, or < 0 (a negative errno code) on error.
+ */
+int vmaf_picture_wrap(VmafPicture *pic, enum VmafPixelFormat pix_fmt,
+                      unsigned bpc, unsigned w, unsigned h,
+                      void *const data[3], const ptrdiff_t stride[3],
+                      void (*release)(void *cookie), void *cookie);
+
 int vmaf_picture_unref(VmafPicture *pic);
 
+typedef struct VmafPicturePool VmafPicturePool;
+
+enum VmafPicturePoolFlags {
+    VMAF_PICTURE_POOL_FLAGS_DEFAULT = 0,
+    VMAF_PICTURE_POOL_FLAG_CLEAR = (1 << 0), ///< zero pictures on every fetch
+};
+
+typedef struct VmafPicturePoolConfig {
+    unsigned pic_cnt; ///< number of preallocated pictures
+    enum VmafPixelFormat pix_fmt;
+    unsigned bpc, w, h;
+    uint64_t flags;
+} VmafPicturePoolConfig;
+
+/**
+ * Preallocate `cfg.pic_cnt` pictures of a fixed geometry. Pictures fetched
+ * from the pool are returned to it, instead of being freed, once their last
+ * reference is dropped with `vmaf_picture_unref()`. Pictures are zeroed once
+ * when the pool is created; a recycled picture keeps its previous contents
+ * unless `VMAF_PICTURE_POOL_FLAG_CLEAR` is set.
+ *
+ * @param pool The picture pool to create.
+ *
+ * @param cfg  Pool geometry and flags.
+ *
+ *
+ * @return 0 on success, or < 0 (a negative errno code) on error.
+ */
+int vmaf_picture_pool_create(VmafPicturePool **pool, VmafPicturePoolConfig cfg);
+
+/**
+ * Fetch a picture from the pool. Blocks until a picture is returned if all
+ * of them are in use, so the pool should be sized for every picture held at
+ * once, e.g. by in-flight frames of a threaded `VmafContext`.
+ *
+ * @param pool The picture pool.
+ *
+ * @param pic  Picture to fill, release with `vmaf_picture_unref()` or pass
+ *             on to `vmaf_read_pictures()`.
+ *
+ *
+ * @return 0 on success, or < 0 (a negative errno code) on error.
+ */
+int vmaf_picture_pool_fetch(VmafPicturePool *pool, VmafPicture *pic);
+
+/**
+ * Destroy the pool. Pictures still in use are freed once their last
+ * reference is dropped.
+ *
+ * @param pool The picture pool to destroy.
+ *
+ *
+ * @return 0 on success, or < 0 (a negative errno code) on error.
+ */
+int vmaf_picture_pool_destroy(VmafPicturePool *pool);
+
 #endif /* __VMAF_PICTURE_H__ */
@@ -34,6 +34,7 @@ typedef unsigned int atomic_uint;
 
 #define memory_order_relaxed __ATOMIC_RELAXED
 #define memory_order_acquire __ATOMIC_ACQUIRE
+#define memory_order_release __ATOMIC_RELEASE
 
 #define atomic_init(p_a, v)           do { *(p_a) = (v); } while(0)
 #define atomic_store(p_a, v)          __atomic_store_n(p_a, v, __ATOMIC_SEQ_CST)
@@ -41,6 +42,9 @@ typedef unsigned int atomic_uint;
 #define atomic_load_explicit(p_a, mo) __atomic_load_n(p_a, mo)
 #define atomic_fetch_add(p_a, inc)    __atomic_fetch_add(p_a, inc, __ATOMIC_SEQ_CST)
 #define atomic_fetch_sub(p_a, dec)    __atomic_fetch_sub(p_a, dec, __ATOMIC_SEQ_CST)
+#define atomic_compare_exchange_strong(p_a, expected, desired) \
+    __atomic_compare_exchange_n(p_a, expected, desired, 0, \
+                                __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)
 
 #endif /* !defined(__cplusplus) */
 
@@ -46,7 +46,8 @@ typedef volatile ULONG __declspec(align(32)) atomic_uint;
 
 typedef enum {
     memory_order_relaxed,
-    memory_order_acquire
+    memory_order_acquire,
+    memory_order_release
 } msvc_atomic_memory_order;
 
 #define atomic_init(p_a, v)           do { *(p_a) = (v); } while(0)
@@ -61,6 +62,17 @@ typedef enum {
 #define atomic_fetch_add(p_a, inc)    InterlockedExchangeAdd(p_a, inc)
 #define atomic_fetch_sub(p_a, dec)    InterlockedExchangeAdd(p_a, -(dec))
 
+static inline int atomic_compare_exchange_strong_int(LONG *obj, LONG *expected,
+                                                     LONG desired)
+{
+    LONG orig = *expected;
+    *expected = InterlockedCompareExchange(obj, desired, orig);
+    return *expected == orig;
+}
+#define atomic_compare_exchange_strong(p_a, expected, desired) \
+    atomic_compare_exchange_strong_int((LONG *)p_a, (LONG *)expected, \
+                                       (LONG)desired)
+
 #endif /* ! stdatomic.h */
 
 #pragma warning(pop)
@@ -2,6 +2,7 @@
 #include <string.h>
 
 #include "feature/alias.h"
+#include "feature/picture_copy.h"
 #include "libvmaf/libvmaf.rc.h"
 #include "model.h"
 
@@ -76,34 +77,6 @@ static int bitdepth_map(char *fmt)
     return 8;
 }
 
-static void copy_data(float *src, VmafPicture *dst, unsigned width,
-                      unsigned height, int src_stride)
-{
-    float *a = src;
-    uint8_t *b = dst->data[0];
-    for (unsigned i = 0; i < height; i++) {
-        for (unsigned j = 0; j < width; j++) {
-            b[j] = a[j];
-        }
-        a += src_stride / sizeof(float);
-        b += dst->stride[0];
-    }
-}
-
-static void copy_data_hbd(float *src, VmafPicture *dst, unsigned width,
-                          unsigned height, int src_stride, unsigned bpc)
-{
-    float *a = src;
-    uint16_t *b = dst->data[0];
-    for (unsigned i = 0; i < height; i++) {
-        for (unsigned j = 0; j < width; j++) {
-            b[j] = a[j] * (1 << (bpc - 8));
-        }
-        a += src_stride / sizeof(float);
-        b += dst->stride[0] / sizeof(uint16_t);
-    }
-}
-
 int compute_vmaf(double* vmaf_score, char* fmt, int width, int height,
                  int (*read_frame)(float *ref_data, float *main_data,
                                    float *temp_data, int stride_byte,
@@ -232,14 +205,8 @@ int compute_vmaf(double* vmaf_score, char* fmt, int width, int height,
             goto free_data;
         }
 
-        const unsigned bpc = bitdepth_map(fmt);
-        if (bpc > 8) {
-            copy_data_hbd(ref_data, &pic_ref, width, height, stride, bpc);
-            copy_data_hbd(main_data, &pic_dist, width, height, stride, bpc);
-        } else {
-            copy_data(ref_data, &pic_ref, width, height, stride);
-            copy_data(main_data, &pic_dist, width, height, stride);
-        }
+        picture_copy_from_float_pair(&pic_ref, &pic_dist, ref_data, main_data,
+                                     stride, bitdepth_map(fmt));
 
         err = vmaf_read_pictures(vmaf, &pic_ref, &pic_dist, picture_index);
         if (err) {
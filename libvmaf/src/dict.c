@@ -91,6 +91,17 @@ fail:
     return -ENOMEM;
 }
 
+const VmafDictionaryEntry *vmaf_dictionary_get_entry(VmafDictionary **dict,
+                                                     unsigned index)
+{
+    if (!dict) return NULL;
+    if (!(*dict)) return NULL;
+
+    VmafDictionary *d = *dict;
+    if (index >= d->cnt) return NULL;
+    return &d->entry[index];
+}
+
 int vmaf_dictionary_copy(VmafDictionary **src, VmafDictionary **dst)
 {
     if (!src) return -EINVAL;
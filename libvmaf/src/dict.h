@@ -41,6 +41,10 @@ int vmaf_dictionary_set(VmafDictionary **dict, const char *key, const char *val,
 const VmafDictionaryEntry *vmaf_dictionary_get(VmafDictionary **dict,
                                                const char *key, uint64_t flags);
 
+/* Entries in insertion order, NULL once `index` is past the last entry. */
+const VmafDictionaryEntry *vmaf_dictionary_get_entry(VmafDictionary **dict,
+                                                     unsigned index);
+
 int vmaf_dictionary_copy(VmafDictionary **src, VmafDictionary **dst);
 
 VmafDictionary *vmaf_dictionary_merge(VmafDictionary **dict_a,
@@ -16,6 +16,7 @@
  *
  */
 
+#include <errno.h>
 #include <limits.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -23,6 +24,7 @@
 #include <string.h>
 
 #include "mem.h"
+#include "adm.h"
 #include "adm_options.h"
 #include "adm_tools.h"
 #include "offset.h"
@@ -67,21 +69,83 @@ static char *init_dwt_band_hvd(adm_dwt_band_t *band, char *data_top, size_t buf_
 	return data_top;
 }
 
+// Code optimized to save on multiple buffer copies
+// hence the reduction in the number of buffers required from 35 to 17
+#define NUM_BUFS_ADM 20
+
+int adm_workspace_init(AdmWorkspace *ws, int w, int h)
+{
+    if (!ws) return -EINVAL;
+    if (w <= 0 || h <= 0) return -EINVAL;
+
+    memset(ws, 0, sizeof(*ws));
+    ws->w = w;
+    ws->h = h;
+    ws->buf_stride = ALIGN_CEIL(((w + 1) / 2) * sizeof(float));
+    ws->buf_sz_one = (size_t)ws->buf_stride * ((h + 1) / 2);
+    ws->ind_size_y = ALIGN_CEIL(((h + 1) / 2) * sizeof(int));
+    ws->ind_size_x = ALIGN_CEIL(((w + 1) / 2) * sizeof(int));
+    if (SIZE_MAX / ws->buf_sz_one < NUM_BUFS_ADM) return -EINVAL;
+
+    ws->data_buf = aligned_malloc(ws->buf_sz_one * NUM_BUFS_ADM, MAX_ALIGN);
+    if (!ws->data_buf) goto fail;
+    ws->buf_y_orig = aligned_malloc(ws->ind_size_y * 4, MAX_ALIGN);
+    if (!ws->buf_y_orig) goto fail;
+    ws->buf_x_orig = aligned_malloc(ws->ind_size_x * 4, MAX_ALIGN);
+    if (!ws->buf_x_orig) goto fail;
+    ws->dwt_buf = aligned_malloc(ALIGN_CEIL(sizeof(float) * w) * 2, MAX_ALIGN);
+    if (!ws->dwt_buf) goto fail;
+    return 0;
+
+fail:
+    adm_workspace_free(ws);
+    return -ENOMEM;
+}
+
+void adm_workspace_free(AdmWorkspace *ws)
+{
+    if (!ws) return;
+    aligned_free(ws->data_buf);
+    aligned_free(ws->buf_y_orig);
+    aligned_free(ws->buf_x_orig);
+    aligned_free(ws->dwt_buf);
+    memset(ws, 0, sizeof(*ws));
+}
+
 int compute_adm(const float *ref, const float *dis, int w, int h, int ref_stride, int dis_stride, double *score,
         double *score_num, double *score_den, double *scores, double border_factor, double adm_enhn_gain_limit)
+{
+	AdmWorkspace ws;
+	if (adm_workspace_init(&ws, w, h))
+	{
+		printf("error: aligned_malloc failed for data_buf.\n");
+		fflush(stdout);
+		return 1;
+	}
+
+	int ret = compute_adm_ws(&ws, ref, dis, w, h, ref_stride, dis_stride,
+	                         score, score_num, score_den, scores,
+	                         border_factor, adm_enhn_gain_limit);
+	adm_workspace_free(&ws);
+	return ret;
+}
+
+int compute_adm_ws(AdmWorkspace *ws, const float *ref, const float *dis, int w, int h, int ref_stride, int dis_stride, double *score,
+        double *score_num, double *score_den, double *scores, double border_factor, double adm_enhn_gain_limit)
 {
 #ifdef ADM_OPT_SINGLE_PRECISION
 	double numden_limit = 1e-2 * (w * h) / (1920.0 * 1080.0);
 #else
 	double numden_limit = 1e-10 * (w * h) / (1920.0 * 1080.0);
 #endif
-	float *data_buf = 0;
 	char *data_top;
 
-	char *ind_buf_y = 0, *buf_y_orig = 0;
-	char *ind_buf_x = 0, *buf_x_orig = 0;
+	char *ind_buf_y = 0;
+	char *ind_buf_x = 0;
 	int *ind_y[4], *ind_x[4];
 
+	float *dwt_tmp_lo, *dwt_tmp_hi;
+
 	float *ref_scale;
 	float *dis_scale;
 
@@ -101,36 +165,25 @@ int compute_adm(const float *ref, const float *dis, int w, int h, int ref_stride
 
 	int orig_h = h;
 
-	int buf_stride = ALIGN_CEIL(((w + 1) / 2) * sizeof(float));
-	size_t buf_sz_one = (size_t)buf_stride * ((h + 1) / 2);
+	int buf_stride = ws->buf_stride;
+	size_t buf_sz_one = ws->buf_sz_one;
 
-	int ind_size_y = ALIGN_CEIL(((h + 1) / 2) * sizeof(int));
-	int ind_size_x = ALIGN_CEIL(((w + 1) / 2) * sizeof(int));
+	int ind_size_y = ws->ind_size_y;
+	int ind_size_x = ws->ind_size_x;
 
 	double num = 0;
 	double den = 0;
 
 	int scale;
-	int ret = 1;
-	
-	// Code optimized to save on multiple buffer copies 
-	// hence the reduction in the number of buffers required from 35 to 17 
-#define NUM_BUFS_ADM 20 
-	if (SIZE_MAX / buf_sz_one < NUM_BUFS_ADM)
-	{
-		printf("error: SIZE_MAX / buf_sz_one < NUM_BUFS_ADM, buf_sz_one = %zu.\n", buf_sz_one);
-		fflush(stdout);
-		goto fail;
-	}
 
-	if (!(data_buf = aligned_malloc(buf_sz_one * NUM_BUFS_ADM, MAX_ALIGN)))
+	if (w > ws->w || h > ws->h)
 	{
-		printf("error: aligned_malloc failed for data_buf.\n");
+		printf("error: frame exceeds the adm workspace.\n");
 		fflush(stdout);
-		goto fail;
+		return 1;
 	}
 
-	data_top = (char *)data_buf;
+	data_top = (char *)ws->data_buf;
 
 	data_top = init_dwt_band(&ref_dwt2, data_top, buf_sz_one);
 	data_top = init_dwt_band(&dis_dwt2, data_top, buf_sz_one);
@@ -139,30 +192,21 @@ int compute_adm(const float *ref, const float *dis, int w, int h, int ref_stride
 	data_top = init_dwt_band_hvd(&csf_a, data_top, buf_sz_one);
 	data_top = init_dwt_band_hvd(&csf_f, data_top, buf_sz_one);
 
-	if (!(buf_y_orig = aligned_malloc(ind_size_y * 4, MAX_ALIGN)))
-	{
-		printf("error: aligned_malloc failed for ind_buf_y.\n");
-		fflush(stdout);
-		goto fail;
-	}
-	ind_buf_y = buf_y_orig;
+	ind_buf_y = ws->buf_y_orig;
 	ind_y[0] = (int*)ind_buf_y; ind_buf_y += ind_size_y;
 	ind_y[1] = (int*)ind_buf_y; ind_buf_y += ind_size_y;
 	ind_y[2] = (int*)ind_buf_y; ind_buf_y += ind_size_y;
 	ind_y[3] = (int*)ind_buf_y; ind_buf_y += ind_size_y;
 
-	if (!(buf_x_orig = aligned_malloc(ind_size_x * 4, MAX_ALIGN)))
-	{
-		printf("error: aligned_malloc failed for ind_buf_x.\n");
-		fflush(stdout);
-		goto fail;
-	}
-	ind_buf_x = buf_x_orig;
+	ind_buf_x = ws->buf_x_orig;
 	ind_x[0] = (int*)ind_buf_x; ind_buf_x += ind_size_x;
 	ind_x[1] = (int*)ind_buf_x; ind_buf_x += ind_size_x;
 	ind_x[2] = (int*)ind_buf_x; ind_buf_x += ind_size_x;
 	ind_x[3] = (int*)ind_buf_x; ind_buf_x += ind_size_x;
 
+	dwt_tmp_lo = (float *)ws->dwt_buf;
+	dwt_tmp_hi = (float *)((char *)ws->dwt_buf + ALIGN_CEIL(sizeof(float) * ws->w));
+
 	for (scale = 0; scale < 4; ++scale) {
 #ifdef ADM_OPT_DEBUG_DUMP
 		char pathbuf[256];
@@ -171,8 +215,8 @@ int compute_adm(const float *ref, const float *dis, int w, int h, int ref_stride
 		float den_scale = 0.0;
 	
 		dwt2_src_indices_filt(ind_y, ind_x, w, h);
-		adm_dwt2(curr_ref_scale, &ref_dwt2, ind_y, ind_x, w, h, curr_ref_stride, buf_stride);
-		adm_dwt2(curr_dis_scale, &dis_dwt2, ind_y, ind_x, w, h, curr_dis_stride, buf_stride);
+		adm_dwt2(curr_ref_scale, &ref_dwt2, ind_y, ind_x, w, h, curr_ref_stride, buf_stride, dwt_tmp_lo, dwt_tmp_hi);
+		adm_dwt2(curr_dis_scale, &dis_dwt2, ind_y, ind_x, w, h, curr_dis_stride, buf_stride, dwt_tmp_lo, dwt_tmp_hi);
 
 		w = (w + 1) / 2;
 		h = (h + 1) / 2;
@@ -274,11 +318,5 @@ int compute_adm(const float *ref, const float *dis, int w, int h, int ref_stride
 	*score_num = num;
 	*score_den = den;
 
-	ret = 0;
-
-fail:
-	aligned_free(data_buf);
-	aligned_free(buf_y_orig);
-	aligned_free(buf_x_orig);
-	return ret;
+	return 0;
 }
@@ -16,7 +16,36 @@
  *
  */
 
+#ifndef FEATURE_ADM_H_
+#define FEATURE_ADM_H_
+
+#include <stddef.h>
+
+/* Scratch planes for compute_adm_ws(), sized once for frames up to w x h. */
+typedef struct AdmWorkspace {
+    int w, h;
+    int buf_stride;
+    size_t buf_sz_one;
+    int ind_size_y, ind_size_x;
+    void *data_buf;
+    void *buf_y_orig;
+    void *buf_x_orig;
+    void *dwt_buf; // vertical pass rows for adm_dwt2_s()
+} AdmWorkspace;
+
+int adm_workspace_init(AdmWorkspace *ws, int w, int h);
+
+void adm_workspace_free(AdmWorkspace *ws);
+
+int compute_adm_ws(AdmWorkspace *ws, const float *ref, const float *dis,
+                   int w, int h, int ref_stride, int dis_stride,
+                   double *score, double *score_num, double *score_den,
+                   double *scores, double border_factor,
+                   double adm_enhn_gain_limit);
+
 int compute_adm(const float *ref, const float *dis, int w, int h,
                 int ref_stride, int dis_stride, double *score,
                 double *score_num, double *score_den, double *scores,
                 double border_factor, double adm_enhn_gain_limit);
+
+#endif /* FEATURE_ADM_H_ */
@@ -24,10 +24,18 @@
 #include "config.h"
 #endif
 
+#include "cpu.h"
 #include "mem.h"
 #include "adm_options.h"
 #include "adm_tools.h"
 
+#if ARCH_X86
+#include "x86/float_adm_avx2.h"
+#if HAVE_AVX512
+#include "x86/float_adm_avx512.h"
+#endif
+#endif
+
 #ifndef M_PI
   #define M_PI 3.1415926535897932384626433832795028841971693993751
 #endif
@@ -75,6 +83,16 @@ static const float fcoeff_cm_thresh_s[3][3] =
 
 float adm_sum_cube_s(const float *x, int w, int h, int stride, double border_factor)
 {
+#if ARCH_X86
+    const unsigned flags = vmaf_get_cpu_flags();
+#if HAVE_AVX512
+    if (flags & VMAF_X86_CPU_FLAG_AVX512)
+        return adm_sum_cube_s_avx512(x, w, h, stride, border_factor);
+#endif
+    if (flags & VMAF_X86_CPU_FLAG_AVX2)
+        return adm_sum_cube_s_avx2(x, w, h, stride, border_factor);
+#endif
+
     int px_stride = stride / sizeof(float);
     int left   = w * border_factor - 0.5;
     int top    = h * border_factor - 0.5;
@@ -106,6 +124,26 @@ void adm_decouple_s(const adm_dwt_band_t_s *ref, const adm_dwt_band_t_s *dis,
         int ref_stride, int dis_stride, int r_stride, int a_stride,
         double border_factor, double adm_enhn_gain_limit)
 {
+#if ARCH_X86 && defined(ADM_OPT_AVOID_ATAN) && defined(ADM_OPT_RECIP_DIVISION)
+	/* The SIMD kernels scale by the gain limit in single precision, which
+	 * rounds the same as the double product only for a float-exact limit. */
+	const unsigned flags = vmaf_get_cpu_flags();
+	if ((double)(float)adm_enhn_gain_limit == adm_enhn_gain_limit) {
+#if HAVE_AVX512
+		if (flags & VMAF_X86_CPU_FLAG_AVX512) {
+			adm_decouple_s_avx512(ref, dis, r, a, w, h, ref_stride, dis_stride,
+					r_stride, a_stride, border_factor, adm_enhn_gain_limit);
+			return;
+		}
+#endif
+		if (flags & VMAF_X86_CPU_FLAG_AVX2) {
+			adm_decouple_s_avx2(ref, dis, r, a, w, h, ref_stride, dis_stride,
+					r_stride, a_stride, border_factor, adm_enhn_gain_limit);
+			return;
+		}
+	}
+#endif
+
 #ifdef ADM_OPT_AVOID_ATAN
 	const float cos_1deg_sq = cos(1.0 * M_PI / 180.0) * cos(1.0 * M_PI / 180.0);
 #endif
@@ -237,6 +275,20 @@ void adm_decouple_s(const adm_dwt_band_t_s *ref, const adm_dwt_band_t_s *dis,
 
 void adm_csf_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *dst, const adm_dwt_band_t_s *flt, int orig_h, int scale, int w, int h, int src_stride, int dst_stride, double border_factor)
 {
+#if ARCH_X86
+	const unsigned flags = vmaf_get_cpu_flags();
+#if HAVE_AVX512
+	if (flags & VMAF_X86_CPU_FLAG_AVX512) {
+		adm_csf_s_avx512(src, dst, flt, orig_h, scale, w, h, src_stride, dst_stride, border_factor);
+		return;
+	}
+#endif
+	if (flags & VMAF_X86_CPU_FLAG_AVX2) {
+		adm_csf_s_avx2(src, dst, flt, orig_h, scale, w, h, src_stride, dst_stride, border_factor);
+		return;
+	}
+#endif
+
 	const float *src_angles[3] = { src->band_h, src->band_v, src->band_d };
 	float *dst_angles[3] = { dst->band_h, dst->band_v, dst->band_d };
 	float *flt_angles[3] = { flt->band_h, flt->band_v, flt->band_d };
@@ -297,6 +349,16 @@ void adm_csf_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *dst, const a
 /* Combination of adm_csf_s and adm_sum_cube_s for csf_o based den_scale */
 float adm_csf_den_scale_s(const adm_dwt_band_t_s *src, int orig_h, int scale, int w, int h, int src_stride, double border_factor)
 {
+#if ARCH_X86
+	const unsigned flags = vmaf_get_cpu_flags();
+#if HAVE_AVX512
+	if (flags & VMAF_X86_CPU_FLAG_AVX512)
+		return adm_csf_den_scale_s_avx512(src, orig_h, scale, w, h, src_stride, border_factor);
+#endif
+	if (flags & VMAF_X86_CPU_FLAG_AVX2)
+		return adm_csf_den_scale_s_avx2(src, orig_h, scale, w, h, src_stride, border_factor);
+#endif
+
 	float *src_h = src->band_h, *src_v = src->band_v, *src_d = src->band_d;
 
 	int src_px_stride = src_stride / sizeof(float);
@@ -355,6 +417,43 @@ float adm_csf_den_scale_s(const adm_dwt_band_t_s *src, int orig_h, int scale, in
 
 }
 
+/* Accumulates columns [start_col, end_col) of an interior row i of adm_cm_s */
+static void adm_cm_row_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *csf_f, const adm_dwt_band_t_s *csf_a, const float *rfactor, int i, int start_col, int end_col, int src_px_stride, int csf_px_stride, float *accum_h, float *accum_v, float *accum_d)
+{
+	const float *angles[3] = { csf_a->band_h, csf_a->band_v, csf_a->band_d };
+	const float *flt_angles[3] = { csf_f->band_h, csf_f->band_v, csf_f->band_d };
+
+	float xh, xv, xd, thr;
+	float val;
+	float accum_inner_h = *accum_h, accum_inner_v = *accum_v, accum_inner_d = *accum_d;
+
+	for (int j = start_col; j < end_col; ++j) {
+		xh = src->band_h[i * src_px_stride + j] * rfactor[0];
+		xv = src->band_v[i * src_px_stride + j] * rfactor[1];
+		xd = src->band_d[i * src_px_stride + j] * rfactor[2];
+		ADM_CM_THRESH_S_I_J(angles, flt_angles, csf_px_stride, &thr, 0, 0, i, j);
+
+		xh = fabsf(xh) - thr;
+		xv = fabsf(xv) - thr;
+		xd = fabsf(xd) - thr;
+
+		xh = xh < 0.0f ? 0.0f : xh;
+		xv = xv < 0.0f ? 0.0f : xv;
+		xd = xd < 0.0f ? 0.0f : xd;
+
+		val = (xh * xh * xh);
+		accum_inner_h += val;
+		val = (xv * xv * xv);
+		accum_inner_v += val;
+		val = (xd * xd * xd);
+		accum_inner_d += val;
+	}
+
+	*accum_h = accum_inner_h;
+	*accum_v = accum_inner_v;
+	*accum_d = accum_inner_d;
+}
+
 float adm_cm_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *csf_f, const adm_dwt_band_t_s *csf_a, int w, int h, int src_stride, int flt_stride, int csf_a_stride, double border_factor, int scale)
 {
 	/* Take decouple_r as src and do dsf_s on decouple_r here to get csf_r */
@@ -369,6 +468,17 @@ float adm_cm_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *csf_f, const
 	const float *angles[3] = { csf_a->band_h, csf_a->band_v, csf_a->band_d };
 	const float *flt_angles[3] = { csf_f->band_h, csf_f->band_v, csf_f->band_d };
 
+	void (*cm_row)(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *csf_f, const adm_dwt_band_t_s *csf_a, const float *rfactor, int i, int start_col, int end_col, int src_px_stride, int csf_px_stride, float *accum_h, float *accum_v, float *accum_d) = adm_cm_row_s;
+#if ARCH_X86
+	const unsigned flags = vmaf_get_cpu_flags();
+	if (flags & VMAF_X86_CPU_FLAG_AVX2)
+		cm_row = adm_cm_row_s_avx2;
+#if HAVE_AVX512
+	if (flags & VMAF_X86_CPU_FLAG_AVX512)
+		cm_row = adm_cm_row_s_avx512;
+#endif
+#endif
+
 	int src_px_stride = src_stride / sizeof(float);
 	int flt_px_stride = flt_stride / sizeof(float);
 	int csf_px_stride = csf_a_stride / sizeof(float);
@@ -482,28 +592,8 @@ float adm_cm_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *csf_f, const
 			accum_inner_h = 0;
 			accum_inner_v = 0;
 			accum_inner_d = 0;
-		for (j = start_col; j < end_col; ++j) {
-				xh = src->band_h[i * src_px_stride + j] * rfactor[0];
-				xv = src->band_v[i * src_px_stride + j] * rfactor[1];
-				xd = src->band_d[i * src_px_stride + j] * rfactor[2];
-				ADM_CM_THRESH_S_I_J(angles, flt_angles, csf_px_stride, &thr, w, h, i, j);
-
-			xh = fabsf(xh) - thr;
-			xv = fabsf(xv) - thr;
-			xd = fabsf(xd) - thr;
-
-			xh = xh < 0.0f ? 0.0f : xh;
-			xv = xv < 0.0f ? 0.0f : xv;
-			xd = xd < 0.0f ? 0.0f : xd;
-
-			val = (xh * xh * xh);
-			accum_inner_h += val;
-			val = (xv * xv * xv);
-			accum_inner_v += val;
-			val = (xd * xd * xd);
-			accum_inner_d += val;
-
-		}
+			cm_row(src, csf_f, csf_a, rfactor, i, start_col, end_col, src_px_stride,
+					csf_px_stride, &accum_inner_h, &accum_inner_v, &accum_inner_d);
 			accum_h += accum_inner_h;
 			accum_v += accum_inner_v;
 			accum_d += accum_inner_d;
@@ -539,28 +629,8 @@ float adm_cm_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *csf_f, const
 			accum_inner_d += val;
 
 			/* j within frame */
-			for (j = start_col; j < end_col; ++j) {
-				xh = src->band_h[i * src_px_stride + j] * rfactor[0];
-				xv = src->band_v[i * src_px_stride + j] * rfactor[1];
-				xd = src->band_d[i * src_px_stride + j] * rfactor[2];
-				ADM_CM_THRESH_S_I_J(angles, flt_angles, csf_px_stride, &thr, w, h, i, j);
-
-				xh = fabsf(xh) - thr;
-				xv = fabsf(xv) - thr;
-				xd = fabsf(xd) - thr;
-
-				xh = xh < 0.0f ? 0.0f : xh;
-				xv = xv < 0.0f ? 0.0f : xv;
-				xd = xd < 0.0f ? 0.0f : xd;
-
-				val = (xh * xh * xh);
-				accum_inner_h += val;
-				val = (xv * xv * xv);
-				accum_inner_v += val;
-				val = (xd * xd * xd);
-				accum_inner_d += val;
-
-			}
+			cm_row(src, csf_f, csf_a, rfactor, i, start_col, end_col, src_px_stride,
+					csf_px_stride, &accum_inner_h, &accum_inner_v, &accum_inner_d);
 	accum_h += accum_inner_h;
 	accum_v += accum_inner_v;
 	accum_d += accum_inner_d;
@@ -573,28 +643,8 @@ float adm_cm_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *csf_f, const
 			accum_inner_v = 0;
 			accum_inner_d = 0;
 			/* j within frame */
-			for (j = start_col; j < end_col; ++j) {
-				xh = src->band_h[i * src_px_stride + j] * rfactor[0];
-				xv = src->band_v[i * src_px_stride + j] * rfactor[1];
-				xd = src->band_d[i * src_px_stride + j] * rfactor[2];
-				ADM_CM_THRESH_S_I_J(angles, flt_angles, csf_px_stride, &thr, w, h, i, j);
-
-				xh = fabsf(xh) - thr;
-				xv = fabsf(xv) - thr;
-				xd = fabsf(xd) - thr;
-
-				xh = xh < 0.0f ? 0.0f : xh;
-				xv = xv < 0.0f ? 0.0f : xv;
-				xd = xd < 0.0f ? 0.0f : xd;
-
-				val = (xh * xh * xh);
-				accum_inner_h += val;
-				val = (xv * xv * xv);
-				accum_inner_v += val;
-				val = (xd * xd * xd);
-				accum_inner_d += val;
-
-			}
+			cm_row(src, csf_f, csf_a, rfactor, i, start_col, end_col, src_px_stride,
+					csf_px_stride, &accum_inner_h, &accum_inner_v, &accum_inner_d);
 			/* j = w-1 */
 			xh = src->band_h[i * src_px_stride + w - 1] * rfactor[0];
 			xv = src->band_v[i * src_px_stride + w - 1] * rfactor[1];
@@ -650,28 +700,8 @@ float adm_cm_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *csf_f, const
 			accum_inner_d += val;
 
 			/* j within frame */
-			for (j = start_col; j < end_col; ++j) {
-				xh = src->band_h[i * src_px_stride + j] * rfactor[0];
-				xv = src->band_v[i * src_px_stride + j] * rfactor[1];
-				xd = src->band_d[i * src_px_stride + j] * rfactor[2];
-				ADM_CM_THRESH_S_I_J(angles, flt_angles, csf_px_stride, &thr, w, h, i, j);
-
-				xh = fabsf(xh) - thr;
-				xv = fabsf(xv) - thr;
-				xd = fabsf(xd) - thr;
-
-				xh = xh < 0.0f ? 0.0f : xh;
-				xv = xv < 0.0f ? 0.0f : xv;
-				xd = xd < 0.0f ? 0.0f : xd;
-
-				val = (xh * xh * xh);
-				accum_inner_h += val;
-				val = (xv * xv * xv);
-				accum_inner_v += val;
-				val = (xd * xd * xd);
-				accum_inner_d += val;
-
-			}
+			cm_row(src, csf_f, csf_a, rfactor, i, start_col, end_col, src_px_stride,
+					csf_px_stride, &accum_inner_h, &accum_inner_v, &accum_inner_d);
 			/* j = w-1 */
 			xh = src->band_h[i * src_px_stride + w - 1] * rfactor[0];
 			xv = src->band_v[i * src_px_stride + w - 1] * rfactor[1];
@@ -839,16 +869,29 @@ void dwt2_src_indices_filt_s(int **src_ind_y, int **src_ind_x, int w, int h)
 	}
 }
 
-void adm_dwt2_s(const float *src, const adm_dwt_band_t_s *dst, int **ind_y, int **ind_x, int w, int h, int src_stride, int dst_stride)
+// tmplo and tmphi each hold one row of w floats.
+void adm_dwt2_s(const float *src, const adm_dwt_band_t_s *dst, int **ind_y, int **ind_x, int w, int h, int src_stride, int dst_stride, float *tmplo, float *tmphi)
 {
+#if ARCH_X86
+	const unsigned flags = vmaf_get_cpu_flags();
+#if HAVE_AVX512
+	if (flags & VMAF_X86_CPU_FLAG_AVX512) {
+		adm_dwt2_s_avx512(src, dst, ind_y, ind_x, w, h, src_stride, dst_stride, tmplo, tmphi);
+		return;
+	}
+#endif
+	if (flags & VMAF_X86_CPU_FLAG_AVX2) {
+		adm_dwt2_s_avx2(src, dst, ind_y, ind_x, w, h, src_stride, dst_stride, tmplo, tmphi);
+		return;
+	}
+#endif
+
 	const float *filter_lo = dwt2_db2_coeffs_lo_s;
 	const float *filter_hi = dwt2_db2_coeffs_hi_s;
 
 	int src_px_stride = src_stride / sizeof(float);
 	int dst_px_stride = dst_stride / sizeof(float);
 
-	float *tmplo = aligned_malloc(ALIGN_CEIL(sizeof(float) * w), MAX_ALIGN);
-	float *tmphi = aligned_malloc(ALIGN_CEIL(sizeof(float) * w), MAX_ALIGN);
 	float s0, s1, s2, s3;
 	float accum;
 
@@ -924,9 +967,6 @@ void adm_dwt2_s(const float *src, const adm_dwt_band_t_s *dst, int **ind_y, int
 
 		}
 	}
-
-	aligned_free(tmplo);
-	aligned_free(tmphi);
 }
 
 void adm_dwt2_d(const double *src, const adm_dwt_band_t_d *dst, int **ind_y, int **ind_x, int w, int h, int src_stride, int dst_stride)
@@ -16,8 +16,10 @@
  *
  */
 
-#define M_PI 3.14159265358979323846264338327
 #include <math.h>
+#ifndef M_PI
+#define M_PI 3.14159265358979323846264338327
+#endif // M_PI
 #include "common/macros.h"
 
 #pragma once
@@ -31,8 +33,8 @@
 	*accum = 0; \
 	for (int theta = 0; theta < 3; ++theta) { \
 			float sum = 0; \
-		float *src_ptr = angles[theta]; \
-			float *flt_ptr = flt_angles[theta]; \
+		const float *src_ptr = angles[theta]; \
+			const float *flt_ptr = flt_angles[theta]; \
 			sum += flt_ptr[src_px_stride + 1]; \
 			sum += flt_ptr[src_px_stride]; \
 			sum += flt_ptr[src_px_stride + 1]; \
@@ -51,8 +53,8 @@
 { \
 	*accum = 0; \
 	for (int theta = 0; theta < 3; ++theta) { \
-		float *src_ptr = angles[theta]; \
-			float *flt_ptr = flt_angles[theta]; \
+		const float *src_ptr = angles[theta]; \
+			const float *flt_ptr = flt_angles[theta]; \
 			float sum = 0; \
 			sum += flt_ptr[src_px_stride + w - 2]; \
 			sum += flt_ptr[src_px_stride + w - 1]; \
@@ -73,8 +75,8 @@
 	*accum = 0; \
 	for (int theta = 0; theta < 3; ++theta) { \
 			float sum = 0; \
-		float *src_ptr = angles[theta]; \
-			float *flt_ptr = flt_angles[theta]; \
+		const float *src_ptr = angles[theta]; \
+			const float *flt_ptr = flt_angles[theta]; \
 			sum += flt_ptr[src_px_stride + j - 1]; \
 			sum += flt_ptr[src_px_stride + j]; \
 			sum += flt_ptr[src_px_stride + j + 1]; \
@@ -94,8 +96,8 @@
 	*accum = 0; \
 	for (int theta = 0; theta < 3; ++theta) { \
 			float sum = 0; \
-		float *src_ptr = angles[theta]; \
-			float *flt_ptr = flt_angles[theta]; \
+		const float *src_ptr = angles[theta]; \
+			const float *flt_ptr = flt_angles[theta]; \
 		src_ptr += (src_px_stride * (h - 2)); \
 			flt_ptr += (src_px_stride * (h - 2)); \
 			sum += flt_ptr[1]; \
@@ -118,8 +120,8 @@
 { \
 	*accum = 0; \
 	for (int theta = 0; theta < 3; ++theta) { \
-		float *src_ptr = angles[theta]; \
-			float *flt_ptr = flt_angles[theta]; \
+		const float *src_ptr = angles[theta]; \
+			const float *flt_ptr = flt_angles[theta]; \
 			float sum = 0; \
 		src_ptr += (src_px_stride * (h - 2)); \
 			flt_ptr += (src_px_stride * (h - 2)); \
@@ -143,8 +145,8 @@
 { \
 	*accum = 0; \
 	for (int theta = 0; theta < 3; ++theta) { \
-		float *src_ptr = angles[theta]; \
-			float *flt_ptr = flt_angles[theta]; \
+		const float *src_ptr = angles[theta]; \
+			const float *flt_ptr = flt_angles[theta]; \
 			float sum = 0; \
 		src_ptr += (src_px_stride * (h - 2)); \
 			flt_ptr += (src_px_stride * (h - 2)); \
@@ -169,8 +171,8 @@
 	*accum = 0; \
 	for (int theta = 0; theta < 3; ++theta) { \
 			float sum = 0; \
-			float *src_ptr = angles[theta]; \
-			float *flt_ptr = flt_angles[theta]; \
+			const float *src_ptr = angles[theta]; \
+			const float *flt_ptr = flt_angles[theta]; \
 			src_ptr += (src_px_stride * (i - 1)); \
 			flt_ptr += (src_px_stride * (i - 1)); \
 			sum += flt_ptr[j - 1]; \
@@ -195,8 +197,8 @@
 { \
 	*accum = 0; \
 	for (int theta = 0; theta < 3; ++theta) { \
-			float *src_ptr = angles[theta]; \
-			float *flt_ptr = flt_angles[theta]; \
+			const float *src_ptr = angles[theta]; \
+			const float *flt_ptr = flt_angles[theta]; \
 			float sum = 0; \
 			src_ptr += (src_px_stride * (i - 1)); \
 			flt_ptr += (src_px_stride * (i - 1)); \
@@ -223,8 +225,8 @@
 	float sum = 0; \
 	*accum = 0; \
 	for (int theta = 0; theta < 3; ++theta) { \
-		float *src_ptr = angles[theta]; \
-			float *flt_ptr = flt_angles[theta]; \
+		const float *src_ptr = angles[theta]; \
+			const float *flt_ptr = flt_angles[theta]; \
 			float sum = 0; \
 		src_ptr += (src_px_stride * (i-1)); \
 			flt_ptr += (src_px_stride * (i - 1)); \
@@ -273,7 +275,7 @@ float adm_cm_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *dst, const a
 
 void dwt2_src_indices_filt_s(int **src_ind_y, int **src_ind_x, int w, int h);
 
-void adm_dwt2_s(const float *src, const adm_dwt_band_t_s *dst, int **ind_y, int **ind_x, int w, int h, int src_stride, int dst_stride);
+void adm_dwt2_s(const float *src, const adm_dwt_band_t_s *dst, int **ind_y, int **ind_x, int w, int h, int src_stride, int dst_stride, float *tmplo, float *tmphi);
 
 void adm_dwt2_d(const double *src, const adm_dwt_band_t_d *dst, int **ind_y, int **ind_x, int w, int h, int src_stride, int dst_stride);
 
@@ -334,7 +336,7 @@ static const float dwt_7_9_basis_function_amplitudes[6][4] = {
  * lambda = 0 (finest scale), 1, 2, 3 (coarsest scale);
  * theta = 0 (ll), 1 (lh - vertical), 2 (hh - diagonal), 3(hl - horizontal).
  */
-FORCE_INLINE inline float dwt_quant_step(const struct dwt_model_params *params, int lambda, int theta)
+static FORCE_INLINE inline float dwt_quant_step(const struct dwt_model_params *params, int lambda, int theta)
 {
     // Formula (1), page 1165 - display visual resolution (DVR), in pixels/degree of visual angle. This should be 56.55
     float r = VIEW_DIST * REF_DISPLAY_HEIGHT * M_PI / 180.0;
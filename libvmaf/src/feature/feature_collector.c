@@ -17,15 +17,57 @@
  */
 
 #include <errno.h>
+#include <limits.h>
 #include <pthread.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 #include "feature_collector.h"
 
-static int feature_vector_init(FeatureVector **const feature_vector,
-                               const char *name)
+/* Position of the highest set bit, `x` has to be non-zero. */
+static inline unsigned bit_scan_reverse(unsigned x)
+{
+#if defined(_MSC_VER)
+    unsigned long i;
+    _BitScanReverse(&i, x);
+    return i;
+#else
+    return 31 - __builtin_clz(x);
+#endif
+}
+
+static unsigned feature_vector_bucket_size(unsigned bucket)
+{
+    return bucket ? 4u << bucket : 8;
+}
+
+static unsigned feature_vector_bucket(unsigned index, unsigned *offset)
+{
+    if (index < 8) {
+        *offset = index;
+        return 0;
+    }
+
+    const unsigned bucket = bit_scan_reverse(index) - 2;
+    *offset = index - (4u << bucket);
+    return bucket;
+}
+
+/* Indices up to the end of `bucket`, the last bucket ends at 1 << 32. */
+static unsigned feature_vector_bucket_end(unsigned bucket)
+{
+    return bucket + 1 < FEATURE_VECTOR_BUCKETS ? 8u << bucket : UINT_MAX;
+}
+
+static int feature_vector_init_ring(FeatureVector **const feature_vector,
+                                    const char *name, unsigned window,
+                                    VmafFeatureSpill spill, void *user_data)
 {
     if (!feature_vector) return -EINVAL;
     if (!name) return -EINVAL;
@@ -36,12 +78,21 @@ static int feature_vector_init(FeatureVector **const feature_vector,
     fv->name = malloc(strlen(name) + 1);
     if (!fv->name) goto free_fv;
     strcpy(fv->name, name);
-    fv->capacity = 8;
-    fv->score = malloc(sizeof(fv->score[0]) * fv->capacity);
-    if (!fv->score) goto free_name;
-    memset(fv->score, 0, sizeof(fv->score[0]) * fv->capacity);
+    fv->ring = window > 0;
+    const unsigned capacity = fv->ring ? window : feature_vector_bucket_size(0);
+    atomic_init(&fv->capacity, capacity);
+    atomic_init(&fv->index_end, 0);
+    fv->spill.func = spill;
+    fv->spill.user_data = user_data;
+    fv->bucket[0] = malloc(sizeof(*fv->bucket[0]) * capacity);
+    if (!fv->bucket[0]) goto free_name;
+    memset(fv->bucket[0], 0, sizeof(*fv->bucket[0]) * capacity);
+    atomic_init(&fv->bucket_cnt, 1);
+    if (pthread_mutex_init(&fv->lock, NULL)) goto free_bucket;
     return 0;
 
+free_bucket:
+    free(fv->bucket[0]);
 free_name:
     free(fv->name);
 free_fv:
@@ -54,34 +105,150 @@ static void feature_vector_destroy(FeatureVector *feature_vector)
 {
     if (!feature_vector) return;
     free(feature_vector->name);
-    free(feature_vector->score);
+    for (unsigned i = 0; i < FEATURE_VECTOR_BUCKETS; i++)
+        free(feature_vector->bucket[i]);
+    pthread_mutex_destroy(&feature_vector->lock);
     free(feature_vector);
 }
 
+static FeatureSlot *feature_vector_find_slot(FeatureVector *feature_vector,
+                                             unsigned index)
+{
+    FeatureVector *const fv = feature_vector;
+
+    if (fv->ring)
+        return &fv->bucket[0][index % atomic_load(&fv->capacity)];
+
+    unsigned offset;
+    const unsigned b = feature_vector_bucket(index, &offset);
+    if (b >= atomic_load(&fv->bucket_cnt)) return NULL;
+    return &fv->bucket[b][offset];
+}
+
+/* Buckets are allocated in order under the vector lock, and published by
+ * raising `bucket_cnt` once their pointer is stored. */
+static FeatureSlot *feature_vector_alloc_slot(FeatureVector *feature_vector,
+                                              unsigned index)
+{
+    FeatureVector *const fv = feature_vector;
+
+    FeatureSlot *slot = feature_vector_find_slot(fv, index);
+    if (slot) return slot;
+
+    unsigned offset;
+    const unsigned b = feature_vector_bucket(index, &offset);
+
+    pthread_mutex_lock(&fv->lock);
+    for (unsigned i = atomic_load(&fv->bucket_cnt); i <= b; i++) {
+        const unsigned size = feature_vector_bucket_size(i);
+        FeatureSlot *bucket = malloc(sizeof(*bucket) * size);
+        if (!bucket) break;
+        memset(bucket, 0, sizeof(*bucket) * size);
+        fv->bucket[i] = bucket;
+        atomic_store(&fv->capacity, feature_vector_bucket_end(i));
+        atomic_store(&fv->bucket_cnt, i + 1);
+    }
+    pthread_mutex_unlock(&fv->lock);
+
+    return feature_vector_find_slot(fv, index);
+}
+
+static void feature_vector_raise_index_end(FeatureVector *feature_vector,
+                                           unsigned index)
+{
+    unsigned end = atomic_load(&feature_vector->index_end);
+    while (index >= end &&
+           !atomic_compare_exchange_strong(&feature_vector->index_end, &end,
+                                           index + 1));
+}
+
+static void feature_vector_accumulate(FeatureVector *feature_vector,
+                                      double score)
+{
+    FeatureVector *const fv = feature_vector;
+
+    if (!fv->running.cnt || score < fv->running.min)
+        fv->running.min = score;
+    if (!fv->running.cnt || score > fv->running.max)
+        fv->running.max = score;
+    fv->running.sum += score;
+    fv->running.i_sum += 1. / (score + 1.);
+    fv->running.cnt++;
+}
+
+static void feature_vector_spill(FeatureVector *feature_vector,
+                                 unsigned index, double score)
+{
+    if (!feature_vector->spill.func) return;
+    feature_vector->spill.func(feature_vector->spill.user_data,
+                               feature_vector->name, index, score);
+}
+
+/* A slot holds `index % capacity`. Writing a newer index evicts the older
+ * occupant, a score older than the occupant is spilled right away. Must be
+ * called with the collector locked. */
+static int feature_vector_append_ring(FeatureVector *feature_vector,
+                                      unsigned index, double score)
+{
+    FeatureVector *const fv = feature_vector;
+    FeatureSlot *const slot = feature_vector_find_slot(fv, index);
+
+    if (atomic_load(&slot->state)) {
+        if (slot->index == index)
+            return -EINVAL;
+        if (slot->index > index) {
+            feature_vector_accumulate(fv, score);
+            feature_vector_spill(fv, index, score);
+            return 0;
+        }
+        feature_vector_spill(fv, slot->index, slot->value);
+    }
+
+    slot->value = score;
+    slot->index = index;
+    atomic_store(&slot->state, FEATURE_SLOT_WRITTEN);
+    feature_vector_accumulate(fv, score);
+    feature_vector_raise_index_end(fv, index);
+
+    return 0;
+}
+
 static int feature_vector_append(FeatureVector *feature_vector,
                                  unsigned index, double score)
 {
     if (!feature_vector) return -EINVAL;
 
-    while (index >= feature_vector->capacity) {
-        size_t initial_size =
-            sizeof(feature_vector->score[0]) * feature_vector->capacity;
-        void *score = realloc(feature_vector->score, initial_size * 2);
-        if (!score) return -ENOMEM;
-        memset(score + initial_size, 0, initial_size);
-        feature_vector->score = score;
-        feature_vector->capacity *= 2;
-    }
+    if (feature_vector->ring)
+        return feature_vector_append_ring(feature_vector, index, score);
+
+    FeatureSlot *slot = feature_vector_alloc_slot(feature_vector, index);
+    if (!slot) return -ENOMEM;
 
-    if (feature_vector->score[index].written)
+    int state = FEATURE_SLOT_EMPTY;
+    if (!atomic_compare_exchange_strong(&slot->state, &state, FEATURE_SLOT_BUSY))
         return -EINVAL;
 
-    feature_vector->score[index].written = true;
-    feature_vector->score[index].value = score;
+    slot->value = score;
+    atomic_store(&slot->state, FEATURE_SLOT_WRITTEN);
+    feature_vector_raise_index_end(feature_vector, index);
 
     return 0;
 }
 
+bool feature_vector_get_score(FeatureVector *feature_vector,
+                              unsigned index, double *score)
+{
+    FeatureSlot *slot = feature_vector_find_slot(feature_vector, index);
+    if (!slot) return false;
+    if (atomic_load(&slot->state) != FEATURE_SLOT_WRITTEN)
+        return false;
+    if (feature_vector->ring && slot->index != index)
+        return false;
+
+    *score = slot->value;
+    return true;
+}
+
 int vmaf_feature_collector_init(VmafFeatureCollector **const feature_collector)
 {
     if (!feature_collector) return -EINVAL;
@@ -89,84 +256,216 @@ int vmaf_feature_collector_init(VmafFeatureCollector **const feature_collector)
     VmafFeatureCollector *const fc = *feature_collector = malloc(sizeof(*fc));
     if (!fc) goto fail;
     memset(fc, 0, sizeof(*fc));
-    fc->capacity = 8;
-    fc->feature_vector = malloc(sizeof(*(fc->feature_vector)) * fc->capacity);
-    if (!fc->feature_vector) goto free_fc;
-    memset(fc->feature_vector, 0, sizeof(*(fc->feature_vector)) * fc->capacity);
+    fc->capacity = feature_vector_bucket_size(0);
+    fc->feature_vector[0] = malloc(sizeof(FeatureVector *) * fc->capacity);
+    if (!fc->feature_vector[0]) goto free_fc;
+    atomic_init(&fc->cnt, 0);
     int err = pthread_mutex_init(&(fc->lock), NULL);
     if (err) goto free_feature_vector;
     return 0;
 
 free_feature_vector:
-    free(fc->feature_vector);
+    free(fc->feature_vector[0]);
 free_fc:
     free(fc);
 fail:
     return -ENOMEM;
 }
 
+int vmaf_feature_collector_set_retention(VmafFeatureCollector *feature_collector,
+                                         unsigned window, VmafFeatureSpill spill,
+                                         void *user_data)
+{
+    if (!feature_collector) return -EINVAL;
+
+    pthread_mutex_lock(&(feature_collector->lock));
+    int err = 0;
+
+    if (feature_collector->cnt) {
+        err = -EINVAL;
+        goto unlock;
+    }
+
+    feature_collector->retention.window = window;
+    feature_collector->retention.spill = spill;
+    feature_collector->retention.user_data = user_data;
+
+unlock:
+    pthread_mutex_unlock(&(feature_collector->lock));
+    return err;
+}
+
+FeatureVector *feature_collector_get_vector(VmafFeatureCollector *feature_collector,
+                                            unsigned id)
+{
+    unsigned offset;
+    const unsigned b = feature_vector_bucket(id, &offset);
+    return feature_collector->feature_vector[b][offset];
+}
+
+/* Must be called with the collector locked. */
 static FeatureVector *find_feature_vector(VmafFeatureCollector *fc,
-                                          char *feature_name)
+                                          const char *feature_name,
+                                          unsigned *id)
 {
-    FeatureVector *feature_vector = NULL;
-    for (unsigned i = 0; i < fc->cnt; i++) {
-        FeatureVector *fv = fc->feature_vector[i];
+    const unsigned cnt = atomic_load(&fc->cnt);
+
+    for (unsigned i = 0; i < cnt; i++) {
+        FeatureVector *fv = feature_collector_get_vector(fc, i);
         if (!strcmp(fv->name, feature_name)) {
-            feature_vector = fv;
-            break;
+            if (id) *id = i;
+            return fv;
         }
     }
-    return feature_vector;
+    return NULL;
 }
 
-int vmaf_feature_collector_append(VmafFeatureCollector *feature_collector,
-                                  char *feature_name, double score,
-                                  unsigned picture_index)
+/* Feature ids are bucketed like the slots of a feature vector, so that
+ * readers outside of the lock never see an array move. Must be called with
+ * the collector locked. */
+static int feature_collector_grow(VmafFeatureCollector *fc)
+{
+    if (fc->capacity == UINT_MAX) return -ENOMEM;
+    unsigned offset;
+    const unsigned b = feature_vector_bucket(fc->capacity, &offset);
+
+    const size_t sz = sizeof(FeatureVector *) * feature_vector_bucket_size(b);
+    fc->feature_vector[b] = malloc(sz);
+    if (!fc->feature_vector[b]) return -ENOMEM;
+    fc->capacity = feature_vector_bucket_end(b);
+    return 0;
+}
+
+/* Must be called with the collector locked. */
+static int register_feature(VmafFeatureCollector *fc, const char *feature_name,
+                            unsigned *id)
+{
+    if (find_feature_vector(fc, feature_name, id))
+        return 0;
+
+    FeatureVector *fv;
+    int err = feature_vector_init_ring(&fv, feature_name, fc->retention.window,
+                                       fc->retention.spill,
+                                       fc->retention.user_data);
+    if (err) return err;
+
+    const unsigned cnt = atomic_load(&fc->cnt);
+    if (cnt + 1 > fc->capacity) {
+        err = feature_collector_grow(fc);
+        if (err) {
+            feature_vector_destroy(fv);
+            return err;
+        }
+    }
+
+    unsigned offset;
+    const unsigned b = feature_vector_bucket(cnt, &offset);
+    fc->feature_vector[b][offset] = fv;
+    atomic_store(&fc->cnt, cnt + 1);
+    *id = cnt;
+    return 0;
+}
+
+int vmaf_feature_collector_register(VmafFeatureCollector *feature_collector,
+                                    const char *feature_name, unsigned *id)
 {
     if (!feature_collector) return -EINVAL;
     if (!feature_name) return -EINVAL;
+    if (!id) return -EINVAL;
 
-    pthread_mutex_lock(&(feature_collector->lock));
-    int err = 0;
+    VmafFeatureCollector *const fc = feature_collector;
+    pthread_mutex_lock(&(fc->lock));
+    if (!fc->timer.begin)
+        fc->timer.begin = clock();
+    int err = register_feature(fc, feature_name, id);
+    pthread_mutex_unlock(&(fc->lock));
+    return err;
+}
 
-    if (!feature_collector->timer.begin)
-        feature_collector->timer.begin = clock();
+int vmaf_feature_collector_register_list(VmafFeatureCollector *feature_collector,
+                                         VmafFeatureCollector **interned,
+                                         const char *const *feature_name,
+                                         unsigned *id, unsigned cnt)
+{
+    if (!feature_collector) return -EINVAL;
+    if (!interned) return -EINVAL;
+    if (!feature_name) return -EINVAL;
+    if (!id) return -EINVAL;
 
-    FeatureVector *feature_vector =
-        find_feature_vector(feature_collector, feature_name);
+    if (*interned == feature_collector) return 0;
 
-    if (!feature_vector) {
-        err = feature_vector_init(&feature_vector, feature_name);
-        if (err) goto unlock;
-        if (feature_collector->cnt + 1 > feature_collector->capacity) {
-            size_t initial_size = sizeof(feature_collector->feature_vector[0]) *
-                feature_vector->capacity;
-            FeatureVector **fv =
-                realloc(feature_collector->feature_vector,
-                sizeof(*(feature_collector->feature_vector)) *
-                initial_size * 2);
-            if (!fv) {
-                err = -ENOMEM;
-                goto unlock;
-            }
-            memset(fv + feature_collector->capacity, 0, initial_size);
-            feature_collector->feature_vector = fv;
-            feature_collector->capacity *= 2;
+    VmafFeatureCollector *const fc = feature_collector;
+    pthread_mutex_lock(&(fc->lock));
+    int err = 0;
+
+    if (!fc->timer.begin)
+        fc->timer.begin = clock();
+
+    for (unsigned i = 0; i < cnt; i++) {
+        if (!feature_name[i]) {
+            err = -EINVAL;
+            goto unlock;
         }
-        feature_collector->feature_vector[feature_collector->cnt++]
-            = feature_vector;
+        err = register_feature(fc, feature_name[i], &id[i]);
+        if (err) goto unlock;
     }
-
-    err = feature_vector_append(feature_vector, picture_index, score);
+    *interned = fc;
 
 unlock:
-    feature_collector->timer.end = clock();
+    pthread_mutex_unlock(&(fc->lock));
+    return err;
+}
+
+int vmaf_feature_collector_lookup(VmafFeatureCollector *feature_collector,
+                                  const char *feature_name, unsigned *id)
+{
+    if (!feature_collector) return -EINVAL;
+    if (!feature_name) return -EINVAL;
+    if (!id) return -EINVAL;
+
+    pthread_mutex_lock(&(feature_collector->lock));
+    FeatureVector *fv =
+        find_feature_vector(feature_collector, feature_name, id);
     pthread_mutex_unlock(&(feature_collector->lock));
+    return fv ? 0 : -EINVAL;
+}
+
+int vmaf_feature_collector_append_id(VmafFeatureCollector *feature_collector,
+                                     unsigned id, double score, unsigned index)
+{
+    if (!feature_collector) return -EINVAL;
+
+    VmafFeatureCollector *const fc = feature_collector;
+    if (id >= atomic_load(&fc->cnt)) return -EINVAL;
+    FeatureVector *fv = feature_collector_get_vector(fc, id);
+
+    int err = 0;
+    if (fv->ring) {
+        pthread_mutex_lock(&(fc->lock));
+        err = feature_vector_append(fv, index, score);
+        pthread_mutex_unlock(&(fc->lock));
+    } else {
+        err = feature_vector_append(fv, index, score);
+    }
+
     return err;
 }
 
+int vmaf_feature_collector_append(VmafFeatureCollector *feature_collector,
+                                  char *feature_name, double score,
+                                  unsigned picture_index)
+{
+    unsigned id;
+    int err = vmaf_feature_collector_register(feature_collector, feature_name,
+                                              &id);
+    if (err) return err;
+
+    return vmaf_feature_collector_append_id(feature_collector, id, score,
+                                            picture_index);
+}
+
 int vmaf_feature_collector_get_score(VmafFeatureCollector *feature_collector,
-                                     char *feature_name, double *score,
+                                     const char *feature_name, double *score,
                                      unsigned index)
 {
     if (!feature_collector) return -EINVAL;
@@ -177,33 +476,144 @@ int vmaf_feature_collector_get_score(VmafFeatureCollector *feature_collector,
     int err = 0;
 
     FeatureVector *feature_vector =
-        find_feature_vector(feature_collector, feature_name);
+        find_feature_vector(feature_collector, feature_name, NULL);
 
-    if (!feature_vector || index >= feature_vector->capacity) {
+    if (!feature_vector ||
+        !feature_vector_get_score(feature_vector, index, score))
+    {
         err = -EINVAL;
-        goto unlock;
     }
 
-    if (!feature_vector->score[index].written) {
+    pthread_mutex_unlock(&(feature_collector->lock));
+    return err;
+}
+
+int vmaf_feature_collector_get_score_id(VmafFeatureCollector *feature_collector,
+                                        unsigned id, double *score,
+                                        unsigned index)
+{
+    if (!feature_collector) return -EINVAL;
+    if (!score) return -EINVAL;
+
+    VmafFeatureCollector *const fc = feature_collector;
+    if (id >= atomic_load(&fc->cnt)) return -EINVAL;
+    FeatureVector *fv = feature_collector_get_vector(fc, id);
+
+    bool written;
+    if (fv->ring) {
+        pthread_mutex_lock(&(fc->lock));
+        written = feature_vector_get_score(fv, index, score);
+        pthread_mutex_unlock(&(fc->lock));
+    } else {
+        written = feature_vector_get_score(fv, index, score);
+    }
+
+    return written ? 0 : -EINVAL;
+}
+
+int vmaf_feature_collector_get_running_pooled(VmafFeatureCollector *feature_collector,
+                                              const char *feature_name,
+                                              enum VmafPoolingMethod pool_method,
+                                              double *score, unsigned index_low,
+                                              unsigned index_high)
+{
+    if (!feature_collector) return -EINVAL;
+    if (!feature_name) return -EINVAL;
+    if (!score) return -EINVAL;
+    if (index_low > index_high) return -EINVAL;
+
+    pthread_mutex_lock(&(feature_collector->lock));
+    int err = 0;
+
+    FeatureVector *fv =
+        find_feature_vector(feature_collector, feature_name, NULL);
+    if (!fv || !fv->running.cnt) {
         err = -EINVAL;
         goto unlock;
     }
+    if (index_low || index_high + 1 < atomic_load(&fv->index_end)) {
+        err = -ERANGE;
+        goto unlock;
+    }
 
-    *score = feature_vector->score[index].value;
+    switch (pool_method) {
+    case VMAF_POOL_METHOD_MEAN:
+        *score = fv->running.sum / fv->running.cnt;
+        break;
+    case VMAF_POOL_METHOD_MIN:
+        *score = fv->running.min;
+        break;
+    case VMAF_POOL_METHOD_MAX:
+        *score = fv->running.max;
+        break;
+    case VMAF_POOL_METHOD_HARMONIC_MEAN:
+        *score = fv->running.cnt / fv->running.i_sum - 1.0;
+        break;
+    default:
+        err = -EINVAL;
+        break;
+    }
 
 unlock:
     pthread_mutex_unlock(&(feature_collector->lock));
     return err;
 }
 
+unsigned vmaf_feature_collector_retained_begin(VmafFeatureCollector *feature_collector)
+{
+    if (!feature_collector) return 0;
+
+    pthread_mutex_lock(&(feature_collector->lock));
+    unsigned begin = 0;
+    const unsigned window = feature_collector->retention.window;
+    for (unsigned i = 0; window && i < feature_collector->cnt; i++) {
+        FeatureVector *fv = feature_collector_get_vector(feature_collector, i);
+        const unsigned end = atomic_load(&fv->index_end);
+        if (end > window && end - window > begin)
+            begin = end - window;
+    }
+    pthread_mutex_unlock(&(feature_collector->lock));
+
+    return begin;
+}
+
+/* Slots are cleared in place, buckets stay allocated for the next job. */
+static void feature_vector_reset(FeatureVector *feature_vector)
+{
+    FeatureVector *const fv = feature_vector;
+
+    for (unsigned i = 0; i < atomic_load(&fv->bucket_cnt); i++) {
+        const unsigned size =
+            fv->ring ? atomic_load(&fv->capacity) : feature_vector_bucket_size(i);
+        memset(fv->bucket[i], 0, sizeof(*fv->bucket[i]) * size);
+    }
+    atomic_store(&fv->index_end, 0);
+    memset(&fv->running, 0, sizeof(fv->running));
+}
+
+int vmaf_feature_collector_reset(VmafFeatureCollector *feature_collector)
+{
+    if (!feature_collector) return -EINVAL;
+
+    pthread_mutex_lock(&(feature_collector->lock));
+    for (unsigned i = 0; i < feature_collector->cnt; i++)
+        feature_vector_reset(feature_collector_get_vector(feature_collector, i));
+    feature_collector->timer.begin = clock();
+    feature_collector->timer.end = 0;
+    pthread_mutex_unlock(&(feature_collector->lock));
+
+    return 0;
+}
+
 void vmaf_feature_collector_destroy(VmafFeatureCollector *feature_collector)
 {
     if (!feature_collector) return;
 
     pthread_mutex_lock(&(feature_collector->lock));
     for (unsigned i = 0; i < feature_collector->cnt; i++)
-        feature_vector_destroy(feature_collector->feature_vector[i]);
-    free(feature_collector->feature_vector);
+        feature_vector_destroy(feature_collector_get_vector(feature_collector, i));
+    for (unsigned i = 0; i < FEATURE_VECTOR_BUCKETS; i++)
+        free(feature_collector->feature_vector[i]);
     pthread_mutex_unlock(&(feature_collector->lock));
     pthread_mutex_destroy(&(feature_collector->lock));
     free(feature_collector);
@@ -20,35 +20,158 @@
 #define __VMAF_FEATURE_COLLECTOR_H__
 
 #include <pthread.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <time.h>
 
+#include "libvmaf/libvmaf.rc.h"
+
+enum {
+    FEATURE_SLOT_EMPTY = 0,
+    FEATURE_SLOT_BUSY,
+    FEATURE_SLOT_WRITTEN,
+};
+
+typedef struct {
+    atomic_int state;
+    double value;
+    unsigned index; ///< ring mode only, index held by this slot
+} FeatureSlot;
+
+/* Bucket 0 holds indices [0, 8), bucket b > 0 holds [4 << b, 8 << b). */
+#define FEATURE_VECTOR_BUCKETS 30
+
 typedef struct {
     char *name;
+    FeatureSlot *bucket[FEATURE_VECTOR_BUCKETS]; ///< never moved, see `bucket_cnt`
+    atomic_uint bucket_cnt; ///< buckets [0, bucket_cnt) are allocated
+    atomic_uint capacity;
+    pthread_mutex_t lock; ///< serializes bucket allocation
+    bool ring; ///< a single bucket, slots are indexed modulo capacity
+    atomic_uint index_end; ///< one past the highest index written
     struct {
-        bool written;
-        double value;
-    } *score;
-    unsigned capacity;
+        unsigned cnt;
+        double sum, i_sum, min, max;
+    } running; ///< ring mode only, accumulated over every score ever written
+    struct {
+        VmafFeatureSpill func;
+        void *user_data;
+    } spill;
 } FeatureVector;
 
 typedef struct VmafFeatureCollector {
-    FeatureVector **feature_vector;
-    unsigned cnt, capacity;
+    FeatureVector **feature_vector[FEATURE_VECTOR_BUCKETS]; ///< by feature id, bucketed like slots
+    atomic_uint cnt; ///< registered feature ids
+    unsigned capacity;
     struct { clock_t begin, end; } timer;
+    struct {
+        unsigned window; ///< 0 retains every score
+        VmafFeatureSpill spill;
+        void *user_data;
+    } retention;
     pthread_mutex_t lock;
 } VmafFeatureCollector;
 
 int vmaf_feature_collector_init(VmafFeatureCollector **const feature_collector);
 
+/**
+ * Only retain the scores of the last `window` picture indices per feature.
+ * Older scores are passed to `spill`, if set, and dropped. Pooled statistics
+ * over every score ever written remain available through
+ * `vmaf_feature_collector_get_running_pooled()`. Must be set before the
+ * first score is appended.
+ */
+int vmaf_feature_collector_set_retention(VmafFeatureCollector *feature_collector,
+                                         unsigned window, VmafFeatureSpill spill,
+                                         void *user_data);
+
 int vmaf_feature_collector_append(VmafFeatureCollector *feature_collector,
                                   char *feature_name, double score,
                                   unsigned index);
 
+/**
+ * Intern `feature_name`, creating its feature vector if needed. The returned
+ * `id` is stable for the lifetime of the collector, feature ids are handed
+ * out in registration order.
+ */
+int vmaf_feature_collector_register(VmafFeatureCollector *feature_collector,
+                                    const char *feature_name, unsigned *id);
+
+/**
+ * Intern `cnt` feature names into `id`, under a single lock. `*interned` is
+ * set to the collector once all of them are registered, later calls with the
+ * same collector return right away. This lets extractors intern their
+ * features on every extract() and only pay for the lookup once per collector.
+ */
+int vmaf_feature_collector_register_list(VmafFeatureCollector *feature_collector,
+                                         VmafFeatureCollector **interned,
+                                         const char *const *feature_name,
+                                         unsigned *id, unsigned cnt);
+
+/**
+ * Look up the id of an already registered feature, fails with -EINVAL
+ * otherwise. Unlike `vmaf_feature_collector_register()`, this never creates
+ * a feature vector.
+ */
+int vmaf_feature_collector_lookup(VmafFeatureCollector *feature_collector,
+                                  const char *feature_name, unsigned *id);
+
+/**
+ * Append a score by feature id. Unless a retention window is set, this only
+ * locks to allocate a new bucket: slots are claimed with a single
+ * compare-and-swap, so concurrent writers of distinct indices never block
+ * each other. Writing an index twice fails with -EINVAL.
+ */
+int vmaf_feature_collector_append_id(VmafFeatureCollector *feature_collector,
+                                     unsigned id, double score, unsigned index);
+
 int vmaf_feature_collector_get_score(VmafFeatureCollector *feature_collector,
-                                     char *feature_name, double *score,
+                                     const char *feature_name, double *score,
                                      unsigned index);
 
+/**
+ * Read a score by feature id. Unless a retention window is set, this does
+ * not lock, so it is safe to call while other indices are being written.
+ */
+int vmaf_feature_collector_get_score_id(VmafFeatureCollector *feature_collector,
+                                        unsigned id, double *score,
+                                        unsigned index);
+
+/**
+ * Pool over every score ever written for `feature_name`, including those
+ * no longer retained. Only [`index_low`, `index_high`] ranges covering every
+ * index written so far can be served, other ranges fail with -ERANGE.
+ */
+int vmaf_feature_collector_get_running_pooled(VmafFeatureCollector *feature_collector,
+                                              const char *feature_name,
+                                              enum VmafPoolingMethod pool_method,
+                                              double *score, unsigned index_low,
+                                              unsigned index_high);
+
+/**
+ * Lowest picture index whose scores are still retained.
+ */
+unsigned vmaf_feature_collector_retained_begin(VmafFeatureCollector *feature_collector);
+
+/**
+ * Unlocked lookup of a registered feature id, `id` has to be below `cnt`.
+ */
+FeatureVector *feature_collector_get_vector(VmafFeatureCollector *feature_collector,
+                                            unsigned id);
+
+/**
+ * Unlocked per-index lookup, for use once writers are done (e.g. output).
+ * Returns true if `index` is written and retained.
+ */
+bool feature_vector_get_score(FeatureVector *feature_vector,
+                              unsigned index, double *score);
+
+/**
+ * Drop every score, keeping registered feature ids, the retention window and
+ * all allocated slots. No writers may be active.
+ */
+int vmaf_feature_collector_reset(VmafFeatureCollector *feature_collector);
+
 void vmaf_feature_collector_destroy(VmafFeatureCollector *feature_collector);
 
 #endif /* __VMAF_FEATURE_COLLECTOR_H__ */
@@ -188,6 +188,20 @@ int vmaf_feature_extractor_context_flush(VmafFeatureExtractorContext *fex_ctx,
     return err < 0 ? err : 0;
 }
 
+int vmaf_feature_extractor_context_reset(VmafFeatureExtractorContext *fex_ctx)
+{
+    if (!fex_ctx) return -EINVAL;
+    if (!fex_ctx->is_initialized) return 0;
+    if (!(fex_ctx->fex->flags & VMAF_FEATURE_EXTRACTOR_TEMPORAL)) return 0;
+
+    if (fex_ctx->fex->reset && !fex_ctx->is_closed)
+        return fex_ctx->fex->reset(fex_ctx->fex);
+
+    int err = vmaf_feature_extractor_context_close(fex_ctx);
+    fex_ctx->is_initialized = fex_ctx->is_closed = false;
+    return err;
+}
+
 int vmaf_feature_extractor_context_close(VmafFeatureExtractorContext *fex_ctx)
 {
     if (!fex_ctx) return -EINVAL;
@@ -370,6 +384,30 @@ int vmaf_fex_ctx_pool_flush(VmafFeatureExtractorContextPool *pool,
     return 0;
 }
 
+int vmaf_fex_ctx_pool_reset(VmafFeatureExtractorContextPool *pool)
+{
+    if (!pool) return -EINVAL;
+    if (!pool->fex_list) return -EINVAL;
+    pthread_mutex_lock(&(pool->lock));
+
+    int err = 0;
+    for (unsigned i = 0; i < pool->length; i++) {
+        VmafFeatureExtractor *fex = pool->fex_list[i].fex;
+        if (!(fex->flags & VMAF_FEATURE_EXTRACTOR_TEMPORAL))
+            continue;
+        const unsigned capacity = atomic_load(&pool->fex_list[i].capacity);
+        for (unsigned j = 0; j < capacity; j++) {
+            VmafFeatureExtractorContext *fex_ctx =
+                pool->fex_list[i].ctx_list[j].fex_ctx;
+            if (!fex_ctx) continue;
+            err |= vmaf_feature_extractor_context_reset(fex_ctx);
+        }
+    }
+
+    pthread_mutex_unlock(&(pool->lock));
+    return err;
+}
+
 int vmaf_fex_ctx_pool_destroy(VmafFeatureExtractorContextPool *pool)
 {
     if (!pool) return -EINVAL;
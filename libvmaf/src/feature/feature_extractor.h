@@ -26,6 +26,7 @@
 #include "dict.h"
 #include "feature_collector.h"
 #include "opt.h"
+#include "thread_pool.h"
 
 #include "libvmaf/picture.h"
 
@@ -73,6 +74,15 @@ typedef struct VmafFeatureExtractor {
      */
     int (*flush)(struct VmafFeatureExtractor *fex,
                  VmafFeatureCollector *feature_collector);
+    /**
+     * Reset callback. Optional.
+     * Called only when the VMAF_FEATURE_EXTRACTOR_TEMPORAL flag is set, after
+     * a flush. Drop any state carried between pictures so that the next
+     * picture may start over at index 0, keep fex->priv buffers.
+     *
+     * @param               fex self.
+     */
+    int (*reset)(struct VmafFeatureExtractor *fex);
     /**
      * Close callback. Optional, clean up fex->priv buffers here.
      *
@@ -84,6 +94,7 @@ typedef struct VmafFeatureExtractor {
     size_t priv_size; ///< sizeof private data.
     uint64_t flags; ///< Feauture extraction flags, binary or'd.
     const char **provided_features; ///< Provided feature list, NULL terminated.
+    VmafThreadPool *thread_pool; ///< Optional, shared with the VmafContext.
 } VmafFeatureExtractor;
 
 VmafFeatureExtractor *vmaf_get_feature_extractor_by_name(char *name);
@@ -116,6 +127,13 @@ int vmaf_feature_extractor_context_extract(VmafFeatureExtractorContext *fex_ctx,
 int vmaf_feature_extractor_context_flush(VmafFeatureExtractorContext *fex_ctx,
                                          VmafFeatureCollector *vfc);
 
+/**
+ * Prepare a flushed context for a new sequence of pictures. Temporal feature
+ * extractors without a reset callback are closed and initialized again on
+ * the next extraction.
+ */
+int vmaf_feature_extractor_context_reset(VmafFeatureExtractorContext *fex_ctx);
+
 int vmaf_feature_extractor_context_close(VmafFeatureExtractorContext *fex_ctx);
 
 int vmaf_feature_extractor_context_delete(VmafFeatureExtractorContext *fex_ctx);
@@ -150,6 +168,8 @@ int vmaf_fex_ctx_pool_release(VmafFeatureExtractorContextPool *pool,
 int vmaf_fex_ctx_pool_flush(VmafFeatureExtractorContextPool *pool,
                             VmafFeatureCollector *feature_collector);
 
+int vmaf_fex_ctx_pool_reset(VmafFeatureExtractorContextPool *pool);
+
 int vmaf_fex_ctx_pool_destroy(VmafFeatureExtractorContextPool *pool);
 
 int parse_options(VmafFeatureExtractorContext *fex_ctx);
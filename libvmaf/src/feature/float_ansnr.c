@@ -28,21 +28,19 @@
 
 typedef struct AnsnrState {
     size_t float_stride;
-    float *ref;
-    float *dist;
     double peak;
     double psnr_max;
+    VmafFeatureCollector *feature_collector;
+    unsigned feature_id[2];
 } AnsnrState;
 
 static int init(VmafFeatureExtractor *fex, enum VmafPixelFormat pix_fmt,
                 unsigned bpc, unsigned w, unsigned h)
 {
     AnsnrState *s = fex->priv;
+    (void) pix_fmt;
+    (void) h;
     s->float_stride = ALIGN_CEIL(w * sizeof(float));
-    s->ref = aligned_malloc(s->float_stride * h, 32);
-    if (!s->ref) goto fail;
-    s->dist = aligned_malloc(s->float_stride * h, 32);
-    if (!s->dist) goto free_ref;
 
     if (bpc == 8) {
         s->peak = 255.0;
@@ -57,17 +55,17 @@ static int init(VmafFeatureExtractor *fex, enum VmafPixelFormat pix_fmt,
         s->peak = 255.99609375;
         s->psnr_max = 108.0;
     } else {
-        goto fail;
+        return -EINVAL;
     }
 
     return 0;
-
-    free_ref:
-    free(s->ref);
-    fail:
-    return -ENOMEM;
 }
 
+static const char *feature_name[] = {
+    "float_ansnr",
+    "float_anpsnr",
+};
+
 static int extract(VmafFeatureExtractor *fex,
                    VmafPicture *ref_pic, VmafPicture *ref_pic_90,
                    VmafPicture *dist_pic, VmafPicture *dist_pic_90,
@@ -79,29 +77,26 @@ static int extract(VmafFeatureExtractor *fex,
     (void) ref_pic_90;
     (void) dist_pic_90;
 
-    picture_copy(s->ref, s->float_stride, ref_pic, -128, ref_pic->bpc);
-    picture_copy(s->dist, s->float_stride, dist_pic, -128, dist_pic->bpc);
+    const float *ref = picture_copy_shared(ref_pic, -128);
+    const float *dist = picture_copy_shared(dist_pic, -128);
+    if (!ref || !dist) return -ENOMEM;
 
     double score, score_psnr;
-    err = compute_ansnr(s->ref, s->dist, ref_pic->w[0], ref_pic->h[0],
+    err = compute_ansnr(ref, dist, ref_pic->w[0], ref_pic->h[0],
                         s->float_stride, s->float_stride, &score, &score_psnr,
                         s->peak, s->psnr_max);
 
     if (err) return err;
-    err = vmaf_feature_collector_append(feature_collector, "float_ansnr",
-                                        score, index);
+    err = vmaf_feature_collector_register_list(feature_collector,
+                                               &s->feature_collector,
+                                               feature_name, s->feature_id, 2);
     if (err) return err;
-    err = vmaf_feature_collector_append(feature_collector, "float_anpsnr",
-                                        score_psnr, index);
+    err = vmaf_feature_collector_append_id(feature_collector, s->feature_id[0],
+                                           score, index);
+    if (err) return err;
+    err = vmaf_feature_collector_append_id(feature_collector, s->feature_id[1],
+                                           score_psnr, index);
     if (err) return err;
-    return 0;
-}
-
-static int close(VmafFeatureExtractor *fex)
-{
-    AnsnrState *s = fex->priv;
-    if (s->ref) aligned_free(s->ref);
-    if (s->dist) aligned_free(s->dist);
     return 0;
 }
 
@@ -114,7 +109,6 @@ VmafFeatureExtractor vmaf_fex_float_ansnr = {
         .name = "float_ansnr",
         .init = init,
         .extract = extract,
-        .close = close,
         .priv_size = sizeof(AnsnrState),
         .provided_features = provided_features,
 };
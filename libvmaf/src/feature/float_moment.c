@@ -29,28 +29,27 @@
 
 typedef struct MomentState {
     size_t float_stride;
-    float *ref;
-    float *dist;
+    VmafFeatureCollector *feature_collector;
+    unsigned feature_id[4];
 } MomentState;
 
 static int init(VmafFeatureExtractor *fex, enum VmafPixelFormat pix_fmt,
                 unsigned bpc, unsigned w, unsigned h)
 {
     MomentState *s = fex->priv;
+    (void) pix_fmt;
+    (void) bpc;
+    (void) h;
     s->float_stride = ALIGN_CEIL(w * sizeof(float));
-    s->ref = aligned_malloc(s->float_stride * h, 32);
-    if (!s->ref) goto fail;
-    s->dist = aligned_malloc(s->float_stride * h, 32);
-    if (!s->dist) goto free_ref;
 
     return 0;
-
-free_ref:
-    free(s->ref);
-fail:
-    return -ENOMEM;
 }
 
+static const char *feature_name[] = {
+    "float_moment_ref1st", "float_moment_dis1st",
+    "float_moment_ref2nd", "float_moment_dis2nd",
+};
+
 static int extract(VmafFeatureExtractor *fex,
                    VmafPicture *ref_pic, VmafPicture *ref_pic_90,
                    VmafPicture *dist_pic, VmafPicture *dist_pic_90,
@@ -62,49 +61,35 @@ static int extract(VmafFeatureExtractor *fex,
     (void) ref_pic_90;
     (void) dist_pic_90;
 
-    picture_copy(s->ref, s->float_stride, ref_pic, 0, ref_pic->bpc);
-    picture_copy(s->dist, s->float_stride, dist_pic, 0, dist_pic->bpc);
+    const float *ref = picture_copy_shared(ref_pic, 0);
+    const float *dist = picture_copy_shared(dist_pic, 0);
+    if (!ref || !dist) return -ENOMEM;
 
     double score[4];
-    err = compute_1st_moment(s->ref, ref_pic->w[0], ref_pic->h[0],
+    err = compute_1st_moment(ref, ref_pic->w[0], ref_pic->h[0],
                              s->float_stride, &score[0]);
     if (err) return err;
-    err = compute_1st_moment(s->dist, dist_pic->w[0], dist_pic->h[0],
+    err = compute_1st_moment(dist, dist_pic->w[0], dist_pic->h[0],
                              s->float_stride, &score[1]);
     if (err) return err;
-    err = compute_2nd_moment(s->ref, ref_pic->w[0], ref_pic->h[0],
+    err = compute_2nd_moment(ref, ref_pic->w[0], ref_pic->h[0],
                              s->float_stride, &score[2]);
     if (err) return err;
-    err = compute_2nd_moment(s->dist, dist_pic->w[0], dist_pic->h[0],
+    err = compute_2nd_moment(dist, dist_pic->w[0], dist_pic->h[0],
                              s->float_stride, &score[3]);
     if (err) return err;
 
-    err = vmaf_feature_collector_append(feature_collector,
-                                        "float_moment_ref1st",
-                                        score[0], index);
-    if (err) return err;
-    err = vmaf_feature_collector_append(feature_collector,
-                                        "float_moment_dis1st",
-                                        score[1], index);
-    if (err) return err;
-    err = vmaf_feature_collector_append(feature_collector,
-                                        "float_moment_ref2nd",
-                                        score[2], index);
-    if (err) return err;
-    err = vmaf_feature_collector_append(feature_collector,
-                                        "float_moment_dis2nd",
-                                        score[3], index);
+    err = vmaf_feature_collector_register_list(feature_collector,
+                                               &s->feature_collector,
+                                               feature_name, s->feature_id, 4);
     if (err) return err;
 
-    return 0;
-}
-
-static int close(VmafFeatureExtractor *fex)
-{
-    MomentState *s = fex->priv;
-    if (s->ref) aligned_free(s->ref);
-    if (s->dist) aligned_free(s->dist);
-    return 0;
+    for (unsigned i = 0; i < 4; i++) {
+        err |= vmaf_feature_collector_append_id(feature_collector,
+                                                s->feature_id[i], score[i],
+                                                index);
+    }
+    return err;
 }
 
 static const char *provided_features[] = {
@@ -116,7 +101,6 @@ VmafFeatureExtractor vmaf_fex_float_moment = {
     .name = "float_moment",
     .init = init,
     .extract = extract,
-    .close = close,
     .priv_size = sizeof(MomentState),
     .provided_features = provided_features,
 };
@@ -31,13 +31,14 @@
 
 typedef struct MotionState {
     size_t float_stride;
-    float *ref;
     float *tmp;
     float *blur[3];
     unsigned index;
     double score;
     bool debug;
     bool motion_force_zero;
+    VmafFeatureCollector *feature_collector;
+    unsigned feature_id[2];
 } MotionState;
 
 static const VmafOption options[] = {
@@ -64,12 +65,11 @@ static int init(VmafFeatureExtractor *fex, enum VmafPixelFormat pix_fmt,
     MotionState *s = fex->priv;
 
     s->float_stride = ALIGN_CEIL(w * sizeof(float));
-    s->ref = aligned_malloc(s->float_stride * h, 32);
     s->tmp = aligned_malloc(s->float_stride * h, 32);
     s->blur[0] = aligned_malloc(s->float_stride * h, 32);
     s->blur[1] = aligned_malloc(s->float_stride * h, 32);
     s->blur[2] = aligned_malloc(s->float_stride * h, 32);
-    if (!s->ref || !s->tmp || !s->blur[0] || !s->blur[1] || !s->blur[2])
+    if (!s->tmp || !s->blur[0] || !s->blur[1] || !s->blur[2])
         goto fail;
     if (s->motion_force_zero)
         fex->flush = NULL;
@@ -77,7 +77,6 @@ static int init(VmafFeatureExtractor *fex, enum VmafPixelFormat pix_fmt,
     return 0;
 
 fail:
-    if (s->ref) aligned_free(s->ref);
     if (s->blur[0]) aligned_free(s->blur[0]);
     if (s->blur[1]) aligned_free(s->blur[1]);
     if (s->blur[2]) aligned_free(s->blur[2]);
@@ -86,6 +85,11 @@ fail:
 
 }
 
+static const char *feature_name[] = {
+    "'VMAF_feature_motion2_score'",
+    "'VMAF_feature_motion_score'",
+};
+
 static int flush(VmafFeatureExtractor *fex,
                  VmafFeatureCollector *feature_collector)
 {
@@ -93,9 +97,14 @@ static int flush(VmafFeatureExtractor *fex,
     int ret = 0;
 
     if (s->index > 0) {
-        ret = vmaf_feature_collector_append(feature_collector,
-                                            "'VMAF_feature_motion2_score'",
-                                            s->score, s->index);
+        ret = vmaf_feature_collector_register_list(feature_collector,
+                                                   &s->feature_collector,
+                                                   feature_name, s->feature_id,
+                                                   s->debug ? 2 : 1);
+        if (ret) return ret;
+        ret = vmaf_feature_collector_append_id(feature_collector,
+                                               s->feature_id[0],
+                                               s->score, s->index);
     }
 
     return (ret < 0) ? ret : !ret;
@@ -113,14 +122,19 @@ static int extract(VmafFeatureExtractor *fex,
     (void) ref_pic_90;
     (void) dist_pic_90;
 
+    err = vmaf_feature_collector_register_list(feature_collector,
+                                               &s->feature_collector,
+                                               feature_name, s->feature_id,
+                                               s->debug ? 2 : 1);
+    if (err) return err;
+
     if (s->motion_force_zero) {
-        err = vmaf_feature_collector_append(feature_collector,
-                                            "'VMAF_feature_motion2_score'",
-                                            0., index);
+        err = vmaf_feature_collector_append_id(feature_collector,
+                                               s->feature_id[0], 0., index);
         if (s->debug) {
-            err |= vmaf_feature_collector_append(feature_collector,
-                                                 "'VMAF_feature_motion_score'",
-                                                 0., index);
+            err |= vmaf_feature_collector_append_id(feature_collector,
+                                                    s->feature_id[1],
+                                                    0., index);
         }
         return err;
     }
@@ -130,20 +144,22 @@ static int extract(VmafFeatureExtractor *fex,
     unsigned blur_idx_1 = (index + 1) % 3;
     unsigned blur_idx_2 = (index + 2) % 3;
 
-    picture_copy(s->ref, s->float_stride, ref_pic, -128, ref_pic->bpc);
-    convolution_f32_c_s(FILTER_5_s, 5, s->ref, s->blur[blur_idx_0], s->tmp,
+    /* Shares the conversion of ref_pic with float_adm and float_vif, only
+     * the blurred planes are kept from one picture to the next. */
+    const float *ref = picture_copy_shared(ref_pic, -128);
+    if (!ref) return -ENOMEM;
+    convolution_f32_c_s(FILTER_5_s, 5, ref, s->blur[blur_idx_0], s->tmp,
                         ref_pic->w[0], ref_pic->h[0],
                         s->float_stride / sizeof(float),
                         s->float_stride / sizeof(float));
 
     if (index == 0) {
-        err = vmaf_feature_collector_append(feature_collector,
-                                             "'VMAF_feature_motion2_score'",
-                                             0., index);
+        err = vmaf_feature_collector_append_id(feature_collector,
+                                               s->feature_id[0], 0., index);
         if (s->debug) {
-            err |= vmaf_feature_collector_append(feature_collector,
-                                                 "'VMAF_feature_motion_score'",
-                                                 0., index);
+            err |= vmaf_feature_collector_append_id(feature_collector,
+                                                    s->feature_id[1],
+                                                    0., index);
         }
         return err;
     }
@@ -155,9 +171,8 @@ static int extract(VmafFeatureExtractor *fex,
     if (err) return err;
 
     if (s->debug) {
-        err |= vmaf_feature_collector_append(feature_collector,
-                                            "'VMAF_feature_motion_score'",
-                                            score, index);
+        err |= vmaf_feature_collector_append_id(feature_collector,
+                                                s->feature_id[1], score, index);
     }
     if (err) return err;
     s->score = score;
@@ -171,19 +186,26 @@ static int extract(VmafFeatureExtractor *fex,
                          s->float_stride, s->float_stride, &score2);
     if (err) return err;
     score2 = score2 < score ? score2 : score;
-    err = vmaf_feature_collector_append(feature_collector,
-                                        "'VMAF_feature_motion2_score'",
-                                        score2, index - 1);
+    err = vmaf_feature_collector_append_id(feature_collector, s->feature_id[0],
+                                           score2, index - 1);
     if (err) return err;
 
     return 0;
 }
 
+static int reset(VmafFeatureExtractor *fex)
+{
+    MotionState *s = fex->priv;
+
+    s->index = 0;
+    s->score = 0.;
+    return 0;
+}
+
 static int close(VmafFeatureExtractor *fex)
 {
     MotionState *s = fex->priv;
 
-    if (s->ref) aligned_free(s->ref);
     if (s->blur[0]) aligned_free(s->blur[0]);
     if (s->blur[1]) aligned_free(s->blur[1]);
     if (s->blur[2]) aligned_free(s->blur[2]);
@@ -203,6 +225,7 @@ VmafFeatureExtractor vmaf_fex_float_motion = {
     .extract = extract,
     .options = options,
     .flush = flush,
+    .reset = reset,
     .close = close,
     .priv_size = sizeof(MotionState),
     .provided_features = provided_features,
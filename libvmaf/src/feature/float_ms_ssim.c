@@ -28,9 +28,10 @@
 
 typedef struct MsSsimState {
     size_t float_stride;
-    float *ref;
-    float *dist;
+    MsSsimWorkspace ws;
     bool enable_lcs;
+    VmafFeatureCollector *feature_collector;
+    unsigned feature_id[16];
 } MsSsimState;
 
 static const VmafOption options[] = {
@@ -49,19 +50,23 @@ static int init(VmafFeatureExtractor *fex, enum VmafPixelFormat pix_fmt,
 {
     MsSsimState *s = fex->priv;
     s->float_stride = ALIGN_CEIL(w * sizeof(float));
-    s->ref = aligned_malloc(s->float_stride * h, 32);
-    if (!s->ref) goto fail;
-    s->dist = aligned_malloc(s->float_stride * h, 32);
-    if (!s->dist) goto free_ref;
+    if (ms_ssim_workspace_init(&s->ws, w, h)) return -ENOMEM;
 
     return 0;
-
-free_ref:
-    free(s->ref);
-fail:
-    return -ENOMEM;
 }
 
+static const char *feature_name[] = {
+    "float_ms_ssim",
+    "float_ms_ssim_l_scale0", "float_ms_ssim_l_scale1",
+    "float_ms_ssim_l_scale2", "float_ms_ssim_l_scale3",
+    "float_ms_ssim_l_scale4", "float_ms_ssim_c_scale0",
+    "float_ms_ssim_c_scale1", "float_ms_ssim_c_scale2",
+    "float_ms_ssim_c_scale3", "float_ms_ssim_c_scale4",
+    "float_ms_ssim_s_scale0", "float_ms_ssim_s_scale1",
+    "float_ms_ssim_s_scale2", "float_ms_ssim_s_scale3",
+    "float_ms_ssim_s_scale4",
+};
+
 static int extract(VmafFeatureExtractor *fex,
                    VmafPicture *ref_pic, VmafPicture *ref_pic_90,
                    VmafPicture *dist_pic, VmafPicture *dist_pic_90,
@@ -73,60 +78,42 @@ static int extract(VmafFeatureExtractor *fex,
     (void) ref_pic_90;
     (void) dist_pic_90;
 
-    picture_copy(s->ref, s->float_stride, ref_pic, 0, ref_pic->bpc);
-    picture_copy(s->dist, s->float_stride, dist_pic, 0, dist_pic->bpc);
+    const float *ref = picture_copy_shared(ref_pic, 0);
+    const float *dist = picture_copy_shared(dist_pic, 0);
+    if (!ref || !dist) return -ENOMEM;
 
     double score, l_scores[5], c_scores[5], s_scores[5];
-    err = compute_ms_ssim(s->ref, s->dist, ref_pic->w[0], ref_pic->h[0],
-                          s->float_stride, s->float_stride,
-                          &score, l_scores, c_scores, s_scores);
+    err = compute_ms_ssim_ws(&s->ws, ref, dist, ref_pic->w[0],
+                             ref_pic->h[0], s->float_stride, s->float_stride,
+                             &score, l_scores, c_scores, s_scores);
     if (err) return err;
 
-    err = vmaf_feature_collector_append(feature_collector, "float_ms_ssim",
-                                        score, index);
-    if (s->enable_lcs) {
-        err |= vmaf_feature_collector_append(feature_collector,
-                "float_ms_ssim_l_scale0", l_scores[0], index);
-        err |= vmaf_feature_collector_append(feature_collector,
-                "float_ms_ssim_l_scale1", l_scores[1], index);
-        err |= vmaf_feature_collector_append(feature_collector,
-                "float_ms_ssim_l_scale2", l_scores[2], index);
-        err |= vmaf_feature_collector_append(feature_collector,
-                "float_ms_ssim_l_scale3", l_scores[3], index);
-        err |= vmaf_feature_collector_append(feature_collector,
-                "float_ms_ssim_l_scale4", l_scores[4], index);
-
-        err |= vmaf_feature_collector_append(feature_collector,
-                "float_ms_ssim_c_scale0", c_scores[0], index);
-        err |= vmaf_feature_collector_append(feature_collector,
-                "float_ms_ssim_c_scale1", c_scores[1], index);
-        err |= vmaf_feature_collector_append(feature_collector,
-                "float_ms_ssim_c_scale2", c_scores[2], index);
-        err |= vmaf_feature_collector_append(feature_collector,
-                "float_ms_ssim_c_scale3", c_scores[3], index);
-        err |= vmaf_feature_collector_append(feature_collector,
-                "float_ms_ssim_c_scale4", c_scores[4], index);
-
-        err |= vmaf_feature_collector_append(feature_collector,
-                "float_ms_ssim_s_scale0", s_scores[0], index);
-        err |= vmaf_feature_collector_append(feature_collector,
-                "float_ms_ssim_s_scale1", s_scores[1], index);
-        err |= vmaf_feature_collector_append(feature_collector,
-                "float_ms_ssim_s_scale2", s_scores[2], index);
-        err |= vmaf_feature_collector_append(feature_collector,
-                "float_ms_ssim_s_scale3", s_scores[3], index);
-        err |= vmaf_feature_collector_append(feature_collector,
-                "float_ms_ssim_s_scale4", s_scores[4], index);
-    }
+    const double feature[] = {
+        score,
+        l_scores[0], l_scores[1], l_scores[2], l_scores[3], l_scores[4],
+        c_scores[0], c_scores[1], c_scores[2], c_scores[3], c_scores[4],
+        s_scores[0], s_scores[1], s_scores[2], s_scores[3], s_scores[4],
+    };
+
+    err = vmaf_feature_collector_register_list(feature_collector,
+                                               &s->feature_collector,
+                                               feature_name, s->feature_id,
+                                               s->enable_lcs ? 16 : 1);
+    if (err) return err;
 
+    const unsigned cnt = s->enable_lcs ? 16 : 1;
+    for (unsigned i = 0; i < cnt; i++) {
+        err |= vmaf_feature_collector_append_id(feature_collector,
+                                                s->feature_id[i], feature[i],
+                                                index);
+    }
     return err;
 }
 
 static int close(VmafFeatureExtractor *fex)
 {
     MsSsimState *s = fex->priv;
-    if (s->ref) aligned_free(s->ref);
-    if (s->dist) aligned_free(s->dist);
+    ms_ssim_workspace_free(&s->ws);
     return 0;
 }
 
@@ -28,21 +28,19 @@
 
 typedef struct PsnrState {
     size_t float_stride;
-    float *ref;
-    float *dist;
     double peak;
     double psnr_max;
+    VmafFeatureCollector *feature_collector;
+    unsigned psnr_id;
 } PsnrState;
 
 static int init(VmafFeatureExtractor *fex, enum VmafPixelFormat pix_fmt,
                 unsigned bpc, unsigned w, unsigned h)
 {
     PsnrState *s = fex->priv;
+    (void) pix_fmt;
+    (void) h;
     s->float_stride = ALIGN_CEIL(w * sizeof(float));
-    s->ref = aligned_malloc(s->float_stride * h, 32);
-    if (!s->ref) goto fail;
-    s->dist = aligned_malloc(s->float_stride * h, 32);
-    if (!s->dist) goto free_ref;
 
     if (bpc == 8) {
         s->peak = 255.0;
@@ -57,17 +55,16 @@ static int init(VmafFeatureExtractor *fex, enum VmafPixelFormat pix_fmt,
         s->peak = 255.99609375;
         s->psnr_max = 108.0;
     } else {
-        goto fail;
+        return -EINVAL;
     }
 
     return 0;
-
-free_ref:
-    free(s->ref);
-fail:
-    return -ENOMEM;
 }
 
+static const char *feature_name[] = {
+    "float_psnr",
+};
+
 static int extract(VmafFeatureExtractor *fex,
                    VmafPicture *ref_pic, VmafPicture *ref_pic_90,
                    VmafPicture *dist_pic, VmafPicture *dist_pic_90,
@@ -79,26 +76,23 @@ static int extract(VmafFeatureExtractor *fex,
     (void) ref_pic_90;
     (void) dist_pic_90;
 
-    picture_copy(s->ref, s->float_stride, ref_pic, 0, ref_pic->bpc);
-    picture_copy(s->dist, s->float_stride, dist_pic, 0, dist_pic->bpc);
+    const float *ref = picture_copy_shared(ref_pic, 0);
+    const float *dist = picture_copy_shared(dist_pic, 0);
+    if (!ref || !dist) return -ENOMEM;
 
     double score;
-    err = compute_psnr(s->ref, s->dist, ref_pic->w[0], ref_pic->h[0],
+    err = compute_psnr(ref, dist, ref_pic->w[0], ref_pic->h[0],
                        s->float_stride, s->float_stride, &score,
                        s->peak, s->psnr_max);
 
     if (err) return err;
-    err = vmaf_feature_collector_append(feature_collector, "float_psnr",
-                                        score, index);
+    err = vmaf_feature_collector_register_list(feature_collector,
+                                               &s->feature_collector,
+                                               feature_name, &s->psnr_id, 1);
+    if (err) return err;
+    err = vmaf_feature_collector_append_id(feature_collector, s->psnr_id,
+                                           score, index);
     if (err) return err;
-    return 0;
-}
-
-static int close(VmafFeatureExtractor *fex)
-{
-    PsnrState *s = fex->priv;
-    if (s->ref) aligned_free(s->ref);
-    if (s->dist) aligned_free(s->dist);
     return 0;
 }
 
@@ -111,7 +105,6 @@ VmafFeatureExtractor vmaf_fex_float_psnr = {
     .name = "float_psnr",
     .init = init,
     .extract = extract,
-    .close = close,
     .priv_size = sizeof(PsnrState),
     .provided_features = provided_features,
 };
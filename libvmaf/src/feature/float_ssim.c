@@ -28,9 +28,9 @@
 
 typedef struct SsimState {
     size_t float_stride;
-    float *ref;
-    float *dist;
     bool enable_lcs;
+    VmafFeatureCollector *feature_collector;
+    unsigned feature_id[4];
 } SsimState;
 
 static const VmafOption options[] = {
@@ -48,20 +48,18 @@ static int init(VmafFeatureExtractor *fex, enum VmafPixelFormat pix_fmt,
                 unsigned bpc, unsigned w, unsigned h)
 {
     SsimState *s = fex->priv;
+    (void) pix_fmt;
+    (void) bpc;
+    (void) h;
     s->float_stride = ALIGN_CEIL(w * sizeof(float));
-    s->ref = aligned_malloc(s->float_stride * h, 32);
-    if (!s->ref) goto fail;
-    s->dist = aligned_malloc(s->float_stride * h, 32);
-    if (!s->dist) goto free_ref;
 
     return 0;
-
-free_ref:
-    free(s->ref);
-fail:
-    return -ENOMEM;
 }
 
+static const char *feature_name[] = {
+    "float_ssim", "float_ssim_l", "float_ssim_c", "float_ssim_s",
+};
+
 static int extract(VmafFeatureExtractor *fex,
                    VmafPicture *ref_pic, VmafPicture *ref_pic_90,
                    VmafPicture *dist_pic, VmafPicture *dist_pic_90,
@@ -73,35 +71,33 @@ static int extract(VmafFeatureExtractor *fex,
     (void) ref_pic_90;
     (void) dist_pic_90;
 
-    picture_copy(s->ref, s->float_stride, ref_pic, 0, ref_pic->bpc);
-    picture_copy(s->dist, s->float_stride, dist_pic, 0, dist_pic->bpc);
+    const float *ref = picture_copy_shared(ref_pic, 0);
+    const float *dist = picture_copy_shared(dist_pic, 0);
+    if (!ref || !dist) return -ENOMEM;
 
     double score, l_score, c_score, s_score;
-    err = compute_ssim(s->ref, s->dist, ref_pic->w[0], ref_pic->h[0],
+    err = compute_ssim(ref, dist, ref_pic->w[0], ref_pic->h[0],
                        s->float_stride, s->float_stride,
                        &score, &l_score, &c_score, &s_score);
     if (err) return err;
 
-    err = vmaf_feature_collector_append(feature_collector, "float_ssim",
-                                        score, index);
-    if (s->enable_lcs) {
-        err |= vmaf_feature_collector_append(feature_collector, "float_ssim_l",
-                                            l_score, index);
-        err |= vmaf_feature_collector_append(feature_collector, "float_ssim_c",
-                                            c_score, index);
-        err |= vmaf_feature_collector_append(feature_collector, "float_ssim_s",
-                                            s_score, index);
-    }
+    const double feature[] = {
+        score, l_score, c_score, s_score,
+    };
 
-    return err;
-}
+    err = vmaf_feature_collector_register_list(feature_collector,
+                                               &s->feature_collector,
+                                               feature_name, s->feature_id,
+                                               s->enable_lcs ? 4 : 1);
+    if (err) return err;
 
-static int close(VmafFeatureExtractor *fex)
-{
-    SsimState *s = fex->priv;
-    if (s->ref) aligned_free(s->ref);
-    if (s->dist) aligned_free(s->dist);
-    return 0;
+    const unsigned cnt = s->enable_lcs ? 4 : 1;
+    for (unsigned i = 0; i < cnt; i++) {
+        err |= vmaf_feature_collector_append_id(feature_collector,
+                                                s->feature_id[i], feature[i],
+                                                index);
+    }
+    return err;
 }
 
 static const char *provided_features[] = {
@@ -114,7 +110,6 @@ VmafFeatureExtractor vmaf_fex_float_ssim = {
     .init = init,
     .extract = extract,
     .options = options,
-    .close = close,
     .priv_size = sizeof(SsimState),
     .provided_features = provided_features,
 };
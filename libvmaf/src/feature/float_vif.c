@@ -30,10 +30,11 @@
 
 typedef struct VifState {
     size_t float_stride;
-    float *ref;
-    float *dist;
+    VifWorkspace ws;
     bool debug;
     double vif_enhn_gain_limit;
+    VmafFeatureCollector *feature_collector;
+    unsigned feature_id[15];
 } VifState;
 
 static const VmafOption options[] = {
@@ -62,19 +63,19 @@ static int init(VmafFeatureExtractor *fex, enum VmafPixelFormat pix_fmt,
 {
     VifState *s = fex->priv;
     s->float_stride = ALIGN_CEIL(w * sizeof(float));
-    s->ref = aligned_malloc(s->float_stride * h, 32);
-    if (!s->ref) goto fail;
-    s->dist = aligned_malloc(s->float_stride * h, 32);
-    if (!s->dist) goto free_ref;
+    if (vif_workspace_init(&s->ws, w, h)) return -ENOMEM;
 
     return 0;
-
-free_ref:
-    free(s->ref);
-fail:
-    return -ENOMEM;
 }
 
+static const char *feature_name[] = {
+    "'VMAF_feature_vif_scale0_score'", "'VMAF_feature_vif_scale1_score'",
+    "'VMAF_feature_vif_scale2_score'", "'VMAF_feature_vif_scale3_score'",
+    "vif", "vif_num", "vif_den",
+    "vif_num_scale0", "vif_den_scale0", "vif_num_scale1", "vif_den_scale1",
+    "vif_num_scale2", "vif_den_scale2", "vif_num_scale3", "vif_den_scale3",
+};
+
 static int extract(VmafFeatureExtractor *fex,
                    VmafPicture *ref_pic, VmafPicture *ref_pic_90,
                    VmafPicture *dist_pic, VmafPicture *dist_pic_90,
@@ -86,63 +87,45 @@ static int extract(VmafFeatureExtractor *fex,
     (void) ref_pic_90;
     (void) dist_pic_90;
 
-    picture_copy(s->ref, s->float_stride, ref_pic, -128, ref_pic->bpc);
-    picture_copy(s->dist, s->float_stride, dist_pic, -128, dist_pic->bpc);
+    const float *ref = picture_copy_shared(ref_pic, -128);
+    const float *dist = picture_copy_shared(dist_pic, -128);
+    if (!ref || !dist) return -ENOMEM;
 
     double score, score_num, score_den;
     double scores[8];
-    err = compute_vif(s->ref, s->dist, ref_pic->w[0], ref_pic->h[0],
-                      s->float_stride, s->float_stride,
-                      &score, &score_num, &score_den, scores,
-                      s->vif_enhn_gain_limit);
+    err = compute_vif_ws(&s->ws, ref, dist, ref_pic->w[0],
+                         ref_pic->h[0], s->float_stride, s->float_stride,
+                         &score, &score_num, &score_den, scores,
+                         s->vif_enhn_gain_limit);
     if (err) return err;
 
-    err = vmaf_feature_collector_append(feature_collector,
-                                        "'VMAF_feature_vif_scale0_score'",
-                                        scores[0] / scores[1], index);
-    err |= vmaf_feature_collector_append(feature_collector,
-                                         "'VMAF_feature_vif_scale1_score'",
-                                         scores[2] / scores[3], index);
-    err |= vmaf_feature_collector_append(feature_collector,
-                                         "'VMAF_feature_vif_scale2_score'",
-                                         scores[4] / scores[5], index);
-    err |= vmaf_feature_collector_append(feature_collector,
-                                         "'VMAF_feature_vif_scale3_score'",
-                                         scores[6] / scores[7], index);
-
-    if (s->debug) {
-        err |= vmaf_feature_collector_append(feature_collector,
-                                             "vif", score, index);
-        err |= vmaf_feature_collector_append(feature_collector,
-                                             "vif_num", score_num, index);
-        err |= vmaf_feature_collector_append(feature_collector,
-                                             "vif_den", score_den, index);
-        err |= vmaf_feature_collector_append(feature_collector,
-                                            "vif_num_scale0", scores[0], index);
-        err |= vmaf_feature_collector_append(feature_collector,
-                                            "vif_den_scale0", scores[1], index);
-        err |= vmaf_feature_collector_append(feature_collector,
-                                            "vif_num_scale1", scores[2], index);
-        err |= vmaf_feature_collector_append(feature_collector,
-                                            "vif_den_scale1", scores[3], index);
-        err |= vmaf_feature_collector_append(feature_collector,
-                                            "vif_num_scale2", scores[4], index);
-        err |= vmaf_feature_collector_append(feature_collector,
-                                            "vif_den_scale2", scores[5], index);
-        err |= vmaf_feature_collector_append(feature_collector,
-                                            "vif_num_scale3", scores[6], index);
-        err |= vmaf_feature_collector_append(feature_collector,
-                                            "vif_den_scale3", scores[7], index);
-    }
+    const double feature[] = {
+        scores[0] / scores[1], scores[2] / scores[3],
+        scores[4] / scores[5], scores[6] / scores[7],
+        score, score_num, score_den,
+        scores[0], scores[1], scores[2], scores[3],
+        scores[4], scores[5], scores[6], scores[7],
+    };
+
+    err = vmaf_feature_collector_register_list(feature_collector,
+                                               &s->feature_collector,
+                                               feature_name, s->feature_id,
+                                               s->debug ? 15 : 4);
+    if (err) return err;
 
+    const unsigned cnt = s->debug ? 15 : 4;
+    for (unsigned i = 0; i < cnt; i++) {
+        err |= vmaf_feature_collector_append_id(feature_collector,
+                                                s->feature_id[i], feature[i],
+                                                index);
+    }
     return err;
 }
 
 static int close(VmafFeatureExtractor *fex)
 {
     VifState *s = fex->priv;
-    if (s->ref) aligned_free(s->ref);
-    if (s->dist) aligned_free(s->dist);
+    vif_workspace_free(&s->ws);
     return 0;
 }
 
@@ -25,7 +25,28 @@
 
 #if ARCH_X86
 #include "x86/adm_avx2.h"
+#if HAVE_AVX512
+#include "x86/adm_avx512.h"
 #endif
+#endif
+
+static int32_t div_lookup[65537];
+static const int32_t div_Q_factor = 1073741824; // 2^30
+
+static void div_lookup_generator(void)
+{
+    for (int i = 1; i <= 32768; ++i) {
+        int32_t recip = (int32_t)(div_Q_factor / i);
+        div_lookup[32768 + i] = recip;
+        div_lookup[32768 - i] = 0 - recip;
+    }
+}
+
+typedef struct AdmBand {
+    void *tmp_ref;
+    uint64_t den_accum[3];
+    int64_t num_accum[3];
+} AdmBand;
 
 typedef struct AdmState {
     size_t integer_stride;
@@ -35,6 +56,33 @@ typedef struct AdmState {
     void (*dwt2_8)(const uint8_t *src, const adm_dwt_band_t *dst,
                    AdmBuffer *buf, int w, int h, int src_stride,
                    int dst_stride);
+    void (*dwt2_16)(const uint16_t *src, const adm_dwt_band_t *dst,
+                    AdmBuffer *buf, int w, int h, int src_stride,
+                    int dst_stride, int inp_size_bits);
+    void (*dwt2_s123_combined)(const int32_t *i4_ref_scale,
+                               const int32_t *i4_curr_dis, AdmBuffer *buf,
+                               int w, int h, int ref_stride, int dis_stride,
+                               int dst_stride, int scale);
+    void (*decouple)(AdmBuffer *buf, int w, int h, int stride,
+                     double adm_enhn_gain_limit, int row_start, int row_end);
+    void (*decouple_s123)(AdmBuffer *buf, int w, int h, int stride,
+                          double adm_enhn_gain_limit, int row_start,
+                          int row_end);
+    void (*csf)(AdmBuffer *buf, int w, int h, int stride, int row_start,
+                int row_end);
+    void (*i4_csf)(AdmBuffer *buf, int scale, int w, int h, int stride,
+                   int row_start, int row_end);
+    void (*cm)(AdmBuffer *buf, int w, int h, int src_stride,
+               int csf_a_stride, int row_start, int row_end, int64_t *accum);
+    void (*i4_cm)(AdmBuffer *buf, int w, int h, int src_stride,
+                  int csf_a_stride, int scale, int row_start, int row_end,
+                  int64_t *accum);
+    unsigned n_bands;
+    AdmBand *band;
+    void *band_data;
+    int32_t *i4_scale_in;
+    VmafFeatureCollector *feature_collector;
+    unsigned feature_id[16];
 } AdmState;
 
 static const VmafOption options[] = {
@@ -58,25 +106,6 @@ static const VmafOption options[] = {
     { 0 }
 };
 
-/*
- * lambda = 0 (finest scale), 1, 2, 3 (coarsest scale);
- * theta = 0 (ll), 1 (lh - vertical), 2 (hh - diagonal), 3(hl - horizontal).
- */
-static inline float
-dwt_quant_step(const struct dwt_model_params *params, int lambda, int theta)
-{
-    // Formula (1), page 1165 - display visual resolution (DVR), in pixels/degree
-    // of visual angle. This should be 56.55
-    float r = VIEW_DIST * REF_DISPLAY_HEIGHT * M_PI / 180.0;
-
-    // Formula (9), page 1171
-    float temp = log10(pow(2.0, lambda + 1)*params->f0*params->g[theta] / r);
-    float Q = 2.0*params->a*pow(10.0, params->k*temp*temp) /
-        dwt_7_9_basis_function_amplitudes[lambda][theta];
-
-    return Q;
-}
-
 // i = 0, j = 0: indices y: 1,0,1, x: 1,0,1  for Fixed-point
 #define ADM_CM_THRESH_S_0_0(angles,flt_angles,src_stride,accum,w,h,i,j) \
 { \
@@ -626,7 +655,8 @@ static void dwt2_src_indices_filt(int **src_ind_y, int **src_ind_x, int w, int h
 #define MAX(x, y) (((x) > (y)) ? (x) : (y))
 
 static void adm_decouple(AdmBuffer *buf, int w, int h, int stride,
-                         double adm_enhn_gain_limit)
+                         double adm_enhn_gain_limit, int row_start,
+                         int row_end)
 {
     const float cos_1deg_sq = cos(1.0 * M_PI / 180.0) * cos(1.0 * M_PI / 180.0);
 
@@ -655,7 +685,7 @@ static void adm_decouple(AdmBuffer *buf, int w, int h, int stride,
 
     int64_t ot_dp, o_mag_sq, t_mag_sq;
 
-    for (int i = top; i < bottom; ++i) {
+    for (int i = MAX(top, row_start); i < MIN(bottom, row_end); ++i) {
         for (int j = left; j < right; ++j) {
             int16_t oh = ref->band_h[i * stride + j];
             int16_t ov = ref->band_v[i * stride + j];
@@ -755,7 +785,8 @@ static inline uint16_t get_best15_from32(uint32_t temp, int *x)
 }
 
 static void adm_decouple_s123(AdmBuffer *buf, int w, int h, int stride,
-                              double adm_enhn_gain_limit)
+                              double adm_enhn_gain_limit, int row_start,
+                              int row_end)
 {
     const float cos_1deg_sq = cos(1.0 * M_PI / 180.0) * cos(1.0 * M_PI / 180.0);
 
@@ -785,7 +816,7 @@ static void adm_decouple_s123(AdmBuffer *buf, int w, int h, int stride,
 
     int64_t ot_dp, o_mag_sq, t_mag_sq;
 
-    for (int i = top; i < bottom; ++i)
+    for (int i = MAX(top, row_start); i < MIN(bottom, row_end); ++i)
     {
         for (int j = left; j < right; ++j)
         {
@@ -897,7 +928,8 @@ static void adm_decouple_s123(AdmBuffer *buf, int w, int h, int stride,
     }
 }
 
-static void adm_csf(AdmBuffer *buf, int w, int h, int stride)
+static void adm_csf(AdmBuffer *buf, int w, int h, int stride,
+                    int row_start, int row_end)
 {
     const adm_dwt_band_t *src = &buf->decouple_a;
     const adm_dwt_band_t *dst = &buf->csf_a;
@@ -955,7 +987,7 @@ static void adm_csf(AdmBuffer *buf, int w, int h, int stride)
         int16_t *dst_ptr = dst_angles[theta];
         int16_t *flt_ptr = flt_angles[theta];
 
-        for (int i = top; i < bottom; ++i) {
+        for (int i = MAX(top, row_start); i < MIN(bottom, row_end); ++i) {
             int src_offset = i * stride;
             int dst_offset = i * stride;
 
@@ -970,7 +1002,8 @@ static void adm_csf(AdmBuffer *buf, int w, int h, int stride)
     }
 }
 
-static void i4_adm_csf(AdmBuffer *buf, int scale, int w, int h, int stride)
+static void i4_adm_csf(AdmBuffer *buf, int scale, int w, int h, int stride,
+                       int row_start, int row_end)
 {
     const i4_adm_dwt_band_t *src = &buf->i4_decouple_a;
     const i4_adm_dwt_band_t *dst = &buf->i4_csf_a;
@@ -1029,7 +1062,7 @@ static void i4_adm_csf(AdmBuffer *buf, int scale, int w, int h, int stride)
         int32_t *dst_ptr = dst_angles[theta];
         int32_t *flt_ptr = flt_angles[theta];
 
-        for (int i = top; i < bottom; ++i)
+        for (int i = MAX(top, row_start); i < MIN(bottom, row_end); ++i)
         {
             int src_offset = i * stride;
             int dst_offset = i * stride;
@@ -1046,15 +1079,10 @@ static void i4_adm_csf(AdmBuffer *buf, int scale, int w, int h, int stride)
     }
 }
 
-static float adm_csf_den_scale(const adm_dwt_band_t *src, int w, int h,
-                               int src_stride)
+static void adm_csf_den_accum(const adm_dwt_band_t *src, int w, int h,
+                              int src_stride, int row_start, int row_end,
+                              uint64_t *accum)
 {
-    // for ADM: scales goes from 0 to 3 but in noise floor paper, it goes from
-    // 1 to 4 (from finest scale to coarsest scale).
-    const float factor1 = dwt_quant_step(&dwt_7_9_YCbCr_threshold[0], 0, 1);
-    const float factor2 = dwt_quant_step(&dwt_7_9_YCbCr_threshold[0], 0, 2);
-    const float rfactor[3] = { 1.0f / factor1, 1.0f / factor1, 1.0f / factor2 };
-
     uint64_t accum_h = 0, accum_v = 0, accum_d = 0;
 
     /* The computation of the denominator scales is not required for the regions
@@ -1064,6 +1092,8 @@ static float adm_csf_den_scale(const adm_dwt_band_t *src, int w, int h,
     const int top = h * ADM_BORDER_FACTOR - 0.5;
     const int right = w - left;
     const int bottom = h - top;
+    const int start_row = MAX(top, row_start);
+    const int end_row = MIN(bottom, row_end);
 
     int32_t shift_accum = (int32_t)ceil(log2((bottom - top)*(right - left)) - 20);
     shift_accum = shift_accum > 0 ? shift_accum : 0;
@@ -1075,10 +1105,10 @@ static float adm_csf_den_scale(const adm_dwt_band_t *src, int w, int h,
      * Because d+ = (a[i]^3)*(r^3)
      * is equivalent to d+=a[i]^3 and d=d*(r^3)
      */
-    int16_t *src_h = src->band_h + top * src_stride;
-    int16_t *src_v = src->band_v + top * src_stride;
-    int16_t *src_d = src->band_d + top * src_stride;
-    for (int i = top; i < bottom; ++i) {
+    int16_t *src_h = src->band_h + start_row * src_stride;
+    int16_t *src_v = src->band_v + start_row * src_stride;
+    int16_t *src_d = src->band_d + start_row * src_stride;
+    for (int i = start_row; i < end_row; ++i) {
         uint64_t accum_inner_h = 0;
         uint64_t accum_inner_v = 0;
         uint64_t accum_inner_d = 0;
@@ -1107,6 +1137,28 @@ static float adm_csf_den_scale(const adm_dwt_band_t *src, int w, int h,
         src_v += src_stride;
         src_d += src_stride;
     }
+
+    accum[0] += accum_h;
+    accum[1] += accum_v;
+    accum[2] += accum_d;
+}
+
+static float adm_csf_den_scale(int w, int h, const uint64_t *accum)
+{
+    // for ADM: scales goes from 0 to 3 but in noise floor paper, it goes from
+    // 1 to 4 (from finest scale to coarsest scale).
+    const float factor1 = dwt_quant_step(&dwt_7_9_YCbCr_threshold[0], 0, 1);
+    const float factor2 = dwt_quant_step(&dwt_7_9_YCbCr_threshold[0], 0, 2);
+    const float rfactor[3] = { 1.0f / factor1, 1.0f / factor1, 1.0f / factor2 };
+
+    const int left = w * ADM_BORDER_FACTOR - 0.5;
+    const int top = h * ADM_BORDER_FACTOR - 0.5;
+    const int right = w - left;
+    const int bottom = h - top;
+
+    int32_t shift_accum = (int32_t)ceil(log2((bottom - top)*(right - left)) - 20);
+    shift_accum = shift_accum > 0 ? shift_accum : 0;
+
     /**
      * rfactor is multiplied after cubing
      * accum_h,v,d is converted to floating-point for score calculation
@@ -1115,9 +1167,9 @@ static float adm_csf_den_scale(const adm_dwt_band_t *src, int w, int h,
      * Hence final shift is 18-shift_accum
      */
     double shift_csf = pow(2, (18 - shift_accum));
-    double csf_h = (double)(accum_h / shift_csf) * pow(rfactor[0], 3);
-    double csf_v = (double)(accum_v / shift_csf) * pow(rfactor[1], 3);
-    double csf_d = (double)(accum_d / shift_csf) * pow(rfactor[2], 3);
+    double csf_h = (double)(accum[0] / shift_csf) * pow(rfactor[0], 3);
+    double csf_v = (double)(accum[1] / shift_csf) * pow(rfactor[1], 3);
+    double csf_d = (double)(accum[2] / shift_csf) * pow(rfactor[2], 3);
 
     float powf_add = powf((bottom - top) * (right - left) / 32.0f, 1.0f / 3.0f);
     float den_scale_h = powf(csf_h, 1.0f / 3.0f) + powf_add;
@@ -1128,18 +1180,12 @@ static float adm_csf_den_scale(const adm_dwt_band_t *src, int w, int h,
 
 }
 
-static float adm_csf_den_s123(const i4_adm_dwt_band_t *src, int scale, int w, int h,
-                              int src_stride)
+static void adm_csf_den_s123_accum(const i4_adm_dwt_band_t *src, int scale,
+                                   int w, int h, int src_stride,
+                                   int row_start, int row_end, uint64_t *accum)
 {
-    // for ADM: scales goes from 0 to 3 but in noise floor paper, it goes from
-    // 1 to 4 (from finest scale to coarsest scale).
-    float factor1 = dwt_quant_step(&dwt_7_9_YCbCr_threshold[0], scale, 1);
-    float factor2 = dwt_quant_step(&dwt_7_9_YCbCr_threshold[0], scale, 2);
-    const float rfactor[3] = { 1.0f / factor1, 1.0f / factor1, 1.0f / factor2 };
-
     uint64_t accum_h = 0, accum_v = 0, accum_d = 0;
     const uint32_t shift_sq[3] = { 31, 30, 31 };
-    const uint32_t accum_convert_float[3] = { 32, 27, 23 };
     const uint32_t add_shift_sq[3] = {1 << shift_sq[0] , 1 << shift_sq[1] , 1 << shift_sq[2] };
 
     /* The computation of the denominator scales is not required for the regions
@@ -1149,16 +1195,18 @@ static float adm_csf_den_s123(const i4_adm_dwt_band_t *src, int scale, int w, in
     const int top = h * ADM_BORDER_FACTOR - 0.5;
     const int right = w - left;
     const int bottom = h - top;
+    const int start_row = MAX(top, row_start);
+    const int end_row = MIN(bottom, row_end);
 
     uint32_t shift_cub = (uint32_t)ceil(log2(right - left));
     uint32_t add_shift_cub = (uint32_t)pow(2, (shift_cub - 1));
     uint32_t shift_accum = (uint32_t)ceil(log2(bottom - top));
     uint32_t add_shift_accum = (uint32_t)pow(2, (shift_accum - 1));
 
-    int32_t *src_h = src->band_h + top * src_stride;
-    int32_t *src_v = src->band_v + top * src_stride;
-    int32_t *src_d = src->band_d + top * src_stride;
-    for (int i = top; i < bottom; ++i)
+    int32_t *src_h = src->band_h + start_row * src_stride;
+    int32_t *src_v = src->band_v + start_row * src_stride;
+    int32_t *src_d = src->band_d + start_row * src_stride;
+    for (int i = start_row; i < end_row; ++i)
     {
         uint64_t accum_inner_h = 0;
         uint64_t accum_inner_v = 0;
@@ -1191,14 +1239,38 @@ static float adm_csf_den_s123(const i4_adm_dwt_band_t *src, int scale, int w, in
         src_v += src_stride;
         src_d += src_stride;
     }
+
+    accum[0] += accum_h;
+    accum[1] += accum_v;
+    accum[2] += accum_d;
+}
+
+static float adm_csf_den_s123(int scale, int w, int h, const uint64_t *accum)
+{
+    // for ADM: scales goes from 0 to 3 but in noise floor paper, it goes from
+    // 1 to 4 (from finest scale to coarsest scale).
+    float factor1 = dwt_quant_step(&dwt_7_9_YCbCr_threshold[0], scale, 1);
+    float factor2 = dwt_quant_step(&dwt_7_9_YCbCr_threshold[0], scale, 2);
+    const float rfactor[3] = { 1.0f / factor1, 1.0f / factor1, 1.0f / factor2 };
+
+    const uint32_t accum_convert_float[3] = { 32, 27, 23 };
+
+    const int left = w * ADM_BORDER_FACTOR - 0.5;
+    const int top = h * ADM_BORDER_FACTOR - 0.5;
+    const int right = w - left;
+    const int bottom = h - top;
+
+    uint32_t shift_cub = (uint32_t)ceil(log2(right - left));
+    uint32_t shift_accum = (uint32_t)ceil(log2(bottom - top));
+
     /**
      * All the results are converted to floating-point to calculate the scores
      * For all scales the final shift is 3*shifts from dwt - total shifts done here
      */
     double shift_csf = pow(2, (accum_convert_float[scale - 1] - shift_accum - shift_cub));
-    double csf_h = (double)(accum_h / shift_csf) * pow(rfactor[0], 3);
-    double csf_v = (double)(accum_v / shift_csf) * pow(rfactor[1], 3);
-    double csf_d = (double)(accum_d / shift_csf) * pow(rfactor[2], 3);
+    double csf_h = (double)(accum[0] / shift_csf) * pow(rfactor[0], 3);
+    double csf_v = (double)(accum[1] / shift_csf) * pow(rfactor[1], 3);
+    double csf_d = (double)(accum[2] / shift_csf) * pow(rfactor[2], 3);
 
     float powf_add = powf((bottom - top) * (right - left) / 32.0f, 1.0f / 3.0f);
     float den_scale_h = powf(csf_h, 1.0f / 3.0f) + powf_add;
@@ -1208,7 +1280,9 @@ static float adm_csf_den_s123(const i4_adm_dwt_band_t *src, int scale, int w, in
     return (den_scale_h + den_scale_v + den_scale_d);
 }
 
-static float adm_cm(AdmBuffer *buf, int w, int h, int src_stride, int csf_a_stride)
+static void adm_cm(AdmBuffer *buf, int w, int h, int src_stride,
+                   int csf_a_stride, int row_start, int row_end,
+                   int64_t *accum)
 {
     const adm_dwt_band_t *src   = &buf->decouple_r;
     const adm_dwt_band_t *csf_f = &buf->csf_f;
@@ -1252,8 +1326,8 @@ static float adm_cm(AdmBuffer *buf, int w, int h, int src_stride, int csf_a_stri
 
     const int start_col = (left > 1) ? left : 1;
     const int end_col = (right < (w - 1)) ? right : (w - 1);
-    const int start_row = (top > 1) ? top : 1;
-    const int end_row = (bottom < (h - 1)) ? bottom : (h - 1);
+    const int start_row = MAX((top > 1) ? top : 1, row_start);
+    const int end_row = MIN((bottom < (h - 1)) ? bottom : (h - 1), row_end);
 
     int i, j;
     int64_t val;
@@ -1263,7 +1337,7 @@ static float adm_cm(AdmBuffer *buf, int w, int h, int src_stride, int csf_a_stri
     int64_t accum_inner_h = 0, accum_inner_v = 0, accum_inner_d = 0;
 
     /* i=0,j=0 */
-    if ((top <= 0) && (left <= 0))
+    if ((row_start == 0) && (top <= 0) && (left <= 0))
     {
         xh = (int32_t)src->band_h[0] * rfactor[0];
         xv = (int32_t)src->band_v[0] * rfactor[1];
@@ -1292,7 +1366,7 @@ static float adm_cm(AdmBuffer *buf, int w, int h, int src_stride, int csf_a_stri
     }
 
     /* i=0, j */
-    if (top <= 0) {
+    if ((row_start == 0) && (top <= 0)) {
         for (j = start_col; j < end_col; ++j) {
             xh = src->band_h[j] * rfactor[0];
             xv = src->band_v[j] * rfactor[1];
@@ -1309,7 +1383,7 @@ static float adm_cm(AdmBuffer *buf, int w, int h, int src_stride, int csf_a_stri
     }
 
     /* i=0,j=w-1 */
-    if ((top <= 0) && (right > (w - 1)))
+    if ((row_start == 0) && (top <= 0) && (right > (w - 1)))
     {
         xh = src->band_h[w - 1] * rfactor[0];
         xv = src->band_v[w - 1] * rfactor[1];
@@ -1487,7 +1561,7 @@ static float adm_cm(AdmBuffer *buf, int w, int h, int src_stride, int csf_a_stri
     accum_inner_d = 0;
 
     /* i=h-1,j=0 */
-    if ((bottom > (h - 1)) && (left <= 0))
+    if ((row_end == h) && (bottom > (h - 1)) && (left <= 0))
     {
         xh = src->band_h[(h - 1) * src_stride] * rfactor[0];
         xv = src->band_v[(h - 1) * src_stride] * rfactor[1];
@@ -1503,7 +1577,7 @@ static float adm_cm(AdmBuffer *buf, int w, int h, int src_stride, int csf_a_stri
     }
 
     /* i=h-1,j */
-    if (bottom > (h - 1)) {
+    if ((row_end == h) && (bottom > (h - 1))) {
         for (j = start_col; j < end_col; ++j) {
             xh = src->band_h[(h - 1) * src_stride + j] * rfactor[0];
             xv = src->band_v[(h - 1) * src_stride + j] * rfactor[1];
@@ -1520,7 +1594,7 @@ static float adm_cm(AdmBuffer *buf, int w, int h, int src_stride, int csf_a_stri
     }
 
     /* i-h-1,j=w-1 */
-    if ((bottom > (h - 1)) && (right > (w - 1)))
+    if ((row_end == h) && (bottom > (h - 1)) && (right > (w - 1)))
     {
         xh = src->band_h[(h - 1) * src_stride + w - 1] * rfactor[0];
         xv = src->band_v[(h - 1) * src_stride + w - 1] * rfactor[1];
@@ -1539,6 +1613,23 @@ static float adm_cm(AdmBuffer *buf, int w, int h, int src_stride, int csf_a_stri
     accum_v += (accum_inner_v + add_shift_inner_accum) >> shift_inner_accum;
     accum_d += (accum_inner_d + add_shift_inner_accum) >> shift_inner_accum;
 
+    accum[0] += accum_h;
+    accum[1] += accum_v;
+    accum[2] += accum_d;
+}
+
+static float adm_cm_score(int w, int h, const int64_t *accum)
+{
+    const uint32_t shift_xhcub = (uint32_t)ceil(log2(w) - 4);
+    const uint32_t shift_xvcub = (uint32_t)ceil(log2(w) - 4);
+    const uint32_t shift_xdcub = (uint32_t)ceil(log2(w) - 3);
+    const uint32_t shift_inner_accum = (uint32_t)ceil(log2(h));
+
+    const int left = w * ADM_BORDER_FACTOR - 0.5;
+    const int top = h * ADM_BORDER_FACTOR - 0.5;
+    const int right = w - left;
+    const int bottom = h - top;
+
     /**
      * For h and v total shifts pending from last stage is 6 rfactor[0,1] has 21 shifts
      * => after cubing (6+21)*3=81 after squaring shifted by 29
@@ -1548,9 +1639,9 @@ static float adm_cm(AdmBuffer *buf, int w, int h, int src_stride, int csf_a_stri
      * => after cubing (6+23)*3=87 after squaring shifted by 30
      * hence pending is 57-shift's done based on width and height
      */
-    float f_accum_h = (float)(accum_h / pow(2, (52 - shift_xhcub - shift_inner_accum)));
-    float f_accum_v = (float)(accum_v / pow(2, (52 - shift_xvcub - shift_inner_accum)));
-    float f_accum_d = (float)(accum_d / pow(2, (57 - shift_xdcub - shift_inner_accum)));
+    float f_accum_h = (float)(accum[0] / pow(2, (52 - shift_xhcub - shift_inner_accum)));
+    float f_accum_v = (float)(accum[1] / pow(2, (52 - shift_xvcub - shift_inner_accum)));
+    float f_accum_d = (float)(accum[2] / pow(2, (57 - shift_xdcub - shift_inner_accum)));
 
     float num_scale_h = powf(f_accum_h, 1.0f / 3.0f) + powf((bottom - top) *
                         (right - left) / 32.0f, 1.0f / 3.0f);
@@ -1562,7 +1653,9 @@ static float adm_cm(AdmBuffer *buf, int w, int h, int src_stride, int csf_a_stri
     return (num_scale_h + num_scale_v + num_scale_d);
 }
 
-static float i4_adm_cm(AdmBuffer *buf, int w, int h, int src_stride, int csf_a_stride, int scale)
+static void i4_adm_cm(AdmBuffer *buf, int w, int h, int src_stride,
+                      int csf_a_stride, int scale, int row_start,
+                      int row_end, int64_t *accum)
 {
     const i4_adm_dwt_band_t *src = &buf->i4_decouple_r;
     const i4_adm_dwt_band_t *csf_f = &buf->i4_csf_f;
@@ -1594,10 +1687,6 @@ static float i4_adm_cm(AdmBuffer *buf, int w, int h, int src_stride, int csf_a_s
     uint32_t shift_inner_accum = (uint32_t)ceil(log2(h));
     uint32_t add_shift_inner_accum = (uint32_t)pow(2, (shift_inner_accum - 1));
 
-    float final_shift[3] = { pow(2,(45 - shift_cub - shift_inner_accum)),
-                             pow(2,(39 - shift_cub - shift_inner_accum)),
-                             pow(2,(36 - shift_cub - shift_inner_accum)) };
-
     const int32_t shift_sq = 30;
     const int32_t add_shift_sq = 536870912; //2^29
     const int32_t shift_sub = 0;
@@ -1614,8 +1703,8 @@ static float i4_adm_cm(AdmBuffer *buf, int w, int h, int src_stride, int csf_a_s
 
     const int start_col = (left > 1) ? left : 1;
     const int end_col = (right < (w - 1)) ? right : (w - 1);
-    const int start_row = (top > 1) ? top : 1;
-    const int end_row = (bottom < (h - 1)) ? bottom : (h - 1);
+    const int start_row = MAX((top > 1) ? top : 1, row_start);
+    const int end_row = MIN((bottom < (h - 1)) ? bottom : (h - 1), row_end);
 
     int i, j;
     int32_t xh, xv, xd, thr;
@@ -1624,7 +1713,7 @@ static float i4_adm_cm(AdmBuffer *buf, int w, int h, int src_stride, int csf_a_s
     int64_t accum_h = 0, accum_v = 0, accum_d = 0;
     int64_t accum_inner_h = 0, accum_inner_v = 0, accum_inner_d = 0;
     /* i=0,j=0 */
-    if ((top <= 0) && (left <= 0))
+    if ((row_start == 0) && (top <= 0) && (left <= 0))
     {
         xh = (int32_t)((((int64_t)src->band_h[0] * rfactor[0]) + add_bef_shift_dst[scale - 1])
             >> shift_dst[scale - 1]);
@@ -1644,7 +1733,7 @@ static float i4_adm_cm(AdmBuffer *buf, int w, int h, int src_stride, int csf_a_s
     }
 
     /* i=0, j */
-    if (top <= 0)
+    if ((row_start == 0) && (top <= 0))
     {
         for (j = start_col; j < end_col; ++j)
         {
@@ -1667,7 +1756,7 @@ static float i4_adm_cm(AdmBuffer *buf, int w, int h, int src_stride, int csf_a_s
     }
 
     /* i=0,j=w-1 */
-    if ((top <= 0) && (right > (w - 1)))
+    if ((row_start == 0) && (top <= 0) && (right > (w - 1)))
     {
         xh = (int32_t)((((int64_t)src->band_h[w - 1] * rfactor[0]) +
             add_bef_shift_dst[scale - 1]) >> shift_dst[scale - 1]);
@@ -1889,7 +1978,7 @@ static float i4_adm_cm(AdmBuffer *buf, int w, int h, int src_stride, int csf_a_s
     accum_inner_d = 0;
 
     /* i=h-1,j=0 */
-    if ((bottom > (h - 1)) && (left <= 0))
+    if ((row_end == h) && (bottom > (h - 1)) && (left <= 0))
     {
         xh = (int32_t)((((int64_t)src->band_h[(h - 1) * src_stride] * rfactor[0]) +
             add_bef_shift_dst[scale - 1]) >> shift_dst[scale - 1]);
@@ -1909,7 +1998,7 @@ static float i4_adm_cm(AdmBuffer *buf, int w, int h, int src_stride, int csf_a_s
     }
 
     /* i=h-1,j */
-    if (bottom > (h - 1))
+    if ((row_end == h) && (bottom > (h - 1)))
     {
         for (j = start_col; j < end_col; ++j)
         {
@@ -1932,7 +2021,7 @@ static float i4_adm_cm(AdmBuffer *buf, int w, int h, int src_stride, int csf_a_s
     }
 
     /* i-h-1,j=w-1 */
-    if ((bottom > (h - 1)) && (right > (w - 1)))
+    if ((row_end == h) && (bottom > (h - 1)) && (right > (w - 1)))
     {
         xh = (int32_t)((((int64_t)src->band_h[(h - 1) * src_stride + w - 1] * rfactor[0]) +
             add_bef_shift_dst[scale - 1]) >> shift_dst[scale - 1]);
@@ -1954,13 +2043,32 @@ static float i4_adm_cm(AdmBuffer *buf, int w, int h, int src_stride, int csf_a_s
     accum_v += (accum_inner_v + add_shift_inner_accum) >> shift_inner_accum;
     accum_d += (accum_inner_d + add_shift_inner_accum) >> shift_inner_accum;
 
+    accum[0] += accum_h;
+    accum[1] += accum_v;
+    accum[2] += accum_d;
+}
+
+static float i4_adm_cm_score(int w, int h, int scale, const int64_t *accum)
+{
+    uint32_t shift_cub = (uint32_t)ceil(log2(w));
+    uint32_t shift_inner_accum = (uint32_t)ceil(log2(h));
+
+    float final_shift[3] = { pow(2,(45 - shift_cub - shift_inner_accum)),
+                             pow(2,(39 - shift_cub - shift_inner_accum)),
+                             pow(2,(36 - shift_cub - shift_inner_accum)) };
+
+    const int left = w * ADM_BORDER_FACTOR - 0.5;
+    const int top = h * ADM_BORDER_FACTOR - 0.5;
+    const int right = w - left;
+    const int bottom = h - top;
+
     /**
      * Converted to floating-point for calculating the final scores
      * Final shifts is calculated from 3*(shifts_from_previous_stage(i.e src comes from dwt)+32)-total_shifts_done_in_this_function
      */
-    float f_accum_h = (float)(accum_h / final_shift[scale - 1]);
-    float f_accum_v = (float)(accum_v / final_shift[scale - 1]);
-    float f_accum_d = (float)(accum_d / final_shift[scale - 1]);
+    float f_accum_h = (float)(accum[0] / final_shift[scale - 1]);
+    float f_accum_v = (float)(accum[1] / final_shift[scale - 1]);
+    float f_accum_d = (float)(accum[2] / final_shift[scale - 1]);
 
     float num_scale_h = powf(f_accum_h, 1.0f / 3.0f) + powf((bottom - top) * (right - left) / 32.0f, 1.0f / 3.0f);
     float num_scale_v = powf(f_accum_v, 1.0f / 3.0f) + powf((bottom - top) * (right - left) / 32.0f, 1.0f / 3.0f);
@@ -2339,9 +2447,138 @@ static void adm_dwt2_s123_combined(const int32_t *i4_ref_scale, const int32_t *i
     }
 }
 
-void integer_compute_adm(AdmState *s, VmafPicture *ref_pic, VmafPicture *dis_pic,
-                         double *score, double *score_num, double *score_den, double *scores, AdmBuffer *buf,
-                         double adm_enhn_gain_limit)
+/*
+ * Every scale is processed in two passes over horizontal bands of the
+ * decimated frame. The first pass runs the DWT, decoupling, CSF and the
+ * denominator sums, the second one the contrast masking, which reads the CSF
+ * rows just outside of its band. Integer sums are kept per band and added up
+ * in band order, so the scores do not depend on the number of bands.
+ */
+#define ADM_BAND_MIN_ROWS 8
+
+typedef struct AdmBandJob {
+    AdmState *s;
+    AdmBuffer *buf;
+    VmafPicture *ref_pic, *dis_pic;
+    const int32_t *i4_ref_scale, *i4_dis_scale;
+    size_t ref_stride, dis_stride, buf_stride;
+    int scale, w, h;
+    unsigned n_bands;
+    double adm_enhn_gain_limit;
+} AdmBandJob;
+
+static unsigned adm_n_bands(AdmState *s, int h)
+{
+    const unsigned n = h / ADM_BAND_MIN_ROWS;
+    return MAX(MIN(s->n_bands, n), 1);
+}
+
+static void offset_dwt_band(adm_dwt_band_t *band, ptrdiff_t offset)
+{
+    band->band_a += offset;
+    band->band_h += offset;
+    band->band_v += offset;
+    band->band_d += offset;
+}
+
+static void i4_offset_dwt_band(i4_adm_dwt_band_t *band, ptrdiff_t offset)
+{
+    band->band_a += offset;
+    band->band_h += offset;
+    band->band_v += offset;
+    band->band_d += offset;
+}
+
+static void adm_dwt_decouple_csf_band(void *data, unsigned idx)
+{
+    AdmBandJob *job = data;
+    AdmState *s = job->s;
+    AdmBuffer *buf = job->buf;
+    AdmBand *band = &s->band[idx];
+
+    const int w = (job->w + 1) / 2;
+    const int h = (job->h + 1) / 2;
+    const int row_start = h * idx / job->n_bands;
+    const int row_end = h * (idx + 1) / job->n_bands;
+    const int stride = job->buf_stride;
+
+    // the DWT walks its output from the first row,
+    // give it a view which starts at this band
+    AdmBuffer b = *buf;
+    b.tmp_ref = band->tmp_ref;
+    for (unsigned k = 0; k < 4; k++)
+        b.ind_y[k] = buf->ind_y[k] + row_start;
+    offset_dwt_band(&b.ref_dwt2, row_start * stride);
+    offset_dwt_band(&b.dis_dwt2, row_start * stride);
+    i4_offset_dwt_band(&b.i4_ref_dwt2, row_start * stride);
+    i4_offset_dwt_band(&b.i4_dis_dwt2, row_start * stride);
+    const int band_h = 2 * (row_end - row_start);
+
+    memset(band->den_accum, 0, sizeof(band->den_accum));
+
+    if (job->scale == 0) {
+        if (job->ref_pic->bpc == 8) {
+            s->dwt2_8(job->ref_pic->data[0], &b.ref_dwt2, &b, job->w, band_h,
+                      job->ref_stride, stride);
+            s->dwt2_8(job->dis_pic->data[0], &b.dis_dwt2, &b, job->w, band_h,
+                      job->dis_stride, stride);
+        }
+        else {
+            s->dwt2_16(job->ref_pic->data[0], &b.ref_dwt2, &b, job->w,
+                       band_h, job->ref_stride, stride, job->ref_pic->bpc);
+            s->dwt2_16(job->dis_pic->data[0], &b.dis_dwt2, &b, job->w,
+                       band_h, job->dis_stride, stride, job->dis_pic->bpc);
+        }
+
+        i16_to_i32(&b.ref_dwt2, &b.i4_ref_dwt2, job->w, band_h, stride);
+        i16_to_i32(&b.dis_dwt2, &b.i4_dis_dwt2, job->w, band_h, stride);
+
+        s->decouple(buf, w, h, stride, job->adm_enhn_gain_limit,
+                    row_start, row_end);
+        adm_csf_den_accum(&buf->ref_dwt2, w, h, stride, row_start, row_end,
+                          band->den_accum);
+        s->csf(buf, w, h, stride, row_start, row_end);
+    }
+    else {
+        s->dwt2_s123_combined(job->i4_ref_scale, job->i4_dis_scale, &b,
+                              job->w, band_h, job->ref_stride,
+                              job->dis_stride, stride, job->scale);
+
+        s->decouple_s123(buf, w, h, stride, job->adm_enhn_gain_limit,
+                         row_start, row_end);
+        adm_csf_den_s123_accum(&buf->i4_ref_dwt2, job->scale, w, h, stride,
+                               row_start, row_end, band->den_accum);
+        s->i4_csf(buf, job->scale, w, h, stride, row_start, row_end);
+    }
+}
+
+static void adm_cm_band(void *data, unsigned idx)
+{
+    AdmBandJob *job = data;
+    AdmState *s = job->s;
+    AdmBand *band = &s->band[idx];
+
+    const int w = (job->w + 1) / 2;
+    const int h = (job->h + 1) / 2;
+    const int row_start = h * idx / job->n_bands;
+    const int row_end = h * (idx + 1) / job->n_bands;
+    const int stride = job->buf_stride;
+
+    memset(band->num_accum, 0, sizeof(band->num_accum));
+
+    if (job->scale == 0) {
+        s->cm(job->buf, w, h, stride, stride, row_start, row_end,
+              band->num_accum);
+    }
+    else {
+        s->i4_cm(job->buf, w, h, stride, stride, job->scale, row_start,
+                 row_end, band->num_accum);
+    }
+}
+
+int integer_compute_adm(AdmState *s, VmafPicture *ref_pic, VmafPicture *dis_pic,
+                        double *score, double *score_num, double *score_den, double *scores, AdmBuffer *buf,
+                        double adm_enhn_gain_limit, VmafThreadPool *thread_pool)
 {
     int w = ref_pic->w[0];
     int h = ref_pic->h[0];
@@ -2371,48 +2608,61 @@ void integer_compute_adm(AdmState *s, VmafPicture *ref_pic, VmafPicture *dis_pic
 		float den_scale = 0.0;
 
         dwt2_src_indices_filt(buf->ind_y, buf->ind_x, w, h);
-		if(scale==0) {
-            if (ref_pic->bpc == 8) {
-                s->dwt2_8(ref_pic->data[0], &buf->ref_dwt2, buf, w, h,
-                          curr_ref_stride, buf_stride);
-                s->dwt2_8(dis_pic->data[0], &buf->dis_dwt2, buf, w, h,
-                          curr_dis_stride, buf_stride);
-            }
-            else {
-                adm_dwt2_16(ref_pic->data[0], &buf->ref_dwt2, buf, w, h,
-                            curr_ref_stride, buf_stride, ref_pic->bpc);
-                adm_dwt2_16(dis_pic->data[0], &buf->dis_dwt2, buf, w, h,
-                            curr_dis_stride, buf_stride, dis_pic->bpc);
-            }
 
-			i16_to_i32(&buf->ref_dwt2, &buf->i4_ref_dwt2, w, h, buf_stride);
-			i16_to_i32(&buf->dis_dwt2, &buf->i4_dis_dwt2, w, h, buf_stride);
-
-			w = (w + 1) / 2;
-			h = (h + 1) / 2;
-
-			adm_decouple(buf, w, h, buf_stride, adm_enhn_gain_limit);
+        AdmBandJob job = {
+            .s = s,
+            .buf = buf,
+            .ref_pic = ref_pic,
+            .dis_pic = dis_pic,
+            .i4_ref_scale = i4_curr_ref_scale,
+            .i4_dis_scale = i4_curr_dis_scale,
+            .ref_stride = curr_ref_stride,
+            .dis_stride = curr_dis_stride,
+            .buf_stride = buf_stride,
+            .scale = scale,
+            .w = w,
+            .h = h,
+            .n_bands = adm_n_bands(s, (h + 1) / 2),
+            .adm_enhn_gain_limit = adm_enhn_gain_limit,
+        };
+
+        if (scale > 0 && job.n_bands > 1) {
+            // the DWT overwrites its input in place, which only works
+            // as long as the rows are processed in order
+            const size_t sz = h * buf_stride * sizeof(int32_t);
+            memcpy(s->i4_scale_in, i4_curr_ref_scale, sz);
+            memcpy(s->i4_scale_in + h * buf_stride, i4_curr_dis_scale, sz);
+            job.i4_ref_scale = s->i4_scale_in;
+            job.i4_dis_scale = s->i4_scale_in + h * buf_stride;
+        }
 
-			den_scale = adm_csf_den_scale(&buf->ref_dwt2, w, h, buf_stride);
+        int err = vmaf_thread_pool_parallel_for(thread_pool, job.n_bands,
+                                                adm_dwt_decouple_csf_band,
+                                                &job);
+        if (err) return err;
+        err = vmaf_thread_pool_parallel_for(thread_pool, job.n_bands,
+                                            adm_cm_band, &job);
+        if (err) return err;
+
+        uint64_t den_accum[3] = { 0 };
+        int64_t num_accum[3] = { 0 };
+        for (unsigned i = 0; i < job.n_bands; i++) {
+            for (unsigned k = 0; k < 3; k++) {
+                den_accum[k] += s->band[i].den_accum[k];
+                num_accum[k] += s->band[i].num_accum[k];
+            }
+        }
 
-			adm_csf(buf, w, h, buf_stride);
+		w = (w + 1) / 2;
+		h = (h + 1) / 2;
 
-			num_scale = adm_cm(buf, w, h, buf_stride, buf_stride);
+		if(scale==0) {
+			den_scale = adm_csf_den_scale(w, h, den_accum);
+			num_scale = adm_cm_score(w, h, num_accum);
 		}
 		else {
-            adm_dwt2_s123_combined(i4_curr_ref_scale, i4_curr_dis_scale, buf, w, h, curr_ref_stride,
-                                   curr_dis_stride, buf_stride, scale);
-
-			w = (w + 1) / 2;
-			h = (h + 1) / 2;
-
-			adm_decouple_s123(buf, w, h, buf_stride, adm_enhn_gain_limit);
-
-			den_scale = adm_csf_den_s123(&buf->i4_ref_dwt2, scale, w, h, buf_stride);
-
-			i4_adm_csf(buf, scale, w, h, buf_stride);
-
-			num_scale = i4_adm_cm(buf, w, h, buf_stride, buf_stride, scale);
+			den_scale = adm_csf_den_s123(scale, w, h, den_accum);
+			num_scale = i4_adm_cm_score(w, h, scale, num_accum);
 		}
 
 		num += num_scale;
@@ -2440,6 +2690,7 @@ void integer_compute_adm(AdmState *s, VmafPicture *ref_pic, VmafPicture *dis_pic
     *score_num = num;
     *score_den = den;
 
+    return 0;
 }
 
 static inline void *init_dwt_band(adm_dwt_band_t *band, char *data_top, size_t stride)
@@ -2495,13 +2746,44 @@ static int init(VmafFeatureExtractor *fex, enum VmafPixelFormat pix_fmt,
     (void) bpc;
 
     s->dwt2_8 = adm_dwt2_8;
+    s->dwt2_16 = adm_dwt2_16;
+    s->dwt2_s123_combined = adm_dwt2_s123_combined;
+    s->decouple = adm_decouple;
+    s->decouple_s123 = adm_decouple_s123;
+    s->csf = adm_csf;
+    s->i4_csf = i4_adm_csf;
+    s->cm = adm_cm;
+    s->i4_cm = i4_adm_cm;
 
 #if ARCH_X86
     unsigned flags = vmaf_get_cpu_flags();
     if (flags & VMAF_X86_CPU_FLAG_AVX2) {
         s->dwt2_8 = adm_dwt2_8_avx2;
+        s->dwt2_16 = adm_dwt2_16_avx2;
+        s->dwt2_s123_combined = adm_dwt2_s123_combined_avx2;
+        s->decouple = adm_decouple_avx2;
+        s->decouple_s123 = adm_decouple_s123_avx2;
+        s->csf = adm_csf_avx2;
+        s->i4_csf = i4_adm_csf_avx2;
+        s->cm = adm_cm_avx2;
+        s->i4_cm = i4_adm_cm_avx2;
+    }
+#if HAVE_AVX512
+    if (flags & VMAF_X86_CPU_FLAG_AVX512) {
+        s->dwt2_8 = adm_dwt2_8_avx512;
+        s->dwt2_16 = adm_dwt2_16_avx512;
+        s->dwt2_s123_combined = adm_dwt2_s123_combined_avx512;
+        s->decouple = adm_decouple_avx512;
+        s->decouple_s123 = adm_decouple_s123_avx512;
+        s->csf = adm_csf_avx512;
+        s->i4_csf = i4_adm_csf_avx512;
+        s->cm = adm_cm_avx512;
+        s->i4_cm = i4_adm_cm_avx512;
     }
 #endif
+#endif
+
+    s->n_bands = MAX(vmaf_thread_pool_n_threads(fex->thread_pool), 1);
 
     s->integer_stride   = ALIGN_CEIL(w * sizeof(int32_t));
     s->buf.ind_size_x   = ALIGN_CEIL(((w + 1) / 2) * sizeof(int32_t));
@@ -2537,7 +2819,23 @@ static int init(VmafFeatureExtractor *fex, enum VmafPixelFormat pix_fmt,
     void *ind_buf_x = s->buf.buf_x_orig;
     init_index(s->buf.ind_x, ind_buf_x, s->buf.ind_size_x);
 
+    s->band = malloc(sizeof(*s->band) * s->n_bands);
+    if (!s->band) goto free_ref;
+    memset(s->band, 0, sizeof(*s->band) * s->n_bands);
+    s->band[0].tmp_ref = s->buf.tmp_ref;
+
+    if (s->n_bands > 1) {
+        const size_t tmp_sz = s->integer_stride * 4;
+        s->band_data = aligned_malloc(tmp_sz * s->n_bands, MAX_ALIGN);
+        if (!s->band_data) goto free_ref;
+        for (unsigned i = 0; i < s->n_bands; i++)
+            s->band[i].tmp_ref = (char *)s->band_data + i * tmp_sz;
+        s->i4_scale_in = aligned_malloc(buf_sz_one * 2, MAX_ALIGN);
+        if (!s->i4_scale_in) goto free_ref;
+    }
+
     div_lookup_generator();
+    s->buf.div_lookup = div_lookup;
 
     return 0;
 
@@ -2546,10 +2844,24 @@ free_ref:
     if (s->buf.tmp_ref)     aligned_free(s->buf.tmp_ref);
     if (s->buf.buf_x_orig)  aligned_free(s->buf.buf_x_orig);
     if (s->buf.buf_y_orig)  aligned_free(s->buf.buf_y_orig);
+    if (s->band_data)       aligned_free(s->band_data);
+    if (s->i4_scale_in)     aligned_free(s->i4_scale_in);
+    free(s->band);
 
     return -ENOMEM;
 }
 
+static const char *feature_name[] = {
+    "VMAF_integer_feature_adm2_score",
+    "integer_adm_scale0", "integer_adm_scale1",
+    "integer_adm_scale2", "integer_adm_scale3",
+    "integer_adm", "integer_adm_num", "integer_adm_den",
+    "integer_adm_num_scale0", "integer_adm_den_scale0",
+    "integer_adm_num_scale1", "integer_adm_den_scale1",
+    "integer_adm_num_scale2", "integer_adm_den_scale2",
+    "integer_adm_num_scale3", "integer_adm_den_scale3",
+};
+
 static int extract(VmafFeatureExtractor *fex,
                    VmafPicture *ref_pic, VmafPicture *ref_pic_90,
                    VmafPicture *dist_pic, VmafPicture *dist_pic_90,
@@ -2564,52 +2876,31 @@ static int extract(VmafFeatureExtractor *fex,
     double score, score_num, score_den;
     double scores[8];
 
-    integer_compute_adm(s, ref_pic, dist_pic, &score, &score_num, &score_den,
-            scores, &s->buf, s->adm_enhn_gain_limit);
-
-    err |= vmaf_feature_collector_append(feature_collector,
-                                        "VMAF_integer_feature_adm2_score",
-                                        score, index);
-
-    err |= vmaf_feature_collector_append(feature_collector,
-                                        "integer_adm_scale0",
-                                        scores[0] / scores[1], index);
-
-    err |= vmaf_feature_collector_append(feature_collector,
-                                        "integer_adm_scale1",
-                                        scores[2] / scores[3], index);
-
-    err |= vmaf_feature_collector_append(feature_collector,
-                                        "integer_adm_scale2",
-                                        scores[4] / scores[5], index);
-
-    err |= vmaf_feature_collector_append(feature_collector,
-                                        "integer_adm_scale3",
-                                        scores[6] / scores[7], index);
-
-    if (s->debug) {
-        err |= vmaf_feature_collector_append(feature_collector, "integer_adm",
-                                             score, index);
-        err |= vmaf_feature_collector_append(feature_collector, "integer_adm_num",
-                                             score_num, index);
-        err |= vmaf_feature_collector_append(feature_collector, "integer_adm_den",
-                                             score_den, index);
-        err |= vmaf_feature_collector_append(feature_collector, "integer_adm_num_scale0",
-                                             scores[0], index);
-        err |= vmaf_feature_collector_append(feature_collector, "integer_adm_den_scale0",
-                                             scores[1], index);
-        err |= vmaf_feature_collector_append(feature_collector, "integer_adm_num_scale1",
-                                             scores[2], index);
-        err |= vmaf_feature_collector_append(feature_collector, "integer_adm_den_scale1",
-                                             scores[3], index);
-        err |= vmaf_feature_collector_append(feature_collector, "integer_adm_num_scale2",
-                                             scores[4], index);
-        err |= vmaf_feature_collector_append(feature_collector, "integer_adm_den_scale2",
-                                             scores[5], index);
-        err |= vmaf_feature_collector_append(feature_collector, "integer_adm_num_scale3",
-                                             scores[6], index);
-        err |= vmaf_feature_collector_append(feature_collector, "integer_adm_den_scale3",
-                                             scores[7], index);
+    err = integer_compute_adm(s, ref_pic, dist_pic, &score, &score_num,
+                              &score_den, scores, &s->buf,
+                              s->adm_enhn_gain_limit, fex->thread_pool);
+    if (err) return err;
+
+    const double feature[] = {
+        score,
+        scores[0] / scores[1], scores[2] / scores[3],
+        scores[4] / scores[5], scores[6] / scores[7],
+        score, score_num, score_den,
+        scores[0], scores[1], scores[2], scores[3],
+        scores[4], scores[5], scores[6], scores[7],
+    };
+
+    err = vmaf_feature_collector_register_list(feature_collector,
+                                               &s->feature_collector,
+                                               feature_name, s->feature_id,
+                                               s->debug ? 16 : 5);
+    if (err) return err;
+
+    const unsigned cnt = s->debug ? 16 : 5;
+    for (unsigned i = 0; i < cnt; i++) {
+        err |= vmaf_feature_collector_append_id(feature_collector,
+                                                s->feature_id[i], feature[i],
+                                                index);
     }
 
     if (err) return err;
@@ -2625,6 +2916,9 @@ static int close(VmafFeatureExtractor *fex)
     if (s->buf.tmp_ref)     aligned_free(s->buf.tmp_ref);
     if (s->buf.buf_x_orig)  aligned_free(s->buf.buf_x_orig);
     if (s->buf.buf_y_orig)  aligned_free(s->buf.buf_y_orig);
+    if (s->band_data)       aligned_free(s->band_data);
+    if (s->i4_scale_in)     aligned_free(s->i4_scale_in);
+    free(s->band);
 
     return 0;
 }
@@ -8,17 +8,6 @@
 #include <stdint.h>
 #include <string.h>
 
-static int32_t div_lookup[65536];
-static const int32_t div_Q_factor = 1073741824; // 2^30
-
-static inline void div_lookup_generator() {
-    for (int i = 1; i <= 32768; ++i) {
-        int32_t recip = (int32_t)(div_Q_factor / i);
-        div_lookup[32768 + i] = recip;
-        div_lookup[32768 - i] = 0 - recip;
-    }
-}
-
 typedef struct adm_dwt_band_t {
     int16_t *band_a; /* Low-pass V + low-pass H. */
     int16_t *band_v; /* Low-pass V + high-pass H. */
@@ -40,6 +29,7 @@ typedef struct AdmBuffer {
     void *buf_x_orig; // buffer for storing imgcoeff values along x.
     void *buf_y_orig; // buffer for storing imgcoeff values along y.
     int *ind_y[4], *ind_x[4];
+    const int32_t *div_lookup; // 2^30 / i for i in [-32768, 32768]
 
     adm_dwt_band_t ref_dwt2;
     adm_dwt_band_t dis_dwt2;
@@ -151,4 +141,23 @@ static const float dwt_7_9_basis_function_amplitudes[6][4] = {
     {0.045943, 0.059758, 0.077727, 0.059758},
     {0.023013, 0.030018, 0.039156, 0.030018}};
 
+/*
+ * lambda = 0 (finest scale), 1, 2, 3 (coarsest scale);
+ * theta = 0 (ll), 1 (lh - vertical), 2 (hh - diagonal), 3(hl - horizontal).
+ */
+static inline float
+dwt_quant_step(const struct dwt_model_params *params, int lambda, int theta)
+{
+    // Formula (1), page 1165 - display visual resolution (DVR), in pixels/degree
+    // of visual angle. This should be 56.55
+    float r = VIEW_DIST * REF_DISPLAY_HEIGHT * M_PI / 180.0;
+
+    // Formula (9), page 1171
+    float temp = log10(pow(2.0, lambda + 1)*params->f0*params->g[theta] / r);
+    float Q = 2.0*params->a*pow(10.0, params->k*temp*temp) /
+        dwt_7_9_basis_function_amplitudes[lambda][theta];
+
+    return Q;
+}
+
 #endif /* _FEATURE_ADM_H_ */
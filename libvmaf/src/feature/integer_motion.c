@@ -37,7 +37,7 @@
 
 typedef struct MotionState {
     VmafPicture tmp;
-    VmafPicture blur[3];
+    VmafPicture blur[2];
     unsigned index;
     double score;
     bool debug;
@@ -48,7 +48,12 @@ typedef struct MotionState {
     void (*x_convolution)(const uint16_t *src, uint16_t *dst, unsigned width,
                           unsigned height, ptrdiff_t src_stride,
                           ptrdiff_t dst_stride);
-    void (*sad)(VmafPicture *pic_a, VmafPicture *pic_b, uint64_t *sad);
+    void (*x_convolution_sad)(const uint16_t *src, uint16_t *dst,
+                              const uint16_t *prev, unsigned width,
+                              unsigned height, ptrdiff_t src_stride,
+                              ptrdiff_t dst_stride, uint64_t *sad);
+    VmafFeatureCollector *feature_collector;
+    unsigned feature_id[2];
 } MotionState;
 
 static const VmafOption options[] = {
@@ -219,23 +224,38 @@ y_convolution_8(void *src, uint16_t *dst, unsigned width,
     }
 }
 
-static void sad_c(VmafPicture *pic_a, VmafPicture *pic_b, uint64_t *sad)
+static void sad_c(const uint16_t *a, const uint16_t *b, unsigned width,
+                  unsigned height, ptrdiff_t stride, uint64_t *sad)
 {
     *sad = 0;
 
-    uint16_t *a = pic_a->data[0];
-    uint16_t *b = pic_b->data[0];
-    for (unsigned i = 0; i < pic_a->h[0]; i++) {
+    for (unsigned i = 0; i < height; i++) {
         uint32_t inner_sad = 0;
-        for (unsigned j = 0; j < pic_a->w[0]; j++) {
+        for (unsigned j = 0; j < width; j++) {
             inner_sad += abs(a[j] - b[j]);
         }
         *sad += inner_sad;
-        a += (pic_a->stride[0] / 2);
-        b += (pic_b->stride[0] / 2);
+        a += stride;
+        b += stride;
     }
 }
 
+/* Blurs `src` into `dst` and returns the SAD of `dst` against `prev`, the
+ * previous blurred frame. `prev` shares the stride of `dst`. */
+static void x_convolution_16_sad(const uint16_t *src, uint16_t *dst,
+                                 const uint16_t *prev, unsigned width,
+                                 unsigned height, ptrdiff_t src_stride,
+                                 ptrdiff_t dst_stride, uint64_t *sad)
+{
+    x_convolution_16(src, dst, width, height, src_stride, dst_stride);
+    sad_c(prev, dst, width, height, dst_stride, sad);
+}
+
+static const char *feature_name[] = {
+    "VMAF_integer_feature_motion2_score",
+    "VMAF_integer_feature_motion_score",
+};
+
 static int extract_force_zero(VmafFeatureExtractor *fex,
                               VmafPicture *ref_pic, VmafPicture *ref_pic_90,
                               VmafPicture *dist_pic, VmafPicture *dist_pic_90,
@@ -249,15 +269,17 @@ static int extract_force_zero(VmafFeatureExtractor *fex,
     (void) ref_pic_90;
     (void) dist_pic;
     (void) dist_pic_90;
-    int err = 0;
+    int err = vmaf_feature_collector_register_list(feature_collector,
+                                                   &s->feature_collector,
+                                                   feature_name, s->feature_id,
+                                                   s->debug ? 2 : 1);
+    if (err) return err;
 
-    err = vmaf_feature_collector_append(feature_collector,
-                                         "VMAF_integer_feature_motion2_score",
-                                         0., index);
+    err = vmaf_feature_collector_append_id(feature_collector, s->feature_id[0],
+                                           0., index);
     if (s->debug) {
-        err |= vmaf_feature_collector_append(feature_collector,
-                                            "VMAF_integer_feature_motion_score",
-                                            0., index);
+        err |= vmaf_feature_collector_append_id(feature_collector,
+                                                s->feature_id[1], 0., index);
     }
     return err;
 }
@@ -278,30 +300,36 @@ static int init(VmafFeatureExtractor *fex, enum VmafPixelFormat pix_fmt,
     err |= vmaf_picture_alloc(&s->tmp, pix_fmt, 16, w, h);
     err |= vmaf_picture_alloc(&s->blur[0], pix_fmt, 16, w, h);
     err |= vmaf_picture_alloc(&s->blur[1], pix_fmt, 16, w, h);
-    err |= vmaf_picture_alloc(&s->blur[2], pix_fmt, 16, w, h);
     if (err) goto fail;
 
     s->y_convolution = bpc == 8 ? y_convolution_8 : y_convolution_16;
     s->x_convolution = x_convolution_16;
+    s->x_convolution_sad = x_convolution_16_sad;
 
 #if ARCH_X86
     unsigned flags = vmaf_get_cpu_flags();
-    if (flags & VMAF_X86_CPU_FLAG_AVX2)
+    if (flags & VMAF_X86_CPU_FLAG_AVX2) {
+        s->y_convolution =
+            bpc == 8 ? y_convolution_8_avx2 : y_convolution_16_avx2;
         s->x_convolution = x_convolution_16_avx2;
+        s->x_convolution_sad = x_convolution_16_sad_avx2;
+    }
 #if HAVE_AVX512
-    if (flags & VMAF_X86_CPU_FLAG_AVX512)
+    if (flags & VMAF_X86_CPU_FLAG_AVX512) {
+        s->y_convolution =
+            bpc == 8 ? y_convolution_8_avx512 : y_convolution_16_avx512;
         s->x_convolution = x_convolution_16_avx512;
+        s->x_convolution_sad = x_convolution_16_sad_avx512;
+    }
 #endif
 #endif
 
-    s->sad = sad_c;
     s->score = 0.;
     return 0;
 
 fail:
     err |= vmaf_picture_unref(&s->blur[0]);
     err |= vmaf_picture_unref(&s->blur[1]);
-    err |= vmaf_picture_unref(&s->blur[2]);
     err |= vmaf_picture_unref(&s->tmp);
     return err;
 }
@@ -313,9 +341,14 @@ static int flush(VmafFeatureExtractor *fex,
     int ret = 0;
 
     if (s->index > 0) {
-        ret = vmaf_feature_collector_append(feature_collector,
-                                            "VMAF_integer_feature_motion2_score",
-                                            s->score, s->index);
+        ret = vmaf_feature_collector_register_list(feature_collector,
+                                                   &s->feature_collector,
+                                                   feature_name, s->feature_id,
+                                                   s->debug ? 2 : 1);
+        if (ret) return ret;
+        ret = vmaf_feature_collector_append_id(feature_collector,
+                                               s->feature_id[0],
+                                               s->score, s->index);
     }
 
     return (ret < 0) ? ret : !ret;
@@ -340,9 +373,8 @@ static int extract(VmafFeatureExtractor *fex,
     (void) dist_pic_90;
 
     s->index = index;
-    const unsigned blur_idx_0 = (index + 0) % 3;
-    const unsigned blur_idx_1 = (index + 1) % 3;
-    const unsigned blur_idx_2 = (index + 2) % 3;
+    VmafPicture *blur = &s->blur[index % 2];
+    VmafPicture *prev_blur = &s->blur[(index + 1) % 2];
 
     const ptrdiff_t y_src_stride =
         ref_pic->bpc == 8 ? ref_pic->stride[0] : ref_pic->stride[0] / 2;
@@ -351,48 +383,60 @@ static int extract(VmafFeatureExtractor *fex,
                      ref_pic->h[0], y_src_stride, s->tmp.stride[0] / 2,
                      ref_pic->bpc);
 
-    s->x_convolution(s->tmp.data[0], s->blur[blur_idx_0].data[0],
-                     s->tmp.w[0], s->tmp.h[0], s->tmp.stride[0] / 2,
-                     s->blur[blur_idx_0].stride[0] / 2);
+    err = vmaf_feature_collector_register_list(feature_collector,
+                                               &s->feature_collector,
+                                               feature_name, s->feature_id,
+                                               s->debug ? 2 : 1);
+    if (err) return err;
 
     if (index == 0) {
-        err = vmaf_feature_collector_append(feature_collector,
-                                            "VMAF_integer_feature_motion2_score",
-                                            0., index);
+        s->x_convolution(s->tmp.data[0], blur->data[0], s->tmp.w[0],
+                         s->tmp.h[0], s->tmp.stride[0] / 2,
+                         blur->stride[0] / 2);
+        err = vmaf_feature_collector_append_id(feature_collector,
+                                               s->feature_id[0], 0., index);
         if (s->debug) {
-            err |= vmaf_feature_collector_append(feature_collector,
-                                                 "VMAF_integer_feature_motion_score",
-                                                 0., index);
+            err |= vmaf_feature_collector_append_id(feature_collector,
+                                                    s->feature_id[1],
+                                                    0., index);
         }
         return err;
     }
 
     uint64_t sad;
-    s->sad(&s->blur[blur_idx_2], &s->blur[blur_idx_0], &sad);
-    double score = s->score =
-        normalize_and_scale_sad(sad, ref_pic->w[0], ref_pic->h[0]);
+    s->x_convolution_sad(s->tmp.data[0], blur->data[0], prev_blur->data[0],
+                         s->tmp.w[0], s->tmp.h[0], s->tmp.stride[0] / 2,
+                         blur->stride[0] / 2, &sad);
+    double score = normalize_and_scale_sad(sad, ref_pic->w[0], ref_pic->h[0]);
+
+    /* The SAD of the previous two frames is the previous score. */
+    double score2 = s->score;
+    s->score = score;
 
     if (s->debug) {
-        err |= vmaf_feature_collector_append(feature_collector,
-                                             "VMAF_integer_feature_motion_score",
-                                             score, index);
+        err |= vmaf_feature_collector_append_id(feature_collector,
+                                                s->feature_id[1], score, index);
     }
     if (err) return err;
 
     if (index == 1)
         return 0;
 
-    uint64_t sad2;
-    s->sad(&s->blur[blur_idx_2], &s->blur[blur_idx_1], &sad2);
-    double score2 = normalize_and_scale_sad(sad2, ref_pic->w[0], ref_pic->h[0]);
-
     score2 = score2 < score ? score2 : score;
-    err = vmaf_feature_collector_append(feature_collector,
-                                        "VMAF_integer_feature_motion2_score",
-                                        score2, index - 1);
+    err = vmaf_feature_collector_append_id(feature_collector, s->feature_id[0],
+                                           score2, index - 1);
     return err;
 }
 
+static int reset(VmafFeatureExtractor *fex)
+{
+    MotionState *s = fex->priv;
+
+    s->index = 0;
+    s->score = 0.;
+    return 0;
+}
+
 static int close(VmafFeatureExtractor *fex)
 {
     MotionState *s = fex->priv;
@@ -400,7 +444,6 @@ static int close(VmafFeatureExtractor *fex)
     int err = 0;
     err |= vmaf_picture_unref(&s->blur[0]);
     err |= vmaf_picture_unref(&s->blur[1]);
-    err |= vmaf_picture_unref(&s->blur[2]);
     err |= vmaf_picture_unref(&s->tmp);
     return err;
 }
@@ -415,6 +458,7 @@ VmafFeatureExtractor vmaf_fex_integer_motion = {
     .init = init,
     .extract = extract,
     .flush = flush,
+    .reset = reset,
     .close = close,
     .options = options,
     .priv_size = sizeof(MotionState),
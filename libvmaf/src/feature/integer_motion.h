@@ -25,6 +25,17 @@
 static const uint16_t filter[5] = { 3571, 16004, 26386, 16004, 3571 };
 static const int filter_width = sizeof(filter) / sizeof(filter[0]);
 
+/* Reflects an out-of-range tap back into [0, n), same as edge_16(). */
+static inline int
+mirror_tap(int i, int n)
+{
+    if (i < 0)
+        return -i;
+    if (i >= n)
+        return n - (i - n + 1);
+    return i;
+}
+
 static inline uint32_t
 edge_16(bool horizontal, const uint16_t *src, int width,
         int height, int stride, int i, int j)
@@ -27,6 +27,8 @@
 
 typedef struct PsnrState {
     bool enable_chroma;
+    VmafFeatureCollector *feature_collector;
+    unsigned feature_id[3];
 } PsnrState;
 
 static const VmafOption options[] = {
@@ -45,7 +47,7 @@ static const VmafOption options[] = {
 
 static int psnr8(VmafPicture *ref_pic, VmafPicture *dist_pic,
                  unsigned index, VmafFeatureCollector *feature_collector,
-                 bool enable_chroma)
+                 bool enable_chroma, const unsigned *feature_id)
 {
     int err = 0;
     const unsigned n = enable_chroma ? 3 : 1;
@@ -70,9 +72,8 @@ static int psnr8(VmafPicture *ref_pic, VmafPicture *dist_pic,
         double peak = 255.0;
         double score = MIN(10 * log10(peak * peak / MAX(noise, eps)), psnr_max);
 
-        const char *feature_name[3] = { "psnr_y", "psnr_cb", "psnr_cr" };
-        err = vmaf_feature_collector_append(feature_collector, feature_name[i],
-                                            score, index);
+        err = vmaf_feature_collector_append_id(feature_collector, feature_id[i],
+                                               score, index);
         if (err) return err;
     }
 
@@ -81,7 +82,8 @@ static int psnr8(VmafPicture *ref_pic, VmafPicture *dist_pic,
 
 static int psnr10plus(VmafPicture *ref_pic, VmafPicture *dist_pic,
                       unsigned index, VmafFeatureCollector *feature_collector,
-                      bool enable_chroma, float scaler, double peak, double psnr_max)
+                      bool enable_chroma, const unsigned *feature_id,
+                      float scaler, double peak, double psnr_max)
 {
     int err = 0;
     const unsigned n = enable_chroma ? 3 : 1;
@@ -104,15 +106,20 @@ static int psnr10plus(VmafPicture *ref_pic, VmafPicture *dist_pic,
         double eps = 1e-16; // make consistent with PyspnrFeatureExtractor
         double score = MIN(10 * log10(peak * peak / MAX(noise, eps)), psnr_max);
 
-        const char *feature_name[3] = { "psnr_y", "psnr_cb", "psnr_cr" };
-        err = vmaf_feature_collector_append(feature_collector, feature_name[i],
-                                            score, index);
+        err = vmaf_feature_collector_append_id(feature_collector, feature_id[i],
+                                               score, index);
         if (err) return err;
     }
 
     return 0;
 }
 
+static const char *feature_name[] = {
+    "psnr_y",
+    "psnr_cb",
+    "psnr_cr",
+};
+
 static int extract(VmafFeatureExtractor *fex,
                    VmafPicture *ref_pic, VmafPicture *ref_pic_90,
                    VmafPicture *dist_pic, VmafPicture *dist_pic_90,
@@ -123,19 +130,28 @@ static int extract(VmafFeatureExtractor *fex,
     (void) ref_pic_90;
     (void) dist_pic_90;
 
+    int err = vmaf_feature_collector_register_list(feature_collector,
+                                                   &s->feature_collector,
+                                                   feature_name, s->feature_id,
+                                                   s->enable_chroma ? 3 : 1);
+    if (err) return err;
+
     switch(ref_pic->bpc) {
     case 8:
         return psnr8(ref_pic, dist_pic, index, feature_collector,
-                     s->enable_chroma);
+                     s->enable_chroma, s->feature_id);
     case 10:
         return psnr10plus(ref_pic, dist_pic, index, feature_collector,
-                          s->enable_chroma, 4.0f, 255.75, 72.0);
+                          s->enable_chroma, s->feature_id,
+                          4.0f, 255.75, 72.0);
     case 12:
         return psnr10plus(ref_pic, dist_pic, index, feature_collector,
-                          s->enable_chroma, 16.0f, 255.9375, 84.0);
+                          s->enable_chroma, s->feature_id,
+                          16.0f, 255.9375, 84.0);
     case 16:
         return psnr10plus(ref_pic, dist_pic, index, feature_collector,
-                          s->enable_chroma, 256.0f, 255.99609375, 108.0);
+                          s->enable_chroma, s->feature_id,
+                          256.0f, 255.99609375, 108.0);
     default:
         return -EINVAL;
     }
@@ -196,26 +196,43 @@ static double calc_ssim(const unsigned char *_src,int _systride,
   return ssim/ssimw;
 }
 
+typedef struct SsimState {
+    VmafFeatureCollector *feature_collector;
+    unsigned ssim_id;
+} SsimState;
+
 static int init(VmafFeatureExtractor *fex, enum VmafPixelFormat pix_fmt,
                 unsigned bpc, unsigned w, unsigned h)
 {
     return 0;
 }
 
+static const char *feature_name[] = {
+    "ssim",
+};
+
 static int extract(VmafFeatureExtractor *fex,
                    VmafPicture *ref_pic, VmafPicture *ref_pic_90,
                    VmafPicture *dist_pic, VmafPicture *dist_pic_90,
                    unsigned index, VmafFeatureCollector *feature_collector)
 {
+    SsimState *s = fex->priv;
+
     (void) ref_pic_90;
     (void) dist_pic_90;
 
+    int err = vmaf_feature_collector_register_list(feature_collector,
+                                                   &s->feature_collector,
+                                                   feature_name, &s->ssim_id,
+                                                   1);
+    if (err) return err;
+
     double score =
         calc_ssim(ref_pic->data[0], ref_pic->stride[0],
                   dist_pic->data[0], dist_pic->stride[0], 1.0, ref_pic->bpc,
                   ref_pic->w[0], ref_pic->h[0]);
-    int err =
-        vmaf_feature_collector_append(feature_collector, "ssim", score, index);
+    err = vmaf_feature_collector_append_id(feature_collector, s->ssim_id,
+                                           score, index);
     if (err) return err;
     return 0;
 }
@@ -235,5 +252,6 @@ VmafFeatureExtractor vmaf_fex_ssim = {
     .init = init,
     .extract = extract,
     .close = close,
+    .priv_size = sizeof(SsimState),
     .provided_features = provided_features,
 };
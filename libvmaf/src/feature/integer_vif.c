@@ -36,17 +36,29 @@
 #endif
 #endif
 
+typedef struct VifBand {
+    VifBuffer buf; ///< tmp rows owned by this band
+    VifAccum accum;
+} VifBand;
+
 typedef struct VifState {
     VifBuffer buf;
     uint16_t log2_table[65537];
     bool debug;
     double vif_enhn_gain_limit;
+    unsigned n_bands;
+    VifBand *band;
+    void *band_data;
     void (*filter1d_8)(VifBuffer buf, unsigned w, unsigned h);
     void (*filter1d_16)(VifBuffer buf, unsigned w, unsigned h, int scale,
                         int bpc);
     void (*filter1d_rd_8)(VifBuffer buf, unsigned w, unsigned h);
     void (*filter1d_rd_16)(VifBuffer buf, unsigned w, unsigned h, int scale,
                            int bpc);
+    void (*statistic)(VifBuffer buf, VifAccum *accum, unsigned w, unsigned h,
+                      uint16_t *log2_table, double vif_enhn_gain_limit);
+    VmafFeatureCollector *feature_collector;
+    unsigned feature_id[15];
 } VifState;
 
 static const VmafOption options[] = {
@@ -71,25 +83,7 @@ static const VmafOption options[] = {
 };
 
 static FORCE_INLINE inline void
-pad_top_and_bottom(VifBuffer buf, unsigned h, int fwidth)
-{
-    const unsigned fwidth_half = fwidth / 2;
-    void *ref = buf.ref; void *dis = buf.dis;
-    for (unsigned i = 1; i <= fwidth_half; ++i) {
-        size_t offset = buf.stride * i;
-        memcpy(ref - offset, ref + offset, buf.stride);
-        memcpy(dis - offset, dis + offset, buf.stride);
-        memcpy(ref + buf.stride * (h - 1) + buf.stride * i,
-               ref + buf.stride * (h - 1) - buf.stride * i,
-               buf.stride);
-        memcpy(dis + buf.stride * (h - 1) + buf.stride * i,
-               dis + buf.stride * (h - 1) - buf.stride * i,
-               buf.stride);
-    }
-}
-
-static FORCE_INLINE inline void
-decimate_and_pad(VifBuffer buf, unsigned w, unsigned h, int scale)
+decimate(VifBuffer buf, unsigned w, unsigned h)
 {
     uint16_t *ref = buf.ref;
     uint16_t *dis = buf.dis;
@@ -102,7 +96,6 @@ decimate_and_pad(VifBuffer buf, unsigned w, unsigned h, int scale)
             dis[i * stride + j] = buf.mu2[(i * 2) * mu_stride + (j * 2)];
         }
     }
-    pad_top_and_bottom(buf, h / 2, vif_filter1d_width[scale]);
 }
 
 static FORCE_INLINE inline uint16_t
@@ -143,6 +136,8 @@ static void filter1d_8(VifBuffer buf, unsigned w, unsigned h)
     const uint16_t *vif_filt_s0 = vif_filter1d_table[0];
 
     for (unsigned i = 0; i < h; ++i) {
+        ptrdiff_t row[18];
+        vif_filter_rows(buf, i, fwidth, buf.stride, row);
         //VERTICAL
         for (unsigned j = 0; j < w; ++j) {
             uint32_t accum_mu1 = 0;
@@ -151,13 +146,11 @@ static void filter1d_8(VifBuffer buf, unsigned w, unsigned h)
             uint32_t accum_dis = 0;
             uint32_t accum_ref_dis = 0;
             for (unsigned fi = 0; fi < fwidth; ++fi) {
-                int ii = i - fwidth / 2;
-                int ii_check = ii + fi;
                 const uint16_t fcoeff = vif_filt_s0[fi];
                 const uint8_t *ref = (uint8_t*)buf.ref;
                 const uint8_t *dis = (uint8_t*)buf.dis;
-                uint16_t imgcoeff_ref = ref[ii_check * buf.stride + j];
-                uint16_t imgcoeff_dis = dis[ii_check * buf.stride + j];
+                uint16_t imgcoeff_ref = ref[row[fi] + j];
+                uint16_t imgcoeff_dis = dis[row[fi] + j];
                 uint32_t img_coeff_ref = fcoeff * (uint32_t)imgcoeff_ref;
                 uint32_t img_coeff_dis = fcoeff * (uint32_t)imgcoeff_dis;
                 accum_mu1 += img_coeff_ref;
@@ -207,6 +200,7 @@ static void filter1d_16(VifBuffer buf, unsigned w, unsigned h, int scale,
 {
     const unsigned fwidth = vif_filter1d_width[scale];
     const uint16_t *vif_filt = vif_filter1d_table[scale];
+    const ptrdiff_t stride = buf.stride / sizeof(uint16_t);
 
     int32_t add_shift_round_HP, shift_HP;
     int32_t add_shift_round_VP, shift_VP;
@@ -228,6 +222,8 @@ static void filter1d_16(VifBuffer buf, unsigned w, unsigned h, int scale,
     }
 
     for (unsigned i = 0; i < h; ++i) {
+        ptrdiff_t row[18];
+        vif_filter_rows(buf, i, fwidth, stride, row);
         //VERTICAL
         for (unsigned j = 0; j < w; ++j) {
             uint32_t accum_mu1 = 0;
@@ -236,14 +232,11 @@ static void filter1d_16(VifBuffer buf, unsigned w, unsigned h, int scale,
             uint64_t accum_dis = 0;
             uint64_t accum_ref_dis = 0;
             for (unsigned fi = 0; fi < fwidth; ++fi) {
-                int ii = i - fwidth / 2;
-                int ii_check = ii + fi;
                 const uint16_t fcoeff = vif_filt[fi];
-                const ptrdiff_t stride = buf.stride / sizeof(uint16_t);
                 uint16_t *ref = buf.ref;
                 uint16_t *dis = buf.dis;
-                uint16_t imgcoeff_ref = ref[ii_check * stride + j];
-                uint16_t imgcoeff_dis = dis[ii_check * stride + j];
+                uint16_t imgcoeff_ref = ref[row[fi] + j];
+                uint16_t imgcoeff_dis = dis[row[fi] + j];
                 uint32_t img_coeff_ref = fcoeff * (uint32_t)imgcoeff_ref;
                 uint32_t img_coeff_dis = fcoeff * (uint32_t)imgcoeff_dis;
                 accum_mu1 += img_coeff_ref;
@@ -291,7 +284,7 @@ static void filter1d_16(VifBuffer buf, unsigned w, unsigned h, int scale,
 #define MIN(x, y) (((x) < (y)) ? (x) : (y))
 #define MAX(x, y) (((x) > (y)) ? (x) : (y))
 
-static void vif_statistic(VifBuffer buf, float *num, float *den,
+static void vif_statistic(VifBuffer buf, VifAccum *accum,
                           unsigned w, unsigned h, uint16_t *log2_table,
                           double vif_enhn_gain_limit)
 {
@@ -425,13 +418,25 @@ static void vif_statistic(VifBuffer buf, float *num, float *den,
             }
         }
     }
+
+    accum->x = accum_x;
+    accum->x2 = accum_x2;
+    accum->num_x = num_accum_x;
+    accum->num_log = accum_num_log;
+    accum->den_log = accum_den_log;
+    accum->num_non_log = accum_num_non_log;
+    accum->den_non_log = accum_den_non_log;
+}
+
+static void vif_statistic_score(const VifAccum *accum, float *num, float *den)
+{
     //log has to be divided by 2048 as log_value = log2(i*2048)  i=16384 to 65535
     //num[0] = accum_num_log / 2048.0 + (accum_den_non_log - (accum_num_non_log / 65536.0) / (255.0*255.0));
     //den[0] = accum_den_log / 2048.0 + accum_den_non_log;
 
     //changed calculation to increase performance
-    num[0] = accum_num_log / 2048.0  + accum_x2 + (accum_den_non_log - ((accum_num_non_log) / 16384.0) / (65025.0));
-    den[0] = accum_den_log / 2048.0  - (accum_x + (num_accum_x * 17)) + accum_den_non_log;
+    num[0] = accum->num_log / 2048.0  + accum->x2 + (accum->den_non_log - ((accum->num_non_log) / 16384.0) / (65025.0));
+    den[0] = accum->den_log / 2048.0  - (accum->x + (accum->num_x * 17)) + accum->den_non_log;
 }
 
 static void filter1d_rd_8(VifBuffer buf, unsigned w, unsigned h)
@@ -440,18 +445,18 @@ static void filter1d_rd_8(VifBuffer buf, unsigned w, unsigned h)
     const uint16_t *vif_filt_s1 = vif_filter1d_table[1];
 
     for (unsigned i = 0; i < h; ++i) {
+        ptrdiff_t row[18];
+        vif_filter_rows(buf, i, fwidth, buf.stride, row);
         //VERTICAL
         for (unsigned j = 0; j < w; ++j) {
             uint32_t accum_ref = 0;
             uint32_t accum_dis = 0;
             for (unsigned fi = 0; fi < fwidth; ++fi) {
-                int ii = i - fwidth / 2;
-                int ii_check = ii + fi;
                 const uint16_t fcoeff = vif_filt_s1[fi];
                 const uint8_t *ref = (uint8_t*)buf.ref;
                 const uint8_t *dis = (uint8_t*)buf.dis;
-                accum_ref += fcoeff * (uint32_t)ref[ii_check * buf.stride + j];
-                accum_dis += fcoeff * (uint32_t)dis[ii_check * buf.stride + j];
+                accum_ref += fcoeff * (uint32_t)ref[row[fi] + j];
+                accum_dis += fcoeff * (uint32_t)dis[row[fi] + j];
             }
             buf.tmp.ref_convol[j] = (accum_ref + 128) >> 8;
             buf.tmp.dis_convol[j] = (accum_dis + 128) >> 8;
@@ -482,6 +487,7 @@ static void filter1d_rd_16(VifBuffer buf, unsigned w, unsigned h, int scale,
 {
     const unsigned fwidth = vif_filter1d_width[scale + 1];
     const uint16_t *vif_filt = vif_filter1d_table[scale + 1];
+    const ptrdiff_t stride = buf.stride / sizeof(uint16_t);
     int32_t add_shift_round_VP, shift_VP;
 
     if (scale == 0) {
@@ -493,19 +499,18 @@ static void filter1d_rd_16(VifBuffer buf, unsigned w, unsigned h, int scale,
     }
 
     for (unsigned i = 0; i < h; ++i) {
+        ptrdiff_t row[18];
+        vif_filter_rows(buf, i, fwidth, stride, row);
         //VERTICAL
         for (unsigned j = 0; j < w; ++j) {
             uint32_t accum_ref = 0;
             uint32_t accum_dis = 0;
             for (unsigned fi = 0; fi < fwidth; ++fi) {
-                int ii = i - fwidth / 2;
-                int ii_check = ii + fi;
                 const uint16_t fcoeff = vif_filt[fi];
-                const ptrdiff_t stride = buf.stride / sizeof(uint16_t);
                 uint16_t *ref = buf.ref;
                 uint16_t *dis = buf.dis;
-                accum_ref += fcoeff * ((uint32_t)ref[ii_check * stride + j]);
-                accum_dis += fcoeff * ((uint32_t)dis[ii_check * stride + j]);
+                accum_ref += fcoeff * ((uint32_t)ref[row[fi] + j]);
+                accum_dis += fcoeff * ((uint32_t)dis[row[fi] + j]);
             }
             buf.tmp.ref_convol[j] = (uint16_t)((accum_ref + add_shift_round_VP) >> shift_VP);
             buf.tmp.dis_convol[j] = (uint16_t)((accum_dis + add_shift_round_VP) >> shift_VP);
@@ -531,6 +536,124 @@ static void filter1d_rd_16(VifBuffer buf, unsigned w, unsigned h, int scale,
     }
 }
 
+/*
+ * A frame is split into horizontal bands which are filtered independently.
+ * Rows above and below a band are read straight from the shared input, and
+ * mirrored at the frame edges, so every band sees the same halo as a single
+ * pass over the whole frame would.
+ * Each band only needs private scratch rows, its sums are kept apart and
+ * added up in band order afterwards, which keeps the scores bit-exact.
+ */
+#define VIF_BAND_MIN_ROWS 16
+
+typedef struct VifBandJob {
+    VifState *s;
+    void *ref, *dis; ///< input of the current scale
+    ptrdiff_t stride;
+    unsigned w, h, n_bands;
+    int scale, bpc;
+} VifBandJob;
+
+static unsigned vif_n_bands(VifState *s, unsigned h)
+{
+    const unsigned n = h / VIF_BAND_MIN_ROWS;
+    return MAX(MIN(s->n_bands, n), 1);
+}
+
+static VifBuffer vif_band_buffer(VifBandJob *job, unsigned idx,
+                                 unsigned *band_h)
+{
+    const unsigned y0 = job->h * idx / job->n_bands;
+    const unsigned y1 = job->h * (idx + 1) / job->n_bands;
+    VifState *s = job->s;
+
+    VifBuffer buf = s->buf;
+    buf.tmp = s->band[idx].buf.tmp;
+    buf.ref = (uint8_t *)job->ref + y0 * job->stride;
+    buf.dis = (uint8_t *)job->dis + y0 * job->stride;
+    buf.stride = job->stride;
+    buf.y0 = y0;
+    buf.frame_h = job->h;
+    buf.mu1 += y0 * (buf.stride_16 / sizeof(uint16_t));
+    buf.mu2 += y0 * (buf.stride_16 / sizeof(uint16_t));
+    buf.mu1_32 += y0 * (buf.stride_32 / sizeof(uint32_t));
+    buf.mu2_32 += y0 * (buf.stride_32 / sizeof(uint32_t));
+    buf.ref_sq += y0 * (buf.stride_32 / sizeof(uint32_t));
+    buf.dis_sq += y0 * (buf.stride_32 / sizeof(uint32_t));
+    buf.ref_dis += y0 * (buf.stride_32 / sizeof(uint32_t));
+
+    *band_h = y1 - y0;
+    return buf;
+}
+
+static void vif_filter1d_rd_band(void *data, unsigned idx)
+{
+    VifBandJob *job = data;
+    VifState *s = job->s;
+    unsigned h;
+    VifBuffer buf = vif_band_buffer(job, idx, &h);
+
+    if (job->bpc == 8 && job->scale == 1)
+        s->filter1d_rd_8(buf, job->w, h);
+    else
+        s->filter1d_rd_16(buf, job->w, h, job->scale - 1, job->bpc);
+}
+
+static void vif_filter1d_band(void *data, unsigned idx)
+{
+    VifBandJob *job = data;
+    VifState *s = job->s;
+    unsigned h;
+    VifBuffer buf = vif_band_buffer(job, idx, &h);
+
+    if (job->bpc == 8 && job->scale == 0)
+        s->filter1d_8(buf, job->w, h);
+    else
+        s->filter1d_16(buf, job->w, h, job->scale, job->bpc);
+
+    s->statistic(buf, &s->band[idx].accum, job->w, h, s->log2_table,
+                 s->vif_enhn_gain_limit);
+}
+
+static int init_bands(VifState *s)
+{
+    const size_t band_sz = sizeof(*s->band) * s->n_bands;
+    s->band = malloc(band_sz);
+    if (!s->band) return -ENOMEM;
+    memset(s->band, 0, band_sz);
+
+    if (s->n_bands == 1) {
+        s->band[0].buf = s->buf;
+        return 0;
+    }
+
+    // tmp rows are padded in place on both ends, keep a guard around them
+    const size_t guard = MAX_ALIGN * sizeof(uint32_t);
+    const size_t block_sz = guard + 7 * s->buf.stride_tmp + guard;
+    s->band_data = aligned_malloc(block_sz * s->n_bands, MAX_ALIGN);
+    if (!s->band_data) goto free_band;
+
+    for (unsigned i = 0; i < s->n_bands; i++) {
+        uint8_t *data = (uint8_t *)s->band_data + i * block_sz + guard;
+        VifBuffer *buf = &s->band[i].buf;
+        *buf = s->buf;
+        buf->tmp.mu1 = (uint32_t *)data; data += s->buf.stride_tmp;
+        buf->tmp.mu2 = (uint32_t *)data; data += s->buf.stride_tmp;
+        buf->tmp.ref = (uint32_t *)data; data += s->buf.stride_tmp;
+        buf->tmp.dis = (uint32_t *)data; data += s->buf.stride_tmp;
+        buf->tmp.ref_dis = (uint32_t *)data; data += s->buf.stride_tmp;
+        buf->tmp.ref_convol = (uint32_t *)data; data += s->buf.stride_tmp;
+        buf->tmp.dis_convol = (uint32_t *)data;
+    }
+
+    return 0;
+
+free_band:
+    free(s->band);
+    s->band = NULL;
+    return -ENOMEM;
+}
+
 static inline void log_generate(uint16_t *log2_table)
 {
     for (unsigned i = 32767; i < 65536; ++i) {
@@ -547,21 +670,24 @@ static int init(VmafFeatureExtractor *fex, enum VmafPixelFormat pix_fmt,
     s->filter1d_16 = filter1d_16;
     s->filter1d_rd_8 = filter1d_rd_8;
     s->filter1d_rd_16 = filter1d_rd_16;
+    s->statistic = vif_statistic;
 
 #if ARCH_X86
     unsigned flags = vmaf_get_cpu_flags();
     if (flags & VMAF_X86_CPU_FLAG_AVX2) {
         s->filter1d_8 = vif_filter1d_8_avx2;
-        if (bpc < 12) s->filter1d_16 = vif_filter1d_16_avx2; //FIXME
+        s->filter1d_16 = vif_filter1d_16_avx2;
         s->filter1d_rd_8 = vif_filter1d_rd_8_avx2;
         s->filter1d_rd_16 = vif_filter1d_rd_16_avx2;
+        s->statistic = vif_statistic_avx2;
     }
 #if HAVE_AVX512
     if (flags & VMAF_X86_CPU_FLAG_AVX512) {
         s->filter1d_8 = vif_filter1d_8_avx512;
-        if (bpc < 12) s->filter1d_16 = vif_filter1d_16_avx512; //FIXME
+        s->filter1d_16 = vif_filter1d_16_avx512;
         s->filter1d_rd_8 = vif_filter1d_rd_8_avx512;
         s->filter1d_rd_16 = vif_filter1d_rd_16_avx512;
+        s->statistic = vif_statistic_avx512;
     }
 #endif
 #endif
@@ -571,22 +697,26 @@ static int init(VmafFeatureExtractor *fex, enum VmafPixelFormat pix_fmt,
     (void) pix_fmt;
     const bool hbd = bpc > 8;
 
+    s->n_bands = MAX(vmaf_thread_pool_n_threads(fex->thread_pool), 1);
+    // SIMD kernels store whole vectors past the end of a row, these stores
+    // must not reach into the next row of a band or the next buffer
+    const unsigned row_slack = MAX_ALIGN;
+
     s->buf.stride = ALIGN_CEIL(w << hbd);
-    s->buf.stride_16 = ALIGN_CEIL(w * sizeof(uint16_t));
-    s->buf.stride_32 = ALIGN_CEIL(w * sizeof(uint32_t));
+    s->buf.stride_16 = ALIGN_CEIL((w + row_slack) * sizeof(uint16_t));
+    s->buf.stride_32 = ALIGN_CEIL((w + row_slack) * sizeof(uint32_t));
     s->buf.stride_tmp =
         ALIGN_CEIL((MAX_ALIGN + w + MAX_ALIGN) * sizeof(uint32_t));
     const size_t frame_size = s->buf.stride * h;
-    const size_t pad_size = s->buf.stride * 8;
     const size_t data_sz =
-        2 * (pad_size + frame_size + pad_size) + 2 * (h * s->buf.stride_16) +
+        2 * frame_size + 2 * (h * s->buf.stride_16) +
         5 * (h * s->buf.stride_32) + 7 * s->buf.stride_tmp;
     void *data = aligned_malloc(data_sz, MAX_ALIGN);
     if (!data) goto fail;
 
-    s->buf.data = data; data += pad_size;
-    s->buf.ref = data; data += frame_size + pad_size + pad_size;
-    s->buf.dis = data; data += frame_size + pad_size;
+    s->buf.data = data;
+    s->buf.ref = data; data += frame_size;
+    s->buf.dis = data; data += frame_size;
     s->buf.mu1 = data; data += h * s->buf.stride_16;
     s->buf.mu2 = data; data += h * s->buf.stride_16;
     s->buf.mu1_32 = data; data += h * s->buf.stride_32;
@@ -602,13 +732,28 @@ static int init(VmafFeatureExtractor *fex, enum VmafPixelFormat pix_fmt,
     s->buf.tmp.ref_convol = data; data += s->buf.stride_tmp;
     s->buf.tmp.dis_convol = data;
 
+    if (init_bands(s)) goto fail;
+
     return 0;
 
 fail:
-    aligned_free(data);
+    aligned_free(s->buf.data);
+    s->buf.data = NULL;
     return -ENOMEM;
 }
 
+static const char *feature_name[] = {
+    "VMAF_integer_feature_vif_scale0_score",
+    "VMAF_integer_feature_vif_scale1_score",
+    "VMAF_integer_feature_vif_scale2_score",
+    "VMAF_integer_feature_vif_scale3_score",
+    "integer_vif", "integer_vif_num", "integer_vif_den",
+    "integer_vif_num_scale0", "integer_vif_den_scale0",
+    "integer_vif_num_scale1", "integer_vif_den_scale1",
+    "integer_vif_num_scale2", "integer_vif_den_scale2",
+    "integer_vif_num_scale3", "integer_vif_den_scale3",
+};
+
 static int extract(VmafFeatureExtractor *fex,
                    VmafPicture *ref_pic, VmafPicture *ref_pic_90,
                    VmafPicture *dist_pic, VmafPicture *dist_pic_90,
@@ -622,44 +767,79 @@ static int extract(VmafFeatureExtractor *fex,
     unsigned w = ref_pic->w[0];
     unsigned h = dist_pic->h[0];
 
-    void *ref_in = ref_pic->data[0];
-    void *dis_in = dist_pic->data[0];
-    void *ref_out = s->buf.ref;
-    void *dis_out = s->buf.dis;
-
-    for (unsigned i = 0; i < h; i++) {
-        memcpy(ref_out, ref_in, ref_pic->stride[0]);
-        memcpy(dis_out, dis_in, dist_pic->stride[0]);
-        ref_in += ref_pic->stride[0];
-        dis_in += dist_pic->stride[0];
-        ref_out += s->buf.stride;
-        dis_out += s->buf.stride;
+    VifBandJob job = {
+        .s = s,
+        .ref = ref_pic->data[0],
+        .dis = dist_pic->data[0],
+        .stride = ref_pic->stride[0],
+        .bpc = ref_pic->bpc,
+    };
+
+    // scale 0 and its decimation read the pictures in place, the kernels
+    // share one stride between ref and dis so fall back to a copy otherwise
+    if (ref_pic->stride[0] != dist_pic->stride[0]) {
+        void *ref_in = ref_pic->data[0];
+        void *dis_in = dist_pic->data[0];
+        void *ref_out = s->buf.ref;
+        void *dis_out = s->buf.dis;
+
+        for (unsigned i = 0; i < h; i++) {
+            memcpy(ref_out, ref_in, s->buf.stride);
+            memcpy(dis_out, dis_in, s->buf.stride);
+            ref_in += ref_pic->stride[0];
+            dis_in += dist_pic->stride[0];
+            ref_out += s->buf.stride;
+            dis_out += s->buf.stride;
+        }
+        job.ref = s->buf.ref;
+        job.dis = s->buf.dis;
+        job.stride = s->buf.stride;
     }
-    pad_top_and_bottom(s->buf, h, vif_filter1d_width[0]);
 
     double scores[8];
     double score_num = 0.0;
     double score_den = 0.0;
 
+    int err = 0;
+
     for (unsigned scale = 0; scale < 4; ++scale) {
-        if (scale > 0) {
-            if (ref_pic->bpc == 8 && scale == 1)
-                s->filter1d_rd_8(s->buf, w, h);
-            else
-                s->filter1d_rd_16(s->buf, w, h, scale - 1, ref_pic->bpc);
+        job.scale = scale;
 
-            decimate_and_pad(s->buf, w, h, scale);
+        if (scale > 0) {
+            job.w = w;
+            job.h = h;
+            job.n_bands = vif_n_bands(s, h);
+            err = vmaf_thread_pool_parallel_for(fex->thread_pool, job.n_bands,
+                                                vif_filter1d_rd_band, &job);
+            if (err) return err;
+
+            decimate(s->buf, w, h);
             w /= 2; h /= 2;
+            job.ref = s->buf.ref;
+            job.dis = s->buf.dis;
+            job.stride = s->buf.stride;
         }
 
-        if (ref_pic->bpc == 8 && scale == 0)
-            s->filter1d_8(s->buf, w, h);
-        else
-            s->filter1d_16(s->buf, w, h, scale, ref_pic->bpc);
+        job.w = w;
+        job.h = h;
+        job.n_bands = vif_n_bands(s, h);
+        err = vmaf_thread_pool_parallel_for(fex->thread_pool, job.n_bands,
+                                            vif_filter1d_band, &job);
+        if (err) return err;
+
+        VifAccum accum = { 0 };
+        for (unsigned i = 0; i < job.n_bands; i++) {
+            accum.x += s->band[i].accum.x;
+            accum.x2 += s->band[i].accum.x2;
+            accum.num_x += s->band[i].accum.num_x;
+            accum.num_log += s->band[i].accum.num_log;
+            accum.den_log += s->band[i].accum.den_log;
+            accum.num_non_log += s->band[i].accum.num_non_log;
+            accum.den_non_log += s->band[i].accum.den_non_log;
+        }
 
         float num, den;
-        vif_statistic(s->buf, &num, &den, w, h, s->log2_table,
-                      s->vif_enhn_gain_limit);
+        vif_statistic_score(&accum, &num, &den);
         scores[2 * scale] = num;
         scores[2 * scale + 1] = den;
         score_num += scores[2 * scale];
@@ -674,43 +854,25 @@ static int extract(VmafFeatureExtractor *fex,
         score = score_num / score_den;
     }
 
-    int err = 0;
-    err |= vmaf_feature_collector_append(feature_collector,
-                                         "VMAF_integer_feature_vif_scale0_score",
-                                         scores[0] / scores[1], index);
-    err |= vmaf_feature_collector_append(feature_collector,
-                                         "VMAF_integer_feature_vif_scale1_score",
-                                         scores[2] / scores[3], index);
-    err |= vmaf_feature_collector_append(feature_collector,
-                                         "VMAF_integer_feature_vif_scale2_score",
-                                         scores[4] / scores[5], index);
-    err |= vmaf_feature_collector_append(feature_collector,
-                                         "VMAF_integer_feature_vif_scale3_score",
-                                         scores[6] / scores[7], index);
-
-    if (s->debug) {
-        err |= vmaf_feature_collector_append(feature_collector,
-                                             "integer_vif", score, index);
-        err |= vmaf_feature_collector_append(feature_collector,
-                                             "integer_vif_num", score_num, index);
-        err |= vmaf_feature_collector_append(feature_collector,
-                                             "integer_vif_den", score_den, index);
-        err |= vmaf_feature_collector_append(feature_collector,
-                                             "integer_vif_num_scale0", scores[0], index);
-        err |= vmaf_feature_collector_append(feature_collector,
-                                             "integer_vif_den_scale0", scores[1], index);
-        err |= vmaf_feature_collector_append(feature_collector,
-                                             "integer_vif_num_scale1", scores[2], index);
-        err |= vmaf_feature_collector_append(feature_collector,
-                                             "integer_vif_den_scale1", scores[3], index);
-        err |= vmaf_feature_collector_append(feature_collector,
-                                             "integer_vif_num_scale2", scores[4], index);
-        err |= vmaf_feature_collector_append(feature_collector,
-                                             "integer_vif_den_scale2", scores[5], index);
-        err |= vmaf_feature_collector_append(feature_collector,
-                                             "integer_vif_num_scale3", scores[6], index);
-        err |= vmaf_feature_collector_append(feature_collector,
-                                             "integer_vif_den_scale3", scores[7], index);
+    const double feature[] = {
+        scores[0] / scores[1], scores[2] / scores[3],
+        scores[4] / scores[5], scores[6] / scores[7],
+        score, score_num, score_den,
+        scores[0], scores[1], scores[2], scores[3],
+        scores[4], scores[5], scores[6], scores[7],
+    };
+
+    err = vmaf_feature_collector_register_list(feature_collector,
+                                               &s->feature_collector,
+                                               feature_name, s->feature_id,
+                                               s->debug ? 15 : 4);
+    if (err) return err;
+
+    const unsigned cnt = s->debug ? 15 : 4;
+    for (unsigned i = 0; i < cnt; i++) {
+        err |= vmaf_feature_collector_append_id(feature_collector,
+                                                s->feature_id[i], feature[i],
+                                                index);
     }
     return err;
 }
@@ -719,6 +881,8 @@ static int close(VmafFeatureExtractor *fex)
 {
     VifState *s = fex->priv;
     if (s->buf.data) aligned_free(s->buf.data);
+    if (s->band_data) aligned_free(s->band_data);
+    free(s->band);
     return 0;
 }
 
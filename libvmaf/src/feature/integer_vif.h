@@ -19,6 +19,7 @@
 #ifndef FEATURE_VIF_H_
 #define FEATURE_VIF_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 /* Enhancement gain imposed on vif, must be >= 1.0, where 1.0 means the gain is completely disabled */
@@ -62,8 +63,38 @@ typedef struct VifBuffer {
     ptrdiff_t stride_16;
     ptrdiff_t stride_32;
     ptrdiff_t stride_tmp;
+
+    int y0; ///< frame row that row 0 of `ref` and `dis` maps to
+    int frame_h; ///< rows of `ref` and `dis` in the whole frame
 } VifBuffer;
 
+/* `ref` and `dis` are not padded, rows read above and below the frame are
+ * mirrored back into it about its first and last row. */
+static inline int vif_mirror_row(VifBuffer buf, int i)
+{
+    const int y = buf.y0 + i;
+    if (y < 0) return -y - buf.y0;
+    if (y >= buf.frame_h) return 2 * (buf.frame_h - 1) - y - buf.y0;
+    return i;
+}
+
+/* Offsets of the `fwidth` rows which are filtered into row `i`. SIMD
+ * kernels process taps in pairs and load one more row for the zero
+ * coefficient which ends each filter, so `row` holds `fwidth + 1` offsets. */
+static inline void vif_filter_rows(VifBuffer buf, int i, unsigned fwidth,
+                                   ptrdiff_t stride, ptrdiff_t *row)
+{
+    const int ii = i - (int)(fwidth / 2);
+    for (unsigned fi = 0; fi <= fwidth; ++fi)
+        row[fi] = vif_mirror_row(buf, ii + fi) * stride;
+}
+
+typedef struct VifAccum {
+    int64_t x, x2, num_x;
+    int64_t num_log, den_log;
+    int64_t num_non_log, den_non_log;
+} VifAccum;
+
 static inline void PADDING_SQ_DATA(VifBuffer buf, int w, unsigned fwidth_half)
 {
     for (unsigned f = 1; f <= fwidth_half; ++f) {
@@ -85,7 +85,7 @@ static float _calc_scale(const struct _kernel *k)
     }
 }
 
-void _iqa_convolve(float *img, int w, int h, const struct _kernel *k, float *result, int *rw, int *rh)
+void _iqa_convolve(float *img, int w, int h, const struct _kernel *k, float *result, int *rw, int *rh, float *cache)
 {
 
 #ifdef IQA_CONVOLVE_1D
@@ -109,7 +109,9 @@ void _iqa_convolve(float *img, int w, int h, const struct _kernel *k, float *res
     scale = _calc_scale(k);
 
     /* create cache */
-    img_cache = (float *)calloc(w*h, sizeof(float));
+    img_cache = cache;
+    if (!img_cache)
+        img_cache = (float *)calloc(w*h, sizeof(float));
     if (!img_cache)
         assert(0);
 
@@ -148,7 +150,8 @@ void _iqa_convolve(float *img, int w, int h, const struct _kernel *k, float *res
     }
 
     /* free cache */
-    free(img_cache);
+    if (img_cache != cache)
+        free(img_cache);
 
 #else /* use 2D filter */
 
@@ -163,6 +166,8 @@ void _iqa_convolve(float *img, int w, int h, const struct _kernel *k, float *res
     float sum;
     float scale, *dst=result;
 
+    (void)cache;
+
     if (!dst)
         dst = img; /* Convolve in-place */
 
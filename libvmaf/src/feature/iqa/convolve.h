@@ -71,8 +71,10 @@ struct _kernel {
  *               will be written to the original image buffer.
  * @param rw Optional. The width of the resulting image will be stored here.
  * @param rh Optional. The height of the resulting image will be stored here.
+ * @param cache Optional. Scratch buffer of w*h floats for the separable
+ *              filter. If 0, one is allocated for the call.
  */
-void _iqa_convolve(float *img, int w, int h, const struct _kernel *k, float *result, int *rw, int *rh);
+void _iqa_convolve(float *img, int w, int h, const struct _kernel *k, float *result, int *rw, int *rh, float *cache);
 
 /**
  * The same as _iqa_convolve() except the kernel is applied to the entire image.
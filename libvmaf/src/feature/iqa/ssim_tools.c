@@ -99,6 +99,7 @@ IQA_INLINE static double _calc_structure(float sigma_12, double sigma_comb_12, f
 float _iqa_ssim(float *ref, float *cmp, int w, int h, const struct _kernel *k,
 		const struct _map_reduce *mr, const struct iqa_ssim_args *args
 		, float *l_mean, float *c_mean, float *s_mean /* zli-nflx */
+		, float *buf
 		)
 {
     float alpha=1.0f, beta=1.0f, gamma=1.0f;
@@ -107,6 +108,7 @@ float _iqa_ssim(float *ref, float *cmp, int w, int h, const struct _kernel *k,
     float C1,C2,C3;
     int x,y,offset;
     float *ref_mu,*cmp_mu,*ref_sigma_sqd,*cmp_sigma_sqd,*sigma_both;
+    float *buf_alloc=0,*conv_cache;
     double ssim_sum;
     // double numerator, denominator; /* zli-nflx */
     double luminance_comp, contrast_comp, structure_comp, sigma_root;
@@ -130,23 +132,21 @@ float _iqa_ssim(float *ref, float *cmp, int w, int h, const struct _kernel *k,
     C2 = (K2*L)*(K2*L);
     C3 = C2 / 2.0f;
 
-    ref_mu = (float*)malloc(w*h*sizeof(float));
-    cmp_mu = (float*)malloc(w*h*sizeof(float));
-    ref_sigma_sqd = (float*)malloc(w*h*sizeof(float));
-    cmp_sigma_sqd = (float*)malloc(w*h*sizeof(float));
-    sigma_both = (float*)malloc(w*h*sizeof(float));
-    if (!ref_mu || !cmp_mu || !ref_sigma_sqd || !cmp_sigma_sqd || !sigma_both) {
-        if (ref_mu) free(ref_mu);
-        if (cmp_mu) free(cmp_mu);
-        if (ref_sigma_sqd) free(ref_sigma_sqd);
-        if (cmp_sigma_sqd) free(cmp_sigma_sqd);
-        if (sigma_both) free(sigma_both);
-        return INFINITY;
+    if (!buf) {
+        buf = buf_alloc = (float*)malloc(SSIM_BUF_PLANES*w*h*sizeof(float));
+        if (!buf)
+            return INFINITY;
     }
+    ref_mu = buf;
+    cmp_mu = ref_mu + w*h;
+    ref_sigma_sqd = cmp_mu + w*h;
+    cmp_sigma_sqd = ref_sigma_sqd + w*h;
+    sigma_both = cmp_sigma_sqd + w*h;
+    conv_cache = sigma_both + w*h;
 
     /* Calculate mean */
-    _iqa_convolve(ref, w, h, k, ref_mu, 0, 0);
-    _iqa_convolve(cmp, w, h, k, cmp_mu, 0, 0);
+    _iqa_convolve(ref, w, h, k, ref_mu, 0, 0, conv_cache);
+    _iqa_convolve(cmp, w, h, k, cmp_mu, 0, 0, conv_cache);
 
     for (y=0; y<h; ++y) {
         offset = y*w;
@@ -158,9 +158,9 @@ float _iqa_ssim(float *ref, float *cmp, int w, int h, const struct _kernel *k,
     }
 
     /* Calculate sigma */
-    _iqa_convolve(ref_sigma_sqd, w, h, k, 0,  0,  0);
-    _iqa_convolve(cmp_sigma_sqd, w, h, k, 0,  0,  0);
-    _iqa_convolve(sigma_both,    w, h, k, 0, &w, &h); /* Update the width and height */
+    _iqa_convolve(ref_sigma_sqd, w, h, k, 0,  0,  0, conv_cache);
+    _iqa_convolve(cmp_sigma_sqd, w, h, k, 0,  0,  0, conv_cache);
+    _iqa_convolve(sigma_both,    w, h, k, 0, &w, &h, conv_cache); /* Update the width and height */
 
     /* The convolution results are smaller by the kernel width and height */
     for (y=0; y<h; ++y) {
@@ -220,17 +220,15 @@ float _iqa_ssim(float *ref, float *cmp, int w, int h, const struct _kernel *k,
                 sint.c = contrast_comp;
                 sint.s = structure_comp;
 
-                if (mr->map(&sint, mr->context))
+                if (mr->map(&sint, mr->context)) {
+                    free(buf_alloc);
                     return INFINITY;
+                }
             }
         }
     }
 
-    free(ref_mu);
-    free(cmp_mu);
-    free(ref_sigma_sqd);
-    free(cmp_sigma_sqd);
-    free(sigma_both);
+    free(buf_alloc);
 
     if (!args) {
     	*l_mean = (float)(l_sum / (double)(w*h)); /* zli-nflx */
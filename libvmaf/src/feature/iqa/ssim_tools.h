@@ -113,9 +113,14 @@ struct _map_reduce {
     void *context;
 };
 
+/* 'buf' is optional scratch of SSIM_BUF_PLANES*w*h floats; if 0, it is
+ * allocated for the call. */
+#define SSIM_BUF_PLANES 6
+
 float _iqa_ssim(float *ref, float *cmp, int w, int h, const struct _kernel *k,
 		const struct _map_reduce *mr, const struct iqa_ssim_args *args
 		, float *l_mean, float *c_mean, float *s_mean /* zli-nflx */
+		, float *buf
 		);
 
 #endif /* _SSIM_TOOLS_H_ */
@@ -16,6 +16,7 @@
  *
  */
 
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -29,6 +30,7 @@
 #include "iqa/math_utils.h"
 #include "iqa/decimate.h"
 #include "iqa/ssim_tools.h"
+#include "ms_ssim.h"
 
 /* Low-pass filter for down-sampling (9/7 biorthogonal wavelet filter) */
 #define LPF_LEN 9
@@ -113,10 +115,63 @@ int _alloc_buffers(float **buf, int w, int h, int scales)
     return 0;
 }
 
+int ms_ssim_workspace_init(MsSsimWorkspace *ws, int w, int h)
+{
+    if (!ws) return -EINVAL;
+    if (w <= 0 || h <= 0) return -EINVAL;
+
+    memset(ws, 0, sizeof(*ws));
+    ws->w = w;
+    ws->h = h;
+    if (_alloc_buffers(ws->ref_imgs, w, h, SCALES))
+        goto fail;
+    if (_alloc_buffers(ws->cmp_imgs, w, h, SCALES)) {
+        _free_buffers(ws->ref_imgs, SCALES);
+        goto fail;
+    }
+    ws->ssim_buf = (float*)malloc((size_t)SSIM_BUF_PLANES*w*h*sizeof(float));
+    if (!ws->ssim_buf) {
+        _free_buffers(ws->ref_imgs, SCALES);
+        _free_buffers(ws->cmp_imgs, SCALES);
+        goto fail;
+    }
+    return 0;
+
+fail:
+    memset(ws, 0, sizeof(*ws));
+    return -ENOMEM;
+}
+
+void ms_ssim_workspace_free(MsSsimWorkspace *ws)
+{
+    if (!ws || !ws->ssim_buf) return;
+    _free_buffers(ws->ref_imgs, SCALES);
+    _free_buffers(ws->cmp_imgs, SCALES);
+    free(ws->ssim_buf);
+    memset(ws, 0, sizeof(*ws));
+}
+
 int compute_ms_ssim(const float *ref, const float *cmp, int w, int h,
         int ref_stride, int cmp_stride, double *score,
         double* l_scores, double* c_scores, double* s_scores)
 {
+    MsSsimWorkspace ws;
+    if (ms_ssim_workspace_init(&ws, w, h)) {
+        printf("error: unable to _alloc_buffers on ref_imgs or cmp_imgs.\n");
+        fflush(stdout);
+        return 1;
+    }
+
+    int ret = compute_ms_ssim_ws(&ws, ref, cmp, w, h, ref_stride, cmp_stride,
+                                 score, l_scores, c_scores, s_scores);
+    ms_ssim_workspace_free(&ws);
+    return ret;
+}
+
+int compute_ms_ssim_ws(MsSsimWorkspace *ws, const float *ref,
+        const float *cmp, int w, int h, int ref_stride, int cmp_stride,
+        double *score, double* l_scores, double* c_scores, double* s_scores)
+{
 
     int ret = 1;
 
@@ -126,7 +181,8 @@ int compute_ms_ssim(const float *ref, const float *cmp, int w, int h,
     const float *alphas=g_alphas, *betas=g_betas, *gammas=g_gammas;
     int idx,x,y,cur_w,cur_h;
     int offset,src_offset;
-    float **ref_imgs, **cmp_imgs; /* Array of pointers to scaled images */
+    float **ref_imgs = ws->ref_imgs; /* Array of pointers to scaled images */
+    float **cmp_imgs = ws->cmp_imgs;
     double msssim;
     float l, c, s;
     struct _kernel lpf, window;
@@ -134,6 +190,13 @@ int compute_ms_ssim(const float *ref, const float *cmp, int w, int h,
     struct _map_reduce mr;
     struct _context ms_ctx;
 
+    if (w > ws->w || h > ws->h)
+    {
+        printf("error: frame exceeds the ms_ssim workspace.\n");
+        fflush(stdout);
+        goto fail_or_end;
+    }
+
     /* check stride */
     int stride = ref_stride; /* stride in bytes */
     if (stride != cmp_stride)
@@ -189,32 +252,6 @@ int compute_ms_ssim(const float *ref, const float *cmp, int w, int h,
     mr.map     = _ms_ssim_map;
     mr.reduce  = _ms_ssim_reduce;
 
-    /* allocate the scaled image buffers */
-    ref_imgs = (float**)malloc(scales*sizeof(float*));
-    cmp_imgs = (float**)malloc(scales*sizeof(float*));
-    if (!ref_imgs || !cmp_imgs) {
-        if (ref_imgs) free(ref_imgs);
-        if (cmp_imgs) free(cmp_imgs);
-        printf("error: unable to malloc ref_imgs or cmp_imgs.\n");
-        fflush(stdout);
-        goto fail_or_end;
-    }
-    if (_alloc_buffers(ref_imgs, w, h, scales)) {
-        free(ref_imgs);
-        free(cmp_imgs);
-        printf("error: unable to _alloc_buffers on ref_imgs.\n");
-        fflush(stdout);
-        goto fail_or_end;
-    }
-    if (_alloc_buffers(cmp_imgs, w, h, scales)) {
-        _free_buffers(ref_imgs, scales);
-        free(ref_imgs);
-        free(cmp_imgs);
-        printf("error: unable to _alloc_buffers on cmp_imgs.\n");
-        fflush(stdout);
-        goto fail_or_end;
-    }
-
     /* copy original images into first scale buffer, forcing stride = width. */
     for (y=0; y<h; ++y) {
         src_offset = y * stride;
@@ -238,10 +275,6 @@ int compute_ms_ssim(const float *ref, const float *cmp, int w, int h,
         if (_iqa_decimate(ref_imgs[idx-1], cur_w, cur_h, 2, &lpf, ref_imgs[idx], 0, 0) ||
             _iqa_decimate(cmp_imgs[idx-1], cur_w, cur_h, 2, &lpf, cmp_imgs[idx], &cur_w, &cur_h))
         {
-            _free_buffers(ref_imgs, scales);
-            _free_buffers(cmp_imgs, scales);
-            free(ref_imgs);
-            free(cmp_imgs);
             printf("error: decimation fails on ref_imgs or cmp_imgs.\n");
             fflush(stdout);
             goto fail_or_end;
@@ -270,7 +303,7 @@ int compute_ms_ssim(const float *ref, const float *cmp, int w, int h,
             s_args.L  = 255;
             s_args.f  = 1; /* Don't resize */
             mr.context = &ms_ctx;
-            _iqa_ssim(ref_imgs[idx], cmp_imgs[idx], cur_w, cur_h, &window, &mr, &s_args, &l, &c, &s);
+            _iqa_ssim(ref_imgs[idx], cmp_imgs[idx], cur_w, cur_h, &window, &mr, &s_args, &l, &c, &s, ws->ssim_buf);
         }
         else {
             /* MS-SSIM (Wang) */
@@ -283,11 +316,11 @@ int compute_ms_ssim(const float *ref, const float *cmp, int w, int h,
             s_args.L  = 255;
             s_args.f  = 1; // Don't resize
             mr.context = &ms_ctx;
-            msssim *= _iqa_ssim(ref_imgs[idx], cmp_imgs[idx], cur_w, cur_h, &window, &mr, &s_args, &l, &c, &s);
+            msssim *= _iqa_ssim(ref_imgs[idx], cmp_imgs[idx], cur_w, cur_h, &window, &mr, &s_args, &l, &c, &s, ws->ssim_buf);
             */
 
             /* above is equivalent to passing default parameter: */
-            _iqa_ssim(ref_imgs[idx], cmp_imgs[idx], cur_w, cur_h, &window, NULL, NULL, &l, &c, &s);
+            _iqa_ssim(ref_imgs[idx], cmp_imgs[idx], cur_w, cur_h, &window, NULL, NULL, &l, &c, &s, ws->ssim_buf);
 
         }
 
@@ -297,10 +330,6 @@ int compute_ms_ssim(const float *ref, const float *cmp, int w, int h,
         s_scores[idx] = s;
 
         if (msssim == INFINITY) {
-            _free_buffers(ref_imgs, scales);
-            _free_buffers(cmp_imgs, scales);
-            free(ref_imgs);
-            free(cmp_imgs);
             printf("error: ms_ssim is INFINITY.\n");
             fflush(stdout);
             goto fail_or_end;
@@ -309,11 +338,6 @@ int compute_ms_ssim(const float *ref, const float *cmp, int w, int h,
         cur_h = cur_h/2 + (cur_h&1);
     }
 
-    _free_buffers(ref_imgs, scales);
-    _free_buffers(cmp_imgs, scales);
-    free(ref_imgs);
-    free(cmp_imgs);
-
     *score = msssim;
 
     ret = 0;
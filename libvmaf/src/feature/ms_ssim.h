@@ -16,6 +16,31 @@
  *
  */
 
+#ifndef FEATURE_MS_SSIM_H_
+#define FEATURE_MS_SSIM_H_
+
+#include "iqa/ssim_tools.h"
+
+/* Image pyramids and SSIM scratch for compute_ms_ssim_ws(), sized once for
+ * frames up to w x h. */
+typedef struct MsSsimWorkspace {
+    int w, h;
+    float *ref_imgs[SCALES];
+    float *cmp_imgs[SCALES];
+    float *ssim_buf;
+} MsSsimWorkspace;
+
+int ms_ssim_workspace_init(MsSsimWorkspace *ws, int w, int h);
+
+void ms_ssim_workspace_free(MsSsimWorkspace *ws);
+
+int compute_ms_ssim_ws(MsSsimWorkspace *ws, const float *ref,
+                       const float *cmp, int w, int h, int ref_stride,
+                       int cmp_stride, double *score, double* l_scores,
+                       double* c_scores, double* s_scores);
+
 int compute_ms_ssim(const float *ref, const float *cmp, int w, int h,
                     int ref_stride, int cmp_stride, double *score,
                     double* l_scores, double* c_scores, double* s_scores);
+
+#endif /* FEATURE_MS_SSIM_H_ */
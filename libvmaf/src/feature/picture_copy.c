@@ -16,13 +16,46 @@
  *
  */
 
+#include <stdbool.h>
 #include <stdint.h>
 
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
 #include <libvmaf/picture.h>
 
+#include "cpu.h"
+#include "mem.h"
+#include "picture.h"
+
+#if ARCH_X86
+#include "x86/picture_copy_avx2.h"
+#if HAVE_AVX512
+#include "x86/picture_copy_avx512.h"
+#endif
+#endif
+
 void picture_copy_hbd(float *dst, ptrdiff_t dst_stride,
                       VmafPicture *src, int offset, float scaler)
 {
+#if ARCH_X86
+    /* scaler is a power of two, its reciprocal is exact. */
+    const unsigned flags = vmaf_get_cpu_flags();
+#if HAVE_AVX512
+    if (flags & VMAF_X86_CPU_FLAG_AVX512) {
+        picture_copy_16_avx512(dst, dst_stride, src->data[0], src->stride[0],
+                               src->w[0], src->h[0], 1.0f / scaler, offset);
+        return;
+    }
+#endif
+    if (flags & VMAF_X86_CPU_FLAG_AVX2) {
+        picture_copy_16_avx2(dst, dst_stride, src->data[0], src->stride[0],
+                             src->w[0], src->h[0], 1.0f / scaler, offset);
+        return;
+    }
+#endif
+
     float *float_data = dst;
     uint16_t *data = src->data[0];
 
@@ -46,6 +79,22 @@ void picture_copy(float *dst, ptrdiff_t dst_stride,
     else if (bpc == 16)
         return picture_copy_hbd(dst, dst_stride, src, offset, 256.0f);
 
+#if ARCH_X86
+    const unsigned flags = vmaf_get_cpu_flags();
+#if HAVE_AVX512
+    if (flags & VMAF_X86_CPU_FLAG_AVX512) {
+        picture_copy_8_avx512(dst, dst_stride, src->data[0], src->stride[0],
+                              src->w[0], src->h[0], offset);
+        return;
+    }
+#endif
+    if (flags & VMAF_X86_CPU_FLAG_AVX2) {
+        picture_copy_8_avx2(dst, dst_stride, src->data[0], src->stride[0],
+                            src->w[0], src->h[0], offset);
+        return;
+    }
+#endif
+
     float *float_data = dst;
     uint8_t *data = src->data[0];
 
@@ -59,3 +108,105 @@ void picture_copy(float *dst, ptrdiff_t dst_stride,
 
     return;
 }
+
+static void picture_copy_from_float_c(VmafPicture *dst, const float *src,
+                                      ptrdiff_t src_stride, unsigned bpc)
+{
+    const float *a = src;
+
+    if (bpc > 8) {
+        uint16_t *b = dst->data[0];
+        for (unsigned i = 0; i < dst->h[0]; i++) {
+            for (unsigned j = 0; j < dst->w[0]; j++) {
+                b[j] = a[j] * (1 << (bpc - 8));
+            }
+            a += src_stride / sizeof(float);
+            b += dst->stride[0] / sizeof(uint16_t);
+        }
+        return;
+    }
+
+    uint8_t *b = dst->data[0];
+    for (unsigned i = 0; i < dst->h[0]; i++) {
+        for (unsigned j = 0; j < dst->w[0]; j++) {
+            b[j] = a[j];
+        }
+        a += src_stride / sizeof(float);
+        b += dst->stride[0];
+    }
+}
+
+/* `dst_b` is optional, and has the same geometry as `dst_a` if set. */
+static void picture_copy_from_float(VmafPicture *dst_a, VmafPicture *dst_b,
+                                    const float *src_a, const float *src_b,
+                                    ptrdiff_t src_stride, unsigned bpc)
+{
+#if ARCH_X86
+    const unsigned flags = vmaf_get_cpu_flags();
+    const float scale = 1 << (bpc - 8);
+    uint8_t *const b = dst_b ? dst_b->data[0] : NULL;
+#if HAVE_AVX512
+    if (flags & VMAF_X86_CPU_FLAG_AVX512) {
+        if (bpc > 8) {
+            picture_copy_from_float_16_avx512(dst_a->data[0], (uint16_t *) b,
+                                              dst_a->stride[0], src_a, src_b,
+                                              src_stride, dst_a->w[0],
+                                              dst_a->h[0], scale);
+        } else {
+            picture_copy_from_float_8_avx512(dst_a->data[0], b,
+                                             dst_a->stride[0], src_a, src_b,
+                                             src_stride, dst_a->w[0],
+                                             dst_a->h[0]);
+        }
+        return;
+    }
+#endif
+    if (flags & VMAF_X86_CPU_FLAG_AVX2) {
+        if (bpc > 8) {
+            picture_copy_from_float_16_avx2(dst_a->data[0], (uint16_t *) b,
+                                            dst_a->stride[0], src_a, src_b,
+                                            src_stride, dst_a->w[0],
+                                            dst_a->h[0], scale);
+        } else {
+            picture_copy_from_float_8_avx2(dst_a->data[0], b,
+                                           dst_a->stride[0], src_a, src_b,
+                                           src_stride, dst_a->w[0],
+                                           dst_a->h[0]);
+        }
+        return;
+    }
+#endif
+
+    picture_copy_from_float_c(dst_a, src_a, src_stride, bpc);
+    if (dst_b) picture_copy_from_float_c(dst_b, src_b, src_stride, bpc);
+}
+
+void picture_copy_from_float_pair(VmafPicture *ref, VmafPicture *dist,
+                                  const float *ref_src, const float *dist_src,
+                                  ptrdiff_t src_stride, unsigned bpc)
+{
+    const bool same_layout = ref->w[0] == dist->w[0] &&
+                             ref->h[0] == dist->h[0] &&
+                             ref->stride[0] == dist->stride[0];
+    if (same_layout) {
+        picture_copy_from_float(ref, dist, ref_src, dist_src, src_stride, bpc);
+        return;
+    }
+
+    picture_copy_from_float(ref, NULL, ref_src, NULL, src_stride, bpc);
+    picture_copy_from_float(dist, NULL, dist_src, NULL, src_stride, bpc);
+}
+
+static int picture_copy_fill(void *data, VmafPicture *pic, int offset)
+{
+    picture_copy(data, ALIGN_CEIL(pic->w[0] * sizeof(float)), pic, offset,
+                 pic->bpc);
+    return 0;
+}
+
+const float *picture_copy_shared(VmafPicture *src, int offset)
+{
+    const size_t float_stride = ALIGN_CEIL(src->w[0] * sizeof(float));
+    return vmaf_picture_cache_fetch(src, offset, float_stride * src->h[0],
+                                    picture_copy_fill);
+}
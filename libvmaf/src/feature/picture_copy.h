@@ -17,5 +17,26 @@
  */
 #include <stddef.h>
 
+#include <libvmaf/picture.h>
+
 void picture_copy(float *dst, ptrdiff_t dst_stride, VmafPicture *src,
                   int offset, unsigned bpc);
+
+/**
+ * Reverse of `picture_copy()` without an offset, for a ref/dist pair in one
+ * pass. Float planes in the 8-bit range are scaled up to `bpc` and truncated
+ * into the luma planes of `ref` and `dist`.
+ */
+void picture_copy_from_float_pair(VmafPicture *ref, VmafPicture *dist,
+                                  const float *ref_src, const float *dist_src,
+                                  ptrdiff_t src_stride, unsigned bpc);
+
+/**
+ * Like `picture_copy()`, into a buffer shared by every feature extractor
+ * requesting the same `offset` for `src`. The conversion is done once per
+ * picture, the buffer has a stride of `ALIGN_CEIL(src->w[0] * sizeof(float))`
+ * bytes and lives as long as `src` is referenced.
+ *
+ * @return the converted luma plane, or NULL on error.
+ */
+const float *picture_copy_shared(VmafPicture *src, int offset);
@@ -341,16 +341,27 @@ static double convert_score_db(double _score, double _weight)
     return 10 * (-1 * log10(_weight * _score));
 }
 
+typedef struct PsnrHvsState {
+    VmafFeatureCollector *feature_collector;
+    unsigned feature_id[4];
+} PsnrHvsState;
+
 static int extract(VmafFeatureExtractor *fex, VmafPicture *ref_pic,
                    VmafPicture *ref_pic_90, VmafPicture *dist_pic,
                    VmafPicture *dist_pic_90, unsigned index,
                    VmafFeatureCollector *feature_collector)
 {
-    int err = 0;
+    PsnrHvsState *s = fex->priv;
 
     (void)ref_pic_90;
     (void)dist_pic_90;
 
+    int err = vmaf_feature_collector_register_list(feature_collector,
+                                                   &s->feature_collector,
+                                                   fex->provided_features,
+                                                   s->feature_id, 4);
+    if (err) return err;
+
     double score[3];
     for (unsigned i = 0; i < 3; i++) {
         score[i] =
@@ -359,16 +370,17 @@ static int extract(VmafFeatureExtractor *fex, VmafPicture *ref_pic,
                          ref_pic->bpc, ref_pic->w[i], ref_pic->h[i], 7,
                          i == 0 ? csf_y : i == 1 ? csf_cb420 : csf_cr420);
 
-        err |= vmaf_feature_collector_append(feature_collector,
-                                             fex->provided_features[i],
-                                             convert_score_db(score[i], 1.0),
-                                             index);
+        err |= vmaf_feature_collector_append_id(feature_collector,
+                                                s->feature_id[i],
+                                                convert_score_db(score[i], 1.0),
+                                                index);
     }
 
     const double psnr_hvs = (score[0]) * .8 + .1 * (score[1] + score[2]);
-    err |= vmaf_feature_collector_append(feature_collector, "psnr_hvs",
-                                         convert_score_db(psnr_hvs, 1.0),
-                                         index);
+    err |= vmaf_feature_collector_append_id(feature_collector,
+                                            s->feature_id[3],
+                                            convert_score_db(psnr_hvs, 1.0),
+                                            index);
     return err;
 }
 
@@ -380,5 +392,6 @@ static const char *provided_features[] = {
 VmafFeatureExtractor vmaf_fex_psnr_hvs = {
     .name = "psnr_hvs",
     .extract = extract,
+    .priv_size = sizeof(PsnrHvsState),
     .provided_features = provided_features,
 };
@@ -161,7 +161,7 @@ int compute_ssim(const float *ref, const float *cmp, int w, int h,
         free(low_pass.kernel_v); /* zli-nflx */
     }
 
-    result = _iqa_ssim(ref_f, cmp_f, w, h, &window, &mr, args, &l, &c, &s);
+    result = _iqa_ssim(ref_f, cmp_f, w, h, &window, &mr, args, &l, &c, &s, 0);
 
     free(ref_f);
     free(cmp_f);
@@ -16,6 +16,7 @@
  *
  */
 
+#include <errno.h>
 #include <limits.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -26,6 +27,7 @@
 #include "mem.h"
 #include "common/convolution.h"
 #include "offset.h"
+#include "vif.h"
 #include "vif_options.h"
 #include "vif_tools.h"
 
@@ -54,10 +56,55 @@ void apply_frame_differencing(const float *current_frame, const float *previous_
     }
 }
 
+// Code optimized to save on multiple buffer copies
+// hence the reduction in the number of buffers required from 15 to 10
+#define VIF_BUF_CNT 10
+
+int vif_workspace_init(VifWorkspace *ws, int w, int h)
+{
+    if (!ws) return -EINVAL;
+    if (w <= 0 || h <= 0) return -EINVAL;
+    if ((size_t)w > ALIGN_FLOOR(INT_MAX) / sizeof(float)) return -EINVAL;
+
+    ws->w = w;
+    ws->h = h;
+    ws->buf_stride = ALIGN_CEIL(w * sizeof(float));
+    ws->buf_sz_one = (size_t)ws->buf_stride * h;
+    if (SIZE_MAX / ws->buf_sz_one < VIF_BUF_CNT) return -EINVAL;
+
+    ws->data_buf = aligned_malloc(ws->buf_sz_one * VIF_BUF_CNT, MAX_ALIGN);
+    if (!ws->data_buf) return -ENOMEM;
+    return 0;
+}
+
+void vif_workspace_free(VifWorkspace *ws)
+{
+    if (!ws) return;
+    aligned_free(ws->data_buf);
+    ws->data_buf = NULL;
+}
+
 int compute_vif(const float *ref, const float *dis, int w, int h, int ref_stride, int dis_stride,
         double *score, double *score_num, double *score_den, double *scores, double vif_enhn_gain_limit)
 {
-    float *data_buf = 0;
+    VifWorkspace ws;
+    if (vif_workspace_init(&ws, w, h))
+    {
+        printf("error: aligned_malloc failed for data_buf.\n");
+        fflush(stdout);
+        return 1;
+    }
+
+    int ret = compute_vif_ws(&ws, ref, dis, w, h, ref_stride, dis_stride,
+                             score, score_num, score_den, scores,
+                             vif_enhn_gain_limit);
+    vif_workspace_free(&ws);
+    return ret;
+}
+
+int compute_vif_ws(VifWorkspace *ws, const float *ref, const float *dis, int w, int h, int ref_stride, int dis_stride,
+        double *score, double *score_num, double *score_den, double *scores, double vif_enhn_gain_limit)
+{
     char *data_top;
 
     float *ref_scale;
@@ -99,33 +146,22 @@ int compute_vif(const float *ref, const float *dis, int w, int h, int ref_stride
     int curr_ref_stride = ref_stride;
     int curr_dis_stride = dis_stride;
 
-    int buf_stride = ALIGN_CEIL(w * sizeof(float));
-    size_t buf_sz_one = (size_t)buf_stride * h;
+    int buf_stride = ws->buf_stride;
+    size_t buf_sz_one = ws->buf_sz_one;
 
     float num = 0;
     float den = 0;
 
     int scale;
-    int ret = 1;
-
-	// Code optimized to save on multiple buffer copies
-	// hence the reduction in the number of buffers required from 15 to 10 
-#define VIF_BUF_CNT 10	
-	if (SIZE_MAX / buf_sz_one < VIF_BUF_CNT)
-	{
-		printf("error: SIZE_MAX / buf_sz_one < VIF_BUF_CNT, buf_sz_one = %zu.\n", buf_sz_one);
-		fflush(stdout);
-		goto fail_or_end;
-	}
 
-	if (!(data_buf = aligned_malloc(buf_sz_one * VIF_BUF_CNT, MAX_ALIGN)))
+	if (w > ws->w || h > ws->h)
 	{
-		printf("error: aligned_malloc failed for data_buf.\n");
+		printf("error: frame exceeds the vif workspace.\n");
 		fflush(stdout);
-		goto fail_or_end;
+		return 1;
 	}
 
-	data_top = (char *)data_buf;
+	data_top = (char *)ws->data_buf;
 
 	ref_scale = (float *)data_top; data_top += buf_sz_one;
 	dis_scale = (float *)data_top; data_top += buf_sz_one;
@@ -135,7 +171,7 @@ int compute_vif(const float *ref, const float *dis, int w, int h, int ref_stride
 	dis_sq_filt = (float *)data_top; data_top += buf_sz_one;
 	ref_dis_filt = (float *)data_top; data_top += buf_sz_one;
 	num_array    = (float *)data_top; data_top += buf_sz_one;
-    den_array    = (float *)data_top; data_top += buf_sz_one;
+	den_array    = (float *)data_top; data_top += buf_sz_one;
 	tmpbuf = (float *)data_top; data_top += buf_sz_one;
 
     for (scale = 0; scale < 4; ++scale)
@@ -286,10 +322,7 @@ int compute_vif(const float *ref, const float *dis, int w, int h, int ref_stride
         *score = (*score_num) / (*score_den);
     }
 
-    ret = 0;
-fail_or_end:
-    aligned_free(data_buf);
-    return ret;
+    return 0;
 }
 
 int vifdiff(int (*read_frame)(float *ref_data, float *main_data, float *temp_data, int stride, void *user_data), void *user_data, int w, int h, const char *fmt)
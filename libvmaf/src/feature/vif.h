@@ -16,5 +16,29 @@
  *
  */
 
+#ifndef FEATURE_VIF_H_
+#define FEATURE_VIF_H_
+
+#include <stddef.h>
+
+/* Scratch planes for compute_vif_ws(), sized once for frames up to w x h. */
+typedef struct VifWorkspace {
+    int w, h;
+    int buf_stride;
+    size_t buf_sz_one;
+    void *data_buf;
+} VifWorkspace;
+
+int vif_workspace_init(VifWorkspace *ws, int w, int h);
+
+void vif_workspace_free(VifWorkspace *ws);
+
+int compute_vif_ws(VifWorkspace *ws, const float *ref, const float *dis,
+                   int w, int h, int ref_stride, int dis_stride,
+                   double *score, double *score_num, double *score_den,
+                   double *scores, double vif_enhn_gain_limit);
+
 int compute_vif(const float *ref, const float *dis, int w, int h, int ref_stride, int dis_stride,
         double *score, double *score_num, double *score_den, double *scores, double vif_enhn_gain_limit);
+
+#endif /* FEATURE_VIF_H_ */
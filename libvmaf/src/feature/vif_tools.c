@@ -29,6 +29,13 @@
 #include "vif_options.h"
 #include "vif_tools.h"
 
+#if ARCH_X86
+#include "x86/float_vif_avx2.h"
+#if HAVE_AVX512
+#include "x86/float_vif_avx512.h"
+#endif
+#endif
+
 #define MIN(x, y) (((x) < (y)) ? (x) : (y))
 #define MAX(x, y) (((x) > (y)) ? (x) : (y))
 
@@ -149,6 +156,20 @@ const int vif_filter2d_width[4] = { 17, 9, 5, 3 };
 
 void vif_dec2_s(const float *src, float *dst, int src_w, int src_h, int src_stride, int dst_stride)
 {
+#if ARCH_X86
+    const unsigned flags = vmaf_get_cpu_flags();
+#if HAVE_AVX512
+    if (flags & VMAF_X86_CPU_FLAG_AVX512) {
+        vif_dec2_s_avx512(src, dst, src_w, src_h, src_stride, dst_stride);
+        return;
+    }
+#endif
+    if (flags & VMAF_X86_CPU_FLAG_AVX2) {
+        vif_dec2_s_avx2(src, dst, src_w, src_h, src_stride, dst_stride);
+        return;
+    }
+#endif
+
     int src_px_stride = src_stride / sizeof(float); // src_stride is in bytes
     int dst_px_stride = dst_stride / sizeof(float);
 
@@ -219,6 +240,24 @@ void vif_statistic_s(const float *mu1, const float *mu2, const float *mu1_mu2, c
 	int w, int h, int mu1_stride, int mu2_stride, int mu1_mu2_stride, int xx_filt_stride, int yy_filt_stride, int xy_filt_stride, int num_stride, int den_stride,
 	double vif_enhn_gain_limit)
 {
+#if ARCH_X86 && defined(VIF_OPT_FAST_LOG2)
+	const unsigned flags = vmaf_get_cpu_flags();
+#if HAVE_AVX512
+	if (flags & VMAF_X86_CPU_FLAG_AVX512) {
+		vif_statistic_s_avx512(mu1, mu2, xx_filt, yy_filt, xy_filt, num, den, w, h,
+				mu1_stride, mu2_stride, xx_filt_stride, yy_filt_stride, xy_filt_stride,
+				vif_enhn_gain_limit);
+		return;
+	}
+#endif
+	if (flags & VMAF_X86_CPU_FLAG_AVX2) {
+		vif_statistic_s_avx2(mu1, mu2, xx_filt, yy_filt, xy_filt, num, den, w, h,
+				mu1_stride, mu2_stride, xx_filt_stride, yy_filt_stride, xy_filt_stride,
+				vif_enhn_gain_limit);
+		return;
+	}
+#endif
+
 	static const float sigma_nsq = 2;
 	static const float sigma_max_inv = 4.0 / (255.0*255.0);
 
@@ -351,7 +390,7 @@ void vif_filter1d_s(const float *f, const float *src, float *dst, float *tmpbuf,
 
     /* fall back */
 
-    float *tmp = aligned_malloc(ALIGN_CEIL(w * sizeof(float)), MAX_ALIGN);
+    float *tmp = tmpbuf;
     float fcoeff, imgcoeff;
 
     int i, j, fi, fj, ii, jj;
@@ -393,8 +432,6 @@ void vif_filter1d_s(const float *f, const float *src, float *dst, float *tmpbuf,
             dst[i * dst_px_stride + j] = accum;
         }
     }
-
-    aligned_free(tmp);
 }
 
 // Code optimized by adding intrinsic code for the functions,
@@ -419,7 +456,7 @@ void vif_filter1d_sq_s(const float *f, const float *src, float *dst, float *tmpb
 
 	/* fall back */
 
-	float *tmp = aligned_malloc(ALIGN_CEIL(w * sizeof(float)), MAX_ALIGN);
+	float *tmp = tmpbuf;
 	float fcoeff, imgcoeff;
 
 	int i, j, fi, fj, ii, jj;
@@ -461,8 +498,6 @@ void vif_filter1d_sq_s(const float *f, const float *src, float *dst, float *tmpb
 			dst[i * dst_px_stride + j] = accum;
 		}
 	}
-
-	aligned_free(tmp);
 }
 
 void vif_filter1d_xy_s(const float *f, const float *src1, const float *src2, float *dst, float *tmpbuf, int w, int h, int src1_stride, int src2_stride, int dst_stride, int fwidth)
@@ -485,7 +520,7 @@ void vif_filter1d_xy_s(const float *f, const float *src1, const float *src2, flo
 
 	/* fall back */
 
-	float *tmp = aligned_malloc(ALIGN_CEIL(w * sizeof(float)), MAX_ALIGN);
+	float *tmp = tmpbuf;
 	float fcoeff, imgcoeff, imgcoeff1, imgcoeff2;
 
 	int i, j, fi, fj, ii, jj;
@@ -528,8 +563,6 @@ void vif_filter1d_xy_s(const float *f, const float *src1, const float *src2, flo
 			dst[i * dst_px_stride + j] = accum;
 		}
 	}
-
-	aligned_free(tmp);
 }
 
 void vif_filter2d_s(const float *f, const float *src, float *dst, int w, int h, int src_stride, int dst_stride, int fwidth)
@@ -19,6 +19,217 @@
 #include "feature/integer_adm.h"
 
 #include <immintrin.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MIN(x, y) (((x) < (y)) ? (x) : (y))
+#define MAX(x, y) (((x) > (y)) ? (x) : (y))
+
+/*
+ * The kernels below are bit-exact with their C counterparts in
+ * integer_adm.c. Integer math keeps the C types, using 64-bit lanes where the
+ * C code widens to int64_t, and the few floating-point decisions are
+ * evaluated in the same precision and order as the C expressions.
+ */
+
+static inline __m256i srai_epi64(__m256i v, int shift)
+{
+    const __m256i sign = _mm256_cmpgt_epi64(_mm256_setzero_si256(), v);
+    return _mm256_or_si256(_mm256_srl_epi64(v, _mm_cvtsi32_si128(shift)),
+                           _mm256_sll_epi64(sign, _mm_cvtsi32_si128(64 - shift)));
+}
+
+static inline int64_t hsum_epi64(__m256i v)
+{
+    const __m128i s = _mm_add_epi64(_mm256_castsi256_si128(v),
+                                    _mm256_extracti128_si256(v, 1));
+    return _mm_cvtsi128_si64(s) + _mm_extract_epi64(s, 1);
+}
+
+/* low 16 bits of eight 32-bit lanes, as an int32_t to int16_t conversion */
+static inline __m128i trunc_epi32_epi16(__m256i v)
+{
+    v = _mm256_blend_epi16(v, _mm256_setzero_si256(), 0xAA);
+    return _mm_packus_epi32(_mm256_castsi256_si128(v),
+                            _mm256_extracti128_si256(v, 1));
+}
+
+/* the low 32 bits of the 64-bit even and odd lanes, back in lane order */
+static inline __m256i merge_epi64_lo(__m256i even, __m256i odd)
+{
+    return _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+}
+
+static inline __m128i loadu_epi16_n(const int16_t *p, int n)
+{
+    if (n >= 8) return _mm_loadu_si128((const __m128i *)p);
+    int16_t tmp[8] = { 0 };
+    memcpy(tmp, p, n * sizeof(*p));
+    return _mm_loadu_si128((const __m128i *)tmp);
+}
+
+static inline void storeu_epi16_n(int16_t *p, __m128i v, int n)
+{
+    if (n >= 8) {
+        _mm_storeu_si128((__m128i *)p, v);
+        return;
+    }
+    int16_t tmp[8];
+    _mm_storeu_si128((__m128i *)tmp, v);
+    memcpy(p, tmp, n * sizeof(*p));
+}
+
+static inline __m256i tail_mask_epi32(int n)
+{
+    return _mm256_cmpgt_epi32(_mm256_set1_epi32(n),
+                              _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+}
+
+/* Vertical pass of one column for 8 to 16-bit input. */
+static inline void adm_dwt2_v_col(uint16_t u_s0, uint16_t u_s1, uint16_t u_s2,
+                                  uint16_t u_s3, int shift_VP,
+                                  int32_t add_shift_VP, int16_t *lo,
+                                  int16_t *hi)
+{
+    const int16_t *filter_lo = dwt2_db2_coeffs_lo;
+    const int16_t *filter_hi = dwt2_db2_coeffs_hi;
+    int32_t accum;
+
+    accum = 0;
+    accum += (int32_t)filter_lo[0] * (int32_t)u_s0;
+    accum += (int32_t)filter_lo[1] * (int32_t)u_s1;
+    accum += (int32_t)filter_lo[2] * (int32_t)u_s2;
+    accum += (int32_t)filter_lo[3] * (int32_t)u_s3;
+    accum -= (int32_t)dwt2_db2_coeffs_lo_sum * add_shift_VP;
+    *lo = (accum + add_shift_VP) >> shift_VP;
+
+    accum = 0;
+    accum += (int32_t)filter_hi[0] * (int32_t)u_s0;
+    accum += (int32_t)filter_hi[1] * (int32_t)u_s1;
+    accum += (int32_t)filter_hi[2] * (int32_t)u_s2;
+    accum += (int32_t)filter_hi[3] * (int32_t)u_s3;
+    accum -= (int32_t)dwt2_db2_coeffs_hi_sum * add_shift_VP;
+    *hi = (accum + add_shift_VP) >> shift_VP;
+}
+
+/* Horizontal pass of one output column, j may be mirrored at either edge. */
+static inline void adm_dwt2_h_col(const int16_t *tmplo, const int16_t *tmphi,
+                                  const adm_dwt_band_t *dst, int **ind_x,
+                                  ptrdiff_t offset, int j)
+{
+    const int16_t *filter_lo = dwt2_db2_coeffs_lo;
+    const int16_t *filter_hi = dwt2_db2_coeffs_hi;
+    const int32_t add_shift_HP = 32768;
+    const int16_t shift_HP = 16;
+    const int j0 = ind_x[0][j];
+    const int j1 = ind_x[1][j];
+    const int j2 = ind_x[2][j];
+    const int j3 = ind_x[3][j];
+    int32_t accum;
+
+    int16_t s0 = tmplo[j0];
+    int16_t s1 = tmplo[j1];
+    int16_t s2 = tmplo[j2];
+    int16_t s3 = tmplo[j3];
+
+    accum = 0;
+    accum += (int32_t)filter_lo[0] * s0;
+    accum += (int32_t)filter_lo[1] * s1;
+    accum += (int32_t)filter_lo[2] * s2;
+    accum += (int32_t)filter_lo[3] * s3;
+    dst->band_a[offset + j] = (accum + add_shift_HP) >> shift_HP;
+
+    accum = 0;
+    accum += (int32_t)filter_hi[0] * s0;
+    accum += (int32_t)filter_hi[1] * s1;
+    accum += (int32_t)filter_hi[2] * s2;
+    accum += (int32_t)filter_hi[3] * s3;
+    dst->band_v[offset + j] = (accum + add_shift_HP) >> shift_HP;
+
+    s0 = tmphi[j0];
+    s1 = tmphi[j1];
+    s2 = tmphi[j2];
+    s3 = tmphi[j3];
+
+    accum = 0;
+    accum += (int32_t)filter_lo[0] * s0;
+    accum += (int32_t)filter_lo[1] * s1;
+    accum += (int32_t)filter_lo[2] * s2;
+    accum += (int32_t)filter_lo[3] * s3;
+    dst->band_h[offset + j] = (accum + add_shift_HP) >> shift_HP;
+
+    accum = 0;
+    accum += (int32_t)filter_hi[0] * s0;
+    accum += (int32_t)filter_hi[1] * s1;
+    accum += (int32_t)filter_hi[2] * s2;
+    accum += (int32_t)filter_hi[3] * s3;
+    dst->band_d[offset + j] = (accum + add_shift_HP) >> shift_HP;
+}
+
+/* 16 output columns from j of the lo and hi filters over one tmp row. */
+static inline void adm_dwt2_h_16(const int16_t *tmp, int16_t *lo, int16_t *hi,
+                                 int j, __m256i fl0, __m256i fl1, __m256i fh0,
+                                 __m256i fh1)
+{
+    const __m256i add_shift_HP = _mm256_set1_epi32(32768);
+
+    const __m256i s0 = _mm256_loadu_si256((__m256i *)(tmp + 2 * j - 1));
+    const __m256i s1 = _mm256_loadu_si256((__m256i *)(tmp + 2 * j + 1));
+    const __m256i s2 = _mm256_loadu_si256((__m256i *)(tmp + 2 * j + 15));
+    const __m256i s3 = _mm256_loadu_si256((__m256i *)(tmp + 2 * j + 17));
+
+    __m256i accum_lo =
+        _mm256_add_epi32(_mm256_madd_epi16(s0, fl0), _mm256_madd_epi16(s1, fl1));
+    __m256i accum_hi =
+        _mm256_add_epi32(_mm256_madd_epi16(s2, fl0), _mm256_madd_epi16(s3, fl1));
+    accum_lo = _mm256_srli_epi32(_mm256_add_epi32(accum_lo, add_shift_HP), 16);
+    accum_hi = _mm256_srli_epi32(_mm256_add_epi32(accum_hi, add_shift_HP), 16);
+    accum_lo = _mm256_packus_epi32(accum_lo, accum_hi);
+    accum_lo = _mm256_permute4x64_epi64(accum_lo, 0xD8);
+    _mm256_storeu_si256((__m256i *)(lo + j), accum_lo);
+
+    accum_lo =
+        _mm256_add_epi32(_mm256_madd_epi16(s0, fh0), _mm256_madd_epi16(s1, fh1));
+    accum_hi =
+        _mm256_add_epi32(_mm256_madd_epi16(s2, fh0), _mm256_madd_epi16(s3, fh1));
+    accum_lo = _mm256_srli_epi32(_mm256_add_epi32(accum_lo, add_shift_HP), 16);
+    accum_hi = _mm256_srli_epi32(_mm256_add_epi32(accum_hi, add_shift_HP), 16);
+    accum_lo = _mm256_packus_epi32(accum_lo, accum_hi);
+    accum_lo = _mm256_permute4x64_epi64(accum_lo, 0xD8);
+    _mm256_storeu_si256((__m256i *)(hi + j), accum_lo);
+}
+
+static void adm_dwt2_h_row(const int16_t *tmplo, const int16_t *tmphi,
+                           const adm_dwt_band_t *dst, int **ind_x, int w,
+                           ptrdiff_t offset)
+{
+    const int16_t *filter_lo = dwt2_db2_coeffs_lo;
+    const int16_t *filter_hi = dwt2_db2_coeffs_hi;
+    const __m256i fl0 =
+        _mm256_broadcastd_epi32(_mm_loadu_si128((__m128i *)filter_lo));
+    const __m256i fl1 =
+        _mm256_broadcastd_epi32(_mm_loadu_si128((__m128i *)(filter_lo + 2)));
+    const __m256i fh0 =
+        _mm256_broadcastd_epi32(_mm_loadu_si128((__m128i *)filter_hi));
+    const __m256i fh1 =
+        _mm256_broadcastd_epi32(_mm_loadu_si128((__m128i *)(filter_hi + 2)));
+
+    // taps of j reach 2 * j + 2, those of the last columns are mirrored
+    const int w_half = (w + 1) / 2;
+    const int j_end = (w - 3) / 2 + 1;
+
+    adm_dwt2_h_col(tmplo, tmphi, dst, ind_x, offset, 0);
+    int j = 1;
+    for (; j + 16 <= j_end; j += 16) {
+        adm_dwt2_h_16(tmplo, dst->band_a + offset, dst->band_v + offset, j,
+                      fl0, fl1, fh0, fh1);
+        adm_dwt2_h_16(tmphi, dst->band_h + offset, dst->band_d + offset, j,
+                      fl0, fl1, fh0, fh1);
+    }
+    for (; j < w_half; ++j)
+        adm_dwt2_h_col(tmplo, tmphi, dst, ind_x, offset, j);
+}
 
 void adm_dwt2_8_avx2(const uint8_t *src, const adm_dwt_band_t *dst,
                      AdmBuffer *buf, int w, int h, int src_stride,
@@ -27,17 +238,11 @@ void adm_dwt2_8_avx2(const uint8_t *src, const adm_dwt_band_t *dst,
     const int16_t *filter_lo = dwt2_db2_coeffs_lo;
     const int16_t *filter_hi = dwt2_db2_coeffs_hi;
 
-    const int16_t shift_VP = 8;
-    const int16_t shift_HP = 16;
-    const int32_t add_shift_VP = 128;
-    const int32_t add_shift_HP = 32768;
     int **ind_y = buf->ind_y;
     int **ind_x = buf->ind_x;
 
     int16_t *tmplo = (int16_t *)buf->tmp_ref;
     int16_t *tmphi = tmplo + w;
-    int32_t accum;
-    int32_t accumv[16] = {0};
 
     __m256i dwt2_db2_coeffs_lo_sum_const = _mm256_set1_epi32(5931776);
     __m256i fl0 =
@@ -50,26 +255,26 @@ void adm_dwt2_8_avx2(const uint8_t *src, const adm_dwt_band_t *dst,
         _mm256_broadcastd_epi32(_mm_loadu_si128((__m128i *)(filter_hi + 2)));
     __m256i add_shift_VP_vex = _mm256_set1_epi32(128);
     __m256i pad_register = _mm256_setzero_si256();
-    __m256i add_shift_HP_vex = _mm256_set1_epi32(32768);
 
     for (int i = 0; i < (h + 1) / 2; ++i) {
         /* Vertical pass. */
+        const uint8_t *src0 = src + ind_y[0][i] * src_stride;
+        const uint8_t *src1 = src + ind_y[1][i] * src_stride;
+        const uint8_t *src2 = src + ind_y[2][i] * src_stride;
+        const uint8_t *src3 = src + ind_y[3][i] * src_stride;
 
-        for (int j = 0; j < w; j = j + 16) {
+        int j = 0;
+        for (; j + 16 <= w; j = j + 16) {
 
             __m256i accum_mu2_lo, accum_mu2_hi, accum_mu1_lo, accum_mu1_hi;
             accum_mu2_lo = accum_mu2_hi = accum_mu1_lo = accum_mu1_hi =
                 _mm256_setzero_si256();
-            __m256i s0, s1, s2, s3, s4;
+            __m256i s0, s1, s2, s3;
 
-            s0 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(src + (ind_y[0][i] * src_stride) + j)));
-            s1 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(src + (ind_y[1][i] * src_stride) + j)));
-            s2 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(src + (ind_y[2][i] * src_stride) + j)));
-            s3 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(src + (ind_y[3][i] * src_stride) + j)));
+            s0 = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i *)(src0 + j)));
+            s1 = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i *)(src1 + j)));
+            s2 = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i *)(src2 + j)));
+            s3 = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i *)(src3 + j)));
 
             __m256i s0lo = _mm256_unpacklo_epi16(s0, s1);
             __m256i s0hi = _mm256_unpackhi_epi16(s0, s1);
@@ -117,161 +322,1246 @@ void adm_dwt2_8_avx2(const uint8_t *src, const adm_dwt_band_t *dst,
             accum_mu1_hi = _mm256_blend_epi16(accum_mu1_hi, pad_register, 0xAA);
             accum_mu1_hi = _mm256_packus_epi32(accum_mu1_lo, accum_mu1_hi);
             _mm256_storeu_si256((__m256i *)(tmphi + j), accum_mu1_hi);
-            // for( int k =0; k<16;k++){
-            //     fprintf(stderr, "actual value hi tmp is %d \n",tmphi[j +k]);
-            // }
         }
+        // a whole vector here would spill from tmplo into tmphi
+        for (; j < w; ++j) {
+            adm_dwt2_v_col(src0[j], src1[j], src2[j], src3[j], 8, 128,
+                           &tmplo[j], &tmphi[j]);
+        }
+
+        /* Horizontal pass (lo and hi). */
+        adm_dwt2_h_row(tmplo, tmphi, dst, ind_x, w, i * dst_stride);
+    }
+}
+
+void adm_dwt2_16_avx2(const uint16_t *src, const adm_dwt_band_t *dst,
+                      AdmBuffer *buf, int w, int h, int src_stride,
+                      int dst_stride, int inp_size_bits)
+{
+    const int16_t *filter_lo = dwt2_db2_coeffs_lo;
+    const int16_t *filter_hi = dwt2_db2_coeffs_hi;
+
+    const int16_t shift_VP = inp_size_bits;
+    const int32_t add_shift_VP = 1 << (inp_size_bits - 1);
+
+    int **ind_y = buf->ind_y;
+    int **ind_x = buf->ind_x;
+
+    int16_t *tmplo = (int16_t *)buf->tmp_ref;
+    int16_t *tmphi = tmplo + w;
+
+    const __m256i fl0 =
+        _mm256_broadcastd_epi32(_mm_loadu_si128((__m128i *)filter_lo));
+    const __m256i fl1 =
+        _mm256_broadcastd_epi32(_mm_loadu_si128((__m128i *)(filter_lo + 2)));
+    const __m256i fh0 =
+        _mm256_broadcastd_epi32(_mm_loadu_si128((__m128i *)filter_hi));
+    const __m256i fh1 =
+        _mm256_broadcastd_epi32(_mm_loadu_si128((__m128i *)(filter_hi + 2)));
+
+    /*
+     * Samples are biased by -32768 to fit madd_epi16, which takes
+     * 32768 * sum(filter) off the sums. That is 0 for the high-pass filter,
+     * for the low-pass one it is added back along with the normalization,
+     * all of it wrapping like the int32_t sums of adm_dwt2_16().
+     */
+    const __m256i bias = _mm256_set1_epi16((int16_t)0x8000);
+    const uint32_t lo_sum = dwt2_db2_coeffs_lo_sum;
+    const __m256i add_lo = _mm256_set1_epi32(
+        (int32_t)(32768u * lo_sum - lo_sum * add_shift_VP + add_shift_VP));
+    const __m256i add_hi = _mm256_set1_epi32(add_shift_VP);
+    const __m128i shift = _mm_cvtsi32_si128(shift_VP);
+    const __m256i zero = _mm256_setzero_si256();
+
+    for (int i = 0; i < (h + 1) / 2; ++i) {
+        /* Vertical pass. */
+        const uint16_t *src0 = src + ind_y[0][i] * src_stride;
+        const uint16_t *src1 = src + ind_y[1][i] * src_stride;
+        const uint16_t *src2 = src + ind_y[2][i] * src_stride;
+        const uint16_t *src3 = src + ind_y[3][i] * src_stride;
+
+        int j = 0;
+        for (; j + 16 <= w; j += 16) {
+            const __m256i s0 = _mm256_xor_si256(
+                _mm256_loadu_si256((__m256i *)(src0 + j)), bias);
+            const __m256i s1 = _mm256_xor_si256(
+                _mm256_loadu_si256((__m256i *)(src1 + j)), bias);
+            const __m256i s2 = _mm256_xor_si256(
+                _mm256_loadu_si256((__m256i *)(src2 + j)), bias);
+            const __m256i s3 = _mm256_xor_si256(
+                _mm256_loadu_si256((__m256i *)(src3 + j)), bias);
+
+            const __m256i s01lo = _mm256_unpacklo_epi16(s0, s1);
+            const __m256i s01hi = _mm256_unpackhi_epi16(s0, s1);
+            const __m256i s23lo = _mm256_unpacklo_epi16(s2, s3);
+            const __m256i s23hi = _mm256_unpackhi_epi16(s2, s3);
+
+            __m256i accum_lo, accum_hi;
+
+            accum_lo = _mm256_add_epi32(_mm256_madd_epi16(s01lo, fl0),
+                                        _mm256_madd_epi16(s23lo, fl1));
+            accum_hi = _mm256_add_epi32(_mm256_madd_epi16(s01hi, fl0),
+                                        _mm256_madd_epi16(s23hi, fl1));
+            accum_lo = _mm256_sra_epi32(_mm256_add_epi32(accum_lo, add_lo), shift);
+            accum_hi = _mm256_sra_epi32(_mm256_add_epi32(accum_hi, add_lo), shift);
+            accum_lo = _mm256_blend_epi16(accum_lo, zero, 0xAA);
+            accum_hi = _mm256_blend_epi16(accum_hi, zero, 0xAA);
+            _mm256_storeu_si256((__m256i *)(tmplo + j),
+                                _mm256_packus_epi32(accum_lo, accum_hi));
+
+            accum_lo = _mm256_add_epi32(_mm256_madd_epi16(s01lo, fh0),
+                                        _mm256_madd_epi16(s23lo, fh1));
+            accum_hi = _mm256_add_epi32(_mm256_madd_epi16(s01hi, fh0),
+                                        _mm256_madd_epi16(s23hi, fh1));
+            accum_lo = _mm256_sra_epi32(_mm256_add_epi32(accum_lo, add_hi), shift);
+            accum_hi = _mm256_sra_epi32(_mm256_add_epi32(accum_hi, add_hi), shift);
+            accum_lo = _mm256_blend_epi16(accum_lo, zero, 0xAA);
+            accum_hi = _mm256_blend_epi16(accum_hi, zero, 0xAA);
+            _mm256_storeu_si256((__m256i *)(tmphi + j),
+                                _mm256_packus_epi32(accum_lo, accum_hi));
+        }
+        for (; j < w; ++j) {
+            adm_dwt2_v_col(src0[j], src1[j], src2[j], src3[j], shift_VP,
+                           add_shift_VP, &tmplo[j], &tmphi[j]);
+        }
+
+        /* Horizontal pass (lo and hi). */
+        adm_dwt2_h_row(tmplo, tmphi, dst, ind_x, w, i * dst_stride);
+    }
+}
+
+/* One output of the 32-bit filters, int64_t sums as in the C code. */
+static inline int32_t adm_dwt2_s123_tap(const int16_t *filter, int32_t s0,
+                                        int32_t s1, int32_t s2, int32_t s3,
+                                        int32_t add_shift, int16_t shift)
+{
+    int64_t accum = 0;
+    accum += (int64_t)filter[0] * s0;
+    accum += (int64_t)filter[1] * s1;
+    accum += (int64_t)filter[2] * s2;
+    accum += (int64_t)filter[3] * s3;
+    return (int32_t)((accum + add_shift) >> shift);
+}
+
+static inline void adm_dwt2_s123_h_col(const int32_t *tmplo,
+                                       const int32_t *tmphi,
+                                       const i4_adm_dwt_band_t *dst,
+                                       int **ind_x, ptrdiff_t offset, int j,
+                                       int32_t add_shift, int16_t shift)
+{
+    const int16_t *filter_lo = dwt2_db2_coeffs_lo;
+    const int16_t *filter_hi = dwt2_db2_coeffs_hi;
+    const int j0 = ind_x[0][j];
+    const int j1 = ind_x[1][j];
+    const int j2 = ind_x[2][j];
+    const int j3 = ind_x[3][j];
+
+    dst->band_a[offset + j] =
+        adm_dwt2_s123_tap(filter_lo, tmplo[j0], tmplo[j1], tmplo[j2],
+                          tmplo[j3], add_shift, shift);
+    dst->band_v[offset + j] =
+        adm_dwt2_s123_tap(filter_hi, tmplo[j0], tmplo[j1], tmplo[j2],
+                          tmplo[j3], add_shift, shift);
+    dst->band_h[offset + j] =
+        adm_dwt2_s123_tap(filter_lo, tmphi[j0], tmphi[j1], tmphi[j2],
+                          tmphi[j3], add_shift, shift);
+    dst->band_d[offset + j] =
+        adm_dwt2_s123_tap(filter_hi, tmphi[j0], tmphi[j1], tmphi[j2],
+                          tmphi[j3], add_shift, shift);
+}
+
+/*
+ * Low 32 bits of (even + add) >> shift and (odd + add) >> shift, where even
+ * and odd hold the 64-bit sums of the even and odd lanes.
+ */
+static inline __m256i round_shift_merge_epi64(__m256i even, __m256i odd,
+                                              __m256i add, int shift)
+{
+    even = _mm256_srl_epi64(_mm256_add_epi64(even, add),
+                            _mm_cvtsi32_si128(shift));
+    odd = _mm256_sll_epi64(_mm256_add_epi64(odd, add),
+                           _mm_cvtsi32_si128(32 - shift));
+    return _mm256_blend_epi32(even, odd, 0xAA);
+}
+
+static inline void adm_dwt2_s123_v_8(const int32_t *src0, const int32_t *src1,
+                                     const int32_t *src2, const int32_t *src3,
+                                     int32_t *lo, int32_t *hi, const __m256i *fl,
+                                     const __m256i *fh, __m256i add, int shift)
+{
+    const __m256i s0 = _mm256_loadu_si256((__m256i *)src0);
+    const __m256i s1 = _mm256_loadu_si256((__m256i *)src1);
+    const __m256i s2 = _mm256_loadu_si256((__m256i *)src2);
+    const __m256i s3 = _mm256_loadu_si256((__m256i *)src3);
+    const __m256i o0 = _mm256_srli_epi64(s0, 32);
+    const __m256i o1 = _mm256_srli_epi64(s1, 32);
+    const __m256i o2 = _mm256_srli_epi64(s2, 32);
+    const __m256i o3 = _mm256_srli_epi64(s3, 32);
+
+    __m256i even, odd;
+
+    even = _mm256_add_epi64(
+        _mm256_add_epi64(_mm256_mul_epi32(s0, fl[0]), _mm256_mul_epi32(s1, fl[1])),
+        _mm256_add_epi64(_mm256_mul_epi32(s2, fl[2]), _mm256_mul_epi32(s3, fl[3])));
+    odd = _mm256_add_epi64(
+        _mm256_add_epi64(_mm256_mul_epi32(o0, fl[0]), _mm256_mul_epi32(o1, fl[1])),
+        _mm256_add_epi64(_mm256_mul_epi32(o2, fl[2]), _mm256_mul_epi32(o3, fl[3])));
+    _mm256_storeu_si256((__m256i *)lo,
+                        round_shift_merge_epi64(even, odd, add, shift));
+
+    even = _mm256_add_epi64(
+        _mm256_add_epi64(_mm256_mul_epi32(s0, fh[0]), _mm256_mul_epi32(s1, fh[1])),
+        _mm256_add_epi64(_mm256_mul_epi32(s2, fh[2]), _mm256_mul_epi32(s3, fh[3])));
+    odd = _mm256_add_epi64(
+        _mm256_add_epi64(_mm256_mul_epi32(o0, fh[0]), _mm256_mul_epi32(o1, fh[1])),
+        _mm256_add_epi64(_mm256_mul_epi32(o2, fh[2]), _mm256_mul_epi32(o3, fh[3])));
+    _mm256_storeu_si256((__m256i *)hi,
+                        round_shift_merge_epi64(even, odd, add, shift));
+}
+
+/*
+ * 8 outputs from j of the lo and hi filters over one tmp row. The even 32-bit
+ * lanes of a load from 2 * j - 1 are the first taps of outputs j to j + 3,
+ * the odd ones the second taps, likewise a load from 2 * j + 1 gives the
+ * third and fourth taps.
+ */
+static inline void adm_dwt2_s123_h_8(const int32_t *tmp, int32_t *lo,
+                                     int32_t *hi, int j, const __m256i *fl,
+                                     const __m256i *fh, __m256i add, int shift)
+{
+    const __m256i idx = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+
+    const __m256i a = _mm256_loadu_si256((__m256i *)(tmp + 2 * j - 1));
+    const __m256i b = _mm256_loadu_si256((__m256i *)(tmp + 2 * j + 7));
+    const __m256i c = _mm256_loadu_si256((__m256i *)(tmp + 2 * j + 1));
+    const __m256i d = _mm256_loadu_si256((__m256i *)(tmp + 2 * j + 9));
+    const __m256i a1 = _mm256_srli_epi64(a, 32);
+    const __m256i b1 = _mm256_srli_epi64(b, 32);
+    const __m256i c1 = _mm256_srli_epi64(c, 32);
+    const __m256i d1 = _mm256_srli_epi64(d, 32);
+
+    __m256i first, second;
+
+    first = _mm256_add_epi64(
+        _mm256_add_epi64(_mm256_mul_epi32(a, fl[0]), _mm256_mul_epi32(a1, fl[1])),
+        _mm256_add_epi64(_mm256_mul_epi32(c, fl[2]), _mm256_mul_epi32(c1, fl[3])));
+    second = _mm256_add_epi64(
+        _mm256_add_epi64(_mm256_mul_epi32(b, fl[0]), _mm256_mul_epi32(b1, fl[1])),
+        _mm256_add_epi64(_mm256_mul_epi32(d, fl[2]), _mm256_mul_epi32(d1, fl[3])));
+    _mm256_storeu_si256((__m256i *)(lo + j),
+        _mm256_permutevar8x32_epi32(
+            round_shift_merge_epi64(first, second, add, shift), idx));
+
+    first = _mm256_add_epi64(
+        _mm256_add_epi64(_mm256_mul_epi32(a, fh[0]), _mm256_mul_epi32(a1, fh[1])),
+        _mm256_add_epi64(_mm256_mul_epi32(c, fh[2]), _mm256_mul_epi32(c1, fh[3])));
+    second = _mm256_add_epi64(
+        _mm256_add_epi64(_mm256_mul_epi32(b, fh[0]), _mm256_mul_epi32(b1, fh[1])),
+        _mm256_add_epi64(_mm256_mul_epi32(d, fh[2]), _mm256_mul_epi32(d1, fh[3])));
+    _mm256_storeu_si256((__m256i *)(hi + j),
+        _mm256_permutevar8x32_epi32(
+            round_shift_merge_epi64(first, second, add, shift), idx));
+}
+
+void adm_dwt2_s123_combined_avx2(const int32_t *i4_ref_scale,
+                                 const int32_t *i4_curr_dis, AdmBuffer *buf,
+                                 int w, int h, int ref_stride, int dis_stride,
+                                 int dst_stride, int scale)
+{
+    const i4_adm_dwt_band_t *i4_ref_dwt2 = &buf->i4_ref_dwt2;
+    const i4_adm_dwt_band_t *i4_dis_dwt2 = &buf->i4_dis_dwt2;
+    int **ind_y = buf->ind_y;
+    int **ind_x = buf->ind_x;
+
+    const int16_t *filter_lo = dwt2_db2_coeffs_lo;
+    const int16_t *filter_hi = dwt2_db2_coeffs_hi;
+
+    const int32_t add_bef_shift_round_VP[3] = { 0, 32768, 32768 };
+    const int32_t add_bef_shift_round_HP[3] = { 16384, 32768, 16384 };
+    const int16_t shift_VerticalPass[3] = { 0, 16, 16 };
+    const int16_t shift_HorizontalPass[3] = { 15, 16, 15 };
+
+    const int32_t add_VP = add_bef_shift_round_VP[scale - 1];
+    const int32_t add_HP = add_bef_shift_round_HP[scale - 1];
+    const int16_t shift_VP = shift_VerticalPass[scale - 1];
+    const int16_t shift_HP = shift_HorizontalPass[scale - 1];
+
+    int32_t *tmplo_ref = buf->tmp_ref;
+    int32_t *tmphi_ref = tmplo_ref + w;
+    int32_t *tmplo_dis = tmphi_ref + w;
+    int32_t *tmphi_dis = tmplo_dis + w;
+
+    const __m256i fl[4] = {
+        _mm256_set1_epi32(filter_lo[0]), _mm256_set1_epi32(filter_lo[1]),
+        _mm256_set1_epi32(filter_lo[2]), _mm256_set1_epi32(filter_lo[3]),
+    };
+    const __m256i fh[4] = {
+        _mm256_set1_epi32(filter_hi[0]), _mm256_set1_epi32(filter_hi[1]),
+        _mm256_set1_epi32(filter_hi[2]), _mm256_set1_epi32(filter_hi[3]),
+    };
+    const __m256i add_VP_64 = _mm256_set1_epi64x(add_VP);
+    const __m256i add_HP_64 = _mm256_set1_epi64x(add_HP);
+
+    const int w_half = (w + 1) / 2;
+    const int j_end = (w - 3) / 2 + 1;
+
+    for (int i = 0; i < (h + 1) / 2; ++i) {
+        /* Vertical pass. */
+        const int32_t *ref0 = i4_ref_scale + ind_y[0][i] * ref_stride;
+        const int32_t *ref1 = i4_ref_scale + ind_y[1][i] * ref_stride;
+        const int32_t *ref2 = i4_ref_scale + ind_y[2][i] * ref_stride;
+        const int32_t *ref3 = i4_ref_scale + ind_y[3][i] * ref_stride;
+        const int32_t *dis0 = i4_curr_dis + ind_y[0][i] * dis_stride;
+        const int32_t *dis1 = i4_curr_dis + ind_y[1][i] * dis_stride;
+        const int32_t *dis2 = i4_curr_dis + ind_y[2][i] * dis_stride;
+        const int32_t *dis3 = i4_curr_dis + ind_y[3][i] * dis_stride;
+
+        int j = 0;
+        for (; j + 8 <= w; j += 8) {
+            adm_dwt2_s123_v_8(ref0 + j, ref1 + j, ref2 + j, ref3 + j,
+                              tmplo_ref + j, tmphi_ref + j, fl, fh, add_VP_64,
+                              shift_VP);
+            adm_dwt2_s123_v_8(dis0 + j, dis1 + j, dis2 + j, dis3 + j,
+                              tmplo_dis + j, tmphi_dis + j, fl, fh, add_VP_64,
+                              shift_VP);
+        }
+        for (; j < w; ++j) {
+            tmplo_ref[j] = adm_dwt2_s123_tap(filter_lo, ref0[j], ref1[j],
+                                             ref2[j], ref3[j], add_VP, shift_VP);
+            tmphi_ref[j] = adm_dwt2_s123_tap(filter_hi, ref0[j], ref1[j],
+                                             ref2[j], ref3[j], add_VP, shift_VP);
+            tmplo_dis[j] = adm_dwt2_s123_tap(filter_lo, dis0[j], dis1[j],
+                                             dis2[j], dis3[j], add_VP, shift_VP);
+            tmphi_dis[j] = adm_dwt2_s123_tap(filter_hi, dis0[j], dis1[j],
+                                             dis2[j], dis3[j], add_VP, shift_VP);
+        }
+
+        /* Horizontal pass (lo and hi). */
+        const ptrdiff_t offset = i * dst_stride;
+        adm_dwt2_s123_h_col(tmplo_ref, tmphi_ref, i4_ref_dwt2, ind_x, offset,
+                            0, add_HP, shift_HP);
+        adm_dwt2_s123_h_col(tmplo_dis, tmphi_dis, i4_dis_dwt2, ind_x, offset,
+                            0, add_HP, shift_HP);
+        j = 1;
+        for (; j + 8 <= j_end; j += 8) {
+            adm_dwt2_s123_h_8(tmplo_ref, i4_ref_dwt2->band_a + offset,
+                              i4_ref_dwt2->band_v + offset, j, fl, fh,
+                              add_HP_64, shift_HP);
+            adm_dwt2_s123_h_8(tmphi_ref, i4_ref_dwt2->band_h + offset,
+                              i4_ref_dwt2->band_d + offset, j, fl, fh,
+                              add_HP_64, shift_HP);
+            adm_dwt2_s123_h_8(tmplo_dis, i4_dis_dwt2->band_a + offset,
+                              i4_dis_dwt2->band_v + offset, j, fl, fh,
+                              add_HP_64, shift_HP);
+            adm_dwt2_s123_h_8(tmphi_dis, i4_dis_dwt2->band_h + offset,
+                              i4_dis_dwt2->band_d + offset, j, fl, fh,
+                              add_HP_64, shift_HP);
+        }
+        for (; j < w_half; ++j) {
+            adm_dwt2_s123_h_col(tmplo_ref, tmphi_ref, i4_ref_dwt2, ind_x,
+                                offset, j, add_HP, shift_HP);
+            adm_dwt2_s123_h_col(tmplo_dis, tmphi_dis, i4_dis_dwt2, ind_x,
+                                offset, j, add_HP, shift_HP);
+        }
+    }
+}
+
+/* Frame region the decouple and csf stages are computed on. */
+static inline void adm_dwt_border(int w, int h, int *left, int *top,
+                                  int *right, int *bottom)
+{
+    *left = w * ADM_BORDER_FACTOR - 0.5 - 1; // -1 for filter tap
+    *top = h * ADM_BORDER_FACTOR - 0.5 - 1;
+    *right = w - *left + 2; // +2 for filter tap
+    *bottom = h - *top + 2;
+
+    if (*left < 0) {
+        *left = 0;
+    }
+    if (*right > w) {
+        *right = w;
+    }
+    if (*top < 0) {
+        *top = 0;
+    }
+    if (*bottom > h) {
+        *bottom = h;
+    }
+}
+
+/* 32-bit lanes in order from two 4 x 64-bit masks of lanes 0-3 and 4-7. */
+static inline __m256i mask_pd_epi32(__m256d lo, __m256d hi)
+{
+    const __m256i idx = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    const __m256i l =
+        _mm256_permutevar8x32_epi32(_mm256_castpd_si256(lo), idx);
+    const __m256i u =
+        _mm256_permutevar8x32_epi32(_mm256_castpd_si256(hi), idx);
+    return _mm256_permute2x128_si256(l, u, 0x20);
+}
+
+/*
+ * angle_flag of adm_decouple() for 4 lanes, from products that are exact in
+ * double. As in the C code, every value is rounded to float before the
+ * comparison is evaluated in double.
+ */
+static inline __m256d adm_angle_flag_pd(__m256d ot_dp, __m256d o_mag_sq,
+                                        __m256d t_mag_sq, __m256d cos_1deg_sq)
+{
+    const __m256d by_4096 = _mm256_set1_pd(1.0 / 4096.0);
+    const __m256d ot =
+        _mm256_mul_pd(_mm256_cvtps_pd(_mm256_cvtpd_ps(ot_dp)), by_4096);
+    const __m256d om =
+        _mm256_mul_pd(_mm256_cvtps_pd(_mm256_cvtpd_ps(o_mag_sq)), by_4096);
+    const __m256d tm =
+        _mm256_mul_pd(_mm256_cvtps_pd(_mm256_cvtpd_ps(t_mag_sq)), by_4096);
+
+    const __m256d lhs = _mm256_mul_pd(ot, ot);
+    const __m256d rhs = _mm256_mul_pd(_mm256_mul_pd(cos_1deg_sq, om), tm);
+    return _mm256_and_pd(_mm256_cmp_pd(ot, _mm256_setzero_pd(), _CMP_GE_OQ),
+                         _mm256_cmp_pd(lhs, rhs, _CMP_GE_OQ));
+}
+
+/*
+ * The enhancement gain limit of both decouple stages: rst is replaced by
+ * MIN(rst * limit, t) where pos is set and by MAX(rst * limit, t) where neg
+ * is set, evaluated in double as in the C code.
+ */
+static inline __m256i adm_gain_limit(__m256i rst, __m256i t, __m256i pos,
+                                     __m256i neg, __m256d limit)
+{
+    const __m128i rst_lo = _mm256_castsi256_si128(rst);
+    const __m128i rst_hi = _mm256_extracti128_si256(rst, 1);
+    const __m256d r0 = _mm256_mul_pd(_mm256_cvtepi32_pd(rst_lo), limit);
+    const __m256d r1 = _mm256_mul_pd(_mm256_cvtepi32_pd(rst_hi), limit);
+    const __m256d t0 = _mm256_cvtepi32_pd(_mm256_castsi256_si128(t));
+    const __m256d t1 = _mm256_cvtepi32_pd(_mm256_extracti128_si256(t, 1));
+
+    const __m256i rst_min = _mm256_setr_m128i(
+        _mm256_cvttpd_epi32(_mm256_min_pd(r0, t0)),
+        _mm256_cvttpd_epi32(_mm256_min_pd(r1, t1)));
+    const __m256i rst_max = _mm256_setr_m128i(
+        _mm256_cvttpd_epi32(_mm256_max_pd(r0, t0)),
+        _mm256_cvttpd_epi32(_mm256_max_pd(r1, t1)));
+
+    rst = _mm256_blendv_epi8(rst, rst_min, pos);
+    return _mm256_blendv_epi8(rst, rst_max, neg);
+}
+
+/*
+ * k and rst of adm_decouple() for one orientation. The int64_t products of
+ * the division by lookup take the even and odd lanes apart.
+ */
+static inline __m256i adm_decouple_rst(const int32_t *div_lookup,
+                                       __m256i o, __m256i t, __m256i *k)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i add = _mm256_set1_epi64x(16384);
+
+    const __m256i div = _mm256_i32gather_epi32(
+        div_lookup, _mm256_add_epi32(o, _mm256_set1_epi32(32768)), 4);
+    const __m256i q_even = _mm256_add_epi64(_mm256_mul_epi32(div, t), add);
+    const __m256i q_odd = _mm256_add_epi64(
+        _mm256_mul_epi32(_mm256_srli_epi64(div, 32), _mm256_srli_epi64(t, 32)),
+        add);
+
+    // q >> 15 fits in 31 bits for q >= 0, tmp_k < 0 iff q < 0
+    const __m256i tmp_k =
+        merge_epi64_lo(_mm256_srli_epi64(q_even, 15), _mm256_srli_epi64(q_odd, 15));
+    const __m256i neg = _mm256_blend_epi32(_mm256_cmpgt_epi64(zero, q_even),
+                                           _mm256_cmpgt_epi64(zero, q_odd), 0xAA);
+    __m256i kk = _mm256_min_epi32(tmp_k, _mm256_set1_epi32(32768));
+    kk = _mm256_andnot_si256(neg, kk);
+    kk = _mm256_blendv_epi8(kk, _mm256_set1_epi32(32768),
+                            _mm256_cmpeq_epi32(o, zero));
+    *k = kk;
+
+    return _mm256_srai_epi32(
+        _mm256_add_epi32(_mm256_mullo_epi32(kk, o), _mm256_set1_epi32(16384)),
+        15);
+}
 
-        int j0 = ind_x[0][0];
-        int j1 = ind_x[1][0];
-        int j2 = ind_x[2][0];
-        int j3 = ind_x[3][0];
-
-        int16_t s0 = tmplo[j0];
-        int16_t s1 = tmplo[j1];
-        int16_t s2 = tmplo[j2];
-        int16_t s3 = tmplo[j3];
-
-        accum = 0;
-        accum += (int32_t)filter_lo[0] * s0;
-        accum += (int32_t)filter_lo[1] * s1;
-        accum += (int32_t)filter_lo[2] * s2;
-        accum += (int32_t)filter_lo[3] * s3;
-        dst->band_a[i * dst_stride] = (accum + add_shift_HP) >> shift_HP;
-
-        accum = 0;
-        accum += (int32_t)filter_hi[0] * s0;
-        accum += (int32_t)filter_hi[1] * s1;
-        accum += (int32_t)filter_hi[2] * s2;
-        accum += (int32_t)filter_hi[3] * s3;
-        dst->band_v[i * dst_stride] = (accum + add_shift_HP) >> shift_HP;
-
-        s0 = tmphi[j0];
-        s1 = tmphi[j1];
-        s2 = tmphi[j2];
-        s3 = tmphi[j3];
-
-        accum = 0;
-        accum += (int32_t)filter_lo[0] * s0;
-        accum += (int32_t)filter_lo[1] * s1;
-        accum += (int32_t)filter_lo[2] * s2;
-        accum += (int32_t)filter_lo[3] * s3;
-        dst->band_h[i * dst_stride] = (accum + add_shift_HP) >> shift_HP;
-
-        accum = 0;
-        accum += (int32_t)filter_hi[0] * s0;
-        accum += (int32_t)filter_hi[1] * s1;
-        accum += (int32_t)filter_hi[2] * s2;
-        accum += (int32_t)filter_hi[3] * s3;
-        dst->band_d[i * dst_stride] = (accum + add_shift_HP) >> shift_HP;
-
-        for (int j = 1; j < (w + 1) / 2; j = j + 16) {
-            {
-                __m256i accum_mu2_lo, accum_mu2_hi, accum_mu1_lo, accum_mu1_hi;
-                accum_mu2_lo = accum_mu2_hi = accum_mu1_lo = accum_mu1_hi =
-                    _mm256_setzero_si256();
-
-                __m256i s00, s11, s22, s33, s44;
-
-                s00 = _mm256_loadu_si256((__m256i *)(tmplo + ind_x[0][j]));
-                s22 = _mm256_loadu_si256((__m256i *)(tmplo + ind_x[2][j]));
-                s33 = _mm256_loadu_si256((__m256i *)(tmplo + 16 + ind_x[0][j]));
-                s44 = _mm256_loadu_si256((__m256i *)(tmplo + 16 + ind_x[2][j]));
-
-                accum_mu2_lo =
-                    _mm256_add_epi32(accum_mu2_lo, _mm256_madd_epi16(s00, fl0));
-                accum_mu2_hi =
-                    _mm256_add_epi32(accum_mu2_hi, _mm256_madd_epi16(s33, fl0));
-                accum_mu2_lo =
-                    _mm256_add_epi32(accum_mu2_lo, _mm256_madd_epi16(s22, fl1));
-                accum_mu2_hi =
-                    _mm256_add_epi32(accum_mu2_hi, _mm256_madd_epi16(s44, fl1));
-
-                accum_mu2_lo = _mm256_add_epi32(accum_mu2_lo, add_shift_HP_vex);
-                accum_mu2_lo = _mm256_srli_epi32(accum_mu2_lo, 0x10);
-                accum_mu2_hi = _mm256_add_epi32(accum_mu2_hi, add_shift_HP_vex);
-                accum_mu2_hi = _mm256_srli_epi32(accum_mu2_hi, 0x10);
-
-                accum_mu2_hi = _mm256_packus_epi32(accum_mu2_lo, accum_mu2_hi);
-                accum_mu2_hi = _mm256_permute4x64_epi64(accum_mu2_hi, 0xD8);
-                _mm256_storeu_si256(
-                    (__m256i *)(dst->band_a + i * dst_stride + j),
-                    accum_mu2_hi);
-
-                accum_mu1_lo =
-                    _mm256_add_epi32(accum_mu1_lo, _mm256_madd_epi16(s00, fh0));
-                accum_mu1_hi =
-                    _mm256_add_epi32(accum_mu1_hi, _mm256_madd_epi16(s33, fh0));
-                accum_mu1_lo =
-                    _mm256_add_epi32(accum_mu1_lo, _mm256_madd_epi16(s22, fh1));
-                accum_mu1_hi =
-                    _mm256_add_epi32(accum_mu1_hi, _mm256_madd_epi16(s44, fh1));
-
-                accum_mu1_lo = _mm256_add_epi32(accum_mu1_lo, add_shift_HP_vex);
-                accum_mu1_lo = _mm256_srli_epi32(accum_mu1_lo, 0x10);
-                accum_mu1_hi = _mm256_add_epi32(accum_mu1_hi, add_shift_HP_vex);
-                accum_mu1_hi = _mm256_srli_epi32(accum_mu1_hi, 0x10);
-
-                accum_mu1_hi = _mm256_packus_epi32(accum_mu1_lo, accum_mu1_hi);
-                accum_mu1_hi = _mm256_permute4x64_epi64(accum_mu1_hi, 0xD8);
-                _mm256_storeu_si256(
-                    (__m256i *)(dst->band_v + i * dst_stride + j),
-                    accum_mu1_hi);
+void adm_decouple_avx2(AdmBuffer *buf, int w, int h, int stride,
+                       double adm_enhn_gain_limit, int row_start,
+                       int row_end)
+{
+    const float cos_1deg_sq = cos(1.0 * M_PI / 180.0) * cos(1.0 * M_PI / 180.0);
+
+    const adm_dwt_band_t *ref = &buf->ref_dwt2;
+    const adm_dwt_band_t *dis = &buf->dis_dwt2;
+    const adm_dwt_band_t *r = &buf->decouple_r;
+    const adm_dwt_band_t *a = &buf->decouple_a;
+    const int32_t *div_lookup = buf->div_lookup;
+
+    int left, top, right, bottom;
+    adm_dwt_border(w, h, &left, &top, &right, &bottom);
+
+    const __m256d cos_pd = _mm256_set1_pd(cos_1deg_sq);
+    const __m256d limit = _mm256_set1_pd(adm_enhn_gain_limit);
+    const __m256i zero = _mm256_setzero_si256();
+
+    const int16_t *o_band[3] = { ref->band_h, ref->band_v, ref->band_d };
+    const int16_t *t_band[3] = { dis->band_h, dis->band_v, dis->band_d };
+    int16_t *r_band[3] = { r->band_h, r->band_v, r->band_d };
+    int16_t *a_band[3] = { a->band_h, a->band_v, a->band_d };
+
+    for (int i = MAX(top, row_start); i < MIN(bottom, row_end); ++i) {
+        for (int j = left; j < right; j += 8) {
+            const int n = right - j;
+            const ptrdiff_t offset = i * stride + j;
+            __m256i o[3], t[3];
+
+            for (int theta = 0; theta < 3; ++theta) {
+                o[theta] = _mm256_cvtepi16_epi32(
+                    loadu_epi16_n(o_band[theta] + offset, n));
+                t[theta] = _mm256_cvtepi16_epi32(
+                    loadu_epi16_n(t_band[theta] + offset, n));
+            }
+
+            __m256d flag[2];
+            for (int half = 0; half < 2; ++half) {
+                const __m256d oh = _mm256_cvtepi32_pd(half ?
+                    _mm256_extracti128_si256(o[0], 1) : _mm256_castsi256_si128(o[0]));
+                const __m256d ov = _mm256_cvtepi32_pd(half ?
+                    _mm256_extracti128_si256(o[1], 1) : _mm256_castsi256_si128(o[1]));
+                const __m256d th = _mm256_cvtepi32_pd(half ?
+                    _mm256_extracti128_si256(t[0], 1) : _mm256_castsi256_si128(t[0]));
+                const __m256d tv = _mm256_cvtepi32_pd(half ?
+                    _mm256_extracti128_si256(t[1], 1) : _mm256_castsi256_si128(t[1]));
+
+                const __m256d ot_dp =
+                    _mm256_add_pd(_mm256_mul_pd(oh, th), _mm256_mul_pd(ov, tv));
+                const __m256d o_mag_sq =
+                    _mm256_add_pd(_mm256_mul_pd(oh, oh), _mm256_mul_pd(ov, ov));
+                const __m256d t_mag_sq =
+                    _mm256_add_pd(_mm256_mul_pd(th, th), _mm256_mul_pd(tv, tv));
+                flag[half] = adm_angle_flag_pd(ot_dp, o_mag_sq, t_mag_sq, cos_pd);
+            }
+            const __m256i angle_flag = mask_pd_epi32(flag[0], flag[1]);
+
+            for (int theta = 0; theta < 3; ++theta) {
+                __m256i k;
+                __m256i rst =
+                    adm_decouple_rst(div_lookup, o[theta], t[theta], &k);
+
+                const __m256i k_pos = _mm256_and_si256(
+                    angle_flag, _mm256_cmpgt_epi32(k, zero));
+                const __m256i pos = _mm256_and_si256(
+                    k_pos, _mm256_cmpgt_epi32(o[theta], zero));
+                const __m256i neg = _mm256_and_si256(
+                    k_pos, _mm256_cmpgt_epi32(zero, o[theta]));
+                rst = adm_gain_limit(rst, t[theta], pos, neg, limit);
+
+                storeu_epi16_n(r_band[theta] + offset, trunc_epi32_epi16(rst), n);
+                storeu_epi16_n(a_band[theta] + offset,
+                    trunc_epi32_epi16(_mm256_sub_epi32(t[theta], rst)), n);
+            }
+        }
+    }
+}
+
+/*
+ * (double)(float)v for int64_t v, rounded once to float like a scalar
+ * conversion. Magnitudes beyond 53 bits have their low bits folded into a
+ * sticky bit first, so the conversion to double is exact.
+ */
+static inline __m256d cvtepi64_ps_pd(__m256i v)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i sign = _mm256_cmpgt_epi64(zero, v);
+    __m256i m = _mm256_sub_epi64(_mm256_xor_si256(v, sign), sign);
+
+    const __m256i low = _mm256_set1_epi64x(0x7ff);
+    const __m256i wide =
+        _mm256_cmpgt_epi64(_mm256_srli_epi64(m, 53), zero);
+    const __m256i sticky = _mm256_andnot_si256(
+        _mm256_cmpeq_epi64(_mm256_and_si256(m, low), zero),
+        _mm256_set1_epi64x(0x800));
+    m = _mm256_blendv_epi8(
+        m, _mm256_or_si256(_mm256_andnot_si256(low, m), sticky), wide);
+
+    const __m256i hi = _mm256_or_si256(_mm256_srli_epi64(m, 32),
+        _mm256_castpd_si256(_mm256_set1_pd(0x1p84)));
+    const __m256i lo = _mm256_or_si256(
+        _mm256_blend_epi32(m, zero, 0xAA),
+        _mm256_castpd_si256(_mm256_set1_pd(0x1p52)));
+    __m256d d = _mm256_sub_pd(_mm256_castsi256_pd(hi),
+                              _mm256_set1_pd(0x1p84 + 0x1p52));
+    d = _mm256_add_pd(d, _mm256_castsi256_pd(lo));
+
+    d = _mm256_cvtps_pd(_mm256_cvtpd_ps(d));
+    return _mm256_xor_pd(d, _mm256_and_pd(_mm256_castsi256_pd(sign),
+                                          _mm256_set1_pd(-0.0)));
+}
+
+/*
+ * k and rst of adm_decouple_s123() for one orientation, see
+ * get_best15_from32() for the reduction of |o| to 15 bits.
+ */
+static inline __m256i adm_decouple_s123_rst(const int32_t *div_lookup,
+                                            __m256i o, __m256i t, __m256i *k)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi32(1);
+
+    const __m256i abs_o = _mm256_abs_epi32(o);
+    const __m256i small = _mm256_cmpeq_epi32(
+        _mm256_min_epu32(abs_o, _mm256_set1_epi32(32767)), abs_o);
+
+    // 17 - clz(|o|), from the exponent of |o| >> 8 which converts exactly
+    const __m256i expo = _mm256_srli_epi32(_mm256_castps_si256(
+        _mm256_cvtepi32_ps(_mm256_srli_epi32(abs_o, 8))), 23);
+    __m256i shift = _mm256_sub_epi32(expo, _mm256_set1_epi32(133));
+    shift = _mm256_andnot_si256(small, shift);
+    const __m256i rnd = _mm256_sllv_epi32(one, _mm256_sub_epi32(shift, one));
+    const __m256i msb = _mm256_blendv_epi8(
+        _mm256_srlv_epi32(_mm256_add_epi32(abs_o, rnd), shift), abs_o, small);
+
+    const __m256i div = _mm256_i32gather_epi32(
+        div_lookup, _mm256_add_epi32(msb, _mm256_set1_epi32(32768)), 4);
+
+    const __m256i sign = _mm256_cmpgt_epi32(zero, o);
+    const __m256i sign_even = _mm256_shuffle_epi32(sign, 0xA0);
+    const __m256i sign_odd = _mm256_shuffle_epi32(sign, 0xF5);
+
+    // (1 << (14 + shift)) is an int, sign extended to int64_t
+    const __m256i round =
+        _mm256_sllv_epi32(one, _mm256_add_epi32(shift, _mm256_set1_epi32(14)));
+    const __m256i round_even = _mm256_mul_epi32(round, one);
+    const __m256i round_odd =
+        _mm256_mul_epi32(_mm256_srli_epi64(round, 32), one);
+
+    const __m256i shr = _mm256_add_epi32(shift, _mm256_set1_epi32(15));
+    const __m256i shr_even = _mm256_blend_epi32(shr, zero, 0xAA);
+    const __m256i shr_odd = _mm256_srli_epi64(shr, 32);
+
+    __m256i p_even = _mm256_mul_epi32(div, t);
+    __m256i p_odd =
+        _mm256_mul_epi32(_mm256_srli_epi64(div, 32), _mm256_srli_epi64(t, 32));
+    p_even = _mm256_sub_epi64(_mm256_xor_si256(p_even, sign_even), sign_even);
+    p_odd = _mm256_sub_epi64(_mm256_xor_si256(p_odd, sign_odd), sign_odd);
+    const __m256i q_even = _mm256_add_epi64(p_even, round_even);
+    const __m256i q_odd = _mm256_add_epi64(p_odd, round_odd);
+
+    // clamped to [0, 32768], a logical shift is exact for q >= 0
+    const __m256i k_max = _mm256_set1_epi64x(32768);
+    __m256i k_even = _mm256_srlv_epi64(q_even, shr_even);
+    __m256i k_odd = _mm256_srlv_epi64(q_odd, shr_odd);
+    k_even = _mm256_blendv_epi8(k_even, k_max,
+                                _mm256_cmpgt_epi64(k_even, k_max));
+    k_odd = _mm256_blendv_epi8(k_odd, k_max, _mm256_cmpgt_epi64(k_odd, k_max));
+    k_even = _mm256_andnot_si256(_mm256_cmpgt_epi64(zero, q_even), k_even);
+    k_odd = _mm256_andnot_si256(_mm256_cmpgt_epi64(zero, q_odd), k_odd);
+
+    __m256i kk = merge_epi64_lo(k_even, k_odd);
+    kk = _mm256_blendv_epi8(kk, _mm256_set1_epi32(32768),
+                            _mm256_cmpeq_epi32(o, zero));
+    *k = kk;
+
+    const __m256i add = _mm256_set1_epi64x(16384);
+    const __m256i rst_even =
+        _mm256_srli_epi64(_mm256_add_epi64(_mm256_mul_epi32(kk, o), add), 15);
+    const __m256i rst_odd = _mm256_srli_epi64(
+        _mm256_add_epi64(_mm256_mul_epi32(_mm256_srli_epi64(kk, 32),
+                                          _mm256_srli_epi64(o, 32)), add), 15);
+    return merge_epi64_lo(rst_even, rst_odd);
+}
+
+void adm_decouple_s123_avx2(AdmBuffer *buf, int w, int h, int stride,
+                            double adm_enhn_gain_limit, int row_start,
+                            int row_end)
+{
+    const float cos_1deg_sq = cos(1.0 * M_PI / 180.0) * cos(1.0 * M_PI / 180.0);
+
+    const i4_adm_dwt_band_t *ref = &buf->i4_ref_dwt2;
+    const i4_adm_dwt_band_t *dis = &buf->i4_dis_dwt2;
+    const i4_adm_dwt_band_t *r = &buf->i4_decouple_r;
+    const i4_adm_dwt_band_t *a = &buf->i4_decouple_a;
+    const int32_t *div_lookup = buf->div_lookup;
+
+    int left, top, right, bottom;
+    adm_dwt_border(w, h, &left, &top, &right, &bottom);
+
+    const __m256d cos_pd = _mm256_set1_pd(cos_1deg_sq);
+    const __m256d limit = _mm256_set1_pd(adm_enhn_gain_limit);
+    const __m256i zero = _mm256_setzero_si256();
+
+    const int32_t *o_band[3] = { ref->band_h, ref->band_v, ref->band_d };
+    const int32_t *t_band[3] = { dis->band_h, dis->band_v, dis->band_d };
+    int32_t *r_band[3] = { r->band_h, r->band_v, r->band_d };
+    int32_t *a_band[3] = { a->band_h, a->band_v, a->band_d };
+
+    for (int i = MAX(top, row_start); i < MIN(bottom, row_end); ++i) {
+        for (int j = left; j < right; j += 8) {
+            const __m256i mask = tail_mask_epi32(right - j);
+            const ptrdiff_t offset = i * stride + j;
+            __m256i o[3], t[3];
+
+            for (int theta = 0; theta < 3; ++theta) {
+                o[theta] = _mm256_maskload_epi32(o_band[theta] + offset, mask);
+                t[theta] = _mm256_maskload_epi32(t_band[theta] + offset, mask);
+            }
+
+            __m256d flag[2];
+            for (int odd = 0; odd < 2; ++odd) {
+                const __m256i oh = odd ? _mm256_srli_epi64(o[0], 32) : o[0];
+                const __m256i ov = odd ? _mm256_srli_epi64(o[1], 32) : o[1];
+                const __m256i th = odd ? _mm256_srli_epi64(t[0], 32) : t[0];
+                const __m256i tv = odd ? _mm256_srli_epi64(t[1], 32) : t[1];
+
+                const __m256i ot_dp = _mm256_add_epi64(
+                    _mm256_mul_epi32(oh, th), _mm256_mul_epi32(ov, tv));
+                const __m256i o_mag_sq = _mm256_add_epi64(
+                    _mm256_mul_epi32(oh, oh), _mm256_mul_epi32(ov, ov));
+                const __m256i t_mag_sq = _mm256_add_epi64(
+                    _mm256_mul_epi32(th, th), _mm256_mul_epi32(tv, tv));
+                flag[odd] = adm_angle_flag_pd(cvtepi64_ps_pd(ot_dp),
+                                              cvtepi64_ps_pd(o_mag_sq),
+                                              cvtepi64_ps_pd(t_mag_sq), cos_pd);
+            }
+            const __m256i angle_flag =
+                _mm256_blend_epi32(_mm256_castpd_si256(flag[0]),
+                                   _mm256_castpd_si256(flag[1]), 0xAA);
+
+            for (int theta = 0; theta < 3; ++theta) {
+                __m256i k;
+                __m256i rst = adm_decouple_s123_rst(div_lookup, o[theta],
+                                                     t[theta], &k);
+
+                const __m256i k_pos = _mm256_and_si256(
+                    angle_flag, _mm256_cmpgt_epi32(k, zero));
+                const __m256i pos = _mm256_and_si256(
+                    k_pos, _mm256_cmpgt_epi32(o[theta], zero));
+                const __m256i neg = _mm256_and_si256(
+                    k_pos, _mm256_cmpgt_epi32(zero, o[theta]));
+                rst = adm_gain_limit(rst, t[theta], pos, neg, limit);
+
+                _mm256_maskstore_epi32(r_band[theta] + offset, mask, rst);
+                _mm256_maskstore_epi32(a_band[theta] + offset, mask,
+                                       _mm256_sub_epi32(t[theta], rst));
             }
+        }
+    }
+}
+
+void adm_csf_avx2(AdmBuffer *buf, int w, int h, int stride, int row_start,
+                  int row_end)
+{
+    const adm_dwt_band_t *src = &buf->decouple_a;
+    const adm_dwt_band_t *dst = &buf->csf_a;
+    const adm_dwt_band_t *flt = &buf->csf_f;
+
+    const int16_t *src_angles[3] = { src->band_h, src->band_v, src->band_d };
+    int16_t *dst_angles[3] = { dst->band_h, dst->band_v, dst->band_d };
+    int16_t *flt_angles[3] = { flt->band_h, flt->band_v, flt->band_d };
+
+    // see adm_csf() for the fixed-point format of these
+    const uint16_t i_rfactor[3] = { 36453, 36453, 49417 };
+    const uint8_t i_shifts[3] = { 15, 15, 17 };
+    const uint16_t i_shiftsadd[3] = { 16384, 16384, 65535 };
+    const uint16_t FIX_ONE_BY_30 = 4369; //(1/30)*2^17
+
+    int left, top, right, bottom;
+    adm_dwt_border(w, h, &left, &top, &right, &bottom);
+
+    const __m256i one_by_30 = _mm256_set1_epi32(FIX_ONE_BY_30);
+    const __m256i add_flt = _mm256_set1_epi32(2048);
+
+    for (int theta = 0; theta < 3; ++theta) {
+        const int16_t *src_ptr = src_angles[theta];
+        int16_t *dst_ptr = dst_angles[theta];
+        int16_t *flt_ptr = flt_angles[theta];
+
+        const __m256i rfactor = _mm256_set1_epi32(i_rfactor[theta]);
+        const __m256i add = _mm256_set1_epi32(i_shiftsadd[theta]);
+        const __m128i shift = _mm_cvtsi32_si128(i_shifts[theta]);
+
+        for (int i = MAX(top, row_start); i < MIN(bottom, row_end); ++i) {
+            const ptrdiff_t offset = i * stride;
+
+            for (int j = left; j < right; j += 8) {
+                const int n = right - j;
+                const __m256i s = _mm256_cvtepi16_epi32(
+                    loadu_epi16_n(src_ptr + offset + j, n));
+
+                __m256i d = _mm256_mullo_epi32(s, rfactor);
+                d = _mm256_sra_epi32(_mm256_add_epi32(d, add), shift);
+                // as int16_t
+                d = _mm256_srai_epi32(_mm256_slli_epi32(d, 16), 16);
+
+                __m256i f = _mm256_mullo_epi32(_mm256_abs_epi32(d), one_by_30);
+                f = _mm256_srai_epi32(_mm256_add_epi32(f, add_flt), 12);
+
+                storeu_epi16_n(dst_ptr + offset + j, trunc_epi32_epi16(d), n);
+                storeu_epi16_n(flt_ptr + offset + j, trunc_epi32_epi16(f), n);
+            }
+        }
+    }
+}
+
+/* (int32_t)((rfactor * (int64_t)x + add) >> 28) with rfactor a uint32_t. */
+static inline __m256i i4_mul_rfactor(__m256i x, __m256i rfactor, bool rf_high,
+                                     __m256i add)
+{
+    const __m256i x_odd = _mm256_srli_epi64(x, 32);
+    __m256i even = _mm256_mul_epi32(x, rfactor);
+    __m256i odd = _mm256_mul_epi32(x_odd, rfactor);
+    if (rf_high) {
+        // mul_epi32 took rfactor as rfactor - 2^32
+        even = _mm256_add_epi64(even, _mm256_slli_epi64(x, 32));
+        odd = _mm256_add_epi64(odd, _mm256_slli_epi64(x_odd, 32));
+    }
+    even = _mm256_srli_epi64(_mm256_add_epi64(even, add), 28);
+    odd = _mm256_slli_epi64(_mm256_add_epi64(odd, add), 4);
+    return _mm256_blend_epi32(even, odd, 0xAA);
+}
+
+/* (int32_t)(((int64_t)mul * abs(x) + add) >> 32) */
+static inline __m256i i4_mul_abs_hi(__m256i x, __m256i mul, __m256i add)
+{
+    const __m256i abs_x = _mm256_abs_epi32(x);
+    const __m256i even = _mm256_add_epi64(_mm256_mul_epi32(abs_x, mul), add);
+    const __m256i odd = _mm256_add_epi64(
+        _mm256_mul_epi32(_mm256_srli_epi64(abs_x, 32), mul), add);
+    return _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+}
+
+void i4_adm_csf_avx2(AdmBuffer *buf, int scale, int w, int h, int stride,
+                     int row_start, int row_end)
+{
+    const i4_adm_dwt_band_t *src = &buf->i4_decouple_a;
+    const i4_adm_dwt_band_t *dst = &buf->i4_csf_a;
+    const i4_adm_dwt_band_t *flt = &buf->i4_csf_f;
+
+    const int32_t *src_angles[3] = { src->band_h, src->band_v, src->band_d };
+    int32_t *dst_angles[3] = { dst->band_h, dst->band_v, dst->band_d };
+    int32_t *flt_angles[3] = { flt->band_h, flt->band_v, flt->band_d };
+
+    const float factor1 = dwt_quant_step(&dwt_7_9_YCbCr_threshold[0], scale, 1);
+    const float factor2 = dwt_quant_step(&dwt_7_9_YCbCr_threshold[0], scale, 2);
+    const float rfactor1[3] = { 1.0f / factor1, 1.0f / factor1, 1.0f / factor2 };
+
+    const double pow2_32 = pow(2, 32);
+    const uint32_t i_rfactor[3] = { (uint32_t)(rfactor1[0] * pow2_32),
+                                    (uint32_t)(rfactor1[1] * pow2_32),
+                                    (uint32_t)(rfactor1[2] * pow2_32) };
+
+    const uint32_t FIX_ONE_BY_30 = 143165577;
+    const int32_t shift_flt = 32;
+    const int32_t add_bef_shift_dst = (int32_t)(1 << (28 - 1));
+    const int32_t add_bef_shift_flt = (int32_t)(1 << (shift_flt - 1));
+
+    int left, top, right, bottom;
+    adm_dwt_border(w, h, &left, &top, &right, &bottom);
+
+    const __m256i add_dst = _mm256_set1_epi64x(add_bef_shift_dst);
+    const __m256i add_flt = _mm256_set1_epi64x(add_bef_shift_flt);
+    const __m256i one_by_30 = _mm256_set1_epi32(FIX_ONE_BY_30);
+
+    for (int theta = 0; theta < 3; ++theta) {
+        const int32_t *src_ptr = src_angles[theta];
+        int32_t *dst_ptr = dst_angles[theta];
+        int32_t *flt_ptr = flt_angles[theta];
 
-            {
-                __m256i accum_mu2_lo, accum_mu2_hi, accum_mu1_lo, accum_mu1_hi;
-                accum_mu2_lo = accum_mu2_hi = accum_mu1_lo = accum_mu1_hi =
-                    _mm256_setzero_si256();
-
-                __m256i s00, s11, s22, s33, s44;
-                __m256i add_shift_HP_vex = _mm256_set1_epi32(32768);
-
-                s00 = _mm256_loadu_si256((__m256i *)(tmphi + ind_x[0][j]));
-                s22 = _mm256_loadu_si256((__m256i *)(tmphi + ind_x[2][j]));
-                s33 = _mm256_loadu_si256((__m256i *)(tmphi + 16 + ind_x[0][j]));
-                s44 = _mm256_loadu_si256((__m256i *)(tmphi + 16 + ind_x[2][j]));
-
-                accum_mu2_lo =
-                    _mm256_add_epi32(accum_mu2_lo, _mm256_madd_epi16(s00, fl0));
-                accum_mu2_hi =
-                    _mm256_add_epi32(accum_mu2_hi, _mm256_madd_epi16(s33, fl0));
-                accum_mu2_lo =
-                    _mm256_add_epi32(accum_mu2_lo, _mm256_madd_epi16(s22, fl1));
-                accum_mu2_hi =
-                    _mm256_add_epi32(accum_mu2_hi, _mm256_madd_epi16(s44, fl1));
-
-                accum_mu2_lo = _mm256_add_epi32(accum_mu2_lo, add_shift_HP_vex);
-                accum_mu2_lo = _mm256_srli_epi32(accum_mu2_lo, 0x10);
-                accum_mu2_hi = _mm256_add_epi32(accum_mu2_hi, add_shift_HP_vex);
-                accum_mu2_hi = _mm256_srli_epi32(accum_mu2_hi, 0x10);
-
-                accum_mu2_hi = _mm256_packus_epi32(accum_mu2_lo, accum_mu2_hi);
-                accum_mu2_hi = _mm256_permute4x64_epi64(accum_mu2_hi, 0xD8);
-                _mm256_storeu_si256(
-                    (__m256i *)(dst->band_h + i * dst_stride + j),
-                    accum_mu2_hi);
-
-                accum_mu1_lo =
-                    _mm256_add_epi32(accum_mu1_lo, _mm256_madd_epi16(s00, fh0));
-                accum_mu1_hi =
-                    _mm256_add_epi32(accum_mu1_hi, _mm256_madd_epi16(s33, fh0));
-                accum_mu1_lo =
-                    _mm256_add_epi32(accum_mu1_lo, _mm256_madd_epi16(s22, fh1));
-                accum_mu1_hi =
-                    _mm256_add_epi32(accum_mu1_hi, _mm256_madd_epi16(s44, fh1));
-
-                accum_mu1_lo = _mm256_add_epi32(accum_mu1_lo, add_shift_HP_vex);
-                accum_mu1_lo = _mm256_srli_epi32(accum_mu1_lo, 0x10);
-                accum_mu1_hi = _mm256_add_epi32(accum_mu1_hi, add_shift_HP_vex);
-                accum_mu1_hi = _mm256_srli_epi32(accum_mu1_hi, 0x10);
-
-                accum_mu1_hi = _mm256_packus_epi32(accum_mu1_lo, accum_mu1_hi);
-                accum_mu1_hi = _mm256_permute4x64_epi64(accum_mu1_hi, 0xD8);
-                _mm256_storeu_si256(
-                    (__m256i *)(dst->band_d + i * dst_stride + j),
-                    accum_mu1_hi);
+        const __m256i rfactor = _mm256_set1_epi32(i_rfactor[theta]);
+        const bool rf_high = i_rfactor[theta] >> 31;
+
+        for (int i = MAX(top, row_start); i < MIN(bottom, row_end); ++i) {
+            const ptrdiff_t offset = i * stride;
+
+            for (int j = left; j < right; j += 8) {
+                const __m256i mask = tail_mask_epi32(right - j);
+                const __m256i s =
+                    _mm256_maskload_epi32(src_ptr + offset + j, mask);
+
+                const __m256i d = i4_mul_rfactor(s, rfactor, rf_high, add_dst);
+                const __m256i f = i4_mul_abs_hi(d, one_by_30, add_flt);
+
+                _mm256_maskstore_epi32(dst_ptr + offset + j, mask, d);
+                _mm256_maskstore_epi32(flt_ptr + offset + j, mask, f);
             }
         }
     }
 }
+
+/*
+ * Contrast masking. Both adm_cm() and i4_adm_cm() visit the same pixels: the
+ * first and last row only when they lie in the band and within the border,
+ * with their missing neighbours mirrored as rows 1, 0, 1 and h - 2, h - 1,
+ * h - 1, and columns 0 and w - 1 likewise. The sum of every row is rounded
+ * into the accumulators on its own, so the kernels below go row by row and
+ * leave the mirrored columns to a scalar helper.
+ */
+typedef struct AdmCmParams {
+    int w, h;
+    int src_stride, csf_a_stride;
+    int left, right, start_col, end_col;
+    const void *src[3];
+    const void *angles[3];
+    const void *flt_angles[3];
+    uint32_t rfactor[3];
+    int32_t shift_sub[3];
+    int32_t add_shift_sq[3], shift_sq[3];
+    uint32_t add_shift_cub[3], shift_cub[3];
+    int32_t add_bef_shift_dst, add_bef_shift_flt;
+} AdmCmParams;
+
+static inline void adm_cm_accum(int32_t x, int32_t thr, const AdmCmParams *p,
+                                int theta, int64_t *accum_inner)
+{
+    x = abs(x) - ((int32_t)(thr) << p->shift_sub[theta]);
+    x = x < 0 ? 0 : x;
+    const int32_t x_sq = (int32_t)((((int64_t)x * x) + p->add_shift_sq[theta])
+                                   >> p->shift_sq[theta]);
+    accum_inner[theta] += (((int64_t)x_sq * x) + p->add_shift_cub[theta])
+                          >> p->shift_cub[theta];
+}
+
+static inline void i4_adm_cm_accum(int32_t x, int32_t thr,
+                                   const AdmCmParams *p, int theta,
+                                   int64_t *accum_inner)
+{
+    x = abs(x) - (thr >> p->shift_sub[theta]);
+    x = x < 0 ? 0 : x;
+    const int32_t x_sq = (int32_t)((((int64_t)x * x) + p->add_shift_sq[theta])
+                                   >> p->shift_sq[theta]);
+    accum_inner[theta] += (((int64_t)x_sq * x) + p->add_shift_cub[theta])
+                          >> p->shift_cub[theta];
+}
+
+/* Pixel (i, j) with neighbour rows ia, ib and columns ja, jb. */
+static void adm_cm_pixel(const AdmCmParams *p, int i, int ia, int ib, int j,
+                         int ja, int jb, int64_t *accum_inner)
+{
+    const int cs = p->csf_a_stride;
+    int32_t thr = 0;
+
+    for (int theta = 0; theta < 3; ++theta) {
+        const int16_t *src_ptr = p->angles[theta];
+        const int16_t *flt_ptr = p->flt_angles[theta];
+        int32_t sum = 0;
+        sum += flt_ptr[ia * cs + ja];
+        sum += flt_ptr[ia * cs + j];
+        sum += flt_ptr[ia * cs + jb];
+        sum += flt_ptr[i * cs + ja];
+        sum += (int16_t)(((ONE_BY_15 * abs((int32_t)src_ptr[i * cs + j])) + 2048) >> 12);
+        sum += flt_ptr[i * cs + jb];
+        sum += flt_ptr[ib * cs + ja];
+        sum += flt_ptr[ib * cs + j];
+        sum += flt_ptr[ib * cs + jb];
+        thr += sum;
+    }
+
+    for (int theta = 0; theta < 3; ++theta) {
+        const int16_t *src = p->src[theta];
+        const int32_t x = src[i * p->src_stride + j] * (int32_t)p->rfactor[theta];
+        adm_cm_accum(x, thr, p, theta, accum_inner);
+    }
+}
+
+static void i4_adm_cm_pixel(const AdmCmParams *p, int i, int ia, int ib, int j,
+                            int ja, int jb, int64_t *accum_inner)
+{
+    const int cs = p->csf_a_stride;
+    int32_t thr = 0;
+
+    for (int theta = 0; theta < 3; ++theta) {
+        const int32_t *src_ptr = p->angles[theta];
+        const int32_t *flt_ptr = p->flt_angles[theta];
+        int32_t sum = 0;
+        sum += flt_ptr[ia * cs + ja];
+        sum += flt_ptr[ia * cs + j];
+        sum += flt_ptr[ia * cs + jb];
+        sum += flt_ptr[i * cs + ja];
+        sum += (int32_t)((((int64_t)I4_ONE_BY_15 * abs(src_ptr[i * cs + j])) +
+                          p->add_bef_shift_flt) >> 32);
+        sum += flt_ptr[i * cs + jb];
+        sum += flt_ptr[ib * cs + ja];
+        sum += flt_ptr[ib * cs + j];
+        sum += flt_ptr[ib * cs + jb];
+        thr += sum;
+    }
+
+    for (int theta = 0; theta < 3; ++theta) {
+        const int32_t *src = p->src[theta];
+        const int32_t x = (int32_t)((((int64_t)src[i * p->src_stride + j] *
+                                      p->rfactor[theta]) +
+                                     p->add_bef_shift_dst) >> 28);
+        i4_adm_cm_accum(x, thr, p, theta, accum_inner);
+    }
+}
+
+/*
+ * Adds the cubes of 8 lanes of x reduced by thr_sub to two 4 x int64_t sums,
+ * thr_sub being thr shifted as the C code does.
+ */
+static inline void adm_cm_accum_8(__m256i x, __m256i thr_sub,
+                                  const AdmCmParams *p, int theta,
+                                  __m256i *accum)
+{
+    const __m256i add_sq = _mm256_set1_epi64x(p->add_shift_sq[theta]);
+    const __m256i add_cub = _mm256_set1_epi64x(p->add_shift_cub[theta]);
+    const __m128i shift_sq = _mm_cvtsi32_si128(p->shift_sq[theta]);
+    const int shift_cub = p->shift_cub[theta] & 63;
+
+    x = _mm256_sub_epi32(_mm256_abs_epi32(x), thr_sub);
+    x = _mm256_max_epi32(x, _mm256_setzero_si256());
+    const __m256i x_odd = _mm256_srli_epi64(x, 32);
+
+    // x_sq is the low 32 bits of the shifted square
+    const __m256i sq_even = _mm256_srl_epi64(
+        _mm256_add_epi64(_mm256_mul_epu32(x, x), add_sq), shift_sq);
+    const __m256i sq_odd = _mm256_srl_epi64(
+        _mm256_add_epi64(_mm256_mul_epu32(x_odd, x_odd), add_sq), shift_sq);
+
+    const __m256i val_even = srai_epi64(
+        _mm256_add_epi64(_mm256_mul_epi32(sq_even, x), add_cub), shift_cub);
+    const __m256i val_odd = srai_epi64(
+        _mm256_add_epi64(_mm256_mul_epi32(sq_odd, x_odd), add_cub), shift_cub);
+    *accum = _mm256_add_epi64(*accum, _mm256_add_epi64(val_even, val_odd));
+}
+
+static inline __m256i load_epi16_epi32(const int16_t *p)
+{
+    return _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)p));
+}
+
+static void adm_cm_row(const AdmCmParams *p, int i, int ia, int ib,
+                       int64_t *accum_inner)
+{
+    const int cs = p->csf_a_stride;
+    const __m256i one_by_15 = _mm256_set1_epi32(ONE_BY_15);
+    const __m256i add_thr = _mm256_set1_epi32(2048);
+    __m256i accum[3] = {
+        _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256()
+    };
+
+    if (p->left <= 0)
+        adm_cm_pixel(p, i, ia, ib, 0, 1, 1, accum_inner);
+
+    int j = p->start_col;
+    for (; j + 8 <= p->end_col; j += 8) {
+        __m256i thr = _mm256_setzero_si256();
+        for (int theta = 0; theta < 3; ++theta) {
+            const int16_t *src_ptr = p->angles[theta];
+            const int16_t *flt_a = (const int16_t *)p->flt_angles[theta] + ia * cs + j;
+            const int16_t *flt_i = (const int16_t *)p->flt_angles[theta] + i * cs + j;
+            const int16_t *flt_b = (const int16_t *)p->flt_angles[theta] + ib * cs + j;
+
+            __m256i sum = _mm256_add_epi32(load_epi16_epi32(flt_a - 1),
+                                           load_epi16_epi32(flt_a));
+            sum = _mm256_add_epi32(sum, load_epi16_epi32(flt_a + 1));
+            sum = _mm256_add_epi32(sum, load_epi16_epi32(flt_i - 1));
+            sum = _mm256_add_epi32(sum, load_epi16_epi32(flt_i + 1));
+            sum = _mm256_add_epi32(sum, load_epi16_epi32(flt_b - 1));
+            sum = _mm256_add_epi32(sum, load_epi16_epi32(flt_b));
+            sum = _mm256_add_epi32(sum, load_epi16_epi32(flt_b + 1));
+
+            __m256i c = _mm256_abs_epi32(load_epi16_epi32(src_ptr + i * cs + j));
+            c = _mm256_add_epi32(_mm256_mullo_epi32(c, one_by_15), add_thr);
+            c = _mm256_srai_epi32(c, 12);
+            c = _mm256_srai_epi32(_mm256_slli_epi32(c, 16), 16);
+            thr = _mm256_add_epi32(thr, _mm256_add_epi32(sum, c));
+        }
+
+        for (int theta = 0; theta < 3; ++theta) {
+            const int16_t *src = p->src[theta];
+            const __m256i x = _mm256_mullo_epi32(
+                load_epi16_epi32(src + i * p->src_stride + j),
+                _mm256_set1_epi32(p->rfactor[theta]));
+            const __m256i thr_sub = _mm256_sll_epi32(
+                thr, _mm_cvtsi32_si128(p->shift_sub[theta]));
+            adm_cm_accum_8(x, thr_sub, p, theta, &accum[theta]);
+        }
+    }
+    for (; j < p->end_col; ++j)
+        adm_cm_pixel(p, i, ia, ib, j, j - 1, j + 1, accum_inner);
+
+    if (p->right > (p->w - 1))
+        adm_cm_pixel(p, i, ia, ib, p->w - 1, p->w - 2, p->w - 1, accum_inner);
+
+    for (int theta = 0; theta < 3; ++theta)
+        accum_inner[theta] += hsum_epi64(accum[theta]);
+}
+
+static void i4_adm_cm_row(const AdmCmParams *p, int i, int ia, int ib,
+                          int64_t *accum_inner)
+{
+    const int cs = p->csf_a_stride;
+    const __m256i one_by_15 = _mm256_set1_epi32(I4_ONE_BY_15);
+    const __m256i add_thr = _mm256_set1_epi64x(p->add_bef_shift_flt);
+    const __m256i add_dst = _mm256_set1_epi64x(p->add_bef_shift_dst);
+    __m256i accum[3] = {
+        _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256()
+    };
+
+    if (p->left <= 0)
+        i4_adm_cm_pixel(p, i, ia, ib, 0, 1, 1, accum_inner);
+
+    int j = p->start_col;
+    for (; j + 8 <= p->end_col; j += 8) {
+        __m256i thr = _mm256_setzero_si256();
+        for (int theta = 0; theta < 3; ++theta) {
+            const int32_t *src_ptr = p->angles[theta];
+            const int32_t *flt_a = (const int32_t *)p->flt_angles[theta] + ia * cs + j;
+            const int32_t *flt_i = (const int32_t *)p->flt_angles[theta] + i * cs + j;
+            const int32_t *flt_b = (const int32_t *)p->flt_angles[theta] + ib * cs + j;
+
+            __m256i sum = _mm256_add_epi32(
+                _mm256_loadu_si256((const __m256i *)(flt_a - 1)),
+                _mm256_loadu_si256((const __m256i *)flt_a));
+            sum = _mm256_add_epi32(sum, _mm256_loadu_si256((const __m256i *)(flt_a + 1)));
+            sum = _mm256_add_epi32(sum, _mm256_loadu_si256((const __m256i *)(flt_i - 1)));
+            sum = _mm256_add_epi32(sum, _mm256_loadu_si256((const __m256i *)(flt_i + 1)));
+            sum = _mm256_add_epi32(sum, _mm256_loadu_si256((const __m256i *)(flt_b - 1)));
+            sum = _mm256_add_epi32(sum, _mm256_loadu_si256((const __m256i *)flt_b));
+            sum = _mm256_add_epi32(sum, _mm256_loadu_si256((const __m256i *)(flt_b + 1)));
+
+            const __m256i c = i4_mul_abs_hi(
+                _mm256_loadu_si256((const __m256i *)(src_ptr + i * cs + j)),
+                one_by_15, add_thr);
+            thr = _mm256_add_epi32(thr, _mm256_add_epi32(sum, c));
+        }
+
+        for (int theta = 0; theta < 3; ++theta) {
+            const int32_t *src = p->src[theta];
+            const __m256i x = i4_mul_rfactor(
+                _mm256_loadu_si256((const __m256i *)(src + i * p->src_stride + j)),
+                _mm256_set1_epi32(p->rfactor[theta]), p->rfactor[theta] >> 31,
+                add_dst);
+            const __m256i thr_sub = _mm256_sra_epi32(
+                thr, _mm_cvtsi32_si128(p->shift_sub[theta]));
+            adm_cm_accum_8(x, thr_sub, p, theta, &accum[theta]);
+        }
+    }
+    for (; j < p->end_col; ++j)
+        i4_adm_cm_pixel(p, i, ia, ib, j, j - 1, j + 1, accum_inner);
+
+    if (p->right > (p->w - 1))
+        i4_adm_cm_pixel(p, i, ia, ib, p->w - 1, p->w - 2, p->w - 1, accum_inner);
+
+    for (int theta = 0; theta < 3; ++theta)
+        accum_inner[theta] += hsum_epi64(accum[theta]);
+}
+
+static void adm_cm_rows(const AdmCmParams *p, int row_start, int row_end,
+                        void (*row)(const AdmCmParams *p, int i, int ia,
+                                    int ib, int64_t *accum_inner),
+                        int64_t *accum)
+{
+    const int h = p->h;
+
+    const uint32_t shift_inner_accum = (uint32_t)ceil(log2(h));
+    const uint32_t add_shift_inner_accum = (uint32_t)pow(2, (shift_inner_accum - 1));
+
+    const int top = h * ADM_BORDER_FACTOR - 0.5;
+    const int bottom = h - top;
+    const int start_row = MAX((top > 1) ? top : 1, row_start);
+    const int end_row = MIN((bottom < (h - 1)) ? bottom : (h - 1), row_end);
+
+    int64_t accum_out[3] = { 0 };
+    int64_t accum_inner[3];
+
+    memset(accum_inner, 0, sizeof(accum_inner));
+    if ((row_start == 0) && (top <= 0))
+        row(p, 0, 1, 1, accum_inner);
+    for (int theta = 0; theta < 3; ++theta)
+        accum_out[theta] += (accum_inner[theta] + add_shift_inner_accum) >> shift_inner_accum;
+
+    for (int i = start_row; i < end_row; ++i) {
+        memset(accum_inner, 0, sizeof(accum_inner));
+        row(p, i, i - 1, i + 1, accum_inner);
+        for (int theta = 0; theta < 3; ++theta)
+            accum_out[theta] += (accum_inner[theta] + add_shift_inner_accum) >> shift_inner_accum;
+    }
+
+    memset(accum_inner, 0, sizeof(accum_inner));
+    if ((row_end == h) && (bottom > (h - 1)))
+        row(p, h - 1, h - 2, h - 1, accum_inner);
+    for (int theta = 0; theta < 3; ++theta)
+        accum_out[theta] += (accum_inner[theta] + add_shift_inner_accum) >> shift_inner_accum;
+
+    for (int theta = 0; theta < 3; ++theta)
+        accum[theta] += accum_out[theta];
+}
+
+static void adm_cm_params(AdmCmParams *p, int w, int h, int src_stride,
+                          int csf_a_stride)
+{
+    p->w = w;
+    p->h = h;
+    p->src_stride = src_stride;
+    p->csf_a_stride = csf_a_stride;
+
+    p->left = w * ADM_BORDER_FACTOR - 0.5;
+    p->right = w - p->left;
+    p->start_col = (p->left > 1) ? p->left : 1;
+    p->end_col = (p->right < (w - 1)) ? p->right : (w - 1);
+}
+
+void adm_cm_avx2(AdmBuffer *buf, int w, int h, int src_stride,
+                 int csf_a_stride, int row_start, int row_end,
+                 int64_t *accum)
+{
+    const adm_dwt_band_t *src = &buf->decouple_r;
+    const adm_dwt_band_t *csf_f = &buf->csf_f;
+    const adm_dwt_band_t *csf_a = &buf->csf_a;
+
+    // see adm_cm() for the fixed-point format of these
+    const uint32_t shift_xhcub = (uint32_t)ceil(log2(w) - 4);
+    const uint32_t add_shift_xhcub = (uint32_t)pow(2, (shift_xhcub - 1));
+    const uint32_t shift_xdcub = (uint32_t)ceil(log2(w) - 3);
+    const uint32_t add_shift_xdcub = (uint32_t)pow(2, (shift_xdcub - 1));
+
+    AdmCmParams p = {
+        .src = { src->band_h, src->band_v, src->band_d },
+        .angles = { csf_a->band_h, csf_a->band_v, csf_a->band_d },
+        .flt_angles = { csf_f->band_h, csf_f->band_v, csf_f->band_d },
+        .rfactor = { 36453, 36453, 49417 },
+        .shift_sub = { 10, 10, 12 },
+        .add_shift_sq = { 268435456, 268435456, 536870912 },
+        .shift_sq = { 29, 29, 30 },
+        .add_shift_cub = { add_shift_xhcub, add_shift_xhcub, add_shift_xdcub },
+        .shift_cub = { shift_xhcub, shift_xhcub, shift_xdcub },
+    };
+    adm_cm_params(&p, w, h, src_stride, csf_a_stride);
+
+    adm_cm_rows(&p, row_start, row_end, adm_cm_row, accum);
+}
+
+void i4_adm_cm_avx2(AdmBuffer *buf, int w, int h, int src_stride,
+                    int csf_a_stride, int scale, int row_start, int row_end,
+                    int64_t *accum)
+{
+    const i4_adm_dwt_band_t *src = &buf->i4_decouple_r;
+    const i4_adm_dwt_band_t *csf_f = &buf->i4_csf_f;
+    const i4_adm_dwt_band_t *csf_a = &buf->i4_csf_a;
+
+    // see i4_adm_cm() for the fixed-point format of these
+    float factor1 = dwt_quant_step(&dwt_7_9_YCbCr_threshold[0], scale, 1);
+    float factor2 = dwt_quant_step(&dwt_7_9_YCbCr_threshold[0], scale, 2);
+    float rfactor1[3] = { 1.0f / factor1, 1.0f / factor1, 1.0f / factor2 };
+
+    const int32_t shift_flt = 32;
+    uint32_t shift_cub = (uint32_t)ceil(log2(w));
+    uint32_t add_shift_cub = (uint32_t)pow(2, (shift_cub - 1));
+
+    AdmCmParams p = {
+        .src = { src->band_h, src->band_v, src->band_d },
+        .angles = { csf_a->band_h, csf_a->band_v, csf_a->band_d },
+        .flt_angles = { csf_f->band_h, csf_f->band_v, csf_f->band_d },
+        .rfactor = { (uint32_t)(rfactor1[0] * pow(2, 32)),
+                     (uint32_t)(rfactor1[1] * pow(2, 32)),
+                     (uint32_t)(rfactor1[2] * pow(2, 32)) },
+        .shift_sub = { 0, 0, 0 },
+        .add_shift_sq = { 536870912, 536870912, 536870912 },
+        .shift_sq = { 30, 30, 30 },
+        .add_shift_cub = { add_shift_cub, add_shift_cub, add_shift_cub },
+        .shift_cub = { shift_cub, shift_cub, shift_cub },
+        .add_bef_shift_dst = (int32_t)(1 << (28 - 1)),
+        .add_bef_shift_flt = (int32_t)(1 << (shift_flt - 1)),
+    };
+    adm_cm_params(&p, w, h, src_stride, csf_a_stride);
+
+    adm_cm_rows(&p, row_start, row_end, i4_adm_cm_row, accum);
+}
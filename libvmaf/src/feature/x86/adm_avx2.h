@@ -25,4 +25,35 @@ void adm_dwt2_8_avx2(const uint8_t *src, const adm_dwt_band_t *dst,
                      AdmBuffer *buf, int w, int h, int src_stride,
                      int dst_stride);
 
+void adm_dwt2_16_avx2(const uint16_t *src, const adm_dwt_band_t *dst,
+                      AdmBuffer *buf, int w, int h, int src_stride,
+                      int dst_stride, int inp_size_bits);
+
+void adm_dwt2_s123_combined_avx2(const int32_t *i4_ref_scale,
+                                 const int32_t *i4_curr_dis, AdmBuffer *buf,
+                                 int w, int h, int ref_stride, int dis_stride,
+                                 int dst_stride, int scale);
+
+void adm_decouple_avx2(AdmBuffer *buf, int w, int h, int stride,
+                       double adm_enhn_gain_limit, int row_start,
+                       int row_end);
+
+void adm_decouple_s123_avx2(AdmBuffer *buf, int w, int h, int stride,
+                            double adm_enhn_gain_limit, int row_start,
+                            int row_end);
+
+void adm_csf_avx2(AdmBuffer *buf, int w, int h, int stride, int row_start,
+                  int row_end);
+
+void i4_adm_csf_avx2(AdmBuffer *buf, int scale, int w, int h, int stride,
+                     int row_start, int row_end);
+
+void adm_cm_avx2(AdmBuffer *buf, int w, int h, int src_stride,
+                 int csf_a_stride, int row_start, int row_end,
+                 int64_t *accum);
+
+void i4_adm_cm_avx2(AdmBuffer *buf, int w, int h, int src_stride,
+                    int csf_a_stride, int scale, int row_start, int row_end,
+                    int64_t *accum);
+
 #endif /* X86_AVX2_ADM_H_ */
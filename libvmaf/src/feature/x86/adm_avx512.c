@@ -0,0 +1,1398 @@
+/**
+ *
+ *  Copyright 2016-2020 Netflix, Inc.
+ *
+ *     Licensed under the BSD+Patent License (the "License");
+ *     you may not use this file except in compliance with the License.
+ *     You may obtain a copy of the License at
+ *
+ *         https://opensource.org/licenses/BSDplusPatent
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *
+ */
+
+#include "feature/integer_adm.h"
+
+#include <immintrin.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MIN(x, y) (((x) < (y)) ? (x) : (y))
+#define MAX(x, y) (((x) > (y)) ? (x) : (y))
+
+/*
+ * AVX-512 versions of the kernels in adm_avx2.c, bit-exact with the C code
+ * in integer_adm.c. Row ends are handled with masked loads and stores where
+ * the C code does not mirror its indices.
+ */
+
+static inline __mmask16 tail_mask16(int n)
+{
+    return n >= 16 ? 0xffff : (__mmask16)((1u << n) - 1);
+}
+
+static inline __mmask32 tail_mask32(int n)
+{
+    return n >= 32 ? 0xffffffff : (__mmask32)((1u << n) - 1);
+}
+
+/* a and b in every pair of 16-bit lanes, for madd_epi16 */
+static inline __m512i set1_pair_epi16(int16_t a, int16_t b)
+{
+    return _mm512_set1_epi32((uint16_t)a | ((uint32_t)(uint16_t)b << 16));
+}
+
+/* Vertical pass of one column for 8 to 16-bit input. */
+static inline void adm_dwt2_v_col(uint16_t u_s0, uint16_t u_s1, uint16_t u_s2,
+                                  uint16_t u_s3, int shift_VP,
+                                  int32_t add_shift_VP, int16_t *lo,
+                                  int16_t *hi)
+{
+    const int16_t *filter_lo = dwt2_db2_coeffs_lo;
+    const int16_t *filter_hi = dwt2_db2_coeffs_hi;
+    int32_t accum;
+
+    accum = 0;
+    accum += (int32_t)filter_lo[0] * (int32_t)u_s0;
+    accum += (int32_t)filter_lo[1] * (int32_t)u_s1;
+    accum += (int32_t)filter_lo[2] * (int32_t)u_s2;
+    accum += (int32_t)filter_lo[3] * (int32_t)u_s3;
+    accum -= (int32_t)dwt2_db2_coeffs_lo_sum * add_shift_VP;
+    *lo = (accum + add_shift_VP) >> shift_VP;
+
+    accum = 0;
+    accum += (int32_t)filter_hi[0] * (int32_t)u_s0;
+    accum += (int32_t)filter_hi[1] * (int32_t)u_s1;
+    accum += (int32_t)filter_hi[2] * (int32_t)u_s2;
+    accum += (int32_t)filter_hi[3] * (int32_t)u_s3;
+    accum -= (int32_t)dwt2_db2_coeffs_hi_sum * add_shift_VP;
+    *hi = (accum + add_shift_VP) >> shift_VP;
+}
+
+/* Horizontal pass of one output column, j may be mirrored at either edge. */
+static inline void adm_dwt2_h_col(const int16_t *tmplo, const int16_t *tmphi,
+                                  const adm_dwt_band_t *dst, int **ind_x,
+                                  ptrdiff_t offset, int j)
+{
+    const int16_t *filter_lo = dwt2_db2_coeffs_lo;
+    const int16_t *filter_hi = dwt2_db2_coeffs_hi;
+    const int32_t add_shift_HP = 32768;
+    const int16_t shift_HP = 16;
+    const int j0 = ind_x[0][j];
+    const int j1 = ind_x[1][j];
+    const int j2 = ind_x[2][j];
+    const int j3 = ind_x[3][j];
+    int32_t accum;
+
+    int16_t s0 = tmplo[j0];
+    int16_t s1 = tmplo[j1];
+    int16_t s2 = tmplo[j2];
+    int16_t s3 = tmplo[j3];
+
+    accum = 0;
+    accum += (int32_t)filter_lo[0] * s0;
+    accum += (int32_t)filter_lo[1] * s1;
+    accum += (int32_t)filter_lo[2] * s2;
+    accum += (int32_t)filter_lo[3] * s3;
+    dst->band_a[offset + j] = (accum + add_shift_HP) >> shift_HP;
+
+    accum = 0;
+    accum += (int32_t)filter_hi[0] * s0;
+    accum += (int32_t)filter_hi[1] * s1;
+    accum += (int32_t)filter_hi[2] * s2;
+    accum += (int32_t)filter_hi[3] * s3;
+    dst->band_v[offset + j] = (accum + add_shift_HP) >> shift_HP;
+
+    s0 = tmphi[j0];
+    s1 = tmphi[j1];
+    s2 = tmphi[j2];
+    s3 = tmphi[j3];
+
+    accum = 0;
+    accum += (int32_t)filter_lo[0] * s0;
+    accum += (int32_t)filter_lo[1] * s1;
+    accum += (int32_t)filter_lo[2] * s2;
+    accum += (int32_t)filter_lo[3] * s3;
+    dst->band_h[offset + j] = (accum + add_shift_HP) >> shift_HP;
+
+    accum = 0;
+    accum += (int32_t)filter_hi[0] * s0;
+    accum += (int32_t)filter_hi[1] * s1;
+    accum += (int32_t)filter_hi[2] * s2;
+    accum += (int32_t)filter_hi[3] * s3;
+    dst->band_d[offset + j] = (accum + add_shift_HP) >> shift_HP;
+}
+
+/*
+ * Vertical pass of 32 columns. Samples are biased by -bias to fit
+ * madd_epi16, add_lo and add_hi put back bias * sum(filter) along with the
+ * normalization, wrapping like the int32_t sums of the C code.
+ */
+static inline void adm_dwt2_v_32(__m512i s0, __m512i s1, __m512i s2,
+                                 __m512i s3, int16_t *lo, int16_t *hi,
+                                 __mmask32 mask, __m512i add_lo,
+                                 __m512i add_hi, __m128i shift)
+{
+    const int16_t *filter_lo = dwt2_db2_coeffs_lo;
+    const int16_t *filter_hi = dwt2_db2_coeffs_hi;
+    const __m512i fl0 = set1_pair_epi16(filter_lo[0], filter_lo[1]);
+    const __m512i fl1 = set1_pair_epi16(filter_lo[2], filter_lo[3]);
+    const __m512i fh0 = set1_pair_epi16(filter_hi[0], filter_hi[1]);
+    const __m512i fh1 = set1_pair_epi16(filter_hi[2], filter_hi[3]);
+
+    const __m512i s01lo = _mm512_unpacklo_epi16(s0, s1);
+    const __m512i s01hi = _mm512_unpackhi_epi16(s0, s1);
+    const __m512i s23lo = _mm512_unpacklo_epi16(s2, s3);
+    const __m512i s23hi = _mm512_unpackhi_epi16(s2, s3);
+    const __m512i low16 = _mm512_set1_epi32(0xffff);
+
+    __m512i accum_lo, accum_hi;
+
+    accum_lo = _mm512_add_epi32(_mm512_madd_epi16(s01lo, fl0),
+                                _mm512_madd_epi16(s23lo, fl1));
+    accum_hi = _mm512_add_epi32(_mm512_madd_epi16(s01hi, fl0),
+                                _mm512_madd_epi16(s23hi, fl1));
+    accum_lo = _mm512_sra_epi32(_mm512_add_epi32(accum_lo, add_lo), shift);
+    accum_hi = _mm512_sra_epi32(_mm512_add_epi32(accum_hi, add_lo), shift);
+    _mm512_mask_storeu_epi16(lo, mask,
+        _mm512_packus_epi32(_mm512_and_si512(accum_lo, low16),
+                            _mm512_and_si512(accum_hi, low16)));
+
+    accum_lo = _mm512_add_epi32(_mm512_madd_epi16(s01lo, fh0),
+                                _mm512_madd_epi16(s23lo, fh1));
+    accum_hi = _mm512_add_epi32(_mm512_madd_epi16(s01hi, fh0),
+                                _mm512_madd_epi16(s23hi, fh1));
+    accum_lo = _mm512_sra_epi32(_mm512_add_epi32(accum_lo, add_hi), shift);
+    accum_hi = _mm512_sra_epi32(_mm512_add_epi32(accum_hi, add_hi), shift);
+    _mm512_mask_storeu_epi16(hi, mask,
+        _mm512_packus_epi32(_mm512_and_si512(accum_lo, low16),
+                            _mm512_and_si512(accum_hi, low16)));
+}
+
+/* 32 output columns from j of the lo and hi filters over one tmp row. */
+static inline void adm_dwt2_h_32(const int16_t *tmp, int16_t *lo, int16_t *hi,
+                                 int j)
+{
+    const int16_t *filter_lo = dwt2_db2_coeffs_lo;
+    const int16_t *filter_hi = dwt2_db2_coeffs_hi;
+    const __m512i fl0 = set1_pair_epi16(filter_lo[0], filter_lo[1]);
+    const __m512i fl1 = set1_pair_epi16(filter_lo[2], filter_lo[3]);
+    const __m512i fh0 = set1_pair_epi16(filter_hi[0], filter_hi[1]);
+    const __m512i fh1 = set1_pair_epi16(filter_hi[2], filter_hi[3]);
+    const __m512i add_shift_HP = _mm512_set1_epi32(32768);
+
+    const __m512i s0 = _mm512_loadu_si512(tmp + 2 * j - 1);
+    const __m512i s1 = _mm512_loadu_si512(tmp + 2 * j + 1);
+    const __m512i s2 = _mm512_loadu_si512(tmp + 2 * j + 31);
+    const __m512i s3 = _mm512_loadu_si512(tmp + 2 * j + 33);
+
+    __m512i accum_lo, accum_hi;
+
+    accum_lo = _mm512_add_epi32(_mm512_madd_epi16(s0, fl0),
+                                _mm512_madd_epi16(s1, fl1));
+    accum_hi = _mm512_add_epi32(_mm512_madd_epi16(s2, fl0),
+                                _mm512_madd_epi16(s3, fl1));
+    accum_lo = _mm512_srai_epi32(_mm512_add_epi32(accum_lo, add_shift_HP), 16);
+    accum_hi = _mm512_srai_epi32(_mm512_add_epi32(accum_hi, add_shift_HP), 16);
+    _mm256_storeu_si256((__m256i *)(lo + j), _mm512_cvtepi32_epi16(accum_lo));
+    _mm256_storeu_si256((__m256i *)(lo + j + 16), _mm512_cvtepi32_epi16(accum_hi));
+
+    accum_lo = _mm512_add_epi32(_mm512_madd_epi16(s0, fh0),
+                                _mm512_madd_epi16(s1, fh1));
+    accum_hi = _mm512_add_epi32(_mm512_madd_epi16(s2, fh0),
+                                _mm512_madd_epi16(s3, fh1));
+    accum_lo = _mm512_srai_epi32(_mm512_add_epi32(accum_lo, add_shift_HP), 16);
+    accum_hi = _mm512_srai_epi32(_mm512_add_epi32(accum_hi, add_shift_HP), 16);
+    _mm256_storeu_si256((__m256i *)(hi + j), _mm512_cvtepi32_epi16(accum_lo));
+    _mm256_storeu_si256((__m256i *)(hi + j + 16), _mm512_cvtepi32_epi16(accum_hi));
+}
+
+static void adm_dwt2_h_row(const int16_t *tmplo, const int16_t *tmphi,
+                           const adm_dwt_band_t *dst, int **ind_x, int w,
+                           ptrdiff_t offset)
+{
+    // taps of j reach 2 * j + 2, those of the last columns are mirrored
+    const int w_half = (w + 1) / 2;
+    const int j_end = (w - 3) / 2 + 1;
+
+    adm_dwt2_h_col(tmplo, tmphi, dst, ind_x, offset, 0);
+    int j = 1;
+    for (; j + 32 <= j_end; j += 32) {
+        adm_dwt2_h_32(tmplo, dst->band_a + offset, dst->band_v + offset, j);
+        adm_dwt2_h_32(tmphi, dst->band_h + offset, dst->band_d + offset, j);
+    }
+    for (; j < w_half; ++j)
+        adm_dwt2_h_col(tmplo, tmphi, dst, ind_x, offset, j);
+}
+
+void adm_dwt2_8_avx512(const uint8_t *src, const adm_dwt_band_t *dst,
+                       AdmBuffer *buf, int w, int h, int src_stride,
+                       int dst_stride)
+{
+    const int16_t shift_VP = 8;
+    const int32_t add_shift_VP = 128;
+
+    int **ind_y = buf->ind_y;
+    int **ind_x = buf->ind_x;
+
+    int16_t *tmplo = (int16_t *)buf->tmp_ref;
+    int16_t *tmphi = tmplo + w;
+
+    const uint32_t lo_sum = dwt2_db2_coeffs_lo_sum;
+    const __m512i add_lo =
+        _mm512_set1_epi32((int32_t)(add_shift_VP - lo_sum * add_shift_VP));
+    const __m512i add_hi = _mm512_set1_epi32(add_shift_VP);
+    const __m128i shift = _mm_cvtsi32_si128(shift_VP);
+
+    for (int i = 0; i < (h + 1) / 2; ++i) {
+        /* Vertical pass. */
+        const uint8_t *src0 = src + ind_y[0][i] * src_stride;
+        const uint8_t *src1 = src + ind_y[1][i] * src_stride;
+        const uint8_t *src2 = src + ind_y[2][i] * src_stride;
+        const uint8_t *src3 = src + ind_y[3][i] * src_stride;
+
+        for (int j = 0; j < w; j += 32) {
+            const __mmask32 mask = tail_mask32(w - j);
+            const __m512i s0 =
+                _mm512_cvtepu8_epi16(_mm256_maskz_loadu_epi8(mask, src0 + j));
+            const __m512i s1 =
+                _mm512_cvtepu8_epi16(_mm256_maskz_loadu_epi8(mask, src1 + j));
+            const __m512i s2 =
+                _mm512_cvtepu8_epi16(_mm256_maskz_loadu_epi8(mask, src2 + j));
+            const __m512i s3 =
+                _mm512_cvtepu8_epi16(_mm256_maskz_loadu_epi8(mask, src3 + j));
+            adm_dwt2_v_32(s0, s1, s2, s3, tmplo + j, tmphi + j, mask, add_lo,
+                          add_hi, shift);
+        }
+
+        /* Horizontal pass (lo and hi). */
+        adm_dwt2_h_row(tmplo, tmphi, dst, ind_x, w, i * dst_stride);
+    }
+}
+
+void adm_dwt2_16_avx512(const uint16_t *src, const adm_dwt_band_t *dst,
+                        AdmBuffer *buf, int w, int h, int src_stride,
+                        int dst_stride, int inp_size_bits)
+{
+    const int16_t shift_VP = inp_size_bits;
+    const int32_t add_shift_VP = 1 << (inp_size_bits - 1);
+
+    int **ind_y = buf->ind_y;
+    int **ind_x = buf->ind_x;
+
+    int16_t *tmplo = (int16_t *)buf->tmp_ref;
+    int16_t *tmphi = tmplo + w;
+
+    const __m512i bias = _mm512_set1_epi16((int16_t)0x8000);
+    const uint32_t lo_sum = dwt2_db2_coeffs_lo_sum;
+    const __m512i add_lo = _mm512_set1_epi32(
+        (int32_t)(32768u * lo_sum - lo_sum * add_shift_VP + add_shift_VP));
+    const __m512i add_hi = _mm512_set1_epi32(add_shift_VP);
+    const __m128i shift = _mm_cvtsi32_si128(shift_VP);
+
+    for (int i = 0; i < (h + 1) / 2; ++i) {
+        /* Vertical pass. */
+        const uint16_t *src0 = src + ind_y[0][i] * src_stride;
+        const uint16_t *src1 = src + ind_y[1][i] * src_stride;
+        const uint16_t *src2 = src + ind_y[2][i] * src_stride;
+        const uint16_t *src3 = src + ind_y[3][i] * src_stride;
+
+        for (int j = 0; j < w; j += 32) {
+            const __mmask32 mask = tail_mask32(w - j);
+            const __m512i s0 = _mm512_xor_si512(
+                _mm512_maskz_loadu_epi16(mask, src0 + j), bias);
+            const __m512i s1 = _mm512_xor_si512(
+                _mm512_maskz_loadu_epi16(mask, src1 + j), bias);
+            const __m512i s2 = _mm512_xor_si512(
+                _mm512_maskz_loadu_epi16(mask, src2 + j), bias);
+            const __m512i s3 = _mm512_xor_si512(
+                _mm512_maskz_loadu_epi16(mask, src3 + j), bias);
+            adm_dwt2_v_32(s0, s1, s2, s3, tmplo + j, tmphi + j, mask, add_lo,
+                          add_hi, shift);
+        }
+
+        /* Horizontal pass (lo and hi). */
+        adm_dwt2_h_row(tmplo, tmphi, dst, ind_x, w, i * dst_stride);
+    }
+}
+
+/* One output of the 32-bit filters, int64_t sums as in the C code. */
+static inline int32_t adm_dwt2_s123_tap(const int16_t *filter, int32_t s0,
+                                        int32_t s1, int32_t s2, int32_t s3,
+                                        int32_t add_shift, int16_t shift)
+{
+    int64_t accum = 0;
+    accum += (int64_t)filter[0] * s0;
+    accum += (int64_t)filter[1] * s1;
+    accum += (int64_t)filter[2] * s2;
+    accum += (int64_t)filter[3] * s3;
+    return (int32_t)((accum + add_shift) >> shift);
+}
+
+static inline void adm_dwt2_s123_h_col(const int32_t *tmplo,
+                                       const int32_t *tmphi,
+                                       const i4_adm_dwt_band_t *dst,
+                                       int **ind_x, ptrdiff_t offset, int j,
+                                       int32_t add_shift, int16_t shift)
+{
+    const int16_t *filter_lo = dwt2_db2_coeffs_lo;
+    const int16_t *filter_hi = dwt2_db2_coeffs_hi;
+    const int j0 = ind_x[0][j];
+    const int j1 = ind_x[1][j];
+    const int j2 = ind_x[2][j];
+    const int j3 = ind_x[3][j];
+
+    dst->band_a[offset + j] =
+        adm_dwt2_s123_tap(filter_lo, tmplo[j0], tmplo[j1], tmplo[j2],
+                          tmplo[j3], add_shift, shift);
+    dst->band_v[offset + j] =
+        adm_dwt2_s123_tap(filter_hi, tmplo[j0], tmplo[j1], tmplo[j2],
+                          tmplo[j3], add_shift, shift);
+    dst->band_h[offset + j] =
+        adm_dwt2_s123_tap(filter_lo, tmphi[j0], tmphi[j1], tmphi[j2],
+                          tmphi[j3], add_shift, shift);
+    dst->band_d[offset + j] =
+        adm_dwt2_s123_tap(filter_hi, tmphi[j0], tmphi[j1], tmphi[j2],
+                          tmphi[j3], add_shift, shift);
+}
+
+/* Sum of the 4 taps times filter over the low 32 bits of 64-bit lanes. */
+static inline __m512i filter4_epi64(__m512i s0, __m512i s1, __m512i s2,
+                                    __m512i s3, const __m512i *f)
+{
+    return _mm512_add_epi64(
+        _mm512_add_epi64(_mm512_mul_epi32(s0, f[0]), _mm512_mul_epi32(s1, f[1])),
+        _mm512_add_epi64(_mm512_mul_epi32(s2, f[2]), _mm512_mul_epi32(s3, f[3])));
+}
+
+/*
+ * Low 32 bits of (even + add) >> shift and (odd + add) >> shift, where even
+ * and odd hold the 64-bit sums of the even and odd lanes.
+ */
+static inline __m512i round_shift_merge_epi64(__m512i even, __m512i odd,
+                                              __m512i add, int shift)
+{
+    even = _mm512_srl_epi64(_mm512_add_epi64(even, add),
+                            _mm_cvtsi32_si128(shift));
+    odd = _mm512_sll_epi64(_mm512_add_epi64(odd, add),
+                           _mm_cvtsi32_si128(32 - shift));
+    return _mm512_mask_blend_epi32(0xAAAA, even, odd);
+}
+
+static inline void adm_dwt2_s123_v_16(const int32_t *src0, const int32_t *src1,
+                                      const int32_t *src2, const int32_t *src3,
+                                      int32_t *lo, int32_t *hi, __mmask16 mask,
+                                      const __m512i *fl, const __m512i *fh,
+                                      __m512i add, int shift)
+{
+    const __m512i s0 = _mm512_maskz_loadu_epi32(mask, src0);
+    const __m512i s1 = _mm512_maskz_loadu_epi32(mask, src1);
+    const __m512i s2 = _mm512_maskz_loadu_epi32(mask, src2);
+    const __m512i s3 = _mm512_maskz_loadu_epi32(mask, src3);
+    const __m512i o0 = _mm512_srli_epi64(s0, 32);
+    const __m512i o1 = _mm512_srli_epi64(s1, 32);
+    const __m512i o2 = _mm512_srli_epi64(s2, 32);
+    const __m512i o3 = _mm512_srli_epi64(s3, 32);
+
+    _mm512_mask_storeu_epi32(lo, mask, round_shift_merge_epi64(
+        filter4_epi64(s0, s1, s2, s3, fl), filter4_epi64(o0, o1, o2, o3, fl),
+        add, shift));
+    _mm512_mask_storeu_epi32(hi, mask, round_shift_merge_epi64(
+        filter4_epi64(s0, s1, s2, s3, fh), filter4_epi64(o0, o1, o2, o3, fh),
+        add, shift));
+}
+
+/*
+ * 8 outputs from j of the lo and hi filters over one tmp row. The low 32 bits
+ * of the 64-bit lanes of a load from 2 * j - 1 are the first taps of outputs
+ * j to j + 7, the high ones the second taps, likewise a load from 2 * j + 1
+ * gives the third and fourth taps.
+ */
+static inline void adm_dwt2_s123_h_8(const int32_t *tmp, int32_t *lo,
+                                     int32_t *hi, int j, const __m512i *fl,
+                                     const __m512i *fh, __m512i add,
+                                     __m128i shift)
+{
+    const __m512i a = _mm512_loadu_si512(tmp + 2 * j - 1);
+    const __m512i c = _mm512_loadu_si512(tmp + 2 * j + 1);
+    const __m512i a1 = _mm512_srli_epi64(a, 32);
+    const __m512i c1 = _mm512_srli_epi64(c, 32);
+
+    __m512i accum;
+
+    accum = _mm512_sra_epi64(
+        _mm512_add_epi64(filter4_epi64(a, a1, c, c1, fl), add), shift);
+    _mm256_storeu_si256((__m256i *)(lo + j), _mm512_cvtepi64_epi32(accum));
+    accum = _mm512_sra_epi64(
+        _mm512_add_epi64(filter4_epi64(a, a1, c, c1, fh), add), shift);
+    _mm256_storeu_si256((__m256i *)(hi + j), _mm512_cvtepi64_epi32(accum));
+}
+
+void adm_dwt2_s123_combined_avx512(const int32_t *i4_ref_scale,
+                                   const int32_t *i4_curr_dis, AdmBuffer *buf,
+                                   int w, int h, int ref_stride, int dis_stride,
+                                   int dst_stride, int scale)
+{
+    const i4_adm_dwt_band_t *i4_ref_dwt2 = &buf->i4_ref_dwt2;
+    const i4_adm_dwt_band_t *i4_dis_dwt2 = &buf->i4_dis_dwt2;
+    int **ind_y = buf->ind_y;
+    int **ind_x = buf->ind_x;
+
+    const int16_t *filter_lo = dwt2_db2_coeffs_lo;
+    const int16_t *filter_hi = dwt2_db2_coeffs_hi;
+
+    const int32_t add_bef_shift_round_VP[3] = { 0, 32768, 32768 };
+    const int32_t add_bef_shift_round_HP[3] = { 16384, 32768, 16384 };
+    const int16_t shift_VerticalPass[3] = { 0, 16, 16 };
+    const int16_t shift_HorizontalPass[3] = { 15, 16, 15 };
+
+    const int32_t add_VP = add_bef_shift_round_VP[scale - 1];
+    const int32_t add_HP = add_bef_shift_round_HP[scale - 1];
+    const int16_t shift_VP = shift_VerticalPass[scale - 1];
+    const int16_t shift_HP = shift_HorizontalPass[scale - 1];
+
+    int32_t *tmplo_ref = buf->tmp_ref;
+    int32_t *tmphi_ref = tmplo_ref + w;
+    int32_t *tmplo_dis = tmphi_ref + w;
+    int32_t *tmphi_dis = tmplo_dis + w;
+
+    const __m512i fl[4] = {
+        _mm512_set1_epi32(filter_lo[0]), _mm512_set1_epi32(filter_lo[1]),
+        _mm512_set1_epi32(filter_lo[2]), _mm512_set1_epi32(filter_lo[3]),
+    };
+    const __m512i fh[4] = {
+        _mm512_set1_epi32(filter_hi[0]), _mm512_set1_epi32(filter_hi[1]),
+        _mm512_set1_epi32(filter_hi[2]), _mm512_set1_epi32(filter_hi[3]),
+    };
+    const __m512i add_VP_64 = _mm512_set1_epi64(add_VP);
+    const __m512i add_HP_64 = _mm512_set1_epi64(add_HP);
+    const __m128i shift_HP_64 = _mm_cvtsi32_si128(shift_HP);
+
+    const int w_half = (w + 1) / 2;
+    const int j_end = (w - 3) / 2 + 1;
+
+    for (int i = 0; i < (h + 1) / 2; ++i) {
+        /* Vertical pass. */
+        const int32_t *ref0 = i4_ref_scale + ind_y[0][i] * ref_stride;
+        const int32_t *ref1 = i4_ref_scale + ind_y[1][i] * ref_stride;
+        const int32_t *ref2 = i4_ref_scale + ind_y[2][i] * ref_stride;
+        const int32_t *ref3 = i4_ref_scale + ind_y[3][i] * ref_stride;
+        const int32_t *dis0 = i4_curr_dis + ind_y[0][i] * dis_stride;
+        const int32_t *dis1 = i4_curr_dis + ind_y[1][i] * dis_stride;
+        const int32_t *dis2 = i4_curr_dis + ind_y[2][i] * dis_stride;
+        const int32_t *dis3 = i4_curr_dis + ind_y[3][i] * dis_stride;
+
+        for (int j = 0; j < w; j += 16) {
+            const __mmask16 mask = tail_mask16(w - j);
+            adm_dwt2_s123_v_16(ref0 + j, ref1 + j, ref2 + j, ref3 + j,
+                               tmplo_ref + j, tmphi_ref + j, mask, fl, fh,
+                               add_VP_64, shift_VP);
+            adm_dwt2_s123_v_16(dis0 + j, dis1 + j, dis2 + j, dis3 + j,
+                               tmplo_dis + j, tmphi_dis + j, mask, fl, fh,
+                               add_VP_64, shift_VP);
+        }
+
+        /* Horizontal pass (lo and hi). */
+        const ptrdiff_t offset = i * dst_stride;
+        adm_dwt2_s123_h_col(tmplo_ref, tmphi_ref, i4_ref_dwt2, ind_x, offset,
+                            0, add_HP, shift_HP);
+        adm_dwt2_s123_h_col(tmplo_dis, tmphi_dis, i4_dis_dwt2, ind_x, offset,
+                            0, add_HP, shift_HP);
+        int j = 1;
+        for (; j + 8 <= j_end; j += 8) {
+            adm_dwt2_s123_h_8(tmplo_ref, i4_ref_dwt2->band_a + offset,
+                              i4_ref_dwt2->band_v + offset, j, fl, fh,
+                              add_HP_64, shift_HP_64);
+            adm_dwt2_s123_h_8(tmphi_ref, i4_ref_dwt2->band_h + offset,
+                              i4_ref_dwt2->band_d + offset, j, fl, fh,
+                              add_HP_64, shift_HP_64);
+            adm_dwt2_s123_h_8(tmplo_dis, i4_dis_dwt2->band_a + offset,
+                              i4_dis_dwt2->band_v + offset, j, fl, fh,
+                              add_HP_64, shift_HP_64);
+            adm_dwt2_s123_h_8(tmphi_dis, i4_dis_dwt2->band_h + offset,
+                              i4_dis_dwt2->band_d + offset, j, fl, fh,
+                              add_HP_64, shift_HP_64);
+        }
+        for (; j < w_half; ++j) {
+            adm_dwt2_s123_h_col(tmplo_ref, tmphi_ref, i4_ref_dwt2, ind_x,
+                                offset, j, add_HP, shift_HP);
+            adm_dwt2_s123_h_col(tmplo_dis, tmphi_dis, i4_dis_dwt2, ind_x,
+                                offset, j, add_HP, shift_HP);
+        }
+    }
+}
+
+/* Frame region the decouple and csf stages are computed on. */
+static inline void adm_dwt_border(int w, int h, int *left, int *top,
+                                  int *right, int *bottom)
+{
+    *left = w * ADM_BORDER_FACTOR - 0.5 - 1; // -1 for filter tap
+    *top = h * ADM_BORDER_FACTOR - 0.5 - 1;
+    *right = w - *left + 2; // +2 for filter tap
+    *bottom = h - *top + 2;
+
+    if (*left < 0) {
+        *left = 0;
+    }
+    if (*right > w) {
+        *right = w;
+    }
+    if (*top < 0) {
+        *top = 0;
+    }
+    if (*bottom > h) {
+        *bottom = h;
+    }
+}
+
+/* The lower or upper 256 bits of v. */
+static inline __m256i half_si256(__m512i v, int half)
+{
+    return half ? _mm512_extracti64x4_epi64(v, 1) : _mm512_castsi512_si256(v);
+}
+
+/*
+ * angle_flag of adm_decouple() for 8 lanes, from products that are exact in
+ * double. As in the C code, every value is rounded to float before the
+ * comparison is evaluated in double.
+ */
+static inline __mmask8 adm_angle_flag_pd(__m512d ot_dp, __m512d o_mag_sq,
+                                         __m512d t_mag_sq, __m512d cos_1deg_sq)
+{
+    const __m512d by_4096 = _mm512_set1_pd(1.0 / 4096.0);
+    const __m512d ot =
+        _mm512_mul_pd(_mm512_cvtps_pd(_mm512_cvtpd_ps(ot_dp)), by_4096);
+    const __m512d om =
+        _mm512_mul_pd(_mm512_cvtps_pd(_mm512_cvtpd_ps(o_mag_sq)), by_4096);
+    const __m512d tm =
+        _mm512_mul_pd(_mm512_cvtps_pd(_mm512_cvtpd_ps(t_mag_sq)), by_4096);
+
+    const __m512d lhs = _mm512_mul_pd(ot, ot);
+    const __m512d rhs = _mm512_mul_pd(_mm512_mul_pd(cos_1deg_sq, om), tm);
+    return _mm512_cmp_pd_mask(ot, _mm512_setzero_pd(), _CMP_GE_OQ) &
+           _mm512_cmp_pd_mask(lhs, rhs, _CMP_GE_OQ);
+}
+
+/*
+ * The enhancement gain limit of both decouple stages: rst is replaced by
+ * MIN(rst * limit, t) in pos lanes and by MAX(rst * limit, t) in neg lanes,
+ * evaluated in double as in the C code.
+ */
+static inline __m512i adm_gain_limit(__m512i rst, __m512i t, __mmask16 pos,
+                                     __mmask16 neg, __m512d limit)
+{
+    const __m512d r0 = _mm512_mul_pd(
+        _mm512_cvtepi32_pd(_mm512_castsi512_si256(rst)), limit);
+    const __m512d r1 = _mm512_mul_pd(
+        _mm512_cvtepi32_pd(_mm512_extracti64x4_epi64(rst, 1)), limit);
+    const __m512d t0 = _mm512_cvtepi32_pd(_mm512_castsi512_si256(t));
+    const __m512d t1 = _mm512_cvtepi32_pd(_mm512_extracti64x4_epi64(t, 1));
+
+    const __m512i rst_min = _mm512_inserti64x4(
+        _mm512_castsi256_si512(_mm512_cvttpd_epi32(_mm512_min_pd(r0, t0))),
+        _mm512_cvttpd_epi32(_mm512_min_pd(r1, t1)), 1);
+    const __m512i rst_max = _mm512_inserti64x4(
+        _mm512_castsi256_si512(_mm512_cvttpd_epi32(_mm512_max_pd(r0, t0))),
+        _mm512_cvttpd_epi32(_mm512_max_pd(r1, t1)), 1);
+
+    rst = _mm512_mask_blend_epi32(pos, rst, rst_min);
+    return _mm512_mask_blend_epi32(neg, rst, rst_max);
+}
+
+/*
+ * k and rst of adm_decouple() for one orientation. The int64_t products of
+ * the division by lookup take the even and odd lanes apart, q >> 15 always
+ * fits int32_t.
+ */
+static inline __m512i adm_decouple_rst(const int32_t *div_lookup,
+                                       __m512i o, __m512i t, __m512i *k)
+{
+    const __m512i add = _mm512_set1_epi64(16384);
+    const __m512i zero = _mm512_setzero_si512();
+
+    const __m512i div = _mm512_i32gather_epi32(
+        _mm512_add_epi32(o, _mm512_set1_epi32(32768)), div_lookup, 4);
+    __m512i k_even = _mm512_add_epi64(_mm512_mul_epi32(div, t), add);
+    __m512i k_odd = _mm512_add_epi64(
+        _mm512_mul_epi32(_mm512_srli_epi64(div, 32), _mm512_srli_epi64(t, 32)),
+        add);
+    k_even = _mm512_srai_epi64(k_even, 15);
+    k_odd = _mm512_srai_epi64(k_odd, 15);
+
+    __m512i kk = _mm512_mask_blend_epi32(0xAAAA, k_even,
+                                         _mm512_slli_epi64(k_odd, 32));
+    kk = _mm512_max_epi32(kk, zero);
+    kk = _mm512_min_epi32(kk, _mm512_set1_epi32(32768));
+    kk = _mm512_mask_blend_epi32(_mm512_cmpeq_epi32_mask(o, zero), kk,
+                                 _mm512_set1_epi32(32768));
+    *k = kk;
+
+    return _mm512_srai_epi32(
+        _mm512_add_epi32(_mm512_mullo_epi32(kk, o), _mm512_set1_epi32(16384)),
+        15);
+}
+
+void adm_decouple_avx512(AdmBuffer *buf, int w, int h, int stride,
+                         double adm_enhn_gain_limit, int row_start,
+                         int row_end)
+{
+    const float cos_1deg_sq = cos(1.0 * M_PI / 180.0) * cos(1.0 * M_PI / 180.0);
+
+    const adm_dwt_band_t *ref = &buf->ref_dwt2;
+    const adm_dwt_band_t *dis = &buf->dis_dwt2;
+    const adm_dwt_band_t *r = &buf->decouple_r;
+    const adm_dwt_band_t *a = &buf->decouple_a;
+    const int32_t *div_lookup = buf->div_lookup;
+
+    int left, top, right, bottom;
+    adm_dwt_border(w, h, &left, &top, &right, &bottom);
+
+    const __m512d cos_pd = _mm512_set1_pd(cos_1deg_sq);
+    const __m512d limit = _mm512_set1_pd(adm_enhn_gain_limit);
+    const __m512i zero = _mm512_setzero_si512();
+
+    const int16_t *o_band[3] = { ref->band_h, ref->band_v, ref->band_d };
+    const int16_t *t_band[3] = { dis->band_h, dis->band_v, dis->band_d };
+    int16_t *r_band[3] = { r->band_h, r->band_v, r->band_d };
+    int16_t *a_band[3] = { a->band_h, a->band_v, a->band_d };
+
+    for (int i = MAX(top, row_start); i < MIN(bottom, row_end); ++i) {
+        for (int j = left; j < right; j += 16) {
+            const __mmask16 mask = tail_mask16(right - j);
+            const ptrdiff_t offset = i * stride + j;
+            __m512i o[3], t[3];
+
+            for (int theta = 0; theta < 3; ++theta) {
+                o[theta] = _mm512_cvtepi16_epi32(
+                    _mm256_maskz_loadu_epi16(mask, o_band[theta] + offset));
+                t[theta] = _mm512_cvtepi16_epi32(
+                    _mm256_maskz_loadu_epi16(mask, t_band[theta] + offset));
+            }
+
+            __mmask8 flag[2];
+            for (int half = 0; half < 2; ++half) {
+                const __m512d oh = _mm512_cvtepi32_pd(
+                    half_si256(o[0], half));
+                const __m512d ov = _mm512_cvtepi32_pd(
+                    half_si256(o[1], half));
+                const __m512d th = _mm512_cvtepi32_pd(
+                    half_si256(t[0], half));
+                const __m512d tv = _mm512_cvtepi32_pd(
+                    half_si256(t[1], half));
+
+                const __m512d ot_dp =
+                    _mm512_add_pd(_mm512_mul_pd(oh, th), _mm512_mul_pd(ov, tv));
+                const __m512d o_mag_sq =
+                    _mm512_add_pd(_mm512_mul_pd(oh, oh), _mm512_mul_pd(ov, ov));
+                const __m512d t_mag_sq =
+                    _mm512_add_pd(_mm512_mul_pd(th, th), _mm512_mul_pd(tv, tv));
+                flag[half] = adm_angle_flag_pd(ot_dp, o_mag_sq, t_mag_sq, cos_pd);
+            }
+            const __mmask16 angle_flag = flag[0] | ((__mmask16)flag[1] << 8);
+
+            for (int theta = 0; theta < 3; ++theta) {
+                __m512i k;
+                __m512i rst =
+                    adm_decouple_rst(div_lookup, o[theta], t[theta], &k);
+
+                const __mmask16 k_pos =
+                    angle_flag & _mm512_cmpgt_epi32_mask(k, zero);
+                const __mmask16 pos =
+                    k_pos & _mm512_cmpgt_epi32_mask(o[theta], zero);
+                const __mmask16 neg =
+                    k_pos & _mm512_cmplt_epi32_mask(o[theta], zero);
+                rst = adm_gain_limit(rst, t[theta], pos, neg, limit);
+
+                _mm256_mask_storeu_epi16(r_band[theta] + offset, mask,
+                                         _mm512_cvtepi32_epi16(rst));
+                _mm256_mask_storeu_epi16(a_band[theta] + offset, mask,
+                    _mm512_cvtepi32_epi16(_mm512_sub_epi32(t[theta], rst)));
+            }
+        }
+    }
+}
+
+/* Sign extends the lower or upper 8 lanes of v to int64_t. */
+static inline __m512i cvtepi32_epi64_half(__m512i v, int half)
+{
+    return _mm512_cvtepi32_epi64(half_si256(v, half));
+}
+
+/* Packs two vectors of 8 x int64_t, truncated, to 16 x int32_t. */
+static inline __m512i pack_epi64_epi32(__m512i lo, __m512i hi)
+{
+    return _mm512_inserti64x4(_mm512_castsi256_si512(_mm512_cvtepi64_epi32(lo)),
+                              _mm512_cvtepi64_epi32(hi), 1);
+}
+
+/*
+ * k and rst of adm_decouple_s123() for 8 lanes sign extended to int64_t, see
+ * get_best15_from32() for the reduction of |o| to 15 bits.
+ */
+static inline __m512i adm_decouple_s123_rst_8(const int32_t *div_lookup,
+                                              __m512i o, __m512i t, __m512i *k)
+{
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i one = _mm512_set1_epi64(1);
+
+    const __m512i abs_o = _mm512_abs_epi64(o);
+    const __mmask8 small =
+        _mm512_cmplt_epi64_mask(abs_o, _mm512_set1_epi64(32768));
+
+    // 17 - clz(|o|), from the exponent of |o| which converts exactly
+    const __m512i expo = _mm512_srli_epi64(
+        _mm512_castpd_si512(_mm512_cvtepi64_pd(abs_o)), 52);
+    const __m512i shift = _mm512_maskz_sub_epi64(~small, expo,
+                                                 _mm512_set1_epi64(1037));
+    const __m512i rnd = _mm512_sllv_epi64(one, _mm512_sub_epi64(shift, one));
+    const __m512i msb = _mm512_mask_blend_epi64(small,
+        _mm512_srlv_epi64(_mm512_add_epi64(abs_o, rnd), shift), abs_o);
+
+    const __m512i div = _mm512_cvtepi32_epi64(_mm512_i64gather_epi32(
+        _mm512_add_epi64(msb, _mm512_set1_epi64(32768)), div_lookup, 4));
+
+    // (1 << (14 + shift)) is an int, sign extended to int64_t
+    __m512i round = _mm512_sllv_epi64(
+        one, _mm512_add_epi64(shift, _mm512_set1_epi64(14)));
+    round = _mm512_srai_epi64(_mm512_slli_epi64(round, 32), 32);
+
+    __m512i q = _mm512_mul_epi32(div, t);
+    q = _mm512_mask_sub_epi64(q, _mm512_cmplt_epi64_mask(o, zero), zero, q);
+    q = _mm512_add_epi64(q, round);
+
+    __m512i kk = _mm512_srav_epi64(
+        q, _mm512_add_epi64(shift, _mm512_set1_epi64(15)));
+    kk = _mm512_max_epi64(kk, zero);
+    kk = _mm512_min_epi64(kk, _mm512_set1_epi64(32768));
+    kk = _mm512_mask_blend_epi64(_mm512_cmpeq_epi64_mask(o, zero), kk,
+                                 _mm512_set1_epi64(32768));
+    *k = kk;
+
+    return _mm512_srai_epi64(
+        _mm512_add_epi64(_mm512_mul_epi32(kk, o), _mm512_set1_epi64(16384)),
+        15);
+}
+
+/* k and rst of adm_decouple_s123() for one orientation. */
+static inline __m512i adm_decouple_s123_rst(const int32_t *div_lookup,
+                                            __m512i o, __m512i t, __m512i *k)
+{
+    __m512i k_half[2], rst_half[2];
+    for (int half = 0; half < 2; ++half) {
+        rst_half[half] =
+            adm_decouple_s123_rst_8(div_lookup, cvtepi32_epi64_half(o, half),
+                                    cvtepi32_epi64_half(t, half), &k_half[half]);
+    }
+    *k = pack_epi64_epi32(k_half[0], k_half[1]);
+    return pack_epi64_epi32(rst_half[0], rst_half[1]);
+}
+
+void adm_decouple_s123_avx512(AdmBuffer *buf, int w, int h, int stride,
+                              double adm_enhn_gain_limit, int row_start,
+                              int row_end)
+{
+    const float cos_1deg_sq = cos(1.0 * M_PI / 180.0) * cos(1.0 * M_PI / 180.0);
+
+    const i4_adm_dwt_band_t *ref = &buf->i4_ref_dwt2;
+    const i4_adm_dwt_band_t *dis = &buf->i4_dis_dwt2;
+    const i4_adm_dwt_band_t *r = &buf->i4_decouple_r;
+    const i4_adm_dwt_band_t *a = &buf->i4_decouple_a;
+    const int32_t *div_lookup = buf->div_lookup;
+
+    int left, top, right, bottom;
+    adm_dwt_border(w, h, &left, &top, &right, &bottom);
+
+    const __m512d cos_pd = _mm512_set1_pd(cos_1deg_sq);
+    const __m512d limit = _mm512_set1_pd(adm_enhn_gain_limit);
+    const __m512i zero = _mm512_setzero_si512();
+
+    const int32_t *o_band[3] = { ref->band_h, ref->band_v, ref->band_d };
+    const int32_t *t_band[3] = { dis->band_h, dis->band_v, dis->band_d };
+    int32_t *r_band[3] = { r->band_h, r->band_v, r->band_d };
+    int32_t *a_band[3] = { a->band_h, a->band_v, a->band_d };
+
+    for (int i = MAX(top, row_start); i < MIN(bottom, row_end); ++i) {
+        for (int j = left; j < right; j += 16) {
+            const __mmask16 mask = tail_mask16(right - j);
+            const ptrdiff_t offset = i * stride + j;
+            __m512i o[3], t[3];
+
+            for (int theta = 0; theta < 3; ++theta) {
+                o[theta] = _mm512_maskz_loadu_epi32(mask, o_band[theta] + offset);
+                t[theta] = _mm512_maskz_loadu_epi32(mask, t_band[theta] + offset);
+            }
+
+            // int64_t to float conversions round once, like the C code
+            __mmask8 flag[2];
+            for (int half = 0; half < 2; ++half) {
+                const __m512i oh = cvtepi32_epi64_half(o[0], half);
+                const __m512i ov = cvtepi32_epi64_half(o[1], half);
+                const __m512i th = cvtepi32_epi64_half(t[0], half);
+                const __m512i tv = cvtepi32_epi64_half(t[1], half);
+
+                const __m512i ot_dp = _mm512_add_epi64(
+                    _mm512_mul_epi32(oh, th), _mm512_mul_epi32(ov, tv));
+                const __m512i o_mag_sq = _mm512_add_epi64(
+                    _mm512_mul_epi32(oh, oh), _mm512_mul_epi32(ov, ov));
+                const __m512i t_mag_sq = _mm512_add_epi64(
+                    _mm512_mul_epi32(th, th), _mm512_mul_epi32(tv, tv));
+                flag[half] = adm_angle_flag_pd(
+                    _mm512_cvtps_pd(_mm512_cvtepi64_ps(ot_dp)),
+                    _mm512_cvtps_pd(_mm512_cvtepi64_ps(o_mag_sq)),
+                    _mm512_cvtps_pd(_mm512_cvtepi64_ps(t_mag_sq)), cos_pd);
+            }
+            const __mmask16 angle_flag = flag[0] | ((__mmask16)flag[1] << 8);
+
+            for (int theta = 0; theta < 3; ++theta) {
+                __m512i k;
+                __m512i rst = adm_decouple_s123_rst(div_lookup, o[theta],
+                                                     t[theta], &k);
+
+                const __mmask16 k_pos =
+                    angle_flag & _mm512_cmpgt_epi32_mask(k, zero);
+                const __mmask16 pos =
+                    k_pos & _mm512_cmpgt_epi32_mask(o[theta], zero);
+                const __mmask16 neg =
+                    k_pos & _mm512_cmplt_epi32_mask(o[theta], zero);
+                rst = adm_gain_limit(rst, t[theta], pos, neg, limit);
+
+                _mm512_mask_storeu_epi32(r_band[theta] + offset, mask, rst);
+                _mm512_mask_storeu_epi32(a_band[theta] + offset, mask,
+                                         _mm512_sub_epi32(t[theta], rst));
+            }
+        }
+    }
+}
+
+void adm_csf_avx512(AdmBuffer *buf, int w, int h, int stride, int row_start,
+                    int row_end)
+{
+    const adm_dwt_band_t *src = &buf->decouple_a;
+    const adm_dwt_band_t *dst = &buf->csf_a;
+    const adm_dwt_band_t *flt = &buf->csf_f;
+
+    const int16_t *src_angles[3] = { src->band_h, src->band_v, src->band_d };
+    int16_t *dst_angles[3] = { dst->band_h, dst->band_v, dst->band_d };
+    int16_t *flt_angles[3] = { flt->band_h, flt->band_v, flt->band_d };
+
+    // see adm_csf() for the fixed-point format of these
+    const uint16_t i_rfactor[3] = { 36453, 36453, 49417 };
+    const uint8_t i_shifts[3] = { 15, 15, 17 };
+    const uint16_t i_shiftsadd[3] = { 16384, 16384, 65535 };
+    const uint16_t FIX_ONE_BY_30 = 4369; //(1/30)*2^17
+
+    int left, top, right, bottom;
+    adm_dwt_border(w, h, &left, &top, &right, &bottom);
+
+    const __m512i one_by_30 = _mm512_set1_epi32(FIX_ONE_BY_30);
+    const __m512i add_flt = _mm512_set1_epi32(2048);
+
+    for (int theta = 0; theta < 3; ++theta) {
+        const int16_t *src_ptr = src_angles[theta];
+        int16_t *dst_ptr = dst_angles[theta];
+        int16_t *flt_ptr = flt_angles[theta];
+
+        const __m512i rfactor = _mm512_set1_epi32(i_rfactor[theta]);
+        const __m512i add = _mm512_set1_epi32(i_shiftsadd[theta]);
+        const __m128i shift = _mm_cvtsi32_si128(i_shifts[theta]);
+
+        for (int i = MAX(top, row_start); i < MIN(bottom, row_end); ++i) {
+            const ptrdiff_t offset = i * stride;
+
+            for (int j = left; j < right; j += 16) {
+                const __mmask16 mask = tail_mask16(right - j);
+                const __m512i s = _mm512_cvtepi16_epi32(
+                    _mm256_maskz_loadu_epi16(mask, src_ptr + offset + j));
+
+                __m512i d = _mm512_mullo_epi32(s, rfactor);
+                d = _mm512_sra_epi32(_mm512_add_epi32(d, add), shift);
+                // as int16_t
+                d = _mm512_srai_epi32(_mm512_slli_epi32(d, 16), 16);
+
+                __m512i f = _mm512_mullo_epi32(_mm512_abs_epi32(d), one_by_30);
+                f = _mm512_srai_epi32(_mm512_add_epi32(f, add_flt), 12);
+
+                _mm256_mask_storeu_epi16(dst_ptr + offset + j, mask,
+                                         _mm512_cvtepi32_epi16(d));
+                _mm256_mask_storeu_epi16(flt_ptr + offset + j, mask,
+                                         _mm512_cvtepi32_epi16(f));
+            }
+        }
+    }
+}
+
+/* (int32_t)((rfactor * (int64_t)x + add) >> 28) with rfactor a uint32_t. */
+static inline __m512i i4_mul_rfactor(__m512i x, __m512i rfactor, __m512i add)
+{
+    __m512i half[2];
+    for (int i = 0; i < 2; ++i) {
+        const __m512i p =
+            _mm512_mullo_epi64(cvtepi32_epi64_half(x, i), rfactor);
+        half[i] = _mm512_srai_epi64(_mm512_add_epi64(p, add), 28);
+    }
+    return pack_epi64_epi32(half[0], half[1]);
+}
+
+/* (int32_t)(((int64_t)mul * abs(x) + add) >> 32) */
+static inline __m512i i4_mul_abs_hi(__m512i x, __m512i mul, __m512i add)
+{
+    const __m512i abs_x = _mm512_abs_epi32(x);
+    __m512i half[2];
+    for (int i = 0; i < 2; ++i) {
+        const __m512i p =
+            _mm512_mul_epi32(cvtepi32_epi64_half(abs_x, i), mul);
+        half[i] = _mm512_srai_epi64(_mm512_add_epi64(p, add), 32);
+    }
+    return pack_epi64_epi32(half[0], half[1]);
+}
+
+void i4_adm_csf_avx512(AdmBuffer *buf, int scale, int w, int h, int stride,
+                       int row_start, int row_end)
+{
+    const i4_adm_dwt_band_t *src = &buf->i4_decouple_a;
+    const i4_adm_dwt_band_t *dst = &buf->i4_csf_a;
+    const i4_adm_dwt_band_t *flt = &buf->i4_csf_f;
+
+    const int32_t *src_angles[3] = { src->band_h, src->band_v, src->band_d };
+    int32_t *dst_angles[3] = { dst->band_h, dst->band_v, dst->band_d };
+    int32_t *flt_angles[3] = { flt->band_h, flt->band_v, flt->band_d };
+
+    const float factor1 = dwt_quant_step(&dwt_7_9_YCbCr_threshold[0], scale, 1);
+    const float factor2 = dwt_quant_step(&dwt_7_9_YCbCr_threshold[0], scale, 2);
+    const float rfactor1[3] = { 1.0f / factor1, 1.0f / factor1, 1.0f / factor2 };
+
+    const double pow2_32 = pow(2, 32);
+    const uint32_t i_rfactor[3] = { (uint32_t)(rfactor1[0] * pow2_32),
+                                    (uint32_t)(rfactor1[1] * pow2_32),
+                                    (uint32_t)(rfactor1[2] * pow2_32) };
+
+    const uint32_t FIX_ONE_BY_30 = 143165577;
+    const int32_t shift_flt = 32;
+    const int32_t add_bef_shift_dst = (int32_t)(1 << (28 - 1));
+    const int32_t add_bef_shift_flt = (int32_t)(1 << (shift_flt - 1));
+
+    int left, top, right, bottom;
+    adm_dwt_border(w, h, &left, &top, &right, &bottom);
+
+    const __m512i add_dst = _mm512_set1_epi64(add_bef_shift_dst);
+    const __m512i add_flt = _mm512_set1_epi64(add_bef_shift_flt);
+    const __m512i one_by_30 = _mm512_set1_epi64(FIX_ONE_BY_30);
+
+    for (int theta = 0; theta < 3; ++theta) {
+        const int32_t *src_ptr = src_angles[theta];
+        int32_t *dst_ptr = dst_angles[theta];
+        int32_t *flt_ptr = flt_angles[theta];
+
+        const __m512i rfactor = _mm512_set1_epi64(i_rfactor[theta]);
+
+        for (int i = MAX(top, row_start); i < MIN(bottom, row_end); ++i) {
+            const ptrdiff_t offset = i * stride;
+
+            for (int j = left; j < right; j += 16) {
+                const __mmask16 mask = tail_mask16(right - j);
+                const __m512i s =
+                    _mm512_maskz_loadu_epi32(mask, src_ptr + offset + j);
+
+                const __m512i d = i4_mul_rfactor(s, rfactor, add_dst);
+                const __m512i f = i4_mul_abs_hi(d, one_by_30, add_flt);
+
+                _mm512_mask_storeu_epi32(dst_ptr + offset + j, mask, d);
+                _mm512_mask_storeu_epi32(flt_ptr + offset + j, mask, f);
+            }
+        }
+    }
+}
+
+/*
+ * Contrast masking. Both adm_cm() and i4_adm_cm() visit the same pixels: the
+ * first and last row only when they lie in the band and within the border,
+ * with their missing neighbours mirrored as rows 1, 0, 1 and h - 2, h - 1,
+ * h - 1, and columns 0 and w - 1 likewise. The sum of every row is rounded
+ * into the accumulators on its own, so the kernels below go row by row and
+ * leave the mirrored columns to a scalar helper.
+ */
+typedef struct AdmCmParams {
+    int w, h;
+    int src_stride, csf_a_stride;
+    int left, right, start_col, end_col;
+    const void *src[3];
+    const void *angles[3];
+    const void *flt_angles[3];
+    uint32_t rfactor[3];
+    int32_t shift_sub[3];
+    int32_t add_shift_sq[3], shift_sq[3];
+    uint32_t add_shift_cub[3], shift_cub[3];
+    int32_t add_bef_shift_dst, add_bef_shift_flt;
+} AdmCmParams;
+
+static inline void adm_cm_accum(int32_t x, int32_t thr, const AdmCmParams *p,
+                                int theta, int64_t *accum_inner)
+{
+    x = abs(x) - ((int32_t)(thr) << p->shift_sub[theta]);
+    x = x < 0 ? 0 : x;
+    const int32_t x_sq = (int32_t)((((int64_t)x * x) + p->add_shift_sq[theta])
+                                   >> p->shift_sq[theta]);
+    accum_inner[theta] += (((int64_t)x_sq * x) + p->add_shift_cub[theta])
+                          >> p->shift_cub[theta];
+}
+
+static inline void i4_adm_cm_accum(int32_t x, int32_t thr,
+                                   const AdmCmParams *p, int theta,
+                                   int64_t *accum_inner)
+{
+    x = abs(x) - (thr >> p->shift_sub[theta]);
+    x = x < 0 ? 0 : x;
+    const int32_t x_sq = (int32_t)((((int64_t)x * x) + p->add_shift_sq[theta])
+                                   >> p->shift_sq[theta]);
+    accum_inner[theta] += (((int64_t)x_sq * x) + p->add_shift_cub[theta])
+                          >> p->shift_cub[theta];
+}
+
+/* Pixel (i, j) with neighbour rows ia, ib and columns ja, jb. */
+static void adm_cm_pixel(const AdmCmParams *p, int i, int ia, int ib, int j,
+                         int ja, int jb, int64_t *accum_inner)
+{
+    const int cs = p->csf_a_stride;
+    int32_t thr = 0;
+
+    for (int theta = 0; theta < 3; ++theta) {
+        const int16_t *src_ptr = p->angles[theta];
+        const int16_t *flt_ptr = p->flt_angles[theta];
+        int32_t sum = 0;
+        sum += flt_ptr[ia * cs + ja];
+        sum += flt_ptr[ia * cs + j];
+        sum += flt_ptr[ia * cs + jb];
+        sum += flt_ptr[i * cs + ja];
+        sum += (int16_t)(((ONE_BY_15 * abs((int32_t)src_ptr[i * cs + j])) + 2048) >> 12);
+        sum += flt_ptr[i * cs + jb];
+        sum += flt_ptr[ib * cs + ja];
+        sum += flt_ptr[ib * cs + j];
+        sum += flt_ptr[ib * cs + jb];
+        thr += sum;
+    }
+
+    for (int theta = 0; theta < 3; ++theta) {
+        const int16_t *src = p->src[theta];
+        const int32_t x = src[i * p->src_stride + j] * (int32_t)p->rfactor[theta];
+        adm_cm_accum(x, thr, p, theta, accum_inner);
+    }
+}
+
+static void i4_adm_cm_pixel(const AdmCmParams *p, int i, int ia, int ib, int j,
+                            int ja, int jb, int64_t *accum_inner)
+{
+    const int cs = p->csf_a_stride;
+    int32_t thr = 0;
+
+    for (int theta = 0; theta < 3; ++theta) {
+        const int32_t *src_ptr = p->angles[theta];
+        const int32_t *flt_ptr = p->flt_angles[theta];
+        int32_t sum = 0;
+        sum += flt_ptr[ia * cs + ja];
+        sum += flt_ptr[ia * cs + j];
+        sum += flt_ptr[ia * cs + jb];
+        sum += flt_ptr[i * cs + ja];
+        sum += (int32_t)((((int64_t)I4_ONE_BY_15 * abs(src_ptr[i * cs + j])) +
+                          p->add_bef_shift_flt) >> 32);
+        sum += flt_ptr[i * cs + jb];
+        sum += flt_ptr[ib * cs + ja];
+        sum += flt_ptr[ib * cs + j];
+        sum += flt_ptr[ib * cs + jb];
+        thr += sum;
+    }
+
+    for (int theta = 0; theta < 3; ++theta) {
+        const int32_t *src = p->src[theta];
+        const int32_t x = (int32_t)((((int64_t)src[i * p->src_stride + j] *
+                                      p->rfactor[theta]) +
+                                     p->add_bef_shift_dst) >> 28);
+        i4_adm_cm_accum(x, thr, p, theta, accum_inner);
+    }
+}
+
+/*
+ * Adds the cubes of 16 lanes of x reduced by thr_sub to 8 x int64_t sums,
+ * thr_sub being thr shifted as the C code does.
+ */
+static inline void adm_cm_accum_16(__m512i x, __m512i thr_sub,
+                                   const AdmCmParams *p, int theta,
+                                   __m512i *accum)
+{
+    const __m512i add_sq = _mm512_set1_epi64(p->add_shift_sq[theta]);
+    const __m512i add_cub = _mm512_set1_epi64(p->add_shift_cub[theta]);
+    const __m128i shift_sq = _mm_cvtsi32_si128(p->shift_sq[theta]);
+    const __m128i shift_cub = _mm_cvtsi32_si128(p->shift_cub[theta] & 63);
+
+    x = _mm512_sub_epi32(_mm512_abs_epi32(x), thr_sub);
+    x = _mm512_max_epi32(x, _mm512_setzero_si512());
+    const __m512i x_odd = _mm512_srli_epi64(x, 32);
+
+    // x_sq is the low 32 bits of the shifted square
+    const __m512i sq_even = _mm512_srl_epi64(
+        _mm512_add_epi64(_mm512_mul_epu32(x, x), add_sq), shift_sq);
+    const __m512i sq_odd = _mm512_srl_epi64(
+        _mm512_add_epi64(_mm512_mul_epu32(x_odd, x_odd), add_sq), shift_sq);
+
+    const __m512i val_even = _mm512_sra_epi64(
+        _mm512_add_epi64(_mm512_mul_epi32(sq_even, x), add_cub), shift_cub);
+    const __m512i val_odd = _mm512_sra_epi64(
+        _mm512_add_epi64(_mm512_mul_epi32(sq_odd, x_odd), add_cub), shift_cub);
+    *accum = _mm512_add_epi64(*accum, _mm512_add_epi64(val_even, val_odd));
+}
+
+static inline __m512i load_epi16_epi32(const int16_t *p)
+{
+    return _mm512_cvtepi16_epi32(_mm256_loadu_si256((const __m256i *)p));
+}
+
+static void adm_cm_row(const AdmCmParams *p, int i, int ia, int ib,
+                       int64_t *accum_inner)
+{
+    const int cs = p->csf_a_stride;
+    const __m512i one_by_15 = _mm512_set1_epi32(ONE_BY_15);
+    const __m512i add_thr = _mm512_set1_epi32(2048);
+    __m512i accum[3] = {
+        _mm512_setzero_si512(), _mm512_setzero_si512(), _mm512_setzero_si512()
+    };
+
+    if (p->left <= 0)
+        adm_cm_pixel(p, i, ia, ib, 0, 1, 1, accum_inner);
+
+    int j = p->start_col;
+    for (; j + 16 <= p->end_col; j += 16) {
+        __m512i thr = _mm512_setzero_si512();
+        for (int theta = 0; theta < 3; ++theta) {
+            const int16_t *src_ptr = p->angles[theta];
+            const int16_t *flt_a = (const int16_t *)p->flt_angles[theta] + ia * cs + j;
+            const int16_t *flt_i = (const int16_t *)p->flt_angles[theta] + i * cs + j;
+            const int16_t *flt_b = (const int16_t *)p->flt_angles[theta] + ib * cs + j;
+
+            __m512i sum = _mm512_add_epi32(load_epi16_epi32(flt_a - 1),
+                                           load_epi16_epi32(flt_a));
+            sum = _mm512_add_epi32(sum, load_epi16_epi32(flt_a + 1));
+            sum = _mm512_add_epi32(sum, load_epi16_epi32(flt_i - 1));
+            sum = _mm512_add_epi32(sum, load_epi16_epi32(flt_i + 1));
+            sum = _mm512_add_epi32(sum, load_epi16_epi32(flt_b - 1));
+            sum = _mm512_add_epi32(sum, load_epi16_epi32(flt_b));
+            sum = _mm512_add_epi32(sum, load_epi16_epi32(flt_b + 1));
+
+            __m512i c = _mm512_abs_epi32(load_epi16_epi32(src_ptr + i * cs + j));
+            c = _mm512_add_epi32(_mm512_mullo_epi32(c, one_by_15), add_thr);
+            c = _mm512_srai_epi32(c, 12);
+            c = _mm512_srai_epi32(_mm512_slli_epi32(c, 16), 16);
+            thr = _mm512_add_epi32(thr, _mm512_add_epi32(sum, c));
+        }
+
+        for (int theta = 0; theta < 3; ++theta) {
+            const int16_t *src = p->src[theta];
+            const __m512i x = _mm512_mullo_epi32(
+                load_epi16_epi32(src + i * p->src_stride + j),
+                _mm512_set1_epi32(p->rfactor[theta]));
+            const __m512i thr_sub = _mm512_sll_epi32(
+                thr, _mm_cvtsi32_si128(p->shift_sub[theta]));
+            adm_cm_accum_16(x, thr_sub, p, theta, &accum[theta]);
+        }
+    }
+    for (; j < p->end_col; ++j)
+        adm_cm_pixel(p, i, ia, ib, j, j - 1, j + 1, accum_inner);
+
+    if (p->right > (p->w - 1))
+        adm_cm_pixel(p, i, ia, ib, p->w - 1, p->w - 2, p->w - 1, accum_inner);
+
+    for (int theta = 0; theta < 3; ++theta)
+        accum_inner[theta] += _mm512_reduce_add_epi64(accum[theta]);
+}
+
+static void i4_adm_cm_row(const AdmCmParams *p, int i, int ia, int ib,
+                          int64_t *accum_inner)
+{
+    const int cs = p->csf_a_stride;
+    const __m512i one_by_15 = _mm512_set1_epi64(I4_ONE_BY_15);
+    const __m512i add_thr = _mm512_set1_epi64(p->add_bef_shift_flt);
+    const __m512i add_dst = _mm512_set1_epi64(p->add_bef_shift_dst);
+    __m512i accum[3] = {
+        _mm512_setzero_si512(), _mm512_setzero_si512(), _mm512_setzero_si512()
+    };
+
+    if (p->left <= 0)
+        i4_adm_cm_pixel(p, i, ia, ib, 0, 1, 1, accum_inner);
+
+    int j = p->start_col;
+    for (; j + 16 <= p->end_col; j += 16) {
+        __m512i thr = _mm512_setzero_si512();
+        for (int theta = 0; theta < 3; ++theta) {
+            const int32_t *src_ptr = p->angles[theta];
+            const int32_t *flt_a = (const int32_t *)p->flt_angles[theta] + ia * cs + j;
+            const int32_t *flt_i = (const int32_t *)p->flt_angles[theta] + i * cs + j;
+            const int32_t *flt_b = (const int32_t *)p->flt_angles[theta] + ib * cs + j;
+
+            __m512i sum = _mm512_add_epi32(_mm512_loadu_si512(flt_a - 1),
+                                           _mm512_loadu_si512(flt_a));
+            sum = _mm512_add_epi32(sum, _mm512_loadu_si512(flt_a + 1));
+            sum = _mm512_add_epi32(sum, _mm512_loadu_si512(flt_i - 1));
+            sum = _mm512_add_epi32(sum, _mm512_loadu_si512(flt_i + 1));
+            sum = _mm512_add_epi32(sum, _mm512_loadu_si512(flt_b - 1));
+            sum = _mm512_add_epi32(sum, _mm512_loadu_si512(flt_b));
+            sum = _mm512_add_epi32(sum, _mm512_loadu_si512(flt_b + 1));
+
+            const __m512i c = i4_mul_abs_hi(
+                _mm512_loadu_si512(src_ptr + i * cs + j), one_by_15, add_thr);
+            thr = _mm512_add_epi32(thr, _mm512_add_epi32(sum, c));
+        }
+
+        for (int theta = 0; theta < 3; ++theta) {
+            const int32_t *src = p->src[theta];
+            const __m512i x = i4_mul_rfactor(
+                _mm512_loadu_si512(src + i * p->src_stride + j),
+                _mm512_set1_epi64(p->rfactor[theta]), add_dst);
+            const __m512i thr_sub = _mm512_sra_epi32(
+                thr, _mm_cvtsi32_si128(p->shift_sub[theta]));
+            adm_cm_accum_16(x, thr_sub, p, theta, &accum[theta]);
+        }
+    }
+    for (; j < p->end_col; ++j)
+        i4_adm_cm_pixel(p, i, ia, ib, j, j - 1, j + 1, accum_inner);
+
+    if (p->right > (p->w - 1))
+        i4_adm_cm_pixel(p, i, ia, ib, p->w - 1, p->w - 2, p->w - 1, accum_inner);
+
+    for (int theta = 0; theta < 3; ++theta)
+        accum_inner[theta] += _mm512_reduce_add_epi64(accum[theta]);
+}
+
+/*
+ * (uint32_t)pow(2, shift - 1) as the C code gets it on x86-64. For a shift of
+ * 0 the power is out of range of uint32_t, which converts to 0 there but to
+ * UINT32_MAX with AVX-512 enabled, so it is not left to the compiler here.
+ */
+static inline uint32_t add_shift(uint32_t shift)
+{
+    return shift - 1 < 32 ? 1u << (shift - 1) : 0;
+}
+
+static void adm_cm_rows(const AdmCmParams *p, int row_start, int row_end,
+                        void (*row)(const AdmCmParams *p, int i, int ia,
+                                    int ib, int64_t *accum_inner),
+                        int64_t *accum)
+{
+    const int h = p->h;
+
+    const uint32_t shift_inner_accum = (uint32_t)ceil(log2(h));
+    const uint32_t add_shift_inner_accum = add_shift(shift_inner_accum);
+
+    const int top = h * ADM_BORDER_FACTOR - 0.5;
+    const int bottom = h - top;
+    const int start_row = MAX((top > 1) ? top : 1, row_start);
+    const int end_row = MIN((bottom < (h - 1)) ? bottom : (h - 1), row_end);
+
+    int64_t accum_out[3] = { 0 };
+    int64_t accum_inner[3];
+
+    memset(accum_inner, 0, sizeof(accum_inner));
+    if ((row_start == 0) && (top <= 0))
+        row(p, 0, 1, 1, accum_inner);
+    for (int theta = 0; theta < 3; ++theta)
+        accum_out[theta] += (accum_inner[theta] + add_shift_inner_accum) >> shift_inner_accum;
+
+    for (int i = start_row; i < end_row; ++i) {
+        memset(accum_inner, 0, sizeof(accum_inner));
+        row(p, i, i - 1, i + 1, accum_inner);
+        for (int theta = 0; theta < 3; ++theta)
+            accum_out[theta] += (accum_inner[theta] + add_shift_inner_accum) >> shift_inner_accum;
+    }
+
+    memset(accum_inner, 0, sizeof(accum_inner));
+    if ((row_end == h) && (bottom > (h - 1)))
+        row(p, h - 1, h - 2, h - 1, accum_inner);
+    for (int theta = 0; theta < 3; ++theta)
+        accum_out[theta] += (accum_inner[theta] + add_shift_inner_accum) >> shift_inner_accum;
+
+    for (int theta = 0; theta < 3; ++theta)
+        accum[theta] += accum_out[theta];
+}
+
+static void adm_cm_params(AdmCmParams *p, int w, int h, int src_stride,
+                          int csf_a_stride)
+{
+    p->w = w;
+    p->h = h;
+    p->src_stride = src_stride;
+    p->csf_a_stride = csf_a_stride;
+
+    p->left = w * ADM_BORDER_FACTOR - 0.5;
+    p->right = w - p->left;
+    p->start_col = (p->left > 1) ? p->left : 1;
+    p->end_col = (p->right < (w - 1)) ? p->right : (w - 1);
+}
+
+void adm_cm_avx512(AdmBuffer *buf, int w, int h, int src_stride,
+                   int csf_a_stride, int row_start, int row_end,
+                   int64_t *accum)
+{
+    const adm_dwt_band_t *src = &buf->decouple_r;
+    const adm_dwt_band_t *csf_f = &buf->csf_f;
+    const adm_dwt_band_t *csf_a = &buf->csf_a;
+
+    // see adm_cm() for the fixed-point format of these
+    const uint32_t shift_xhcub = (uint32_t)ceil(log2(w) - 4);
+    const uint32_t add_shift_xhcub = add_shift(shift_xhcub);
+    const uint32_t shift_xdcub = (uint32_t)ceil(log2(w) - 3);
+    const uint32_t add_shift_xdcub = add_shift(shift_xdcub);
+
+    AdmCmParams p = {
+        .src = { src->band_h, src->band_v, src->band_d },
+        .angles = { csf_a->band_h, csf_a->band_v, csf_a->band_d },
+        .flt_angles = { csf_f->band_h, csf_f->band_v, csf_f->band_d },
+        .rfactor = { 36453, 36453, 49417 },
+        .shift_sub = { 10, 10, 12 },
+        .add_shift_sq = { 268435456, 268435456, 536870912 },
+        .shift_sq = { 29, 29, 30 },
+        .add_shift_cub = { add_shift_xhcub, add_shift_xhcub, add_shift_xdcub },
+        .shift_cub = { shift_xhcub, shift_xhcub, shift_xdcub },
+    };
+    adm_cm_params(&p, w, h, src_stride, csf_a_stride);
+
+    adm_cm_rows(&p, row_start, row_end, adm_cm_row, accum);
+}
+
+void i4_adm_cm_avx512(AdmBuffer *buf, int w, int h, int src_stride,
+                      int csf_a_stride, int scale, int row_start, int row_end,
+                      int64_t *accum)
+{
+    const i4_adm_dwt_band_t *src = &buf->i4_decouple_r;
+    const i4_adm_dwt_band_t *csf_f = &buf->i4_csf_f;
+    const i4_adm_dwt_band_t *csf_a = &buf->i4_csf_a;
+
+    // see i4_adm_cm() for the fixed-point format of these
+    float factor1 = dwt_quant_step(&dwt_7_9_YCbCr_threshold[0], scale, 1);
+    float factor2 = dwt_quant_step(&dwt_7_9_YCbCr_threshold[0], scale, 2);
+    float rfactor1[3] = { 1.0f / factor1, 1.0f / factor1, 1.0f / factor2 };
+
+    const int32_t shift_flt = 32;
+    uint32_t shift_cub = (uint32_t)ceil(log2(w));
+    uint32_t add_shift_cub = add_shift(shift_cub);
+
+    AdmCmParams p = {
+        .src = { src->band_h, src->band_v, src->band_d },
+        .angles = { csf_a->band_h, csf_a->band_v, csf_a->band_d },
+        .flt_angles = { csf_f->band_h, csf_f->band_v, csf_f->band_d },
+        .rfactor = { (uint32_t)(rfactor1[0] * pow(2, 32)),
+                     (uint32_t)(rfactor1[1] * pow(2, 32)),
+                     (uint32_t)(rfactor1[2] * pow(2, 32)) },
+        .shift_sub = { 0, 0, 0 },
+        .add_shift_sq = { 536870912, 536870912, 536870912 },
+        .shift_sq = { 30, 30, 30 },
+        .add_shift_cub = { add_shift_cub, add_shift_cub, add_shift_cub },
+        .shift_cub = { shift_cub, shift_cub, shift_cub },
+        .add_bef_shift_dst = (int32_t)(1 << (28 - 1)),
+        .add_bef_shift_flt = (int32_t)(1 << (shift_flt - 1)),
+    };
+    adm_cm_params(&p, w, h, src_stride, csf_a_stride);
+
+    adm_cm_rows(&p, row_start, row_end, i4_adm_cm_row, accum);
+}
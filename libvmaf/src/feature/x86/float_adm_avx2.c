@@ -0,0 +1,565 @@
+/**
+ *
+ *  Copyright 2016-2020 Netflix, Inc.
+ *
+ *     Licensed under the BSD+Patent License (the "License");
+ *     you may not use this file except in compliance with the License.
+ *     You may obtain a copy of the License at
+ *
+ *         https://opensource.org/licenses/BSDplusPatent
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *
+ */
+
+#include <immintrin.h>
+#include <math.h>
+#include <stddef.h>
+
+#include "feature/adm_options.h"
+#include "float_adm_avx2.h"
+
+/*
+ * Per-pixel arithmetic mirrors adm_tools.c operation for operation (no FMA,
+ * same association, double where the scalar code promotes to double), so
+ * every intermediate band is bit-identical to the C path. Only the cube sums
+ * differ: each row is accumulated across 8 lanes before being folded into
+ * the frame total.
+ */
+
+#define FLOAT_ONE_BY_30 0.0333333351
+#define FLOAT_ONE_BY_15 0.0666666701
+
+static const float dwt2_db2_coeffs_lo_s[4] = { 0.482962913144690, 0.836516303737469, 0.224143868041857, -0.129409522550921 };
+static const float dwt2_db2_coeffs_hi_s[4] = { -0.129409522550921, -0.224143868041857, 0.836516303737469, -0.482962913144690 };
+
+static inline __m256i tail_mask(int n)
+{
+    return _mm256_cmpgt_epi32(_mm256_set1_epi32(n),
+                              _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+}
+
+static inline __m256 abs_ps(__m256 x)
+{
+    return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x);
+}
+
+static inline __m256 cube_ps(__m256 x)
+{
+    return _mm256_mul_ps(_mm256_mul_ps(x, x), x);
+}
+
+static inline float hsum_ps(__m256 x)
+{
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(x),
+                          _mm256_extractf128_ps(x, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+
+/* (float)(c * (double)x), lane by lane */
+static inline __m256 mul_pd_ps(double c, __m256 x)
+{
+    const __m256d vc = _mm256_set1_pd(c);
+    __m128 lo = _mm256_cvtpd_ps(_mm256_mul_pd(vc,
+                    _mm256_cvtps_pd(_mm256_castps256_ps128(x))));
+    __m128 hi = _mm256_cvtpd_ps(_mm256_mul_pd(vc,
+                    _mm256_cvtps_pd(_mm256_extractf128_ps(x, 1))));
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+}
+
+/* (float)((double)s + c * (double)x), lane by lane */
+static inline __m256 add_mul_pd_ps(__m256 s, double c, __m256 x)
+{
+    const __m256d vc = _mm256_set1_pd(c);
+    __m256d lo = _mm256_add_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(s)),
+                 _mm256_mul_pd(vc, _mm256_cvtps_pd(_mm256_castps256_ps128(x))));
+    __m256d hi = _mm256_add_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(s, 1)),
+                 _mm256_mul_pd(vc, _mm256_cvtps_pd(_mm256_extractf128_ps(x, 1))));
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(lo)),
+                                _mm256_cvtpd_ps(hi), 1);
+}
+
+/* rcp_s() from adm_tools.c: one Newton-Raphson step on the 12-bit estimate */
+static inline __m256 rcp_nr_ps(__m256 x)
+{
+    const __m256 xi = _mm256_rcp_ps(x);
+    return _mm256_add_ps(xi, _mm256_mul_ps(xi,
+               _mm256_sub_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(x, xi))));
+}
+
+static inline __m256 load_ps(const float *p, __m256i m, int tail)
+{
+    return tail ? _mm256_maskload_ps(p, m) : _mm256_loadu_ps(p);
+}
+
+static inline void store_ps(float *p, __m256 x, __m256i m, int tail)
+{
+    if (tail)
+        _mm256_maskstore_ps(p, m, x);
+    else
+        _mm256_storeu_ps(p, x);
+}
+
+float adm_sum_cube_s_avx2(const float *x, int w, int h, int stride,
+                          double border_factor)
+{
+    int px_stride = stride / sizeof(float);
+    int left   = w * border_factor - 0.5;
+    int top    = h * border_factor - 0.5;
+    int right  = w - left;
+    int bottom = h - top;
+
+    float accum = 0;
+
+    for (int i = top; i < bottom; ++i) {
+        const float *row = x + i * px_stride;
+        __m256 acc = _mm256_setzero_ps();
+        int j;
+
+        for (j = left; j + 8 <= right; j += 8)
+            acc = _mm256_add_ps(acc, cube_ps(abs_ps(_mm256_loadu_ps(row + j))));
+        if (j < right) {
+            __m256 v = _mm256_maskload_ps(row + j, tail_mask(right - j));
+            acc = _mm256_add_ps(acc, cube_ps(abs_ps(v)));
+        }
+
+        accum += hsum_ps(acc);
+    }
+
+    return powf(accum, 1.0f / 3.0f) + powf((bottom - top) * (right - left) / 32.0f, 1.0f / 3.0f);
+}
+
+static inline void decouple_band(__m256 o, __m256 t, __m256 angle_flag,
+                                 __m256 gain_limit, __m256 *rst_out,
+                                 __m256 *a_out)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    __m256 k = _mm256_mul_ps(t, rcp_nr_ps(_mm256_add_ps(o, _mm256_set1_ps(1e-30f))));
+    k = _mm256_max_ps(zero, _mm256_min_ps(one, k));
+    __m256 rst = _mm256_mul_ps(k, o);
+
+    __m256 pos = _mm256_and_ps(angle_flag, _mm256_cmp_ps(rst, zero, _CMP_GT_OQ));
+    rst = _mm256_blendv_ps(rst, _mm256_min_ps(_mm256_mul_ps(rst, gain_limit), t), pos);
+    __m256 neg = _mm256_and_ps(angle_flag, _mm256_cmp_ps(rst, zero, _CMP_LT_OQ));
+    rst = _mm256_blendv_ps(rst, _mm256_max_ps(_mm256_mul_ps(rst, gain_limit), t), neg);
+
+    *rst_out = rst;
+    *a_out = _mm256_sub_ps(t, rst);
+}
+
+static inline void decouple_block(const adm_dwt_band_t_s *ref,
+                                  const adm_dwt_band_t_s *dis,
+                                  const adm_dwt_band_t_s *r,
+                                  const adm_dwt_band_t_s *a, int ref_off,
+                                  int dis_off, int r_off, int a_off,
+                                  __m256 cos_1deg_sq, __m256 gain_limit,
+                                  __m256i m, int tail)
+{
+    const __m256 oh = load_ps(ref->band_h + ref_off, m, tail);
+    const __m256 ov = load_ps(ref->band_v + ref_off, m, tail);
+    const __m256 od = load_ps(ref->band_d + ref_off, m, tail);
+    const __m256 th = load_ps(dis->band_h + dis_off, m, tail);
+    const __m256 tv = load_ps(dis->band_v + dis_off, m, tail);
+    const __m256 td = load_ps(dis->band_d + dis_off, m, tail);
+
+    __m256 ot_dp = _mm256_add_ps(_mm256_mul_ps(oh, th), _mm256_mul_ps(ov, tv));
+    __m256 o_mag_sq = _mm256_add_ps(_mm256_mul_ps(oh, oh), _mm256_mul_ps(ov, ov));
+    __m256 t_mag_sq = _mm256_add_ps(_mm256_mul_ps(th, th), _mm256_mul_ps(tv, tv));
+    __m256 angle_flag = _mm256_and_ps(
+        _mm256_cmp_ps(ot_dp, _mm256_setzero_ps(), _CMP_GE_OQ),
+        _mm256_cmp_ps(_mm256_mul_ps(ot_dp, ot_dp),
+                      _mm256_mul_ps(_mm256_mul_ps(cos_1deg_sq, o_mag_sq), t_mag_sq),
+                      _CMP_GE_OQ));
+
+    __m256 rst, diff;
+    decouple_band(oh, th, angle_flag, gain_limit, &rst, &diff);
+    store_ps(r->band_h + r_off, rst, m, tail);
+    store_ps(a->band_h + a_off, diff, m, tail);
+    decouple_band(ov, tv, angle_flag, gain_limit, &rst, &diff);
+    store_ps(r->band_v + r_off, rst, m, tail);
+    store_ps(a->band_v + a_off, diff, m, tail);
+    decouple_band(od, td, angle_flag, gain_limit, &rst, &diff);
+    store_ps(r->band_d + r_off, rst, m, tail);
+    store_ps(a->band_d + a_off, diff, m, tail);
+}
+
+/*
+ * The scalar path scales by adm_enhn_gain_limit in double; the caller only
+ * dispatches here when the limit is exactly representable as a float, in
+ * which case the single precision product rounds identically.
+ */
+void adm_decouple_s_avx2(const adm_dwt_band_t_s *ref,
+                         const adm_dwt_band_t_s *dis,
+                         const adm_dwt_band_t_s *r, const adm_dwt_band_t_s *a,
+                         int w, int h, int ref_stride, int dis_stride,
+                         int r_stride, int a_stride, double border_factor,
+                         double adm_enhn_gain_limit)
+{
+    const float cos_1deg_sq = cos(1.0 * M_PI / 180.0) * cos(1.0 * M_PI / 180.0);
+    const __m256 vcos_1deg_sq = _mm256_set1_ps(cos_1deg_sq);
+    const __m256 gain_limit = _mm256_set1_ps((float)adm_enhn_gain_limit);
+
+    int ref_px_stride = ref_stride / sizeof(float);
+    int dis_px_stride = dis_stride / sizeof(float);
+    int r_px_stride = r_stride / sizeof(float);
+    int a_px_stride = a_stride / sizeof(float);
+
+    int left = w * border_factor - 0.5 - 1; // -1 for filter tap
+    int top = h * border_factor - 0.5 - 1;
+    int right = w - left + 2; // +2 for filter tap
+    int bottom = h - top + 2;
+
+    if (left < 0) left = 0;
+    if (right > w) right = w;
+    if (top < 0) top = 0;
+    if (bottom > h) bottom = h;
+
+    const __m256i m = tail_mask((right - left) % 8);
+
+    for (int i = top; i < bottom; ++i) {
+        int j;
+        for (j = left; j + 8 <= right; j += 8) {
+            decouple_block(ref, dis, r, a, i * ref_px_stride + j,
+                           i * dis_px_stride + j, i * r_px_stride + j,
+                           i * a_px_stride + j, vcos_1deg_sq, gain_limit,
+                           m, 0);
+        }
+        if (j < right) {
+            decouple_block(ref, dis, r, a, i * ref_px_stride + j,
+                           i * dis_px_stride + j, i * r_px_stride + j,
+                           i * a_px_stride + j, vcos_1deg_sq, gain_limit,
+                           m, 1);
+        }
+    }
+}
+
+void adm_csf_s_avx2(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *dst,
+                    const adm_dwt_band_t_s *flt, int orig_h, int scale, int w,
+                    int h, int src_stride, int dst_stride,
+                    double border_factor)
+{
+    (void) orig_h;
+    const float *src_angles[3] = { src->band_h, src->band_v, src->band_d };
+    float *dst_angles[3] = { dst->band_h, dst->band_v, dst->band_d };
+    float *flt_angles[3] = { flt->band_h, flt->band_v, flt->band_d };
+
+    int src_px_stride = src_stride / sizeof(float);
+    int dst_px_stride = dst_stride / sizeof(float);
+
+    float factor1 = dwt_quant_step(&dwt_7_9_YCbCr_threshold[0], scale, 1);
+    float factor2 = dwt_quant_step(&dwt_7_9_YCbCr_threshold[0], scale, 2);
+    float rfactor[3] = { 1.0f / factor1, 1.0f / factor1, 1.0f / factor2 };
+
+    int left = w * border_factor - 0.5 - 1; // -1 for filter tap
+    int top = h * border_factor - 0.5 - 1;
+    int right = w - left + 2; // +2 for filter tap
+    int bottom = h - top + 2;
+
+    if (left < 0) left = 0;
+    if (right > w) right = w;
+    if (top < 0) top = 0;
+    if (bottom > h) bottom = h;
+
+    const __m256i m = tail_mask((right - left) % 8);
+
+    for (int theta = 0; theta < 3; ++theta) {
+        const __m256 rf = _mm256_set1_ps(rfactor[theta]);
+
+        for (int i = top; i < bottom; ++i) {
+            const float *src_ptr = src_angles[theta] + i * src_px_stride;
+            float *dst_ptr = dst_angles[theta] + i * dst_px_stride;
+            float *flt_ptr = flt_angles[theta] + i * dst_px_stride;
+            int j;
+
+            for (j = left; j + 8 <= right; j += 8) {
+                __m256 dst_val = _mm256_mul_ps(rf, _mm256_loadu_ps(src_ptr + j));
+                _mm256_storeu_ps(dst_ptr + j, dst_val);
+                _mm256_storeu_ps(flt_ptr + j,
+                                 mul_pd_ps(FLOAT_ONE_BY_30, abs_ps(dst_val)));
+            }
+            if (j < right) {
+                __m256 dst_val = _mm256_mul_ps(rf, _mm256_maskload_ps(src_ptr + j, m));
+                _mm256_maskstore_ps(dst_ptr + j, m, dst_val);
+                _mm256_maskstore_ps(flt_ptr + j, m,
+                                    mul_pd_ps(FLOAT_ONE_BY_30, abs_ps(dst_val)));
+            }
+        }
+    }
+}
+
+float adm_csf_den_scale_s_avx2(const adm_dwt_band_t_s *src, int orig_h,
+                               int scale, int w, int h, int src_stride,
+                               double border_factor)
+{
+    (void) orig_h;
+    int src_px_stride = src_stride / sizeof(float);
+
+    float factor1 = dwt_quant_step(&dwt_7_9_YCbCr_threshold[0], scale, 1);
+    float factor2 = dwt_quant_step(&dwt_7_9_YCbCr_threshold[0], scale, 2);
+    const __m256 rf1 = _mm256_set1_ps(1.0f / factor1);
+    const __m256 rf2 = _mm256_set1_ps(1.0f / factor2);
+
+    float accum_h = 0, accum_v = 0, accum_d = 0;
+    float den_scale_h, den_scale_v, den_scale_d;
+
+    int left = w * border_factor - 0.5;
+    int top = h * border_factor - 0.5;
+    int right = w - left;
+    int bottom = h - top;
+
+    const __m256i m = tail_mask((right - left) % 8);
+
+    for (int i = top; i < bottom; ++i) {
+        const float *src_h = src->band_h + i * src_px_stride;
+        const float *src_v = src->band_v + i * src_px_stride;
+        const float *src_d = src->band_d + i * src_px_stride;
+        __m256 acc_h = _mm256_setzero_ps();
+        __m256 acc_v = _mm256_setzero_ps();
+        __m256 acc_d = _mm256_setzero_ps();
+        int j;
+
+        for (j = left; j + 8 <= right; j += 8) {
+            acc_h = _mm256_add_ps(acc_h, cube_ps(abs_ps(_mm256_mul_ps(rf1, _mm256_loadu_ps(src_h + j)))));
+            acc_v = _mm256_add_ps(acc_v, cube_ps(abs_ps(_mm256_mul_ps(rf1, _mm256_loadu_ps(src_v + j)))));
+            acc_d = _mm256_add_ps(acc_d, cube_ps(abs_ps(_mm256_mul_ps(rf2, _mm256_loadu_ps(src_d + j)))));
+        }
+        if (j < right) {
+            acc_h = _mm256_add_ps(acc_h, cube_ps(abs_ps(_mm256_mul_ps(rf1, _mm256_maskload_ps(src_h + j, m)))));
+            acc_v = _mm256_add_ps(acc_v, cube_ps(abs_ps(_mm256_mul_ps(rf1, _mm256_maskload_ps(src_v + j, m)))));
+            acc_d = _mm256_add_ps(acc_d, cube_ps(abs_ps(_mm256_mul_ps(rf2, _mm256_maskload_ps(src_d + j, m)))));
+        }
+
+        accum_h += hsum_ps(acc_h);
+        accum_v += hsum_ps(acc_v);
+        accum_d += hsum_ps(acc_d);
+    }
+
+    den_scale_h = powf(accum_h, 1.0f / 3.0f) + powf((bottom - top) * (right - left) / 32.0f, 1.0f / 3.0f);
+    den_scale_v = powf(accum_v, 1.0f / 3.0f) + powf((bottom - top) * (right - left) / 32.0f, 1.0f / 3.0f);
+    den_scale_d = powf(accum_d, 1.0f / 3.0f) + powf((bottom - top) * (right - left) / 32.0f, 1.0f / 3.0f);
+
+    return den_scale_h + den_scale_v + den_scale_d;
+}
+
+/* ADM_CM_THRESH_S_I_J for 8 adjacent columns of one band */
+static inline __m256 cm_thresh_band(const float *a, const float *f,
+                                    int stride, __m256i m, int tail)
+{
+    const float *f0 = f - stride, *f2 = f + stride;
+    __m256 sum = _mm256_add_ps(_mm256_setzero_ps(), load_ps(f0 - 1, m, tail));
+    sum = _mm256_add_ps(sum, load_ps(f0, m, tail));
+    sum = _mm256_add_ps(sum, load_ps(f0 + 1, m, tail));
+    sum = _mm256_add_ps(sum, load_ps(f - 1, m, tail));
+    sum = add_mul_pd_ps(sum, FLOAT_ONE_BY_15, abs_ps(load_ps(a, m, tail)));
+    sum = _mm256_add_ps(sum, load_ps(f + 1, m, tail));
+    sum = _mm256_add_ps(sum, load_ps(f2 - 1, m, tail));
+    sum = _mm256_add_ps(sum, load_ps(f2, m, tail));
+    sum = _mm256_add_ps(sum, load_ps(f2 + 1, m, tail));
+    return sum;
+}
+
+static inline __m256 cm_val(__m256 x, __m256 rf, __m256 thr)
+{
+    x = _mm256_sub_ps(abs_ps(_mm256_mul_ps(x, rf)), thr);
+    return cube_ps(_mm256_max_ps(_mm256_setzero_ps(), x));
+}
+
+static inline void cm_block(const float *const src[3], const float *const a[3],
+                            const float *const f[3], const __m256 rf[3],
+                            int stride, __m256 acc[3], __m256i m, int tail)
+{
+    __m256 thr = _mm256_add_ps(_mm256_setzero_ps(),
+                               cm_thresh_band(a[0], f[0], stride, m, tail));
+    thr = _mm256_add_ps(thr, cm_thresh_band(a[1], f[1], stride, m, tail));
+    thr = _mm256_add_ps(thr, cm_thresh_band(a[2], f[2], stride, m, tail));
+
+    for (int theta = 0; theta < 3; ++theta) {
+        __m256 val = cm_val(load_ps(src[theta], m, tail), rf[theta], thr);
+        /* masked lanes load zero everywhere and so contribute zero */
+        acc[theta] = _mm256_add_ps(acc[theta], val);
+    }
+}
+
+/* One interior row (0 < i < h - 1) of adm_cm_s over [start_col, end_col) */
+void adm_cm_row_s_avx2(const adm_dwt_band_t_s *src,
+                       const adm_dwt_band_t_s *csf_f,
+                       const adm_dwt_band_t_s *csf_a, const float *rfactor,
+                       int i, int start_col, int end_col, int src_px_stride,
+                       int csf_px_stride, float *accum_h, float *accum_v,
+                       float *accum_d)
+{
+    const __m256 rf[3] = {
+        _mm256_set1_ps(rfactor[0]), _mm256_set1_ps(rfactor[1]),
+        _mm256_set1_ps(rfactor[2]),
+    };
+    __m256 acc[3] = {
+        _mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps(),
+    };
+    const ptrdiff_t src_off = (ptrdiff_t)i * src_px_stride;
+    const ptrdiff_t csf_off = (ptrdiff_t)i * csf_px_stride;
+    const __m256i m = tail_mask((end_col - start_col) % 8);
+    int j;
+
+    for (j = start_col; j + 8 <= end_col; j += 8) {
+        const float *const s[3] = {
+            src->band_h + src_off + j, src->band_v + src_off + j,
+            src->band_d + src_off + j,
+        };
+        const float *const a[3] = {
+            csf_a->band_h + csf_off + j, csf_a->band_v + csf_off + j,
+            csf_a->band_d + csf_off + j,
+        };
+        const float *const f[3] = {
+            csf_f->band_h + csf_off + j, csf_f->band_v + csf_off + j,
+            csf_f->band_d + csf_off + j,
+        };
+        cm_block(s, a, f, rf, csf_px_stride, acc, m, 0);
+    }
+    if (j < end_col) {
+        const float *const s[3] = {
+            src->band_h + src_off + j, src->band_v + src_off + j,
+            src->band_d + src_off + j,
+        };
+        const float *const a[3] = {
+            csf_a->band_h + csf_off + j, csf_a->band_v + csf_off + j,
+            csf_a->band_d + csf_off + j,
+        };
+        const float *const f[3] = {
+            csf_f->band_h + csf_off + j, csf_f->band_v + csf_off + j,
+            csf_f->band_d + csf_off + j,
+        };
+        cm_block(s, a, f, rf, csf_px_stride, acc, m, 1);
+    }
+
+    *accum_h += hsum_ps(acc[0]);
+    *accum_v += hsum_ps(acc[1]);
+    *accum_d += hsum_ps(acc[2]);
+}
+
+static inline __m256 dwt_filter(const float *fc, __m256 s0, __m256 s1,
+                                __m256 s2, __m256 s3)
+{
+    __m256 accum = _mm256_add_ps(_mm256_setzero_ps(),
+                                 _mm256_mul_ps(_mm256_set1_ps(fc[0]), s0));
+    accum = _mm256_add_ps(accum, _mm256_mul_ps(_mm256_set1_ps(fc[1]), s1));
+    accum = _mm256_add_ps(accum, _mm256_mul_ps(_mm256_set1_ps(fc[2]), s2));
+    accum = _mm256_add_ps(accum, _mm256_mul_ps(_mm256_set1_ps(fc[3]), s3));
+    return accum;
+}
+
+static inline float dwt_filter_px(const float *fc, float s0, float s1,
+                                  float s2, float s3)
+{
+    float accum = 0;
+    accum += fc[0] * s0;
+    accum += fc[1] * s1;
+    accum += fc[2] * s2;
+    accum += fc[3] * s3;
+    return accum;
+}
+
+/* Split 16 consecutive floats into their even and odd elements */
+static inline void deinterleave_ps(const float *p, __m256 *even, __m256 *odd)
+{
+    const __m256 x0 = _mm256_loadu_ps(p);
+    const __m256 x1 = _mm256_loadu_ps(p + 8);
+    const __m256 e = _mm256_shuffle_ps(x0, x1, _MM_SHUFFLE(2, 0, 2, 0));
+    const __m256 o = _mm256_shuffle_ps(x0, x1, _MM_SHUFFLE(3, 1, 3, 1));
+    *even = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(e), 0xd8));
+    *odd = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(o), 0xd8));
+}
+
+static inline void dwt2_h_px(const float *tmp, int **ind_x, int j,
+                             float *lo, float *hi)
+{
+    const float s0 = tmp[ind_x[0][j]];
+    const float s1 = tmp[ind_x[1][j]];
+    const float s2 = tmp[ind_x[2][j]];
+    const float s3 = tmp[ind_x[3][j]];
+    *lo = dwt_filter_px(dwt2_db2_coeffs_lo_s, s0, s1, s2, s3);
+    *hi = dwt_filter_px(dwt2_db2_coeffs_hi_s, s0, s1, s2, s3);
+}
+
+// tmplo and tmphi each hold one row of w floats.
+void adm_dwt2_s_avx2(const float *src, const adm_dwt_band_t_s *dst,
+                     int **ind_y, int **ind_x, int w, int h, int src_stride,
+                     int dst_stride, float *tmplo, float *tmphi)
+{
+    const float *filter_lo = dwt2_db2_coeffs_lo_s;
+    const float *filter_hi = dwt2_db2_coeffs_hi_s;
+
+    int src_px_stride = src_stride / sizeof(float);
+    int dst_px_stride = dst_stride / sizeof(float);
+
+    const int w_out = (w + 1) / 2;
+    const __m256i m = tail_mask(w % 8);
+
+    /*
+     * Columns 1 <= j < j_end read tmp[2j - 1 .. 2j + 2] without mirroring,
+     * and a full vector starting at j reads up to tmp[2j + 16].
+     */
+    int j_end = 1;
+    while (2 * (j_end + 7) + 2 < w)
+        j_end += 8;
+
+    for (int i = 0; i < (h + 1) / 2; ++i) {
+        const float *s0p = src + ind_y[0][i] * src_px_stride;
+        const float *s1p = src + ind_y[1][i] * src_px_stride;
+        const float *s2p = src + ind_y[2][i] * src_px_stride;
+        const float *s3p = src + ind_y[3][i] * src_px_stride;
+        float *band_a = dst->band_a + i * dst_px_stride;
+        float *band_v = dst->band_v + i * dst_px_stride;
+        float *band_h = dst->band_h + i * dst_px_stride;
+        float *band_d = dst->band_d + i * dst_px_stride;
+        int j;
+
+        /* Vertical pass. */
+        for (j = 0; j + 8 <= w; j += 8) {
+            const __m256 s0 = _mm256_loadu_ps(s0p + j);
+            const __m256 s1 = _mm256_loadu_ps(s1p + j);
+            const __m256 s2 = _mm256_loadu_ps(s2p + j);
+            const __m256 s3 = _mm256_loadu_ps(s3p + j);
+            _mm256_storeu_ps(tmplo + j, dwt_filter(filter_lo, s0, s1, s2, s3));
+            _mm256_storeu_ps(tmphi + j, dwt_filter(filter_hi, s0, s1, s2, s3));
+        }
+        if (j < w) {
+            const __m256 s0 = _mm256_maskload_ps(s0p + j, m);
+            const __m256 s1 = _mm256_maskload_ps(s1p + j, m);
+            const __m256 s2 = _mm256_maskload_ps(s2p + j, m);
+            const __m256 s3 = _mm256_maskload_ps(s3p + j, m);
+            _mm256_maskstore_ps(tmplo + j, m, dwt_filter(filter_lo, s0, s1, s2, s3));
+            _mm256_maskstore_ps(tmphi + j, m, dwt_filter(filter_hi, s0, s1, s2, s3));
+        }
+
+        /* Horizontal pass (lo and hi). */
+        dwt2_h_px(tmplo, ind_x, 0, &band_a[0], &band_v[0]);
+        dwt2_h_px(tmphi, ind_x, 0, &band_h[0], &band_d[0]);
+
+        for (j = 1; j < j_end; j += 8) {
+            __m256 s0, s1, s2, s3;
+
+            deinterleave_ps(tmplo + 2 * j - 1, &s0, &s1);
+            deinterleave_ps(tmplo + 2 * j + 1, &s2, &s3);
+            _mm256_storeu_ps(band_a + j, dwt_filter(filter_lo, s0, s1, s2, s3));
+            _mm256_storeu_ps(band_v + j, dwt_filter(filter_hi, s0, s1, s2, s3));
+
+            deinterleave_ps(tmphi + 2 * j - 1, &s0, &s1);
+            deinterleave_ps(tmphi + 2 * j + 1, &s2, &s3);
+            _mm256_storeu_ps(band_h + j, dwt_filter(filter_lo, s0, s1, s2, s3));
+            _mm256_storeu_ps(band_d + j, dwt_filter(filter_hi, s0, s1, s2, s3));
+        }
+
+        for (j = j_end; j < w_out; ++j) {
+            dwt2_h_px(tmplo, ind_x, j, &band_a[j], &band_v[j]);
+            dwt2_h_px(tmphi, ind_x, j, &band_h[j], &band_d[j]);
+        }
+    }
+}
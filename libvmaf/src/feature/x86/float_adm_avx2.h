@@ -0,0 +1,54 @@
+/**
+ *
+ *  Copyright 2016-2020 Netflix, Inc.
+ *
+ *     Licensed under the BSD+Patent License (the "License");
+ *     you may not use this file except in compliance with the License.
+ *     You may obtain a copy of the License at
+ *
+ *         https://opensource.org/licenses/BSDplusPatent
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *
+ */
+
+#ifndef X86_AVX2_FLOAT_ADM_H_
+#define X86_AVX2_FLOAT_ADM_H_
+
+#include "feature/adm_tools.h"
+
+float adm_sum_cube_s_avx2(const float *x, int w, int h, int stride,
+                         double border_factor);
+
+void adm_decouple_s_avx2(const adm_dwt_band_t_s *ref,
+                        const adm_dwt_band_t_s *dis,
+                        const adm_dwt_band_t_s *r, const adm_dwt_band_t_s *a,
+                        int w, int h, int ref_stride, int dis_stride,
+                        int r_stride, int a_stride, double border_factor,
+                        double adm_enhn_gain_limit);
+
+void adm_csf_s_avx2(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *dst,
+                   const adm_dwt_band_t_s *flt, int orig_h, int scale, int w,
+                   int h, int src_stride, int dst_stride,
+                   double border_factor);
+
+float adm_csf_den_scale_s_avx2(const adm_dwt_band_t_s *src, int orig_h,
+                              int scale, int w, int h, int src_stride,
+                              double border_factor);
+
+void adm_cm_row_s_avx2(const adm_dwt_band_t_s *src,
+                      const adm_dwt_band_t_s *csf_f,
+                      const adm_dwt_band_t_s *csf_a, const float *rfactor,
+                      int i, int start_col, int end_col, int src_px_stride,
+                      int csf_px_stride, float *accum_h, float *accum_v,
+                      float *accum_d);
+
+void adm_dwt2_s_avx2(const float *src, const adm_dwt_band_t_s *dst,
+                    int **ind_y, int **ind_x, int w, int h, int src_stride,
+                    int dst_stride, float *tmplo, float *tmphi);
+
+#endif /* X86_AVX2_FLOAT_ADM_H_ */
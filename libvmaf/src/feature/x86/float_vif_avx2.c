@@ -0,0 +1,208 @@
+/**
+ *
+ *  Copyright 2016-2020 Netflix, Inc.
+ *
+ *     Licensed under the BSD+Patent License (the "License");
+ *     you may not use this file except in compliance with the License.
+ *     You may obtain a copy of the License at
+ *
+ *         https://opensource.org/licenses/BSDplusPatent
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *
+ */
+
+#include <immintrin.h>
+#include <math.h>
+#include <stdint.h>
+
+#include "float_vif_avx2.h"
+
+/*
+ * log2f_approx() and the matching_matlab statistic from vif_tools.c, 8
+ * pixels at a time. Each lane performs the scalar operations in the scalar
+ * order (no FMA), so per-pixel num/den values are bit-identical; only the
+ * row sums are reassociated across lanes.
+ */
+
+static const float log2_poly_s[9] = { -0.012671635276421, 0.064841182402670, -0.157048836463065, 0.257167726303123, -0.353800560300520, 0.480131410397451, -0.721314327952201, 1.442694803896991, 0 };
+
+static inline __m256 log2_approx_ps(__m256 x)
+{
+    const __m256i bits = _mm256_castps_si256(x);
+    const __m256i exponent =
+        _mm256_srli_epi32(_mm256_and_si256(bits, _mm256_set1_epi32(0x7F800000)), 23);
+    const __m256 remain = _mm256_castsi256_ps(
+        _mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007FFFFF)),
+                        _mm256_set1_epi32(0x3F800000)));
+    const __m256 log_base =
+        _mm256_cvtepi32_ps(_mm256_sub_epi32(exponent, _mm256_set1_epi32(127)));
+    const __m256 t = _mm256_sub_ps(remain, _mm256_set1_ps(1.0f));
+
+    __m256 log_remain = _mm256_set1_ps(log2_poly_s[0]);
+    for (int i = 1; i < 9; ++i) {
+        log_remain = _mm256_add_ps(_mm256_mul_ps(log_remain, t),
+                                   _mm256_set1_ps(log2_poly_s[i]));
+    }
+
+    __m256 r = _mm256_add_ps(log_base, log_remain);
+    r = _mm256_blendv_ps(r, _mm256_set1_ps(-INFINITY),
+                         _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_EQ_OQ));
+    r = _mm256_blendv_ps(r, _mm256_set1_ps(NAN),
+                         _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ));
+    return r;
+}
+
+static inline __m256 load_ps(const float *p, __m256i m, int tail)
+{
+    return tail ? _mm256_maskload_ps(p, m) : _mm256_loadu_ps(p);
+}
+
+static inline float hsum_ps(__m256 x)
+{
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(x),
+                          _mm256_extractf128_ps(x, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+
+void vif_dec2_s_avx2(const float *src, float *dst, int src_w, int src_h,
+                     int src_stride, int dst_stride)
+{
+    int src_px_stride = src_stride / sizeof(float);
+    int dst_px_stride = dst_stride / sizeof(float);
+
+    for (int i = 0; i < src_h / 2; ++i) {
+        const float *s = src + (i * 2) * src_px_stride;
+        float *d = dst + i * dst_px_stride;
+        int j;
+
+        for (j = 0; 2 * j + 16 <= src_w; j += 8) {
+            const __m256 x0 = _mm256_loadu_ps(s + 2 * j);
+            const __m256 x1 = _mm256_loadu_ps(s + 2 * j + 8);
+            const __m256 e = _mm256_shuffle_ps(x0, x1, _MM_SHUFFLE(2, 0, 2, 0));
+            _mm256_storeu_ps(d + j, _mm256_castpd_ps(
+                _mm256_permute4x64_pd(_mm256_castps_pd(e), 0xd8)));
+        }
+        for (; j < src_w / 2; ++j)
+            d[j] = s[j * 2];
+    }
+}
+
+static inline void statistic_block(const float *mu1, const float *mu2,
+                                   const float *xx_filt, const float *yy_filt,
+                                   const float *xy_filt, __m256 gain_limit,
+                                   __m256 *acc_num, __m256 *acc_den,
+                                   __m256i m, int tail)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 eps = _mm256_set1_ps(1.0e-10f);
+    const __m256 sigma_nsq = _mm256_set1_ps(2.0f);
+    const __m256 sigma_max_inv = _mm256_set1_ps((float)(4.0 / (255.0 * 255.0)));
+
+    const __m256 mu1_val = load_ps(mu1, m, tail);
+    const __m256 mu2_val = load_ps(mu2, m, tail);
+    const __m256 mu1_sq_val = _mm256_mul_ps(mu1_val, mu1_val);
+    const __m256 mu2_sq_val = _mm256_mul_ps(mu2_val, mu2_val);
+    const __m256 mu1_mu2_val = _mm256_mul_ps(mu1_val, mu2_val);
+
+    __m256 sigma1_sq = _mm256_sub_ps(load_ps(xx_filt, m, tail), mu1_sq_val);
+    __m256 sigma2_sq = _mm256_sub_ps(load_ps(yy_filt, m, tail), mu2_sq_val);
+    const __m256 sigma12 = _mm256_sub_ps(load_ps(xy_filt, m, tail), mu1_mu2_val);
+
+    sigma1_sq = _mm256_max_ps(sigma1_sq, zero);
+    sigma2_sq = _mm256_max_ps(sigma2_sq, zero);
+
+    __m256 g = _mm256_div_ps(sigma12, _mm256_add_ps(sigma1_sq, eps));
+    __m256 sv_sq = _mm256_sub_ps(sigma2_sq, _mm256_mul_ps(g, sigma12));
+
+    const __m256 sigma1_lt_eps = _mm256_cmp_ps(sigma1_sq, eps, _CMP_LT_OQ);
+    g = _mm256_andnot_ps(sigma1_lt_eps, g);
+    sv_sq = _mm256_blendv_ps(sv_sq, sigma2_sq, sigma1_lt_eps);
+    sigma1_sq = _mm256_andnot_ps(sigma1_lt_eps, sigma1_sq);
+
+    const __m256 sigma2_lt_eps = _mm256_cmp_ps(sigma2_sq, eps, _CMP_LT_OQ);
+    g = _mm256_andnot_ps(sigma2_lt_eps, g);
+    sv_sq = _mm256_andnot_ps(sigma2_lt_eps, sv_sq);
+
+    const __m256 g_lt_0 = _mm256_cmp_ps(g, zero, _CMP_LT_OQ);
+    sv_sq = _mm256_blendv_ps(sv_sq, sigma2_sq, g_lt_0);
+    g = _mm256_andnot_ps(g_lt_0, g);
+    sv_sq = _mm256_max_ps(sv_sq, eps);
+
+    g = _mm256_min_ps(g, gain_limit);
+
+    __m256 num_val = log2_approx_ps(_mm256_add_ps(one,
+        _mm256_div_ps(_mm256_mul_ps(_mm256_mul_ps(g, g), sigma1_sq),
+                      _mm256_add_ps(sv_sq, sigma_nsq))));
+    __m256 den_val = log2_approx_ps(_mm256_add_ps(one,
+        _mm256_div_ps(sigma1_sq, sigma_nsq)));
+
+    num_val = _mm256_andnot_ps(_mm256_cmp_ps(sigma12, zero, _CMP_LT_OQ), num_val);
+
+    const __m256 sigma1_lt_nsq = _mm256_cmp_ps(sigma1_sq, sigma_nsq, _CMP_LT_OQ);
+    num_val = _mm256_blendv_ps(num_val,
+        _mm256_sub_ps(one, _mm256_mul_ps(sigma2_sq, sigma_max_inv)), sigma1_lt_nsq);
+    den_val = _mm256_blendv_ps(den_val, one, sigma1_lt_nsq);
+
+    if (tail) {
+        num_val = _mm256_and_ps(num_val, _mm256_castsi256_ps(m));
+        den_val = _mm256_and_ps(den_val, _mm256_castsi256_ps(m));
+    }
+
+    *acc_num = _mm256_add_ps(*acc_num, num_val);
+    *acc_den = _mm256_add_ps(*acc_den, den_val);
+}
+
+void vif_statistic_s_avx2(const float *mu1, const float *mu2,
+                          const float *xx_filt, const float *yy_filt,
+                          const float *xy_filt, float *num, float *den, int w,
+                          int h, int mu1_stride, int mu2_stride,
+                          int xx_filt_stride, int yy_filt_stride,
+                          int xy_filt_stride, double vif_enhn_gain_limit)
+{
+    int mu1_px_stride = mu1_stride / sizeof(float);
+    int mu2_px_stride = mu2_stride / sizeof(float);
+    int xx_filt_px_stride = xx_filt_stride / sizeof(float);
+    int yy_filt_px_stride = yy_filt_stride / sizeof(float);
+    int xy_filt_px_stride = xy_filt_stride / sizeof(float);
+
+    const __m256 gain_limit = _mm256_set1_ps((float)vif_enhn_gain_limit);
+    const __m256i m = _mm256_cmpgt_epi32(_mm256_set1_epi32(w % 8),
+                          _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+
+    float accum_num = 0.0f;
+    float accum_den = 0.0f;
+
+    for (int i = 0; i < h; ++i) {
+        const float *mu1_row = mu1 + i * mu1_px_stride;
+        const float *mu2_row = mu2 + i * mu2_px_stride;
+        const float *xx_row = xx_filt + i * xx_filt_px_stride;
+        const float *yy_row = yy_filt + i * yy_filt_px_stride;
+        const float *xy_row = xy_filt + i * xy_filt_px_stride;
+        __m256 acc_num = _mm256_setzero_ps();
+        __m256 acc_den = _mm256_setzero_ps();
+        int j;
+
+        for (j = 0; j + 8 <= w; j += 8) {
+            statistic_block(mu1_row + j, mu2_row + j, xx_row + j, yy_row + j,
+                            xy_row + j, gain_limit, &acc_num, &acc_den, m, 0);
+        }
+        if (j < w) {
+            statistic_block(mu1_row + j, mu2_row + j, xx_row + j, yy_row + j,
+                            xy_row + j, gain_limit, &acc_num, &acc_den, m, 1);
+        }
+
+        accum_num += hsum_ps(acc_num);
+        accum_den += hsum_ps(acc_den);
+    }
+
+    num[0] = accum_num;
+    den[0] = accum_den;
+}
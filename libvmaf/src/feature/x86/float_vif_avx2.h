@@ -0,0 +1,32 @@
+/**
+ *
+ *  Copyright 2016-2020 Netflix, Inc.
+ *
+ *     Licensed under the BSD+Patent License (the "License");
+ *     you may not use this file except in compliance with the License.
+ *     You may obtain a copy of the License at
+ *
+ *         https://opensource.org/licenses/BSDplusPatent
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *
+ */
+
+#ifndef X86_AVX2_FLOAT_VIF_H_
+#define X86_AVX2_FLOAT_VIF_H_
+
+void vif_dec2_s_avx2(const float *src, float *dst, int src_w, int src_h,
+                    int src_stride, int dst_stride);
+
+void vif_statistic_s_avx2(const float *mu1, const float *mu2,
+                         const float *xx_filt, const float *yy_filt,
+                         const float *xy_filt, float *num, float *den, int w,
+                         int h, int mu1_stride, int mu2_stride,
+                         int xx_filt_stride, int yy_filt_stride,
+                         int xy_filt_stride, double vif_enhn_gain_limit);
+
+#endif /* X86_AVX2_FLOAT_VIF_H_ */
@@ -0,0 +1,194 @@
+/**
+ *
+ *  Copyright 2016-2020 Netflix, Inc.
+ *
+ *     Licensed under the BSD+Patent License (the "License");
+ *     you may not use this file except in compliance with the License.
+ *     You may obtain a copy of the License at
+ *
+ *         https://opensource.org/licenses/BSDplusPatent
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *
+ */
+
+#include <immintrin.h>
+#include <math.h>
+#include <stdint.h>
+
+#include "float_vif_avx512.h"
+
+/*
+ * 16-lane counterpart of float_vif_avx2.c: per-pixel num/den values are
+ * bit-identical to vif_statistic_s(), row sums are reassociated.
+ */
+
+static const float log2_poly_s[9] = { -0.012671635276421, 0.064841182402670, -0.157048836463065, 0.257167726303123, -0.353800560300520, 0.480131410397451, -0.721314327952201, 1.442694803896991, 0 };
+
+static inline __m512 log2_approx_ps(__m512 x)
+{
+    const __m512i bits = _mm512_castps_si512(x);
+    const __m512i exponent =
+        _mm512_srli_epi32(_mm512_and_si512(bits, _mm512_set1_epi32(0x7F800000)), 23);
+    const __m512 remain = _mm512_castsi512_ps(
+        _mm512_or_si512(_mm512_and_si512(bits, _mm512_set1_epi32(0x007FFFFF)),
+                        _mm512_set1_epi32(0x3F800000)));
+    const __m512 log_base =
+        _mm512_cvtepi32_ps(_mm512_sub_epi32(exponent, _mm512_set1_epi32(127)));
+    const __m512 t = _mm512_sub_ps(remain, _mm512_set1_ps(1.0f));
+
+    __m512 log_remain = _mm512_set1_ps(log2_poly_s[0]);
+    for (int i = 1; i < 9; ++i) {
+        log_remain = _mm512_add_ps(_mm512_mul_ps(log_remain, t),
+                                   _mm512_set1_ps(log2_poly_s[i]));
+    }
+
+    __m512 r = _mm512_add_ps(log_base, log_remain);
+    r = _mm512_mask_mov_ps(r, _mm512_cmp_ps_mask(x, _mm512_setzero_ps(), _CMP_EQ_OQ),
+                           _mm512_set1_ps(-INFINITY));
+    r = _mm512_mask_mov_ps(r, _mm512_cmp_ps_mask(x, _mm512_setzero_ps(), _CMP_LT_OQ),
+                           _mm512_set1_ps(NAN));
+    return r;
+}
+
+static inline __m512 load_ps(const float *p, __mmask16 m, int tail)
+{
+    return tail ? _mm512_maskz_loadu_ps(m, p) : _mm512_loadu_ps(p);
+}
+
+void vif_dec2_s_avx512(const float *src, float *dst, int src_w, int src_h,
+                       int src_stride, int dst_stride)
+{
+    const __m512i idx_even = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14,
+                                               16, 18, 20, 22, 24, 26, 28, 30);
+
+    int src_px_stride = src_stride / sizeof(float);
+    int dst_px_stride = dst_stride / sizeof(float);
+
+    for (int i = 0; i < src_h / 2; ++i) {
+        const float *s = src + (i * 2) * src_px_stride;
+        float *d = dst + i * dst_px_stride;
+        int j;
+
+        for (j = 0; 2 * j + 32 <= src_w; j += 16) {
+            const __m512 x0 = _mm512_loadu_ps(s + 2 * j);
+            const __m512 x1 = _mm512_loadu_ps(s + 2 * j + 16);
+            _mm512_storeu_ps(d + j, _mm512_permutex2var_ps(x0, idx_even, x1));
+        }
+        for (; j < src_w / 2; ++j)
+            d[j] = s[j * 2];
+    }
+}
+
+static inline void statistic_block(const float *mu1, const float *mu2,
+                                   const float *xx_filt, const float *yy_filt,
+                                   const float *xy_filt, __m512 gain_limit,
+                                   __m512 *acc_num, __m512 *acc_den,
+                                   __mmask16 m, int tail)
+{
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512 one = _mm512_set1_ps(1.0f);
+    const __m512 eps = _mm512_set1_ps(1.0e-10f);
+    const __m512 sigma_nsq = _mm512_set1_ps(2.0f);
+    const __m512 sigma_max_inv = _mm512_set1_ps((float)(4.0 / (255.0 * 255.0)));
+
+    const __m512 mu1_val = load_ps(mu1, m, tail);
+    const __m512 mu2_val = load_ps(mu2, m, tail);
+    const __m512 mu1_sq_val = _mm512_mul_ps(mu1_val, mu1_val);
+    const __m512 mu2_sq_val = _mm512_mul_ps(mu2_val, mu2_val);
+    const __m512 mu1_mu2_val = _mm512_mul_ps(mu1_val, mu2_val);
+
+    __m512 sigma1_sq = _mm512_sub_ps(load_ps(xx_filt, m, tail), mu1_sq_val);
+    __m512 sigma2_sq = _mm512_sub_ps(load_ps(yy_filt, m, tail), mu2_sq_val);
+    const __m512 sigma12 = _mm512_sub_ps(load_ps(xy_filt, m, tail), mu1_mu2_val);
+
+    sigma1_sq = _mm512_max_ps(sigma1_sq, zero);
+    sigma2_sq = _mm512_max_ps(sigma2_sq, zero);
+
+    __m512 g = _mm512_div_ps(sigma12, _mm512_add_ps(sigma1_sq, eps));
+    __m512 sv_sq = _mm512_sub_ps(sigma2_sq, _mm512_mul_ps(g, sigma12));
+
+    const __mmask16 sigma1_lt_eps = _mm512_cmp_ps_mask(sigma1_sq, eps, _CMP_LT_OQ);
+    g = _mm512_mask_mov_ps(g, sigma1_lt_eps, zero);
+    sv_sq = _mm512_mask_mov_ps(sv_sq, sigma1_lt_eps, sigma2_sq);
+    sigma1_sq = _mm512_mask_mov_ps(sigma1_sq, sigma1_lt_eps, zero);
+
+    const __mmask16 sigma2_lt_eps = _mm512_cmp_ps_mask(sigma2_sq, eps, _CMP_LT_OQ);
+    g = _mm512_mask_mov_ps(g, sigma2_lt_eps, zero);
+    sv_sq = _mm512_mask_mov_ps(sv_sq, sigma2_lt_eps, zero);
+
+    const __mmask16 g_lt_0 = _mm512_cmp_ps_mask(g, zero, _CMP_LT_OQ);
+    sv_sq = _mm512_mask_mov_ps(sv_sq, g_lt_0, sigma2_sq);
+    g = _mm512_mask_mov_ps(g, g_lt_0, zero);
+    sv_sq = _mm512_max_ps(sv_sq, eps);
+
+    g = _mm512_min_ps(g, gain_limit);
+
+    __m512 num_val = log2_approx_ps(_mm512_add_ps(one,
+        _mm512_div_ps(_mm512_mul_ps(_mm512_mul_ps(g, g), sigma1_sq),
+                      _mm512_add_ps(sv_sq, sigma_nsq))));
+    __m512 den_val = log2_approx_ps(_mm512_add_ps(one,
+        _mm512_div_ps(sigma1_sq, sigma_nsq)));
+
+    num_val = _mm512_mask_mov_ps(num_val,
+        _mm512_cmp_ps_mask(sigma12, zero, _CMP_LT_OQ), zero);
+
+    const __mmask16 sigma1_lt_nsq = _mm512_cmp_ps_mask(sigma1_sq, sigma_nsq, _CMP_LT_OQ);
+    num_val = _mm512_mask_mov_ps(num_val, sigma1_lt_nsq,
+        _mm512_sub_ps(one, _mm512_mul_ps(sigma2_sq, sigma_max_inv)));
+    den_val = _mm512_mask_mov_ps(den_val, sigma1_lt_nsq, one);
+
+    *acc_num = _mm512_mask_add_ps(*acc_num, m, *acc_num, num_val);
+    *acc_den = _mm512_mask_add_ps(*acc_den, m, *acc_den, den_val);
+}
+
+void vif_statistic_s_avx512(const float *mu1, const float *mu2,
+                            const float *xx_filt, const float *yy_filt,
+                            const float *xy_filt, float *num, float *den,
+                            int w, int h, int mu1_stride, int mu2_stride,
+                            int xx_filt_stride, int yy_filt_stride,
+                            int xy_filt_stride, double vif_enhn_gain_limit)
+{
+    int mu1_px_stride = mu1_stride / sizeof(float);
+    int mu2_px_stride = mu2_stride / sizeof(float);
+    int xx_filt_px_stride = xx_filt_stride / sizeof(float);
+    int yy_filt_px_stride = yy_filt_stride / sizeof(float);
+    int xy_filt_px_stride = xy_filt_stride / sizeof(float);
+
+    const __m512 gain_limit = _mm512_set1_ps((float)vif_enhn_gain_limit);
+    const __mmask16 m = (__mmask16)((1u << (w % 16)) - 1);
+
+    float accum_num = 0.0f;
+    float accum_den = 0.0f;
+
+    for (int i = 0; i < h; ++i) {
+        const float *mu1_row = mu1 + i * mu1_px_stride;
+        const float *mu2_row = mu2 + i * mu2_px_stride;
+        const float *xx_row = xx_filt + i * xx_filt_px_stride;
+        const float *yy_row = yy_filt + i * yy_filt_px_stride;
+        const float *xy_row = xy_filt + i * xy_filt_px_stride;
+        __m512 acc_num = _mm512_setzero_ps();
+        __m512 acc_den = _mm512_setzero_ps();
+        int j;
+
+        for (j = 0; j + 16 <= w; j += 16) {
+            statistic_block(mu1_row + j, mu2_row + j, xx_row + j, yy_row + j,
+                            xy_row + j, gain_limit, &acc_num, &acc_den,
+                            0xffff, 0);
+        }
+        if (j < w) {
+            statistic_block(mu1_row + j, mu2_row + j, xx_row + j, yy_row + j,
+                            xy_row + j, gain_limit, &acc_num, &acc_den, m, 1);
+        }
+
+        accum_num += _mm512_reduce_add_ps(acc_num);
+        accum_den += _mm512_reduce_add_ps(acc_den);
+    }
+
+    num[0] = accum_num;
+    den[0] = accum_den;
+}
@@ -19,6 +19,7 @@
 #include <immintrin.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdlib.h>
 
 #include "feature/integer_motion.h"
 #include "feature/common/alignment.h"
@@ -133,3 +134,177 @@ void x_convolution_16_avx2(const uint16_t *src, uint16_t *dst, unsigned width,
         }
     }
 }
+
+static inline void mac_epu16(__m256i *lo, __m256i *hi, __m256i src,
+                             __m256i coeff)
+{
+    const __m256i prod_lo = _mm256_mullo_epi16(src, coeff);
+    const __m256i prod_hi = _mm256_mulhi_epu16(src, coeff);
+    *lo = _mm256_add_epi32(*lo, _mm256_unpacklo_epi16(prod_lo, prod_hi));
+    *hi = _mm256_add_epi32(*hi, _mm256_unpackhi_epi16(prod_lo, prod_hi));
+}
+
+/* 5-tap filter over 16 lanes of 16-bit taps, rounded and shifted back down
+ * to 16 bits. Accumulates in 32 bits, so it is exact for any input depth. */
+static inline __m256i filter_5tap(const __m256i tap[5], __m256i round,
+                                  __m128i shift)
+{
+    const __m256i coeff0 = _mm256_set1_epi16(filter[0]);
+    const __m256i coeff1 = _mm256_set1_epi16(filter[1]);
+    const __m256i coeff2 = _mm256_set1_epi16(filter[2]);
+    __m256i lo = round, hi = round;
+
+    mac_epu16(&lo, &hi, tap[0], coeff0);
+    mac_epu16(&lo, &hi, tap[1], coeff1);
+    mac_epu16(&lo, &hi, tap[2], coeff2);
+    mac_epu16(&lo, &hi, tap[3], coeff1);
+    mac_epu16(&lo, &hi, tap[4], coeff0);
+    lo = _mm256_srl_epi32(lo, shift);
+    hi = _mm256_srl_epi32(hi, shift);
+    return _mm256_packus_epi32(lo, hi);
+}
+
+static inline uint32_t hadd_epi32(__m256i x)
+{
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(x),
+                                _mm256_extracti128_si256(x, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4e));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xb1));
+    return _mm_cvtsi128_si32(sum);
+}
+
+void y_convolution_8_avx2(void *src, uint16_t *dst, unsigned width,
+                          unsigned height, ptrdiff_t src_stride,
+                          ptrdiff_t dst_stride, unsigned inp_size_bits)
+{
+    (void) inp_size_bits;
+    const int radius = filter_width / 2;
+    const unsigned shift_var = 8;
+    const unsigned add_before_shift = 1u << (shift_var - 1);
+    const __m256i round = _mm256_set1_epi32(add_before_shift);
+    const __m128i shift = _mm_cvtsi32_si128(shift_var);
+
+    for (unsigned i = 0; i < height; i++) {
+        const uint8_t *row[5];
+        for (int k = 0; k < filter_width; k++)
+            row[k] = (uint8_t*) src +
+                     mirror_tap(i - radius + k, height) * src_stride;
+
+        uint16_t *dst_p = dst + i * dst_stride;
+        unsigned j = 0;
+        for (; j + 16 <= width; j += 16) {
+            __m256i tap[5];
+            for (int k = 0; k < filter_width; k++) {
+                tap[k] = _mm256_cvtepu8_epi16(
+                    _mm_loadu_si128((const __m128i*) (row[k] + j)));
+            }
+            _mm256_storeu_si256((__m256i*) (dst_p + j),
+                                filter_5tap(tap, round, shift));
+        }
+        for (; j < width; j++) {
+            uint32_t accum = 0;
+            for (int k = 0; k < filter_width; k++)
+                accum += filter[k] * row[k][j];
+            dst_p[j] = (accum + add_before_shift) >> shift_var;
+        }
+    }
+}
+
+void y_convolution_16_avx2(void *src, uint16_t *dst, unsigned width,
+                           unsigned height, ptrdiff_t src_stride,
+                           ptrdiff_t dst_stride, unsigned inp_size_bits)
+{
+    const int radius = filter_width / 2;
+    const unsigned shift_var = inp_size_bits;
+    const unsigned add_before_shift = 1u << (shift_var - 1);
+    const __m256i round = _mm256_set1_epi32(add_before_shift);
+    const __m128i shift = _mm_cvtsi32_si128(shift_var);
+
+    for (unsigned i = 0; i < height; i++) {
+        const uint16_t *row[5];
+        for (int k = 0; k < filter_width; k++)
+            row[k] = (uint16_t*) src +
+                     mirror_tap(i - radius + k, height) * src_stride;
+
+        uint16_t *dst_p = dst + i * dst_stride;
+        unsigned j = 0;
+        for (; j + 16 <= width; j += 16) {
+            __m256i tap[5];
+            for (int k = 0; k < filter_width; k++)
+                tap[k] = _mm256_loadu_si256((const __m256i*) (row[k] + j));
+            _mm256_storeu_si256((__m256i*) (dst_p + j),
+                                filter_5tap(tap, round, shift));
+        }
+        for (; j < width; j++) {
+            uint32_t accum = 0;
+            for (int k = 0; k < filter_width; k++)
+                accum += filter[k] * row[k][j];
+            dst_p[j] = (accum + add_before_shift) >> shift_var;
+        }
+    }
+}
+
+void x_convolution_16_sad_avx2(const uint16_t *src, uint16_t *dst,
+                               const uint16_t *prev, unsigned width,
+                               unsigned height, ptrdiff_t src_stride,
+                               ptrdiff_t dst_stride, uint64_t *sad)
+{
+    const int radius = filter_width / 2;
+    const unsigned left_edge = vmaf_ceiln(radius, 1);
+    const unsigned right_edge = vmaf_floorn(width - (filter_width - radius), 1);
+    const unsigned shift_add_round = 32768;
+    const __m256i round = _mm256_set1_epi32(shift_add_round);
+    const __m128i shift = _mm_cvtsi32_si128(16);
+    const __m256i lo_mask = _mm256_set1_epi32(0xffff);
+
+    *sad = 0;
+    for (unsigned i = 0; i < height; i++) {
+        const uint16_t *src_p = src + i * src_stride;
+        uint16_t *dst_p = dst + i * dst_stride;
+        const uint16_t *prev_p = prev + i * dst_stride;
+        __m256i row_sad = _mm256_setzero_si256();
+
+        for (unsigned j = 0; j < left_edge; j++) {
+            dst_p[j] = (edge_16(true, src, width, height, src_stride, i, j) +
+                        shift_add_round) >> 16;
+        }
+
+        unsigned j = left_edge;
+        for (; j + 16 <= right_edge; j += 16) {
+            __m256i tap[5];
+            for (int k = 0; k < filter_width; k++) {
+                tap[k] = _mm256_loadu_si256(
+                    (const __m256i*) (src_p + j - radius + k));
+            }
+            const __m256i blur = filter_5tap(tap, round, shift);
+            _mm256_storeu_si256((__m256i*) (dst_p + j), blur);
+
+            const __m256i last = _mm256_loadu_si256((const __m256i*) (prev_p + j));
+            const __m256i diff = _mm256_or_si256(_mm256_subs_epu16(blur, last),
+                                                 _mm256_subs_epu16(last, blur));
+            row_sad = _mm256_add_epi32(row_sad, _mm256_and_si256(diff, lo_mask));
+            row_sad = _mm256_add_epi32(row_sad, _mm256_srli_epi32(diff, 16));
+        }
+        const unsigned vector_end = j;
+
+        for (; j < right_edge; j++) {
+            uint32_t accum = 0;
+            for (int k = 0; k < filter_width; k++)
+                accum += filter[k] * src_p[j - radius + k];
+            dst_p[j] = (accum + shift_add_round) >> 16;
+        }
+
+        for (j = right_edge; j < width; j++) {
+            dst_p[j] = (edge_16(true, src, width, height, src_stride, i, j) +
+                        shift_add_round) >> 16;
+        }
+
+        /* sad_c() sums each row in 32 bits; wrapping here matches it */
+        uint32_t inner_sad = hadd_epi32(row_sad);
+        for (j = 0; j < left_edge; j++)
+            inner_sad += abs(dst_p[j] - prev_p[j]);
+        for (j = vector_end; j < width; j++)
+            inner_sad += abs(dst_p[j] - prev_p[j]);
+        *sad += inner_sad;
+    }
+}
@@ -20,6 +20,7 @@
 #include <math.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "feature/integer_motion.h"
@@ -135,3 +136,149 @@ void x_convolution_16_avx512(const uint16_t *src, uint16_t *dst, unsigned width,
         }
     }
 }
+
+static inline void mac_epu16(__m512i *lo, __m512i *hi, __m512i src,
+                             __m512i coeff)
+{
+    const __m512i prod_lo = _mm512_mullo_epi16(src, coeff);
+    const __m512i prod_hi = _mm512_mulhi_epu16(src, coeff);
+    *lo = _mm512_add_epi32(*lo, _mm512_unpacklo_epi16(prod_lo, prod_hi));
+    *hi = _mm512_add_epi32(*hi, _mm512_unpackhi_epi16(prod_lo, prod_hi));
+}
+
+/* 5-tap filter over 32 lanes of 16-bit taps, rounded and shifted back down
+ * to 16 bits. Accumulates in 32 bits, so it is exact for any input depth. */
+static inline __m512i filter_5tap(const __m512i tap[5], __m512i round,
+                                  __m128i shift)
+{
+    const __m512i coeff0 = _mm512_set1_epi16(filter[0]);
+    const __m512i coeff1 = _mm512_set1_epi16(filter[1]);
+    const __m512i coeff2 = _mm512_set1_epi16(filter[2]);
+    __m512i lo = round, hi = round;
+
+    mac_epu16(&lo, &hi, tap[0], coeff0);
+    mac_epu16(&lo, &hi, tap[1], coeff1);
+    mac_epu16(&lo, &hi, tap[2], coeff2);
+    mac_epu16(&lo, &hi, tap[3], coeff1);
+    mac_epu16(&lo, &hi, tap[4], coeff0);
+    lo = _mm512_srl_epi32(lo, shift);
+    hi = _mm512_srl_epi32(hi, shift);
+    return _mm512_packus_epi32(lo, hi);
+}
+
+static inline __mmask32 tail_mask(unsigned n)
+{
+    return n >= 32 ? 0xffffffff : (1u << n) - 1;
+}
+
+void y_convolution_8_avx512(void *src, uint16_t *dst, unsigned width,
+                            unsigned height, ptrdiff_t src_stride,
+                            ptrdiff_t dst_stride, unsigned inp_size_bits)
+{
+    (void) inp_size_bits;
+    const int radius = filter_width / 2;
+    const unsigned shift_var = 8;
+    const __m512i round = _mm512_set1_epi32(1u << (shift_var - 1));
+    const __m128i shift = _mm_cvtsi32_si128(shift_var);
+
+    for (unsigned i = 0; i < height; i++) {
+        const uint8_t *row[5];
+        for (int k = 0; k < filter_width; k++)
+            row[k] = (uint8_t*) src +
+                     mirror_tap(i - radius + k, height) * src_stride;
+
+        uint16_t *dst_p = dst + i * dst_stride;
+        for (unsigned j = 0; j < width; j += 32) {
+            const __mmask32 m = tail_mask(width - j);
+            __m512i tap[5];
+            for (int k = 0; k < filter_width; k++)
+                tap[k] = _mm512_cvtepu8_epi16(_mm256_maskz_loadu_epi8(m, row[k] + j));
+            _mm512_mask_storeu_epi16(dst_p + j, m,
+                                     filter_5tap(tap, round, shift));
+        }
+    }
+}
+
+void y_convolution_16_avx512(void *src, uint16_t *dst, unsigned width,
+                             unsigned height, ptrdiff_t src_stride,
+                             ptrdiff_t dst_stride, unsigned inp_size_bits)
+{
+    const int radius = filter_width / 2;
+    const unsigned shift_var = inp_size_bits;
+    const __m512i round = _mm512_set1_epi32(1u << (shift_var - 1));
+    const __m128i shift = _mm_cvtsi32_si128(shift_var);
+
+    for (unsigned i = 0; i < height; i++) {
+        const uint16_t *row[5];
+        for (int k = 0; k < filter_width; k++)
+            row[k] = (uint16_t*) src +
+                     mirror_tap(i - radius + k, height) * src_stride;
+
+        uint16_t *dst_p = dst + i * dst_stride;
+        for (unsigned j = 0; j < width; j += 32) {
+            const __mmask32 m = tail_mask(width - j);
+            __m512i tap[5];
+            for (int k = 0; k < filter_width; k++)
+                tap[k] = _mm512_maskz_loadu_epi16(m, row[k] + j);
+            _mm512_mask_storeu_epi16(dst_p + j, m,
+                                     filter_5tap(tap, round, shift));
+        }
+    }
+}
+
+void x_convolution_16_sad_avx512(const uint16_t *src, uint16_t *dst,
+                                 const uint16_t *prev, unsigned width,
+                                 unsigned height, ptrdiff_t src_stride,
+                                 ptrdiff_t dst_stride, uint64_t *sad)
+{
+    const int radius = filter_width / 2;
+    const unsigned left_edge = vmaf_ceiln(radius, 1);
+    const unsigned right_edge = vmaf_floorn(width - (filter_width - radius), 1);
+    const unsigned shift_add_round = 32768;
+    const __m512i round = _mm512_set1_epi32(shift_add_round);
+    const __m128i shift = _mm_cvtsi32_si128(16);
+    const __m512i lo_mask = _mm512_set1_epi32(0xffff);
+
+    *sad = 0;
+    for (unsigned i = 0; i < height; i++) {
+        const uint16_t *src_p = src + i * src_stride;
+        uint16_t *dst_p = dst + i * dst_stride;
+        const uint16_t *prev_p = prev + i * dst_stride;
+        __m512i row_sad = _mm512_setzero_si512();
+
+        for (unsigned j = 0; j < left_edge; j++) {
+            dst_p[j] = (edge_16(true, src, width, height, src_stride, i, j) +
+                        shift_add_round) >> 16;
+        }
+
+        /* masked-off lanes filter to 0 and compare against 0 */
+        for (unsigned j = left_edge; j < right_edge; j += 32) {
+            const __mmask32 m = tail_mask(right_edge - j);
+            __m512i tap[5];
+            for (int k = 0; k < filter_width; k++)
+                tap[k] = _mm512_maskz_loadu_epi16(m, src_p + j - radius + k);
+            const __m512i blur = filter_5tap(tap, round, shift);
+            _mm512_mask_storeu_epi16(dst_p + j, m, blur);
+
+            const __m512i last = _mm512_maskz_loadu_epi16(m, prev_p + j);
+            const __m512i diff = _mm512_or_si512(_mm512_subs_epu16(blur, last),
+                                                 _mm512_subs_epu16(last, blur));
+            row_sad = _mm512_add_epi32(row_sad, _mm512_and_si512(diff, lo_mask));
+            row_sad = _mm512_add_epi32(row_sad, _mm512_srli_epi32(diff, 16));
+        }
+
+        for (unsigned j = right_edge; j < width; j++) {
+            dst_p[j] = (edge_16(true, src, width, height, src_stride, i, j) +
+                        shift_add_round) >> 16;
+        }
+
+        /* sad_c() sums each row in 32 bits; wrapping here matches it */
+        uint32_t inner_sad = _mm512_reduce_add_epi32(row_sad);
+        for (unsigned j = 0; j < left_edge; j++)
+            inner_sad += abs(dst_p[j] - prev_p[j]);
+        for (unsigned j = right_edge > left_edge ? right_edge : left_edge;
+             j < width; j++)
+            inner_sad += abs(dst_p[j] - prev_p[j]);
+        *sad += inner_sad;
+    }
+}
@@ -19,10 +19,24 @@
 #ifndef X86_AVX512_MOTION_H_
 #define X86_AVX512_MOTION_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 void x_convolution_16_avx512(const uint16_t *src, uint16_t *dst, unsigned width,
                              unsigned height, ptrdiff_t src_stride,
                              ptrdiff_t dst_stride);
 
+void y_convolution_8_avx512(void *src, uint16_t *dst, unsigned width,
+                            unsigned height, ptrdiff_t src_stride,
+                            ptrdiff_t dst_stride, unsigned inp_size_bits);
+
+void y_convolution_16_avx512(void *src, uint16_t *dst, unsigned width,
+                             unsigned height, ptrdiff_t src_stride,
+                             ptrdiff_t dst_stride, unsigned inp_size_bits);
+
+void x_convolution_16_sad_avx512(const uint16_t *src, uint16_t *dst,
+                                 const uint16_t *prev, unsigned width,
+                                 unsigned height, ptrdiff_t src_stride,
+                                 ptrdiff_t dst_stride, uint64_t *sad);
+
 #endif /* X86_AVX512_MOTION_H_ */
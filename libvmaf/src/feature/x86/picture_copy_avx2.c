@@ -0,0 +1,143 @@
+/**
+ *
+ *  Copyright 2016-2020 Netflix, Inc.
+ *
+ *     Licensed under the BSD+Patent License (the "License");
+ *     you may not use this file except in compliance with the License.
+ *     You may obtain a copy of the License at
+ *
+ *         https://opensource.org/licenses/BSDplusPatent
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *
+ */
+
+#include <immintrin.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "picture_copy_avx2.h"
+
+/*
+ * Integer to float conversions are exact, and `scale` is the reciprocal of a
+ * power of two, so these match the scalar division in picture_copy_hbd().
+ */
+void picture_copy_8_avx2(float *dst, ptrdiff_t dst_stride, const uint8_t *src,
+                         ptrdiff_t src_stride, unsigned w, unsigned h,
+                         float offset)
+{
+    const __m256 off = _mm256_set1_ps(offset);
+
+    for (unsigned i = 0; i < h; i++) {
+        unsigned j = 0;
+        for (; j + 16 <= w; j += 16) {
+            const __m128i s = _mm_loadu_si128((const __m128i *)(src + j));
+            const __m256 lo = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(s));
+            const __m256 hi =
+                _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(s, 8)));
+            _mm256_storeu_ps(dst + j, _mm256_add_ps(lo, off));
+            _mm256_storeu_ps(dst + j + 8, _mm256_add_ps(hi, off));
+        }
+        for (; j < w; j++)
+            dst[j] = (float) src[j] + offset;
+        dst += dst_stride / sizeof(float);
+        src += src_stride;
+    }
+}
+
+void picture_copy_16_avx2(float *dst, ptrdiff_t dst_stride, const uint16_t *src,
+                          ptrdiff_t src_stride, unsigned w, unsigned h,
+                          float scale, float offset)
+{
+    const __m256 off = _mm256_set1_ps(offset);
+    const __m256 sc = _mm256_set1_ps(scale);
+
+    for (unsigned i = 0; i < h; i++) {
+        unsigned j = 0;
+        for (; j + 16 <= w; j += 16) {
+            const __m256i s = _mm256_loadu_si256((const __m256i *)(src + j));
+            const __m256 lo = _mm256_cvtepi32_ps(
+                _mm256_cvtepu16_epi32(_mm256_castsi256_si128(s)));
+            const __m256 hi = _mm256_cvtepi32_ps(
+                _mm256_cvtepu16_epi32(_mm256_extracti128_si256(s, 1)));
+            _mm256_storeu_ps(dst + j, _mm256_add_ps(_mm256_mul_ps(lo, sc), off));
+            _mm256_storeu_ps(dst + j + 8,
+                             _mm256_add_ps(_mm256_mul_ps(hi, sc), off));
+        }
+        for (; j < w; j++)
+            dst[j] = (float) src[j] * scale + offset;
+        dst += dst_stride / sizeof(float);
+        src += src_stride / sizeof(uint16_t);
+    }
+}
+
+/* Truncates like the scalar float to integer conversion, out of range values
+ * saturate. */
+static void from_float_8_row(uint8_t *dst, const float *src, unsigned w)
+{
+    unsigned j = 0;
+    for (; j + 16 <= w; j += 16) {
+        const __m256i lo = _mm256_cvttps_epi32(_mm256_loadu_ps(src + j));
+        const __m256i hi = _mm256_cvttps_epi32(_mm256_loadu_ps(src + j + 8));
+        const __m256i p =
+            _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xd8);
+        _mm_storeu_si128((__m128i *)(dst + j),
+                         _mm_packus_epi16(_mm256_castsi256_si128(p),
+                                          _mm256_extracti128_si256(p, 1)));
+    }
+    for (; j < w; j++)
+        dst[j] = src[j];
+}
+
+static void from_float_16_row(uint16_t *dst, const float *src, unsigned w,
+                              float scale)
+{
+    const __m256 sc = _mm256_set1_ps(scale);
+    unsigned j = 0;
+    for (; j + 16 <= w; j += 16) {
+        const __m256i lo = _mm256_cvttps_epi32(
+            _mm256_mul_ps(_mm256_loadu_ps(src + j), sc));
+        const __m256i hi = _mm256_cvttps_epi32(
+            _mm256_mul_ps(_mm256_loadu_ps(src + j + 8), sc));
+        _mm256_storeu_si256((__m256i *)(dst + j),
+            _mm256_permute4x64_epi64(_mm256_packus_epi32(lo, hi), 0xd8));
+    }
+    for (; j < w; j++)
+        dst[j] = src[j] * scale;
+}
+
+void picture_copy_from_float_8_avx2(uint8_t *dst_a, uint8_t *dst_b,
+                                    ptrdiff_t dst_stride, const float *src_a,
+                                    const float *src_b, ptrdiff_t src_stride,
+                                    unsigned w, unsigned h)
+{
+    for (unsigned i = 0; i < h; i++) {
+        from_float_8_row(dst_a, src_a, w);
+        dst_a += dst_stride;
+        src_a += src_stride / sizeof(float);
+        if (!dst_b) continue;
+        from_float_8_row(dst_b, src_b, w);
+        dst_b += dst_stride;
+        src_b += src_stride / sizeof(float);
+    }
+}
+
+void picture_copy_from_float_16_avx2(uint16_t *dst_a, uint16_t *dst_b,
+                                     ptrdiff_t dst_stride, const float *src_a,
+                                     const float *src_b, ptrdiff_t src_stride,
+                                     unsigned w, unsigned h, float scale)
+{
+    for (unsigned i = 0; i < h; i++) {
+        from_float_16_row(dst_a, src_a, w, scale);
+        dst_a += dst_stride / sizeof(uint16_t);
+        src_a += src_stride / sizeof(float);
+        if (!dst_b) continue;
+        from_float_16_row(dst_b, src_b, w, scale);
+        dst_b += dst_stride / sizeof(uint16_t);
+        src_b += src_stride / sizeof(float);
+    }
+}
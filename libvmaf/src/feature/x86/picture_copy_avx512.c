@@ -0,0 +1,131 @@
+/**
+ *
+ *  Copyright 2016-2020 Netflix, Inc.
+ *
+ *     Licensed under the BSD+Patent License (the "License");
+ *     you may not use this file except in compliance with the License.
+ *     You may obtain a copy of the License at
+ *
+ *         https://opensource.org/licenses/BSDplusPatent
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *
+ */
+
+#include <immintrin.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "picture_copy_avx512.h"
+
+static inline __mmask16 tail_mask(unsigned n)
+{
+    return n >= 16 ? 0xffff : (__mmask16) ((1u << n) - 1);
+}
+
+/*
+ * Integer to float conversions are exact, and `scale` is the reciprocal of a
+ * power of two, so these match the scalar division in picture_copy_hbd().
+ */
+void picture_copy_8_avx512(float *dst, ptrdiff_t dst_stride, const uint8_t *src,
+                           ptrdiff_t src_stride, unsigned w, unsigned h,
+                           float offset)
+{
+    const __m512 off = _mm512_set1_ps(offset);
+
+    for (unsigned i = 0; i < h; i++) {
+        for (unsigned j = 0; j < w; j += 16) {
+            const __mmask16 m = tail_mask(w - j);
+            const __m128i s = _mm_maskz_loadu_epi8(m, src + j);
+            const __m512 f = _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(s));
+            _mm512_mask_storeu_ps(dst + j, m, _mm512_add_ps(f, off));
+        }
+        dst += dst_stride / sizeof(float);
+        src += src_stride;
+    }
+}
+
+void picture_copy_16_avx512(float *dst, ptrdiff_t dst_stride, const uint16_t *src,
+                            ptrdiff_t src_stride, unsigned w, unsigned h,
+                            float scale, float offset)
+{
+    const __m512 off = _mm512_set1_ps(offset);
+    const __m512 sc = _mm512_set1_ps(scale);
+
+    for (unsigned i = 0; i < h; i++) {
+        for (unsigned j = 0; j < w; j += 16) {
+            const __mmask16 m = tail_mask(w - j);
+            const __m256i s = _mm256_maskz_loadu_epi16(m, src + j);
+            const __m512 f = _mm512_cvtepi32_ps(_mm512_cvtepu16_epi32(s));
+            _mm512_mask_storeu_ps(dst + j, m,
+                                  _mm512_add_ps(_mm512_mul_ps(f, sc), off));
+        }
+        dst += dst_stride / sizeof(float);
+        src += src_stride / sizeof(uint16_t);
+    }
+}
+
+/* Truncates like the scalar float to integer conversion, out of range values
+ * saturate. */
+static inline __m512i cvt_epi32(const float *src, __mmask16 m, __m512 scale)
+{
+    const __m512 f = _mm512_mul_ps(_mm512_maskz_loadu_ps(m, src), scale);
+    return _mm512_max_epi32(_mm512_cvttps_epi32(f), _mm512_setzero_si512());
+}
+
+static void from_float_8_row(uint8_t *dst, const float *src, unsigned w)
+{
+    const __m512 one = _mm512_set1_ps(1.0f);
+    for (unsigned j = 0; j < w; j += 16) {
+        const __mmask16 m = tail_mask(w - j);
+        _mm512_mask_cvtusepi32_storeu_epi8(dst + j, m,
+                                           cvt_epi32(src + j, m, one));
+    }
+}
+
+static void from_float_16_row(uint16_t *dst, const float *src, unsigned w,
+                              float scale)
+{
+    const __m512 sc = _mm512_set1_ps(scale);
+    for (unsigned j = 0; j < w; j += 16) {
+        const __mmask16 m = tail_mask(w - j);
+        _mm512_mask_cvtusepi32_storeu_epi16(dst + j, m,
+                                            cvt_epi32(src + j, m, sc));
+    }
+}
+
+void picture_copy_from_float_8_avx512(uint8_t *dst_a, uint8_t *dst_b,
+                                      ptrdiff_t dst_stride, const float *src_a,
+                                      const float *src_b, ptrdiff_t src_stride,
+                                      unsigned w, unsigned h)
+{
+    for (unsigned i = 0; i < h; i++) {
+        from_float_8_row(dst_a, src_a, w);
+        dst_a += dst_stride;
+        src_a += src_stride / sizeof(float);
+        if (!dst_b) continue;
+        from_float_8_row(dst_b, src_b, w);
+        dst_b += dst_stride;
+        src_b += src_stride / sizeof(float);
+    }
+}
+
+void picture_copy_from_float_16_avx512(uint16_t *dst_a, uint16_t *dst_b,
+                                       ptrdiff_t dst_stride, const float *src_a,
+                                       const float *src_b, ptrdiff_t src_stride,
+                                       unsigned w, unsigned h, float scale)
+{
+    for (unsigned i = 0; i < h; i++) {
+        from_float_16_row(dst_a, src_a, w, scale);
+        dst_a += dst_stride / sizeof(uint16_t);
+        src_a += src_stride / sizeof(float);
+        if (!dst_b) continue;
+        from_float_16_row(dst_b, src_b, w, scale);
+        dst_b += dst_stride / sizeof(uint16_t);
+        src_b += src_stride / sizeof(float);
+    }
+}
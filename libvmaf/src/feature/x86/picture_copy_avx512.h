@@ -0,0 +1,43 @@
+/**
+ *
+ *  Copyright 2016-2020 Netflix, Inc.
+ *
+ *     Licensed under the BSD+Patent License (the "License");
+ *     you may not use this file except in compliance with the License.
+ *     You may obtain a copy of the License at
+ *
+ *         https://opensource.org/licenses/BSDplusPatent
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *
+ */
+
+#ifndef X86_AVX512_PICTURE_COPY_H_
+#define X86_AVX512_PICTURE_COPY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+void picture_copy_8_avx512(float *dst, ptrdiff_t dst_stride, const uint8_t *src,
+                           ptrdiff_t src_stride, unsigned w, unsigned h,
+                           float offset);
+
+void picture_copy_16_avx512(float *dst, ptrdiff_t dst_stride, const uint16_t *src,
+                            ptrdiff_t src_stride, unsigned w, unsigned h,
+                            float scale, float offset);
+
+void picture_copy_from_float_8_avx512(uint8_t *dst_a, uint8_t *dst_b,
+                                      ptrdiff_t dst_stride, const float *src_a,
+                                      const float *src_b, ptrdiff_t src_stride,
+                                      unsigned w, unsigned h);
+
+void picture_copy_from_float_16_avx512(uint16_t *dst_a, uint16_t *dst_b,
+                                       ptrdiff_t dst_stride, const float *src_a,
+                                       const float *src_b, ptrdiff_t src_stride,
+                                       unsigned w, unsigned h, float scale);
+
+#endif /* X86_AVX512_PICTURE_COPY_H_ */
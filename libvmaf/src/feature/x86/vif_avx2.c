@@ -76,8 +76,9 @@ void vif_filter1d_8_avx2(VifBuffer buf, unsigned w, unsigned h) {
 
 #pragma loop(ivdep)
     for (unsigned i = 0; i < h; ++i) {
+        ptrdiff_t row[18];
+        vif_filter_rows(buf, i, fwidth, buf.stride, row);
         // VERTICAL
-        int ii = i - fwidth_half;
 
         for (unsigned j = 0; j < w; j = j + 16) {
             __m256i accum_ref_lo, accum_ref_hi, accum_dis_lo, accum_dis_hi,
@@ -93,45 +94,44 @@ void vif_filter1d_8_avx2(VifBuffer buf, unsigned w, unsigned h) {
             dislo = dishi = refdislo = refdishi = final_resultlo =
                 final_resulthi = _mm256_setzero_si256();
 
-            int ii_check = ii;
             __m256i g0, g1, g2, g3, g4, g5, g6, g7, g8, g20, g21, g22, g23, g24,
                 g25, g26, g27, g28;
             __m256i s0, s1, s2, s3, s4, s5, s6, s7, s8, s20, s21, s22, s23, s24,
                 s25, s26, s27, s28, sg0, sg1, sg2, sg3, sg4, sg5, sg6, sg7, sg8;
 
             g0 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(ref + (buf.stride * ii_check) + j)));
+                (__m128i *)(ref + row[0] + j)));
             g1 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(ref + buf.stride * (ii_check + 1) + j)));
+                (__m128i *)(ref + row[1] + j)));
             g2 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(ref + buf.stride * (ii_check + 2) + j)));
+                (__m128i *)(ref + row[2] + j)));
             g3 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(ref + buf.stride * (ii_check + 3) + j)));
+                (__m128i *)(ref + row[3] + j)));
             g4 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(ref + buf.stride * (ii_check + 4) + j)));
+                (__m128i *)(ref + row[4] + j)));
             g5 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(ref + buf.stride * (ii_check + 5) + j)));
+                (__m128i *)(ref + row[5] + j)));
             g6 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(ref + buf.stride * (ii_check + 6) + j)));
+                (__m128i *)(ref + row[6] + j)));
             g7 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(ref + buf.stride * (ii_check + 7) + j)));
+                (__m128i *)(ref + row[7] + j)));
 
             s0 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(dis + (buf.stride * ii_check) + j)));
+                (__m128i *)(dis + row[0] + j)));
             s1 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(dis + buf.stride * (ii_check + 1) + j)));
+                (__m128i *)(dis + row[1] + j)));
             s2 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(dis + buf.stride * (ii_check + 2) + j)));
+                (__m128i *)(dis + row[2] + j)));
             s3 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(dis + buf.stride * (ii_check + 3) + j)));
+                (__m128i *)(dis + row[3] + j)));
             s4 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(dis + buf.stride * (ii_check + 4) + j)));
+                (__m128i *)(dis + row[4] + j)));
             s5 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(dis + buf.stride * (ii_check + 5) + j)));
+                (__m128i *)(dis + row[5] + j)));
             s6 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(dis + buf.stride * (ii_check + 6) + j)));
+                (__m128i *)(dis + row[6] + j)));
             s7 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(dis + buf.stride * (ii_check + 7) + j)));
+                (__m128i *)(dis + row[7] + j)));
 
             __m256i s0lo = _mm256_unpacklo_epi16(s0, s1);
             __m256i s0hi = _mm256_unpackhi_epi16(s0, s1);
@@ -360,38 +360,38 @@ void vif_filter1d_8_avx2(VifBuffer buf, unsigned w, unsigned h) {
                 refdishi, _mm256_unpackhi_epi16(result9lo, result9));
 
             g0 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(ref + buf.stride * (ii_check + 8) + j)));
+                (__m128i *)(ref + row[8] + j)));
             g1 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(ref + buf.stride * (ii_check + 9) + j)));
+                (__m128i *)(ref + row[9] + j)));
             g2 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(ref + buf.stride * (ii_check + 10) + j)));
+                (__m128i *)(ref + row[10] + j)));
             g3 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(ref + buf.stride * (ii_check + 11) + j)));
+                (__m128i *)(ref + row[11] + j)));
             g4 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(ref + buf.stride * (ii_check + 12) + j)));
+                (__m128i *)(ref + row[12] + j)));
             g5 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(ref + buf.stride * (ii_check + 13) + j)));
+                (__m128i *)(ref + row[13] + j)));
             g6 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(ref + buf.stride * (ii_check + 14) + j)));
+                (__m128i *)(ref + row[14] + j)));
             g7 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(ref + buf.stride * (ii_check + 15) + j)));
+                (__m128i *)(ref + row[15] + j)));
 
             s0 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(dis + buf.stride * (ii_check + 8) + j)));
+                (__m128i *)(dis + row[8] + j)));
             s1 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(dis + buf.stride * (ii_check + 9) + j)));
+                (__m128i *)(dis + row[9] + j)));
             s2 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(dis + buf.stride * (ii_check + 10) + j)));
+                (__m128i *)(dis + row[10] + j)));
             s3 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(dis + buf.stride * (ii_check + 11) + j)));
+                (__m128i *)(dis + row[11] + j)));
             s4 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(dis + buf.stride * (ii_check + 12) + j)));
+                (__m128i *)(dis + row[12] + j)));
             s5 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(dis + buf.stride * (ii_check + 13) + j)));
+                (__m128i *)(dis + row[13] + j)));
             s6 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(dis + buf.stride * (ii_check + 14) + j)));
+                (__m128i *)(dis + row[14] + j)));
             s7 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(dis + buf.stride * (ii_check + 15) + j)));
+                (__m128i *)(dis + row[15] + j)));
 
             s0lo = _mm256_unpacklo_epi16(s0, s1);
             s0hi = _mm256_unpackhi_epi16(s0, s1);
@@ -618,14 +618,14 @@ void vif_filter1d_8_avx2(VifBuffer buf, unsigned w, unsigned h) {
                 refdishi, _mm256_unpackhi_epi16(result9lo, result9));
 
             g0 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(ref + buf.stride * (ii_check + 16) + j)));
+                (__m128i *)(ref + row[16] + j)));
             g1 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(ref + buf.stride * (ii_check + 17) + j)));
+                (__m128i *)(ref + row[17] + j)));
 
             s0 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(dis + buf.stride * (ii_check + 16) + j)));
+                (__m128i *)(dis + row[16] + j)));
             s1 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(dis + buf.stride * (ii_check + 17) + j)));
+                (__m128i *)(dis + row[17] + j)));
 
             s0lo = _mm256_unpacklo_epi16(s0, s1);
             s0hi = _mm256_unpackhi_epi16(s0, s1);
@@ -1421,8 +1421,9 @@ void vif_filter1d_16_avx2(VifBuffer buf, unsigned w, unsigned h, int scale,
     }
 
     for (unsigned i = 0; i < h; ++i) {
+        ptrdiff_t row[18];
+        vif_filter_rows(buf, i, fwidth, stride, row);
         // VERTICAL
-        int ii = i - fwidth_half;
         int n = w >> 4;
         for (unsigned j = 0; j < n << 4; j = j + 16) {
             uint32_t accum_mu1 = 0;
@@ -1434,7 +1435,6 @@ void vif_filter1d_16_avx2(VifBuffer buf, unsigned w, unsigned h, int scale,
                                             9, 8, 5, 4, 1, 0, 15, 14, 11, 10, 7,
                                             6, 3, 2, 13, 12, 9, 8, 5, 4, 1, 0);
             __m256i mask2 = _mm256_set_epi32(7, 5, 3, 1, 6, 4, 2, 0);
-            int ii_check = ii;
 
             uint16_t *ref = buf.ref;
             uint16_t *dis = buf.dis;
@@ -1448,13 +1448,13 @@ void vif_filter1d_16_avx2(VifBuffer buf, unsigned w, unsigned h, int scale,
                         accumdis1 = accumdis2 = accumdis3 = accumdis4 =
                             _mm256_setzero_si256();
             __m256i addnum = _mm256_set1_epi32(add_shift_round_VP);
-            for (unsigned fi = 0; fi < fwidth; ++fi, ii_check = ii + fi) {
+            for (unsigned fi = 0; fi < fwidth; ++fi) {
                 const uint16_t fcoeff = vif_filt[fi];
                 __m256i f1 = _mm256_set1_epi16(vif_filt[fi]);
                 __m256i ref1 = _mm256_loadu_si256(
-                    (__m256i *)(ref + (ii_check * stride) + j));
+                    (__m256i *)(ref + row[fi] + j));
                 __m256i dis1 = _mm256_loadu_si256(
-                    (__m256i *)(dis + (ii_check * stride) + j));
+                    (__m256i *)(dis + row[fi] + j));
                 __m256i result2 = _mm256_mulhi_epu16(ref1, f1);
                 __m256i result2lo = _mm256_mullo_epi16(ref1, f1);
                 rmul1 = _mm256_unpacklo_epi16(result2lo, result2);
@@ -1622,13 +1622,12 @@ void vif_filter1d_16_avx2(VifBuffer buf, unsigned w, unsigned h, int scale,
             uint64_t accum_dis = 0;
             uint64_t accum_ref_dis = 0;
 
-            int ii_check = ii;
-            for (unsigned fi = 0; fi < fwidth; ++fi, ii_check = ii + fi) {
+            for (unsigned fi = 0; fi < fwidth; ++fi) {
                 const uint16_t fcoeff = vif_filt[fi];
                 uint16_t *ref = buf.ref;
                 uint16_t *dis = buf.dis;
-                uint16_t imgcoeff_ref = ref[ii_check * stride + j];
-                uint16_t imgcoeff_dis = dis[ii_check * stride + j];
+                uint16_t imgcoeff_ref = ref[row[fi] + j];
+                uint16_t imgcoeff_dis = dis[row[fi] + j];
                 uint32_t img_coeff_ref = fcoeff * (uint32_t)imgcoeff_ref;
                 uint32_t img_coeff_dis = fcoeff * (uint32_t)imgcoeff_dis;
                 accum_mu1 += img_coeff_ref;
@@ -1845,11 +1844,11 @@ void vif_filter1d_rd_8_avx2(VifBuffer buf, unsigned w, unsigned h) {
     __m256i fcoeff8 = _mm256_set1_epi16(vif_filt_s1[8]);
 
     for (unsigned i = 0; i < h; ++i) {
+        ptrdiff_t row[18];
+        vif_filter_rows(buf, i, fwidth, buf.stride, row);
         // VERTICAL
         int n = w >> 4;
         for (unsigned j = 0; j < n << 4; j = j + 16) {
-            int ii = i - fwidth_half;
-            int ii_check = ii;
             __m256i accum_mu2_lo, accum_mu1_lo, accum_mu2_hi, accum_mu1_hi;
             accum_mu2_lo = accum_mu2_hi = accum_mu1_lo = accum_mu1_hi =
                 _mm256_setzero_si256();
@@ -1857,46 +1856,46 @@ void vif_filter1d_rd_8_avx2(VifBuffer buf, unsigned w, unsigned h) {
             __m256i s0, s1, s2, s3, s4, s5, s6, s7, s8, s9, s20, s21, sg0, sg1;
 
             g0 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(ref + (buf.stride * ii_check) + j)));
+                (__m128i *)(ref + row[0] + j)));
             g1 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(ref + buf.stride * (ii_check + 1) + j)));
+                (__m128i *)(ref + row[1] + j)));
             g2 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(ref + buf.stride * (ii_check + 2) + j)));
+                (__m128i *)(ref + row[2] + j)));
             g3 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(ref + buf.stride * (ii_check + 3) + j)));
+                (__m128i *)(ref + row[3] + j)));
             g4 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(ref + buf.stride * (ii_check + 4) + j)));
+                (__m128i *)(ref + row[4] + j)));
             g5 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(ref + buf.stride * (ii_check + 5) + j)));
+                (__m128i *)(ref + row[5] + j)));
             g6 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(ref + buf.stride * (ii_check + 6) + j)));
+                (__m128i *)(ref + row[6] + j)));
             g7 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(ref + buf.stride * (ii_check + 7) + j)));
+                (__m128i *)(ref + row[7] + j)));
             g8 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(ref + buf.stride * (ii_check + 8) + j)));
+                (__m128i *)(ref + row[8] + j)));
             g9 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(ref + buf.stride * (ii_check + 9) + j)));
+                (__m128i *)(ref + row[9] + j)));
 
             s0 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(dis + (buf.stride * ii_check) + j)));
+                (__m128i *)(dis + row[0] + j)));
             s1 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(dis + buf.stride * (ii_check + 1) + j)));
+                (__m128i *)(dis + row[1] + j)));
             s2 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(dis + buf.stride * (ii_check + 2) + j)));
+                (__m128i *)(dis + row[2] + j)));
             s3 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(dis + buf.stride * (ii_check + 3) + j)));
+                (__m128i *)(dis + row[3] + j)));
             s4 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(dis + buf.stride * (ii_check + 4) + j)));
+                (__m128i *)(dis + row[4] + j)));
             s5 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(dis + buf.stride * (ii_check + 5) + j)));
+                (__m128i *)(dis + row[5] + j)));
             s6 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(dis + buf.stride * (ii_check + 6) + j)));
+                (__m128i *)(dis + row[6] + j)));
             s7 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(dis + buf.stride * (ii_check + 7) + j)));
+                (__m128i *)(dis + row[7] + j)));
             s8 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(dis + buf.stride * (ii_check + 8) + j)));
+                (__m128i *)(dis + row[8] + j)));
             s9 = _mm256_cvtepu8_epi16(_mm_loadu_si128(
-                (__m128i *)(dis + buf.stride * (ii_check + 9) + j)));
+                (__m128i *)(dis + row[9] + j)));
 
             __m256i s0lo = _mm256_unpacklo_epi16(s0, s1);
             __m256i s0hi = _mm256_unpackhi_epi16(s0, s1);
@@ -1985,13 +1984,11 @@ void vif_filter1d_rd_8_avx2(VifBuffer buf, unsigned w, unsigned h) {
             uint32_t accum_ref = 0;
             uint32_t accum_dis = 0;
             for (unsigned fi = 0; fi < fwidth; ++fi) {
-                int ii = i - fwidth_half;
-                int ii_check = ii + fi;
                 const uint16_t fcoeff = vif_filt_s1[fi];
                 const uint8_t *ref = (uint8_t *)buf.ref;
                 const uint8_t *dis = (uint8_t *)buf.dis;
-                accum_ref += fcoeff * (uint32_t)ref[ii_check * buf.stride + j];
-                accum_dis += fcoeff * (uint32_t)dis[ii_check * buf.stride + j];
+                accum_ref += fcoeff * (uint32_t)ref[row[fi] + j];
+                accum_dis += fcoeff * (uint32_t)dis[row[fi] + j];
             }
             buf.tmp.ref_convol[j] = (accum_ref + 128) >> 8;
             buf.tmp.dis_convol[j] = (accum_dis + 128) >> 8;
@@ -2176,7 +2173,7 @@ void vif_filter1d_rd_8_avx2(VifBuffer buf, unsigned w, unsigned h) {
             _mm_storeu_si128((__m128i *)(buf.mu2 + i * stride + j),
                              _mm256_castsi256_si128(result));
         }
-        for (unsigned j = n << 3; j < w; j = j++) {
+        for (unsigned j = n << 3; j < w; ++j) {
             uint32_t accum_ref = 0;
             uint32_t accum_dis = 0;
             int jj = j - fwidth_half;
@@ -2214,23 +2211,23 @@ void vif_filter1d_rd_16_avx2(VifBuffer buf, unsigned w, unsigned h, int scale,
     }
 
     for (unsigned i = 0; i < h; ++i) {
+        ptrdiff_t row[18];
+        vif_filter_rows(buf, i, fwidth, stride, row);
         // VERTICAL
 
         int n = w >> 4;
-        int ii = i - fwidth_half;
         for (unsigned j = 0; j < n << 4; j = j + 16) {
-            int ii_check = ii;
             __m256i accumr_lo, accumr_hi, accumd_lo, accumd_hi, rmul1, rmul2,
                 dmul1, dmul2;
             accumr_lo = accumr_hi = accumd_lo = accumd_hi = rmul1 = rmul2 =
                 dmul1 = dmul2 = _mm256_setzero_si256();
-            for (unsigned fi = 0; fi < fwidth; ++fi, ii_check = ii + fi) {
+            for (unsigned fi = 0; fi < fwidth; ++fi) {
                 const uint16_t fcoeff = vif_filt[fi];
                 __m256i f1 = _mm256_set1_epi16(vif_filt[fi]);
                 __m256i ref1 = _mm256_loadu_si256(
-                    (__m256i *)(ref + (ii_check * stride) + j));
+                    (__m256i *)(ref + row[fi] + j));
                 __m256i dis1 = _mm256_loadu_si256(
-                    (__m256i *)(dis + (ii_check * stride) + j));
+                    (__m256i *)(dis + row[fi] + j));
                 __m256i result2 = _mm256_mulhi_epu16(ref1, f1);
                 __m256i result2lo = _mm256_mullo_epi16(ref1, f1);
                 rmul1 = _mm256_unpacklo_epi16(result2lo, result2);
@@ -2276,11 +2273,10 @@ void vif_filter1d_rd_16_avx2(VifBuffer buf, unsigned w, unsigned h, int scale,
         for (unsigned j = n << 4; j < w; ++j) {
             uint32_t accum_ref = 0;
             uint32_t accum_dis = 0;
-            int ii_check = ii;
-            for (unsigned fi = 0; fi < fwidth; ++fi, ii_check = ii + fi) {
+            for (unsigned fi = 0; fi < fwidth; ++fi) {
                 const uint16_t fcoeff = vif_filt[fi];
-                accum_ref += fcoeff * ((uint32_t)ref[ii_check * stride + j]);
-                accum_dis += fcoeff * ((uint32_t)dis[ii_check * stride + j]);
+                accum_ref += fcoeff * ((uint32_t)ref[row[fi] + j]);
+                accum_dis += fcoeff * ((uint32_t)dis[row[fi] + j]);
             }
             buf.tmp.ref_convol[j] =
                 (uint16_t)((accum_ref + add_shift_round_VP) >> shift_VP);
@@ -2359,3 +2355,175 @@ void vif_filter1d_rd_16_avx2(VifBuffer buf, unsigned w, unsigned h, int scale,
         }
     }
 }
+
+/*
+ * vif_statistic() evaluates its gain terms in double precision and reads
+ * its logarithms from log2_table, both are reproduced lane by lane here so
+ * the sums are bit-exact with the C reference for any bit depth.
+ */
+typedef struct VifAccumAvx2 {
+    __m256i x, x2, num_x;
+    __m256i num_log, den_log;
+    __m256i num_non_log, den_non_log;
+} VifAccumAvx2;
+
+/* (a * b + 2^31) >> 32 on unsigned 32-bit lanes */
+static inline __m256i mul_hi32_round(__m256i a, __m256i b)
+{
+    const __m256i round = _mm256_set1_epi64x(1ULL << 31);
+    const __m256i even = _mm256_add_epi64(_mm256_mul_epu32(a, b), round);
+    const __m256i odd = _mm256_add_epi64(
+        _mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32)),
+        round);
+    return _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+}
+
+/*
+ * Lanes hold positive integers which doubles represent exactly, their top
+ * 16 bits are returned as in get_best16_from32/64(). Those also return a
+ * shift of 16 - bit length, which is 1038 - `exp` in terms of the biased
+ * exponent written to `exp`.
+ */
+static inline __m256i best16(__m256d v, __m256i *exp)
+{
+    const __m256i bits = _mm256_castpd_si256(v);
+    *exp = _mm256_srli_epi64(bits, 52);
+    const __m256i mant = _mm256_and_si256(_mm256_srli_epi64(bits, 37),
+                                          _mm256_set1_epi64x(0x7fff));
+    return _mm256_or_si256(mant, _mm256_set1_epi64x(0x8000));
+}
+
+static inline __m128i log2_lookup(const uint16_t *log2_table, __m256i idx)
+{
+    const __m128i v = _mm256_i64gather_epi32((const int *)log2_table, idx, 2);
+    return _mm_and_si128(v, _mm_set1_epi32(0xffff));
+}
+
+static inline void vif_statistic_4(VifAccumAvx2 *a, __m128i sigma1_sq,
+                                   __m128i sigma2_sq, __m128i sigma12,
+                                   __m128i valid, const uint16_t *log2_table,
+                                   __m256d gain_limit)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m256d eps = _mm256_set1_pd(65536 * 1.0e-10);
+    const __m256d sigma_nsq = _mm256_set1_pd(65536 << 1);
+
+    const __m256d s1 = _mm256_cvtepi32_pd(sigma1_sq);
+    const __m256d s2 = _mm256_cvtepi32_pd(sigma2_sq);
+    const __m256d s12 = _mm256_cvtepi32_pd(sigma12);
+    __m256d g = _mm256_div_pd(s12, _mm256_add_pd(s1, eps));
+    __m128i sv_sq =
+        _mm256_cvttpd_epi32(_mm256_sub_pd(s2, _mm256_mul_pd(g, s12)));
+
+    // sigma1_sq and sigma2_sq are integers, `< eps` means zero. With both
+    // non-zero g has the sign of sigma12.
+    const __m128i s1_zero = _mm_cmpeq_epi32(sigma1_sq, zero);
+    const __m128i s2_zero = _mm_cmpeq_epi32(sigma2_sq, zero);
+    const __m128i g_neg = _mm_andnot_si128(_mm_or_si128(s1_zero, s2_zero),
+                                           _mm_cmpgt_epi32(zero, sigma12));
+    const __m128i g_zero = _mm_or_si128(_mm_or_si128(s1_zero, s2_zero), g_neg);
+    sv_sq = _mm_blendv_epi8(sv_sq, sigma2_sq, _mm_or_si128(s1_zero, g_neg));
+    sv_sq = _mm_andnot_si128(s2_zero, sv_sq);
+    sv_sq = _mm_max_epi32(sv_sq, zero);
+    g = _mm256_andnot_pd(_mm256_castsi256_pd(_mm256_cvtepi32_epi64(g_zero)), g);
+    g = _mm256_min_pd(g, gain_limit);
+
+    const __m128i log = _mm_and_si128(valid,
+        _mm_cmpgt_epi32(sigma1_sq, _mm_set1_epi32((65536 << 1) - 1)));
+    const __m256i log_mask = _mm256_cvtepi32_epi64(log);
+    const __m256i non_log_mask =
+        _mm256_cvtepi32_epi64(_mm_andnot_si128(log, valid));
+    const __m256i num_mask = _mm256_cvtepi32_epi64(
+        _mm_and_si128(log, _mm_cmpgt_epi32(sigma12, _mm_set1_epi32(-1))));
+
+    a->num_non_log = _mm256_add_epi64(a->num_non_log,
+        _mm256_and_si256(non_log_mask, _mm256_cvtepi32_epi64(sigma2_sq)));
+    a->den_non_log = _mm256_sub_epi64(a->den_non_log, non_log_mask);
+
+    __m256i exp_den, exp_num, exp_numer1;
+    const __m256i den_idx = best16(_mm256_add_pd(s1, sigma_nsq), &exp_den);
+    a->x = _mm256_add_epi64(a->x, _mm256_and_si256(log_mask,
+        _mm256_sub_epi64(_mm256_set1_epi64x(1038), exp_den)));
+    a->num_x = _mm256_sub_epi64(a->num_x, log_mask);
+    a->den_log = _mm256_add_epi64(a->den_log, _mm256_and_si256(log_mask,
+        _mm256_cvtepi32_epi64(log2_lookup(log2_table, den_idx))));
+
+    // numerator terms stay below 2^53, so they are exact as doubles
+    const __m256d numer1 = _mm256_add_pd(_mm256_cvtepi32_pd(sv_sq), sigma_nsq);
+    __m256d numer1_tmp = _mm256_mul_pd(_mm256_mul_pd(g, g), s1);
+    numer1_tmp = _mm256_round_pd(numer1_tmp,
+                                 _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    numer1_tmp = _mm256_add_pd(numer1_tmp, numer1);
+    const __m256i num_idx = best16(numer1_tmp, &exp_num);
+    const __m256i numer1_idx = best16(numer1, &exp_numer1);
+    const __m128i num_val = _mm_sub_epi32(log2_lookup(log2_table, num_idx),
+                                          log2_lookup(log2_table, numer1_idx));
+    a->x2 = _mm256_add_epi64(a->x2, _mm256_and_si256(num_mask,
+        _mm256_sub_epi64(exp_num, exp_numer1)));
+    a->num_log = _mm256_add_epi64(a->num_log,
+        _mm256_and_si256(num_mask, _mm256_cvtepi32_epi64(num_val)));
+}
+
+static inline int64_t hsum_epi64(__m256i v)
+{
+    const __m128i s = _mm_add_epi64(_mm256_castsi256_si128(v),
+                                    _mm256_extracti128_si256(v, 1));
+    return _mm_cvtsi128_si64(s) + _mm_extract_epi64(s, 1);
+}
+
+void vif_statistic_avx2(VifBuffer buf, VifAccum *accum, unsigned w, unsigned h,
+                        uint16_t *log2_table, double vif_enhn_gain_limit)
+{
+    const ptrdiff_t stride = buf.stride_32 / sizeof(uint32_t);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256d gain_limit = _mm256_set1_pd(vif_enhn_gain_limit);
+    VifAccumAvx2 a = {
+        zero, zero, zero, zero, zero, zero, zero,
+    };
+
+    for (unsigned i = 0; i < h; ++i) {
+        for (unsigned j = 0; j < w; j += 8) {
+            // lanes past the end of a row load as zero and are masked off
+            const __m256i valid =
+                _mm256_cmpgt_epi32(_mm256_set1_epi32(w - j), lane);
+            const ptrdiff_t k = i * stride + j;
+            const __m256i mu1 =
+                _mm256_maskload_epi32((const int *)(buf.mu1_32 + k), valid);
+            const __m256i mu2 =
+                _mm256_maskload_epi32((const int *)(buf.mu2_32 + k), valid);
+            const __m256i xx =
+                _mm256_maskload_epi32((const int *)(buf.ref_sq + k), valid);
+            const __m256i yy =
+                _mm256_maskload_epi32((const int *)(buf.dis_sq + k), valid);
+            const __m256i xy =
+                _mm256_maskload_epi32((const int *)(buf.ref_dis + k), valid);
+
+            const __m256i sigma1_sq = _mm256_max_epi32(
+                _mm256_sub_epi32(xx, mul_hi32_round(mu1, mu1)), zero);
+            const __m256i sigma2_sq = _mm256_max_epi32(
+                _mm256_sub_epi32(yy, mul_hi32_round(mu2, mu2)), zero);
+            const __m256i sigma12 =
+                _mm256_sub_epi32(xy, mul_hi32_round(mu1, mu2));
+
+            vif_statistic_4(&a, _mm256_castsi256_si128(sigma1_sq),
+                            _mm256_castsi256_si128(sigma2_sq),
+                            _mm256_castsi256_si128(sigma12),
+                            _mm256_castsi256_si128(valid), log2_table,
+                            gain_limit);
+            vif_statistic_4(&a, _mm256_extracti128_si256(sigma1_sq, 1),
+                            _mm256_extracti128_si256(sigma2_sq, 1),
+                            _mm256_extracti128_si256(sigma12, 1),
+                            _mm256_extracti128_si256(valid, 1), log2_table,
+                            gain_limit);
+        }
+    }
+
+    accum->x = hsum_epi64(a.x);
+    accum->x2 = hsum_epi64(a.x2);
+    accum->num_x = hsum_epi64(a.num_x);
+    accum->num_log = hsum_epi64(a.num_log);
+    accum->den_log = hsum_epi64(a.den_log);
+    accum->num_non_log = hsum_epi64(a.num_non_log);
+    accum->den_non_log = hsum_epi64(a.den_non_log);
+}
@@ -70,8 +70,9 @@ void vif_filter1d_8_avx512(VifBuffer buf, unsigned w, unsigned h)
 
     for (unsigned i = 0; i < h; ++i)
     {
+        ptrdiff_t row[18];
+        vif_filter_rows(buf, i, fwidth, buf.stride, row);
         //VERTICAL
-        int ii = i - fwidth_half;
 
         for (unsigned j = 0; j < w; j = j + 32)
         {
@@ -87,45 +88,44 @@ void vif_filter1d_8_avx512(VifBuffer buf, unsigned w, unsigned h)
             dislo = dishi = refdislo = refdishi = final_resultlo =
                 final_resulthi = _mm512_setzero_si512();
 
-            int ii_check = ii;
             __m512i g0, g1, g2, g3, g4, g5, g6, g7, g8, g20, g21, g22,
                 g23, g24, g25, g26, g27, g28;
             __m512i s0, s1, s2, s3, s4, s5, s6, s7, s8, s20, s21, s22,
                 s23, s24, s25, s26, s27, s28, sg0, sg1, sg2, sg3, sg4, sg5, sg6, sg7, sg8;
 
             g0 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(ref + (buf.stride * ii_check) + j)));
+                (__m256i *)(ref + row[0] + j)));
             g1 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(ref + buf.stride * (ii_check + 1) + j)));
+                (__m256i *)(ref + row[1] + j)));
             g2 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(ref + buf.stride * (ii_check + 2) + j)));
+                (__m256i *)(ref + row[2] + j)));
             g3 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(ref + buf.stride * (ii_check + 3) + j)));
+                (__m256i *)(ref + row[3] + j)));
             g4 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(ref + buf.stride * (ii_check + 4) + j)));
+                (__m256i *)(ref + row[4] + j)));
             g5 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(ref + buf.stride * (ii_check + 5) + j)));
+                (__m256i *)(ref + row[5] + j)));
             g6 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(ref + buf.stride * (ii_check + 6) + j)));
+                (__m256i *)(ref + row[6] + j)));
             g7 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(ref + buf.stride * (ii_check + 7) + j)));
+                (__m256i *)(ref + row[7] + j)));
 
             s0 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(dis + (buf.stride * ii_check) + j)));
+                (__m256i *)(dis + row[0] + j)));
             s1 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(dis + buf.stride * (ii_check + 1) + j)));
+                (__m256i *)(dis + row[1] + j)));
             s2 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(dis + buf.stride * (ii_check + 2) + j)));
+                (__m256i *)(dis + row[2] + j)));
             s3 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(dis + buf.stride * (ii_check + 3) + j)));
+                (__m256i *)(dis + row[3] + j)));
             s4 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(dis + buf.stride * (ii_check + 4) + j)));
+                (__m256i *)(dis + row[4] + j)));
             s5 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(dis + buf.stride * (ii_check + 5) + j)));
+                (__m256i *)(dis + row[5] + j)));
             s6 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(dis + buf.stride * (ii_check + 6) + j)));
+                (__m256i *)(dis + row[6] + j)));
             s7 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(dis + buf.stride * (ii_check + 7) + j)));
+                (__m256i *)(dis + row[7] + j)));
 
             __m512i s0lo = _mm512_unpacklo_epi16(s0, s1);
             __m512i s0hi = _mm512_unpackhi_epi16(s0, s1);
@@ -354,38 +354,38 @@ void vif_filter1d_8_avx512(VifBuffer buf, unsigned w, unsigned h)
                 refdishi, _mm512_unpackhi_epi16(result9lo, result9));
 
             g0 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(ref + buf.stride * (ii_check + 8) + j)));
+                (__m256i *)(ref + row[8] + j)));
             g1 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(ref + buf.stride * (ii_check + 9) + j)));
+                (__m256i *)(ref + row[9] + j)));
             g2 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(ref + buf.stride * (ii_check + 10) + j)));
+                (__m256i *)(ref + row[10] + j)));
             g3 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(ref + buf.stride * (ii_check + 11) + j)));
+                (__m256i *)(ref + row[11] + j)));
             g4 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(ref + buf.stride * (ii_check + 12) + j)));
+                (__m256i *)(ref + row[12] + j)));
             g5 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(ref + buf.stride * (ii_check + 13) + j)));
+                (__m256i *)(ref + row[13] + j)));
             g6 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(ref + buf.stride * (ii_check + 14) + j)));
+                (__m256i *)(ref + row[14] + j)));
             g7 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(ref + buf.stride * (ii_check + 15) + j)));
+                (__m256i *)(ref + row[15] + j)));
 
             s0 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(dis + buf.stride * (ii_check + 8) + j)));
+                (__m256i *)(dis + row[8] + j)));
             s1 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(dis + buf.stride * (ii_check + 9) + j)));
+                (__m256i *)(dis + row[9] + j)));
             s2 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(dis + buf.stride * (ii_check + 10) + j)));
+                (__m256i *)(dis + row[10] + j)));
             s3 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(dis + buf.stride * (ii_check + 11) + j)));
+                (__m256i *)(dis + row[11] + j)));
             s4 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(dis + buf.stride * (ii_check + 12) + j)));
+                (__m256i *)(dis + row[12] + j)));
             s5 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(dis + buf.stride * (ii_check + 13) + j)));
+                (__m256i *)(dis + row[13] + j)));
             s6 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(dis + buf.stride * (ii_check + 14) + j)));
+                (__m256i *)(dis + row[14] + j)));
             s7 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(dis + buf.stride * (ii_check + 15) + j)));
+                (__m256i *)(dis + row[15] + j)));
 
             s0lo = _mm512_unpacklo_epi16(s0, s1);
             s0hi = _mm512_unpackhi_epi16(s0, s1);
@@ -612,14 +612,14 @@ void vif_filter1d_8_avx512(VifBuffer buf, unsigned w, unsigned h)
                 refdishi, _mm512_unpackhi_epi16(result9lo, result9));
 
             g0 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(ref + buf.stride * (ii_check + 16) + j)));
+                (__m256i *)(ref + row[16] + j)));
             g1 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(ref + buf.stride * (ii_check + 17) + j)));
+                (__m256i *)(ref + row[17] + j)));
 
             s0 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(dis + buf.stride * (ii_check + 16) + j)));
+                (__m256i *)(dis + row[16] + j)));
             s1 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
-                (__m256i *)(dis + buf.stride * (ii_check + 17) + j)));
+                (__m256i *)(dis + row[17] + j)));
 
             s0lo = _mm512_unpacklo_epi16(s0, s1);
             s0hi = _mm512_unpackhi_epi16(s0, s1);
@@ -1404,15 +1404,15 @@ void vif_filter1d_16_avx512(VifBuffer buf, unsigned w, unsigned h, int scale,
     {
         for (unsigned i = 0; i < h; ++i)
         {
+            ptrdiff_t row[18];
+            vif_filter_rows(buf, i, fwidth, stride, row);
             //VERTICAL
-            int ii = i - fwidth_half;
             int n = w >> 5;
             for (unsigned j = 0; j < n << 5; j = j + 32)
             {
 
                 __m512i mask3 = _mm512_set_epi64(11, 10, 3, 2, 9, 8, 1, 0);   //first half of 512
                 __m512i mask4 = _mm512_set_epi64(15, 14, 7, 6, 13, 12, 5, 4); //second half of 512
-                int ii_check = ii;
                 __m512i accumr_lo, accumr_hi, accumd_lo, accumd_hi, rmul1, rmul2,
                     dmul1, dmul2, accumref1, accumref2, accumref3, accumref4,
                     accumrefdis1, accumrefdis2, accumrefdis3, accumrefdis4,
@@ -1420,15 +1420,15 @@ void vif_filter1d_16_avx512(VifBuffer buf, unsigned w, unsigned h, int scale,
                 accumr_lo = accumr_hi = accumd_lo = accumd_hi = rmul1 = rmul2 = dmul1 = dmul2 = accumref1 = accumref2 = accumref3 = accumref4 = accumrefdis1 = accumrefdis2 = accumrefdis3 =
                     accumrefdis4 = accumdis1 = accumdis2 = accumdis3 = accumdis4 = _mm512_setzero_si512();
 
-                for (unsigned fi = 0; fi < fwidth; ++fi, ii_check = ii + fi)
+                for (unsigned fi = 0; fi < fwidth; ++fi)
                 {
 
                     const uint16_t fcoeff = vif_filt[fi];
                     __m512i f1 = _mm512_set1_epi16(vif_filt[fi]);
                     __m512i ref1 = _mm512_loadu_si512(
-                        (__m512i *)(ref + (ii_check * stride) + j));
+                        (__m512i *)(ref + row[fi] + j));
                     __m512i dis1 = _mm512_loadu_si512(
-                        (__m512i *)(dis + (ii_check * stride) + j));
+                        (__m512i *)(dis + row[fi] + j));
                     __m512i result2 = _mm512_mulhi_epu16(ref1, f1);
                     __m512i result2lo = _mm512_mullo_epi16(ref1, f1);
                     __m512i rmult1 = _mm512_unpacklo_epi16(result2lo, result2);
@@ -1554,14 +1554,11 @@ void vif_filter1d_16_avx512(VifBuffer buf, unsigned w, unsigned h, int scale,
                 uint64_t accum_ref_dis = 0;
                 for (unsigned fi = 0; fi < fwidth; ++fi)
                 {
-                    int ii = i - fwidth / 2;
-                    int ii_check = ii + fi;
                     const uint16_t fcoeff = vif_filt[fi];
-                    const ptrdiff_t stride = buf.stride / sizeof(uint16_t);
                     uint16_t *ref = buf.ref;
                     uint16_t *dis = buf.dis;
-                    uint16_t imgcoeff_ref = ref[ii_check * stride + j];
-                    uint16_t imgcoeff_dis = dis[ii_check * stride + j];
+                    uint16_t imgcoeff_ref = ref[row[fi] + j];
+                    uint16_t imgcoeff_dis = dis[row[fi] + j];
                     uint32_t img_coeff_ref = fcoeff * (uint32_t)imgcoeff_ref;
                     uint32_t img_coeff_dis = fcoeff * (uint32_t)imgcoeff_dis;
                     accum_mu1 += img_coeff_ref;
@@ -1732,13 +1729,13 @@ void vif_filter1d_rd_8_avx512(VifBuffer buf, unsigned w, unsigned h)
 
     for (unsigned i = 0; i < h; ++i)
     {
+        ptrdiff_t row[18];
+        vif_filter_rows(buf, i, fwidth, buf.stride, row);
         //VERTICAL
         int n = w >> 5;
-        int ii = i - fwidth_half;
         for (unsigned j = 0; j < n << 5; j = j + 32)
         {
 
-            int ii_check = ii;
             __m512i accum_mu2_lo, accum_mu1_lo, accum_mu2_hi, accum_mu1_hi;
             accum_mu2_lo = accum_mu2_hi = accum_mu1_lo = accum_mu1_hi = _mm512_setzero_si512();
 
@@ -1746,27 +1743,27 @@ void vif_filter1d_rd_8_avx512(VifBuffer buf, unsigned w, unsigned h)
                 __m512i g0, g1, g2, g3, g4, g5, g6, g7, g8, g9, g20, g21;
                 __m512i s0, s1, s2, s3, s4, s5, s6, s7, s8, s9, s20, s21, sg0, sg1;
 
-                g0 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(ref + (buf.stride * ii_check) + j)));
-                g1 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(ref + buf.stride * (ii_check) + buf.stride + j)));
-                g2 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(ref + buf.stride * (ii_check + 2) + j)));
-                g3 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(ref + buf.stride * (ii_check + 3) + j)));
-                g4 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(ref + buf.stride * (ii_check + 4) + j)));
-                g5 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(ref + buf.stride * (ii_check + 5) + j)));
-                g6 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(ref + buf.stride * (ii_check + 6) + j)));
-                g7 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(ref + buf.stride * (ii_check + 7) + j)));
-                g8 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(ref + buf.stride * (ii_check + 8) + j)));
-                g9 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(ref + buf.stride * (ii_check + 9) + j)));
-
-                s0 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(dis + (buf.stride * ii_check) + j)));
-                s1 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(dis + buf.stride * (ii_check + 1) + j)));
-                s2 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(dis + buf.stride * (ii_check + 2) + j)));
-                s3 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(dis + buf.stride * (ii_check + 3) + j)));
-                s4 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(dis + buf.stride * (ii_check + 4) + j)));
-                s5 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(dis + buf.stride * (ii_check + 5) + j)));
-                s6 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(dis + buf.stride * (ii_check + 6) + j)));
-                s7 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(dis + buf.stride * (ii_check + 7) + j)));
-                s8 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(dis + buf.stride * (ii_check + 8) + j)));
-                s9 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(dis + buf.stride * (ii_check + 9) + j)));
+                g0 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(ref + row[0] + j)));
+                g1 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(ref + row[1] + j)));
+                g2 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(ref + row[2] + j)));
+                g3 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(ref + row[3] + j)));
+                g4 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(ref + row[4] + j)));
+                g5 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(ref + row[5] + j)));
+                g6 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(ref + row[6] + j)));
+                g7 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(ref + row[7] + j)));
+                g8 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(ref + row[8] + j)));
+                g9 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(ref + row[9] + j)));
+
+                s0 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(dis + row[0] + j)));
+                s1 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(dis + row[1] + j)));
+                s2 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(dis + row[2] + j)));
+                s3 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(dis + row[3] + j)));
+                s4 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(dis + row[4] + j)));
+                s5 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(dis + row[5] + j)));
+                s6 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(dis + row[6] + j)));
+                s7 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(dis + row[7] + j)));
+                s8 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(dis + row[8] + j)));
+                s9 = _mm512_cvtepu8_epi16(_mm256_loadu_si256((__m256i *)(dis + row[9] + j)));
 
                 __m512i s0lo = _mm512_unpacklo_epi16(s0, s1);
                 __m512i s0hi = _mm512_unpackhi_epi16(s0, s1);
@@ -1853,13 +1850,11 @@ void vif_filter1d_rd_8_avx512(VifBuffer buf, unsigned w, unsigned h)
             uint32_t accum_dis = 0;
             for (unsigned fi = 0; fi < fwidth; ++fi)
             {
-                int ii = i - fwidth_half;
-                int ii_check = ii + fi;
                 const uint16_t fcoeff = vif_filt_s1[fi];
                 const uint8_t *ref = (uint8_t *)buf.ref;
                 const uint8_t *dis = (uint8_t *)buf.dis;
-                accum_ref += fcoeff * (uint32_t)ref[ii_check * buf.stride + j];
-                accum_dis += fcoeff * (uint32_t)dis[ii_check * buf.stride + j];
+                accum_ref += fcoeff * (uint32_t)ref[row[fi] + j];
+                accum_dis += fcoeff * (uint32_t)dis[row[fi] + j];
             }
             buf.tmp.ref_convol[j] = (accum_ref + 128) >> 8;
             buf.tmp.dis_convol[j] = (accum_dis + 128) >> 8;
@@ -2022,7 +2017,7 @@ void vif_filter1d_rd_8_avx512(VifBuffer buf, unsigned w, unsigned h)
             _mm256_storeu_si256((__m256i *)(buf.mu2 + i * stride + j), _mm512_castsi512_si256(result));
         }
 
-        for (unsigned j = n << 4; j < w; j = j++)
+        for (unsigned j = n << 4; j < w; ++j)
         {
             uint32_t accum_ref = 0;
             uint32_t accum_dis = 0;
@@ -2067,24 +2062,24 @@ void vif_filter1d_rd_16_avx512(VifBuffer buf, unsigned w, unsigned h, int scale,
 
     for (unsigned i = 0; i < h; ++i)
     {
+        ptrdiff_t row[18];
+        vif_filter_rows(buf, i, fwidth, stride, row);
         //VERTICAL
 
-        int n = w >> 4;
-        int ii = i - fwidth_half;
-        for (unsigned j = 0; j < n << 4; j = j + 32)
+        int n = w >> 5;
+        for (unsigned j = 0; j < n << 5; j = j + 32)
         {
-            int ii_check = ii;
             __m512i accumr_lo, accumr_hi, accumd_lo, accumd_hi, rmul1, rmul2, dmul1, dmul2;
             accumr_lo = accumr_hi = accumd_lo = accumd_hi = rmul1 = rmul2 = dmul1 = dmul2 = _mm512_setzero_si512();
             __m512i mask3 = _mm512_set_epi64(11, 10, 3, 2, 9, 8, 1, 0);   //first half of 512
             __m512i mask4 = _mm512_set_epi64(15, 14, 7, 6, 13, 12, 5, 4); //second half of 512
-            for (unsigned fi = 0; fi < fwidth; ++fi, ii_check = ii + fi)
+            for (unsigned fi = 0; fi < fwidth; ++fi)
             {
 
                 const uint16_t fcoeff = vif_filt[fi];
                 __m512i f1 = _mm512_set1_epi16(vif_filt[fi]);
-                __m512i ref1 = _mm512_loadu_si512((__m512i *)(ref + (ii_check * stride) + j));
-                __m512i dis1 = _mm512_loadu_si512((__m512i *)(dis + (ii_check * stride) + j));
+                __m512i ref1 = _mm512_loadu_si512((__m512i *)(ref + row[fi] + j));
+                __m512i dis1 = _mm512_loadu_si512((__m512i *)(dis + row[fi] + j));
                 __m512i result2 = _mm512_mulhi_epu16(ref1, f1);
                 __m512i result2lo = _mm512_mullo_epi16(ref1, f1);
                 rmul1 = _mm512_unpacklo_epi16(result2lo, result2);
@@ -2121,16 +2116,15 @@ void vif_filter1d_rd_16_avx512(VifBuffer buf, unsigned w, unsigned h, int scale,
         }
 
         // //VERTICAL
-        for (unsigned j = n << 4; j < w; ++j)
+        for (unsigned j = n << 5; j < w; ++j)
         {
             uint32_t accum_ref = 0;
             uint32_t accum_dis = 0;
-            int ii_check = ii;
-            for (unsigned fi = 0; fi < fwidth; ++fi, ii_check = ii + fi)
+            for (unsigned fi = 0; fi < fwidth; ++fi)
             {
                 const uint16_t fcoeff = vif_filt[fi];
-                accum_ref += fcoeff * ((uint32_t)ref[ii_check * stride + j]);
-                accum_dis += fcoeff * ((uint32_t)dis[ii_check * stride + j]);
+                accum_ref += fcoeff * ((uint32_t)ref[row[fi] + j]);
+                accum_dis += fcoeff * ((uint32_t)dis[row[fi] + j]);
             }
             buf.tmp.ref_convol[j] = (uint16_t)((accum_ref + add_shift_round_VP) >> shift_VP);
             buf.tmp.dis_convol[j] = (uint16_t)((accum_dis + add_shift_round_VP) >> shift_VP);
@@ -2201,3 +2195,163 @@ void vif_filter1d_rd_16_avx512(VifBuffer buf, unsigned w, unsigned h, int scale,
         }
     }
 }
+
+/*
+ * vif_statistic() evaluates its gain terms in double precision and reads
+ * its logarithms from log2_table, both are reproduced lane by lane here so
+ * the sums are bit-exact with the C reference for any bit depth.
+ */
+typedef struct VifAccumAvx512
+{
+    __m512i x, x2, num_x;
+    __m512i num_log, den_log;
+    __m512i num_non_log, den_non_log;
+} VifAccumAvx512;
+
+/* (a * b + 2^31) >> 32 on unsigned 32-bit lanes */
+static inline __m512i mul_hi32_round(__m512i a, __m512i b)
+{
+    const __m512i round = _mm512_set1_epi64(1ULL << 31);
+    const __m512i even = _mm512_add_epi64(_mm512_mul_epu32(a, b), round);
+    const __m512i odd = _mm512_add_epi64(
+        _mm512_mul_epu32(_mm512_srli_epi64(a, 32), _mm512_srli_epi64(b, 32)),
+        round);
+    return _mm512_mask_blend_epi32(0xAAAA, _mm512_srli_epi64(even, 32), odd);
+}
+
+/*
+ * Lanes hold positive integers which doubles represent exactly, their top
+ * 16 bits are returned as in get_best16_from32/64(). Those also return a
+ * shift of 16 - bit length, which is 1038 - `exp` in terms of the biased
+ * exponent written to `exp`.
+ */
+static inline __m512i best16(__m512d v, __m512i *exp)
+{
+    const __m512i bits = _mm512_castpd_si512(v);
+    *exp = _mm512_srli_epi64(bits, 52);
+    const __m512i mant = _mm512_and_si512(_mm512_srli_epi64(bits, 37),
+                                          _mm512_set1_epi64(0x7fff));
+    return _mm512_or_si512(mant, _mm512_set1_epi64(0x8000));
+}
+
+static inline __m256i log2_lookup(const uint16_t *log2_table, __m512i idx)
+{
+    const __m256i v = _mm512_i64gather_epi32(idx, (const int *)log2_table, 2);
+    return _mm256_and_si256(v, _mm256_set1_epi32(0xffff));
+}
+
+static inline void vif_statistic_8(VifAccumAvx512 *a, __m256i sigma1_sq,
+                                   __m256i sigma2_sq, __m256i sigma12,
+                                   __mmask8 valid, const uint16_t *log2_table,
+                                   __m512d gain_limit)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m512d eps = _mm512_set1_pd(65536 * 1.0e-10);
+    const __m512d sigma_nsq = _mm512_set1_pd(65536 << 1);
+
+    const __m512d s1 = _mm512_cvtepi32_pd(sigma1_sq);
+    const __m512d s2 = _mm512_cvtepi32_pd(sigma2_sq);
+    const __m512d s12 = _mm512_cvtepi32_pd(sigma12);
+    __m512d g = _mm512_div_pd(s12, _mm512_add_pd(s1, eps));
+    __m256i sv_sq =
+        _mm512_cvttpd_epi32(_mm512_sub_pd(s2, _mm512_mul_pd(g, s12)));
+
+    // sigma1_sq and sigma2_sq are integers, `< eps` means zero. With both
+    // non-zero g has the sign of sigma12.
+    const __mmask8 s1_zero = _mm256_cmpeq_epi32_mask(sigma1_sq, zero);
+    const __mmask8 s2_zero = _mm256_cmpeq_epi32_mask(sigma2_sq, zero);
+    const __mmask8 g_neg =
+        _mm256_cmplt_epi32_mask(sigma12, zero) & ~(s1_zero | s2_zero);
+    sv_sq = _mm256_mask_mov_epi32(sv_sq, s1_zero | g_neg, sigma2_sq);
+    sv_sq = _mm256_mask_mov_epi32(sv_sq, s2_zero, zero);
+    sv_sq = _mm256_max_epi32(sv_sq, zero);
+    g = _mm512_mask_mov_pd(g, s1_zero | s2_zero | g_neg, _mm512_setzero_pd());
+    g = _mm512_min_pd(g, gain_limit);
+
+    const __mmask8 log =
+        _mm256_mask_cmpge_epi32_mask(valid, sigma1_sq,
+                                     _mm256_set1_epi32(65536 << 1));
+    const __mmask8 non_log = valid & ~log;
+    const __mmask8 num =
+        _mm256_mask_cmpge_epi32_mask(log, sigma12, zero);
+    const __m512i one = _mm512_set1_epi64(1);
+
+    a->num_non_log = _mm512_mask_add_epi64(a->num_non_log, non_log,
+        a->num_non_log, _mm512_cvtepi32_epi64(sigma2_sq));
+    a->den_non_log =
+        _mm512_mask_add_epi64(a->den_non_log, non_log, a->den_non_log, one);
+
+    __m512i exp_den, exp_num, exp_numer1;
+    const __m512i den_idx = best16(_mm512_add_pd(s1, sigma_nsq), &exp_den);
+    a->x = _mm512_mask_add_epi64(a->x, log, a->x,
+        _mm512_sub_epi64(_mm512_set1_epi64(1038), exp_den));
+    a->num_x = _mm512_mask_add_epi64(a->num_x, log, a->num_x, one);
+    a->den_log = _mm512_mask_add_epi64(a->den_log, log, a->den_log,
+        _mm512_cvtepi32_epi64(log2_lookup(log2_table, den_idx)));
+
+    // numerator terms stay below 2^53, so they are exact as doubles
+    const __m512d numer1 = _mm512_add_pd(_mm512_cvtepi32_pd(sv_sq), sigma_nsq);
+    __m512d numer1_tmp = _mm512_mul_pd(_mm512_mul_pd(g, g), s1);
+    numer1_tmp = _mm512_roundscale_pd(numer1_tmp,
+                                      _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    numer1_tmp = _mm512_add_pd(numer1_tmp, numer1);
+    const __m512i num_idx = best16(numer1_tmp, &exp_num);
+    const __m512i numer1_idx = best16(numer1, &exp_numer1);
+    const __m256i num_val = _mm256_sub_epi32(log2_lookup(log2_table, num_idx),
+                                             log2_lookup(log2_table, numer1_idx));
+    a->x2 = _mm512_mask_add_epi64(a->x2, num, a->x2,
+                                  _mm512_sub_epi64(exp_num, exp_numer1));
+    a->num_log = _mm512_mask_add_epi64(a->num_log, num, a->num_log,
+                                       _mm512_cvtepi32_epi64(num_val));
+}
+
+void vif_statistic_avx512(VifBuffer buf, VifAccum *accum, unsigned w, unsigned h,
+                          uint16_t *log2_table, double vif_enhn_gain_limit)
+{
+    const ptrdiff_t stride = buf.stride_32 / sizeof(uint32_t);
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512d gain_limit = _mm512_set1_pd(vif_enhn_gain_limit);
+    VifAccumAvx512 a = {
+        zero, zero, zero, zero, zero, zero, zero,
+    };
+
+    for (unsigned i = 0; i < h; ++i)
+    {
+        for (unsigned j = 0; j < w; j += 16)
+        {
+            // lanes past the end of a row load as zero and are masked off
+            const __mmask16 valid =
+                w - j >= 16 ? 0xFFFF : (__mmask16)((1u << (w - j)) - 1);
+            const ptrdiff_t k = i * stride + j;
+            const __m512i mu1 = _mm512_maskz_loadu_epi32(valid, buf.mu1_32 + k);
+            const __m512i mu2 = _mm512_maskz_loadu_epi32(valid, buf.mu2_32 + k);
+            const __m512i xx = _mm512_maskz_loadu_epi32(valid, buf.ref_sq + k);
+            const __m512i yy = _mm512_maskz_loadu_epi32(valid, buf.dis_sq + k);
+            const __m512i xy = _mm512_maskz_loadu_epi32(valid, buf.ref_dis + k);
+
+            const __m512i sigma1_sq = _mm512_max_epi32(
+                _mm512_sub_epi32(xx, mul_hi32_round(mu1, mu1)), zero);
+            const __m512i sigma2_sq = _mm512_max_epi32(
+                _mm512_sub_epi32(yy, mul_hi32_round(mu2, mu2)), zero);
+            const __m512i sigma12 =
+                _mm512_sub_epi32(xy, mul_hi32_round(mu1, mu2));
+
+            vif_statistic_8(&a, _mm512_castsi512_si256(sigma1_sq),
+                            _mm512_castsi512_si256(sigma2_sq),
+                            _mm512_castsi512_si256(sigma12),
+                            (__mmask8)valid, log2_table, gain_limit);
+            vif_statistic_8(&a, _mm512_extracti64x4_epi64(sigma1_sq, 1),
+                            _mm512_extracti64x4_epi64(sigma2_sq, 1),
+                            _mm512_extracti64x4_epi64(sigma12, 1),
+                            (__mmask8)(valid >> 8), log2_table, gain_limit);
+        }
+    }
+
+    accum->x = _mm512_reduce_add_epi64(a.x);
+    accum->x2 = _mm512_reduce_add_epi64(a.x2);
+    accum->num_x = _mm512_reduce_add_epi64(a.num_x);
+    accum->num_log = _mm512_reduce_add_epi64(a.num_log);
+    accum->den_log = _mm512_reduce_add_epi64(a.den_log);
+    accum->num_non_log = _mm512_reduce_add_epi64(a.num_non_log);
+    accum->den_non_log = _mm512_reduce_add_epi64(a.den_non_log);
+}
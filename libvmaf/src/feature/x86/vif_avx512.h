@@ -31,4 +31,7 @@ void vif_filter1d_rd_16_avx512(VifBuffer buf, unsigned w, unsigned h, int scale,
 void vif_filter1d_16_avx512(VifBuffer buf, unsigned w, unsigned h, int scale,
                             int bpc);
 
+void vif_statistic_avx512(VifBuffer buf, VifAccum *accum, unsigned w, unsigned h,
+                          uint16_t *log2_table, double vif_enhn_gain_limit);
+
 #endif /* X86_AVX512_VIF_H_ */
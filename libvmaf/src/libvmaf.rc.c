@@ -17,6 +17,7 @@
  */
 
 #include <errno.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdint.h>
@@ -35,15 +36,34 @@
 #include "output.h"
 #include "picture.h"
 #include "predict.h"
+#include "temporal_lane.h"
 #include "thread_pool.h"
 #include "vcs_version.h"
 
+#define MAX(x, y) (((x) > (y)) ? (x) : (y))
+
 typedef struct VmafContext {
     VmafConfiguration cfg;
     VmafFeatureCollector *feature_collector;
     RegisteredFeatureExtractors registered_feature_extractors;
     VmafFeatureExtractorContextPool *fex_ctx_pool;
     VmafThreadPool *thread_pool;
+    struct {
+        pthread_mutex_t lock;
+        pthread_cond_t retired;
+        unsigned cnt;
+    } in_flight;
+    struct {
+        VmafTemporalLane **lane; ///< indexed like registered_feature_extractors
+        unsigned cnt;
+    } temporal;
+    struct {
+        VmafFrameCallback func;
+        VmafModel *model;
+        void *user_data;
+        bool lagging; ///< unthreaded mode, `lagging_index` awaits a temporal score
+        unsigned lagging_index;
+    } frame_cb;
     struct {
         unsigned w, h;
         enum VmafPixelFormat pix_fmt;
@@ -53,6 +73,24 @@ typedef struct VmafContext {
     bool flushed;
 } VmafContext;
 
+typedef struct FrameInFlight {
+    VmafContext *vmaf;
+    unsigned index;
+    unsigned ref_cnt; ///< holders of the pictures, counts against the window
+    unsigned hold_cnt; ///< holders which may still write scores for `index`
+    bool notify;
+} FrameInFlight;
+
+struct ThreadData {
+    VmafFeatureExtractorContext *fex_ctx;
+    FrameInFlight *frame;
+    VmafPicture ref, dist;
+    unsigned index;
+    VmafFeatureCollector *feature_collector;
+    VmafFeatureExtractorContextPool *fex_ctx_pool;
+    int err;
+};
+
 int vmaf_init(VmafContext **vmaf, VmafConfiguration cfg)
 {
     if (!vmaf) return -EINVAL;
@@ -72,10 +110,24 @@ int vmaf_init(VmafContext **vmaf, VmafConfiguration cfg)
     if (err) goto free_feature_collector;
 
     if (v->cfg.n_threads > 0) {
-        err = vmaf_thread_pool_create(&v->thread_pool, v->cfg.n_threads);
+        switch (v->cfg.scheduler) {
+        case VMAF_THREAD_SCHEDULER_FIFO:
+            err = vmaf_thread_pool_create(&v->thread_pool, v->cfg.n_threads);
+            break;
+        case VMAF_THREAD_SCHEDULER_WORK_STEALING:
+            err = vmaf_thread_pool_create_work_stealing(&v->thread_pool,
+                                                        v->cfg.n_threads,
+                                                        sizeof(struct ThreadData));
+            break;
+        default:
+            err = -EINVAL;
+            break;
+        }
         if (err) goto free_feature_extractor_vector;
         err = vmaf_fex_ctx_pool_create(&v->fex_ctx_pool, v->cfg.n_threads);
         if (err) goto free_thread_pool;
+        pthread_mutex_init(&(v->in_flight.lock), NULL);
+        pthread_cond_init(&(v->in_flight.retired), NULL);
     }
 
     return 0;
@@ -97,10 +149,18 @@ int vmaf_close(VmafContext *vmaf)
     if (!vmaf) return -EINVAL;
 
     vmaf_thread_pool_wait(vmaf->thread_pool);
+    vmaf->frame_cb.func = NULL;
+    for (unsigned i = 0; i < vmaf->temporal.cnt; i++)
+        vmaf_temporal_lane_destroy(vmaf->temporal.lane[i]);
+    free(vmaf->temporal.lane);
     feature_extractor_vector_destroy(&(vmaf->registered_feature_extractors));
     vmaf_feature_collector_destroy(vmaf->feature_collector);
     vmaf_thread_pool_destroy(vmaf->thread_pool);
     vmaf_fex_ctx_pool_destroy(vmaf->fex_ctx_pool);
+    if (vmaf->thread_pool) {
+        pthread_mutex_destroy(&(vmaf->in_flight.lock));
+        pthread_cond_destroy(&(vmaf->in_flight.retired));
+    }
     free(vmaf);
 
     return 0;
@@ -192,14 +252,68 @@ int vmaf_use_features_from_model_collection(VmafContext *vmaf,
     return err;
 }
 
-struct ThreadData {
-    VmafFeatureExtractorContext *fex_ctx;
-    VmafPicture ref, dist;
-    unsigned index;
-    VmafFeatureCollector *feature_collector;
-    VmafFeatureExtractorContextPool *fex_ctx_pool;
-    int err;
-};
+static void notify_frame_complete(VmafContext *vmaf, unsigned index)
+{
+    if (!vmaf->frame_cb.func) return;
+
+    double score;
+    const double *s = NULL;
+    if (vmaf->frame_cb.model &&
+        !vmaf_score_at_index(vmaf, vmaf->frame_cb.model, &score, index))
+    {
+        s = &score;
+    }
+    vmaf->frame_cb.func(vmaf->frame_cb.user_data, index, s);
+}
+
+static void frame_in_flight_ref(FrameInFlight *frame)
+{
+    pthread_mutex_lock(&(frame->vmaf->in_flight.lock));
+    frame->ref_cnt++;
+    frame->hold_cnt++;
+    pthread_mutex_unlock(&(frame->vmaf->in_flight.lock));
+}
+
+static void frame_in_flight_unref(FrameInFlight *frame)
+{
+    VmafContext *vmaf = frame->vmaf;
+
+    pthread_mutex_lock(&(vmaf->in_flight.lock));
+    if (!(--frame->ref_cnt)) {
+        vmaf->in_flight.cnt--;
+        pthread_cond_signal(&(vmaf->in_flight.retired));
+    }
+    pthread_mutex_unlock(&(vmaf->in_flight.lock));
+}
+
+static void frame_in_flight_release(FrameInFlight *frame)
+{
+    VmafContext *vmaf = frame->vmaf;
+
+    pthread_mutex_lock(&(vmaf->in_flight.lock));
+    const bool complete = !(--frame->hold_cnt);
+    pthread_mutex_unlock(&(vmaf->in_flight.lock));
+
+    if (!complete) return;
+    if (frame->notify) notify_frame_complete(vmaf, frame->index);
+    free(frame);
+}
+
+static void frame_in_flight_retire(void *cookie)
+{
+    frame_in_flight_unref(cookie);
+}
+
+static void frame_in_flight_complete(void *cookie)
+{
+    frame_in_flight_release(cookie);
+}
+
+static bool in_flight_window_full(VmafContext *vmaf)
+{
+    return vmaf->cfg.max_frames_in_flight &&
+           vmaf->in_flight.cnt >= vmaf->cfg.max_frames_in_flight;
+}
 
 static void threaded_extract_func(void *e)
 {
@@ -211,6 +325,48 @@ static void threaded_extract_func(void *e)
     f->err = vmaf_fex_ctx_pool_release(f->fex_ctx_pool, f->fex_ctx);
     vmaf_picture_unref(&f->ref);
     vmaf_picture_unref(&f->dist);
+    frame_in_flight_unref(f->frame);
+    frame_in_flight_release(f->frame);
+}
+
+static int temporal_lane_get(VmafContext *vmaf, unsigned i,
+                             VmafTemporalLane **lane)
+{
+    const unsigned cnt = vmaf->registered_feature_extractors.cnt;
+    if (vmaf->temporal.cnt < cnt) {
+        VmafTemporalLane **l =
+            realloc(vmaf->temporal.lane, sizeof(*l) * cnt);
+        if (!l) return -ENOMEM;
+        for (unsigned j = vmaf->temporal.cnt; j < cnt; j++)
+            l[j] = NULL;
+        vmaf->temporal.lane = l;
+        vmaf->temporal.cnt = cnt;
+    }
+
+    if (!vmaf->temporal.lane[i]) {
+        /* Deep enough to keep the lane busy while the spatial jobs of later
+         * frames run, but never deeper than the in-flight window. Otherwise
+         * frames held back in the reorder buffer could stall the reader. */
+        unsigned capacity = 2 * vmaf->cfg.n_threads;
+        if (vmaf->cfg.max_frames_in_flight &&
+            vmaf->cfg.max_frames_in_flight < capacity)
+        {
+            capacity = vmaf->cfg.max_frames_in_flight;
+        }
+
+        VmafFeatureExtractorContext *fex_ctx =
+            vmaf->registered_feature_extractors.fex_ctx[i];
+        fex_ctx->fex->thread_pool = vmaf->thread_pool;
+        int err = vmaf_temporal_lane_create(&vmaf->temporal.lane[i], fex_ctx,
+                                            vmaf->feature_collector,
+                                            vmaf->thread_pool, capacity,
+                                            frame_in_flight_retire,
+                                            frame_in_flight_complete);
+        if (err) return err;
+    }
+
+    *lane = vmaf->temporal.lane[i];
+    return 0;
 }
 
 static int threaded_read_pictures(VmafContext *vmaf, VmafPicture *ref,
@@ -222,6 +378,23 @@ static int threaded_read_pictures(VmafContext *vmaf, VmafPicture *ref,
 
     int err = 0;
 
+    /* The frame is retired once every job holding it has finished, and
+     * complete once every feature for its index has been written. The
+     * reader holds one reference of its own until all jobs are queued. */
+    FrameInFlight *frame = malloc(sizeof(*frame));
+    if (!frame) return -ENOMEM;
+    frame->vmaf = vmaf;
+    frame->index = index;
+    frame->ref_cnt = frame->hold_cnt = 1;
+    frame->notify = !(vmaf->cfg.n_subsample > 1) ||
+                    !(index % vmaf->cfg.n_subsample);
+
+    pthread_mutex_lock(&(vmaf->in_flight.lock));
+    while (in_flight_window_full(vmaf))
+        pthread_cond_wait(&(vmaf->in_flight.retired), &(vmaf->in_flight.lock));
+    vmaf->in_flight.cnt++;
+    pthread_mutex_unlock(&(vmaf->in_flight.lock));
+
     for (unsigned i = 0; i < vmaf->registered_feature_extractors.cnt; i++) {
         VmafFeatureExtractor *fex =
             vmaf->registered_feature_extractors.fex_ctx[i]->fex;
@@ -234,17 +407,42 @@ static int threaded_read_pictures(VmafContext *vmaf, VmafPicture *ref,
             continue;
         }
 
+        if (fex->flags & VMAF_FEATURE_EXTRACTOR_TEMPORAL) {
+            VmafTemporalLane *lane;
+            err = temporal_lane_get(vmaf, i, &lane);
+            if (err) goto unref_frame;
+
+            VmafPicture pic_a, pic_b;
+            vmaf_picture_ref(&pic_a, ref);
+            vmaf_picture_ref(&pic_b, dist);
+
+            frame_in_flight_ref(frame);
+            err = vmaf_temporal_lane_submit(lane, &pic_a, &pic_b, index, frame);
+            if (err) {
+                vmaf_picture_unref(&pic_a);
+                vmaf_picture_unref(&pic_b);
+                frame_in_flight_unref(frame);
+                frame_in_flight_release(frame);
+                goto unref_frame;
+            }
+            continue;
+        }
+
         VmafFeatureExtractorContext *fex_ctx;
         err = vmaf_fex_ctx_pool_aquire(vmaf->fex_ctx_pool, fex, opts_dict,
                                        &fex_ctx);
-        if (err) return err;
+        if (err) goto unref_frame;
+        fex_ctx->fex->thread_pool = vmaf->thread_pool;
 
         VmafPicture pic_a, pic_b;
         vmaf_picture_ref(&pic_a, ref);
         vmaf_picture_ref(&pic_b, dist);
 
+        frame_in_flight_ref(frame);
+
         struct ThreadData data = {
             .fex_ctx = fex_ctx,
+            .frame = frame,
             .ref = pic_a,
             .dist = pic_b,
             .index = index,
@@ -258,11 +456,21 @@ static int threaded_read_pictures(VmafContext *vmaf, VmafPicture *ref,
         if (err) {
             vmaf_picture_unref(&pic_a);
             vmaf_picture_unref(&pic_b);
-            return err;
+            frame_in_flight_unref(frame);
+            frame_in_flight_release(frame);
+            goto unref_frame;
         }
     }
 
+    frame_in_flight_unref(frame);
+    frame_in_flight_release(frame);
     return vmaf_picture_unref(ref) | vmaf_picture_unref(dist);
+
+unref_frame:
+    frame->notify = false;
+    frame_in_flight_unref(frame);
+    frame_in_flight_release(frame);
+    return err;
 }
 
 static int validate_pic_params(VmafContext *vmaf, VmafPicture *ref,
@@ -293,8 +501,13 @@ static int validate_pic_params(VmafContext *vmaf, VmafPicture *ref,
 static int flush_context_threaded(VmafContext *vmaf)
 {
     int err = 0;
+    for (unsigned i = 0; i < vmaf->temporal.cnt; i++) {
+        if (!vmaf->temporal.lane[i]) continue;
+        err |= vmaf_temporal_lane_flush(vmaf->temporal.lane[i]);
+    }
     err |= vmaf_thread_pool_wait(vmaf->thread_pool);
     err |= vmaf_fex_ctx_pool_flush(vmaf->fex_ctx_pool, vmaf->feature_collector);
+    vmaf->feature_collector->timer.end = clock();
 
     if (!err) vmaf->flushed = true;
     return err;
@@ -313,10 +526,86 @@ static int flush_context(VmafContext *vmaf)
                                                     vmaf->feature_collector);
     }
 
+    if (vmaf->frame_cb.lagging) {
+        vmaf->frame_cb.lagging = false;
+        notify_frame_complete(vmaf, vmaf->frame_cb.lagging_index);
+    }
+    vmaf->feature_collector->timer.end = clock();
+
     if (!err) vmaf->flushed = true;
     return err;
 }
 
+int vmaf_reset(VmafContext *vmaf)
+{
+    if (!vmaf) return -EINVAL;
+
+    int err = 0;
+    if (vmaf->pic_cnt && !vmaf->flushed) {
+        err = flush_context(vmaf);
+        if (err) return err;
+    }
+    if (vmaf->thread_pool) {
+        err = vmaf_thread_pool_wait(vmaf->thread_pool);
+        if (err) return err;
+    }
+
+    RegisteredFeatureExtractors rfe = vmaf->registered_feature_extractors;
+    for (unsigned i = 0; i < rfe.cnt; i++) {
+        if (i < vmaf->temporal.cnt && vmaf->temporal.lane[i])
+            err |= vmaf_temporal_lane_reset(vmaf->temporal.lane[i]);
+        else
+            err |= vmaf_feature_extractor_context_reset(rfe.fex_ctx[i]);
+    }
+    if (vmaf->fex_ctx_pool)
+        err |= vmaf_fex_ctx_pool_reset(vmaf->fex_ctx_pool);
+    err |= vmaf_feature_collector_reset(vmaf->feature_collector);
+    if (err) return err;
+
+    vmaf->frame_cb.lagging = false;
+    vmaf->pic_cnt = 0;
+    vmaf->flushed = false;
+    return 0;
+}
+
+int vmaf_set_retention_window(VmafContext *vmaf, unsigned n_frames,
+                              VmafFeatureSpill spill, void *user_data)
+{
+    if (!vmaf) return -EINVAL;
+    if (vmaf->pic_cnt) return -EINVAL;
+
+    return vmaf_feature_collector_set_retention(vmaf->feature_collector,
+                                                n_frames, spill, user_data);
+}
+
+int vmaf_register_frame_callback(VmafContext *vmaf, VmafFrameCallback callback,
+                                 VmafModel *model, void *user_data)
+{
+    if (!vmaf) return -EINVAL;
+    if (vmaf->pic_cnt) return -EINVAL;
+
+    vmaf->frame_cb.func = callback;
+    vmaf->frame_cb.model = model;
+    vmaf->frame_cb.user_data = user_data;
+    return 0;
+}
+
+int vmaf_try_read_pictures(VmafContext *vmaf, VmafPicture *ref,
+                           VmafPicture *dist, unsigned index)
+{
+    if (!vmaf) return -EINVAL;
+    if (!vmaf->thread_pool || !ref || !dist)
+        return vmaf_read_pictures(vmaf, ref, dist, index);
+
+    /* Only this thread adds frames, so the window can not fill up again
+     * between the check and the enqueue in `vmaf_read_pictures()`. */
+    pthread_mutex_lock(&(vmaf->in_flight.lock));
+    const bool full = in_flight_window_full(vmaf);
+    pthread_mutex_unlock(&(vmaf->in_flight.lock));
+    if (full) return -EAGAIN;
+
+    return vmaf_read_pictures(vmaf, ref, dist, index);
+}
 
 int vmaf_read_pictures(VmafContext *vmaf, VmafPicture *ref, VmafPicture *dist,
                        unsigned index)
@@ -331,10 +620,15 @@ int vmaf_read_pictures(VmafContext *vmaf, VmafPicture *ref, VmafPicture *dist,
     vmaf->pic_cnt++;
     err = validate_pic_params(vmaf, ref, dist);
     if (err) return err;
+    err = vmaf_picture_ensure_aligned(ref);
+    if (err) return err;
+    err = vmaf_picture_ensure_aligned(dist);
+    if (err) return err;
 
     if (vmaf->thread_pool)
         return threaded_read_pictures(vmaf, ref, dist, index);
 
+    bool temporal = false;
     for (unsigned i = 0; i < vmaf->registered_feature_extractors.cnt; i++) {
         VmafFeatureExtractorContext *fex_ctx =
             vmaf->registered_feature_extractors.fex_ctx[i];
@@ -349,6 +643,22 @@ int vmaf_read_pictures(VmafContext *vmaf, VmafPicture *ref, VmafPicture *dist,
                                                      NULL, index,
                                                      vmaf->feature_collector);
         if (err) return err;
+        temporal |= !!(fex_ctx->fex->flags & VMAF_FEATURE_EXTRACTOR_TEMPORAL);
+    }
+
+    /* Temporal feature extractors write some scores one picture late, so
+     * the previous index is only complete now. */
+    if (vmaf->frame_cb.lagging) {
+        vmaf->frame_cb.lagging = false;
+        notify_frame_complete(vmaf, vmaf->frame_cb.lagging_index);
+    }
+    if (!(vmaf->cfg.n_subsample > 1) || !(index % vmaf->cfg.n_subsample)) {
+        if (temporal) {
+            vmaf->frame_cb.lagging = true;
+            vmaf->frame_cb.lagging_index = index;
+        } else {
+            notify_frame_complete(vmaf, index);
+        }
     }
 
     err = vmaf_picture_unref(ref);
@@ -412,6 +722,15 @@ int vmaf_feature_score_pooled(VmafContext *vmaf, const char *feature_name,
     if (index_low > index_high) return -EINVAL;
     if (!pool_method) return -EINVAL;
 
+    if (vmaf->feature_collector->retention.window &&
+        index_low < vmaf_feature_collector_retained_begin(vmaf->feature_collector))
+    {
+        return vmaf_feature_collector_get_running_pooled(vmaf->feature_collector,
+                                                         feature_name,
+                                                         pool_method, score,
+                                                         index_low, index_high);
+    }
+
     unsigned pic_cnt = 0;
     double min = 0., max = 0., sum = 0., i_sum = 0.;
     for (unsigned i = index_low; i <= index_high; i++) {
@@ -459,11 +778,29 @@ int vmaf_score_pooled(VmafContext *vmaf, VmafModel *model,
     if (index_low > index_high) return -EINVAL;
     if (!pool_method) return -EINVAL;
 
-    for (unsigned i = index_low; i <= index_high; i++) {
+    unsigned index[VMAF_PREDICT_BATCH_SIZE], cnt = 0;
+    double vmaf_score[VMAF_PREDICT_BATCH_SIZE];
+    // scores before `begin` are gone, vmaf_feature_score_pooled() fails
+    // unless the running accumulators cover the whole range
+    const unsigned begin =
+        vmaf_feature_collector_retained_begin(vmaf->feature_collector);
+    for (unsigned i = MAX(index_low, begin); i <= index_high; i++) {
         if ((vmaf->cfg.n_subsample > 1) && (i % vmaf->cfg.n_subsample))
             continue;
-        double vmaf_score;
-        int err = vmaf_score_at_index(vmaf, model, &vmaf_score, i);
+        int err = vmaf_feature_collector_get_score(vmaf->feature_collector,
+                                                   model->name,
+                                                   &vmaf_score[0], i);
+        if (!err) continue;
+        index[cnt++] = i;
+        if (cnt < VMAF_PREDICT_BATCH_SIZE) continue;
+        err = vmaf_predict_score_at_indices(model, vmaf->feature_collector,
+                                            index, cnt, vmaf_score, true, 0);
+        if (err) return err;
+        cnt = 0;
+    }
+    if (cnt) {
+        int err = vmaf_predict_score_at_indices(model, vmaf->feature_collector,
+                                                index, cnt, vmaf_score, true, 0);
         if (err) return err;
     }
 
@@ -484,11 +821,27 @@ int vmaf_score_pooled_model_collection(VmafContext *vmaf,
     if (!pool_method) return -EINVAL;
 
     int err = 0;
-    for (unsigned i = index_low; i <= index_high; i++) {
+    unsigned index[VMAF_PREDICT_BATCH_SIZE], cnt = 0;
+    VmafModelCollectionScore s[VMAF_PREDICT_BATCH_SIZE];
+    // scores before `begin` are gone, vmaf_feature_score_pooled() fails
+    // unless the running accumulators cover the whole range
+    const unsigned begin =
+        vmaf_feature_collector_retained_begin(vmaf->feature_collector);
+    for (unsigned i = MAX(index_low, begin); i <= index_high; i++) {
         if ((vmaf->cfg.n_subsample > 1) && (i % vmaf->cfg.n_subsample))
             continue;
-        VmafModelCollectionScore s;
-        err = vmaf_score_at_index_model_collection(vmaf, model_collection, &s, i);
+        index[cnt++] = i;
+        if (cnt < VMAF_PREDICT_BATCH_SIZE) continue;
+        err = vmaf_predict_score_at_indices_model_collection(model_collection,
+                                                             vmaf->feature_collector,
+                                                             index, cnt, s);
+        if (err) return err;
+        cnt = 0;
+    }
+    if (cnt) {
+        err = vmaf_predict_score_at_indices_model_collection(model_collection,
+                                                             vmaf->feature_collector,
+                                                             index, cnt, s);
         if (err) return err;
     }
 
@@ -1,15 +1,28 @@
 #include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <sys/stat.h>
 
+#ifdef _WIN32
+#define realpath(path, resolved_path) _fullpath(resolved_path, path, 0)
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 #include <libvmaf/model.h>
 
 #include "config.h"
+#include "mem.h"
 #include "model.h"
 #include "read_json_model.h"
+#include "ref.h"
 #include "svm.h"
+#include "svr.h"
 #include "unpickle.h"
 
 typedef struct VmafBuiltInModel {
@@ -72,9 +85,165 @@ static const VmafBuiltInModel built_in_models[] = {
 #define BUILT_IN_MODEL_CNT \
     ((sizeof(built_in_models)) / (sizeof(built_in_models[0]))) - 1
 
+typedef struct VmafModelRegistryEntry {
+    char *key;
+    VmafModel *model;
+    VmafModelCollection *model_collection;
+    unsigned ref_cnt; ///< handed out `model` and `model_collection` handles
+    struct VmafModelRegistryEntry *next;
+} VmafModelRegistryEntry;
+
+static struct {
+    pthread_mutex_t lock;
+    VmafModelRegistryEntry *entry;
+} model_registry = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static char *model_registry_key(VmafModelConfig *cfg, const char *version,
+                                const char *path, bool collection)
+{
+    char *resolved_path = path ? realpath(path, NULL) : NULL;
+    const char *source =
+        version ? version : (resolved_path ? resolved_path : path);
+    char *name = vmaf_model_generate_name(cfg);
+    char *key = NULL;
+    if (!name) goto free_path;
+
+    const uint64_t flags = cfg->flags & ~VMAF_MODEL_FLAG_SHARED;
+    const char *fmt = "%s:%s:%s:%s:%" PRIu64;
+    const char *type = collection ? "collection" : "model";
+    const char *source_type = version ? "version" : "path";
+    const size_t key_sz =
+        snprintf(NULL, 0, fmt, type, source_type, source, name, flags) + 1;
+    key = malloc(key_sz);
+    if (key)
+        snprintf(key, key_sz, fmt, type, source_type, source, name, flags);
+
+    free(name);
+free_path:
+    free(resolved_path);
+    return key;
+}
+
+static VmafModelRegistryEntry *model_registry_find(const char *key)
+{
+    VmafModelRegistryEntry *e = model_registry.entry;
+    while (e && strcmp(e->key, key))
+        e = e->next;
+    return e;
+}
+
+/* The registry must be locked. */
+static void model_registry_ref(VmafModelRegistryEntry *e, VmafModel **model,
+                               VmafModelCollection **model_collection)
+{
+    *model = e->model;
+    e->ref_cnt++;
+    if (model_collection) {
+        *model_collection = e->model_collection;
+        e->ref_cnt++;
+    }
+}
+
+/* Models are loaded without holding the registry lock, so that a slow load
+ * does not stall every other lookup. When concurrent requests load the same
+ * model, the first one to register it wins and the others drop their copy. */
+static int model_registry_load(VmafModel **model,
+                               VmafModelCollection **model_collection,
+                               VmafModelConfig *cfg, const char *version,
+                               const char *path)
+{
+    char *key = model_registry_key(cfg, version, path, model_collection);
+    if (!key) return -ENOMEM;
+
+    pthread_mutex_lock(&model_registry.lock);
+    VmafModelRegistryEntry *e = model_registry_find(key);
+    if (e) {
+        model_registry_ref(e, model, model_collection);
+        pthread_mutex_unlock(&model_registry.lock);
+        free(key);
+        return 0;
+    }
+    pthread_mutex_unlock(&model_registry.lock);
+
+    int err = 0;
+    VmafModel *m = NULL;
+    VmafModelCollection *mc = NULL;
+    VmafModelConfig c = *cfg;
+    c.flags &= ~VMAF_MODEL_FLAG_SHARED;
+    if (model_collection && version)
+        err = vmaf_model_collection_load(&m, &mc, &c, version);
+    else if (model_collection)
+        err = vmaf_model_collection_load_from_path(&m, &mc, &c, path);
+    else if (version)
+        err = vmaf_model_load(&m, &c, version);
+    else
+        err = vmaf_model_load_from_path(&m, &c, path);
+    if (err) goto free_key;
+
+    VmafModelRegistryEntry *entry = malloc(sizeof(*entry));
+    if (!entry) {
+        err = -ENOMEM;
+        goto free_model;
+    }
+    memset(entry, 0, sizeof(*entry));
+    entry->key = key;
+    entry->model = m;
+    entry->model_collection = mc;
+
+    pthread_mutex_lock(&model_registry.lock);
+    e = model_registry_find(key);
+    if (!e) {
+        m->shared = entry;
+        if (mc)
+            mc->shared = entry;
+        entry->next = model_registry.entry;
+        model_registry.entry = e = entry;
+    }
+    model_registry_ref(e, model, model_collection);
+    pthread_mutex_unlock(&model_registry.lock);
+    if (e == entry) return 0;
+
+    // registered concurrently by another request
+    free(entry);
+free_model:
+    vmaf_model_destroy(m);
+    vmaf_model_collection_destroy(mc);
+free_key:
+    free(key);
+    return err;
+}
+
+static void model_registry_release(VmafModelRegistryEntry *entry)
+{
+    pthread_mutex_lock(&model_registry.lock);
+    if (--entry->ref_cnt) {
+        pthread_mutex_unlock(&model_registry.lock);
+        return;
+    }
+    VmafModelRegistryEntry **e = &model_registry.entry;
+    while (*e != entry)
+        e = &(*e)->next;
+    *e = entry->next;
+    pthread_mutex_unlock(&model_registry.lock);
+
+    entry->model->shared = NULL;
+    vmaf_model_destroy(entry->model);
+    if (entry->model_collection) {
+        entry->model_collection->shared = NULL;
+        vmaf_model_collection_destroy(entry->model_collection);
+    }
+    free(entry->key);
+    free(entry);
+}
+
 int vmaf_model_load(VmafModel **model, VmafModelConfig *cfg,
                     const char *version)
 {
+    if (cfg->flags & VMAF_MODEL_FLAG_SHARED)
+        return model_registry_load(model, NULL, cfg, version, NULL);
+
     const VmafBuiltInModel *built_in_model = NULL;
 
     for (unsigned i = 0; i < BUILT_IN_MODEL_CNT; i++) {
@@ -108,9 +277,324 @@ char *vmaf_model_generate_name(VmafModelConfig *cfg)
     return name;
 }
 
+static bool is_binary_model_path(const char *path)
+{
+    const char *ext = strrchr(path, '.');
+    return ext && !strcmp(ext, ".vmafb");
+}
+
+#ifdef _WIN32
+/* No mmap(), read the whole file into an aligned buffer instead. */
+static void *model_file_load(const char *path, size_t *sz)
+{
+    FILE *in = fopen(path, "rb");
+    if (!in) return NULL;
+    void *data = NULL;
+    if (fseek(in, 0, SEEK_END)) goto close_in;
+    const long end = ftell(in);
+    if (end < (long) sizeof(VmafModelBinaryHeader)) goto close_in;
+    if (fseek(in, 0, SEEK_SET)) goto close_in;
+    data = aligned_malloc(end, VMAF_MODEL_BINARY_ALIGN);
+    if (!data) goto close_in;
+    if (fread(data, 1, end, in) != (size_t) end) {
+        aligned_free(data);
+        data = NULL;
+        goto close_in;
+    }
+    *sz = end;
+
+close_in:
+    fclose(in);
+    return data;
+}
+
+static void model_file_unload(void *data, size_t sz)
+{
+    (void) sz;
+    aligned_free(data);
+}
+#else
+static void *model_file_load(const char *path, size_t *sz)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat s;
+    if (fstat(fd, &s) || (size_t) s.st_size < sizeof(VmafModelBinaryHeader)) {
+        close(fd);
+        return NULL;
+    }
+    void *data = mmap(NULL, s.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return NULL;
+    *sz = s.st_size;
+    return data;
+}
+
+static void model_file_unload(void *data, size_t sz)
+{
+    munmap(data, sz);
+}
+#endif
+
+static int model_map_open(VmafModelMap **map, const char *path)
+{
+    size_t sz;
+    void *data = model_file_load(path, &sz);
+    if (!data) return -EINVAL;
+
+    int err = -EINVAL;
+    const VmafModelBinaryHeader *h = data;
+    if (memcmp(h->magic, VMAF_MODEL_BINARY_MAGIC, sizeof(h->magic)))
+        goto unmap;
+    if (h->version != VMAF_MODEL_BINARY_VERSION)
+        goto unmap;
+    if (h->byte_order != VMAF_MODEL_BINARY_BYTE_ORDER)
+        goto unmap;
+    if (h->sz != sz || !h->model_cnt)
+        goto unmap;
+    if (h->model_cnt > (sz - sizeof(*h)) / sizeof(uint64_t))
+        goto unmap;
+
+    err = -ENOMEM;
+    VmafModelMap *const m = *map = malloc(sizeof(*m));
+    if (!m) goto unmap;
+    memset(m, 0, sizeof(*m));
+    m->data = data;
+    m->sz = sz;
+    if (vmaf_ref_init(&m->ref)) goto free_m;
+    return 0;
+
+free_m:
+    free(m);
+unmap:
+    model_file_unload(data, sz);
+    return err;
+}
+
+static void model_map_release(VmafModelMap *map)
+{
+    if (!map) return;
+    if (vmaf_ref_fetch_decrement(map->ref) != 1) return;
+    model_file_unload((void *) map->data, map->sz);
+    vmaf_ref_close(map->ref);
+    free(map);
+}
+
+static const void *model_map_at(const VmafModelMap *map, uint64_t offset,
+                                uint64_t sz, uint64_t align)
+{
+    if (offset % align) return NULL;
+    if (offset > map->sz || sz > map->sz - offset) return NULL;
+    return map->data + offset;
+}
+
+static const char *model_map_string(const VmafModelMap *map, uint64_t offset)
+{
+    if (offset >= map->sz) return NULL;
+    const char *str = (const char *) map->data + offset;
+    return memchr(str, 0, map->sz - offset) ? str : NULL;
+}
+
+static int model_map_feature(VmafModelMap *map,
+                             const VmafModelBinaryFeature *feature,
+                             VmafModelFeature *model_feature)
+{
+    const char *name = model_map_string(map, feature->name);
+    if (!name) return -EINVAL;
+    model_feature->name = strdup(name);
+    if (!model_feature->name) return -ENOMEM;
+    model_feature->slope = feature->slope;
+    model_feature->intercept = feature->intercept;
+
+    uint64_t offset = feature->opts;
+    for (unsigned i = 0; i < feature->opts_cnt; i++) {
+        const char *key = model_map_string(map, offset);
+        if (!key) return -EINVAL;
+        offset += strlen(key) + 1;
+        const char *val = model_map_string(map, offset);
+        if (!val) return -EINVAL;
+        offset += strlen(val) + 1;
+        int err = vmaf_dictionary_set(&model_feature->opts_dict, key, val,
+                                      VMAF_DICT_DO_NOT_OVERWRITE);
+        if (err) return err;
+    }
+
+    return 0;
+}
+
+static int model_map_model(VmafModel **model, VmafModelConfig *cfg,
+                           VmafModelMap *map, unsigned index)
+{
+    const VmafModelBinaryHeader *h = (const void *) map->data;
+    const uint64_t *offset = (const uint64_t *) (h + 1);
+    const VmafModelBinaryModel *b =
+        model_map_at(map, offset[index], sizeof(*b), sizeof(uint64_t));
+    if (!b) return -EINVAL;
+
+    if (b->type < VMAF_MODEL_TYPE_SVM_NUSVR ||
+        b->type > VMAF_MODEL_RESIDUE_BOOTSTRAP_SVM_NUSVR)
+        return -EINVAL;
+    if (b->norm_type < VMAF_MODEL_NORMALIZATION_TYPE_NONE ||
+        b->norm_type > VMAF_MODEL_NORMALIZATION_TYPE_LINEAR_RESCALE)
+        return -EINVAL;
+
+    const VmafModelBinaryFeature *feature =
+        model_map_at(map, b->feature, sizeof(*feature) * (uint64_t) b->n_features,
+                     sizeof(uint64_t));
+    if (!feature || !b->n_features) return -EINVAL;
+
+    const uint64_t n_sv_padded =
+        ((uint64_t) b->n_sv + VMAF_SVR_SV_ALIGN - 1) / VMAF_SVR_SV_ALIGN *
+        VMAF_SVR_SV_ALIGN;
+    if (b->n_sv_padded != n_sv_padded)
+        return -EINVAL;
+    if (n_sv_padded > map->sz / sizeof(double) ||
+        b->n_features > map->sz / sizeof(double) / (n_sv_padded + 1))
+        return -EINVAL;
+    const double *sv =
+        model_map_at(map, b->sv,
+                     sizeof(*sv) * (b->n_features * n_sv_padded + 1),
+                     VMAF_MODEL_BINARY_ALIGN);
+    const double *coef =
+        model_map_at(map, b->coef, sizeof(*coef) * (n_sv_padded + 1),
+                     VMAF_MODEL_BINARY_ALIGN);
+    if (!sv || !coef) return -EINVAL;
+
+    int err = -ENOMEM;
+    VmafModel *const m = *model = malloc(sizeof(*m));
+    if (!m) goto fail;
+    memset(m, 0, sizeof(*m));
+    m->feature = malloc(sizeof(*m->feature) * b->n_features);
+    if (!m->feature) goto free_m;
+    memset(m->feature, 0, sizeof(*m->feature) * b->n_features);
+    m->name = vmaf_model_generate_name(cfg);
+    if (!m->name) goto free_m;
+
+    m->type = b->type;
+    m->norm_type = b->norm_type;
+    m->slope = b->slope;
+    m->intercept = b->intercept;
+
+    m->score_clip.enabled = (b->flags & VMAF_MODEL_BINARY_SCORE_CLIP) &&
+                            !(cfg->flags & VMAF_MODEL_FLAG_DISABLE_CLIP);
+    if (m->score_clip.enabled) {
+        m->score_clip.min = b->score_clip_min;
+        m->score_clip.max = b->score_clip_max;
+    }
+
+    m->score_transform.enabled =
+        (b->flags & VMAF_MODEL_BINARY_SCORE_TRANSFORM) &&
+        (cfg->flags & VMAF_MODEL_FLAG_ENABLE_TRANSFORM);
+    if (m->score_transform.enabled) {
+        m->score_transform.p0.enabled = b->flags & VMAF_MODEL_BINARY_TRANSFORM_P0;
+        m->score_transform.p0.value = b->p0;
+        m->score_transform.p1.enabled = b->flags & VMAF_MODEL_BINARY_TRANSFORM_P1;
+        m->score_transform.p1.value = b->p1;
+        m->score_transform.p2.enabled = b->flags & VMAF_MODEL_BINARY_TRANSFORM_P2;
+        m->score_transform.p2.value = b->p2;
+        m->score_transform.out_lte_in =
+            b->flags & VMAF_MODEL_BINARY_TRANSFORM_OUT_LTE_IN;
+        m->score_transform.out_gte_in =
+            b->flags & VMAF_MODEL_BINARY_TRANSFORM_OUT_GTE_IN;
+    }
+
+    for (unsigned i = 0; i < b->n_features; i++) {
+        m->n_features++;
+        err = model_map_feature(map, &feature[i], &m->feature[i]);
+        if (err) goto free_m;
+    }
+
+    err = vmaf_svr_wrap(&m->svr, b->n_features, b->n_sv, b->gamma, b->rho,
+                        sv, coef);
+    if (err) goto free_m;
+
+    vmaf_ref_fetch_increment(map->ref);
+    m->map = map;
+    return 0;
+
+free_m:
+    vmaf_model_destroy(m);
+    *model = NULL;
+fail:
+    return err;
+}
+
+static int model_collection_map(VmafModelCollection **model_collection,
+                                VmafModelConfig *cfg, VmafModelMap *map)
+{
+    const VmafModelBinaryHeader *h = (const void *) map->data;
+
+    VmafModelConfig c = *cfg;
+    char *name = vmaf_model_generate_name(cfg);
+    if (!name) return -ENOMEM;
+    const size_t cfg_name_sz = strlen(name) + 5 + 1;
+    char cfg_name[cfg_name_sz];
+    c.name = cfg_name;
+
+    int err = 0;
+    for (unsigned i = 1; i < h->model_cnt && i <= 9999; i++) {
+        snprintf(c.name, cfg_name_sz, "%s_%04d", name, i);
+        VmafModel *m;
+        err = model_map_model(&m, &c, map, i);
+        if (err) break;
+        err = vmaf_model_collection_append(model_collection, m);
+        if (err) {
+            vmaf_model_destroy(m);
+            break;
+        }
+    }
+
+    free(name);
+    return err;
+}
+
+/* Map a binary model. Without `model_collection`, the file has to hold a
+ * single model, -EAGAIN signals a model collection. */
+static int vmaf_read_binary_model(VmafModel **model,
+                                  VmafModelCollection **model_collection,
+                                  VmafModelConfig *cfg, const char *path)
+{
+    VmafModelMap *map;
+    int err = model_map_open(&map, path);
+    if (err) return err;
+
+    const VmafModelBinaryHeader *h = (const void *) map->data;
+    if (!model_collection && h->model_cnt > 1) {
+        // bail, this is a model_collection
+        err = -EAGAIN;
+        goto release;
+    }
+    if (model_collection && h->model_cnt < 2) {
+        err = -EINVAL;
+        goto release;
+    }
+
+    err = model_map_model(model, cfg, map, 0);
+    if (err || !model_collection) goto release;
+
+    *model_collection = NULL;
+    err = model_collection_map(model_collection, cfg, map);
+    if (err) {
+        vmaf_model_collection_destroy(*model_collection);
+        *model_collection = NULL;
+        vmaf_model_destroy(*model);
+        *model = NULL;
+    }
+
+release:
+    model_map_release(map);
+    return err;
+}
+
 int vmaf_model_load_from_path(VmafModel **model, VmafModelConfig *cfg,
                               const char *path)
 {
+    if (cfg->flags & VMAF_MODEL_FLAG_SHARED)
+        return model_registry_load(model, NULL, cfg, NULL, path);
+
+    if (is_binary_model_path(path))
+        return vmaf_read_binary_model(model, NULL, cfg, path);
+
     const char *ext = strrchr(path, '.');
     if (!strcmp(ext, ".json"))
         return vmaf_read_json_model_from_path(model, cfg, path);
@@ -147,11 +631,15 @@ int vmaf_model_load_from_path(VmafModel **model, VmafModelConfig *cfg,
     m->svm = svm_load_model(svm_path);
     free(svm_path);
     if (!m->svm) goto free_name;
-    int err = vmaf_unpickle_model(m, m->path, cfg->flags);
-    if (err) goto free_svm;
+    int err = vmaf_svr_init(&m->svr, m->svm);
+    if (err && err != -ENOTSUP) goto free_svm;
+    err = vmaf_unpickle_model(m, m->path, cfg->flags);
+    if (err) goto free_svr;
 
     return 0;
 
+free_svr:
+    vmaf_svr_destroy(m->svr);
 free_svm:
     svm_free_and_destroy_model(&(m->svm));
 free_name:
@@ -196,11 +684,15 @@ static int vmaf_model_load_from_path_internal(VmafModel **model,
     m->svm = svm_load_model(svm_path);
     free(svm_path);
     if (!m->svm) goto free_name;
-    int err = vmaf_unpickle_model(m, m->path, cfg->flags);
-    if (err) goto free_svm;
+    int err = vmaf_svr_init(&m->svr, m->svm);
+    if (err && err != -ENOTSUP) goto free_svm;
+    err = vmaf_unpickle_model(m, m->path, cfg->flags);
+    if (err) goto free_svr;
 
     return 0;
 
+free_svr:
+    vmaf_svr_destroy(m->svr);
 free_svm:
     svm_free_and_destroy_model(&(m->svm));
 free_name:
@@ -217,9 +709,15 @@ fail:
 void vmaf_model_destroy(VmafModel *model)
 {
     if (!model) return;
+    if (model->shared) {
+        model_registry_release(model->shared);
+        return;
+    }
     free(model->path);
     free(model->name);
     svm_free_and_destroy_model(&(model->svm));
+    vmaf_svr_destroy(model->svr);
+    model_map_release(model->map);
     for (unsigned i = 0; i < model->n_features; i++) {
         free(model->feature[i].name);
         vmaf_dictionary_free(&model->feature[i].opts_dict);
@@ -278,6 +776,10 @@ fail:
 void vmaf_model_collection_destroy(VmafModelCollection *model_collection)
 {
     if (!model_collection) return;
+    if (model_collection->shared) {
+        model_registry_release(model_collection->shared);
+        return;
+    }
     for (unsigned i = 0; i < model_collection->cnt; i++)
         vmaf_model_destroy(model_collection->model[i]);
     free(model_collection->model);
@@ -290,6 +792,11 @@ int vmaf_model_collection_load(VmafModel **model,
                                VmafModelConfig *cfg,
                                const char *version)
 {
+    if (cfg->flags & VMAF_MODEL_FLAG_SHARED) {
+        return model_registry_load(model, model_collection, cfg, version,
+                                   NULL);
+    }
+
     const VmafBuiltInModel *built_in_model = NULL;
 
     for (unsigned i = 0; i < BUILT_IN_MODEL_CNT; i++) {
@@ -311,6 +818,14 @@ int vmaf_model_collection_load_from_path(VmafModel **model,
                                          VmafModelConfig *cfg,
                                          const char *path)
 {
+    if (cfg->flags & VMAF_MODEL_FLAG_SHARED) {
+        return model_registry_load(model, model_collection, cfg, NULL,
+                                   path);
+    }
+
+    if (is_binary_model_path(path))
+        return vmaf_read_binary_model(model, model_collection, cfg, path);
+
     const char *ext = strrchr(path, '.');
     if (!strcmp(ext, ".json")) {
         return vmaf_read_json_model_collection_from_path(model,
@@ -366,3 +881,187 @@ fail:
     free(name);
     return err;
 }
+
+static int write_padding(FILE *out, unsigned align)
+{
+    long pos = ftell(out);
+    if (pos < 0) return -EIO;
+    for (; pos % align; pos++) {
+        if (fputc(0, out) == EOF)
+            return -EIO;
+    }
+    return 0;
+}
+
+static int write_aligned(FILE *out, uint64_t *offset, const void *data,
+                         size_t sz, unsigned align)
+{
+    int err = write_padding(out, align);
+    if (err) return err;
+    long pos = ftell(out);
+    if (pos < 0) return -EIO;
+    if (offset) *offset = pos;
+    if (sz && fwrite(data, sz, 1, out) != 1) return -EIO;
+    return 0;
+}
+
+static int write_string(FILE *out, uint64_t *offset, const char *str)
+{
+    return write_aligned(out, offset, str, strlen(str) + 1, 1);
+}
+
+static int write_model_feature(FILE *out, VmafModelFeature *model_feature,
+                               VmafModelBinaryFeature *feature)
+{
+    int err = write_string(out, &feature->name, model_feature->name);
+    if (err) return err;
+    feature->slope = model_feature->slope;
+    feature->intercept = model_feature->intercept;
+
+    const VmafDictionaryEntry *entry;
+    for (unsigned i = 0;
+         (entry = vmaf_dictionary_get_entry(&model_feature->opts_dict, i));
+         i++)
+    {
+        err = write_string(out, i ? NULL : &feature->opts, entry->key);
+        if (err) return err;
+        err = write_string(out, NULL, entry->val);
+        if (err) return err;
+        feature->opts_cnt++;
+    }
+
+    return 0;
+}
+
+/* The dense matrix of `svr` only has rows up to the highest feature index
+ * used by a support vector, the rows for the remaining model features are
+ * written as zeros. Like in the sparse libsvm model, these features are
+ * then compared against zero. */
+static int write_model(FILE *out, VmafModel *model, uint64_t *offset)
+{
+    const VmafSvr *svr = model->svr;
+    if (!svr) return -ENOTSUP;
+    if (!model->n_features) return -EINVAL;
+    if (svr->n_features > model->n_features) return -EINVAL;
+
+    int err = 0;
+    VmafModelBinaryFeature feature[model->n_features];
+    memset(feature, 0, sizeof(feature));
+    for (unsigned i = 0; i < model->n_features; i++) {
+        err = write_model_feature(out, &model->feature[i], &feature[i]);
+        if (err) return err;
+    }
+
+    VmafModelBinaryModel b;
+    memset(&b, 0, sizeof(b));
+    b.type = model->type;
+    b.norm_type = model->norm_type;
+    b.n_features = model->n_features;
+    b.slope = model->slope;
+    b.intercept = model->intercept;
+    b.n_sv = svr->n_sv;
+    b.n_sv_padded = svr->n_sv_padded;
+    b.gamma = svr->gamma;
+    b.rho = svr->rho;
+
+    if (model->score_clip.enabled) {
+        b.flags |= VMAF_MODEL_BINARY_SCORE_CLIP;
+        b.score_clip_min = model->score_clip.min;
+        b.score_clip_max = model->score_clip.max;
+    }
+
+    if (model->score_transform.enabled) {
+        b.flags |= VMAF_MODEL_BINARY_SCORE_TRANSFORM;
+        if (model->score_transform.p0.enabled)
+            b.flags |= VMAF_MODEL_BINARY_TRANSFORM_P0;
+        if (model->score_transform.p1.enabled)
+            b.flags |= VMAF_MODEL_BINARY_TRANSFORM_P1;
+        if (model->score_transform.p2.enabled)
+            b.flags |= VMAF_MODEL_BINARY_TRANSFORM_P2;
+        if (model->score_transform.out_lte_in)
+            b.flags |= VMAF_MODEL_BINARY_TRANSFORM_OUT_LTE_IN;
+        if (model->score_transform.out_gte_in)
+            b.flags |= VMAF_MODEL_BINARY_TRANSFORM_OUT_GTE_IN;
+        b.p0 = model->score_transform.p0.value;
+        b.p1 = model->score_transform.p1.value;
+        b.p2 = model->score_transform.p2.value;
+    }
+
+    const size_t row_sz = sizeof(*svr->sv) * svr->n_sv_padded;
+    const double zero[VMAF_SVR_SV_ALIGN] = { 0 };
+    for (unsigned i = 0; i < model->n_features; i++) {
+        if (i < svr->n_features) {
+            err = write_aligned(out, i ? NULL : &b.sv,
+                                &svr->sv[i * svr->n_sv_padded], row_sz,
+                                VMAF_MODEL_BINARY_ALIGN);
+            if (err) return err;
+            continue;
+        }
+        for (unsigned j = 0; j < svr->n_sv_padded; j += VMAF_SVR_SV_ALIGN) {
+            err = write_aligned(out, (i || j) ? NULL : &b.sv, zero,
+                                sizeof(zero), VMAF_MODEL_BINARY_ALIGN);
+            if (err) return err;
+        }
+    }
+    err = write_aligned(out, NULL, zero, sizeof(*zero), 1);
+    if (err) return err;
+
+    err = write_aligned(out, &b.coef, svr->coef,
+                        sizeof(*svr->coef) * (svr->n_sv_padded + 1),
+                        VMAF_MODEL_BINARY_ALIGN);
+    if (err) return err;
+    err = write_aligned(out, &b.feature, feature, sizeof(feature),
+                        sizeof(uint64_t));
+    if (err) return err;
+    return write_aligned(out, offset, &b, sizeof(b), sizeof(uint64_t));
+}
+
+int vmaf_model_write_binary(VmafModel *model,
+                            VmafModelCollection *model_collection,
+                            const char *path)
+{
+    if (!model) return -EINVAL;
+    if (!path) return -EINVAL;
+
+    const unsigned model_cnt =
+        1 + (model_collection ? model_collection->cnt : 0);
+    uint64_t offset[model_cnt];
+    memset(offset, 0, sizeof(offset));
+
+    VmafModelBinaryHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, VMAF_MODEL_BINARY_MAGIC, sizeof(h.magic));
+    h.version = VMAF_MODEL_BINARY_VERSION;
+    h.byte_order = VMAF_MODEL_BINARY_BYTE_ORDER;
+    h.model_cnt = model_cnt;
+
+    FILE *out = fopen(path, "wb");
+    if (!out) return -EINVAL;
+
+    // header and offsets are rewritten once the models have been written
+    int err = write_aligned(out, NULL, &h, sizeof(h), 1);
+    if (err) goto close;
+    err = write_aligned(out, NULL, offset, sizeof(offset), 1);
+    if (err) goto close;
+
+    for (unsigned i = 0; i < model_cnt; i++) {
+        VmafModel *m = i ? model_collection->model[i - 1] : model;
+        err = write_model(out, m, &offset[i]);
+        if (err) goto close;
+    }
+
+    const long sz = ftell(out);
+    if (sz < 0 || fseek(out, 0, SEEK_SET)) {
+        err = -EIO;
+        goto close;
+    }
+    h.sz = sz;
+    err = write_aligned(out, NULL, &h, sizeof(h), 1);
+    if (err) goto close;
+    err = write_aligned(out, NULL, offset, sizeof(offset), 1);
+
+close:
+    if (fclose(out) && !err) err = -EIO;
+    if (err) remove(path);
+    return err;
+}
@@ -20,6 +20,8 @@
 #define __VMAF_SRC_MODEL_H__
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #include "dict.h"
 #include "libvmaf/model.h"
@@ -64,6 +66,9 @@ typedef struct VmafModel {
         bool out_lte_in, out_gte_in;
     } score_transform;
     struct svm_model *svm;
+    struct VmafSvr *svr; ///< dense copy of `svm`, NULL if unsupported
+    struct VmafModelMap *map; ///< backs `svr` of a binary model, `svm` is NULL
+    struct VmafModelRegistryEntry *shared; ///< see `VMAF_MODEL_FLAG_SHARED`
 } VmafModel;
 
 typedef struct VmafModelCollection {
@@ -71,11 +76,89 @@ typedef struct VmafModelCollection {
     unsigned cnt, size;
     enum VmafModelType type;
     const char *name;
+    struct VmafModelRegistryEntry *shared; ///< see `VMAF_MODEL_FLAG_SHARED`
 } VmafModelCollection;
 
+/**
+ * Precompiled binary models, written by `vmaf_model_write_binary()` and
+ * loaded from paths ending in `.vmafb`.
+ *
+ * A native-endian file made of a header, a table with the offset of each
+ * model record, and the data the records point to. Nothing needs parsing:
+ * the support vectors are stored as `VmafSvr` matrices aligned to
+ * VMAF_MODEL_BINARY_ALIGN, which are used in place from the memory-mapped
+ * file. The first model is the model, any further models form its model
+ * collection and are named as in a JSON model collection.
+ *
+ * Clipping and transform parameters are always stored, the
+ * `VmafModelFlags` are applied at load time.
+ */
+#define VMAF_MODEL_BINARY_MAGIC "VMAFBIN"
+#define VMAF_MODEL_BINARY_VERSION 1
+#define VMAF_MODEL_BINARY_BYTE_ORDER 0x01020304
+#define VMAF_MODEL_BINARY_ALIGN 64
+
+enum VmafModelBinaryFlags {
+    VMAF_MODEL_BINARY_SCORE_CLIP = 1 << 0,
+    VMAF_MODEL_BINARY_SCORE_TRANSFORM = 1 << 1,
+    VMAF_MODEL_BINARY_TRANSFORM_P0 = 1 << 2,
+    VMAF_MODEL_BINARY_TRANSFORM_P1 = 1 << 3,
+    VMAF_MODEL_BINARY_TRANSFORM_P2 = 1 << 4,
+    VMAF_MODEL_BINARY_TRANSFORM_OUT_LTE_IN = 1 << 5,
+    VMAF_MODEL_BINARY_TRANSFORM_OUT_GTE_IN = 1 << 6,
+};
+
+typedef struct VmafModelBinaryHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t sz; ///< file size
+    uint32_t model_cnt;
+    uint32_t reserved;
+    /* followed by `model_cnt` offsets of `VmafModelBinaryModel` */
+} VmafModelBinaryHeader;
+
+typedef struct VmafModelBinaryFeature {
+    uint64_t name; ///< offset of a NUL-terminated string
+    uint64_t opts; ///< offset of `opts_cnt` NUL-terminated key/value pairs
+    uint32_t opts_cnt;
+    uint32_t reserved;
+    double slope, intercept;
+} VmafModelBinaryFeature;
+
+typedef struct VmafModelBinaryModel {
+    uint32_t type, norm_type;
+    uint32_t flags; ///< `enum VmafModelBinaryFlags`
+    uint32_t n_features;
+    double slope, intercept;
+    double score_clip_min, score_clip_max;
+    double p0, p1, p2;
+    uint32_t n_sv, n_sv_padded;
+    double gamma, rho;
+    uint64_t feature; ///< offset of `n_features` `VmafModelBinaryFeature`
+    uint64_t sv; ///< offset of `n_features` rows of `n_sv_padded` values
+    uint64_t coef; ///< offset of `n_sv_padded` values
+} VmafModelBinaryModel;
+
+typedef struct VmafModelMap {
+    const uint8_t *data;
+    size_t sz;
+    struct VmafRef *ref; ///< one per model using the mapping
+} VmafModelMap;
+
 char *vmaf_model_generate_name(VmafModelConfig *cfg);
 
 int vmaf_model_collection_append(VmafModelCollection **model_collection,
                                  VmafModel *model);
 
+/**
+ * Write `model`, and optionally its `model_collection`, as a binary model.
+ * Clipping and transform parameters are only written if they were enabled
+ * when `model` was loaded. Returns -ENOTSUP for models which do not have a
+ * `VmafSvr`.
+ */
+int vmaf_model_write_binary(VmafModel *model,
+                            VmafModelCollection *model_collection,
+                            const char *path);
+
 #endif /* __VMAF_SRC_MODEL_H__ */
@@ -24,16 +24,17 @@
 
 #include <libvmaf/libvmaf.rc.h>
 
-static unsigned max_capacity(VmafFeatureCollector *fc)
+static unsigned max_index_end(VmafFeatureCollector *fc)
 {
-    unsigned capacity = 0;
+    unsigned index_end = 0;
 
     for (unsigned j = 0; j < fc->cnt; j++) {
-        if (fc->feature_vector[j]->capacity > capacity)
-            capacity = fc->feature_vector[j]->capacity;
+        FeatureVector *fv = feature_collector_get_vector(fc, j);
+        if (fv->index_end > index_end)
+            index_end = fv->index_end;
     }
 
-    return capacity;
+    return index_end;
 }
 
 static const char *pool_method_name[] = {
@@ -58,28 +59,28 @@ int vmaf_write_output_xml(VmafContext *vmaf, VmafFeatureCollector *fc,
 
     unsigned n_frames = 0;
     fprintf(outfile, "  <frames>\n");
-    for (unsigned i = 0 ; i < max_capacity(fc); i++) {
+    for (unsigned i = vmaf_feature_collector_retained_begin(fc);
+         i < max_index_end(fc); i++) {
         if ((subsample > 1) && (i % subsample))
             continue;
 
         unsigned cnt = 0;
+        double score;
         for (unsigned j = 0; j < fc->cnt; j++) {
-            if (i > fc->feature_vector[j]->capacity)
-                continue;
-            if (fc->feature_vector[j]->score[i].written)
+            FeatureVector *fv = feature_collector_get_vector(fc, j);
+            if (feature_vector_get_score(fv, i, &score))
                 cnt++;
         }
         if (!cnt) continue;
 
         fprintf(outfile, "    <frame frameNum=\"%d\" ", i);
         for (unsigned j = 0; j < fc->cnt; j++) {
-            if (i > fc->feature_vector[j]->capacity)
-                continue;
-            if (!fc->feature_vector[j]->score[i].written)
+            FeatureVector *fv = feature_collector_get_vector(fc, j);
+            if (!feature_vector_get_score(fv, i, &score))
                 continue;
             fprintf(outfile, "%s=\"%.6f\" ",
-                vmaf_feature_name_alias(fc->feature_vector[j]->name),
-                fc->feature_vector[j]->score[i].value
+                vmaf_feature_name_alias(fv->name),
+                score
             );
         }
         n_frames++;
@@ -89,7 +90,7 @@ int vmaf_write_output_xml(VmafContext *vmaf, VmafFeatureCollector *fc,
 
     fprintf(outfile, "  <pooled_metrics>\n");
     for (unsigned i = 0; i < fc->cnt; i++) {
-        const char *feature_name = fc->feature_vector[i]->name;
+        const char *feature_name = feature_collector_get_vector(fc, i)->name;
         fprintf(outfile, "    <metric name=\"%s\" ",
                 vmaf_feature_name_alias(feature_name));
 
@@ -117,19 +118,20 @@ int vmaf_write_output_json(VmafContext *vmaf, VmafFeatureCollector *fc,
 
     unsigned n_frames = 0;
     fprintf(outfile, "  \"frames\": [");
-    for (unsigned i = 0 ; i < max_capacity(fc); i++) {
+    for (unsigned i = vmaf_feature_collector_retained_begin(fc);
+         i < max_index_end(fc); i++) {
         if ((subsample > 1) && (i % subsample))
             continue;
 
         unsigned cnt = 0;
+        double score;
         for (unsigned j = 0; j < fc->cnt; j++) {
-            if (i > fc->feature_vector[j]->capacity)
-                continue;
-            if (fc->feature_vector[j]->score[i].written)
+            FeatureVector *fv = feature_collector_get_vector(fc, j);
+            if (feature_vector_get_score(fv, i, &score))
                 cnt++;
         }
         if (!cnt) continue;
-        fprintf(outfile, "%s", i > 0 ? ",\n" : "\n");
+        fprintf(outfile, "%s", n_frames > 0 ? ",\n" : "\n");
 
         fprintf(outfile, "    {\n");
         fprintf(outfile, "      \"frameNum\": %d,\n", i);
@@ -137,14 +139,13 @@ int vmaf_write_output_json(VmafContext *vmaf, VmafFeatureCollector *fc,
 
         unsigned cnt2 = 0;
         for (unsigned j = 0; j < fc->cnt; j++) {
-            if (i > fc->feature_vector[j]->capacity)
-                continue;
-            if (!fc->feature_vector[j]->score[i].written)
+            FeatureVector *fv = feature_collector_get_vector(fc, j);
+            if (!feature_vector_get_score(fv, i, &score))
                 continue;
             cnt2++;
             fprintf(outfile, "        \"%s\": %.6f%s\n",
-                vmaf_feature_name_alias(fc->feature_vector[j]->name),
-                fc->feature_vector[j]->score[i].value,
+                vmaf_feature_name_alias(fv->name),
+                score,
                 cnt2 < cnt ? "," : ""
             );
         }
@@ -156,7 +157,7 @@ int vmaf_write_output_json(VmafContext *vmaf, VmafFeatureCollector *fc,
 
     fprintf(outfile, "  \"pooled_metrics\": [");
     for (unsigned i = 0; i < fc->cnt; i++) {
-        const char *feature_name = fc->feature_vector[i]->name;
+        const char *feature_name = feature_collector_get_vector(fc, i)->name;
         fprintf(outfile, "%s", i > 0 ? ",\n" : "\n");
         fprintf(outfile, "    {\n");
         fprintf(outfile, "      \"metric\": \"%s\",\n",
@@ -189,31 +190,31 @@ int vmaf_write_output_csv(VmafFeatureCollector *fc, FILE *outfile,
 
     fprintf(outfile, "Frame,");
     for (unsigned i = 0; i < fc->cnt; i++) {
-        fprintf(outfile, "%s,",
-                vmaf_feature_name_alias(fc->feature_vector[i]->name));
+        FeatureVector *fv = feature_collector_get_vector(fc, i);
+        fprintf(outfile, "%s,", vmaf_feature_name_alias(fv->name));
     }
     fprintf(outfile, "\n");
 
-    for (unsigned i = 0 ; i < max_capacity(fc); i++) {
+    for (unsigned i = vmaf_feature_collector_retained_begin(fc);
+         i < max_index_end(fc); i++) {
         if ((subsample > 1) && (i % subsample))
             continue;
 
         unsigned cnt = 0;
+        double score;
         for (unsigned j = 0; j < fc->cnt; j++) {
-            if (i > fc->feature_vector[j]->capacity)
-                continue;
-            if (fc->feature_vector[j]->score[i].written)
+            FeatureVector *fv = feature_collector_get_vector(fc, j);
+            if (feature_vector_get_score(fv, i, &score))
                 cnt++;
         }
         if (!cnt) continue;
 
         fprintf(outfile, "%d,", i);
         for (unsigned j = 0; j < fc->cnt; j++) {
-            if (i > fc->feature_vector[j]->capacity)
-                continue;
-            if (!fc->feature_vector[j]->score[i].written)
+            FeatureVector *fv = feature_collector_get_vector(fc, j);
+            if (!feature_vector_get_score(fv, i, &score))
                 continue;
-            fprintf(outfile, "%.6f,", fc->feature_vector[j]->score[i].value);
+            fprintf(outfile, "%.6f,", score);
         }
         fprintf(outfile, "\n");
     }
@@ -224,28 +225,28 @@ int vmaf_write_output_csv(VmafFeatureCollector *fc, FILE *outfile,
 int vmaf_write_output_sub(VmafFeatureCollector *fc, FILE *outfile,
                           unsigned subsample)
 {
-    for (unsigned i = 0 ; i < max_capacity(fc); i++) {
+    for (unsigned i = vmaf_feature_collector_retained_begin(fc);
+         i < max_index_end(fc); i++) {
         if ((subsample > 1) && (i % subsample))
             continue;
 
         unsigned cnt = 0;
+        double score;
         for (unsigned j = 0; j < fc->cnt; j++) {
-            if (i > fc->feature_vector[j]->capacity)
-                continue;
-            if (fc->feature_vector[j]->score[i].written)
+            FeatureVector *fv = feature_collector_get_vector(fc, j);
+            if (feature_vector_get_score(fv, i, &score))
                 cnt++;
         }
         if (!cnt) continue;
 
         fprintf(outfile, "{%d}{%d}frame: %d|", i, i + 1, i);
         for (unsigned j = 0; j < fc->cnt; j++) {
-            if (i > fc->feature_vector[j]->capacity)
-                continue;
-            if (!fc->feature_vector[j]->score[i].written)
+            FeatureVector *fv = feature_collector_get_vector(fc, j);
+            if (!feature_vector_get_score(fv, i, &score))
                 continue;
             fprintf(outfile, "%s: %.6f|",
-                    vmaf_feature_name_alias(fc->feature_vector[j]->name),
-                    fc->feature_vector[j]->score[i].value);
+                    vmaf_feature_name_alias(fv->name),
+                    score);
         }
         fprintf(outfile, "\n");
     }
@@ -17,6 +17,8 @@
  */
 
 #include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
@@ -27,13 +29,9 @@
 
 #define DATA_ALIGN 32
 
-int vmaf_picture_alloc(VmafPicture *pic, enum VmafPixelFormat pix_fmt,
-                       unsigned bpc, unsigned w, unsigned h)
+static void picture_set_geometry(VmafPicture *pic, enum VmafPixelFormat pix_fmt,
+                                 unsigned bpc, unsigned w, unsigned h)
 {
-    if (!pic) return -EINVAL;
-    if (!pix_fmt) return -EINVAL;
-    if (bpc < 8 || bpc > 16) return -EINVAL;
-
     memset(pic, 0, sizeof(*pic));
     pic->pix_fmt = pix_fmt;
     pic->bpc = bpc;
@@ -43,6 +41,16 @@ int vmaf_picture_alloc(VmafPicture *pic, enum VmafPixelFormat pix_fmt,
     pic->w[1] = pic->w[2] = w >> ss_hor;
     pic->h[0] = h;
     pic->h[1] = pic->h[2] = h >> ss_ver;
+}
+
+int vmaf_picture_alloc(VmafPicture *pic, enum VmafPixelFormat pix_fmt,
+                       unsigned bpc, unsigned w, unsigned h)
+{
+    if (!pic) return -EINVAL;
+    if (!pix_fmt) return -EINVAL;
+    if (bpc < 8 || bpc > 16) return -EINVAL;
+
+    picture_set_geometry(pic, pix_fmt, bpc, w, h);
     const int aligned_y = (pic->w[0] + DATA_ALIGN - 1) & ~(DATA_ALIGN - 1);
     const int aligned_c = (pic->w[1] + DATA_ALIGN - 1) & ~(DATA_ALIGN - 1);
     const int hbd = pic->bpc > 8;
@@ -70,6 +78,243 @@ fail:
     return -ENOMEM;
 }
 
+typedef struct PictureCacheEntry {
+    int (*fill)(void *data, VmafPicture *pic, int key);
+    int key;
+    void *data;
+    size_t size;
+    int err;
+    bool ready;
+    struct PictureCacheEntry *next;
+} PictureCacheEntry;
+
+struct VmafPictureCache {
+    PictureCacheEntry *entry;
+    PictureCacheEntry *spare; ///< entries of a recycled picture, data kept
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+};
+
+static void picture_cache_entry_free(PictureCacheEntry *entry)
+{
+    while (entry) {
+        PictureCacheEntry *next = entry->next;
+        aligned_free(entry->data);
+        free(entry);
+        entry = next;
+    }
+}
+
+static void picture_cache_destroy(VmafPictureCache *cache)
+{
+    if (!cache) return;
+
+    picture_cache_entry_free(cache->entry);
+    picture_cache_entry_free(cache->spare);
+    pthread_mutex_destroy(&(cache->lock));
+    pthread_cond_destroy(&(cache->ready));
+    free(cache);
+}
+
+/* Called once the last reference is dropped, so nothing else holds the
+ * cache. The entries are kept as spares for the next use of the picture. */
+static void picture_cache_recycle(VmafPictureCache *cache)
+{
+    if (!cache) return;
+
+    PictureCacheEntry *entry = cache->entry;
+    while (entry) {
+        PictureCacheEntry *next = entry->next;
+        entry->next = cache->spare;
+        cache->spare = entry;
+        entry = next;
+    }
+    cache->entry = NULL;
+}
+
+static void picture_ref_close(VmafRef *ref)
+{
+    picture_cache_destroy(ref->cache);
+    vmaf_ref_close(ref);
+}
+
+typedef struct PictureWrap {
+    VmafRef *ref;
+    void (*release)(void *cookie);
+    void *cookie;
+} PictureWrap;
+
+static void picture_wrap_release(void *user_data)
+{
+    PictureWrap *wrap = user_data;
+    if (wrap->release) wrap->release(wrap->cookie);
+    picture_ref_close(wrap->ref);
+    free(wrap);
+}
+
+int vmaf_picture_wrap(VmafPicture *pic, enum VmafPixelFormat pix_fmt,
+                      unsigned bpc, unsigned w, unsigned h,
+                      void *const data[3], const ptrdiff_t stride[3],
+                      void (*release)(void *cookie), void *cookie)
+{
+    if (!pic) return -EINVAL;
+    if (!pix_fmt) return -EINVAL;
+    if (bpc < 8 || bpc > 16) return -EINVAL;
+    if (!data || !stride) return -EINVAL;
+
+    picture_set_geometry(pic, pix_fmt, bpc, w, h);
+    for (unsigned i = 0; i < 3; i++) {
+        if (!data[i]) return -EINVAL;
+        if (stride[i] < (ptrdiff_t) (pic->w[i] << (bpc > 8))) return -EINVAL;
+        pic->data[i] = data[i];
+        pic->stride[i] = stride[i];
+    }
+
+    PictureWrap *wrap = malloc(sizeof(*wrap));
+    if (!wrap) goto fail;
+    int err = vmaf_ref_init(&wrap->ref);
+    if (err) goto free_wrap;
+    wrap->release = release;
+    wrap->cookie = cookie;
+    wrap->ref->release = picture_wrap_release;
+    wrap->ref->user_data = wrap;
+    pic->ref = wrap->ref;
+
+    return 0;
+
+free_wrap:
+    free(wrap);
+fail:
+    memset(pic, 0, sizeof(*pic));
+    return -ENOMEM;
+}
+
+int vmaf_picture_ensure_aligned(VmafPicture *pic)
+{
+    if (!pic) return -EINVAL;
+
+    /* Extractors may read rows up to the padded width. */
+    const int hbd = pic->bpc > 8;
+    bool aligned = true;
+    for (unsigned i = 0; i < 3; i++) {
+        const ptrdiff_t min_stride =
+            ((pic->w[i] + DATA_ALIGN - 1) & ~(DATA_ALIGN - 1)) << hbd;
+        aligned &= !(((uintptr_t) pic->data[i]) % DATA_ALIGN);
+        aligned &= !(pic->stride[i] % DATA_ALIGN);
+        aligned &= pic->stride[i] >= min_stride;
+    }
+    if (aligned) return 0;
+
+    VmafPicture copy;
+    int err = vmaf_picture_alloc(&copy, pic->pix_fmt, pic->bpc,
+                                 pic->w[0], pic->h[0]);
+    if (err) return err;
+
+    for (unsigned i = 0; i < 3; i++) {
+        uint8_t *src = pic->data[i];
+        uint8_t *dst = copy.data[i];
+        for (unsigned j = 0; j < pic->h[i]; j++) {
+            memcpy(dst, src, pic->w[i] << hbd);
+            src += pic->stride[i];
+            dst += copy.stride[i];
+        }
+    }
+
+    err = vmaf_picture_unref(pic);
+    *pic = copy;
+    return err;
+}
+
+static VmafPictureCache *picture_cache_get(VmafRef *ref)
+{
+    pthread_mutex_lock(&(ref->lock));
+    VmafPictureCache *cache = ref->cache;
+    if (cache) goto unlock;
+
+    cache = malloc(sizeof(*cache));
+    if (!cache) goto unlock;
+    memset(cache, 0, sizeof(*cache));
+    pthread_mutex_init(&(cache->lock), NULL);
+    pthread_cond_init(&(cache->ready), NULL);
+    ref->cache = cache;
+
+unlock:
+    pthread_mutex_unlock(&(ref->lock));
+    return cache;
+}
+
+/* Takes a spare entry with room for `size` bytes, or allocates a new one.
+ * Called with the cache locked. */
+static PictureCacheEntry *picture_cache_entry_get(VmafPictureCache *cache,
+                                                  size_t size)
+{
+    PictureCacheEntry **spare = &cache->spare;
+    while (*spare && (*spare)->size < size)
+        spare = &(*spare)->next;
+    if (*spare) {
+        PictureCacheEntry *entry = *spare;
+        *spare = entry->next;
+        return entry;
+    }
+
+    PictureCacheEntry *entry = malloc(sizeof(*entry));
+    if (!entry) return NULL;
+    memset(entry, 0, sizeof(*entry));
+    entry->data = aligned_malloc(size, DATA_ALIGN);
+    if (!entry->data) {
+        free(entry);
+        return NULL;
+    }
+    entry->size = size;
+    return entry;
+}
+
+void *vmaf_picture_cache_fetch(VmafPicture *pic, int key, size_t size,
+                               int (*fill)(void *data, VmafPicture *pic,
+                                           int key))
+{
+    if (!pic || !pic->ref) return NULL;
+    if (!fill) return NULL;
+
+    VmafPictureCache *cache = picture_cache_get(pic->ref);
+    if (!cache) return NULL;
+
+    pthread_mutex_lock(&(cache->lock));
+    PictureCacheEntry *entry = cache->entry;
+    while (entry && (entry->fill != fill || entry->key != key))
+        entry = entry->next;
+    if (entry) {
+        while (!entry->ready)
+            pthread_cond_wait(&(cache->ready), &(cache->lock));
+        void *data = entry->err ? NULL : entry->data;
+        pthread_mutex_unlock(&(cache->lock));
+        return data;
+    }
+
+    entry = picture_cache_entry_get(cache, size);
+    if (!entry) {
+        pthread_mutex_unlock(&(cache->lock));
+        return NULL;
+    }
+    entry->fill = fill;
+    entry->key = key;
+    entry->err = 0;
+    entry->ready = false;
+    entry->next = cache->entry;
+    cache->entry = entry;
+    pthread_mutex_unlock(&(cache->lock));
+
+    /* Filled without the lock, so that other entries are not held up. */
+    const int err = fill(entry->data, pic, key);
+
+    pthread_mutex_lock(&(cache->lock));
+    entry->err = err;
+    entry->ready = true;
+    pthread_cond_broadcast(&(cache->ready));
+    pthread_mutex_unlock(&(cache->lock));
+    return err ? NULL : entry->data;
+}
+
 int vmaf_picture_ref(VmafPicture *dst, VmafPicture *src) {
     if (!dst || !src) return -EINVAL;
 
@@ -82,11 +327,139 @@ int vmaf_picture_unref(VmafPicture *pic) {
     if (!pic) return -EINVAL;
     if (!pic->ref) return -EINVAL;
 
-    vmaf_ref_fetch_decrement(pic->ref);
-    if (vmaf_ref_load(pic->ref) == 0) {
-        aligned_free(pic->data[0]);
-        vmaf_ref_close(pic->ref);
+    VmafRef *const ref = pic->ref;
+    if (vmaf_ref_fetch_decrement(ref) == 1) {
+        if (ref->release) {
+            picture_cache_recycle(ref->cache);
+            ref->release(ref->user_data);
+        } else {
+            aligned_free(pic->data[0]);
+            picture_ref_close(ref);
+        }
     }
     memset(pic, 0, sizeof(*pic));
     return 0;
 }
+
+typedef struct PoolEntry {
+    VmafPicturePool *pool;
+    VmafPicture pic;
+} PoolEntry;
+
+struct VmafPicturePool {
+    VmafPicturePoolConfig cfg;
+    PoolEntry *entry;
+    PoolEntry **free; ///< stack of entries not in use
+    unsigned free_cnt;
+    bool closed;
+    pthread_mutex_t lock;
+    pthread_cond_t available;
+};
+
+static size_t picture_size(VmafPicture *pic)
+{
+    return pic->stride[0] * pic->h[0] + 2 * pic->stride[1] * pic->h[1];
+}
+
+static void picture_pool_free(VmafPicturePool *pool)
+{
+    for (unsigned i = 0; i < pool->cfg.pic_cnt; i++) {
+        if (!pool->entry[i].pic.ref) continue;
+        aligned_free(pool->entry[i].pic.data[0]);
+        picture_ref_close(pool->entry[i].pic.ref);
+    }
+    pthread_mutex_destroy(&(pool->lock));
+    pthread_cond_destroy(&(pool->available));
+    free(pool->free);
+    free(pool->entry);
+    free(pool);
+}
+
+/* Runs on whichever thread drops the last reference. The pool is freed by
+ * either this, or `vmaf_picture_pool_destroy()`, whichever comes last. */
+static void picture_pool_release(void *user_data)
+{
+    PoolEntry *entry = user_data;
+    VmafPicturePool *pool = entry->pool;
+
+    pthread_mutex_lock(&(pool->lock));
+    pool->free[pool->free_cnt++] = entry;
+    const bool done = pool->closed && pool->free_cnt == pool->cfg.pic_cnt;
+    pthread_cond_signal(&(pool->available));
+    pthread_mutex_unlock(&(pool->lock));
+
+    if (done) picture_pool_free(pool);
+}
+
+int vmaf_picture_pool_create(VmafPicturePool **pool, VmafPicturePoolConfig cfg)
+{
+    if (!pool) return -EINVAL;
+    if (!cfg.pic_cnt) return -EINVAL;
+
+    int err = 0;
+
+    VmafPicturePool *const p = *pool = malloc(sizeof(*p));
+    if (!p) return -ENOMEM;
+    memset(p, 0, sizeof(*p));
+    p->cfg = cfg;
+    pthread_mutex_init(&(p->lock), NULL);
+    pthread_cond_init(&(p->available), NULL);
+
+    p->entry = malloc(sizeof(*(p->entry)) * cfg.pic_cnt);
+    p->free = malloc(sizeof(*(p->free)) * cfg.pic_cnt);
+    if (!p->entry || !p->free) {
+        err = -ENOMEM;
+        goto free_p;
+    }
+    memset(p->entry, 0, sizeof(*(p->entry)) * cfg.pic_cnt);
+
+    for (unsigned i = 0; i < cfg.pic_cnt; i++) {
+        PoolEntry *entry = &p->entry[i];
+        err = vmaf_picture_alloc(&entry->pic, cfg.pix_fmt, cfg.bpc,
+                                 cfg.w, cfg.h);
+        if (err) goto free_p;
+        entry->pool = p;
+        entry->pic.ref->release = picture_pool_release;
+        entry->pic.ref->user_data = entry;
+        vmaf_ref_fetch_decrement(entry->pic.ref);
+        p->free[p->free_cnt++] = entry;
+    }
+
+    return 0;
+
+free_p:
+    picture_pool_free(p);
+    *pool = NULL;
+    return err;
+}
+
+int vmaf_picture_pool_fetch(VmafPicturePool *pool, VmafPicture *pic)
+{
+    if (!pool) return -EINVAL;
+    if (!pic) return -EINVAL;
+
+    pthread_mutex_lock(&(pool->lock));
+    while (!pool->free_cnt)
+        pthread_cond_wait(&(pool->available), &(pool->lock));
+    PoolEntry *entry = pool->free[--pool->free_cnt];
+    pthread_mutex_unlock(&(pool->lock));
+
+    *pic = entry->pic;
+    vmaf_ref_fetch_increment(pic->ref);
+    if (pool->cfg.flags & VMAF_PICTURE_POOL_FLAG_CLEAR)
+        memset(pic->data[0], 0, picture_size(pic));
+    return 0;
+}
+
+int vmaf_picture_pool_destroy(VmafPicturePool *pool)
+{
+    if (!pool) return -EINVAL;
+
+    pthread_mutex_lock(&(pool->lock));
+    pool->closed = true;
+    const bool done = pool->free_cnt == pool->cfg.pic_cnt;
+    pthread_mutex_unlock(&(pool->lock));
+
+    if (done) picture_pool_free(pool);
+    return 0;
+}
@@ -23,4 +23,27 @@
 
 int vmaf_picture_ref(VmafPicture *dst, VmafPicture *src);
 
+/**
+ * Replace `pic` with an aligned copy, unless its planes already meet the
+ * alignment of `vmaf_picture_alloc()`.
+ */
+int vmaf_picture_ensure_aligned(VmafPicture *pic);
+
+typedef struct VmafPictureCache VmafPictureCache;
+
+/**
+ * Fetch data derived from `pic`, e.g. a converted plane, which is shared by
+ * every holder of the picture and dropped along with its last reference.
+ * Pictures with a release callback, e.g. from a pool, keep the allocations
+ * and reuse them for entries of the same size or smaller.
+ * Entries are identified by `fill` and `key`. The first request allocates
+ * `size` bytes with the alignment of `vmaf_picture_alloc()` and calls `fill`
+ * on them, concurrent requests for the same entry wait for it to finish.
+ *
+ * @return the entry, or NULL if it could not be allocated or filled.
+ */
+void *vmaf_picture_cache_fetch(VmafPicture *pic, int key, size_t size,
+                               int (*fill)(void *data, VmafPicture *pic,
+                                           int key));
+
 #endif /* __VMAF_SRC_PICTURE_H__ */
@@ -27,8 +27,9 @@
 #include "model.h"
 #include "predict.h"
 #include "svm.h"
+#include "svr.h"
 
-static int normalize(VmafModel *model, double slope, double intercept,
+static int normalize(const VmafModel *model, double slope, double intercept,
                      double *feature_score)
 {
     switch (model->norm_type) {
@@ -44,7 +45,7 @@ static int normalize(VmafModel *model, double slope, double intercept,
     return 0;
 }
 
-static int denormalize(VmafModel *model, double *prediction)
+static int denormalize(const VmafModel *model, double *prediction)
 {
     switch (model->norm_type) {
     case(VMAF_MODEL_NORMALIZATION_TYPE_NONE):
@@ -60,7 +61,7 @@ static int denormalize(VmafModel *model, double *prediction)
 }
 
 
-static int transform(VmafModel *model, double *prediction,
+static int transform(const VmafModel *model, double *prediction,
                      enum VmafModelFlags flags)
 {
     if (!model->score_transform.enabled)
@@ -86,7 +87,7 @@ static int transform(VmafModel *model, double *prediction,
     return 0;
 }
 
-static int clip(VmafModel *model, double *prediction,
+static int clip(const VmafModel *model, double *prediction,
                 enum VmafModelFlags flags)
 {
     if (!model->score_clip.enabled)
@@ -102,59 +103,156 @@ static int clip(VmafModel *model, double *prediction,
     return 0;
 }
 
-int vmaf_predict_score_at_index(VmafModel *model,
-                                VmafFeatureCollector *feature_collector,
-                                unsigned index, double *vmaf_score,
-                                bool write_prediction,
-                                enum VmafModelFlags flags)
+/* Fetch `n_features` raw feature scores for each of `n` frames, one row of
+ * `n_features` values per frame. Feature names are resolved once per batch,
+ * the scores themselves are read by id. */
+static int fetch_features(VmafFeatureCollector *feature_collector,
+                          const char **feature_name, unsigned n_features,
+                          const unsigned *index, unsigned n, double *raw)
 {
-    if (!model) return -EINVAL;
-    if (!feature_collector) return -EINVAL;
-    if (!vmaf_score) return -EINVAL;
+    unsigned id[n_features + 1];
+    for (unsigned k = 0; k < n_features; k++) {
+        int err = vmaf_feature_collector_lookup(feature_collector,
+                                                feature_name[k], &id[k]);
+        if (err) return err;
+    }
 
-    int err = 0;
+    for (unsigned j = 0; j < n; j++) {
+        double *row = &raw[j * n_features];
+        for (unsigned k = 0; k < n_features; k++) {
+            int err = vmaf_feature_collector_get_score_id(feature_collector,
+                                                          id[k], &row[k],
+                                                          index[j]);
+            if (err) return err;
+        }
+    }
 
-    struct svm_node *node = malloc(sizeof(*node) * (model->n_features + 1));
-    if (!node) return -ENOMEM;
+    return 0;
+}
 
-    for (unsigned i = 0; i < model->n_features; i++) {
-        double feature_score;
-        err = vmaf_feature_collector_get_score(feature_collector,
-                       vmaf_internal_feature_name_alias(model->feature[i].name),
-                       &feature_score, index);
-        if (err) goto free_node;
+/* Evaluate `model` for `n` frames of fetched features. Model feature `i` is
+ * read from column `column[i]` of `raw`, which has `n_columns` columns. The
+ * predictions are denormalized, but neither transformed nor clipped. */
+static int predict_raw(const VmafModel *model, const double *raw,
+                       unsigned n_columns, const unsigned *column, unsigned n,
+                       double *prediction)
+{
+    int err = 0;
+    const unsigned n_features = model->n_features;
+    double x[n * n_features + 1];
+
+    for (unsigned j = 0; j < n; j++) {
+        for (unsigned i = 0; i < n_features; i++) {
+            double feature_score = raw[j * n_columns + column[i]];
+            err = normalize(model, model->feature[i].slope,
+                            model->feature[i].intercept, &feature_score);
+            if (err) return err;
+            x[j * n_features + i] = feature_score;
+        }
+    }
 
-        err = normalize(model, model->feature[i].slope,
-                        model->feature[i].intercept, &feature_score);
-        if (err) goto free_node;
+    if (model->svr && model->svr->n_features == n_features) {
+        vmaf_svr_predict(model->svr, x, prediction, n);
+    } else {
+        struct svm_node node[n_features + 1];
+        for (unsigned j = 0; j < n; j++) {
+            for (unsigned i = 0; i < n_features; i++) {
+                node[i].index = i + 1;
+                node[i].value = x[j * n_features + i];
+            }
+            node[n_features].index = -1;
+            prediction[j] = svm_predict(model->svm, node);
+        }
+    }
 
-        node[i].index = i + 1;
-        node[i].value = feature_score;
+    for (unsigned j = 0; j < n; j++) {
+        err = denormalize(model, &prediction[j]);
+        if (err) return err;
     }
-    node[model->n_features].index = -1;
 
-    double prediction = svm_predict(model->svm, node);
+    return 0;
+}
 
-    err = denormalize(model, &prediction);
-    if (err) goto free_node;
+static int predict_batch(const VmafModel *model,
+                         VmafFeatureCollector *feature_collector,
+                         const unsigned *index, unsigned n, double *score,
+                         bool write_prediction, enum VmafModelFlags flags)
+{
+    int err = 0;
+    const unsigned n_features = model->n_features;
+    const char *feature_name[n_features + 1];
+    unsigned column[n_features + 1];
+    for (unsigned i = 0; i < n_features; i++) {
+        feature_name[i] =
+            vmaf_internal_feature_name_alias(model->feature[i].name);
+        column[i] = i;
+    }
 
-    err = transform(model, &prediction, flags);
-    if (err) goto free_node;
+    double raw[n * n_features + 1];
+    err = fetch_features(feature_collector, feature_name, n_features, index,
+                         n, raw);
+    if (err) return err;
 
-    err = clip(model, &prediction, flags);
-    if (err) goto free_node;
+    double prediction[n];
+    err = predict_raw(model, raw, n_features, column, n, prediction);
+    if (err) return err;
 
+    unsigned id = 0;
     if (write_prediction) {
-        err = vmaf_feature_collector_append(feature_collector, model->name,
-                                            prediction, index);
-        if (err) goto free_node;
+        err = vmaf_feature_collector_register(feature_collector, model->name,
+                                              &id);
+        if (err) return err;
+    }
+
+    for (unsigned j = 0; j < n; j++) {
+        err = transform(model, &prediction[j], flags);
+        if (err) return err;
+
+        err = clip(model, &prediction[j], flags);
+        if (err) return err;
+
+        if (write_prediction) {
+            err = vmaf_feature_collector_append_id(feature_collector, id,
+                                                   prediction[j], index[j]);
+            if (err) return err;
+        }
+
+        score[j] = prediction[j];
+    }
+
+    return 0;
+}
+
+int vmaf_predict_score_at_indices(const VmafModel *model,
+                                  VmafFeatureCollector *feature_collector,
+                                  const unsigned *index, unsigned n,
+                                  double *vmaf_score, bool write_prediction,
+                                  enum VmafModelFlags flags)
+{
+    if (!model) return -EINVAL;
+    if (!feature_collector) return -EINVAL;
+    if (!index) return -EINVAL;
+    if (!vmaf_score) return -EINVAL;
+
+    for (unsigned j = 0; j < n; j += VMAF_PREDICT_BATCH_SIZE) {
+        const unsigned cnt =
+            n - j < VMAF_PREDICT_BATCH_SIZE ? n - j : VMAF_PREDICT_BATCH_SIZE;
+        int err = predict_batch(model, feature_collector, &index[j], cnt,
+                                &vmaf_score[j], write_prediction, flags);
+        if (err) return err;
     }
 
-    *vmaf_score = prediction;
+    return 0;
+}
 
-free_node:
-    free(node);
-    return err;
+int vmaf_predict_score_at_index(const VmafModel *model,
+                                VmafFeatureCollector *feature_collector,
+                                unsigned index, double *vmaf_score,
+                                bool write_prediction,
+                                enum VmafModelFlags flags)
+{
+    return vmaf_predict_score_at_indices(model, feature_collector, &index, 1,
+                                         vmaf_score, write_prediction, flags);
 }
 
 
@@ -177,36 +275,11 @@ static double percentile(double *scores, unsigned n_scores, double perc)
         scores[idx_l] * (idx_r - p) + scores[idx_r] * (p - idx_l);
 }
 
-static int vmaf_bootstrap_predict_score_at_index(
-                                        VmafModelCollection *model_collection,
-                                        VmafFeatureCollector *feature_collector,
-                                        unsigned index,
-                                        VmafModelCollectionScore *score)
+/* `scores` are the unclipped, untransformed submodel predictions of a single
+ * frame, they are reordered. */
+static void bootstrap_score(const VmafModelCollection *model_collection,
+                            double *scores, VmafModelCollectionScore *score)
 {
-    int err = 0;
-    double scores[model_collection->cnt];
-
-    for (unsigned i = 0; i < model_collection->cnt; i++) {
-        // mean, stddev, etc. are calculated on untransformed/unclipped scores
-        // gather the unclipped scores, for the purposes of these calculations
-        // but do not write them to the feature collector
-        const unsigned flags =
-            VMAF_MODEL_FLAG_DISABLE_CLIP | VMAF_MODEL_FLAG_DISABLE_TRANSFORM;
-        err = vmaf_predict_score_at_index(model_collection->model[i],
-                                          feature_collector, index,
-                                          &scores[i], false,
-                                          flags);
-        if (err) return err;
-
-        // do not override the model's transform/clip behavior
-        // write the scores to the feature collector
-        double score;
-        err = vmaf_predict_score_at_index(model_collection->model[i],
-                                          feature_collector, index,
-                                          &score, true, 0);
-        if (err) return err;
-    }
-
     score->type = VMAF_MODEL_COLLECTION_SCORE_BOOTSTRAP;
 
     double sum = 0.;
@@ -242,49 +315,148 @@ static int vmaf_bootstrap_predict_score_at_index(
 
     const double slope = (score_plus_delta - score_minus_delta) / (2.0 * delta);
     score->bootstrap.stddev *= slope;
+}
 
-    //TODO: dedupe, vmaf_score_pooled_model_collection()
-    const char *suffix_lo = "_ci_p95_lo";
-    const char *suffix_hi = "_ci_p95_hi";
-    const char *suffix_bagging = "_bagging";
-    const char *suffix_stddev = "_stddev";
+/* Every distinct feature is fetched once per frame and every submodel is
+ * evaluated once per frame. The clipped submodel scores written to the
+ * feature collector and the unclipped ones the statistics are calculated on
+ * are both derived from that single evaluation. */
+static int bootstrap_predict_batch(const VmafModelCollection *model_collection,
+                                   VmafFeatureCollector *feature_collector,
+                                   const unsigned *index, unsigned n,
+                                   VmafModelCollectionScore *score)
+{
+    int err = 0;
+    const unsigned cnt = model_collection->cnt;
+
+    unsigned n_model_features = 0;
+    for (unsigned m = 0; m < cnt; m++)
+        n_model_features += model_collection->model[m]->n_features;
+
+    // submodels normally share their features, map them to distinct columns
+    const char *feature_name[n_model_features + 1];
+    unsigned column[n_model_features + 1];
+    unsigned n_columns = 0;
+    for (unsigned m = 0, c = 0; m < cnt; m++) {
+        const VmafModel *model = model_collection->model[m];
+        for (unsigned i = 0; i < model->n_features; i++, c++) {
+            const char *name =
+                vmaf_internal_feature_name_alias(model->feature[i].name);
+            unsigned k = 0;
+            while (k < n_columns && strcmp(feature_name[k], name))
+                k++;
+            if (k == n_columns)
+                feature_name[n_columns++] = name;
+            column[c] = k;
+        }
+    }
+
+    double raw[n * n_columns + 1];
+    err = fetch_features(feature_collector, feature_name, n_columns, index, n,
+                         raw);
+    if (err) return err;
+
+    double prediction[cnt * n];
+    for (unsigned m = 0, c = 0; m < cnt; m++) {
+        const VmafModel *model = model_collection->model[m];
+        err = predict_raw(model, raw, n_columns, &column[c], n,
+                          &prediction[m * n]);
+        if (err) return err;
+        c += model->n_features;
+    }
+
+    const char *suffix[] = { "_bagging", "_stddev", "_ci_p95_lo", "_ci_p95_hi" };
     const size_t name_sz =
-        strlen(model_collection->name) + strlen(suffix_lo) + 1;
-    const char name[name_sz];
-    memset(name, 0, name_sz);
-
-    snprintf(name, name_sz, "%s%s", model_collection->name, suffix_bagging);
-    err = vmaf_feature_collector_append(feature_collector, name,
-                                        score->bootstrap.bagging_score, index);
-
-    snprintf(name, name_sz, "%s%s", model_collection->name, suffix_stddev);
-    err = vmaf_feature_collector_append(feature_collector, name,
-                                        score->bootstrap.stddev, index);
-
-    snprintf(name, name_sz, "%s%s", model_collection->name, suffix_lo);
-    err |= vmaf_feature_collector_append(feature_collector, name,
-                                         score->bootstrap.ci.p95.lo, index);
-
-    snprintf(name, name_sz, "%s%s", model_collection->name, suffix_hi);
-    err |= vmaf_feature_collector_append(feature_collector, name,
-                                         score->bootstrap.ci.p95.hi,
-                                         index);
-    return err;
+        strlen(model_collection->name) + strlen(suffix[2]) + 1;
+    char name[name_sz];
+
+    unsigned model_id[cnt], suffix_id[4];
+    for (unsigned m = 0; m < cnt; m++) {
+        err = vmaf_feature_collector_register(feature_collector,
+                                              model_collection->model[m]->name,
+                                              &model_id[m]);
+        if (err) return err;
+    }
+    for (unsigned i = 0; i < 4; i++) {
+        snprintf(name, name_sz, "%s%s", model_collection->name, suffix[i]);
+        err = vmaf_feature_collector_register(feature_collector, name,
+                                              &suffix_id[i]);
+        if (err) return err;
+    }
+
+    for (unsigned j = 0; j < n; j++) {
+        double scores[cnt];
+        for (unsigned m = 0; m < cnt; m++) {
+            // mean, stddev, etc. are calculated on untransformed/unclipped
+            // scores, the model's own transform/clip behavior is only
+            // applied to the score written to the feature collector
+            const VmafModel *model = model_collection->model[m];
+            double s = scores[m] = prediction[m * n + j];
+            err = transform(model, &s, 0);
+            if (err) return err;
+            err = clip(model, &s, 0);
+            if (err) return err;
+            err = vmaf_feature_collector_append_id(feature_collector,
+                                                   model_id[m], s, index[j]);
+            if (err) return err;
+        }
+
+        bootstrap_score(model_collection, scores, &score[j]);
+
+        const double value[] = {
+            score[j].bootstrap.bagging_score,
+            score[j].bootstrap.stddev,
+            score[j].bootstrap.ci.p95.lo,
+            score[j].bootstrap.ci.p95.hi,
+        };
+        for (unsigned i = 0; i < 4; i++) {
+            err |= vmaf_feature_collector_append_id(feature_collector,
+                                                    suffix_id[i], value[i],
+                                                    index[j]);
+        }
+        if (err) return err;
+    }
+
+    return 0;
 }
 
-int vmaf_predict_score_at_index_model_collection(
-                                VmafModelCollection *model_collection,
+int vmaf_predict_score_at_indices_model_collection(
+                                const VmafModelCollection *model_collection,
                                 VmafFeatureCollector *feature_collector,
-                                unsigned index,
+                                const unsigned *index, unsigned n,
                                 VmafModelCollectionScore *score)
 {
+    if (!model_collection) return -EINVAL;
+    if (!feature_collector) return -EINVAL;
+    if (!index) return -EINVAL;
+    if (!score) return -EINVAL;
+
     switch (model_collection->type) {
     case VMAF_MODEL_BOOTSTRAP_SVM_NUSVR:
     case VMAF_MODEL_RESIDUE_BOOTSTRAP_SVM_NUSVR:
-        return vmaf_bootstrap_predict_score_at_index(model_collection,
-                                                     feature_collector,
-                                                     index, score);
+        break;
     default:
         return -EINVAL;
     }
+
+    for (unsigned j = 0; j < n; j += VMAF_PREDICT_BATCH_SIZE) {
+        const unsigned cnt =
+            n - j < VMAF_PREDICT_BATCH_SIZE ? n - j : VMAF_PREDICT_BATCH_SIZE;
+        int err = bootstrap_predict_batch(model_collection, feature_collector,
+                                          &index[j], cnt, &score[j]);
+        if (err) return err;
+    }
+
+    return 0;
+}
+
+int vmaf_predict_score_at_index_model_collection(
+                                const VmafModelCollection *model_collection,
+                                VmafFeatureCollector *feature_collector,
+                                unsigned index,
+                                VmafModelCollectionScore *score)
+{
+    return vmaf_predict_score_at_indices_model_collection(model_collection,
+                                                          feature_collector,
+                                                          &index, 1, score);
 }
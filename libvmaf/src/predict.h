@@ -22,16 +22,39 @@
 #include "feature/feature_collector.h"
 #include "model.h"
 
-int vmaf_predict_score_at_index(VmafModel *model,
+/* Frames are gathered and predicted in batches of up to this many. */
+#define VMAF_PREDICT_BATCH_SIZE 64
+
+int vmaf_predict_score_at_index(const VmafModel *model,
                                 VmafFeatureCollector *feature_collector,
                                 unsigned index, double *vmaf_score,
                                 bool write_prediction,
                                 enum VmafModelFlags flags);
 
+/**
+ * Predict, and optionally write, the scores of `n` frames at once. This is
+ * much cheaper per frame than repeated `vmaf_predict_score_at_index()`.
+ */
+int vmaf_predict_score_at_indices(const VmafModel *model,
+                                  VmafFeatureCollector *feature_collector,
+                                  const unsigned *index, unsigned n,
+                                  double *vmaf_score, bool write_prediction,
+                                  enum VmafModelFlags flags);
+
 int vmaf_predict_score_at_index_model_collection(
-                                VmafModelCollection *model_collection,
+                                const VmafModelCollection *model_collection,
                                 VmafFeatureCollector *feature_collector,
                                 unsigned index,
                                 VmafModelCollectionScore *score);
 
+/**
+ * Predict and write the collection scores of `n` frames at once, `score`
+ * holds `n` entries.
+ */
+int vmaf_predict_score_at_indices_model_collection(
+                                const VmafModelCollection *model_collection,
+                                VmafFeatureCollector *feature_collector,
+                                const unsigned *index, unsigned n,
+                                VmafModelCollectionScore *score);
+
 #endif /* __VMAF_PREDICT_H__ */
@@ -20,6 +20,7 @@
 #include "model.h"
 #include "pdjson.h"
 #include "svm.h"
+#include "svr.h"
 
 #include <errno.h>
 #include <stdlib.h>
@@ -201,7 +202,8 @@ static int parse_libsvm_model(json_stream *s, VmafModel *model)
     model->svm = svm_parse_model_from_buffer(libsvm_model, sz);
     if (!model->svm) return -ENOMEM;
 
-    return 0;
+    int err = vmaf_svr_init(&model->svr, model->svm);
+    return (err == -ENOTSUP) ? 0 : err;
 }
 
 static int parse_model_dict(json_stream *s, VmafModel *model,
@@ -28,6 +28,7 @@ int vmaf_ref_init(VmafRef **ref)
     if (!r) return -ENOMEM;
     memset(r, 0, sizeof(*r));
     atomic_init(&r->cnt, 1);
+    pthread_mutex_init(&(r->lock), NULL);
     return 0;
 }
 
@@ -36,9 +37,9 @@ void vmaf_ref_fetch_increment(VmafRef *ref)
     atomic_fetch_add(&ref->cnt, 1);
 }
 
-void vmaf_ref_fetch_decrement(VmafRef *ref)
+long vmaf_ref_fetch_decrement(VmafRef *ref)
 {
-    atomic_fetch_sub(&ref->cnt, 1);
+    return atomic_fetch_sub(&ref->cnt, 1);
 }
 
 long vmaf_ref_load(VmafRef *ref)
@@ -48,6 +49,7 @@ long vmaf_ref_load(VmafRef *ref)
 
 int vmaf_ref_close(VmafRef *ref)
 {
+    pthread_mutex_destroy(&(ref->lock));
     free(ref);
     return 0;
 }
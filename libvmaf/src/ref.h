@@ -19,15 +19,29 @@
 #ifndef __VMAF_SRC_REF_H__
 #define __VMAF_SRC_REF_H__
 
+#include <pthread.h>
 #include <stdatomic.h>
 
 typedef struct VmafRef {
     atomic_int cnt;
+    /**
+     * Optional, called instead of the owner's default cleanup once the last
+     * reference is dropped. Takes ownership of the data and of the ref.
+     */
+    void (*release)(void *user_data);
+    void *user_data;
+    /**
+     * Pictures only, data derived from the planes and shared by every holder
+     * of the reference. Created on demand under `lock`, recycled along with
+     * the picture and dropped once the reference is closed.
+     */
+    struct VmafPictureCache *cache;
+    pthread_mutex_t lock;
 } VmafRef;
 
 int vmaf_ref_init(VmafRef **ref);
 void vmaf_ref_fetch_increment(VmafRef *ref);
-void vmaf_ref_fetch_decrement(VmafRef *ref);
+long vmaf_ref_fetch_decrement(VmafRef *ref);
 long vmaf_ref_load(VmafRef *ref);
 int vmaf_ref_close(VmafRef *ref);
 
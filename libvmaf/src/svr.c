@@ -0,0 +1,163 @@
+/**
+ *
+ *  Copyright 2016-2020 Netflix, Inc.
+ *
+ *     Licensed under the BSD+Patent License (the "License");
+ *     you may not use this file except in compliance with the License.
+ *     You may obtain a copy of the License at
+ *
+ *         https://opensource.org/licenses/BSDplusPatent
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#include "cpu.h"
+#include "mem.h"
+#include "svr.h"
+
+#if ARCH_X86
+#include "x86/svr_avx2.h"
+#if HAVE_AVX512
+#include "x86/svr_avx512.h"
+#endif
+#endif
+
+int vmaf_svr_init(VmafSvr **svr, const struct svm_model *svm)
+{
+    if (!svr) return -EINVAL;
+    if (!svm) return -EINVAL;
+
+    if (svm->param.svm_type != NU_SVR && svm->param.svm_type != EPSILON_SVR)
+        return -ENOTSUP;
+    if (svm->param.kernel_type != RBF)
+        return -ENOTSUP;
+
+    unsigned n_features = 0;
+    for (int i = 0; i < svm->l; i++) {
+        for (const struct svm_node *node = svm->SV[i]; node->index != -1; node++) {
+            if (node->index < 1) return -ENOTSUP;
+            if ((unsigned) node->index > n_features)
+                n_features = node->index;
+        }
+    }
+
+    VmafSvr *const s = malloc(sizeof(*s));
+    if (!s) goto fail;
+    memset(s, 0, sizeof(*s));
+    s->n_features = n_features;
+    s->n_sv = svm->l;
+    s->n_sv_padded = (s->n_sv + VMAF_SVR_SV_ALIGN - 1) / VMAF_SVR_SV_ALIGN *
+                     VMAF_SVR_SV_ALIGN;
+    s->gamma = svm->param.gamma;
+    s->rho = svm->rho[0];
+
+    const size_t sv_sz = sizeof(*s->sv) * (n_features * s->n_sv_padded + 1);
+    s->sv = aligned_malloc(sv_sz, 64);
+    if (!s->sv) goto free_s;
+    memset(s->sv, 0, sv_sz);
+    const size_t coef_sz = sizeof(*s->coef) * (s->n_sv_padded + 1);
+    s->coef = aligned_malloc(coef_sz, 64);
+    if (!s->coef) goto free_sv;
+    memset(s->coef, 0, coef_sz);
+
+    for (unsigned i = 0; i < s->n_sv; i++) {
+        s->coef[i] = svm->sv_coef[0][i];
+        for (const struct svm_node *node = svm->SV[i]; node->index != -1; node++)
+            s->sv[(node->index - 1) * s->n_sv_padded + i] = node->value;
+    }
+
+    *svr = s;
+    return 0;
+
+free_sv:
+    aligned_free(s->sv);
+free_s:
+    free(s);
+fail:
+    return -ENOMEM;
+}
+
+int vmaf_svr_wrap(VmafSvr **svr, unsigned n_features, unsigned n_sv,
+                  double gamma, double rho, const double *sv,
+                  const double *coef)
+{
+    if (!svr) return -EINVAL;
+    if (!sv) return -EINVAL;
+    if (!coef) return -EINVAL;
+    if (((uintptr_t) sv | (uintptr_t) coef) % 64) return -EINVAL;
+
+    VmafSvr *const s = *svr = malloc(sizeof(*s));
+    if (!s) return -ENOMEM;
+    memset(s, 0, sizeof(*s));
+    s->n_features = n_features;
+    s->n_sv = n_sv;
+    s->n_sv_padded = (n_sv + VMAF_SVR_SV_ALIGN - 1) / VMAF_SVR_SV_ALIGN *
+                     VMAF_SVR_SV_ALIGN;
+    s->gamma = gamma;
+    s->rho = rho;
+    s->sv = (double *) sv;
+    s->coef = (double *) coef;
+    s->wrapped = true;
+    return 0;
+}
+
+/* Same operation order as libsvm's RBF `k_function()` and
+ * `svm_predict_values()`, so the results are identical. */
+static void svr_predict_c(const VmafSvr *svr, const double *x, double *y,
+                          unsigned n)
+{
+    for (unsigned j = 0; j < n; j++) {
+        const double *xj = &x[j * svr->n_features];
+        double sum = 0.;
+        for (unsigned i = 0; i < svr->n_sv; i++) {
+            double d2 = 0.;
+            for (unsigned f = 0; f < svr->n_features; f++) {
+                const double d = xj[f] - svr->sv[f * svr->n_sv_padded + i];
+                d2 += d * d;
+            }
+            sum += svr->coef[i] * exp(-svr->gamma * d2);
+        }
+        y[j] = sum - svr->rho;
+    }
+}
+
+void vmaf_svr_predict(const VmafSvr *svr, const double *x, double *y,
+                      unsigned n)
+{
+#if ARCH_X86
+    const unsigned flags = vmaf_get_cpu_flags();
+#if HAVE_AVX512
+    if (flags & VMAF_X86_CPU_FLAG_AVX512) {
+        svr_predict_avx512(svr, x, y, n);
+        return;
+    }
+#endif
+    if (flags & VMAF_X86_CPU_FLAG_AVX2) {
+        svr_predict_avx2(svr, x, y, n);
+        return;
+    }
+#endif
+    svr_predict_c(svr, x, y, n);
+}
+
+void vmaf_svr_destroy(VmafSvr *svr)
+{
+    if (!svr) return;
+    if (!svr->wrapped) {
+        aligned_free(svr->sv);
+        aligned_free(svr->coef);
+    }
+    free(svr);
+}
@@ -0,0 +1,70 @@
+/**
+ *
+ *  Copyright 2016-2020 Netflix, Inc.
+ *
+ *     Licensed under the BSD+Patent License (the "License");
+ *     you may not use this file except in compliance with the License.
+ *     You may obtain a copy of the License at
+ *
+ *         https://opensource.org/licenses/BSDplusPatent
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *
+ */
+
+#ifndef __VMAF_SRC_SVR_H__
+#define __VMAF_SRC_SVR_H__
+
+#include <stdbool.h>
+
+#include "svm.h"
+
+/* Support vectors are padded to a multiple of this, padding has a zero
+ * coefficient. */
+#define VMAF_SVR_SV_ALIGN 8
+
+/**
+ * Dense NuSVR/epsilon-SVR inference for the RBF kernel.
+ *
+ * The support vectors of a libsvm model are converted once into a
+ * feature-major structure-of-arrays matrix, so that the kernel can be
+ * evaluated for several support vectors and several frames at a time.
+ */
+typedef struct VmafSvr {
+    unsigned n_features;
+    unsigned n_sv, n_sv_padded;
+    double gamma, rho;
+    double *sv; ///< `n_features` rows of `n_sv_padded` values
+    double *coef; ///< `n_sv_padded` values
+    bool wrapped; ///< `sv` and `coef` are not owned, see `vmaf_svr_wrap()`
+} VmafSvr;
+
+/**
+ * Returns -ENOTSUP if `svm` is not a regression model with an RBF kernel,
+ * such models have to be evaluated with `svm_predict()`.
+ */
+int vmaf_svr_init(VmafSvr **svr, const struct svm_model *svm);
+
+/**
+ * Use support vectors which are already laid out as by `vmaf_svr_init()`,
+ * e.g. in a memory-mapped binary model. Nothing is copied, `sv` and `coef`
+ * have to be 64-byte aligned, zero padded, and outlive `svr`.
+ */
+int vmaf_svr_wrap(VmafSvr **svr, unsigned n_features, unsigned n_sv,
+                  double gamma, double rho, const double *sv,
+                  const double *coef);
+
+/**
+ * Predict `n` frames. `x` holds `n` rows of `n_features` values, one row
+ * per frame. Equivalent to `svm_predict()`, up to floating point rounding.
+ */
+void vmaf_svr_predict(const VmafSvr *svr, const double *x, double *y,
+                      unsigned n);
+
+void vmaf_svr_destroy(VmafSvr *svr);
+
+#endif /* __VMAF_SRC_SVR_H__ */
@@ -0,0 +1,249 @@
+/**
+ *
+ *  Copyright 2016-2020 Netflix, Inc.
+ *
+ *     Licensed under the BSD+Patent License (the "License");
+ *     you may not use this file except in compliance with the License.
+ *     You may obtain a copy of the License at
+ *
+ *         https://opensource.org/licenses/BSDplusPatent
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "temporal_lane.h"
+
+typedef struct LaneFrame {
+    VmafPicture ref, dist;
+    unsigned index;
+    void *cookie;
+} LaneFrame;
+
+struct VmafTemporalLane {
+    VmafFeatureExtractorContext *fex_ctx;
+    VmafFeatureCollector *feature_collector;
+    VmafThreadPool *thread_pool;
+    void (*retire)(void *cookie);
+    void (*complete)(void *cookie);
+    pthread_mutex_t lock;
+    pthread_cond_t space, idle;
+    LaneFrame *frame; ///< reorder buffer, sorted by index
+    unsigned cnt, capacity;
+    unsigned next_index;
+    bool running, draining;
+    int err;
+    bool lagging; ///< `lagging_cookie` awaits the next frame or a flush
+    void *lagging_cookie;
+};
+
+int vmaf_temporal_lane_create(VmafTemporalLane **lane,
+                              VmafFeatureExtractorContext *fex_ctx,
+                              VmafFeatureCollector *feature_collector,
+                              VmafThreadPool *thread_pool, unsigned capacity,
+                              void (*retire)(void *cookie),
+                              void (*complete)(void *cookie))
+{
+    if (!lane) return -EINVAL;
+    if (!fex_ctx) return -EINVAL;
+    if (!feature_collector) return -EINVAL;
+    if (!thread_pool) return -EINVAL;
+    if (!capacity) return -EINVAL;
+
+    VmafTemporalLane *const l = *lane = malloc(sizeof(*l));
+    if (!l) goto fail;
+    memset(l, 0, sizeof(*l));
+    l->frame = malloc(sizeof(*(l->frame)) * capacity);
+    if (!l->frame) goto free_l;
+
+    l->fex_ctx = fex_ctx;
+    l->feature_collector = feature_collector;
+    l->thread_pool = thread_pool;
+    l->capacity = capacity;
+    l->retire = retire;
+    l->complete = complete;
+    pthread_mutex_init(&(l->lock), NULL);
+    pthread_cond_init(&(l->space), NULL);
+    pthread_cond_init(&(l->idle), NULL);
+    return 0;
+
+free_l:
+    free(l);
+fail:
+    return -ENOMEM;
+}
+
+/* Only ever called by the running job, or while the lane is idle. */
+static void temporal_lane_complete_lagging(VmafTemporalLane *lane)
+{
+    if (!lane->lagging) return;
+    lane->lagging = false;
+    if (lane->complete) lane->complete(lane->lagging_cookie);
+}
+
+static bool temporal_lane_ready(VmafTemporalLane *lane)
+{
+    if (!lane->cnt) return false;
+    return lane->frame[0].index <= lane->next_index ||
+           lane->cnt == lane->capacity || lane->draining;
+}
+
+static void temporal_lane_run(void *data)
+{
+    VmafTemporalLane *lane = *((VmafTemporalLane **) data);
+
+    pthread_mutex_lock(&(lane->lock));
+    while (temporal_lane_ready(lane)) {
+        LaneFrame f = lane->frame[0];
+        memmove(&lane->frame[0], &lane->frame[1],
+                sizeof(*(lane->frame)) * --lane->cnt);
+        lane->next_index = f.index + 1;
+        pthread_cond_signal(&(lane->space));
+        pthread_mutex_unlock(&(lane->lock));
+
+        int err =
+            vmaf_feature_extractor_context_extract(lane->fex_ctx, &f.ref, NULL,
+                                                   &f.dist, NULL, f.index,
+                                                   lane->feature_collector);
+        vmaf_picture_unref(&f.ref);
+        vmaf_picture_unref(&f.dist);
+        if (lane->retire) lane->retire(f.cookie);
+        temporal_lane_complete_lagging(lane);
+        lane->lagging = true;
+        lane->lagging_cookie = f.cookie;
+
+        pthread_mutex_lock(&(lane->lock));
+        if (err && !lane->err) lane->err = err;
+    }
+    lane->running = false;
+    pthread_cond_broadcast(&(lane->idle));
+    pthread_mutex_unlock(&(lane->lock));
+}
+
+/* Called with the lane locked. The job is enqueued unlocked since a thread
+ * pool may decide to run it inline. */
+static int temporal_lane_start(VmafTemporalLane *lane)
+{
+    if (lane->running || !temporal_lane_ready(lane)) return 0;
+
+    lane->running = true;
+    pthread_mutex_unlock(&(lane->lock));
+    int err = vmaf_thread_pool_enqueue(lane->thread_pool, temporal_lane_run,
+                                       &lane, sizeof(lane));
+    pthread_mutex_lock(&(lane->lock));
+    if (err) lane->running = false;
+    return err;
+}
+
+int vmaf_temporal_lane_submit(VmafTemporalLane *lane, VmafPicture *ref,
+                              VmafPicture *dist, unsigned index, void *cookie)
+{
+    if (!lane) return -EINVAL;
+    if (!ref) return -EINVAL;
+    if (!dist) return -EINVAL;
+
+    int err = 0;
+    pthread_mutex_lock(&(lane->lock));
+
+    while (lane->cnt == lane->capacity) {
+        if (!lane->running) {
+            err = temporal_lane_start(lane);
+            if (err) goto unlock;
+            continue;
+        }
+        pthread_cond_wait(&(lane->space), &(lane->lock));
+    }
+
+    unsigned i = lane->cnt;
+    while (i && lane->frame[i - 1].index > index) {
+        lane->frame[i] = lane->frame[i - 1];
+        i--;
+    }
+    lane->frame[i] = (LaneFrame) {
+        .ref = *ref,
+        .dist = *dist,
+        .index = index,
+        .cookie = cookie,
+    };
+    lane->cnt++;
+
+    err = temporal_lane_start(lane);
+
+unlock:
+    pthread_mutex_unlock(&(lane->lock));
+    return err;
+}
+
+int vmaf_temporal_lane_flush(VmafTemporalLane *lane)
+{
+    if (!lane) return -EINVAL;
+
+    int err = 0;
+    pthread_mutex_lock(&(lane->lock));
+
+    lane->draining = true;
+    while (lane->running || lane->cnt) {
+        if (!lane->running) {
+            err = temporal_lane_start(lane);
+            if (err) break;
+            continue;
+        }
+        pthread_cond_wait(&(lane->idle), &(lane->lock));
+    }
+    lane->draining = false;
+    if (!err) err = lane->err;
+
+    pthread_mutex_unlock(&(lane->lock));
+
+    if (!err && lane->fex_ctx->is_initialized) {
+        err = vmaf_feature_extractor_context_flush(lane->fex_ctx,
+                                                   lane->feature_collector);
+    }
+    temporal_lane_complete_lagging(lane);
+    return err;
+}
+
+int vmaf_temporal_lane_reset(VmafTemporalLane *lane)
+{
+    if (!lane) return -EINVAL;
+
+    pthread_mutex_lock(&(lane->lock));
+    int err = lane->running || lane->cnt ? -EBUSY : 0;
+    if (!err) {
+        lane->next_index = 0;
+        lane->err = 0;
+    }
+    pthread_mutex_unlock(&(lane->lock));
+
+    if (err) return err;
+    return vmaf_feature_extractor_context_reset(lane->fex_ctx);
+}
+
+int vmaf_temporal_lane_destroy(VmafTemporalLane *lane)
+{
+    if (!lane) return -EINVAL;
+
+    for (unsigned i = 0; i < lane->cnt; i++) {
+        vmaf_picture_unref(&lane->frame[i].ref);
+        vmaf_picture_unref(&lane->frame[i].dist);
+        if (lane->retire) lane->retire(lane->frame[i].cookie);
+        if (lane->complete) lane->complete(lane->frame[i].cookie);
+    }
+    temporal_lane_complete_lagging(lane);
+    pthread_mutex_destroy(&(lane->lock));
+    pthread_cond_destroy(&(lane->space));
+    pthread_cond_destroy(&(lane->idle));
+    free(lane->frame);
+    free(lane);
+    return 0;
+}
@@ -0,0 +1,84 @@
+/**
+ *
+ *  Copyright 2016-2020 Netflix, Inc.
+ *
+ *     Licensed under the BSD+Patent License (the "License");
+ *     you may not use this file except in compliance with the License.
+ *     You may obtain a copy of the License at
+ *
+ *         https://opensource.org/licenses/BSDplusPatent
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *
+ */
+
+#ifndef __VMAF_SRC_TEMPORAL_LANE_H__
+#define __VMAF_SRC_TEMPORAL_LANE_H__
+
+#include "feature/feature_collector.h"
+#include "feature/feature_extractor.h"
+#include "libvmaf/picture.h"
+#include "thread_pool.h"
+
+/**
+ * An ordered execution lane for a single VMAF_FEATURE_EXTRACTOR_TEMPORAL
+ * feature extractor context. Frames are submitted by the reader, kept in a
+ * small reorder buffer sorted by picture index, and extracted strictly in
+ * index order by at most one thread pool job at a time. Spatial feature
+ * extractors keep running in parallel alongside the lane.
+ *
+ * A frame which is not the next expected index is held back until the gap
+ * is filled, the reorder buffer is full, or the lane is flushed.
+ *
+ * Temporal feature extractors may write scores for a picture when they see
+ * the next one. A frame is therefore only reported as complete once the
+ * following frame has been extracted, or the lane has been flushed.
+ */
+typedef struct VmafTemporalLane VmafTemporalLane;
+
+/**
+ * @param capacity Reorder buffer depth, `vmaf_temporal_lane_submit()` blocks
+ *                 while it is full.
+ * @param retire   Optional, called with a frame's `cookie` once the frame
+ *                 has been extracted or dropped.
+ * @param complete Optional, called with a frame's `cookie` once all of its
+ *                 scores have been written, or it has been dropped. Always
+ *                 after `retire`.
+ */
+int vmaf_temporal_lane_create(VmafTemporalLane **lane,
+                              VmafFeatureExtractorContext *fex_ctx,
+                              VmafFeatureCollector *feature_collector,
+                              VmafThreadPool *thread_pool, unsigned capacity,
+                              void (*retire)(void *cookie),
+                              void (*complete)(void *cookie));
+
+/**
+ * Queue a frame for extraction. The lane takes ownership of `ref` and
+ * `dist`.
+ */
+int vmaf_temporal_lane_submit(VmafTemporalLane *lane, VmafPicture *ref,
+                              VmafPicture *dist, unsigned index, void *cookie);
+
+/**
+ * Extract all queued frames, regardless of gaps in their indices, then
+ * flush the feature extractor context. Returns the first extraction error.
+ */
+int vmaf_temporal_lane_flush(VmafTemporalLane *lane);
+
+/**
+ * Start over at picture index 0 with a reset feature extractor context. The
+ * lane must have been flushed, its reorder buffer is kept.
+ */
+int vmaf_temporal_lane_reset(VmafTemporalLane *lane);
+
+/**
+ * Drop all queued frames and free the lane. The lane must be idle, the
+ * feature extractor context is not closed.
+ */
+int vmaf_temporal_lane_destroy(VmafTemporalLane *lane);
+
+#endif /* __VMAF_SRC_TEMPORAL_LANE_H__ */
@@ -18,17 +18,68 @@
 
 #include <errno.h>
 #include <pthread.h>
+#include <stdatomic.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "thread_pool.h"
+
+#define JOB_DEQUE_CAPACITY 64
+#define CACHE_LINE_SIZE 64
+
 typedef struct VmafThreadPoolJob {
     void (*func)(void *data);
     void *data;
     struct VmafThreadPoolJob *next;
 } VmafThreadPoolJob;
 
-typedef struct VmafTreadPool {
+/*
+ * Job storage of the work-stealing scheduler. A slot is written in place by
+ * the deque owner and copied out by whichever thread wins it, so enqueueing a
+ * job never allocates. `busy` is cleared once the winner has copied the job
+ * out, only then may the owner reuse the slot.
+ */
+typedef struct VmafJobSlot {
+    atomic_int busy;
+    void (*func)(void *data);
+} VmafJobSlot;
+
+typedef union {
+    void *ptr;
+    double dbl;
+    long long ll;
+} VmafJobDataAlign;
+
+#define JOB_SLOT_DATA_OFFSET \
+    ((sizeof(VmafJobSlot) + sizeof(VmafJobDataAlign) - 1) / \
+     sizeof(VmafJobDataAlign) * sizeof(VmafJobDataAlign))
+
+/*
+ * Chase-Lev deque. Only the owner pushes and pops at the bottom, any thread
+ * may steal from the top. `top` and `bottom` live on separate cache lines.
+ */
+typedef struct VmafJobDeque {
+    atomic_uint top;
+    uint8_t pad_top[CACHE_LINE_SIZE];
+    atomic_uint bottom;
+    uint8_t pad_bottom[CACHE_LINE_SIZE];
+    uint8_t *slots;
+    size_t slot_sz;
+    unsigned mask;
+} VmafJobDeque;
+
+typedef struct VmafThreadPoolWorker {
+    struct VmafThreadPool *pool;
+    pthread_t thread;
+    unsigned id;
+    VmafJobDeque deque; ///< jobs enqueued by this worker, e.g. nested jobs
+    VmafJobDeque inbox; ///< jobs enqueued by threads outside of the pool
+} VmafThreadPoolWorker;
+
+struct VmafThreadPool {
+    enum VmafThreadPoolType type;
     struct {
         pthread_mutex_t lock;
         pthread_cond_t empty;
@@ -38,7 +89,18 @@ typedef struct VmafTreadPool {
     unsigned n_threads;
     unsigned n_working;
     bool stop;
-} VmafThreadPool;
+    struct {
+        VmafThreadPoolWorker *worker;
+        size_t max_data_sz;
+        pthread_key_t self;
+        pthread_key_t in_job; ///< set while a thread runs a job of this pool
+        pthread_mutex_t submit_lock;
+        unsigned next_inbox;
+        atomic_int pending, outstanding, n_sleeping, stop;
+        pthread_mutex_t lock;
+        pthread_cond_t wake, done;
+    } ws;
+};
 
 static VmafThreadPoolJob *vmaf_thread_pool_fetch_job(VmafThreadPool *pool)
 {
@@ -92,6 +154,323 @@ static void *vmaf_thread_pool_runner(void *p)
     return NULL;
 }
 
+static int job_deque_init(VmafJobDeque *q, unsigned capacity,
+                          size_t max_data_sz)
+{
+    memset(q, 0, sizeof(*q));
+    atomic_init(&q->top, 0);
+    atomic_init(&q->bottom, 0);
+    q->mask = capacity - 1;
+    q->slot_sz = JOB_SLOT_DATA_OFFSET + max_data_sz;
+    q->slot_sz = (q->slot_sz + CACHE_LINE_SIZE - 1) & ~(CACHE_LINE_SIZE - 1);
+    q->slots = malloc(q->slot_sz * capacity);
+    if (!q->slots) return -ENOMEM;
+    memset(q->slots, 0, q->slot_sz * capacity);
+    for (unsigned i = 0; i < capacity; i++) {
+        VmafJobSlot *slot = (VmafJobSlot *)(q->slots + i * q->slot_sz);
+        atomic_init(&slot->busy, 0);
+    }
+    return 0;
+}
+
+static void job_deque_destroy(VmafJobDeque *q)
+{
+    free(q->slots);
+    q->slots = NULL;
+}
+
+static VmafJobSlot *job_deque_slot(VmafJobDeque *q, unsigned idx)
+{
+    return (VmafJobSlot *)(q->slots + (idx & q->mask) * q->slot_sz);
+}
+
+static int job_deque_push(VmafJobDeque *q, void (*func)(void *data),
+                          void *data, size_t data_sz)
+{
+    const unsigned b = atomic_load(&q->bottom);
+    const unsigned t = atomic_load(&q->top);
+    if (b - t > q->mask) return -EAGAIN;
+
+    VmafJobSlot *slot = job_deque_slot(q, b);
+    if (atomic_load(&slot->busy)) return -EAGAIN;
+    atomic_store(&slot->busy, 1);
+    slot->func = func;
+    if (data) memcpy((uint8_t *)slot + JOB_SLOT_DATA_OFFSET, data, data_sz);
+    atomic_store(&q->bottom, b + 1);
+    return 0;
+}
+
+static void job_deque_take(VmafJobSlot *slot, void (**func)(void *data),
+                           void *data, size_t data_sz)
+{
+    *func = slot->func;
+    memcpy(data, (uint8_t *)slot + JOB_SLOT_DATA_OFFSET, data_sz);
+    atomic_store(&slot->busy, 0);
+}
+
+static int job_deque_pop(VmafJobDeque *q, void (**func)(void *data),
+                         void *data, size_t data_sz)
+{
+    const unsigned b = atomic_load(&q->bottom) - 1;
+    atomic_store(&q->bottom, b);
+    unsigned t = atomic_load(&q->top);
+
+    if ((int)(b - t) < 0) {
+        atomic_store(&q->bottom, b + 1);
+        return -EAGAIN;
+    }
+
+    if (b == t) {
+        // last job, race against thieves
+        const bool won = atomic_compare_exchange_strong(&q->top, &t, t + 1);
+        atomic_store(&q->bottom, b + 1);
+        if (!won) return -EAGAIN;
+    }
+
+    job_deque_take(job_deque_slot(q, b), func, data, data_sz);
+    return 0;
+}
+
+static int job_deque_steal(VmafJobDeque *q, void (**func)(void *data),
+                           void *data, size_t data_sz)
+{
+    unsigned t = atomic_load(&q->top);
+    const unsigned b = atomic_load(&q->bottom);
+    if ((int)(b - t) <= 0) return -EAGAIN;
+    if (!atomic_compare_exchange_strong(&q->top, &t, t + 1)) return -EAGAIN;
+
+    job_deque_take(job_deque_slot(q, t), func, data, data_sz);
+    return 0;
+}
+
+static int ws_take_job(VmafThreadPool *pool, VmafThreadPoolWorker *self,
+                       void (**func)(void *data), void *data)
+{
+    const size_t sz = pool->ws.max_data_sz;
+    const unsigned n = pool->n_threads;
+    const unsigned start = self ? self->id : 0;
+
+    if (self) {
+        if (!job_deque_pop(&self->deque, func, data, sz)) goto found;
+        if (!job_deque_steal(&self->inbox, func, data, sz)) goto found;
+    }
+
+    for (unsigned i = 0; i < n; i++) {
+        VmafThreadPoolWorker *victim = &pool->ws.worker[(start + i) % n];
+        if (victim == self) continue;
+        if (!job_deque_steal(&victim->inbox, func, data, sz)) goto found;
+        if (!job_deque_steal(&victim->deque, func, data, sz)) goto found;
+    }
+    return -EAGAIN;
+
+found:
+    atomic_fetch_sub(&pool->ws.pending, 1);
+    return 0;
+}
+
+static void ws_job_done(VmafThreadPool *pool)
+{
+    if (atomic_fetch_sub(&pool->ws.outstanding, 1) != 1)
+        return;
+    pthread_mutex_lock(&pool->ws.lock);
+    pthread_cond_broadcast(&pool->ws.done);
+    pthread_mutex_unlock(&pool->ws.lock);
+}
+
+static int ws_run_job(VmafThreadPool *pool, VmafThreadPoolWorker *self)
+{
+    VmafJobDataAlign data[VMAF_THREAD_POOL_MAX_DATA_SZ /
+                          sizeof(VmafJobDataAlign) + 1];
+    void (*func)(void *data);
+
+    if (ws_take_job(pool, self, &func, data)) return -EAGAIN;
+    void *const outer = pthread_getspecific(pool->ws.in_job);
+    pthread_setspecific(pool->ws.in_job, pool);
+    func(data);
+    pthread_setspecific(pool->ws.in_job, outer);
+    ws_job_done(pool);
+    return 0;
+}
+
+static void *ws_runner(void *p)
+{
+    VmafThreadPoolWorker *self = p;
+    VmafThreadPool *pool = self->pool;
+    pthread_setspecific(pool->ws.self, self);
+
+    while (!atomic_load(&pool->ws.stop)) {
+        if (!ws_run_job(pool, self)) continue;
+
+        atomic_fetch_add(&pool->ws.n_sleeping, 1);
+        pthread_mutex_lock(&pool->ws.lock);
+        while (atomic_load(&pool->ws.pending) <= 0 &&
+               !atomic_load(&pool->ws.stop))
+        {
+            pthread_cond_wait(&pool->ws.wake, &pool->ws.lock);
+        }
+        pthread_mutex_unlock(&pool->ws.lock);
+        atomic_fetch_sub(&pool->ws.n_sleeping, 1);
+    }
+
+    return NULL;
+}
+
+static void ws_notify(VmafThreadPool *pool)
+{
+    atomic_fetch_add(&pool->ws.pending, 1);
+    if (!atomic_load(&pool->ws.n_sleeping)) return;
+    pthread_mutex_lock(&pool->ws.lock);
+    pthread_cond_signal(&pool->ws.wake);
+    pthread_mutex_unlock(&pool->ws.lock);
+}
+
+static int ws_enqueue(VmafThreadPool *pool, void (*func)(void *data),
+                      void *data, size_t data_sz)
+{
+    if (data_sz > pool->ws.max_data_sz) return -EINVAL;
+
+    atomic_fetch_add(&pool->ws.outstanding, 1);
+
+    VmafThreadPoolWorker *self = pthread_getspecific(pool->ws.self);
+    if (self) {
+        // nested job, keep it local unless another worker steals it
+        if (job_deque_push(&self->deque, func, data, data_sz)) {
+            func(data);
+            ws_job_done(pool);
+            return 0;
+        }
+        ws_notify(pool);
+        return 0;
+    }
+
+    for (;;) {
+        pthread_mutex_lock(&pool->ws.submit_lock);
+        for (unsigned i = 0; i < pool->n_threads; i++) {
+            const unsigned idx = pool->ws.next_inbox++ % pool->n_threads;
+            VmafJobDeque *inbox = &pool->ws.worker[idx].inbox;
+            if (!job_deque_push(inbox, func, data, data_sz)) {
+                pthread_mutex_unlock(&pool->ws.submit_lock);
+                ws_notify(pool);
+                return 0;
+            }
+        }
+        pthread_mutex_unlock(&pool->ws.submit_lock);
+        // every inbox is full, help out instead of waiting
+        ws_run_job(pool, NULL);
+    }
+}
+
+static int ws_wait(VmafThreadPool *pool)
+{
+    // the calling job is outstanding itself, waiting on it would never return
+    if (pthread_getspecific(pool->ws.in_job)) return -EDEADLK;
+
+    while (!ws_run_job(pool, NULL));
+
+    pthread_mutex_lock(&pool->ws.lock);
+    while (atomic_load(&pool->ws.outstanding))
+        pthread_cond_wait(&pool->ws.done, &pool->ws.lock);
+    pthread_mutex_unlock(&pool->ws.lock);
+    return 0;
+}
+
+static void ws_stop(VmafThreadPool *pool, unsigned n_started)
+{
+    pthread_mutex_lock(&pool->ws.lock);
+    atomic_store(&pool->ws.stop, 1);
+    pthread_cond_broadcast(&pool->ws.wake);
+    pthread_mutex_unlock(&pool->ws.lock);
+
+    for (unsigned i = 0; i < n_started; i++)
+        pthread_join(pool->ws.worker[i].thread, NULL);
+}
+
+static void ws_free(VmafThreadPool *pool)
+{
+    for (unsigned i = 0; i < pool->n_threads; i++) {
+        job_deque_destroy(&pool->ws.worker[i].deque);
+        job_deque_destroy(&pool->ws.worker[i].inbox);
+    }
+    free(pool->ws.worker);
+    free(pool);
+}
+
+static int ws_destroy(VmafThreadPool *pool)
+{
+    ws_stop(pool, pool->n_threads);
+    pthread_key_delete(pool->ws.self);
+    pthread_key_delete(pool->ws.in_job);
+    pthread_mutex_destroy(&pool->ws.submit_lock);
+    pthread_mutex_destroy(&pool->ws.lock);
+    pthread_cond_destroy(&pool->ws.wake);
+    pthread_cond_destroy(&pool->ws.done);
+    ws_free(pool);
+    return 0;
+}
+
+int vmaf_thread_pool_create_work_stealing(VmafThreadPool **pool,
+                                          unsigned n_threads,
+                                          size_t max_data_sz)
+{
+    if (!pool) return -EINVAL;
+    if (!n_threads) return -EINVAL;
+    if (max_data_sz > VMAF_THREAD_POOL_MAX_DATA_SZ) return -EINVAL;
+
+    VmafThreadPool *const p = *pool = malloc(sizeof(*p));
+    if (!p) return -ENOMEM;
+    memset(p, 0, sizeof(*p));
+    p->type = VMAF_THREAD_POOL_TYPE_WORK_STEALING;
+    p->n_threads = n_threads;
+    p->ws.max_data_sz = max_data_sz;
+    atomic_init(&p->ws.pending, 0);
+    atomic_init(&p->ws.outstanding, 0);
+    atomic_init(&p->ws.n_sleeping, 0);
+    atomic_init(&p->ws.stop, 0);
+
+    const size_t worker_sz = sizeof(*p->ws.worker) * n_threads;
+    p->ws.worker = malloc(worker_sz);
+    if (!p->ws.worker) goto free_p;
+    memset(p->ws.worker, 0, worker_sz);
+
+    for (unsigned i = 0; i < n_threads; i++) {
+        VmafThreadPoolWorker *w = &p->ws.worker[i];
+        w->pool = p;
+        w->id = i;
+        int err = job_deque_init(&w->deque, JOB_DEQUE_CAPACITY, max_data_sz);
+        err |= job_deque_init(&w->inbox, JOB_DEQUE_CAPACITY, max_data_sz);
+        if (err) goto free_ws;
+    }
+
+    if (pthread_key_create(&p->ws.self, NULL)) goto free_ws;
+    if (pthread_key_create(&p->ws.in_job, NULL)) {
+        pthread_key_delete(p->ws.self);
+        goto free_ws;
+    }
+    pthread_mutex_init(&p->ws.submit_lock, NULL);
+    pthread_mutex_init(&p->ws.lock, NULL);
+    pthread_cond_init(&p->ws.wake, NULL);
+    pthread_cond_init(&p->ws.done, NULL);
+
+    for (unsigned i = 0; i < n_threads; i++) {
+        VmafThreadPoolWorker *w = &p->ws.worker[i];
+        if (pthread_create(&w->thread, NULL, ws_runner, w)) {
+            ws_stop(p, i);
+            pthread_key_delete(p->ws.self);
+            pthread_key_delete(p->ws.in_job);
+            goto free_ws;
+        }
+    }
+
+    return 0;
+
+free_ws:
+    ws_free(p);
+    return -ENOMEM;
+free_p:
+    free(p);
+    return -ENOMEM;
+}
+
 int vmaf_thread_pool_create(VmafThreadPool **pool, unsigned n_threads)
 {
     if (!pool) return -EINVAL;
@@ -120,6 +499,8 @@ int vmaf_thread_pool_enqueue(VmafThreadPool *pool, void (*func)(void *data),
 {
     if (!pool) return -EINVAL;
     if (!func) return -EINVAL;
+    if (pool->type == VMAF_THREAD_POOL_TYPE_WORK_STEALING)
+        return ws_enqueue(pool, func, data, data_sz);
 
     VmafThreadPoolJob *job = malloc(sizeof(*job));
     if (!job) return -ENOMEM;
@@ -154,16 +535,113 @@ free_job:
 int vmaf_thread_pool_wait(VmafThreadPool *pool)
 {
     if (!pool) return -EINVAL;
+    if (pool->type == VMAF_THREAD_POOL_TYPE_WORK_STEALING)
+        return ws_wait(pool);
 
     pthread_mutex_lock(&(pool->queue.lock));
-    while((!pool->stop && pool->n_working) || (pool->stop && pool->n_threads))
+    while((!pool->stop && (pool->n_working || pool->queue.head)) ||
+          (pool->stop && pool->n_threads))
         pthread_cond_wait(&(pool->working), &(pool->queue.lock));
     pthread_mutex_unlock(&(pool->queue.lock));
     return 0;
 }
+
+typedef struct VmafParallelFor {
+    void (*func)(void *data, unsigned idx);
+    void *data;
+    unsigned n_jobs;
+    atomic_int next, done, refcnt;
+    pthread_mutex_t lock;
+    pthread_cond_t finished;
+} VmafParallelFor;
+
+static void parallel_for_run(VmafParallelFor *pf)
+{
+    for (;;) {
+        const unsigned idx = atomic_fetch_add(&pf->next, 1);
+        if (idx >= pf->n_jobs) return;
+        pf->func(pf->data, idx);
+        if (atomic_fetch_add(&pf->done, 1) + 1 != (int)pf->n_jobs) continue;
+        pthread_mutex_lock(&pf->lock);
+        pthread_cond_broadcast(&pf->finished);
+        pthread_mutex_unlock(&pf->lock);
+    }
+}
+
+static void parallel_for_unref(VmafParallelFor *pf)
+{
+    if (atomic_fetch_sub(&pf->refcnt, 1) != 1) return;
+    pthread_mutex_destroy(&pf->lock);
+    pthread_cond_destroy(&pf->finished);
+    free(pf);
+}
+
+static void parallel_for_helper(void *data)
+{
+    VmafParallelFor *pf = *(VmafParallelFor **)data;
+    parallel_for_run(pf);
+    parallel_for_unref(pf);
+}
+
+int vmaf_thread_pool_parallel_for(VmafThreadPool *pool, unsigned n_jobs,
+                                  void (*func)(void *data, unsigned idx),
+                                  void *data)
+{
+    if (!func) return -EINVAL;
+
+    if (!pool || n_jobs < 2 || pool->n_threads < 2) {
+        for (unsigned i = 0; i < n_jobs; i++)
+            func(data, i);
+        return 0;
+    }
+
+    VmafParallelFor *pf = malloc(sizeof(*pf));
+    if (!pf) return -ENOMEM;
+    pf->func = func;
+    pf->data = data;
+    pf->n_jobs = n_jobs;
+    atomic_init(&pf->next, 0);
+    atomic_init(&pf->done, 0);
+    atomic_init(&pf->refcnt, 1);
+    pthread_mutex_init(&pf->lock, NULL);
+    pthread_cond_init(&pf->finished, NULL);
+
+    // helpers only pick up jobs nobody has claimed yet, they may well run
+    // after this call has returned, hence the reference count
+    const unsigned n_helpers =
+        (n_jobs < pool->n_threads ? n_jobs : pool->n_threads) - 1;
+    for (unsigned i = 0; i < n_helpers; i++) {
+        atomic_fetch_add(&pf->refcnt, 1);
+        if (vmaf_thread_pool_enqueue(pool, parallel_for_helper, &pf,
+                                     sizeof(pf)))
+        {
+            atomic_fetch_sub(&pf->refcnt, 1);
+            break;
+        }
+    }
+
+    parallel_for_run(pf);
+
+    pthread_mutex_lock(&pf->lock);
+    while (atomic_load(&pf->done) != (int)n_jobs)
+        pthread_cond_wait(&pf->finished, &pf->lock);
+    pthread_mutex_unlock(&pf->lock);
+
+    parallel_for_unref(pf);
+    return 0;
+}
+
+unsigned vmaf_thread_pool_n_threads(VmafThreadPool *pool)
+{
+    if (!pool) return 0;
+    return pool->n_threads;
+}
+
 int vmaf_thread_pool_destroy(VmafThreadPool *pool)
 {
     if (!pool) return -EINVAL;
+    if (pool->type == VMAF_THREAD_POOL_TYPE_WORK_STEALING)
+        return ws_destroy(pool);
     pthread_mutex_lock(&(pool->queue.lock));
 
     VmafThreadPoolJob *job = pool->queue.head;
@@ -20,16 +20,49 @@
 #define __VMAF_THREAD_POOL_H__
 
 #include <pthread.h>
+#include <stddef.h>
 
 typedef struct VmafThreadPool VmafThreadPool;
 
+enum VmafThreadPoolType {
+    VMAF_THREAD_POOL_TYPE_FIFO = 0,
+    VMAF_THREAD_POOL_TYPE_WORK_STEALING,
+};
+
 int vmaf_thread_pool_create(VmafThreadPool **tpool, unsigned n_threads);
 
+/**
+ * Create a work-stealing thread pool. Every worker owns a lock-free deque of
+ * preallocated job slots, idle workers steal from their peers. Jobs enqueued
+ * from within a job stay on the worker's own deque.
+ * `vmaf_thread_pool_enqueue()` never allocates, `data_sz` is limited to
+ * `max_data_sz`, which may not exceed `VMAF_THREAD_POOL_MAX_DATA_SZ`.
+ * `vmaf_thread_pool_wait()` fails with -EDEADLK when called from within a
+ * job, use `vmaf_thread_pool_parallel_for()` there instead.
+ */
+#define VMAF_THREAD_POOL_MAX_DATA_SZ 512
+
+int vmaf_thread_pool_create_work_stealing(VmafThreadPool **tpool,
+                                          unsigned n_threads,
+                                          size_t max_data_sz);
+
 int vmaf_thread_pool_enqueue(VmafThreadPool *pool, void (*func)(void *data),
                              void *data, size_t data_sz);
 
 int vmaf_thread_pool_wait(VmafThreadPool *pool);
 
+/**
+ * Run `func(data, idx)` for every `idx` in [0, n_jobs) and return once all of
+ * them have finished. The calling thread takes part and never waits on a job
+ * which has not been started yet, so this is safe to call from within a job.
+ * Without a pool, all jobs run on the calling thread.
+ */
+int vmaf_thread_pool_parallel_for(VmafThreadPool *pool, unsigned n_jobs,
+                                  void (*func)(void *data, unsigned idx),
+                                  void *data);
+
+unsigned vmaf_thread_pool_n_threads(VmafThreadPool *pool);
+
 int vmaf_thread_pool_destroy(VmafThreadPool *tpool);
 
 #endif /* __VMAF_THREAD_POOL_H__ */
@@ -0,0 +1,115 @@
+/**
+ *
+ *  Copyright 2016-2020 Netflix, Inc.
+ *
+ *     Licensed under the BSD+Patent License (the "License");
+ *     you may not use this file except in compliance with the License.
+ *     You may obtain a copy of the License at
+ *
+ *         https://opensource.org/licenses/BSDplusPatent
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *
+ */
+
+#include <immintrin.h>
+
+#include "svr.h"
+#include "x86/svr_avx2.h"
+
+/* exp() for x <= 0: Cody-Waite reduction to |r| <= ln(2) / 2 and a degree 13
+ * Taylor polynomial, accurate to about 1 ulp. Flushes to zero below -708. */
+static inline __m256d exp_pd(__m256d x)
+{
+    const __m256d min_x = _mm256_set1_pd(-708.0);
+    const __m256d underflow = _mm256_cmp_pd(x, min_x, _CMP_LT_OQ);
+    x = _mm256_min_pd(_mm256_max_pd(x, min_x), _mm256_setzero_pd());
+
+    const __m256d n =
+        _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(1.4426950408889634)),
+                        _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256d r = _mm256_sub_pd(x, _mm256_mul_pd(n, _mm256_set1_pd(6.93145751953125e-1)));
+    r = _mm256_sub_pd(r, _mm256_mul_pd(n, _mm256_set1_pd(1.42860682030941723212e-6)));
+
+    __m256d p = _mm256_set1_pd(1.6059043836821613e-10);
+    p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(2.0876756987868100e-09));
+    p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(2.5052108385441720e-08));
+    p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(2.7557319223985893e-07));
+    p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(2.7557319223985888e-06));
+    p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(2.4801587301587302e-05));
+    p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(1.9841269841269841e-04));
+    p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(1.3888888888888889e-03));
+    p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(8.3333333333333332e-03));
+    p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(4.1666666666666664e-02));
+    p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(1.6666666666666666e-01));
+    p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(0.5));
+    p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(1.0));
+    p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(1.0));
+
+    const __m256i e = _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(n));
+    const __m256i scale =
+        _mm256_slli_epi64(_mm256_add_epi64(e, _mm256_set1_epi64x(1023)), 52);
+    p = _mm256_mul_pd(p, _mm256_castsi256_pd(scale));
+
+    return _mm256_andnot_pd(underflow, p);
+}
+
+static inline double hsum_pd(__m256d x)
+{
+    __m128d s = _mm_add_pd(_mm256_castpd256_pd128(x),
+                           _mm256_extractf128_pd(x, 1));
+    s = _mm_add_sd(s, _mm_unpackhi_pd(s, s));
+    return _mm_cvtsd_f64(s);
+}
+
+/* Each block of 4 support vectors is loaded once and evaluated against up to
+ * 4 frames. `cnt` is a constant at every call site. */
+static inline void predict_frames(const VmafSvr *svr, const double *x,
+                                  double *y, const unsigned cnt)
+{
+    const unsigned n_features = svr->n_features;
+    const unsigned stride = svr->n_sv_padded;
+    const __m256d neg_gamma = _mm256_set1_pd(-svr->gamma);
+
+    __m256d sum[4];
+    for (unsigned b = 0; b < cnt; b++)
+        sum[b] = _mm256_setzero_pd();
+
+    for (unsigned i = 0; i < stride; i += 4) {
+        __m256d d2[4];
+        for (unsigned b = 0; b < cnt; b++)
+            d2[b] = _mm256_setzero_pd();
+
+        for (unsigned f = 0; f < n_features; f++) {
+            const __m256d sv = _mm256_load_pd(&svr->sv[f * stride + i]);
+            for (unsigned b = 0; b < cnt; b++) {
+                const __m256d d =
+                    _mm256_sub_pd(_mm256_set1_pd(x[b * n_features + f]), sv);
+                d2[b] = _mm256_add_pd(d2[b], _mm256_mul_pd(d, d));
+            }
+        }
+
+        const __m256d coef = _mm256_load_pd(&svr->coef[i]);
+        for (unsigned b = 0; b < cnt; b++) {
+            const __m256d k = exp_pd(_mm256_mul_pd(neg_gamma, d2[b]));
+            sum[b] = _mm256_add_pd(sum[b], _mm256_mul_pd(coef, k));
+        }
+    }
+
+    for (unsigned b = 0; b < cnt; b++)
+        y[b] = hsum_pd(sum[b]) - svr->rho;
+}
+
+void svr_predict_avx2(const VmafSvr *svr, const double *x, double *y,
+                      unsigned n)
+{
+    unsigned j = 0;
+    for (; j + 4 <= n; j += 4)
+        predict_frames(svr, &x[j * svr->n_features], &y[j], 4);
+    for (; j < n; j++)
+        predict_frames(svr, &x[j * svr->n_features], &y[j], 1);
+}
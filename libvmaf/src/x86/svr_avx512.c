@@ -0,0 +1,102 @@
+/**
+ *
+ *  Copyright 2016-2020 Netflix, Inc.
+ *
+ *     Licensed under the BSD+Patent License (the "License");
+ *     you may not use this file except in compliance with the License.
+ *     You may obtain a copy of the License at
+ *
+ *         https://opensource.org/licenses/BSDplusPatent
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *
+ */
+
+#include <immintrin.h>
+
+#include "svr.h"
+#include "x86/svr_avx512.h"
+
+/* exp() for x <= 0: Cody-Waite reduction to |r| <= ln(2) / 2 and a degree 13
+ * Taylor polynomial, accurate to about 1 ulp. Flushes to zero below -708. */
+static inline __m512d exp_pd(__m512d x)
+{
+    const __m512d min_x = _mm512_set1_pd(-708.0);
+    const __mmask8 valid = _mm512_cmp_pd_mask(x, min_x, _CMP_GE_OQ);
+    x = _mm512_min_pd(_mm512_max_pd(x, min_x), _mm512_setzero_pd());
+
+    const __m512d n =
+        _mm512_roundscale_pd(_mm512_mul_pd(x, _mm512_set1_pd(1.4426950408889634)),
+                             _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m512d r = _mm512_fnmadd_pd(n, _mm512_set1_pd(6.93145751953125e-1), x);
+    r = _mm512_fnmadd_pd(n, _mm512_set1_pd(1.42860682030941723212e-6), r);
+
+    __m512d p = _mm512_set1_pd(1.6059043836821613e-10);
+    p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(2.0876756987868100e-09));
+    p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(2.5052108385441720e-08));
+    p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(2.7557319223985893e-07));
+    p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(2.7557319223985888e-06));
+    p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(2.4801587301587302e-05));
+    p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.9841269841269841e-04));
+    p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.3888888888888889e-03));
+    p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(8.3333333333333332e-03));
+    p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(4.1666666666666664e-02));
+    p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.6666666666666666e-01));
+    p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(0.5));
+    p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0));
+    p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0));
+
+    return _mm512_maskz_scalef_pd(valid, p, n);
+}
+
+/* Each block of 8 support vectors is loaded once and evaluated against up to
+ * 4 frames. `cnt` is a constant at every call site. */
+static inline void predict_frames(const VmafSvr *svr, const double *x,
+                                  double *y, const unsigned cnt)
+{
+    const unsigned n_features = svr->n_features;
+    const unsigned stride = svr->n_sv_padded;
+    const __m512d neg_gamma = _mm512_set1_pd(-svr->gamma);
+
+    __m512d sum[4];
+    for (unsigned b = 0; b < cnt; b++)
+        sum[b] = _mm512_setzero_pd();
+
+    for (unsigned i = 0; i < stride; i += 8) {
+        __m512d d2[4];
+        for (unsigned b = 0; b < cnt; b++)
+            d2[b] = _mm512_setzero_pd();
+
+        for (unsigned f = 0; f < n_features; f++) {
+            const __m512d sv = _mm512_load_pd(&svr->sv[f * stride + i]);
+            for (unsigned b = 0; b < cnt; b++) {
+                const __m512d d =
+                    _mm512_sub_pd(_mm512_set1_pd(x[b * n_features + f]), sv);
+                d2[b] = _mm512_fmadd_pd(d, d, d2[b]);
+            }
+        }
+
+        const __m512d coef = _mm512_load_pd(&svr->coef[i]);
+        for (unsigned b = 0; b < cnt; b++) {
+            const __m512d k = exp_pd(_mm512_mul_pd(neg_gamma, d2[b]));
+            sum[b] = _mm512_fmadd_pd(coef, k, sum[b]);
+        }
+    }
+
+    for (unsigned b = 0; b < cnt; b++)
+        y[b] = _mm512_reduce_add_pd(sum[b]) - svr->rho;
+}
+
+void svr_predict_avx512(const VmafSvr *svr, const double *x, double *y,
+                        unsigned n)
+{
+    unsigned j = 0;
+    for (; j + 4 <= n; j += 4)
+        predict_frames(svr, &x[j * svr->n_features], &y[j], 4);
+    for (; j < n; j++)
+        predict_frames(svr, &x[j * svr->n_features], &y[j], 1);
+}
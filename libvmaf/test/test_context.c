@@ -16,6 +16,10 @@
  *
  */
 
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
 #include "test.h"
 #include "libvmaf/libvmaf.rc.h"
 
@@ -70,9 +74,208 @@ static char *test_get_feature_score()
     return NULL;
 }
 
+static char *test_max_frames_in_flight()
+{
+    int err = 0;
+    VmafContext *vmaf;
+    VmafConfiguration cfg = {
+        .n_threads = 2,
+        .max_frames_in_flight = 1,
+    };
+
+    err = vmaf_init(&vmaf, cfg);
+    mu_assert("problem during vmaf_init", !err);
+    err = vmaf_use_feature(vmaf, "psnr", NULL);
+    mu_assert("problem during vmaf_use_feature", !err);
+
+    const unsigned n_frames = 8;
+    for (unsigned i = 0; i < n_frames; i++) {
+        VmafPicture ref, dist;
+        err = vmaf_picture_alloc(&ref, VMAF_PIX_FMT_YUV420P, 8, 64, 64);
+        err |= vmaf_picture_alloc(&dist, VMAF_PIX_FMT_YUV420P, 8, 64, 64);
+        mu_assert("problem during vmaf_picture_alloc", !err);
+
+        while ((err = vmaf_try_read_pictures(vmaf, &ref, &dist, i)) == -EAGAIN);
+        mu_assert("problem during vmaf_try_read_pictures", !err);
+    }
+
+    err = vmaf_read_pictures(vmaf, NULL, NULL, 0);
+    mu_assert("problem flushing context", !err);
+
+    for (unsigned i = 0; i < n_frames; i++) {
+        double score;
+        err = vmaf_feature_score_at_index(vmaf, "psnr_y", &score, i);
+        mu_assert("every frame should have been extracted", !err);
+    }
+
+    err = vmaf_close(vmaf);
+    mu_assert("problem during vmaf_close", !err);
+
+    return NULL;
+}
+
+typedef struct FrameCallbackState {
+    VmafContext *vmaf;
+    atomic_uint fired, incomplete;
+} FrameCallbackState;
+
+static void frame_callback(void *user_data, unsigned index,
+                           const double *score)
+{
+    FrameCallbackState *s = user_data;
+    (void) score;
+
+    double feature_score;
+    int err = vmaf_feature_score_at_index(s->vmaf, "psnr_y",
+                                          &feature_score, index);
+    err |= vmaf_feature_score_at_index(s->vmaf,
+                                       "VMAF_integer_feature_motion2_score",
+                                       &feature_score, index);
+    if (err) atomic_fetch_add(&s->incomplete, 1);
+    atomic_fetch_add(&s->fired, 1);
+}
+
+static char *run_frame_callback(unsigned n_threads)
+{
+    int err = 0;
+    VmafContext *vmaf;
+    VmafConfiguration cfg = {
+        .n_threads = n_threads,
+    };
+
+    err = vmaf_init(&vmaf, cfg);
+    mu_assert("problem during vmaf_init", !err);
+    err = vmaf_use_feature(vmaf, "psnr", NULL);
+    err |= vmaf_use_feature(vmaf, "motion", NULL);
+    mu_assert("problem during vmaf_use_feature", !err);
+
+    FrameCallbackState state = { .vmaf = vmaf };
+    atomic_init(&state.fired, 0);
+    atomic_init(&state.incomplete, 0);
+    err = vmaf_register_frame_callback(vmaf, frame_callback, NULL, &state);
+    mu_assert("problem during vmaf_register_frame_callback", !err);
+
+    const unsigned n_frames = 6;
+    for (unsigned i = 0; i < n_frames; i++) {
+        VmafPicture ref, dist;
+        err = vmaf_picture_alloc(&ref, VMAF_PIX_FMT_YUV420P, 8, 64, 64);
+        err |= vmaf_picture_alloc(&dist, VMAF_PIX_FMT_YUV420P, 8, 64, 64);
+        mu_assert("problem during vmaf_picture_alloc", !err);
+        err = vmaf_read_pictures(vmaf, &ref, &dist, i);
+        mu_assert("problem during vmaf_read_pictures", !err);
+    }
+
+    err = vmaf_read_pictures(vmaf, NULL, NULL, 0);
+    mu_assert("problem flushing context", !err);
+    mu_assert("callback should fire once per frame",
+              atomic_load(&state.fired) == n_frames);
+    mu_assert("callback should only fire once all features are written",
+              !atomic_load(&state.incomplete));
+
+    err = vmaf_close(vmaf);
+    mu_assert("problem during vmaf_close", !err);
+
+    return NULL;
+}
+
+static char *test_frame_callback()
+{
+    char *msg = run_frame_callback(0);
+    if (msg) return msg;
+    return run_frame_callback(2);
+}
+
+static int read_moving_pictures(VmafContext *vmaf, unsigned n_frames,
+                                bool flush)
+{
+    int err = 0;
+    for (unsigned i = 0; i < n_frames; i++) {
+        VmafPicture ref, dist;
+        err = vmaf_picture_alloc(&ref, VMAF_PIX_FMT_YUV420P, 8, 64, 64);
+        err |= vmaf_picture_alloc(&dist, VMAF_PIX_FMT_YUV420P, 8, 64, 64);
+        if (err) return err;
+        uint8_t *r = ref.data[0], *d = dist.data[0];
+        for (unsigned y = 0; y < ref.h[0]; y++) {
+            for (unsigned x = 0; x < ref.w[0]; x++) {
+                r[y * ref.stride[0] + x] = (x * 3 + y + i * 7) & 0xff;
+                d[y * dist.stride[0] + x] = (x * 3 + y + i * 5) & 0xff;
+            }
+        }
+        err = vmaf_read_pictures(vmaf, &ref, &dist, i);
+        if (err) return err;
+    }
+    return flush ? vmaf_read_pictures(vmaf, NULL, NULL, 0) : 0;
+}
+
+static char *run_reset(unsigned n_threads)
+{
+    int err = 0;
+    VmafContext *vmaf;
+    VmafConfiguration cfg = {
+        .n_threads = n_threads,
+    };
+
+    err = vmaf_init(&vmaf, cfg);
+    mu_assert("problem during vmaf_init", !err);
+    err = vmaf_use_feature(vmaf, "psnr", NULL);
+    err |= vmaf_use_feature(vmaf, "motion", NULL);
+    mu_assert("problem during vmaf_use_feature", !err);
+
+    const unsigned n_frames = 6;
+    double psnr[6], motion2[6];
+    err = read_moving_pictures(vmaf, n_frames, true);
+    mu_assert("problem reading pictures", !err);
+    for (unsigned i = 0; i < n_frames; i++) {
+        err = vmaf_feature_score_at_index(vmaf, "psnr_y", &psnr[i], i);
+        err |= vmaf_feature_score_at_index(vmaf,
+                                           "VMAF_integer_feature_motion2_score",
+                                           &motion2[i], i);
+        mu_assert("every frame should have been extracted", !err);
+    }
+
+    err = vmaf_reset(vmaf);
+    mu_assert("problem during vmaf_reset", !err);
+    double score;
+    err = vmaf_feature_score_at_index(vmaf, "psnr_y", &score, 0);
+    mu_assert("reset should drop all scores", err);
+
+    /* A shorter job which is not flushed before the next reset. */
+    err = read_moving_pictures(vmaf, n_frames / 2, false);
+    mu_assert("problem reading pictures after reset", !err);
+    err = vmaf_reset(vmaf);
+    mu_assert("problem during vmaf_reset", !err);
+
+    err = read_moving_pictures(vmaf, n_frames, true);
+    mu_assert("problem reading pictures after reset", !err);
+    for (unsigned i = 0; i < n_frames; i++) {
+        err = vmaf_feature_score_at_index(vmaf, "psnr_y", &score, i);
+        mu_assert("psnr should match the first job", !err && score == psnr[i]);
+        err = vmaf_feature_score_at_index(vmaf,
+                                          "VMAF_integer_feature_motion2_score",
+                                          &score, i);
+        mu_assert("motion2 should match the first job",
+                  !err && score == motion2[i]);
+    }
+
+    err = vmaf_close(vmaf);
+    mu_assert("problem during vmaf_close", !err);
+
+    return NULL;
+}
+
+static char *test_reset()
+{
+    char *msg = run_reset(0);
+    if (msg) return msg;
+    return run_reset(2);
+}
+
 char *run_tests()
 {
     mu_run_test(test_context_init_and_close);
     mu_run_test(test_get_feature_score);
+    mu_run_test(test_max_frames_in_flight);
+    mu_run_test(test_frame_callback);
+    mu_run_test(test_reset);
     return NULL;
 }
@@ -16,6 +16,8 @@
  *
  */
 
+#include <pthread.h>
+
 #include "test.h"
 #include "feature_collector.c"
 
@@ -24,8 +26,8 @@ static char *test_feature_vector_init_append_and_destroy()
     int err;
 
     FeatureVector *feature_vector;
-    err = feature_vector_init(&feature_vector, "psnr_y");
-    mu_assert("problem during feature_vector_init", !err);
+    err = feature_vector_init_ring(&feature_vector, "psnr_y", 0, NULL, NULL);
+    mu_assert("problem during feature_vector_init_ring", !err);
 
     unsigned initial_capacity = feature_vector->capacity;
     for (int j = initial_capacity - 1; j >= 0; j--) {
@@ -86,9 +88,249 @@ static char *test_feature_collector_init_append_get_and_destroy()
     return NULL;
 }
 
+typedef struct {
+    VmafFeatureCollector *feature_collector;
+    unsigned id, first, n;
+    int err;
+} AppendJob;
+
+static void *append_job(void *data)
+{
+    AppendJob *job = data;
+    for (unsigned i = job->first; i < job->n; i += 4) {
+        job->err |= vmaf_feature_collector_append_id(job->feature_collector,
+                                                     job->id, i, i);
+    }
+    return NULL;
+}
+
+static char *test_feature_collector_append_id()
+{
+    int err;
+
+    VmafFeatureCollector *feature_collector;
+    err = vmaf_feature_collector_init(&feature_collector);
+    mu_assert("problem during vmaf_feature_collector_init", !err);
+
+    unsigned id[2];
+    err  = vmaf_feature_collector_register(feature_collector, "feature0", &id[0]);
+    err |= vmaf_feature_collector_register(feature_collector, "feature1", &id[1]);
+    mu_assert("problem during vmaf_feature_collector_register", !err);
+    mu_assert("feature ids should be handed out in order",
+              id[0] == 0 && id[1] == 1);
+    unsigned again;
+    err = vmaf_feature_collector_register(feature_collector, "feature1", &again);
+    mu_assert("registering twice should return the same id",
+              !err && again == id[1]);
+
+    const unsigned n = 1000;
+    pthread_t thread[4];
+    AppendJob job[4];
+    for (unsigned i = 0; i < 4; i++) {
+        job[i] = (AppendJob) {
+            .feature_collector = feature_collector,
+            .id = id[1], .first = i, .n = n,
+        };
+        pthread_create(&thread[i], NULL, append_job, &job[i]);
+    }
+    for (unsigned i = 0; i < 4; i++) {
+        pthread_join(thread[i], NULL);
+        mu_assert("problem during vmaf_feature_collector_append_id", !job[i].err);
+    }
+
+    for (unsigned i = 0; i < n; i++) {
+        double score;
+        err = vmaf_feature_collector_get_score(feature_collector, "feature1",
+                                               &score, i);
+        mu_assert("every concurrently written score should be readable",
+                  !err && score == i);
+    }
+    FeatureVector *fv = feature_collector_get_vector(feature_collector, id[1]);
+    mu_assert("index_end should cover every index", fv->index_end == n);
+
+    err = vmaf_feature_collector_append_id(feature_collector, id[1], 0., 5);
+    mu_assert("vmaf_feature_collector_append_id should not overwrite", err);
+    err = vmaf_feature_collector_append_id(feature_collector, 2, 0., 0);
+    mu_assert("an unregistered id should be rejected", err);
+
+    vmaf_feature_collector_destroy(feature_collector);
+    return NULL;
+}
+
+static char *test_feature_collector_register_list()
+{
+    int err;
+
+    VmafFeatureCollector *feature_collector;
+    err = vmaf_feature_collector_init(&feature_collector);
+    mu_assert("problem during vmaf_feature_collector_init", !err);
+
+    unsigned id;
+    err = vmaf_feature_collector_lookup(feature_collector, "feature1", &id);
+    mu_assert("an unregistered feature should not be found", err);
+    err = vmaf_feature_collector_register(feature_collector, "feature1", &id);
+    mu_assert("problem during vmaf_feature_collector_register", !err);
+
+    const char *feature_name[] = { "feature0", "feature1", "feature2" };
+    VmafFeatureCollector *interned = NULL;
+    unsigned feature_id[3];
+    err = vmaf_feature_collector_register_list(feature_collector, &interned,
+                                               feature_name, feature_id, 3);
+    mu_assert("problem during vmaf_feature_collector_register_list", !err);
+    mu_assert("the collector should be remembered",
+              interned == feature_collector);
+    mu_assert("registered features should keep their id",
+              feature_id[1] == id);
+    mu_assert("new features should be registered in order",
+              feature_id[0] == 1 && feature_id[2] == 2);
+
+    feature_id[0] = 42;
+    err = vmaf_feature_collector_register_list(feature_collector, &interned,
+                                               feature_name, feature_id, 3);
+    mu_assert("an interned list should not be looked up again",
+              !err && feature_id[0] == 42);
+
+    err = vmaf_feature_collector_lookup(feature_collector, "feature2", &id);
+    mu_assert("vmaf_feature_collector_lookup should find registered features",
+              !err && id == feature_id[2]);
+
+    double score;
+    err = vmaf_feature_collector_append_id(feature_collector, id, 3., 7);
+    mu_assert("problem during vmaf_feature_collector_append_id", !err);
+    err = vmaf_feature_collector_get_score_id(feature_collector, id, &score, 7);
+    mu_assert("score should be readable by id", !err && score == 3.);
+    err = vmaf_feature_collector_get_score_id(feature_collector, id, &score, 6);
+    mu_assert("an unwritten index should not be read", err);
+    err = vmaf_feature_collector_get_score_id(feature_collector, 3, &score, 7);
+    mu_assert("an unregistered id should be rejected", err);
+
+    vmaf_feature_collector_destroy(feature_collector);
+    return NULL;
+}
+
+static unsigned spilled_cnt;
+static double spilled_sum;
+
+static void spill(void *user_data, const char *feature_name, unsigned index,
+                  double score)
+{
+    (void) user_data;
+    (void) feature_name;
+    (void) index;
+    spilled_cnt++;
+    spilled_sum += score;
+}
+
+static char *test_feature_collector_retention()
+{
+    int err;
+
+    VmafFeatureCollector *feature_collector;
+    err = vmaf_feature_collector_init(&feature_collector);
+    mu_assert("problem during vmaf_feature_collector_init", !err);
+    err = vmaf_feature_collector_set_retention(feature_collector, 4, spill,
+                                               NULL);
+    mu_assert("problem during vmaf_feature_collector_set_retention", !err);
+
+    const unsigned n = 1000;
+    for (unsigned i = 0; i < n; i++) {
+        err = vmaf_feature_collector_append(feature_collector, "feature",
+                                            i, i);
+        mu_assert("problem during vmaf_feature_collector_append", !err);
+    }
+    FeatureVector *fv = feature_collector_get_vector(feature_collector, 0);
+    mu_assert("ring buffer should not grow", fv->capacity == 4);
+    mu_assert("older scores should have been spilled",
+              spilled_cnt == n - 4);
+
+    double score;
+    err = vmaf_feature_collector_get_score(feature_collector, "feature",
+                                           &score, n - 1);
+    mu_assert("latest score should be retained", !err && score == n - 1);
+    err = vmaf_feature_collector_get_score(feature_collector, "feature",
+                                           &score, n - 5);
+    mu_assert("old score should not be retained", err);
+    mu_assert("retained range should start at the window",
+              vmaf_feature_collector_retained_begin(feature_collector) == n - 4);
+
+    err = vmaf_feature_collector_append(feature_collector, "feature", 7., 3);
+    mu_assert("a late score should be spilled, not rejected", !err);
+    mu_assert("a late score should be spilled", spilled_cnt == n - 3);
+
+    err = vmaf_feature_collector_get_running_pooled(feature_collector,
+                                                    "feature",
+                                                    VMAF_POOL_METHOD_MAX,
+                                                    &score, 0, n - 1);
+    mu_assert("running max does not match", !err && score == n - 1);
+    err = vmaf_feature_collector_get_running_pooled(feature_collector,
+                                                    "feature",
+                                                    VMAF_POOL_METHOD_MEAN,
+                                                    &score, 0, n - 1);
+    const double expected = ((n - 1) * n / 2. + 7.) / (n + 1);
+    mu_assert("running mean does not match", !err && score == expected);
+    err = vmaf_feature_collector_get_running_pooled(feature_collector,
+                                                    "feature",
+                                                    VMAF_POOL_METHOD_MEAN,
+                                                    &score, 1, n - 1);
+    mu_assert("a partial range should not be pooled", err == -ERANGE);
+    err = vmaf_feature_collector_get_running_pooled(feature_collector,
+                                                    "feature",
+                                                    VMAF_POOL_METHOD_MEAN,
+                                                    &score, 0, n - 2);
+    mu_assert("a truncated range should not be pooled", err == -ERANGE);
+
+    vmaf_feature_collector_destroy(feature_collector);
+    return NULL;
+}
+
+static char *test_feature_collector_reset()
+{
+    int err;
+
+    VmafFeatureCollector *feature_collector;
+    err = vmaf_feature_collector_init(&feature_collector);
+    mu_assert("problem during vmaf_feature_collector_init", !err);
+
+    unsigned id;
+    err = vmaf_feature_collector_register(feature_collector, "feature", &id);
+    mu_assert("problem during vmaf_feature_collector_register", !err);
+    for (unsigned i = 0; i < 100; i++) {
+        err = vmaf_feature_collector_append_id(feature_collector, id, i, i);
+        mu_assert("problem during vmaf_feature_collector_append_id", !err);
+    }
+    FeatureVector *fv = feature_collector_get_vector(feature_collector, id);
+    FeatureSlot *bucket = fv->bucket[3];
+
+    err = vmaf_feature_collector_reset(feature_collector);
+    mu_assert("problem during vmaf_feature_collector_reset", !err);
+
+    double score;
+    err = vmaf_feature_collector_get_score(feature_collector, "feature",
+                                           &score, 42);
+    mu_assert("reset should drop every score", err);
+    mu_assert("reset should clear index_end",
+              fv->index_end == 0);
+    mu_assert("reset should keep allocated buckets",
+              fv->bucket[3] == bucket);
+
+    err = vmaf_feature_collector_append_id(feature_collector, id, 1., 42);
+    mu_assert("feature ids should survive a reset", !err);
+    err = vmaf_feature_collector_get_score(feature_collector, "feature",
+                                           &score, 42);
+    mu_assert("score written after reset should be readable",
+              !err && score == 1.);
+
+    vmaf_feature_collector_destroy(feature_collector);
+    return NULL;
+}
+
 char *run_tests()
 {
     mu_run_test(test_feature_vector_init_append_and_destroy);
     mu_run_test(test_feature_collector_init_append_get_and_destroy);
+    mu_run_test(test_feature_collector_append_id);
+    mu_run_test(test_feature_collector_register_list);
+    mu_run_test(test_feature_collector_retention);
+    mu_run_test(test_feature_collector_reset);
     return NULL;
 }
@@ -16,12 +16,17 @@
  *
  */
 
+#include <errno.h>
+#include <math.h>
 #include <stdint.h>
 #include <string.h>
 
+#include "cpu.h"
 #include "dict.h"
+#include "mem.h"
 #include "feature/feature_extractor.h"
 #include "feature/feature_collector.h"
+#include "feature/picture_copy.h"
 #include "test.h"
 #include "picture.h"
 #include "libvmaf/picture.h"
@@ -159,11 +164,453 @@ static char *test_feature_extractor_initialization_options()
     return NULL;
 }
 
+#if ARCH_X86
+static const unsigned simd_masks[] = {
+    0,
+    ~(unsigned)(VMAF_X86_CPU_FLAG_AVX512 | VMAF_X86_CPU_FLAG_AVX512ICL),
+    ~0u,
+};
+#else
+static const unsigned simd_masks[] = { 0, ~0u };
+#endif
+#define N_SIMD_MASKS (sizeof(simd_masks) / sizeof(simd_masks[0]))
+
+/*
+ * Wrap a 4:2:0 picture whose strides are padded past the aligned width, so
+ * that kernels reading up to the stride instead of the width get caught.
+ * `noise` is the amplitude of the pseudo-random texture added to a diagonal
+ * ramp, `seed` varies the texture between ref and dist. `pad` is the number
+ * of aligned blocks added to the luma stride.
+ */
+static int test_picture_alloc(VmafPicture *pic, unsigned bpc, unsigned w,
+                              unsigned h, unsigned seed, unsigned noise,
+                              unsigned pad)
+{
+    const unsigned bytes = bpc > 8 ? 2 : 1;
+    const unsigned max = (1u << bpc) - 1;
+    const unsigned w_uv = (w + 1) >> 1, h_uv = (h + 1) >> 1;
+    const ptrdiff_t stride[3] = {
+        ALIGN_CEIL(w * bytes) + pad * MAX_ALIGN,
+        ALIGN_CEIL(w_uv * bytes) + MAX_ALIGN,
+        ALIGN_CEIL(w_uv * bytes) + MAX_ALIGN,
+    };
+    const size_t sz[3] = { stride[0] * h, stride[1] * h_uv, stride[2] * h_uv };
+
+    uint8_t *buf = aligned_malloc(sz[0] + sz[1] + sz[2], MAX_ALIGN);
+    if (!buf) return -ENOMEM;
+    memset(buf, 0, sz[0] + sz[1] + sz[2]);
+    void *data[3] = { buf, buf + sz[0], buf + sz[0] + sz[1] };
+
+    uint32_t lcg = seed * 2654435761u + 1;
+    for (unsigned p = 0; p < 3; p++) {
+        const unsigned pw = p ? w_uv : w, ph = p ? h_uv : h;
+        for (unsigned i = 0; i < ph; i++) {
+            for (unsigned j = 0; j < pw; j++) {
+                lcg = lcg * 1664525u + 1013904223u;
+                unsigned v = ((i + 2 * j) * (max + 1) / (ph + 2 * pw) +
+                              (lcg >> 16) % (noise + 1)) % (max + 1);
+                uint8_t *row = (uint8_t *)data[p] + i * stride[p];
+                if (bytes == 2)
+                    ((uint16_t *)row)[j] = v;
+                else
+                    row[j] = v;
+            }
+        }
+    }
+
+    int err = vmaf_picture_wrap(pic, VMAF_PIX_FMT_YUV420P, bpc, w, h, data,
+                                stride, aligned_free, buf);
+    if (err) aligned_free(buf);
+    return err;
+}
+
+/*
+ * Run `fex_name` over `n_pics` picture pairs with the CPU flags limited to
+ * `cpu_mask`, and read back `n_names` features per picture into `scores`,
+ * picture-major. `thread_pool` is optional, and handed to the extractor.
+ */
+static char *extract_features(const char *fex_name, unsigned cpu_mask,
+                              VmafThreadPool *thread_pool,
+                              VmafPicture *ref, VmafPicture *dist,
+                              unsigned n_pics, const char **names,
+                              unsigned n_names, double *scores)
+{
+    int err = 0;
+
+    vmaf_init_cpu();
+    vmaf_set_cpu_flags_mask(cpu_mask);
+
+    VmafFeatureExtractor *fex = vmaf_get_feature_extractor_by_name(fex_name);
+    mu_assert("problem during vmaf_get_feature_extractor_by_name", fex);
+    VmafFeatureExtractorContext *fex_ctx;
+    err = vmaf_feature_extractor_context_create(&fex_ctx, fex, NULL);
+    mu_assert("problem during vmaf_feature_extractor_context_create", !err);
+    fex_ctx->fex->thread_pool = thread_pool;
+    VmafFeatureCollector *vfc;
+    err = vmaf_feature_collector_init(&vfc);
+    mu_assert("problem during vmaf_feature_collector_init", !err);
+
+    for (unsigned i = 0; i < n_pics; i++) {
+        err = vmaf_feature_extractor_context_extract(fex_ctx, &ref[i], NULL,
+                                                     &dist[i], NULL, i, vfc);
+        mu_assert("problem during vmaf_feature_extractor_context_extract",
+                  !err);
+    }
+    err = vmaf_feature_extractor_context_flush(fex_ctx, vfc);
+    mu_assert("problem during vmaf_feature_extractor_context_flush", !err);
+
+    for (unsigned i = 0; i < n_pics; i++) {
+        for (unsigned j = 0; j < n_names; j++) {
+            err = vmaf_feature_collector_get_score(vfc, names[j],
+                                                   &scores[i * n_names + j], i);
+            mu_assert("problem during vmaf_feature_collector_get_score", !err);
+        }
+    }
+
+    err = vmaf_feature_extractor_context_close(fex_ctx);
+    mu_assert("problem during vmaf_feature_extractor_context_close", !err);
+    err = vmaf_feature_extractor_context_destroy(fex_ctx);
+    mu_assert("problem during vmaf_feature_extractor_context_destroy", !err);
+    vmaf_feature_collector_destroy(vfc);
+    vmaf_set_cpu_flags_mask(~0u);
+
+    return NULL;
+}
+
+static char *extract_with_cpu_mask(const char *fex_name, unsigned cpu_mask,
+                                   VmafPicture *ref, VmafPicture *dist,
+                                   unsigned n_pics, const char **names,
+                                   unsigned n_names, double *scores)
+{
+    return extract_features(fex_name, cpu_mask, NULL, ref, dist, n_pics,
+                            names, n_names, scores);
+}
+
+/*
+ * Check `fex_name` at every SIMD level against its C reference, on `n_pics`
+ * frames at odd sizes for each bit depth in `bpc`. Scores have to be within
+ * `tolerance` of the reference relative to its magnitude, 0 for bit-exact
+ * kernels.
+ */
+static char *check_simd_matches_c(const char *fex_name, const char **names,
+                                  unsigned n_names, const unsigned *bpc,
+                                  unsigned n_bpc, unsigned n_pics,
+                                  double tolerance)
+{
+    const unsigned size[][2] = { { 97, 61 }, { 211, 83 } };
+
+    for (unsigned b = 0; b < n_bpc; b++) {
+        for (unsigned s = 0; s < 2; s++) {
+            const unsigned w = size[s][0], h = size[s][1];
+            VmafPicture ref[n_pics], dist[n_pics];
+            for (unsigned i = 0; i < n_pics; i++) {
+                int err = test_picture_alloc(&ref[i], bpc[b], w, h, 2 * i + 1,
+                                             i ? 2u << (bpc[b] - 8) : 0, 2);
+                err |= test_picture_alloc(&dist[i], bpc[b], w, h, 2 * i + 2,
+                                          4u << (bpc[b] - 8), 2);
+                mu_assert("problem during test_picture_alloc", !err);
+            }
+
+            double expected[n_pics * n_names], scores[n_pics * n_names];
+            char *msg = extract_with_cpu_mask(fex_name, 0, ref, dist, n_pics,
+                                              names, n_names, expected);
+            if (msg) return msg;
+            for (unsigned m = 1; m < N_SIMD_MASKS; m++) {
+                msg = extract_with_cpu_mask(fex_name, simd_masks[m], ref, dist,
+                                            n_pics, names, n_names, scores);
+                if (msg) return msg;
+                for (unsigned i = 0; i < n_pics * n_names; i++) {
+                    const double diff = fabs(scores[i] - expected[i]);
+                    mu_assert("simd scores should match c",
+                              diff <= tolerance * fabs(expected[i]));
+                }
+            }
+
+            for (unsigned i = 0; i < n_pics; i++) {
+                vmaf_picture_unref(&ref[i]);
+                vmaf_picture_unref(&dist[i]);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+static char *test_integer_adm_simd()
+{
+    const char *names[] = {
+        "VMAF_integer_feature_adm2_score",
+        "integer_adm_scale0", "integer_adm_scale1",
+        "integer_adm_scale2", "integer_adm_scale3",
+    };
+    const unsigned bpc[] = { 8, 10, 12 };
+    return check_simd_matches_c("adm", names, 5, bpc, 3, 1, 0.);
+}
+
+static const char *integer_vif_names[] = {
+    "VMAF_integer_feature_vif_scale0_score",
+    "VMAF_integer_feature_vif_scale1_score",
+    "VMAF_integer_feature_vif_scale2_score",
+    "VMAF_integer_feature_vif_scale3_score",
+};
+
+static char *test_integer_vif_simd()
+{
+    const unsigned bpc[] = { 8, 10 };
+    char *msg = check_simd_matches_c("vif", integer_vif_names, 4, bpc, 2, 1,
+                                     0.);
+    if (msg) return msg;
+
+    /* Pictures with differing strides are copied before filtering, planes
+     * read in place have to give the same scores. */
+    for (unsigned b = 0; b < 2; b++) {
+        VmafPicture ref, dist, dist_copy;
+        int err = test_picture_alloc(&ref, bpc[b], 97, 61, 1, 0, 2);
+        err |= test_picture_alloc(&dist, bpc[b], 97, 61, 2,
+                                  4u << (bpc[b] - 8), 2);
+        err |= test_picture_alloc(&dist_copy, bpc[b], 97, 61, 2,
+                                  4u << (bpc[b] - 8), 3);
+        mu_assert("problem during test_picture_alloc", !err);
+
+        for (unsigned m = 0; m < N_SIMD_MASKS; m++) {
+            double in_place[4], copied[4];
+            msg = extract_with_cpu_mask("vif", simd_masks[m], &ref, &dist, 1,
+                                        integer_vif_names, 4, in_place);
+            if (msg) return msg;
+            msg = extract_with_cpu_mask("vif", simd_masks[m], &ref, &dist_copy,
+                                        1, integer_vif_names, 4, copied);
+            if (msg) return msg;
+            for (unsigned i = 0; i < 4; i++) {
+                mu_assert("in place vif should match the copied planes",
+                          in_place[i] == copied[i]);
+            }
+        }
+
+        vmaf_picture_unref(&ref);
+        vmaf_picture_unref(&dist);
+        vmaf_picture_unref(&dist_copy);
+    }
+
+    return NULL;
+}
+
+static char *test_integer_vif_hbd_simd()
+{
+    const unsigned bpc[] = { 12, 16 };
+    return check_simd_matches_c("vif", integer_vif_names, 4, bpc, 2, 1, 0.);
+}
+
+static char *test_integer_motion_simd()
+{
+    const char *names[] = { "VMAF_integer_feature_motion2_score" };
+    const unsigned bpc[] = { 8, 10, 12 };
+    return check_simd_matches_c("motion", names, 1, bpc, 3, 4, 0.);
+}
+
+/*
+ * Float extractors keep their workspaces across frames, scores must not
+ * depend on what the previous frame left in them.
+ */
+static char *test_float_workspace_reuse()
+{
+    const char *fex_name[] = { "float_vif", "float_adm", "float_ms_ssim" };
+    const char *names[] = {
+        "'VMAF_feature_vif_scale0_score'",
+        "'VMAF_feature_adm2_score'",
+        "float_ms_ssim",
+    };
+    const unsigned bpc[] = { 8, 10 };
+
+    for (unsigned b = 0; b < 2; b++) {
+        VmafPicture ref[2], dist[2];
+        for (unsigned i = 0; i < 2; i++) {
+            int err = test_picture_alloc(&ref[i], bpc[b], 257, 181, 2 * i + 1,
+                                         i ? 8u << (bpc[b] - 8) : 0, 2);
+            err |= test_picture_alloc(&dist[i], bpc[b], 257, 181, 2 * i + 2,
+                                      (4u << i) << (bpc[b] - 8), 2);
+            mu_assert("problem during test_picture_alloc", !err);
+        }
+        VmafPicture ref_seq[3] = { ref[0], ref[1], ref[0] };
+        VmafPicture dist_seq[3] = { dist[0], dist[1], dist[0] };
+
+        for (unsigned f = 0; f < 3; f++) {
+            double seq[3], alone;
+            char *msg = extract_with_cpu_mask(fex_name[f], ~0u, ref_seq,
+                                              dist_seq, 3, &names[f], 1, seq);
+            if (msg) return msg;
+            msg = extract_with_cpu_mask(fex_name[f], ~0u, &ref[1], &dist[1],
+                                        1, &names[f], 1, &alone);
+            if (msg) return msg;
+            mu_assert("a frame should score the same after another frame",
+                      seq[1] == alone);
+            mu_assert("a repeated frame should score the same",
+                      seq[2] == seq[0]);
+            mu_assert("distinct frames should score differently",
+                      seq[1] != seq[0]);
+        }
+
+        for (unsigned i = 0; i < 2; i++) {
+            vmaf_picture_unref(&ref[i]);
+            vmaf_picture_unref(&dist[i]);
+        }
+    }
+
+    return NULL;
+}
+
+static char *test_float_vif_simd()
+{
+    const char *names[] = {
+        "'VMAF_feature_vif_scale0_score'", "'VMAF_feature_vif_scale1_score'",
+        "'VMAF_feature_vif_scale2_score'", "'VMAF_feature_vif_scale3_score'",
+    };
+    const unsigned bpc[] = { 8, 10 };
+    /* Float sums are reordered by the vector kernels. */
+    return check_simd_matches_c("float_vif", names, 4, bpc, 2, 1, 1e-4);
+}
+
+/*
+ * Convert to float and back at every SIMD level. The float planes have to
+ * match C exactly without writes past the width, and converting back has to
+ * restore the original pixels of both pictures of a pair.
+ */
+static char *test_picture_copy_simd()
+{
+    const unsigned bpc[] = { 8, 10, 12, 16 };
+    const unsigned w = 97, h = 61;
+    const ptrdiff_t float_stride = ALIGN_CEIL(w * sizeof(float)) + MAX_ALIGN;
+    const size_t n = float_stride / sizeof(float) * h;
+
+    for (unsigned b = 0; b < 4; b++) {
+        VmafPicture pic[2], out[2];
+        int err = 0;
+        for (unsigned i = 0; i < 2; i++) {
+            err |= test_picture_alloc(&pic[i], bpc[b], w, h, i + 1,
+                                      4u << (bpc[b] - 8), 2);
+            err |= test_picture_alloc(&out[i], bpc[b], w, h, 0, 0, 2);
+        }
+        mu_assert("problem during test_picture_alloc", !err);
+
+        float *expected = aligned_malloc(3 * n * sizeof(float), MAX_ALIGN);
+        float *converted = aligned_malloc(3 * n * sizeof(float), MAX_ALIGN);
+        mu_assert("problem during aligned_malloc", expected && converted);
+
+        vmaf_init_cpu();
+        for (unsigned m = 0; m < N_SIMD_MASKS; m++) {
+            vmaf_set_cpu_flags_mask(simd_masks[m]);
+            float *dst = m ? converted : expected;
+            for (unsigned k = 0; k < 3 * n; k++)
+                dst[k] = -1.f;
+            picture_copy(dst, float_stride, &pic[0], -128, bpc[b]);
+            picture_copy(dst + n, float_stride, &pic[0], 0, bpc[b]);
+            picture_copy(dst + 2 * n, float_stride, &pic[1], 0, bpc[b]);
+            if (m) {
+                mu_assert("simd picture_copy should match c",
+                          !memcmp(converted, expected, 3 * n * sizeof(float)));
+            }
+
+            picture_copy_from_float_pair(&out[0], &out[1], dst + n,
+                                         dst + 2 * n, float_stride, bpc[b]);
+            for (unsigned i = 0; i < 2; i++) {
+                const size_t row = (bpc[b] > 8 ? 2 : 1) * w;
+                for (unsigned y = 0; y < h; y++) {
+                    const uint8_t *a =
+                        (uint8_t *) pic[i].data[0] + y * pic[i].stride[0];
+                    const uint8_t *c =
+                        (uint8_t *) out[i].data[0] + y * out[i].stride[0];
+                    mu_assert("converting back should restore the pixels",
+                              !memcmp(a, c, row));
+                }
+                memset(out[i].data[0], 0, out[i].stride[0] * h);
+            }
+        }
+        vmaf_set_cpu_flags_mask(~0u);
+
+        aligned_free(expected);
+        aligned_free(converted);
+        for (unsigned i = 0; i < 2; i++) {
+            vmaf_picture_unref(&pic[i]);
+            vmaf_picture_unref(&out[i]);
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Integer vif and adm split a frame into row bands on the thread pool, the
+ * scores have to match a single band exactly. None of the heights is a
+ * multiple of the band count.
+ */
+static char *test_integer_banded_extraction()
+{
+    const char *fex_name[] = { "vif", "adm" };
+    const char *names[][5] = {
+        {
+            "VMAF_integer_feature_vif_scale0_score",
+            "VMAF_integer_feature_vif_scale1_score",
+            "VMAF_integer_feature_vif_scale2_score",
+            "VMAF_integer_feature_vif_scale3_score",
+        },
+        {
+            "VMAF_integer_feature_adm2_score",
+            "integer_adm_scale0", "integer_adm_scale1",
+            "integer_adm_scale2", "integer_adm_scale3",
+        },
+    };
+    const unsigned n_names[] = { 4, 5 };
+    const unsigned n_threads[] = { 3, 4 };
+    const unsigned bpc[] = { 8, 10 };
+
+    for (unsigned b = 0; b < 2; b++) {
+        VmafPicture ref, dist;
+        int err = test_picture_alloc(&ref, bpc[b], 211, 83, 1, 0, 2);
+        err |= test_picture_alloc(&dist, bpc[b], 211, 83, 2,
+                                  4u << (bpc[b] - 8), 2);
+        mu_assert("problem during test_picture_alloc", !err);
+
+        for (unsigned f = 0; f < 2; f++) {
+            double expected[5], scores[5];
+            char *msg = extract_features(fex_name[f], ~0u, NULL, &ref, &dist,
+                                         1, names[f], n_names[f], expected);
+            if (msg) return msg;
+
+            for (unsigned t = 0; t < 2; t++) {
+                VmafThreadPool *pool;
+                err = vmaf_thread_pool_create(&pool, n_threads[t]);
+                mu_assert("problem during vmaf_thread_pool_create", !err);
+                msg = extract_features(fex_name[f], ~0u, pool, &ref, &dist, 1,
+                                       names[f], n_names[f], scores);
+                if (msg) return msg;
+                err = vmaf_thread_pool_destroy(pool);
+                mu_assert("problem during vmaf_thread_pool_destroy", !err);
+                for (unsigned i = 0; i < n_names[f]; i++) {
+                    mu_assert("banded extraction should match a single band",
+                              scores[i] == expected[i]);
+                }
+            }
+        }
+
+        vmaf_picture_unref(&ref);
+        vmaf_picture_unref(&dist);
+    }
+
+    return NULL;
+}
+
 char *run_tests()
 {
     mu_run_test(test_get_feature_extractor_by_name_and_feature_name);
     mu_run_test(test_feature_extractor_context_pool);
     mu_run_test(test_feature_extractor_flush);
     mu_run_test(test_feature_extractor_initialization_options);
+    mu_run_test(test_integer_adm_simd);
+    mu_run_test(test_integer_vif_simd);
+    mu_run_test(test_integer_vif_hbd_simd);
+    mu_run_test(test_integer_motion_simd);
+    mu_run_test(test_float_workspace_reuse);
+    mu_run_test(test_float_vif_simd);
+    mu_run_test(test_picture_copy_simd);
+    mu_run_test(test_integer_banded_extraction);
     return NULL;
 }
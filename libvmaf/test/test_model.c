@@ -16,7 +16,12 @@
  *
  */
 
+#include <errno.h>
+#include <pthread.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
 
 #include "config.h"
 #include "test.h"
@@ -310,6 +315,211 @@ static char *test_model_set_flags()
     return NULL;
 }
 
+static int svr_compare(VmafSvr *svr_a, VmafSvr *svr_b, unsigned n_features)
+{
+    int err = 0;
+
+    err += svr_a->n_sv != svr_b->n_sv;
+    err += svr_a->gamma != svr_b->gamma;
+    err += svr_a->rho != svr_b->rho;
+    if (err) return err;
+
+    double x[4 * n_features];
+    for (unsigned i = 0; i < 4 * n_features; i++)
+        x[i] = (i % 7) / 7.;
+
+    double y_a[4], y_b[4];
+    vmaf_svr_predict(svr_a, x, y_a, 4);
+    vmaf_svr_predict(svr_b, x, y_b, 4);
+    for (unsigned i = 0; i < 4; i++)
+        err += y_a[i] != y_b[i];
+
+    return err;
+}
+
+static char *test_binary_model()
+{
+    int err = 0;
+
+    VmafModel *model_json;
+    VmafModelConfig cfg_json = { .flags = VMAF_MODEL_FLAG_ENABLE_TRANSFORM };
+    const char *path_json = "../../model/vmaf_v0.6.1neg.json";
+    err = vmaf_model_load_from_path(&model_json, &cfg_json, path_json);
+    mu_assert("problem during vmaf_model_load_from_path", !err);
+
+    char dir[] = "/tmp/vmaf_test_XXXXXX";
+    mu_assert("problem during mkdtemp", mkdtemp(dir));
+    char path[sizeof(dir) + 64];
+    snprintf(path, sizeof(path), "%s/test_binary_model.vmafb", dir);
+    err = vmaf_model_write_binary(model_json, NULL, path);
+    mu_assert("problem during vmaf_model_write_binary", !err);
+
+    VmafModel *model;
+    VmafModelConfig cfg = { .flags = VMAF_MODEL_FLAG_ENABLE_TRANSFORM };
+    err = vmaf_model_load_from_path(&model, &cfg, path);
+    mu_assert("problem during vmaf_model_load_from_path", !err);
+    mu_assert("binary model should be memory-mapped", model->map && !model->svm);
+
+    err = model_compare(model_json, model);
+    mu_assert("json/binary models do not match", !err);
+    mu_assert("score transform should be enabled",
+              model->score_transform.enabled);
+    for (unsigned i = 0; i < model->n_features; i++) {
+        mu_assert("feature names do not match",
+                  !strcmp(model_json->feature[i].name, model->feature[i].name));
+    }
+    const VmafDictionaryEntry *entry =
+        vmaf_dictionary_get(&model->feature[0].opts_dict,
+                            "adm_enhn_gain_limit", 0);
+    mu_assert("feature[0].opts_dict[\"adm_enhn_gain_limit\"] must be 1.0",
+              entry && !strcmp(entry->val, "1.0"));
+    err = svr_compare(model_json->svr, model->svr, model->n_features);
+    mu_assert("json/binary model predictions do not match", !err);
+
+    VmafModel *model_default;
+    VmafModelConfig cfg_default = { .flags = VMAF_MODEL_FLAG_DISABLE_CLIP };
+    err = vmaf_model_load_from_path(&model_default, &cfg_default, path);
+    mu_assert("problem during vmaf_model_load_from_path", !err);
+    mu_assert("flags should be applied at load time",
+              !model_default->score_clip.enabled &&
+              !model_default->score_transform.enabled);
+
+    vmaf_model_destroy(model_default);
+    vmaf_model_destroy(model);
+    vmaf_model_destroy(model_json);
+    remove(path);
+    rmdir(dir);
+    return NULL;
+}
+
+static char *test_binary_model_collection()
+{
+    int err = 0;
+
+    const char *path_json = "../../model/vmaf_b_v0.6.3.json";
+    VmafModel *model_json;
+    VmafModelCollection *model_collection_json = NULL;
+    VmafModelConfig cfg_json = { 0 };
+    err = vmaf_model_collection_load_from_path(&model_json,
+                                               &model_collection_json,
+                                               &cfg_json, path_json);
+    mu_assert("problem during vmaf_model_collection_load_from_path", !err);
+
+    char dir[] = "/tmp/vmaf_test_XXXXXX";
+    mu_assert("problem during mkdtemp", mkdtemp(dir));
+    char path[sizeof(dir) + 64];
+    snprintf(path, sizeof(path), "%s/test_binary_model_collection.vmafb", dir);
+    err = vmaf_model_write_binary(model_json, model_collection_json, path);
+    mu_assert("problem during vmaf_model_write_binary", !err);
+
+    VmafModel *model;
+    VmafModelConfig cfg = { 0 };
+    err = vmaf_model_load_from_path(&model, &cfg, path);
+    mu_assert("a binary model collection should not load as a model",
+              err == -EAGAIN);
+
+    VmafModelCollection *model_collection = NULL;
+    err = vmaf_model_collection_load_from_path(&model, &model_collection,
+                                               &cfg, path);
+    mu_assert("problem during vmaf_model_collection_load_from_path", !err);
+    mu_assert("model collections should be the same size",
+              model_collection->cnt == model_collection_json->cnt);
+    mu_assert("model collection names do not match",
+              !strcmp(model_collection->name, model_collection_json->name));
+    mu_assert("model collection types do not match",
+              model_collection->type == model_collection_json->type);
+
+    err = model_compare(model_json, model);
+    err += svr_compare(model_json->svr, model->svr, model->n_features);
+    for (unsigned i = 0; i < model_collection->cnt; i++) {
+        VmafModel *m_json = model_collection_json->model[i];
+        VmafModel *m = model_collection->model[i];
+        err += model_compare(m_json, m);
+        err += svr_compare(m_json->svr, m->svr, m->n_features);
+        err += strcmp(m_json->name, m->name) != 0;
+        err += m->map != model->map;
+    }
+    mu_assert("json/binary model collections do not match", !err);
+
+    // submodels keep the mapping alive
+    vmaf_model_destroy(model);
+    mu_assert("model collection should still be mapped",
+              model_collection->model[0]->svr->coef[0] ==
+              model_collection_json->model[0]->svr->coef[0]);
+
+    vmaf_model_collection_destroy(model_collection);
+    vmaf_model_collection_destroy(model_collection_json);
+    vmaf_model_destroy(model_json);
+    remove(path);
+    rmdir(dir);
+    return NULL;
+}
+
+static void *load_shared_model(void *data)
+{
+    VmafModel **model = data;
+    VmafModelConfig cfg = { .flags = VMAF_MODEL_FLAG_SHARED };
+    const char *path = "../../model/vmaf_v0.6.1.json";
+    if (vmaf_model_load_from_path(model, &cfg, path))
+        *model = NULL;
+    return NULL;
+}
+
+static char *test_shared_model()
+{
+    int err = 0;
+
+    pthread_t thread[8];
+    VmafModel *model[8];
+    for (unsigned i = 0; i < 8; i++)
+        pthread_create(&thread[i], NULL, load_shared_model, &model[i]);
+    for (unsigned i = 0; i < 8; i++)
+        pthread_join(thread[i], NULL);
+    for (unsigned i = 0; i < 8; i++) {
+        mu_assert("problem during vmaf_model_load_from_path", model[i]);
+        mu_assert("a shared model should only be loaded once",
+                  model[i] == model[0]);
+    }
+
+    VmafModel *model_named;
+    VmafModelConfig cfg_named = {
+        .name = "named",
+        .flags = VMAF_MODEL_FLAG_SHARED,
+    };
+    const char *path = "../../model/vmaf_v0.6.1.json";
+    err = vmaf_model_load_from_path(&model_named, &cfg_named, path);
+    mu_assert("problem during vmaf_model_load_from_path", !err);
+    mu_assert("models with different configs should not be shared",
+              model_named != model[0]);
+
+    VmafModel *model_collection_model[2];
+    VmafModelCollection *model_collection[2];
+    VmafModelConfig cfg_collection = { .flags = VMAF_MODEL_FLAG_SHARED };
+    const char *path_collection = "../../model/vmaf_b_v0.6.3.json";
+    for (unsigned i = 0; i < 2; i++) {
+        err = vmaf_model_collection_load_from_path(&model_collection_model[i],
+                                                   &model_collection[i],
+                                                   &cfg_collection,
+                                                   path_collection);
+        mu_assert("problem during vmaf_model_collection_load_from_path", !err);
+    }
+    mu_assert("a shared model collection should only be loaded once",
+              model_collection[0] == model_collection[1] &&
+              model_collection_model[0] == model_collection_model[1]);
+
+    for (unsigned i = 0; i < 8; i++)
+        vmaf_model_destroy(model[i]);
+    vmaf_model_destroy(model_named);
+    for (unsigned i = 0; i < 2; i++) {
+        vmaf_model_destroy(model_collection_model[i]);
+        vmaf_model_collection_destroy(model_collection[i]);
+    }
+    mu_assert("released models should leave the registry",
+              !model_registry.entry);
+
+    return NULL;
+}
+
 char *run_tests()
 {
     mu_run_test(test_json_model);
@@ -321,5 +531,8 @@ char *run_tests()
     mu_run_test(test_model_check_default_behavior_unset_flags);
     mu_run_test(test_model_check_default_behavior_set_flags);
     mu_run_test(test_model_set_flags);
+    mu_run_test(test_binary_model);
+    mu_run_test(test_binary_model_collection);
+    mu_run_test(test_shared_model);
     return NULL;
 }
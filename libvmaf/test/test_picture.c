@@ -16,9 +16,11 @@
  *
  */
 
+#include <errno.h>
 #include <stdint.h>
 
 #include "test.h"
+#include "mem.h"
 #include "picture.h"
 #include "libvmaf/picture.h"
 #include "ref.h"
@@ -65,9 +67,237 @@ static char *test_picture_data_alignment()
     return NULL;
 }
 
+static char *test_picture_pool()
+{
+    int err;
+
+    VmafPicturePool *pool;
+    VmafPicturePoolConfig cfg = {
+        .pic_cnt = 2,
+        .pix_fmt = VMAF_PIX_FMT_YUV420P,
+        .bpc = 10,
+        .w = 64,
+        .h = 32,
+    };
+    err = vmaf_picture_pool_create(&pool, cfg);
+    mu_assert("problem during vmaf_picture_pool_create", !err);
+
+    VmafPicture pic_a, pic_b, pic_c;
+    err = vmaf_picture_pool_fetch(pool, &pic_a);
+    err |= vmaf_picture_pool_fetch(pool, &pic_b);
+    mu_assert("problem during vmaf_picture_pool_fetch", !err);
+    mu_assert("fetched pictures should be distinct",
+              pic_a.data[0] != pic_b.data[0]);
+    mu_assert("fetched picture should match the pool geometry",
+              pic_a.w[0] == 64 && pic_a.h[1] == 16 && pic_a.bpc == 10);
+    mu_assert("pic_a.ref->cnt should be 1", vmaf_ref_load(pic_a.ref) == 1);
+
+    ((uint16_t *) pic_a.data[0])[0] = 1023;
+    void *data = pic_a.data[0];
+    err = vmaf_picture_ref(&pic_c, &pic_a);
+    err |= vmaf_picture_unref(&pic_a);
+    mu_assert("problem during vmaf_picture_unref", !err);
+    err = vmaf_picture_unref(&pic_c);
+    mu_assert("problem during vmaf_picture_unref", !err);
+
+    err = vmaf_picture_pool_fetch(pool, &pic_a);
+    mu_assert("problem during vmaf_picture_pool_fetch", !err);
+    mu_assert("picture should be recycled once unreferenced",
+              pic_a.data[0] == data);
+    mu_assert("recycled picture should keep its contents",
+              ((uint16_t *) pic_a.data[0])[0] == 1023);
+    mu_assert("pic_a.ref->cnt should be 1", vmaf_ref_load(pic_a.ref) == 1);
+
+    /* Outstanding pictures keep the pool alive. */
+    err = vmaf_picture_pool_destroy(pool);
+    mu_assert("problem during vmaf_picture_pool_destroy", !err);
+    err = vmaf_picture_unref(&pic_a);
+    err |= vmaf_picture_unref(&pic_b);
+    mu_assert("problem during vmaf_picture_unref", !err);
+
+    cfg.pic_cnt = 1;
+    cfg.flags = VMAF_PICTURE_POOL_FLAG_CLEAR;
+    err = vmaf_picture_pool_create(&pool, cfg);
+    mu_assert("problem during vmaf_picture_pool_create", !err);
+    err = vmaf_picture_pool_fetch(pool, &pic_a);
+    mu_assert("problem during vmaf_picture_pool_fetch", !err);
+    ((uint16_t *) pic_a.data[2])[0] = 1023;
+    err = vmaf_picture_unref(&pic_a);
+    err |= vmaf_picture_pool_fetch(pool, &pic_a);
+    mu_assert("problem during vmaf_picture_pool_fetch", !err);
+    mu_assert("VMAF_PICTURE_POOL_FLAG_CLEAR should zero recycled pictures",
+              ((uint16_t *) pic_a.data[2])[0] == 0);
+    err = vmaf_picture_unref(&pic_a);
+    err |= vmaf_picture_pool_destroy(pool);
+    mu_assert("problem during cleanup", !err);
+
+    return NULL;
+}
+
+static unsigned released_cnt;
+
+static void release(void *cookie)
+{
+    (void) cookie;
+    released_cnt++;
+}
+
+static char *test_picture_wrap()
+{
+    int err;
+
+    /* 16x8 yuv420p, 10-bit, one plane per buffer. */
+    uint16_t *buf[3];
+    ptrdiff_t stride[3] = { 64, 64, 64 };
+    for (unsigned i = 0; i < 3; i++) {
+        buf[i] = aligned_malloc(stride[i] * 8, 32);
+        mu_assert("problem during aligned_malloc", buf[i]);
+        for (unsigned j = 0; j < stride[i] * 8 / 2; j++)
+            buf[i][j] = j;
+    }
+    void *data[3] = { buf[0], buf[1], buf[2] };
+
+    VmafPicture pic_a, pic_b;
+    released_cnt = 0;
+    err = vmaf_picture_wrap(&pic_a, VMAF_PIX_FMT_YUV420P, 10, 16, 8,
+                            data, stride, release, NULL);
+    mu_assert("problem during vmaf_picture_wrap", !err);
+    mu_assert("wrapped picture should use the caller's planes",
+              pic_a.data[1] == buf[1] && pic_a.stride[0] == 64);
+    mu_assert("chroma planes should be subsampled",
+              pic_a.w[1] == 8 && pic_a.h[2] == 4);
+    err = vmaf_picture_ensure_aligned(&pic_a);
+    mu_assert("aligned planes should not be copied",
+              !err && pic_a.data[0] == buf[0]);
+    err = vmaf_picture_ref(&pic_b, &pic_a);
+    err |= vmaf_picture_unref(&pic_a);
+    mu_assert("problem during vmaf_picture_unref", !err);
+    mu_assert("planes should not be released while referenced", !released_cnt);
+    err = vmaf_picture_unref(&pic_b);
+    mu_assert("problem during vmaf_picture_unref", !err);
+    mu_assert("planes should be released exactly once", released_cnt == 1);
+
+    /* An odd offset forces a copy, which releases the planes right away. */
+    void *unaligned[3] = { buf[0] + 1, buf[1] + 1, buf[2] + 1 };
+    const ptrdiff_t unaligned_stride[3] = { 62, 62, 62 };
+    err = vmaf_picture_wrap(&pic_a, VMAF_PIX_FMT_YUV420P, 10, 15, 8,
+                            unaligned, unaligned_stride, release, NULL);
+    mu_assert("problem during vmaf_picture_wrap", !err);
+    err = vmaf_picture_ensure_aligned(&pic_a);
+    mu_assert("problem during vmaf_picture_ensure_aligned", !err);
+    mu_assert("unaligned planes should be released after the copy",
+              released_cnt == 2);
+    mu_assert("copy should be aligned",
+              !(((uintptr_t) pic_a.data[0]) % 32) && !(pic_a.stride[1] % 32));
+    for (unsigned i = 0; i < 3; i++) {
+        for (unsigned y = 0; y < pic_a.h[i]; y++) {
+            uint16_t *row = (uint16_t *) pic_a.data[i] + y * pic_a.stride[i] / 2;
+            for (unsigned x = 0; x < pic_a.w[i]; x++) {
+                mu_assert("copy should match the wrapped planes",
+                          row[x] == y * unaligned_stride[i] / 2 + x + 1);
+            }
+        }
+    }
+    err = vmaf_picture_unref(&pic_a);
+    mu_assert("problem during vmaf_picture_unref", !err);
+    mu_assert("the copy should not release the planes again",
+              released_cnt == 2);
+
+    for (unsigned i = 0; i < 3; i++)
+        aligned_free(buf[i]);
+
+    return NULL;
+}
+
+static unsigned fill_cnt;
+
+static int fill(void *data, VmafPicture *pic, int key)
+{
+    fill_cnt++;
+    ((int *) data)[0] = ((uint8_t *) pic->data[0])[0] + key;
+    return 0;
+}
+
+static int fill_fail(void *data, VmafPicture *pic, int key)
+{
+    (void) data;
+    (void) pic;
+    (void) key;
+    return -EINVAL;
+}
+
+static char *test_picture_cache()
+{
+    int err;
+
+    VmafPicture pic_a, pic_b;
+    err = vmaf_picture_alloc(&pic_a, VMAF_PIX_FMT_YUV420P, 8, 64, 32);
+    mu_assert("problem during vmaf_picture_alloc", !err);
+    ((uint8_t *) pic_a.data[0])[0] = 100;
+    err = vmaf_picture_ref(&pic_b, &pic_a);
+    mu_assert("problem during vmaf_picture_ref", !err);
+
+    fill_cnt = 0;
+    int *a = vmaf_picture_cache_fetch(&pic_a, -1, 64, fill);
+    int *b = vmaf_picture_cache_fetch(&pic_b, -1, 64, fill);
+    mu_assert("cached entry should be filled", a && a[0] == 99);
+    mu_assert("cached entry should be aligned", !(((uintptr_t) a) % 32));
+    mu_assert("holders of a picture should share an entry",
+              a == b && fill_cnt == 1);
+    int *c = vmaf_picture_cache_fetch(&pic_b, 1, 64, fill);
+    mu_assert("entries should be keyed", c && c != a && c[0] == 101);
+    mu_assert("a new key should be filled", fill_cnt == 2);
+    mu_assert("a failed fill should return NULL",
+              !vmaf_picture_cache_fetch(&pic_a, -1, 64, fill_fail));
+    err = vmaf_picture_unref(&pic_a);
+    err |= vmaf_picture_unref(&pic_b);
+    mu_assert("problem during vmaf_picture_unref", !err);
+
+    /* Recycled pool pictures start over with an empty cache. */
+    VmafPicturePool *pool;
+    VmafPicturePoolConfig cfg = {
+        .pic_cnt = 1,
+        .pix_fmt = VMAF_PIX_FMT_YUV420P,
+        .bpc = 8,
+        .w = 64,
+        .h = 32,
+    };
+    err = vmaf_picture_pool_create(&pool, cfg);
+    err |= vmaf_picture_pool_fetch(pool, &pic_a);
+    mu_assert("problem during vmaf_picture_pool_fetch", !err);
+    ((uint8_t *) pic_a.data[0])[0] = 1;
+    a = vmaf_picture_cache_fetch(&pic_a, 0, 64, fill);
+    mu_assert("cached entry should be filled", a && a[0] == 1);
+    err = vmaf_picture_unref(&pic_a);
+    err |= vmaf_picture_pool_fetch(pool, &pic_a);
+    mu_assert("problem during vmaf_picture_pool_fetch", !err);
+    ((uint8_t *) pic_a.data[0])[0] = 2;
+    fill_cnt = 0;
+    b = vmaf_picture_cache_fetch(&pic_a, 0, 64, fill);
+    mu_assert("recycled picture should be filled again",
+              b && b[0] == 2 && fill_cnt == 1);
+    mu_assert("recycled picture should reuse the entry's data", b == a);
+    c = vmaf_picture_cache_fetch(&pic_a, 1, 128, fill);
+    mu_assert("a larger entry should get new data", c && c != a);
+    err = vmaf_picture_unref(&pic_a);
+    err |= vmaf_picture_pool_fetch(pool, &pic_a);
+    mu_assert("problem during vmaf_picture_pool_fetch", !err);
+    b = vmaf_picture_cache_fetch(&pic_a, 2, 32, fill);
+    mu_assert("a smaller entry should reuse spare data",
+              b && (b == a || b == c));
+    err = vmaf_picture_unref(&pic_a);
+    err |= vmaf_picture_pool_destroy(pool);
+    mu_assert("problem during cleanup", !err);
+
+    return NULL;
+}
+
 char *run_tests()
 {
     mu_run_test(test_picture_alloc_ref_and_unref);
     mu_run_test(test_picture_data_alignment);
+    mu_run_test(test_picture_pool);
+    mu_run_test(test_picture_wrap);
+    mu_run_test(test_picture_cache);
     return NULL;
 }
@@ -16,10 +16,17 @@
  *
  */
 
+#include <math.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "test.h"
+#include "cpu.h"
+#include "feature/alias.h"
 #include "predict.h"
+#include "svm.h"
+#include "svr.h"
 
 #include <libvmaf/model.h>
 
@@ -56,8 +63,311 @@ static char *test_predict_score_at_index()
     return NULL;
 }
 
+static char *test_svr_matches_libsvm()
+{
+    int err;
+
+    VmafModel *model;
+    VmafModelConfig cfg = {
+        .name = "vmaf",
+        .flags = VMAF_MODEL_FLAGS_DEFAULT,
+    };
+    const char *path = "../../model/vmaf_float_v0.6.1.pkl";
+    err = vmaf_model_load_from_path(&model, &cfg, path);
+    mu_assert("problem during vmaf_model_load_from_path", !err);
+    mu_assert("an rbf nusvr model should have a dense svr", model->svr);
+    mu_assert("svr and model should agree on the feature count",
+              model->svr->n_features == model->n_features);
+
+    const unsigned n_features = model->n_features;
+    const unsigned n = 11;
+    double x[n * n_features], expected[n], y[n];
+    for (unsigned j = 0; j < n; j++) {
+        struct svm_node node[n_features + 1];
+        for (unsigned i = 0; i < n_features; i++) {
+            node[i].index = i + 1;
+            node[i].value = x[j * n_features + i] =
+                ((j * 37 + i * 11) % 101) / 100.;
+        }
+        node[n_features].index = -1;
+        expected[j] = svm_predict(model->svm, node);
+    }
+
+    vmaf_set_cpu_flags_mask(0);
+    vmaf_svr_predict(model->svr, x, y, n);
+    for (unsigned j = 0; j < n; j++)
+        mu_assert("scalar svr should match libsvm exactly", y[j] == expected[j]);
+
+    vmaf_init_cpu();
+    vmaf_set_cpu_flags_mask(~0);
+    vmaf_svr_predict(model->svr, x, y, n);
+    for (unsigned j = 0; j < n; j++) {
+        mu_assert("simd svr should match libsvm",
+                  fabs(y[j] - expected[j]) <= 1e-12 * (1. + fabs(expected[j])));
+    }
+
+    vmaf_model_destroy(model);
+    return NULL;
+}
+
+static char *test_predict_score_at_indices()
+{
+    int err;
+
+    VmafFeatureCollector *feature_collector;
+    err = vmaf_feature_collector_init(&feature_collector);
+    mu_assert("problem during vmaf_feature_collector_init", !err);
+
+    VmafModel *model;
+    VmafModelConfig cfg = {
+        .name = "vmaf",
+        .flags = VMAF_MODEL_FLAGS_DEFAULT,
+    };
+    const char *path = "../../model/vmaf_float_v0.6.1.pkl";
+    err = vmaf_model_load_from_path(&model, &cfg, path);
+    mu_assert("problem during vmaf_model_load_from_path", !err);
+
+    const unsigned n = 70;
+    unsigned index[n];
+    for (unsigned j = 0; j < n; j++) {
+        index[j] = j;
+        for (unsigned i = 0; i < model->n_features; i++) {
+            err = vmaf_feature_collector_append(feature_collector,
+                                                model->feature[i].name,
+                                                (j % 7) / 7. + i, j);
+            mu_assert("problem during vmaf_feature_collector_append", !err);
+        }
+    }
+
+    double score[n];
+    err = vmaf_predict_score_at_indices(model, feature_collector, index, n,
+                                        score, true, 0);
+    mu_assert("problem during vmaf_predict_score_at_indices", !err);
+
+    for (unsigned j = 0; j < n; j++) {
+        double s;
+        err = vmaf_predict_score_at_index(model, feature_collector, j, &s,
+                                          false, 0);
+        mu_assert("problem during vmaf_predict_score_at_index", !err);
+        mu_assert("batched and single frame predictions should match",
+                  s == score[j]);
+        err = vmaf_feature_collector_get_score(feature_collector, "vmaf",
+                                               &s, j);
+        mu_assert("batched prediction should have been written",
+                  !err && s == score[j]);
+    }
+
+    vmaf_model_destroy(model);
+    vmaf_feature_collector_destroy(feature_collector);
+    return NULL;
+}
+
+/* The per-submodel loop bootstrap prediction used before it was folded into a
+ * single pass, kept here as the reference. */
+static void transform_and_clip(const VmafModel *model, double *prediction)
+{
+    double p = *prediction;
+
+    if (model->score_transform.enabled) {
+        double value = 0.;
+        if (model->score_transform.p0.enabled)
+            value += model->score_transform.p0.value;
+        if (model->score_transform.p1.enabled)
+            value += model->score_transform.p1.value * p;
+        if (model->score_transform.p2.enabled)
+            value += model->score_transform.p2.value * p * p;
+        if (model->score_transform.out_lte_in)
+            value = (value > p) ? p : value;
+        if (model->score_transform.out_gte_in)
+            value = (value < p) ? p : value;
+        p = value;
+    }
+
+    if (model->score_clip.enabled) {
+        p = (p < model->score_clip.min) ? model->score_clip.min : p;
+        p = (p > model->score_clip.max) ? model->score_clip.max : p;
+    }
+
+    *prediction = p;
+}
+
+static int double_compare(const void *a, const void *b)
+{
+    const double *x = a;
+    const double *y = b;
+    return (*x > *y) - (*x < *y);
+}
+
+static double reference_percentile(double *scores, unsigned n_scores,
+                                   double perc)
+{
+    const double p = perc * (n_scores - 1) / 100.;
+    const int idx_l = floor(p);
+    const int idx_r = ceil(p);
+
+    return (idx_l == idx_r) ? scores[idx_l] :
+        scores[idx_l] * (idx_r - p) + scores[idx_r] * (p - idx_l);
+}
+
+static int reference_bootstrap_score(VmafModelCollection *model_collection,
+                                     VmafFeatureCollector *feature_collector,
+                                     unsigned index, double *clipped,
+                                     VmafModelCollectionScore *score)
+{
+    int err = 0;
+    const unsigned cnt = model_collection->cnt;
+    double scores[cnt];
+
+    for (unsigned i = 0; i < cnt; i++) {
+        err = vmaf_predict_score_at_index(model_collection->model[i],
+                                          feature_collector, index,
+                                          &scores[i], false,
+                                          VMAF_MODEL_FLAG_DISABLE_CLIP |
+                                          VMAF_MODEL_FLAG_DISABLE_TRANSFORM);
+        if (err) return err;
+        err = vmaf_predict_score_at_index(model_collection->model[i],
+                                          feature_collector, index,
+                                          &clipped[i], false, 0);
+        if (err) return err;
+    }
+
+    double sum = 0.;
+    for (unsigned i = 0; i < cnt; i++)
+        sum += scores[i];
+    const double mean = sum / cnt;
+
+    double ssd = 0.;
+    for (unsigned i = 0; i < cnt; i++)
+        ssd += pow(scores[i] - mean, 2);
+
+    qsort(scores, cnt, sizeof(double), double_compare);
+    score->bootstrap.bagging_score = mean;
+    score->bootstrap.stddev = sqrt(ssd / cnt);
+    score->bootstrap.ci.p95.lo = reference_percentile(scores, cnt, 2.5);
+    score->bootstrap.ci.p95.hi = reference_percentile(scores, cnt, 97.5);
+
+    const double delta = 0.01;
+    double plus = mean + delta, minus = mean - delta;
+    const VmafModel *model = model_collection->model[0];
+    transform_and_clip(model, &score->bootstrap.bagging_score);
+    transform_and_clip(model, &score->bootstrap.ci.p95.lo);
+    transform_and_clip(model, &score->bootstrap.ci.p95.hi);
+    transform_and_clip(model, &plus);
+    transform_and_clip(model, &minus);
+    score->bootstrap.stddev *= (plus - minus) / (2.0 * delta);
+
+    return 0;
+}
+
+static char *test_bootstrap_matches_per_model_prediction()
+{
+    int err;
+
+    VmafFeatureCollector *feature_collector;
+    err = vmaf_feature_collector_init(&feature_collector);
+    mu_assert("problem during vmaf_feature_collector_init", !err);
+
+    VmafModel *model;
+    VmafModelCollection *model_collection = NULL;
+    VmafModelConfig cfg = {
+        .name = "vmaf",
+        .flags = VMAF_MODEL_FLAG_ENABLE_TRANSFORM,
+    };
+    const char *path = "../../model/vmaf_float_b_v0.6.3.json";
+    err = vmaf_model_collection_load_from_path(&model, &model_collection,
+                                               &cfg, path);
+    mu_assert("problem during vmaf_model_collection_load_from_path", !err);
+    mu_assert("the model collection should have several submodels",
+              model_collection->cnt > 1);
+    mu_assert("the transform should be exercised",
+              model->score_transform.enabled);
+
+    // more frames than a single batch, features spread over a usable range
+    const unsigned n = 70;
+    unsigned index[n];
+    for (unsigned j = 0; j < n; j++) {
+        index[j] = j;
+        for (unsigned i = 0; i < model->n_features; i++) {
+            const char *name =
+                vmaf_internal_feature_name_alias(model->feature[i].name);
+            const double value = strstr(name, "motion2") ?
+                (j % 11) * 2. : 0.3 + 0.07 * ((j + 3 * i) % 10);
+            err = vmaf_feature_collector_append(feature_collector, name,
+                                                value, j);
+            mu_assert("problem during vmaf_feature_collector_append", !err);
+        }
+    }
+
+    VmafModelCollectionScore score[n];
+    err = vmaf_predict_score_at_indices_model_collection(model_collection,
+                                                         feature_collector,
+                                                         index, n, score);
+    mu_assert("problem during "
+              "vmaf_predict_score_at_indices_model_collection", !err);
+
+    const char *suffix[] = {
+        "_bagging", "_stddev", "_ci_p95_lo", "_ci_p95_hi",
+    };
+    char name[64];
+    bool spread = false;
+
+    for (unsigned j = 0; j < n; j++) {
+        double clipped[model_collection->cnt];
+        VmafModelCollectionScore expected;
+        err = reference_bootstrap_score(model_collection, feature_collector,
+                                        j, clipped, &expected);
+        mu_assert("problem during reference_bootstrap_score", !err);
+
+        mu_assert("score type should be bootstrap",
+                  score[j].type == VMAF_MODEL_COLLECTION_SCORE_BOOTSTRAP);
+        const double got[] = {
+            score[j].bootstrap.bagging_score,
+            score[j].bootstrap.stddev,
+            score[j].bootstrap.ci.p95.lo,
+            score[j].bootstrap.ci.p95.hi,
+        };
+        const double want[] = {
+            expected.bootstrap.bagging_score,
+            expected.bootstrap.stddev,
+            expected.bootstrap.ci.p95.lo,
+            expected.bootstrap.ci.p95.hi,
+        };
+        for (unsigned k = 0; k < 4; k++) {
+            mu_assert("single pass and per-model bootstrap should match",
+                      fabs(got[k] - want[k]) <= 1e-9 * fmax(1., fabs(want[k])));
+            double s;
+            snprintf(name, sizeof(name), "%s%s", model_collection->name,
+                     suffix[k]);
+            err = vmaf_feature_collector_get_score(feature_collector, name,
+                                                   &s, j);
+            mu_assert("bootstrap score should have been written",
+                      !err && s == got[k]);
+        }
+        spread |= expected.bootstrap.stddev > 0.;
+
+        for (unsigned i = 0; i < model_collection->cnt; i++) {
+            double s;
+            err = vmaf_feature_collector_get_score(feature_collector,
+                                            model_collection->model[i]->name,
+                                            &s, j);
+            mu_assert("submodel score should have been written", !err);
+            mu_assert("written submodel score should match its prediction",
+                      fabs(s - clipped[i]) <=
+                      1e-9 * fmax(1., fabs(clipped[i])));
+        }
+    }
+    mu_assert("submodels should disagree on some frames", spread);
+
+    vmaf_model_collection_destroy(model_collection);
+    vmaf_feature_collector_destroy(feature_collector);
+    return NULL;
+}
+
 char *run_tests()
 {
     mu_run_test(test_predict_score_at_index);
+    mu_run_test(test_svr_matches_libsvm);
+    mu_run_test(test_predict_score_at_indices);
+    mu_run_test(test_bootstrap_matches_per_model_prediction);
     return NULL;
 }
@@ -0,0 +1,153 @@
+/**
+ *
+ *  Copyright 2016-2020 Netflix, Inc.
+ *
+ *     Licensed under the BSD+Patent License (the "License");
+ *     you may not use this file except in compliance with the License.
+ *     You may obtain a copy of the License at
+ *
+ *         https://opensource.org/licenses/BSDplusPatent
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *
+ */
+
+#include <stdatomic.h>
+
+#include "test.h"
+#include "feature/feature_collector.h"
+#include "feature/feature_extractor.h"
+#include "temporal_lane.h"
+#include "thread_pool.h"
+
+static unsigned extracted[16];
+static unsigned extracted_cnt;
+static atomic_uint retired_cnt, completed_cnt;
+
+static int extract(VmafFeatureExtractor *fex,
+                   VmafPicture *ref_pic, VmafPicture *ref_pic_90,
+                   VmafPicture *dist_pic, VmafPicture *dist_pic_90,
+                   unsigned index, VmafFeatureCollector *feature_collector)
+{
+    (void) fex;
+    (void) ref_pic;
+    (void) ref_pic_90;
+    (void) dist_pic;
+    (void) dist_pic_90;
+    (void) feature_collector;
+
+    extracted[extracted_cnt++] = index;
+    return 0;
+}
+
+static VmafFeatureExtractor fake_temporal_fex = {
+    .name = "fake_temporal",
+    .extract = extract,
+    .flags = VMAF_FEATURE_EXTRACTOR_TEMPORAL,
+};
+
+static void retire(void *cookie)
+{
+    (void) cookie;
+    atomic_fetch_add(&retired_cnt, 1);
+}
+
+static void complete(void *cookie)
+{
+    (void) cookie;
+    atomic_fetch_add(&completed_cnt, 1);
+}
+
+static char *run_lane(const unsigned *index, unsigned cnt, unsigned capacity)
+{
+    int err = 0;
+
+    extracted_cnt = 0;
+    atomic_init(&retired_cnt, 0);
+    atomic_init(&completed_cnt, 0);
+
+    VmafThreadPool *pool;
+    err = vmaf_thread_pool_create(&pool, 2);
+    mu_assert("problem during vmaf_thread_pool_create", !err);
+    VmafFeatureCollector *feature_collector;
+    err = vmaf_feature_collector_init(&feature_collector);
+    mu_assert("problem during vmaf_feature_collector_init", !err);
+    VmafFeatureExtractorContext *fex_ctx;
+    err = vmaf_feature_extractor_context_create(&fex_ctx, &fake_temporal_fex,
+                                                NULL);
+    mu_assert("problem during vmaf_feature_extractor_context_create", !err);
+
+    VmafTemporalLane *lane;
+    err = vmaf_temporal_lane_create(&lane, fex_ctx, feature_collector, pool,
+                                    capacity, retire, complete);
+    mu_assert("problem during vmaf_temporal_lane_create", !err);
+
+    for (unsigned i = 0; i < cnt; i++) {
+        VmafPicture ref, dist;
+        err = vmaf_picture_alloc(&ref, VMAF_PIX_FMT_YUV420P, 8, 16, 16);
+        err |= vmaf_picture_alloc(&dist, VMAF_PIX_FMT_YUV420P, 8, 16, 16);
+        mu_assert("problem during vmaf_picture_alloc", !err);
+        err = vmaf_temporal_lane_submit(lane, &ref, &dist, index[i], NULL);
+        mu_assert("problem during vmaf_temporal_lane_submit", !err);
+    }
+
+    err = vmaf_temporal_lane_flush(lane);
+    mu_assert("problem during vmaf_temporal_lane_flush", !err);
+    mu_assert("every frame should be retired", atomic_load(&retired_cnt) == cnt);
+    mu_assert("every frame should be complete",
+              atomic_load(&completed_cnt) == cnt);
+
+    err = vmaf_thread_pool_wait(pool);
+    err |= vmaf_temporal_lane_destroy(lane);
+    err |= vmaf_feature_extractor_context_close(fex_ctx);
+    err |= vmaf_feature_extractor_context_destroy(fex_ctx);
+    err |= vmaf_thread_pool_destroy(pool);
+    mu_assert("problem during cleanup", !err);
+    vmaf_feature_collector_destroy(feature_collector);
+
+    return NULL;
+}
+
+static char *test_temporal_lane_reorders()
+{
+    const unsigned index[] = { 1, 0, 3, 2, 4, 6, 5, 7 };
+    const unsigned cnt = sizeof(index) / sizeof(index[0]);
+
+    char *msg = run_lane(index, cnt, 4);
+    if (msg) return msg;
+
+    mu_assert("every frame should be extracted", extracted_cnt == cnt);
+    for (unsigned i = 0; i < cnt; i++)
+        mu_assert("frames should be extracted in index order", extracted[i] == i);
+
+    return NULL;
+}
+
+static char *test_temporal_lane_gap()
+{
+    const unsigned index[] = { 0, 2, 4, 3, 6 };
+    const unsigned expected[] = { 0, 2, 3, 4, 6 };
+    const unsigned cnt = sizeof(index) / sizeof(index[0]);
+
+    char *msg = run_lane(index, cnt, 2);
+    if (msg) return msg;
+
+    mu_assert("every frame should be extracted", extracted_cnt == cnt);
+    for (unsigned i = 0; i < cnt; i++) {
+        mu_assert("a gap should not stall the lane or break its order",
+                  extracted[i] == expected[i]);
+    }
+
+    return NULL;
+}
+
+char *run_tests()
+{
+    mu_run_test(test_temporal_lane_reorders);
+    mu_run_test(test_temporal_lane_gap);
+    return NULL;
+}
@@ -16,6 +16,8 @@
  *
  */
 
+#include <errno.h>
+#include <stdatomic.h>
 #include <stdint.h>
 
 #include "test.h"
@@ -77,8 +79,87 @@ static char *test_thread_pool_create_enqueue_wait_and_destroy()
     return NULL;
 }
 
+typedef struct JobCount {
+    VmafThreadPool *pool;
+    atomic_int *cnt;
+    unsigned depth;
+} JobCount;
+
+static void fn_count(void *data)
+{
+    JobCount *job = data;
+    atomic_fetch_add(job->cnt, 1);
+    if (!job->depth) return;
+
+    JobCount child = *job;
+    child.depth--;
+    vmaf_thread_pool_enqueue(job->pool, fn_count, &child, sizeof(child));
+    vmaf_thread_pool_enqueue(job->pool, fn_count, &child, sizeof(child));
+}
+
+static void fn_wait(void *data)
+{
+    JobCount *job = data;
+    atomic_store(job->cnt, vmaf_thread_pool_wait(job->pool));
+}
+
+static char *test_thread_pool_work_stealing()
+{
+    int err;
+
+    VmafThreadPool *pool;
+    err = vmaf_thread_pool_create_work_stealing(&pool, 8, sizeof(JobCount));
+    mu_assert("problem during vmaf_thread_pool_create_work_stealing", !err);
+
+    atomic_int cnt;
+    atomic_init(&cnt, 0);
+    JobCount job = { .pool = pool, .cnt = &cnt, .depth = 0 };
+
+    const unsigned n_jobs = 10000;
+    for (unsigned i = 0; i < n_jobs; i++) {
+        err = vmaf_thread_pool_enqueue(pool, fn_count, &job, sizeof(job));
+        mu_assert("problem during vmaf_thread_pool_enqueue", !err);
+    }
+    err = vmaf_thread_pool_wait(pool);
+    mu_assert("problem during vmaf_thread_pool_wait", !err);
+    mu_assert("not every job was run exactly once",
+              atomic_load(&cnt) == (int)n_jobs);
+
+    // every job enqueues two more from within the pool, 2^11 - 1 jobs total
+    atomic_store(&cnt, 0);
+    job.depth = 10;
+    err = vmaf_thread_pool_enqueue(pool, fn_count, &job, sizeof(job));
+    mu_assert("problem during vmaf_thread_pool_enqueue", !err);
+    err = vmaf_thread_pool_wait(pool);
+    mu_assert("problem during vmaf_thread_pool_wait", !err);
+    mu_assert("not every nested job was run exactly once",
+              atomic_load(&cnt) == (1 << 11) - 1);
+
+    uint8_t too_large[sizeof(JobCount) + 1];
+    err = vmaf_thread_pool_enqueue(pool, fn_a, too_large, sizeof(too_large));
+    mu_assert("job data larger than a job slot should be rejected", err);
+
+    atomic_store(&cnt, 0);
+    err = vmaf_thread_pool_enqueue(pool, fn_wait, &job, sizeof(job));
+    mu_assert("problem during vmaf_thread_pool_enqueue", !err);
+    err = vmaf_thread_pool_wait(pool);
+    mu_assert("problem during vmaf_thread_pool_wait", !err);
+    mu_assert("waiting from within a job should fail",
+              atomic_load(&cnt) == -EDEADLK);
+
+    err = vmaf_thread_pool_destroy(pool);
+    mu_assert("problem during vmaf_thread_pool_destroy", !err);
+
+    err = vmaf_thread_pool_create_work_stealing(&pool, 8,
+                                                VMAF_THREAD_POOL_MAX_DATA_SZ + 1);
+    mu_assert("oversized job slots should be rejected", err == -EINVAL);
+
+    return NULL;
+}
+
 char *run_tests()
 {
     mu_run_test(test_thread_pool_create_enqueue_wait_and_destroy);
+    mu_run_test(test_thread_pool_work_stealing);
     return NULL;
 }
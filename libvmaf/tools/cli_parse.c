@@ -23,6 +23,7 @@ enum {
     ARG_FEATURE,
     ARG_SUBSAMPLE,
     ARG_CPUMASK,
+    ARG_QUEUE_DEPTH,
 };
 
 static const struct option long_opts[] = {
@@ -42,6 +43,7 @@ static const struct option long_opts[] = {
     { "feature",          1, NULL, ARG_FEATURE },
     { "subsample",        1, NULL, ARG_SUBSAMPLE },
     { "cpumask",          1, NULL, ARG_CPUMASK },
+    { "queue_depth",      1, NULL, ARG_QUEUE_DEPTH },
     { "no_prediction",    0, NULL, 'n' },
     { "version",          0, NULL, 'v' },
     { "quiet",            0, NULL, 'q' },
@@ -79,6 +81,9 @@ static void usage(const char *const app, const char *const reason, ...) {
             " --feature $string:         additional feature\n"
             " --cpumask: $bitmask        restrict permitted CPU instruction sets\n"
             " --subsample: $unsigned     compute scores only every N frames\n"
+            " --queue_depth $unsigned:   pictures read ahead per input on a separate\n"
+            "                            thread, 0 reads on the main thread\n"
+            "                            (default: 4 with --threads, else 0)\n"
             " --quiet/-q:                disable FPS meter when run in a TTY\n"
             " --no_prediction/-n:        no prediction, extract features only\n"
             " --version/-v:              print version and exit\n"
@@ -224,6 +229,7 @@ void cli_parse(const int argc, char *const *const argv,
                CLISettings *const settings)
 {
     memset(settings, 0, sizeof(*settings));
+    bool queue_depth_set = false;
     int o;
 
     while ((o = getopt_long(argc, argv, short_opts, long_opts, NULL)) >= 0) {
@@ -290,6 +296,11 @@ void cli_parse(const int argc, char *const *const argv,
         case ARG_CPUMASK:
             settings->cpumask = parse_unsigned(optarg, 'c', argv[0]);
             break;
+        case ARG_QUEUE_DEPTH:
+            settings->queue_depth =
+                parse_unsigned(optarg, ARG_QUEUE_DEPTH, argv[0]);
+            queue_depth_set = true;
+            break;
         case 'n':
             settings->no_prediction = true;
             break;
@@ -306,6 +317,8 @@ void cli_parse(const int argc, char *const *const argv,
 
     if (!settings->output_fmt)
         settings->output_fmt = VMAF_OUTPUT_FORMAT_XML;
+    if (!queue_depth_set && settings->thread_cnt)
+        settings->queue_depth = 4;
     if (!settings->path_ref)
         usage(argv[0], "Reference .y4m or .yuv (-r/--reference) is required");
     if (!settings->path_ref)
@@ -36,6 +36,7 @@ typedef struct {
     enum VmafLogLevel log_level;
     unsigned subsample;
     unsigned thread_cnt;
+    unsigned queue_depth;
     bool no_prediction;
     bool quiet;
     unsigned cpumask;
@@ -0,0 +1,127 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "read_ahead.h"
+
+typedef struct read_ahead_entry {
+    VmafPicture pic;
+    int ret;
+} read_ahead_entry;
+
+struct read_ahead {
+    read_ahead_fetch_func fetch;
+    void *user_data;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t filled, drained;
+    read_ahead_entry *entry; ///< ring buffer
+    unsigned depth, head, cnt;
+    bool stop;
+};
+
+static void *read_ahead_run(void *data)
+{
+    read_ahead *ra = data;
+    int ret = 0;
+
+    while (!ret) {
+        read_ahead_entry e = { .ret = 0 };
+        ret = e.ret = ra->fetch(ra->user_data, &e.pic);
+
+        pthread_mutex_lock(&(ra->lock));
+        while (ra->cnt == ra->depth && !ra->stop)
+            pthread_cond_wait(&(ra->drained), &(ra->lock));
+        if (ra->stop) {
+            pthread_mutex_unlock(&(ra->lock));
+            if (!e.ret) vmaf_picture_unref(&e.pic);
+            break;
+        }
+        ra->entry[(ra->head + ra->cnt++) % ra->depth] = e;
+        pthread_cond_signal(&(ra->filled));
+        pthread_mutex_unlock(&(ra->lock));
+    }
+
+    return NULL;
+}
+
+int read_ahead_start(read_ahead **ra, unsigned depth,
+                     read_ahead_fetch_func fetch, void *user_data)
+{
+    if (!ra) return -EINVAL;
+    if (!depth) return -EINVAL;
+    if (!fetch) return -EINVAL;
+
+    read_ahead *const r = *ra = malloc(sizeof(*r));
+    if (!r) goto fail;
+    memset(r, 0, sizeof(*r));
+    r->entry = malloc(sizeof(*(r->entry)) * depth);
+    if (!r->entry) goto free_r;
+
+    r->fetch = fetch;
+    r->user_data = user_data;
+    r->depth = depth;
+    pthread_mutex_init(&(r->lock), NULL);
+    pthread_cond_init(&(r->filled), NULL);
+    pthread_cond_init(&(r->drained), NULL);
+    if (pthread_create(&r->thread, NULL, read_ahead_run, r))
+        goto destroy_sync;
+
+    return 0;
+
+destroy_sync:
+    pthread_mutex_destroy(&(r->lock));
+    pthread_cond_destroy(&(r->filled));
+    pthread_cond_destroy(&(r->drained));
+    free(r->entry);
+free_r:
+    free(r);
+fail:
+    return -ENOMEM;
+}
+
+int read_ahead_fetch_picture(read_ahead *ra, VmafPicture *pic)
+{
+    pthread_mutex_lock(&(ra->lock));
+    while (!ra->cnt)
+        pthread_cond_wait(&(ra->filled), &(ra->lock));
+
+    // the final entry, end of input or an error, is never dequeued
+    read_ahead_entry *e = &ra->entry[ra->head];
+    const int ret = e->ret;
+    if (!ret) {
+        *pic = e->pic;
+        ra->head = (ra->head + 1) % ra->depth;
+        ra->cnt--;
+        pthread_cond_signal(&(ra->drained));
+    }
+    pthread_mutex_unlock(&(ra->lock));
+
+    return ret;
+}
+
+void read_ahead_stop(read_ahead *ra)
+{
+    if (!ra) return;
+
+    // queued pictures are dropped before joining, the producer may be
+    // waiting for one of them to return to a picture pool
+    pthread_mutex_lock(&(ra->lock));
+    ra->stop = true;
+    for (; ra->cnt; ra->cnt--) {
+        read_ahead_entry *e = &ra->entry[ra->head];
+        if (!e->ret) vmaf_picture_unref(&e->pic);
+        ra->head = (ra->head + 1) % ra->depth;
+    }
+    pthread_cond_signal(&(ra->drained));
+    pthread_mutex_unlock(&(ra->lock));
+    pthread_join(ra->thread, NULL);
+
+    pthread_mutex_destroy(&(ra->lock));
+    pthread_cond_destroy(&(ra->filled));
+    pthread_cond_destroy(&(ra->drained));
+    free(ra->entry);
+    free(ra);
+}
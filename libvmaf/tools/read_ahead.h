@@ -0,0 +1,33 @@
+#ifndef __VMAF_READ_AHEAD_H__
+#define __VMAF_READ_AHEAD_H__
+
+#include <libvmaf/picture.h>
+
+/**
+ * Fetches pictures on a producer thread into a bounded queue, so that
+ * reading and parsing an input overlaps with feature extraction.
+ */
+typedef struct read_ahead read_ahead;
+
+/**
+ * Picture source, returns 0 on success, 1 at the end of the input, or < 0
+ * on error. Only ever called from the producer thread.
+ */
+typedef int (*read_ahead_fetch_func)(void *user_data, VmafPicture *pic);
+
+int read_ahead_start(read_ahead **ra, unsigned depth,
+                     read_ahead_fetch_func fetch, void *user_data);
+
+/**
+ * Blocks until the next picture is available. Returns like the
+ * `read_ahead_fetch_func`; once the input has ended, or failed, every
+ * further call returns the same result.
+ */
+int read_ahead_fetch_picture(read_ahead *ra, VmafPicture *pic);
+
+/**
+ * Stop the producer thread and unreference all pictures still queued.
+ */
+void read_ahead_stop(read_ahead *ra);
+
+#endif /* __VMAF_READ_AHEAD_H__ */
@@ -4,8 +4,10 @@
 #include <unistd.h>
 
 #include "cli_parse.h"
+#include "read_ahead.h"
 #include "spinner.h"
 #include "vidinput.h"
+#include "yuv_mmap.h"
 
 #include <libvmaf/picture.h>
 #include <libvmaf/libvmaf.rc.h>
@@ -65,18 +67,36 @@ static int validate_videos(video_input *vid1, video_input *vid2)
     return err_cnt;
 }
 
-static int fetch_picture(video_input *vid, VmafPicture *pic)
+static int picture_pool_create(video_input *vid, unsigned pic_cnt,
+                               VmafPicturePool **pool)
+{
+    video_input_info info;
+    video_input_get_info(vid, &info);
+
+    VmafPicturePoolConfig cfg = {
+        .pic_cnt = pic_cnt,
+        .pix_fmt = pix_fmt_map(info.pixel_fmt),
+        .bpc = info.depth,
+        .w = info.pic_w,
+        .h = info.pic_h,
+    };
+    return vmaf_picture_pool_create(pool, cfg);
+}
+
+static int fetch_picture(video_input *vid, yuv_mmap *yuv,
+                         VmafPicturePool *pool, VmafPicture *pic)
 {
     int ret;
     video_input_ycbcr ycbcr;
     video_input_info info;
 
+    if (yuv) return yuv_mmap_fetch_picture(yuv, pic);
+
     ret = video_input_fetch_frame(vid, ycbcr, NULL);
     if (ret < 1) return !ret;
 
     video_input_get_info(vid, &info);
-    ret = vmaf_picture_alloc(pic, pix_fmt_map(info.pixel_fmt), info.depth,
-                             info.pic_w, info.pic_h);
+    ret = vmaf_picture_pool_fetch(pool, pic);
     if (ret) {
         fprintf(stderr, "problem allocating picture.\n");
         return -1;
@@ -121,6 +141,25 @@ static int fetch_picture(video_input *vid, VmafPicture *pic)
     return 0;
 }
 
+typedef struct picture_source {
+    video_input *vid;
+    yuv_mmap *yuv;
+    VmafPicturePool *pool;
+    read_ahead *ra;
+} picture_source;
+
+static int picture_source_read(void *user_data, VmafPicture *pic)
+{
+    picture_source *src = user_data;
+    return fetch_picture(src->vid, src->yuv, src->pool, pic);
+}
+
+static int picture_source_fetch(picture_source *src, VmafPicture *pic)
+{
+    if (src->ra) return read_ahead_fetch_picture(src->ra, pic);
+    return picture_source_read(src, pic);
+}
+
 int main(int argc, char *argv[])
 {
     int err = 0;
@@ -174,6 +213,48 @@ int main(int argc, char *argv[])
         return -1;
     }
 
+    // raw files are read straight out of a mapping when possible, all other
+    // inputs are copied into pooled pictures
+    yuv_mmap *mmap_ref = NULL, *mmap_dist = NULL;
+    if (c.use_yuv) {
+        yuv_mmap_open(&mmap_ref, file_ref,
+                      c.width, c.height, c.pix_fmt, c.bitdepth);
+        yuv_mmap_open(&mmap_dist, file_dist,
+                      c.width, c.height, c.pix_fmt, c.bitdepth);
+    }
+
+    // pictures are only written up to their width, so recycled pictures
+    // need no clearing. when threaded, enough pictures are pooled to keep
+    // frames in flight while the next ones are read ahead.
+    const unsigned pic_cnt =
+        (c.thread_cnt ? 2 * c.thread_cnt + 1 : 1) + c.queue_depth;
+    VmafPicturePool *pool_ref = NULL, *pool_dist = NULL;
+    if (!mmap_ref)
+        err |= picture_pool_create(&vid_ref, pic_cnt, &pool_ref);
+    if (!mmap_dist)
+        err |= picture_pool_create(&vid_dist, pic_cnt, &pool_dist);
+    if (err) {
+        fprintf(stderr, "problem allocating picture pools\n");
+        return -1;
+    }
+
+    picture_source src_ref = {
+        .vid = &vid_ref, .yuv = mmap_ref, .pool = pool_ref,
+    };
+    picture_source src_dist = {
+        .vid = &vid_dist, .yuv = mmap_dist, .pool = pool_dist,
+    };
+    if (c.queue_depth) {
+        err = read_ahead_start(&src_ref.ra, c.queue_depth,
+                               picture_source_read, &src_ref);
+        err |= read_ahead_start(&src_dist.ra, c.queue_depth,
+                                picture_source_read, &src_dist);
+        if (err) {
+            fprintf(stderr, "problem starting read-ahead threads\n");
+            return -1;
+        }
+    }
+
     VmafConfiguration cfg = {
         .log_level = VMAF_LOG_LEVEL_INFO,
         .n_threads = c.thread_cnt,
@@ -270,22 +351,26 @@ int main(int argc, char *argv[])
     unsigned picture_index;
     for (picture_index = 0 ;; picture_index++) {
         VmafPicture pic_ref, pic_dist;
-        int ret1 = fetch_picture(&vid_ref, &pic_ref);
-        int ret2 = fetch_picture(&vid_dist, &pic_dist);
+        int ret1 = picture_source_fetch(&src_ref, &pic_ref);
+        int ret2 = picture_source_fetch(&src_dist, &pic_dist);
 
         if (ret1 && ret2) {
             break;
         } else if (ret1 < 0 || ret2 < 0) {
             fprintf(stderr, "\nproblem while reading pictures\n",
                     c.path_ref, c.path_dist);
+            if (!ret1) vmaf_picture_unref(&pic_ref);
+            if (!ret2) vmaf_picture_unref(&pic_dist);
             break;
         } else if (ret1) {
             fprintf(stderr, "\n\"%s\" ended before \"%s\".\n",
                     c.path_ref, c.path_dist);
+            vmaf_picture_unref(&pic_dist);
             break;
         } else if (ret2) {
             fprintf(stderr, "\n\"%s\" ended before \"%s\".\n",
                     c.path_dist, c.path_ref);
+            vmaf_picture_unref(&pic_ref);
             break;
         }
 
@@ -308,6 +393,8 @@ int main(int argc, char *argv[])
         }
     }
     fprintf(stderr, "\n");
+    read_ahead_stop(src_ref.ra);
+    read_ahead_stop(src_dist.ra);
 
     err |= vmaf_read_pictures(vmaf, NULL, NULL, 0);
     if (err) {
@@ -365,5 +452,9 @@ int main(int argc, char *argv[])
     video_input_close(&vid_ref);
     video_input_close(&vid_dist);
     vmaf_close(vmaf);
+    vmaf_picture_pool_destroy(pool_ref);
+    vmaf_picture_pool_destroy(pool_dist);
+    yuv_mmap_close(mmap_ref);
+    yuv_mmap_close(mmap_dist);
     return err;
 }
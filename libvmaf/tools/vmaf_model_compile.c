@@ -0,0 +1,69 @@
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <libvmaf/model.h>
+
+#include "model.h"
+
+static void usage(const char *const app)
+{
+    fprintf(stderr, "Usage: %s $model $output\n\n", app);
+    fprintf(stderr, "Compile a .json or .pkl model, or a built-in model "
+                    "version, into a binary model.\n"
+                    "$output should end in .vmafb, model collections are "
+                    "compiled into a single file.\n");
+}
+
+static int load(VmafModel **model, VmafModelCollection **model_collection,
+                VmafModelConfig *cfg, const char *model_path)
+{
+    struct stat s;
+    const int is_path = !stat(model_path, &s);
+
+    int err = is_path ? vmaf_model_load_from_path(model, cfg, model_path) :
+                        vmaf_model_load(model, cfg, model_path);
+    if (!err) return 0;
+
+    // check for model_collection before failing
+    err = is_path ?
+        vmaf_model_collection_load_from_path(model, model_collection, cfg,
+                                             model_path) :
+        vmaf_model_collection_load(model, model_collection, cfg, model_path);
+    return err;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 3) {
+        usage(argv[0]);
+        return -1;
+    }
+
+    const char *model_path = argv[1];
+    const char *output_path = argv[2];
+
+    VmafModel *model = NULL;
+    VmafModelCollection *model_collection = NULL;
+    // keep the score transform, it is only applied if enabled at load time
+    VmafModelConfig cfg = {
+        .flags = VMAF_MODEL_FLAG_ENABLE_TRANSFORM,
+    };
+
+    int err = load(&model, &model_collection, &cfg, model_path);
+    if (err) {
+        fprintf(stderr, "problem loading model: %s\n", model_path);
+        return -1;
+    }
+
+    err = vmaf_model_write_binary(model, model_collection, output_path);
+    if (err) {
+        fprintf(stderr, "problem writing binary model: %s (%s)\n",
+                output_path, strerror(-err));
+    }
+
+    vmaf_model_destroy(model);
+    vmaf_model_collection_destroy(model_collection);
+    return err ? -1 : 0;
+}
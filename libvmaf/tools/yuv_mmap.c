@@ -0,0 +1,150 @@
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "yuv_mmap.h"
+
+struct yuv_mmap {
+    uint8_t *data;
+    size_t sz;
+    size_t page_sz;
+    unsigned width, height;
+    enum VmafPixelFormat pix_fmt;
+    unsigned bitdepth;
+    size_t frame_sz;
+    size_t plane_offset[3];
+    ptrdiff_t stride[3];
+    unsigned frame_cnt, index;
+};
+
+typedef struct yuv_mmap_frame {
+    yuv_mmap *yuv;
+    unsigned index;
+} yuv_mmap_frame;
+
+int yuv_mmap_open(yuv_mmap **yuv, FILE *fin, unsigned width, unsigned height,
+                  enum VmafPixelFormat pix_fmt, unsigned bitdepth)
+{
+    if (!yuv) return -EINVAL;
+    if (!fin) return -EINVAL;
+
+    const int fd = fileno(fin);
+    struct stat st;
+    if (fstat(fd, &st) || !S_ISREG(st.st_mode) || !st.st_size)
+        return -EINVAL;
+
+    unsigned c_dec_h, c_dec_v;
+    switch (pix_fmt) {
+    case VMAF_PIX_FMT_YUV420P:
+        c_dec_h = c_dec_v = 2;
+        break;
+    case VMAF_PIX_FMT_YUV422P:
+        c_dec_h = 2;
+        c_dec_v = 1;
+        break;
+    case VMAF_PIX_FMT_YUV444P:
+        c_dec_h = c_dec_v = 1;
+        break;
+    default:
+        return -EINVAL;
+    }
+
+    yuv_mmap *const y = *yuv = malloc(sizeof(*y));
+    if (!y) return -ENOMEM;
+    memset(y, 0, sizeof(*y));
+
+    const int hbd = bitdepth > 8;
+    const unsigned c_w = (width + c_dec_h - 1) / c_dec_h;
+    const unsigned c_h = (height + c_dec_v - 1) / c_dec_v;
+    y->width = width;
+    y->height = height;
+    y->pix_fmt = pix_fmt;
+    y->bitdepth = bitdepth;
+    y->stride[0] = (ptrdiff_t) width << hbd;
+    y->stride[1] = y->stride[2] = (ptrdiff_t) c_w << hbd;
+    y->plane_offset[1] = y->stride[0] * height;
+    y->plane_offset[2] = y->plane_offset[1] + y->stride[1] * c_h;
+    y->frame_sz = y->plane_offset[2] + y->stride[2] * c_h;
+    y->frame_cnt = st.st_size / y->frame_sz;
+    y->sz = st.st_size;
+    y->page_sz = sysconf(_SC_PAGESIZE);
+
+    // private and writable, an extractor writing into a picture only ever
+    // touches its own copy of the page
+    y->data = mmap(NULL, y->sz, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (y->data == MAP_FAILED) {
+        free(y);
+        *yuv = NULL;
+        return -errno;
+    }
+    madvise(y->data, y->sz, MADV_SEQUENTIAL);
+    madvise(y->data, y->frame_sz < y->sz ? y->frame_sz : y->sz, MADV_WILLNEED);
+
+    return 0;
+}
+
+// whole pages only, the first and last page may be shared with a neighbour
+static void yuv_mmap_drop(yuv_mmap *yuv, size_t begin, size_t end)
+{
+    begin = (begin + yuv->page_sz - 1) / yuv->page_sz * yuv->page_sz;
+    end = end / yuv->page_sz * yuv->page_sz;
+    if (end > begin)
+        madvise(yuv->data + begin, end - begin, MADV_DONTNEED);
+}
+
+static void yuv_mmap_release(void *cookie)
+{
+    yuv_mmap_frame *frame = cookie;
+    yuv_mmap *yuv = frame->yuv;
+
+    const size_t begin = yuv->frame_sz * frame->index;
+    yuv_mmap_drop(yuv, begin, begin + yuv->frame_sz);
+    free(frame);
+}
+
+int yuv_mmap_fetch_picture(yuv_mmap *yuv, VmafPicture *pic)
+{
+    if (yuv->index >= yuv->frame_cnt) {
+        if (!(yuv->sz % yuv->frame_sz)) return 1;
+        fprintf(stderr, "Error reading YUV frame data.\n");
+        return -1;
+    }
+
+    yuv_mmap_frame *frame = malloc(sizeof(*frame));
+    if (!frame) return -1;
+    frame->yuv = yuv;
+    frame->index = yuv->index++;
+
+    const size_t offset = yuv->frame_sz * frame->index;
+    if (yuv->index < yuv->frame_cnt) {
+        const size_t next = offset + yuv->frame_sz;
+        const size_t begin = next / yuv->page_sz * yuv->page_sz;
+        madvise(yuv->data + begin, next + yuv->frame_sz - begin,
+                MADV_WILLNEED);
+    }
+
+    void *data[3];
+    for (unsigned i = 0; i < 3; i++)
+        data[i] = yuv->data + offset + yuv->plane_offset[i];
+
+    int err = vmaf_picture_wrap(pic, yuv->pix_fmt, yuv->bitdepth,
+                                yuv->width, yuv->height, data, yuv->stride,
+                                yuv_mmap_release, frame);
+    if (err) {
+        free(frame);
+        return -1;
+    }
+
+    return 0;
+}
+
+void yuv_mmap_close(yuv_mmap *yuv)
+{
+    if (!yuv) return;
+    munmap(yuv->data, yuv->sz);
+    free(yuv);
+}
@@ -0,0 +1,34 @@
+#ifndef __VMAF_YUV_MMAP_H__
+#define __VMAF_YUV_MMAP_H__
+
+#include <stdio.h>
+
+#include <libvmaf/picture.h>
+
+/**
+ * Zero-copy raw .yuv input. The file is mapped into memory and every frame
+ * is wrapped into a VmafPicture which points straight into the mapping.
+ * Pages of a frame are dropped once its picture is unreferenced, and the
+ * next frame is prefetched on every fetch.
+ */
+typedef struct yuv_mmap yuv_mmap;
+
+/**
+ * Fails with a negative errno if `fin` can not be mapped, e.g. when it is
+ * not a regular file. Callers should then fall back to `raw_input_open()`.
+ */
+int yuv_mmap_open(yuv_mmap **yuv, FILE *fin, unsigned width, unsigned height,
+                  enum VmafPixelFormat pix_fmt, unsigned bitdepth);
+
+/**
+ * Returns 0 on success, 1 once all frames have been fetched, or -1 on a
+ * truncated frame, like `fetch_picture()`.
+ */
+int yuv_mmap_fetch_picture(yuv_mmap *yuv, VmafPicture *pic);
+
+/**
+ * Unmap the file. Every fetched picture must have been unreferenced.
+ */
+void yuv_mmap_close(yuv_mmap *yuv);
+
+#endif /* __VMAF_YUV_MMAP_H__ */
@@ -1187,6 +1187,84 @@ class VmafrcQualityRunnerSubsamplingTest(unittest.TestCase):
                 self.assertAlmostEqual(results0[1]['VMAFRC_scores'][i], results[1]['VMAFRC_scores'][i // subsample], places=7)
 
 
+class VmafrcQualityRunnerInputTest(unittest.TestCase):
+
+    def tearDown(self):
+        if hasattr(self, 'runner0'):
+            self.runner0.remove_results()
+        if hasattr(self, 'runner'):
+            self.runner.remove_results()
+
+    def setUp(self):
+        self.result_store = FileSystemResultStore()
+
+    def _assert_all_scores_equal(self, results0, results):
+        for result0, result in zip(results0, results):
+            list_scores_key = result0.get_ordered_list_scores_key()
+            self.assertEqual(list_scores_key, result.get_ordered_list_scores_key())
+            for scores_key in list_scores_key:
+                self.assertEqual(result0[scores_key], result[scores_key])
+
+    def _run_mmap_and_fifo(self, asset, asset_original):
+        # vmaf_rc maps workfiles that are regular files, and reads named pipes
+        # frame by frame with fread()
+        self.runner0 = VmafrcQualityRunner(
+            [asset, asset_original],
+            None, fifo_mode=True,
+            delete_workdir=True,
+            result_store=None,
+            optional_dict={'float_ssim': True, 'psnr': True}
+        )
+        self.runner0.run()
+
+        self.runner = VmafrcQualityRunner(
+            [asset, asset_original],
+            None, fifo_mode=False,
+            delete_workdir=True,
+            result_store=None,
+            optional_dict={'float_ssim': True, 'psnr': True}
+        )
+        self.runner.run()
+
+        self._assert_all_scores_equal(self.runner0.results, self.runner.results)
+
+    def test_run_vmafrc_runner_mmap_matches_fifo(self):
+        ref_path, dis_path, asset, asset_original = set_default_576_324_videos_for_testing()
+        self._run_mmap_and_fifo(asset, asset_original)
+
+    def test_run_vmafrc_runner_mmap_matches_fifo_10bit(self):
+        ref_path, dis_path, asset, asset_original = set_default_576_324_10bit_videos_for_testing()
+        self._run_mmap_and_fifo(asset, asset_original)
+
+
+    def test_run_vmafrc_runner_queue_depth(self):
+        ref_path, dis_path, asset, asset_original = set_default_576_324_videos_for_testing()
+
+        # pictures read inline on the main thread
+        self.runner0 = VmafrcQualityRunner(
+            [asset, asset_original],
+            None, fifo_mode=True,
+            delete_workdir=True,
+            result_store=None,
+            optional_dict={'float_ssim': True, 'psnr': True,
+                           'n_threads': 4, 'queue_depth': 0}
+        )
+        self.runner0.run()
+
+        # pictures read ahead on producer threads
+        self.runner = VmafrcQualityRunner(
+            [asset, asset_original],
+            None, fifo_mode=True,
+            delete_workdir=True,
+            result_store=None,
+            optional_dict={'float_ssim': True, 'psnr': True,
+                           'n_threads': 4, 'queue_depth': 8}
+        )
+        self.runner.run()
+
+        self._assert_all_scores_equal(self.runner0.results, self.runner.results)
+
+
 class QualityRunnerVersionTest(unittest.TestCase):
 
     def test_vmafrc_quality_runner_version(self):
@@ -232,7 +232,8 @@ class ExternalProgramCaller(object):
     def call_vmafrc(reference, distorted, width, height, pixel_format, bitdepth,
                     float_psnr, psnr, float_ssim, ssim, float_ms_ssim, ms_ssim, float_moment,
                     no_prediction, models, subsample, n_threads, disable_avx, output, exe, logger,
-                    vif_enhn_gain_limit=None, adm_enhn_gain_limit=None, motion_force_zero=False):
+                    vif_enhn_gain_limit=None, adm_enhn_gain_limit=None, motion_force_zero=False,
+                    queue_depth=None):
 
         if exe is None:
             exe = required(ExternalProgram.vmafrc)
@@ -284,6 +285,10 @@ class ExternalProgramCaller(object):
         if disable_avx:
             vmafrc_cmd += ' --cpumask -1'
 
+        if queue_depth is not None:
+            assert isinstance(queue_depth, int) and queue_depth >= 0
+            vmafrc_cmd += ' --queue_depth {}'.format(queue_depth)
+
         if vif_enhn_gain_limit is not None:
             # FIXME: hacky - since we do not know which feature is the one used in the model, we have to set the
             # parameter for both, which doubles the computation.
@@ -1284,6 +1284,10 @@ class VmafrcQualityRunner(QualityRunner):
             motion_force_zero = False
         assert isinstance(motion_force_zero, bool)
 
+        queue_depth = self.optional_dict['queue_depth'] \
+            if self.optional_dict is not None and 'queue_depth' in self.optional_dict else None
+        assert queue_depth is None or (isinstance(queue_depth, int) and queue_depth >= 0)
+
         # ==== translate disable_enhn_gain into vif_enhn_gain_limit and adm_enhn_gain_limit: ====
         if disable_enhn_gain is None:
             pass
@@ -1315,7 +1319,8 @@ class VmafrcQualityRunner(QualityRunner):
         ExternalProgramCaller.call_vmafrc(reference, distorted, width, height, pixel_format, bitdepth,
                                           float_psnr, psnr, float_ssim, ssim, float_ms_ssim, ms_ssim, float_moment,
                                           no_prediction, models, subsample, n_threads, disable_avx, output, exe, logger,
-                                          vif_enhn_gain_limit, adm_enhn_gain_limit, motion_force_zero)
+                                          vif_enhn_gain_limit, adm_enhn_gain_limit, motion_force_zero,
+                                          queue_depth)
 
     def _get_exec(self):
         return None  # signaling default